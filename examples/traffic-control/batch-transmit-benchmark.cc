@@ -0,0 +1,133 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This example serves as a benchmark for the batched transmission of packets
+// from the queue discs to the netdevices.
+//
+// Network topology
+//
+//                 10.1.1.0
+// n0 ------------------------------------ n1
+//   point-to-point
+//   dataRate [100 Gbps], delay [10 us]
+//   qdisc PfifoFast with capacity of 1000 packets
+//   netdevice queue with size of 100 packets
+//
+// A set of UDP OnOff applications on n0 saturate the link towards n1. The
+// queue disc on n0 hands packets to the netdevice in batches of up to
+// maxBatchSize packets [1]. The netdevice queue is only woken up when there
+// is room for a whole batch, so that the number of queue disc runs (and of
+// the associated events) decreases as the batch size increases. Also, the
+// netdevice can send the packets in its queue as trains of up to maxTrainSize
+// packets [1], with a single event per train on the transmitter and on the
+// receiver.
+//
+// The output reports the number of packets received by n1, the number of
+// events processed by the simulator and the wall clock time of the
+// simulation, e.g.:
+//
+//    ./waf --run "batch-transmit-benchmark --maxBatchSize=1"
+//    ./waf --run "batch-transmit-benchmark --maxBatchSize=16"
+//    ./waf --run "batch-transmit-benchmark --maxBatchSize=16 --maxTrainSize=16"
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/traffic-control-module.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("BatchTransmitBenchmark");
+
+int main (int argc, char *argv[])
+{
+  uint32_t maxBatchSize = 1;
+  uint32_t maxTrainSize = 1;
+  uint32_t nFlows = 4;
+  uint32_t packetSize = 1448;
+  std::string dataRate = "100Gbps";
+  double simTime = 0.01;
+
+  CommandLine cmd;
+  cmd.AddValue ("maxBatchSize", "Maximum number of packets sent to the device at once", maxBatchSize);
+  cmd.AddValue ("maxTrainSize", "Maximum number of packets sent back-to-back as a train", maxTrainSize);
+  cmd.AddValue ("nFlows", "Number of UDP flows", nFlows);
+  cmd.AddValue ("packetSize", "Size of the UDP payload", packetSize);
+  cmd.AddValue ("dataRate", "Data rate of the point-to-point link", dataRate);
+  cmd.AddValue ("simTime", "Simulation time in seconds", simTime);
+  cmd.Parse (argc, argv);
+
+  NodeContainer nodes;
+  nodes.Create (2);
+
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue (dataRate));
+  p2p.SetDeviceAttribute ("MaxBatchSize", UintegerValue (maxBatchSize));
+  p2p.SetDeviceAttribute ("MaxTrainSize", UintegerValue (maxTrainSize));
+  p2p.SetChannelAttribute ("Delay", StringValue ("10us"));
+  p2p.SetQueue ("ns3::DropTailQueue", "MaxSize", StringValue ("100p"));
+
+  NetDeviceContainer devices = p2p.Install (nodes);
+
+  InternetStackHelper stack;
+  stack.Install (nodes);
+
+  TrafficControlHelper tch;
+  tch.SetRootQueueDisc ("ns3::PfifoFastQueueDisc", "MaxSize", StringValue ("1000p"));
+  tch.Install (devices);
+
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = address.Assign (devices);
+
+  uint16_t port = 9;
+  PacketSinkHelper sinkHelper ("ns3::UdpSocketFactory",
+                               InetSocketAddress (Ipv4Address::GetAny (), port));
+  ApplicationContainer sinkApp = sinkHelper.Install (nodes.Get (1));
+  sinkApp.Start (Seconds (0));
+  sinkApp.Stop (Seconds (simTime));
+
+  // each flow alone is able to saturate the link
+  OnOffHelper onoff ("ns3::UdpSocketFactory", InetSocketAddress (interfaces.GetAddress (1), port));
+  onoff.SetConstantRate (DataRate (dataRate), packetSize);
+  ApplicationContainer sourceApps;
+  for (uint32_t i = 0; i < nFlows; i++)
+    {
+      sourceApps.Add (onoff.Install (nodes.Get (0)));
+    }
+  sourceApps.Start (Seconds (0));
+  sourceApps.Stop (Seconds (simTime));
+
+  Simulator::Stop (Seconds (simTime));
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  Simulator::Run ();
+  int64_t elapsed = clock.End ();
+
+  Ptr<PacketSink> sink = DynamicCast<PacketSink> (sinkApp.Get (0));
+  std::cout << "Max batch size:    " << maxBatchSize << std::endl;
+  std::cout << "Max train size:    " << maxTrainSize << std::endl;
+  std::cout << "Packets received:  " << sink->GetTotalRx () / packetSize << std::endl;
+  std::cout << "Throughput:        " << sink->GetTotalRx () * 8 / simTime / 1e9 << " Gbps" << std::endl;
+  std::cout << "Events processed:  " << Simulator::GetEventCount () << std::endl;
+  std::cout << "Wall clock time:   " << elapsed << " ms" << std::endl;
+
+  Simulator::Destroy ();
+  return 0;
+}
@@ -0,0 +1,158 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This example serves as a benchmark for the flow queue disciplines
+// (FqCoDel, Fq and Cake), which keep the state of their flow queues in a
+// FlowQueueTable.
+//
+// The selected queue disc is configured with nQueues flow queues. In each
+// round, one IPv4/UDP packet of each of nFlows flows (distinct source ports
+// and destination addresses) is enqueued, and then all the packets are
+// dequeued, so that every packet of a round is stored in a different flow
+// queue (as long as the hash does not collide) and every flow queue becomes
+// new, old and inactive in each round.
+//
+// The output reports the wall clock time taken to initialize the queue disc
+// (i.e., to create its flow queues) and to enqueue and dequeue the packets,
+// e.g.:
+//
+//    ./waf --run "flow-queue-benchmark --queueDiscType=FqCoDel"
+//    ./waf --run "flow-queue-benchmark --queueDiscType=Fq"
+//    ./waf --run "flow-queue-benchmark --queueDiscType=Cake"
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/traffic-control-module.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("FlowQueueBenchmark");
+
+uint64_t g_enqueued = 0;   //!< Number of packets enqueued
+uint64_t g_dequeued = 0;   //!< Number of packets dequeued
+int64_t g_runTime = 0;     //!< Wall clock time taken to enqueue and dequeue the packets
+
+/**
+ * Enqueue one packet of each flow into the queue disc and then dequeue all
+ * the packets, for the given number of rounds
+ *
+ * \param queueDisc the queue disc
+ * \param nFlows the number of flows
+ * \param nRounds the number of rounds
+ * \param packetSize the size of the UDP payload
+ */
+void
+EnqueueDequeue (Ptr<QueueDisc> queueDisc, uint32_t nFlows, uint32_t nRounds, uint32_t packetSize)
+{
+  // the packets are created beforehand and enqueued again at each round,
+  // so that only the time taken by the queue disc is measured
+  Ipv4Header ipHeader;
+  ipHeader.SetSource (Ipv4Address ("10.1.1.1"));
+  ipHeader.SetProtocol (UdpL4Protocol::PROT_NUMBER);
+  ipHeader.SetPayloadSize (packetSize + 8);
+  std::vector<Ptr<QueueDiscItem> > items;
+  for (uint32_t i = 0; i < nFlows; i++)
+    {
+      UdpHeader udpHeader;
+      udpHeader.SetSourcePort (1024 + i % 60000);
+      udpHeader.SetDestinationPort (9);
+      Ptr<Packet> p = Create<Packet> (packetSize);
+      p->AddHeader (udpHeader);
+      ipHeader.SetDestination (Ipv4Address (0x0b000000 + i / 60000));
+      items.push_back (Create<Ipv4QueueDiscItem> (p, Address (), 0, ipHeader));
+    }
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  for (uint32_t round = 0; round < nRounds; round++)
+    {
+      for (uint32_t i = 0; i < nFlows; i++)
+        {
+          if (queueDisc->Enqueue (items[i]))
+            {
+              g_enqueued++;
+            }
+        }
+      while (queueDisc->Dequeue ())
+        {
+          g_dequeued++;
+        }
+    }
+  g_runTime = clock.End ();
+}
+
+int main (int argc, char *argv[])
+{
+  std::string queueDiscType = "FqCoDel";
+  uint32_t nFlows = 100000;
+  uint32_t nQueues = 131072;
+  uint32_t nRounds = 10;
+  uint32_t packetSize = 1000;
+
+  CommandLine cmd;
+  cmd.AddValue ("queueDiscType", "Queue disc type: FqCoDel, Fq or Cake", queueDiscType);
+  cmd.AddValue ("nFlows", "Number of flows", nFlows);
+  cmd.AddValue ("nQueues", "Number of flow queues of the queue disc", nQueues);
+  cmd.AddValue ("nRounds", "Number of rounds", nRounds);
+  cmd.AddValue ("packetSize", "Size of the UDP payload", packetSize);
+  cmd.Parse (argc, argv);
+
+  if (queueDiscType != "FqCoDel" && queueDiscType != "Fq" && queueDiscType != "Cake")
+    {
+      NS_FATAL_ERROR ("Invalid queue disc type: Use --queueDiscType=FqCoDel, Fq or Cake");
+    }
+
+  ObjectFactory factory;
+  factory.SetTypeId ("ns3::" + queueDiscType + "QueueDisc");
+  factory.Set ("Flows", UintegerValue (nQueues));
+  factory.Set ("MaxSize", QueueSizeValue (QueueSize (QueueSizeUnit::PACKETS, nFlows)));
+  if (queueDiscType == "Fq")
+    {
+      factory.Set ("FlowLimit", UintegerValue (nFlows));
+      factory.Set ("Quantum", UintegerValue (3000));
+      factory.Set ("InitialQuantum", UintegerValue (15000));
+    }
+  Ptr<QueueDisc> queueDisc = factory.Create<QueueDisc> ();
+  Ptr<FqCoDelQueueDisc> fqCoDel = DynamicCast<FqCoDelQueueDisc> (queueDisc);
+  if (fqCoDel)
+    {
+      fqCoDel->SetQuantum (1500);
+    }
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  queueDisc->Initialize ();
+  int64_t initTime = clock.End ();
+
+  // run the benchmark from an event, as the Time objects created before the
+  // simulation starts are slower to create and destroy
+  Simulator::ScheduleNow (&EnqueueDequeue, queueDisc, nFlows, nRounds, packetSize);
+  Simulator::Run ();
+
+  std::cout << "Queue disc:        " << queueDiscType << std::endl;
+  std::cout << "Flows:             " << nFlows << std::endl;
+  std::cout << "Flow queues:       " << nQueues << std::endl;
+  std::cout << "Packets enqueued:  " << g_enqueued << std::endl;
+  std::cout << "Packets dequeued:  " << g_dequeued << std::endl;
+  std::cout << "Init time:         " << initTime << " ms" << std::endl;
+  std::cout << "Enqueue+dequeue:   " << g_runTime << " ms" << std::endl;
+  std::cout << "Time per packet:   " << (g_enqueued ? g_runTime * 1e6 / g_enqueued : 0) << " ns" << std::endl;
+
+  queueDisc->Dispose ();
+  Simulator::Destroy ();
+  return 0;
+}
@@ -0,0 +1,181 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This example serves as a benchmark for shaping the traffic of many
+// subscribers, each to its own rate, as done by the access node of an ISP.
+//
+// The traffic of nSubscribers subscribers is shaped either by an HTB queue
+// disc with a leaf class per subscriber (--queueDiscType=Htb) or by a Prio
+// queue disc with a TBF child queue disc per subscriber
+// (--queueDiscType=PrioTbf). In both cases, the packets are classified by an
+// Ipv4FiveTuplePacketFilter with a rule per subscriber address.
+//
+// Every millisecond, a packet is enqueued for each subscriber, which offers
+// more than the subscriber rate, and then the queue disc is dequeued until
+// no packet can be sent. The output reports the average rate of the
+// subscribers and the wall clock time taken to enqueue and dequeue the
+// packets, e.g.:
+//
+//    ./waf --run "htb-benchmark --queueDiscType=Htb --nSubscribers=1000"
+//    ./waf --run "htb-benchmark --queueDiscType=PrioTbf --nSubscribers=1000"
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/traffic-control-module.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("HtbBenchmark");
+
+uint64_t g_dequeued = 0;      //!< Number of packets dequeued
+uint64_t g_dequeuedBytes = 0; //!< Number of bytes dequeued
+int64_t g_runTime = 0;        //!< Wall clock time taken to enqueue and dequeue the packets
+
+/**
+ * Count a packet sent
+ *
+ * \param item the packet
+ */
+void
+Sent (Ptr<QueueDiscItem> item)
+{
+  g_dequeued++;
+  g_dequeuedBytes += item->GetSize ();
+}
+
+/**
+ * Enqueue a packet for each subscriber and dequeue the packets that can be sent
+ *
+ * \param queueDisc the queue disc
+ * \param items a packet for each subscriber
+ * \param interval the interval between two rounds
+ */
+void
+EnqueueDequeue (Ptr<QueueDisc> queueDisc, const std::vector<Ptr<QueueDiscItem> > *items, Time interval)
+{
+  SystemWallClockMs clock;
+  clock.Start ();
+  for (auto& item : *items)
+    {
+      // enqueue a copy, as the same packet may be in the queue disc already
+      Ptr<Ipv4QueueDiscItem> ipItem = StaticCast<Ipv4QueueDiscItem> (item);
+      queueDisc->Enqueue (Create<Ipv4QueueDiscItem> (ipItem->GetPacket (), Address (), 0, ipItem->GetHeader ()));
+    }
+  Ptr<QueueDiscItem> item;
+  while ((item = queueDisc->Dequeue ()))
+    {
+      Sent (item);
+    }
+  g_runTime += clock.End ();
+  Simulator::Schedule (interval, &EnqueueDequeue, queueDisc, items, interval);
+}
+
+int main (int argc, char *argv[])
+{
+  std::string queueDiscType = "Htb";
+  uint32_t nSubscribers = 1000;
+  std::string rate = "1Mbps";
+  uint32_t packetSize = 1000;
+  double simTime = 0.2;
+
+  CommandLine cmd;
+  cmd.AddValue ("queueDiscType", "Queue disc type: Htb or PrioTbf", queueDiscType);
+  cmd.AddValue ("nSubscribers", "Number of subscribers", nSubscribers);
+  cmd.AddValue ("rate", "Rate of each subscriber", rate);
+  cmd.AddValue ("packetSize", "Size of the UDP payload", packetSize);
+  cmd.AddValue ("simTime", "Simulation time in seconds", simTime);
+  cmd.Parse (argc, argv);
+
+  if (queueDiscType != "Htb" && queueDiscType != "PrioTbf")
+    {
+      NS_FATAL_ERROR ("Invalid queue disc type: Use --queueDiscType=Htb or PrioTbf");
+    }
+  if (nSubscribers == 0 || nSubscribers > 65536)
+    {
+      NS_FATAL_ERROR ("The number of subscribers must be between 1 and 65536");
+    }
+
+  // the filter maps the address of each subscriber to its class
+  Ptr<Ipv4FiveTuplePacketFilter> filter = CreateObject<Ipv4FiveTuplePacketFilter> ();
+  std::vector<Ptr<QueueDiscItem> > items;
+  Ipv4Header ipHeader;
+  ipHeader.SetSource (Ipv4Address ("10.1.1.1"));
+  ipHeader.SetProtocol (UdpL4Protocol::PROT_NUMBER);
+  ipHeader.SetPayloadSize (packetSize + 8);
+  for (uint32_t i = 0; i < nSubscribers; i++)
+    {
+      Ipv4Address address (0x0b000000 + i);
+      FiveTupleRule rule;
+      rule.SetDestination (address, Ipv4Mask ("255.255.255.255"));
+      filter->AddRule (rule, i);
+
+      UdpHeader udpHeader;
+      udpHeader.SetSourcePort (9);
+      udpHeader.SetDestinationPort (9);
+      Ptr<Packet> p = Create<Packet> (packetSize);
+      p->AddHeader (udpHeader);
+      ipHeader.SetDestination (address);
+      items.push_back (Create<Ipv4QueueDiscItem> (p, Address (), 0, ipHeader));
+    }
+
+  uint64_t bitRate = DataRate (rate).GetBitRate ();
+  uint32_t burst = bitRate / 8000 + 1600;
+  Ptr<QueueDisc> queueDisc;
+  if (queueDiscType == "Htb")
+    {
+      queueDisc = CreateObject<HtbQueueDisc> ();
+      Ptr<HtbClass> root = CreateObjectWithAttributes<HtbClass> ("Rate", DataRateValue (DataRate (bitRate * nSubscribers)));
+      for (uint32_t i = 0; i < nSubscribers; i++)
+        {
+          Ptr<HtbClass> c = CreateObjectWithAttributes<HtbClass> ("Parent", PointerValue (root),
+                                                                  "Rate", StringValue (rate));
+          c->SetQueueDisc (CreateObjectWithAttributes<FifoQueueDisc> ("MaxSize", StringValue ("100p")));
+          queueDisc->AddQueueDiscClass (c);
+        }
+    }
+  else
+    {
+      queueDisc = CreateObject<PrioQueueDisc> ();
+      for (uint32_t i = 0; i < nSubscribers; i++)
+        {
+          Ptr<QueueDiscClass> c = CreateObject<QueueDiscClass> ();
+          c->SetQueueDisc (CreateObjectWithAttributes<TbfQueueDisc> ("MaxSize", StringValue ("100p"),
+                                                                     "Rate", StringValue (rate),
+                                                                     "Burst", UintegerValue (burst),
+                                                                     "Mtu", UintegerValue (1500)));
+          queueDisc->AddQueueDiscClass (c);
+        }
+    }
+  queueDisc->AddPacketFilter (filter);
+  // the packets sent when the queue disc wakes itself up
+  queueDisc->SetSendCallback (MakeCallback (&Sent));
+  queueDisc->Initialize ();
+
+  Simulator::ScheduleNow (&EnqueueDequeue, queueDisc, &items, MilliSeconds (1));
+  Simulator::Stop (Seconds (simTime));
+  Simulator::Run ();
+
+  std::cout << "Queue disc:        " << queueDiscType << std::endl;
+  std::cout << "Subscribers:       " << nSubscribers << std::endl;
+  std::cout << "Packets dequeued:  " << g_dequeued << std::endl;
+  std::cout << "Subscriber rate:   " << g_dequeuedBytes * 8 / simTime / nSubscribers / 1e6 << " Mbps" << std::endl;
+  std::cout << "Enqueue+dequeue:   " << g_runTime << " ms" << std::endl;
+
+  queueDisc->Dispose ();
+  Simulator::Destroy ();
+  return 0;
+}
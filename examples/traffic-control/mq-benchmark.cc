@@ -0,0 +1,137 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This example serves as a benchmark for the mq queue disc on a
+// point-to-point device with multiple transmission queues.
+//
+// Network topology
+//
+//                 10.1.1.0
+// n0 ------------------------------------ n1
+//   point-to-point
+//   dataRate [10 Gbps], delay [10 us]
+//   nTxQueues netdevice queues with size of 100 packets
+//   qdisc Mq with a PfifoFast child (capacity of 1000 packets) per netdevice queue
+//
+// A set of UDP OnOff applications on n0 overload the link towards n1. The
+// transmission queue of each packet is selected by hashing its flow, and the
+// packet is enqueued in the child queue disc of such queue. Each netdevice
+// queue wakes its own child queue disc, and the child queue discs do not
+// update any counter of the mq queue disc, whose statistics are aggregated
+// only when requested at the end of the simulation.
+//
+// The output reports the packets sent by each child queue disc, the
+// aggregated statistics of the mq queue disc and the wall clock time of the
+// simulation, e.g.:
+//
+//    ./waf --run "mq-benchmark --nTxQueues=1"
+//    ./waf --run "mq-benchmark --nTxQueues=8"
+//    ./waf --run "mq-benchmark --nTxQueues=16"
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/traffic-control-module.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("MqBenchmark");
+
+int main (int argc, char *argv[])
+{
+  uint32_t nTxQueues = 8;
+  uint32_t nFlows = 64;
+  uint32_t packetSize = 1448;
+  std::string dataRate = "10Gbps";
+  double simTime = 0.05;
+
+  CommandLine cmd;
+  cmd.AddValue ("nTxQueues", "Number of transmission queues of the netdevices", nTxQueues);
+  cmd.AddValue ("nFlows", "Number of UDP flows", nFlows);
+  cmd.AddValue ("packetSize", "Size of the UDP payload", packetSize);
+  cmd.AddValue ("dataRate", "Data rate of the point-to-point link", dataRate);
+  cmd.AddValue ("simTime", "Simulation time in seconds", simTime);
+  cmd.Parse (argc, argv);
+
+  NodeContainer nodes;
+  nodes.Create (2);
+
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue (dataRate));
+  p2p.SetChannelAttribute ("Delay", StringValue ("10us"));
+  p2p.SetQueue ("ns3::DropTailQueue", "MaxSize", StringValue ("100p"));
+  p2p.SetNTxQueues (nTxQueues);
+
+  NetDeviceContainer devices = p2p.Install (nodes);
+
+  InternetStackHelper stack;
+  stack.Install (nodes);
+
+  TrafficControlHelper tch;
+  uint16_t handle = tch.SetRootQueueDisc ("ns3::MqQueueDisc");
+  TrafficControlHelper::ClassIdList cls = tch.AddQueueDiscClasses (handle, nTxQueues, "ns3::QueueDiscClass");
+  tch.AddChildQueueDiscs (handle, cls, "ns3::PfifoFastQueueDisc", "MaxSize", StringValue ("1000p"));
+  QueueDiscContainer qdiscs = tch.Install (devices);
+
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = address.Assign (devices);
+
+  uint16_t port = 9;
+  PacketSinkHelper sinkHelper ("ns3::UdpSocketFactory",
+                               InetSocketAddress (Ipv4Address::GetAny (), port));
+  ApplicationContainer sinkApp = sinkHelper.Install (nodes.Get (1));
+  sinkApp.Start (Seconds (0));
+  sinkApp.Stop (Seconds (simTime));
+
+  // the flows together offer twice the capacity of the link
+  OnOffHelper onoff ("ns3::UdpSocketFactory", InetSocketAddress (interfaces.GetAddress (1), port));
+  onoff.SetConstantRate (DataRate (DataRate (dataRate).GetBitRate () * 2 / nFlows), packetSize);
+  ApplicationContainer sourceApps;
+  for (uint32_t i = 0; i < nFlows; i++)
+    {
+      sourceApps.Add (onoff.Install (nodes.Get (0)));
+    }
+  sourceApps.Start (Seconds (0));
+  sourceApps.Stop (Seconds (simTime));
+
+  Simulator::Stop (Seconds (simTime));
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  Simulator::Run ();
+  int64_t elapsed = clock.End ();
+
+  Ptr<QueueDisc> mq = qdiscs.Get (0);
+  std::cout << "Tx queues:         " << nTxQueues << std::endl;
+  for (uint32_t i = 0; i < mq->GetNQueueDiscClasses (); i++)
+    {
+      std::cout << "  Tx queue " << i << " sent:  "
+                << mq->GetQueueDiscClass (i)->GetQueueDisc ()->GetStats ().nTotalSentPackets << std::endl;
+    }
+  const QueueDisc::Stats& st = mq->GetStats ();
+  std::cout << "Packets sent:      " << st.nTotalSentPackets << std::endl;
+  std::cout << "Packets dropped:   " << st.nTotalDroppedPackets << std::endl;
+  Ptr<PacketSink> sink = DynamicCast<PacketSink> (sinkApp.Get (0));
+  std::cout << "Throughput:        " << sink->GetTotalRx () * 8 / simTime / 1e9 << " Gbps" << std::endl;
+  std::cout << "Events processed:  " << Simulator::GetEventCount () << std::endl;
+  std::cout << "Wall clock time:   " << elapsed << " ms" << std::endl;
+
+  Simulator::Destroy ();
+  return 0;
+}
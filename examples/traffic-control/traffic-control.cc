@@ -171,7 +171,7 @@ main (int argc, char *argv[])
   Simulator::Run ();
 
   Ptr<Ipv4FlowClassifier> classifier = DynamicCast<Ipv4FlowClassifier> (flowmon.GetClassifier ());
-  std::map<FlowId, FlowMonitor::FlowStats> stats = monitor->GetFlowStats ();
+  FlowMonitor::FlowStatsContainer stats = monitor->GetFlowStats ();
   std::cout << std::endl << "*** Flow monitor statistics ***" << std::endl;
   std::cout << "  Tx Packets/Bytes:   " << stats[1].txPackets
             << " / " << stats[1].txBytes << std::endl;
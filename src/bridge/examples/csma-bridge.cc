@@ -58,7 +58,10 @@ main (int argc, char *argv[])
   // Allow the user to override any of the defaults and the above Bind() at
   // run-time, via command-line arguments
   //
+  bool populateArpCache = false;
+
   CommandLine cmd;
+  cmd.AddValue ("populateArpCache", "Fill the ARP caches of the terminals before the simulation", populateArpCache);
   cmd.Parse (argc, argv);
 
   //
@@ -104,6 +107,16 @@ main (int argc, char *argv[])
   ipv4.SetBase ("10.1.1.0", "255.255.255.0");
   ipv4.Assign (terminalDevices);
 
+  //
+  // Optionally, skip the ARP resolution across the bridge by filling the ARP
+  // caches of the terminals from the topology.
+  //
+  if (populateArpCache)
+    {
+      NeighborCacheHelper neighborCache;
+      neighborCache.PopulateNeighborCache (terminalDevices);
+    }
+
   //
   // Create an OnOff application to send UDP datagrams from node zero to node 1.
   //
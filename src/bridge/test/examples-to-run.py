@@ -9,6 +9,7 @@
 # See test.py for more information.
 cpp_examples = [
     ("csma-bridge", "True", "True"),
+    ("csma-bridge --populateArpCache=1", "True", "True"),
     ("csma-bridge-one-hop", "True", "True"),
 ]
 
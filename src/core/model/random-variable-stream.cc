@@ -36,6 +36,7 @@
 #include "unused.h"
 #include <cmath>
 #include <iostream>
+#include <unordered_set>
 
 /**
  * \file
@@ -49,6 +50,24 @@ NS_LOG_COMPONENT_DEFINE ("RandomVariableStream");
 
 NS_OBJECT_ENSURE_REGISTERED (RandomVariableStream);
 
+/**
+ * \ingroup randomvariable
+ * Get the set of the existing streams, restarted by
+ * RandomVariableStream::ResetAllStreams.
+ *
+ * The set is never deleted, since streams can be destroyed during the
+ * destruction of the static objects.
+ *
+ * \returns The set of the existing streams.
+ */
+static std::unordered_set<RandomVariableStream *> &
+GetAllStreams (void)
+{
+  static std::unordered_set<RandomVariableStream *> *streams =
+    new std::unordered_set<RandomVariableStream *> ();
+  return *streams;
+}
+
 TypeId 
 RandomVariableStream::GetTypeId (void)
 {
@@ -76,10 +95,12 @@ RandomVariableStream::RandomVariableStream()
   : m_rng (0)
 {
   NS_LOG_FUNCTION (this);
+  GetAllStreams ().insert (this);
 }
 RandomVariableStream::~RandomVariableStream()
 {
   NS_LOG_FUNCTION (this);
+  GetAllStreams ().erase (this);
   delete m_rng;
 }
 
@@ -108,20 +129,18 @@ RandomVariableStream::SetStream (int64_t stream)
       // number assignment.
       uint64_t nextStream = RngSeedManager::GetNextStreamIndex ();
       NS_ASSERT(nextStream <= ((1ULL)<<63));
-      m_rng = new RngStream (RngSeedManager::GetSeed (),
-                             nextStream,
-                             RngSeedManager::GetRun ());
+      m_streamIndex = nextStream;
     }
   else
     {
       // The last 2^63 streams are reserved for deterministic stream
       // number assignment.
       uint64_t base = ((1ULL)<<63);
-      uint64_t target = base + stream;
-      m_rng = new RngStream (RngSeedManager::GetSeed (),
-                             target,
-                             RngSeedManager::GetRun ());
+      m_streamIndex = base + stream;
     }
+  m_rng = new RngStream (RngSeedManager::GetSeed (),
+                         m_streamIndex,
+                         RngSeedManager::GetRun ());
   m_stream = stream;
 }
 int64_t
@@ -138,6 +157,34 @@ RandomVariableStream::Peek(void) const
   return m_rng;
 }
 
+void
+RandomVariableStream::ResetAllStreams (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  std::unordered_set<RandomVariableStream *> &streams = GetAllStreams ();
+  for (std::unordered_set<RandomVariableStream *>::iterator i = streams.begin ();
+       i != streams.end (); ++i)
+    {
+      RandomVariableStream *stream = *i;
+      if (stream->m_rng == 0)
+        {
+          // the stream number is not set yet
+          continue;
+        }
+      delete stream->m_rng;
+      stream->m_rng = new RngStream (RngSeedManager::GetSeed (),
+                                     stream->m_streamIndex,
+                                     RngSeedManager::GetRun ());
+      stream->DoResetStream ();
+    }
+}
+
+void
+RandomVariableStream::DoResetStream (void)
+{
+  NS_LOG_FUNCTION (this);
+}
+
 NS_OBJECT_ENSURE_REGISTERED(UniformRandomVariable);
 
 TypeId 
@@ -779,6 +826,13 @@ NormalRandomVariable::GetInteger (void)
   return (uint32_t)GetValue (m_mean, m_variance, m_bound);
 }
 
+void
+NormalRandomVariable::DoResetStream (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_nextValid = false;
+}
+
 NS_OBJECT_ENSURE_REGISTERED(LogNormalRandomVariable);
 
 TypeId 
@@ -1029,6 +1083,13 @@ GammaRandomVariable::GetInteger (void)
   return (uint32_t)GetValue (m_alpha, m_beta);
 }
 
+void
+GammaRandomVariable::DoResetStream (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_nextValid = false;
+}
+
 double 
 GammaRandomVariable::GetNormalValue (double mean, double variance, double bound)
 {
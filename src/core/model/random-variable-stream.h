@@ -137,6 +137,18 @@ public:
    */
   bool IsAntithetic(void) const;
 
+  /**
+   * \brief Restart all the existing streams.
+   *
+   * The underlying RngStream of each existing RandomVariableStream is
+   * created again from the current seed and run number, keeping its
+   * stream number, as if the RandomVariableStream was created now.
+   * This allows a process forked after the simulation setup to draw
+   * values independent from those of the other processes, by changing
+   * the run number before calling this method.
+   */
+  static void ResetAllStreams (void);
+
   /**
    * \brief Get the next random value as a double drawn from the distribution.
    * \return A floating point random value.
@@ -156,6 +168,15 @@ protected:
    */
   RngStream *Peek(void) const;
 
+  /**
+   * \brief Discard the state derived from the values previously drawn.
+   *
+   * Called by ResetAllStreams() after the underlying RngStream is
+   * created again; the random variables which keep values for the next
+   * calls must override it to discard them.
+   */
+  virtual void DoResetStream (void);
+
 private:
   /**
    * Copy constructor.  These objects are not copyable.
@@ -187,6 +208,9 @@ private:
   /** The stream number for the RngStream. */
   int64_t m_stream;
 
+  /** The index of the RngStream, automatically assigned or derived from m_stream. */
+  uint64_t m_streamIndex;
+
 };  // class RandomVariableStream
 
   
@@ -1235,6 +1259,9 @@ public:
   virtual uint32_t GetInteger (void);
 
 private:
+  // Inherited from RandomVariableStream
+  virtual void DoResetStream (void);
+
   /** The mean value for the normal distribution returned by this RNG stream. */
   double m_mean;
 
@@ -1594,6 +1621,9 @@ public:
   virtual uint32_t GetInteger (void);
 
 private:
+  // Inherited from RandomVariableStream
+  virtual void DoResetStream (void);
+
   /**
    * \brief Returns a random double from a normal distribution with the specified mean, variance, and bound.
    * \param [in] mean Mean value for the normal distribution.
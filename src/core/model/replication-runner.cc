@@ -0,0 +1,266 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include <map>
+#include <sstream>
+#include <iostream>
+#include <cstdio>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include "replication-runner.h"
+#include "rng-seed-manager.h"
+#include "random-variable-stream.h"
+#include "simulator.h"
+#include "fatal-error.h"
+#include "log.h"
+
+/**
+ * \file
+ * \ingroup randomvariable
+ * ns3::ReplicationRunner implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ReplicationRunner");
+
+std::string
+ReplicationRunner::Replication::GetLabel (void) const
+{
+  std::ostringstream oss;
+  if (!settings.empty ())
+    {
+      oss << "config" << configuration << "-";
+    }
+  oss << "run" << run;
+  return oss.str ();
+}
+
+ReplicationRunner::ReplicationRunner ()
+  : m_replications (1),
+    m_firstRun (1),
+    m_jobs (0),
+    m_commandLine (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+ReplicationRunner::SetReplications (uint32_t replications)
+{
+  NS_LOG_FUNCTION (this << replications);
+  m_replications = replications;
+}
+
+void
+ReplicationRunner::SetFirstRun (uint64_t run)
+{
+  NS_LOG_FUNCTION (this << run);
+  m_firstRun = run;
+}
+
+void
+ReplicationRunner::SetJobs (uint32_t jobs)
+{
+  NS_LOG_FUNCTION (this << jobs);
+  m_jobs = jobs;
+}
+
+void
+ReplicationRunner::AddSweep (const std::string &name, const std::vector<std::string> &values)
+{
+  NS_LOG_FUNCTION (this << name << values.size ());
+  m_sweeps.push_back (std::make_pair (name, values));
+}
+
+bool
+ReplicationRunner::ParseSweep (std::string sweep)
+{
+  NS_LOG_FUNCTION (this << sweep);
+  std::string::size_type equal = sweep.find ("=");
+  if (equal == std::string::npos || equal == 0)
+    {
+      return false;
+    }
+  std::vector<std::string> values;
+  std::string::size_type cur = equal + 1;
+  std::string::size_type next;
+  while ((next = sweep.find (",", cur)) != std::string::npos)
+    {
+      values.push_back (sweep.substr (cur, next - cur));
+      cur = next + 1;
+    }
+  values.push_back (sweep.substr (cur));
+  AddSweep (sweep.substr (0, equal), values);
+  return true;
+}
+
+void
+ReplicationRunner::AddArguments (CommandLine &cmd)
+{
+  NS_LOG_FUNCTION (this << &cmd);
+  cmd.AddValue ("replications", "Number of replications of each configuration", m_replications);
+  cmd.AddValue ("jobs", "Number of replications run at the same time (0 for the number of processors)", m_jobs);
+  cmd.AddValue ("firstRun", "Run number of the first replication of each configuration", m_firstRun);
+  cmd.AddValue ("sweep", "Values of an argument in the configurations, as name=value1,value2,... (may be repeated)",
+                MakeCallback (&ReplicationRunner::ParseSweep, this));
+  m_commandLine = &cmd;
+}
+
+std::vector<ReplicationRunner::Replication>
+ReplicationRunner::GetReplications (void) const
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t nConfigurations = 1;
+  for (uint32_t i = 0; i < m_sweeps.size (); i++)
+    {
+      nConfigurations *= m_sweeps[i].second.size ();
+    }
+
+  std::vector<Replication> replications;
+  for (uint32_t configuration = 0; configuration < nConfigurations; configuration++)
+    {
+      Replication replication;
+      replication.configuration = configuration;
+      // the values of the last sweep change first
+      uint32_t rest = configuration;
+      replication.settings.resize (m_sweeps.size ());
+      for (uint32_t i = m_sweeps.size (); i-- > 0; )
+        {
+          const std::vector<std::string> &values = m_sweeps[i].second;
+          replication.settings[i] = std::make_pair (m_sweeps[i].first, values[rest % values.size ()]);
+          rest /= values.size ();
+        }
+      for (uint32_t r = 0; r < m_replications; r++)
+        {
+          replication.index = replications.size ();
+          replication.run = m_firstRun + r;
+          replications.push_back (replication);
+        }
+    }
+  return replications;
+}
+
+void
+ReplicationRunner::RunReplication (Callback<void, const Replication &> replication,
+                                   const Replication &current)
+{
+  NS_LOG_FUNCTION (this << current.index);
+  RngSeedManager::SetRun (current.run);
+  RandomVariableStream::ResetAllStreams ();
+
+  if (!current.settings.empty ())
+    {
+      CommandLine local;
+      CommandLine *cmd = m_commandLine ? m_commandLine : &local;
+      std::vector<std::string> args;
+      args.push_back (cmd->GetName ());
+      for (uint32_t i = 0; i < current.settings.size (); i++)
+        {
+          args.push_back ("--" + current.settings[i].first + "=" + current.settings[i].second);
+        }
+      cmd->Parse (args);
+    }
+
+  replication (current);
+}
+
+uint32_t
+ReplicationRunner::Run (Callback<void, const Replication &> replication)
+{
+  NS_LOG_FUNCTION (this);
+  std::vector<Replication> replications = GetReplications ();
+  uint32_t jobs = m_jobs;
+  if (jobs == 0)
+    {
+      long processors = sysconf (_SC_NPROCESSORS_ONLN);
+      jobs = processors > 0 ? processors : 1;
+    }
+
+  /// pid of the process --> index of its replication
+  std::map<pid_t, uint32_t> running;
+  uint32_t next = 0;
+  uint32_t failed = 0;
+  while (next < replications.size () || !running.empty ())
+    {
+      if (next < replications.size () && running.size () < jobs)
+        {
+          // do not write the buffered output again in the new process
+          std::cout.flush ();
+          std::cerr.flush ();
+          std::fflush (0);
+          pid_t pid = fork ();
+          if (pid < 0)
+            {
+              NS_FATAL_ERROR ("Could not fork replication " << next << ": " << std::strerror (errno));
+            }
+          if (pid == 0)
+            {
+              RunReplication (replication, replications[next]);
+              // the process exits without running the destructors, so
+              // release the objects of the simulation, and the files
+              // they hold, such as those of the trace helpers
+              Simulator::Destroy ();
+              std::cout.flush ();
+              std::cerr.flush ();
+              std::fflush (0);
+              _exit (0);
+            }
+          NS_LOG_INFO ("Replication " << replications[next].GetLabel () << " started, pid " << pid);
+          running[pid] = next++;
+          continue;
+        }
+
+      // only wait for the replications, the other child processes
+      // being left to the caller
+      int status;
+      std::map<pid_t, uint32_t>::iterator it;
+      for (it = running.begin (); it != running.end (); it++)
+        {
+          pid_t pid = waitpid (it->first, &status, WNOHANG);
+          if (pid == it->first)
+            {
+              break;
+            }
+          if (pid < 0 && errno != EINTR)
+            {
+              NS_FATAL_ERROR ("Could not wait for replication " << it->second << ": " << std::strerror (errno));
+            }
+        }
+      if (it == running.end ())
+        {
+          // none of the replications is done yet
+          usleep (10000);
+          continue;
+        }
+      if (!WIFEXITED (status) || WEXITSTATUS (status) != 0)
+        {
+          NS_LOG_WARN ("Replication " << replications[it->second].GetLabel () << " failed");
+          failed++;
+        }
+      else
+        {
+          NS_LOG_INFO ("Replication " << replications[it->second].GetLabel () << " done");
+        }
+      running.erase (it);
+    }
+  return failed;
+}
+
+} // namespace ns3
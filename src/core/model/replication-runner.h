@@ -0,0 +1,184 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef REPLICATION_RUNNER_H
+#define REPLICATION_RUNNER_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <utility>
+
+#include "callback.h"
+#include "command-line.h"
+
+/**
+ * \file
+ * \ingroup randomvariable
+ * ns3::ReplicationRunner declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup randomvariable
+ * \brief Run independent replications of a simulation in parallel processes.
+ *
+ * A simulation campaign is made of configurations, each of them being
+ * replicated with distinct run numbers (see RngSeedManager::SetRun).  The
+ * configurations are the combinations of the values of the sweeps, each
+ * sweep giving the values of a command line argument: a program argument
+ * of the CommandLine, an attribute default value or a global value.  The
+ * replications of every configuration use the same run numbers, starting
+ * from the first run number.
+ *
+ * Run() forks a process for each replication, running at most the
+ * given number of jobs at the same time.  Since the processes are forked
+ * when Run() is called, the simulation setup done before, such as the
+ * topology construction, is shared by the replications, the memory being
+ * only copied when written.  In each process, the run number is set, all
+ * the existing random variables are restarted from it (see
+ * RandomVariableStream::ResetAllStreams), the command line arguments of
+ * the configuration are parsed and the replication callback is invoked,
+ * which should run the simulation and write its results.  Hence the
+ * random values drawn before Run() are the same in all the replications,
+ * and the arguments of the configuration only change the objects created
+ * afterwards, as well as the program variables read by the callback.
+ *
+ * The results of a replication are written by its process, typically to
+ * files named from the label of the replication, and merged afterwards,
+ * e.g., with SqliteDataOutput::Merge.  When the callback returns, the
+ * process calls Simulator::Destroy, which releases the objects of the
+ * simulation and the files they hold, and exits without calling the
+ * destructors of the static objects, so the files held by static objects
+ * should be closed by the callback.  Run() only waits for the processes
+ * of the replications, so the caller may have other child processes.
+ *
+ * \code
+ *   CommandLine cmd;
+ *   ReplicationRunner runner;
+ *   cmd.AddValue ("nPackets", "Number of packets", nPackets);
+ *   runner.AddArguments (cmd);
+ *   cmd.Parse (argc, argv);
+ *
+ *   BuildTopology ();
+ *   runner.Run (MakeCallback (&RunReplication));
+ * \endcode
+ *
+ * with, e.g.,
+ *
+ * \verbatim
+   ./waf --run "my-program --replications=10 --jobs=4 --sweep=nPackets=10,100"
+   \endverbatim
+ *
+ * utils/run-replications.py runs the replications of a program which
+ * does not use this class, as distinct processes started from the
+ * beginning.
+ */
+class ReplicationRunner
+{
+public:
+  /** A replication of a configuration */
+  struct Replication
+  {
+    uint32_t index;         //!< Index of the replication in the campaign
+    uint32_t configuration; //!< Index of the configuration
+    uint64_t run;           //!< Run number
+    /** Command line arguments of the configuration, as (name, value) pairs */
+    std::vector<std::pair<std::string, std::string> > settings;
+
+    /**
+     * \brief Get a label identifying the replication, e.g., for file names
+     * \returns "run<run>", prefixed by "config<configuration>-" if
+     *          there are several configurations
+     */
+    std::string GetLabel (void) const;
+  };
+
+  ReplicationRunner ();
+
+  /**
+   * \brief Set the number of replications of each configuration
+   * \param [in] replications The number of replications
+   */
+  void SetReplications (uint32_t replications);
+  /**
+   * \brief Set the run number of the first replication of each configuration
+   * \param [in] run The run number
+   */
+  void SetFirstRun (uint64_t run);
+  /**
+   * \brief Set the number of replications run at the same time
+   * \param [in] jobs The number of processes, 0 for the number of processors
+   */
+  void SetJobs (uint32_t jobs);
+  /**
+   * \brief Add a sweep of the values of a command line argument
+   * \param [in] name The name of the argument, without the leading "--"
+   * \param [in] values The values of the argument
+   */
+  void AddSweep (const std::string &name, const std::vector<std::string> &values);
+  /**
+   * \brief Add a sweep from its command line description
+   * \param [in] sweep The sweep, as "name=value1,value2,..."
+   * \returns true if the sweep could be parsed
+   */
+  bool ParseSweep (std::string sweep);
+
+  /**
+   * \brief Add the arguments of the runner to a CommandLine
+   *
+   * The arguments are \c --replications, \c --jobs, \c --firstRun and
+   * \c --sweep, which may be repeated.  The CommandLine is also used to
+   * parse the arguments of the configurations.
+   *
+   * \param [in] cmd The CommandLine
+   */
+  void AddArguments (CommandLine &cmd);
+
+  /**
+   * \brief Get the replications of the campaign
+   * \returns The replications, ordered by configuration and run number
+   */
+  std::vector<Replication> GetReplications (void) const;
+
+  /**
+   * \brief Run the replications
+   * \param [in] replication The callback running a replication, invoked
+   *             in the process of the replication
+   * \returns The number of replications whose process failed
+   */
+  uint32_t Run (Callback<void, const Replication &> replication);
+
+private:
+  /**
+   * \brief Run a replication in the current process
+   * \param [in] replication The callback running a replication
+   * \param [in] current The replication
+   */
+  void RunReplication (Callback<void, const Replication &> replication,
+                       const Replication &current);
+
+  uint32_t m_replications;   //!< Number of replications of each configuration
+  uint64_t m_firstRun;       //!< Run number of the first replication
+  uint32_t m_jobs;           //!< Number of replications run at the same time
+  /** The sweeps, as (name, values) pairs */
+  std::vector<std::pair<std::string, std::vector<std::string> > > m_sweeps;
+  CommandLine *m_commandLine; //!< CommandLine parsing the arguments of the configurations
+};
+
+} // namespace ns3
+
+#endif /* REPLICATION_RUNNER_H */
@@ -0,0 +1,402 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include <algorithm>
+#include "timer-wheel.h"
+#include "log.h"
+#include "abort.h"
+
+/**
+ * \file
+ * \ingroup timer
+ * ns3::TimerWheel and ns3::WheelTimer implementations.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TimerWheel");
+
+NS_OBJECT_ENSURE_REGISTERED (TimerWheel);
+
+TypeId
+TimerWheel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TimerWheel")
+    .SetParent<Object> ()
+    .SetGroupName ("Core")
+    .AddConstructor<TimerWheel> ()
+    .AddAttribute ("Granularity",
+                   "Width of a slot of the first level of the wheel. The timers "
+                   "are handed to the simulator once their expiration time is "
+                   "less than Granularity in the future.",
+                   TimeValue (MilliSeconds (1)),
+                   MakeTimeAccessor (&TimerWheel::m_granularity),
+                   MakeTimeChecker ())
+  ;
+  return tid;
+}
+
+TimerWheel::TimerWheel ()
+  : m_now (0),
+    m_nPending (0),
+    m_eventTick (0),
+    m_nRemoved (0),
+    m_nScheduled (0),
+    m_nCancelled (0)
+{
+  NS_LOG_FUNCTION (this);
+  std::fill (m_slots, m_slots + LEVELS * SLOTS, (WheelTimer *) 0);
+  std::fill (m_occupied, m_occupied + LEVELS, 0);
+}
+
+TimerWheel::~TimerWheel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+TimerWheel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_event.Cancel ();
+  for (uint32_t i = 0; i < LEVELS * SLOTS; i++)
+    {
+      WheelTimer *timer = Unlink (i);
+      while (timer != 0)
+        {
+          WheelTimer *next = timer->m_next;
+          timer->m_impl = 0;
+          timer = next;
+        }
+    }
+  m_nPending = 0;
+  Object::DoDispose ();
+}
+
+Time
+TimerWheel::GetGranularity (void) const
+{
+  return m_granularity;
+}
+
+uint32_t
+TimerWheel::GetNPending (void) const
+{
+  return m_nPending;
+}
+
+uint64_t
+TimerWheel::GetNRemoved (void) const
+{
+  return m_nRemoved;
+}
+
+uint64_t
+TimerWheel::GetNScheduled (void) const
+{
+  return m_nScheduled;
+}
+
+uint64_t
+TimerWheel::GetNCancelled (void) const
+{
+  return m_nCancelled;
+}
+
+void
+TimerWheel::Insert (WheelTimer *timer)
+{
+  NS_LOG_FUNCTION (this << timer << timer->m_expiry);
+  NS_ABORT_MSG_IF (!m_granularity.IsStrictlyPositive (), "The granularity of the timer wheel must be positive");
+
+  int64_t granularity = m_granularity.GetTimeStep ();
+  uint64_t nowTick = Simulator::Now ().GetTimeStep () / granularity;
+  timer->m_tick = timer->m_expiry.GetTimeStep () / granularity;
+
+  if (m_nPending == 0)
+    {
+      m_now = nowTick;
+    }
+  // the timers expiring in the current slot, or beyond the last level, are
+  // directly handed to the simulator
+  if (timer->m_tick <= nowTick || ((timer->m_tick ^ m_now) >> (BITS * LEVELS)) != 0)
+    {
+      Hand (timer);
+      return;
+    }
+
+  uint64_t tick = Link (timer);
+  if (!m_event.IsRunning () || tick < m_eventTick)
+    {
+      m_event.Cancel ();
+      m_eventTick = tick;
+      Time delay = TimeStep (std::max (tick * granularity, nowTick * granularity)) - Simulator::Now ();
+      m_event = Simulator::Schedule (std::max (delay, Seconds (0)), &TimerWheel::Process, this);
+    }
+}
+
+uint64_t
+TimerWheel::Link (WheelTimer *timer)
+{
+  // the level is the one of the most significant slot index which differs
+  // from the one of the current tick
+  uint64_t diff = timer->m_tick ^ m_now;
+  uint32_t level = 0;
+  while (level < LEVELS - 1 && (diff >> (BITS * (level + 1))) != 0)
+    {
+      level++;
+    }
+  uint32_t slot = (timer->m_tick >> (BITS * level)) & (SLOTS - 1);
+  uint32_t index = level * SLOTS + slot;
+
+  timer->m_index = index;
+  timer->m_prev = 0;
+  timer->m_next = m_slots[index];
+  if (m_slots[index] != 0)
+    {
+      m_slots[index]->m_prev = timer;
+    }
+  m_slots[index] = timer;
+  m_occupied[level] |= (uint64_t (1) << slot);
+  timer->m_linked = true;
+  m_nPending++;
+
+  return (timer->m_tick >> (BITS * level)) << (BITS * level);
+}
+
+void
+TimerWheel::Remove (WheelTimer *timer)
+{
+  NS_LOG_FUNCTION (this << timer);
+  NS_ASSERT (timer->m_linked);
+  if (timer->m_prev != 0)
+    {
+      timer->m_prev->m_next = timer->m_next;
+    }
+  else
+    {
+      m_slots[timer->m_index] = timer->m_next;
+      if (timer->m_next == 0)
+        {
+          m_occupied[timer->m_index / SLOTS] &= ~(uint64_t (1) << (timer->m_index % SLOTS));
+        }
+    }
+  if (timer->m_next != 0)
+    {
+      timer->m_next->m_prev = timer->m_prev;
+    }
+  timer->m_linked = false;
+  m_nPending--;
+  m_nRemoved++;
+}
+
+WheelTimer *
+TimerWheel::Unlink (uint32_t index)
+{
+  WheelTimer *head = m_slots[index];
+  m_slots[index] = 0;
+  m_occupied[index / SLOTS] &= ~(uint64_t (1) << (index % SLOTS));
+  for (WheelTimer *timer = head; timer != 0; timer = timer->m_next)
+    {
+      timer->m_linked = false;
+      m_nPending--;
+    }
+  return head;
+}
+
+void
+TimerWheel::Hand (WheelTimer *timer)
+{
+  NS_LOG_FUNCTION (this << timer);
+  m_nScheduled++;
+  timer->m_event = Simulator::Schedule (timer->m_expiry - Simulator::Now (), &WheelTimer::Expire, timer);
+}
+
+uint64_t
+TimerWheel::GetNextTick (void) const
+{
+  uint64_t next = ~uint64_t (0);
+  for (uint32_t level = 0; level < LEVELS; level++)
+    {
+      if (m_occupied[level] == 0)
+        {
+          continue;
+        }
+      // the timers of the first level may expire in the current slot, the
+      // ones of the upper levels are all in slots after the current one
+      uint32_t current = (m_now >> (BITS * level)) & (SLOTS - 1);
+      uint64_t mask = (level == 0 ? ~uint64_t (0) << current :
+                       (current == SLOTS - 1 ? 0 : ~uint64_t (0) << (current + 1)));
+      uint64_t occupied = m_occupied[level] & mask;
+      NS_ASSERT_MSG (occupied == m_occupied[level], "Timers left behind the current tick");
+      if (occupied == 0)
+        {
+          continue;
+        }
+      uint32_t slot = 0;
+      while ((occupied & 1) == 0)
+        {
+          occupied >>= 1;
+          slot++;
+        }
+      uint64_t base = (m_now >> (BITS * (level + 1))) << (BITS * (level + 1));
+      next = std::min (next, base | (uint64_t (slot) << (BITS * level)));
+    }
+  return next;
+}
+
+void
+TimerWheel::Process (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint64_t nowTick = Simulator::Now ().GetTimeStep () / m_granularity.GetTimeStep ();
+
+  while (m_nPending > 0)
+    {
+      uint64_t tick = GetNextTick ();
+      if (tick > nowTick)
+        {
+          break;
+        }
+      m_now = tick;
+
+      // move the timers of the upper level slots starting at this tick to
+      // the lower levels, from the highest level down, then hand the timers
+      // of the first level slot to the simulator
+      for (uint32_t level = LEVELS - 1; level > 0; level--)
+        {
+          if ((tick & ((uint64_t (1) << (BITS * level)) - 1)) != 0)
+            {
+              continue;
+            }
+          uint32_t index = level * SLOTS + ((tick >> (BITS * level)) & (SLOTS - 1));
+          WheelTimer *timer = Unlink (index);
+          while (timer != 0)
+            {
+              WheelTimer *next = timer->m_next;
+              Link (timer);
+              timer = next;
+            }
+        }
+      WheelTimer *timer = Unlink (tick & (SLOTS - 1));
+      NS_LOG_LOGIC ("Processing tick " << tick);
+      while (timer != 0)
+        {
+          WheelTimer *next = timer->m_next;
+          Hand (timer);
+          timer = next;
+        }
+    }
+  m_now = std::max (m_now, nowTick);
+
+  if (m_nPending > 0)
+    {
+      m_eventTick = GetNextTick ();
+      m_event = Simulator::Schedule (TimeStep (m_eventTick * m_granularity.GetTimeStep ()) - Simulator::Now (),
+                                     &TimerWheel::Process, this);
+    }
+}
+
+
+WheelTimer::WheelTimer ()
+  : m_wheel (0),
+    m_impl (0),
+    m_event (),
+    m_expiry (Seconds (0)),
+    m_tick (0),
+    m_prev (0),
+    m_next (0),
+    m_index (0),
+    m_linked (false)
+{
+}
+
+WheelTimer::~WheelTimer ()
+{
+  Cancel ();
+}
+
+void
+WheelTimer::SetWheel (Ptr<TimerWheel> wheel)
+{
+  NS_ASSERT_MSG (!IsRunning (), "Can not change the wheel of a running timer");
+  m_wheel = wheel;
+}
+
+Ptr<TimerWheel>
+WheelTimer::GetWheel (void) const
+{
+  return m_wheel;
+}
+
+void
+WheelTimer::DoSchedule (Time const &delay, EventImpl *event)
+{
+  Cancel ();
+  m_impl = Ptr<EventImpl> (event, false);
+  m_expiry = Simulator::Now () + delay;
+  m_wheel->Insert (this);
+}
+
+void
+WheelTimer::Cancel (void)
+{
+  if (m_linked)
+    {
+      m_wheel->Remove (this);
+    }
+  else if (m_event.IsRunning ())
+    {
+      m_event.Cancel ();
+      if (m_wheel != 0)
+        {
+          m_wheel->m_nCancelled++;
+        }
+    }
+  m_impl = 0;
+}
+
+bool
+WheelTimer::IsRunning (void) const
+{
+  return m_linked || m_event.IsRunning ();
+}
+
+bool
+WheelTimer::IsExpired (void) const
+{
+  return !IsRunning ();
+}
+
+Time
+WheelTimer::GetDelayLeft (void) const
+{
+  if (m_linked)
+    {
+      return m_expiry - Simulator::Now ();
+    }
+  return Simulator::GetDelayLeft (m_event);
+}
+
+void
+WheelTimer::Expire (void)
+{
+  // the event may rearm the timer
+  Ptr<EventImpl> impl = m_impl;
+  m_impl = 0;
+  impl->Invoke ();
+}
+
+} // namespace ns3
@@ -0,0 +1,284 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include "object.h"
+#include "nstime.h"
+#include "event-id.h"
+#include "event-impl.h"
+#include "make-event.h"
+#include "simulator.h"
+
+/**
+ * \file
+ * \ingroup timer
+ * ns3::TimerWheel and ns3::WheelTimer declarations.
+ */
+
+namespace ns3 {
+
+class WheelTimer;
+
+/**
+ * \ingroup timer
+ * \brief Hierarchical timing wheel holding timers which are rearmed
+ *        frequently and rarely expire.
+ *
+ * Protocol timers, such as the retransmission timer of a transport
+ * protocol, are typically pushed back every time some progress is made and
+ * hardly ever expire. Scheduling them directly in the simulator costs an
+ * event list insertion and a cancelled event for every rearm.
+ *
+ * The timers of a WheelTimer attached to a TimerWheel are instead linked in
+ * the slots of a hierarchy of wheels of 64 slots each, where a slot of the
+ * first level covers Granularity of time and a slot of level n covers 64
+ * slots of level n-1. Arming, rearming and cancelling a timer is a constant
+ * time list operation. A single simulator event is kept for the earliest
+ * non-empty slot: when the slot is reached, the timers of an upper level
+ * are moved to the lower levels and the timers of the first level are
+ * handed to the simulator, i.e., a simulator event is scheduled only for
+ * the timers still armed less than Granularity before their expiration
+ * time. Hence the timers expire at their exact expiration time.
+ */
+class TimerWheel : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  TimerWheel ();
+  virtual ~TimerWheel ();
+
+  /**
+   * \brief Get the width of a slot of the first level
+   * \returns the granularity of the wheel
+   */
+  Time GetGranularity (void) const;
+  /**
+   * \brief Get the number of timers in the wheel
+   * \returns the number of armed timers not handed to the simulator yet
+   */
+  uint32_t GetNPending (void) const;
+  /**
+   * \brief Get the number of timers removed from the wheel
+   *
+   * Each of these timers has been rearmed or cancelled before being handed
+   * to the simulator, which saved the insertion and the cancellation of a
+   * simulator event.
+   *
+   * \returns the number of timers cancelled or rearmed in the wheel
+   */
+  uint64_t GetNRemoved (void) const;
+  /**
+   * \brief Get the number of timers handed to the simulator
+   * \returns the number of simulator events scheduled for the timers
+   */
+  uint64_t GetNScheduled (void) const;
+  /**
+   * \brief Get the number of timers cancelled after being handed to the simulator
+   * \returns the number of simulator events cancelled for the timers
+   */
+  uint64_t GetNCancelled (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  friend class WheelTimer;
+
+  /**
+   * \brief Arm a timer whose expiration time is set
+   * \param timer the timer
+   */
+  void Insert (WheelTimer *timer);
+  /**
+   * \brief Remove a timer from the slot it is linked in
+   * \param timer the timer
+   */
+  void Remove (WheelTimer *timer);
+  /**
+   * \brief Link a timer in the slot of its tick, relative to the current tick
+   * \param timer the timer
+   * \returns the tick at which the slot is processed
+   */
+  uint64_t Link (WheelTimer *timer);
+  /**
+   * \brief Unlink all the timers of a slot
+   * \param index the index of the slot
+   * \returns the timers of the slot
+   */
+  WheelTimer * Unlink (uint32_t index);
+  /**
+   * \brief Hand a timer to the simulator
+   * \param timer the timer
+   */
+  void Hand (WheelTimer *timer);
+  /**
+   * \brief Get the tick at which the earliest non-empty slot is processed
+   * \returns the tick of the earliest non-empty slot
+   */
+  uint64_t GetNextTick (void) const;
+  /**
+   * \brief Process the slots reached by the current time
+   */
+  void Process (void);
+
+  static const uint32_t LEVELS = 6;  //!< Number of levels
+  static const uint32_t BITS = 6;    //!< Number of bits of the slot index of a level
+  static const uint32_t SLOTS = 64;  //!< Number of slots of a level
+
+  Time m_granularity;                   //!< Width of a slot of the first level
+  WheelTimer *m_slots[LEVELS * SLOTS];  //!< Timers of each slot
+  uint64_t m_occupied[LEVELS];          //!< Bitmap of the non-empty slots of each level
+  uint64_t m_now;                       //!< Current tick; all the slots before it have been processed
+  uint32_t m_nPending;                  //!< Number of timers in the slots
+  EventId m_event;                      //!< Event processing the earliest non-empty slot
+  uint64_t m_eventTick;                 //!< Tick of m_event
+  uint64_t m_nRemoved;                  //!< Number of timers removed from the slots
+  uint64_t m_nScheduled;                //!< Number of timers handed to the simulator
+  uint64_t m_nCancelled;                //!< Number of timers cancelled after being handed to the simulator
+};
+
+/**
+ * \ingroup timer
+ * \brief A timer which can be armed in a TimerWheel.
+ *
+ * WheelTimer is a drop-in replacement of an EventId used to hold the event
+ * of a timer: Schedule replaces Simulator::Schedule and implicitly cancels
+ * the pending expiration, if any. Without a TimerWheel, the timer is
+ * scheduled in the simulator; with a TimerWheel, it is armed in the wheel
+ * and rearming it does not touch the simulator event list.
+ */
+class WheelTimer
+{
+public:
+  WheelTimer ();
+  ~WheelTimer ();
+
+  /**
+   * \brief Set the wheel the timer is armed in
+   *
+   * The timer must not be running.
+   *
+   * \param wheel the wheel, or 0 to schedule the timer in the simulator
+   */
+  void SetWheel (Ptr<TimerWheel> wheel);
+  /**
+   * \brief Get the wheel the timer is armed in
+   * \returns the wheel, or 0
+   */
+  Ptr<TimerWheel> GetWheel (void) const;
+
+  /**
+   * \brief Arm the timer to invoke a method after a delay
+   *
+   * The pending expiration, if any, is cancelled.
+   *
+   * \tparam MEM \deduced Class method function signature type.
+   * \tparam OBJ \deduced Class type of the object.
+   * \tparam Ts \deduced Types of the arguments.
+   * \param [in] delay the delay after which the method is invoked
+   * \param [in] memPtr the pointer to the method
+   * \param [in] obj the pointer to the object
+   * \param [in] args the arguments of the method
+   */
+  template <typename MEM, typename OBJ, typename... Ts>
+  void Schedule (Time const &delay, MEM memPtr, OBJ obj, Ts... args);
+  /**
+   * \brief Cancel the pending expiration, if any
+   */
+  void Cancel (void);
+  /**
+   * \returns true if the timer is armed
+   */
+  bool IsRunning (void) const;
+  /**
+   * \returns true if the timer is not armed
+   */
+  bool IsExpired (void) const;
+  /**
+   * \returns the time left before the expiration, or zero if the timer is not armed
+   */
+  Time GetDelayLeft (void) const;
+
+private:
+  friend class TimerWheel;
+
+  /**
+   * \brief Copy constructor
+   *
+   * Defined and unimplemented to avoid misuse: the timer is linked in the wheel.
+   */
+  WheelTimer (const WheelTimer &);
+  /**
+   * \brief Copy assignment operator
+   *
+   * Defined and unimplemented to avoid misuse: the timer is linked in the wheel.
+   * \returns the timer
+   */
+  WheelTimer & operator = (const WheelTimer &);
+
+  /**
+   * \brief Arm the timer in the wheel
+   * \param delay the delay after which the event is invoked
+   * \param event the event to invoke
+   */
+  void DoSchedule (Time const &delay, EventImpl *event);
+  /**
+   * \brief Invoke the event of the timer
+   */
+  void Expire (void);
+
+  Ptr<TimerWheel> m_wheel;  //!< Wheel the timer is armed in, if any
+  Ptr<EventImpl> m_impl;    //!< Event to invoke at the expiration, with a wheel
+  EventId m_event;          //!< Simulator event of the expiration
+  Time m_expiry;            //!< Expiration time, with a wheel
+  uint64_t m_tick;          //!< Tick of the expiration time, with a wheel
+  WheelTimer *m_prev;       //!< Previous timer of the slot
+  WheelTimer *m_next;       //!< Next timer of the slot
+  uint32_t m_index;         //!< Index of the slot
+  bool m_linked;            //!< True if the timer is linked in a slot of the wheel
+};
+
+} // namespace ns3
+
+
+/********************************************************************
+ *  Implementation of the templates declared above.
+ ********************************************************************/
+
+namespace ns3 {
+
+template <typename MEM, typename OBJ, typename... Ts>
+void
+WheelTimer::Schedule (Time const &delay, MEM memPtr, OBJ obj, Ts... args)
+{
+  if (m_wheel == 0)
+    {
+      m_event.Cancel ();
+      m_event = Simulator::Schedule (delay, memPtr, obj, args...);
+      return;
+    }
+  DoSchedule (delay, MakeEvent (memPtr, obj, args...));
+}
+
+} // namespace ns3
+
+#endif /* TIMER_WHEEL_H */
@@ -0,0 +1,207 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/replication-runner.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/command-line.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+#include <fstream>
+#include <iomanip>
+#include <unistd.h>
+#include <sys/wait.h>
+
+/**
+ * \file
+ * \ingroup core-tests
+ * \ingroup randomvariable
+ * \ingroup replication-runner-tests
+ * ReplicationRunner test suite.
+ */
+
+/**
+ * \ingroup core-tests
+ * \defgroup replication-runner-tests ReplicationRunner test suite
+ */
+
+namespace ns3 {
+
+  namespace tests {
+
+
+/**
+ * \ingroup replication-runner-tests
+ *  Replications of two configurations, and of a failing one, run in
+ *  forked processes.  Each replication writes its run number, its
+ *  configuration and the values drawn from a random variable created
+ *  before the replications and from one created by the replication,
+ *  as well as a trace file closed when the simulation is destroyed.
+ *  A child process not started by the runner must be left to the caller.
+ */
+class ReplicationRunnerTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  ReplicationRunnerTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Run a replication
+   * \param [in] replication The replication
+   */
+  void RunReplication (const ReplicationRunner::Replication &replication);
+  /**
+   * Close a trace file of a replication
+   * \param [in] os The stream of the file
+   */
+  static void CloseTrace (std::ofstream *os);
+
+  std::string m_prefix;                 //!< Prefix of the files of the replications
+  uint32_t m_value;                     //!< Swept program argument
+  Ptr<UniformRandomVariable> m_before;  //!< Random variable created before the replications
+};
+
+ReplicationRunnerTestCase::ReplicationRunnerTestCase ()
+  : TestCase ("Replications in forked processes"),
+    m_value (0)
+{
+}
+
+void
+ReplicationRunnerTestCase::RunReplication (const ReplicationRunner::Replication &replication)
+{
+  if (m_value == 3)
+    {
+      _exit (1);
+    }
+  Ptr<UniformRandomVariable> after = CreateObject<UniformRandomVariable> ();
+  std::ofstream os ((m_prefix + replication.GetLabel ()).c_str ());
+  os << std::setprecision (17) << RngSeedManager::GetRun () << " " << m_value << " "
+     << m_before->GetValue () << " " << after->GetValue () << std::endl;
+
+  // the file is only written when the simulation is destroyed
+  std::ofstream *trace = new std::ofstream ((m_prefix + replication.GetLabel () + "-trace").c_str ());
+  *trace << replication.run;
+  Simulator::ScheduleDestroy (&ReplicationRunnerTestCase::CloseTrace, trace);
+}
+
+void
+ReplicationRunnerTestCase::CloseTrace (std::ofstream *os)
+{
+  delete os;
+}
+
+void
+ReplicationRunnerTestCase::DoRun (void)
+{
+  m_prefix = CreateTempDirFilename ("replication-");
+  uint64_t originalRun = RngSeedManager::GetRun ();
+  m_before = CreateObject<UniformRandomVariable> ();
+  // a value drawn before the replications does not change them
+  m_before->GetValue ();
+
+  CommandLine cmd;
+  cmd.AddValue ("value", "Swept value", m_value);
+  ReplicationRunner runner;
+  runner.AddArguments (cmd);
+  cmd.Parse (std::vector<std::string> {"test", "--replications=3", "--firstRun=5",
+                                       "--jobs=2", "--sweep=value=1,2,3"});
+
+  std::vector<ReplicationRunner::Replication> replications = runner.GetReplications ();
+  NS_TEST_ASSERT_MSG_EQ (replications.size (), 9, "Unexpected number of replications");
+  NS_TEST_EXPECT_MSG_EQ (replications[4].GetLabel (), "config1-run6", "Unexpected label");
+
+  // a child process of the caller
+  pid_t other = fork ();
+  if (other == 0)
+    {
+      _exit (7);
+    }
+  NS_TEST_ASSERT_MSG_GT (other, 0, "Could not fork");
+
+  uint32_t failed = runner.Run (MakeCallback (&ReplicationRunnerTestCase::RunReplication, this));
+  NS_TEST_EXPECT_MSG_EQ (failed, 3, "The replications of the third configuration should have failed");
+  int status = 0;
+  NS_TEST_EXPECT_MSG_EQ (waitpid (other, &status, 0), other, "The other child process should not be reaped");
+  NS_TEST_EXPECT_MSG_EQ (WIFEXITED (status) && WEXITSTATUS (status) == 7, true,
+                         "Unexpected status of the other child process");
+  NS_TEST_EXPECT_MSG_EQ (m_value, 0, "The configurations should not be parsed in this process");
+
+  double previous = -1;
+  for (uint32_t i = 0; i < 6; i++)
+    {
+      const ReplicationRunner::Replication &replication = replications[i];
+      std::ifstream is ((m_prefix + replication.GetLabel ()).c_str ());
+      NS_TEST_ASSERT_MSG_EQ (is.is_open (), true, "No result for replication " << i);
+      uint64_t run;
+      uint32_t value;
+      double before, after;
+      is >> run >> value >> before >> after;
+      NS_TEST_ASSERT_MSG_EQ (is.fail (), false, "Could not read the result of replication " << i);
+      NS_TEST_EXPECT_MSG_EQ (run, 5 + i % 3, "Unexpected run number");
+      NS_TEST_EXPECT_MSG_EQ (value, 1 + i / 3, "Unexpected configuration");
+
+      std::ifstream trace ((m_prefix + replication.GetLabel () + "-trace").c_str ());
+      uint64_t traceRun = 0;
+      trace >> traceRun;
+      NS_TEST_EXPECT_MSG_EQ (traceRun, run, "The trace file of replication " << i << " should be written");
+
+      // the random variable created before the replications is
+      // restarted from the run number of the replication
+      RngSeedManager::SetRun (run);
+      RandomVariableStream::ResetAllStreams ();
+      NS_TEST_EXPECT_MSG_EQ (before, m_before->GetValue (), "Unexpected value of replication " << i);
+      NS_TEST_EXPECT_MSG_NE (before, after, "The random variables should be distinct");
+      if (i % 3 != 0)
+        {
+          NS_TEST_EXPECT_MSG_NE (before, previous, "The runs should draw distinct values");
+        }
+      previous = before;
+    }
+
+  m_before = 0;
+  RngSeedManager::SetRun (originalRun);
+  RandomVariableStream::ResetAllStreams ();
+}
+
+
+/**
+ * \ingroup replication-runner-tests
+ *  ReplicationRunner test suite
+ */
+class ReplicationRunnerTestSuite : public TestSuite
+{
+public:
+  /** Constructor. */
+  ReplicationRunnerTestSuite ()
+    : TestSuite ("replication-runner")
+  {
+    AddTestCase (new ReplicationRunnerTestCase ());
+  }
+};
+
+/**
+ * \ingroup replication-runner-tests
+ * ReplicationRunnerTestSuite instance variable.
+ */
+static ReplicationRunnerTestSuite g_replicationRunnerTestSuite;
+
+
+  }  // namespace tests
+
+}  // namespace ns3
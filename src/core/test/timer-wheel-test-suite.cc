@@ -0,0 +1,272 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/timer-wheel.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+#include <vector>
+
+/**
+ * \file
+ * \ingroup core-tests
+ * \ingroup timer
+ * \ingroup timer-tests
+ * TimerWheel test suite.
+ */
+
+namespace ns3 {
+
+  namespace tests {
+
+
+/**
+ * \ingroup timer-tests
+ *  Rearmed and cancelled wheel timers
+ */
+class TimerWheelTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  TimerWheelTestCase ();
+  virtual void DoRun (void);
+  /**
+   * Function to invoke when a timer expires.
+   * \param id The identifier of the timer.
+   */
+  void Expire (uint32_t id);
+  /**
+   * Rearm a timer.
+   * \param timer The timer.
+   * \param delay The delay of the timer.
+   * \param id The identifier of the timer.
+   */
+  void Rearm (WheelTimer *timer, Time delay, uint32_t id);
+  std::vector<std::pair<uint32_t, Time> > m_expired; //!< Identifiers and expiration times of the expired timers
+};
+
+TimerWheelTestCase::TimerWheelTestCase ()
+  : TestCase ("Check that wheel timers expire at their exact expiration time")
+{
+}
+
+void
+TimerWheelTestCase::Expire (uint32_t id)
+{
+  m_expired.push_back (std::make_pair (id, Simulator::Now ()));
+}
+
+void
+TimerWheelTestCase::Rearm (WheelTimer *timer, Time delay, uint32_t id)
+{
+  timer->Schedule (delay, &TimerWheelTestCase::Expire, this, id);
+}
+
+void
+TimerWheelTestCase::DoRun (void)
+{
+  Ptr<TimerWheel> wheel = CreateObject<TimerWheel> ();
+  WheelTimer retx, delAck, far, cancelled;
+  retx.SetWheel (wheel);
+  delAck.SetWheel (wheel);
+  far.SetWheel (wheel);
+  cancelled.SetWheel (wheel);
+
+  // a timer pushed back every 100 us, as a retransmission timer on every ACK
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      Simulator::Schedule (MicroSeconds (100 * i), &TimerWheelTestCase::Rearm, this, &retx,
+                           Seconds (1) + MicroSeconds (7), 1);
+    }
+  // a timer expiring within the current slot
+  Simulator::Schedule (MicroSeconds (50), &TimerWheelTestCase::Rearm, this, &delAck, MicroSeconds (300), 2);
+  // a timer several levels up
+  far.Schedule (Seconds (300) + NanoSeconds (3), &TimerWheelTestCase::Expire, this, 3);
+  cancelled.Schedule (MilliSeconds (70), &TimerWheelTestCase::Expire, this, 4);
+  Simulator::Schedule (MilliSeconds (69) + MicroSeconds (999), &WheelTimer::Cancel, &cancelled);
+
+  NS_TEST_EXPECT_MSG_EQ (far.IsRunning (), true, "The timer should be running");
+  NS_TEST_EXPECT_MSG_EQ (far.GetDelayLeft (), Seconds (300) + NanoSeconds (3), "Wrong delay left");
+
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_expired.size (), 3, "Wrong number of expired timers");
+  NS_TEST_EXPECT_MSG_EQ (m_expired[0].first, 2, "Wrong timer expired");
+  NS_TEST_EXPECT_MSG_EQ (m_expired[0].second, MicroSeconds (350), "Wrong expiration time");
+  NS_TEST_EXPECT_MSG_EQ (m_expired[1].first, 1, "Wrong timer expired");
+  NS_TEST_EXPECT_MSG_EQ (m_expired[1].second, MicroSeconds (9900) + Seconds (1) + MicroSeconds (7), "Wrong expiration time");
+  NS_TEST_EXPECT_MSG_EQ (m_expired[2].first, 3, "Wrong timer expired");
+  NS_TEST_EXPECT_MSG_EQ (m_expired[2].second, Seconds (300) + NanoSeconds (3), "Wrong expiration time");
+  NS_TEST_EXPECT_MSG_EQ (retx.IsExpired (), true, "The timer should be expired");
+
+  // the rearms of the retransmission timer and the cancelled timer did not
+  // reach the simulator
+  NS_TEST_EXPECT_MSG_EQ (wheel->GetNRemoved (), 100, "Wrong number of timers removed from the wheel");
+  NS_TEST_EXPECT_MSG_EQ (wheel->GetNScheduled (), 3, "Wrong number of timers handed to the simulator");
+  NS_TEST_EXPECT_MSG_EQ (wheel->GetNCancelled (), 0, "Wrong number of cancelled simulator events");
+  NS_TEST_EXPECT_MSG_EQ (wheel->GetNPending (), 0, "Wrong number of pending timers");
+
+  wheel->Dispose ();
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup timer-tests
+ *  Random timers compared with the simulator
+ */
+class TimerWheelRandomTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  TimerWheelRandomTestCase ();
+  virtual void DoRun (void);
+  /**
+   * Function to invoke when a timer expires.
+   * \param id The identifier of the timer.
+   */
+  void Expire (uint32_t id);
+  /**
+   * Rearm or cancel a random timer, then schedule the next operation.
+   */
+  void Operate (void);
+  /**
+   * \returns a pseudo-random number
+   */
+  uint32_t Random (void);
+
+  static const uint32_t N_TIMERS = 64;  //!< Number of timers
+  Ptr<TimerWheel> m_wheel;              //!< The wheel
+  WheelTimer m_timers[N_TIMERS];        //!< The timers
+  Time m_expected[N_TIMERS];            //!< Expected expiration time of each timer, or zero
+  uint32_t m_nOperations;               //!< Number of operations left
+  uint32_t m_nExpired;                  //!< Number of expired timers
+  uint64_t m_state;                     //!< State of the pseudo-random generator
+};
+
+TimerWheelRandomTestCase::TimerWheelRandomTestCase ()
+  : TestCase ("Check random wheel timers against their expected expiration time"),
+    m_nOperations (20000),
+    m_nExpired (0),
+    m_state (1)
+{
+}
+
+uint32_t
+TimerWheelRandomTestCase::Random (void)
+{
+  m_state = m_state * 6364136223846793005ULL + 1442695040888963407ULL;
+  return m_state >> 33;
+}
+
+void
+TimerWheelRandomTestCase::Expire (uint32_t id)
+{
+  NS_TEST_EXPECT_MSG_EQ (Simulator::Now (), m_expected[id], "Timer " << id << " expired at the wrong time");
+  m_expected[id] = Seconds (0);
+  m_nExpired++;
+}
+
+void
+TimerWheelRandomTestCase::Operate (void)
+{
+  uint32_t id = Random () % N_TIMERS;
+  if (Random () % 8 == 0)
+    {
+      m_timers[id].Cancel ();
+      m_expected[id] = Seconds (0);
+    }
+  else
+    {
+      // delays spanning several levels of the wheel, and the current slot
+      Time delay;
+      switch (Random () % 4)
+        {
+        case 0:
+          delay = MicroSeconds (Random () % 2000);
+          break;
+        case 1:
+          delay = MicroSeconds (Random () % 200000);
+          break;
+        case 2:
+          delay = MilliSeconds (Random () % 20000);
+          break;
+        default:
+          delay = Seconds (Random () % 1000);
+          break;
+        }
+      m_timers[id].Schedule (delay, &TimerWheelRandomTestCase::Expire, this, id);
+      m_expected[id] = Simulator::Now () + delay;
+    }
+  if (--m_nOperations > 0)
+    {
+      Simulator::Schedule (MicroSeconds (Random () % 3000), &TimerWheelRandomTestCase::Operate, this);
+    }
+}
+
+void
+TimerWheelRandomTestCase::DoRun (void)
+{
+  m_wheel = CreateObject<TimerWheel> ();
+  for (uint32_t i = 0; i < N_TIMERS; i++)
+    {
+      m_timers[i].SetWheel (m_wheel);
+      m_expected[i] = Seconds (0);
+    }
+  Simulator::ScheduleNow (&TimerWheelRandomTestCase::Operate, this);
+  Simulator::Run ();
+
+  uint32_t running = 0;
+  for (uint32_t i = 0; i < N_TIMERS; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_expected[i], Seconds (0), "Timer " << i << " did not expire");
+      running += m_timers[i].IsRunning ();
+    }
+  NS_TEST_EXPECT_MSG_EQ (running, 0, "No timer should be running");
+  NS_TEST_EXPECT_MSG_GT (m_nExpired, 1000, "Too few timers expired");
+  NS_TEST_EXPECT_MSG_GT (m_wheel->GetNRemoved (), 1000, "Too few timers rearmed in the wheel");
+  NS_TEST_EXPECT_MSG_EQ (m_wheel->GetNScheduled (), m_nExpired + m_wheel->GetNCancelled (),
+                         "Each timer handed to the simulator should expire or be cancelled");
+
+  m_wheel->Dispose ();
+  m_wheel = 0;
+  Simulator::Destroy ();
+}
+
+
+/**
+ * \ingroup timer-tests
+ *  TimerWheel test suite
+ */
+class TimerWheelTestSuite : public TestSuite
+{
+public:
+  /** Constructor. */
+  TimerWheelTestSuite ()
+    : TestSuite ("timer-wheel")
+  {
+    AddTestCase (new TimerWheelTestCase ());
+    AddTestCase (new TimerWheelRandomTestCase ());
+  }
+};
+
+/**
+ * \ingroup timer-tests
+ * TimerWheelTestSuite instance variable.
+ */
+static TimerWheelTestSuite g_timerWheelTestSuite;
+
+
+  }  // namespace tests
+
+}  // namespace ns3
@@ -30,6 +30,8 @@
 #include "ns3/uinteger.h"
 #include "ns3/pointer.h"
 #include "ns3/trace-source-accessor.h"
+#include "ns3/queue-item.h"
+#include "ns3/segmentation-offload.h"
 #include "csma-net-device.h"
 #include "csma-channel.h"
 
@@ -77,6 +79,12 @@ CsmaNetDevice::GetTypeId (void)
                    PointerValue (),
                    MakePointerAccessor (&CsmaNetDevice::m_receiveErrorModel),
                    MakePointerChecker<ErrorModel> ())
+    .AddAttribute ("MaxBatchSize",
+                   "The maximum number of packets the device accepts at once "
+                   "from the traffic control layer (1 disables batching)",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&CsmaNetDevice::m_maxBatchSize),
+                   MakeUintegerChecker<uint32_t> (1))
 
     //
     // Transmit queueing discipline for the device which includes its own set
@@ -184,7 +192,8 @@ CsmaNetDevice::GetTypeId (void)
 }
 
 CsmaNetDevice::CsmaNetDevice ()
-  : m_linkUp (false)
+  : m_linkUp (false),
+    m_maxBatchSize (1)
 {
   NS_LOG_FUNCTION (this);
   m_txMachineState = READY;
@@ -961,6 +970,21 @@ CsmaNetDevice::SendFrom (Ptr<Packet> packet, const Address& src, const Address&
       return false;
     }
 
+  //
+  // A super-segment is split into segments, which are framed and queued
+  // separately.
+  //
+  std::vector<Ptr<Packet> > segments;
+  if (SegmentationOffload::Segment (packet, protocolNumber, segments))
+    {
+      bool sent = true;
+      for (auto& segment : segments)
+        {
+          sent = SendFrom (segment, src, dest, protocolNumber) && sent;
+        }
+      return sent;
+    }
+
   Mac48Address destination = Mac48Address::ConvertFrom (dest);
   Mac48Address source = Mac48Address::ConvertFrom (src);
   AddHeader (packet, source, destination, protocolNumber);
@@ -997,6 +1021,78 @@ CsmaNetDevice::SendFrom (Ptr<Packet> packet, const Address& src, const Address&
   return true;
 }
 
+uint32_t
+CsmaNetDevice::SendBatch (const std::vector<Ptr<QueueDiscItem> > &items)
+{
+  NS_LOG_FUNCTION (this << items.size ());
+
+  NS_ASSERT (IsLinkUp ());
+
+  uint32_t nSent = 0;
+  for (auto& item : items)
+    {
+      Ptr<Packet> packet = item->GetPacket ();
+      NS_LOG_LOGIC ("UID is " << packet->GetUid () << ")");
+
+      if (IsSendEnabled () == false)
+        {
+          m_macTxDropTrace (packet);
+          continue;
+        }
+
+      std::vector<Ptr<Packet> > segments;
+      if (!SegmentationOffload::Segment (packet, item->GetProtocol (), segments))
+        {
+          segments.push_back (packet);
+        }
+
+      bool sent = true;
+      Mac48Address destination = Mac48Address::ConvertFrom (item->GetAddress ());
+      for (auto& segment : segments)
+        {
+          AddHeader (segment, m_address, destination, item->GetProtocol ());
+
+          m_macTxTrace (segment);
+
+          if (m_queue->Enqueue (segment) == false)
+            {
+              m_macTxDropTrace (segment);
+              sent = false;
+            }
+        }
+      if (sent)
+        {
+          nSent++;
+        }
+    }
+
+  //
+  // Start the transmitter once for the whole batch, if the device is idle.
+  // Otherwise, the transmission will be started when the current packet
+  // finished transmission (see TransmitCompleteEvent)
+  //
+  if (m_txMachineState == READY && m_queue->IsEmpty () == false)
+    {
+      m_currentPkt = m_queue->Dequeue ();
+      m_promiscSnifferTrace (m_currentPkt);
+      m_snifferTrace (m_currentPkt);
+      TransmitStart ();
+    }
+  return nSent;
+}
+
+uint32_t
+CsmaNetDevice::GetMaxBatchSize (void) const
+{
+  return m_maxBatchSize;
+}
+
+bool
+CsmaNetDevice::SupportsSegmentationOffload (void) const
+{
+  return true;
+}
+
 Ptr<Node>
 CsmaNetDevice::GetNode (void) const
 {
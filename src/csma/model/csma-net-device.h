@@ -284,6 +284,29 @@ public:
   virtual bool SendFrom (Ptr<Packet> packet, const Address& source, const Address& dest, 
                          uint16_t protocolNumber);
 
+  /**
+   * Start sending a batch of packets down the channel. The packets are
+   * placed on the transmit queue and the transmitter is started once for
+   * the whole batch, if idle.
+   *
+   * \param items the packets to send, along with their destination and protocol number
+   * \return the number of packets successfully enqueued
+   */
+  virtual uint32_t SendBatch (const std::vector<Ptr<QueueDiscItem> > &items);
+
+  /**
+   * \return the maximum number of packets accepted by SendBatch
+   */
+  virtual uint32_t GetMaxBatchSize (void) const;
+
+  /**
+   * Super-segments are split into segments, which are framed and queued
+   * separately.
+   *
+   * \return true
+   */
+  virtual bool SupportsSegmentationOffload (void) const;
+
   /**
    * Get the node to which this device is attached.
    *
@@ -727,6 +750,11 @@ private:
    * Ethernet.
    */
   uint32_t m_mtu;
+
+  /**
+   * The maximum number of packets accepted at once by SendBatch.
+   */
+  uint32_t m_maxBatchSize;
 };
 
 } // namespace ns3
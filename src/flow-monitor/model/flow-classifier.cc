@@ -38,6 +38,11 @@ FlowClassifier::GetNewFlowId ()
   return ++m_lastNewFlowId;
 }
 
+void
+FlowClassifier::RemoveFlows (const std::unordered_set<FlowId> &flowIds)
+{
+}
+
 
 } // namespace ns3
 
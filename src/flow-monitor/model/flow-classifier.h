@@ -23,6 +23,7 @@
 
 #include "ns3/simple-ref-count.h"
 #include <ostream>
+#include <unordered_set>
 
 namespace ns3 {
 
@@ -71,6 +72,12 @@ public:
   /// \param indent number of spaces to use as base indentation level
   virtual void SerializeToXmlStream (std::ostream &os, uint16_t indent) const = 0;
 
+  /// Forget some flows, e.g., the idle flows removed from the
+  /// FlowMonitor by the streaming export: a later packet of one of
+  /// them starts a new flow, with a new FlowId.  Does nothing by default.
+  /// \param flowIds the identifiers of the flows
+  virtual void RemoveFlows (const std::unordered_set<FlowId> &flowIds);
+
 protected:
   /// Returns a new, unique Flow Identifier
   /// \returns a new FlowId
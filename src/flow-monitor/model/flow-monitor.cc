@@ -22,8 +22,13 @@
 #include "ns3/simulator.h"
 #include "ns3/log.h"
 #include "ns3/double.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/abort.h"
 #include <fstream>
 #include <sstream>
+#include <algorithm>
+#include <unordered_set>
 
 #define PERIODIC_CHECK_INTERVAL (Seconds (1))
 
@@ -69,6 +74,44 @@ FlowMonitor::GetTypeId (void)
                    TimeValue (Seconds (0.5)),
                    MakeTimeAccessor (&FlowMonitor::m_flowInterruptionsMinTime),
                    MakeTimeChecker ())
+    .AddAttribute ("HistogramMaxBins", ("The maximum number of bins of the histograms, the last bin "
+                                        "counting the values beyond it (0 means no limit)."),
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&FlowMonitor::m_histogramMaxBins),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("FlowIdleTimeout", ("When the streaming export is enabled, the flows with no packet "
+                                       "transmitted or received for this time are removed once exported, "
+                                       "and forgotten by the classifiers (0 means the flows are never removed)."),
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&FlowMonitor::m_flowIdleTimeout),
+                   MakeTimeChecker ())
+    .AddAttribute ("SketchMode", ("Whether the flows are measured with sketches of a sample of the packets, "
+                                  "in the monitor and in each probe, instead of tracking every packet. "
+                                  "Must be set before the probes are installed."),
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&FlowMonitor::m_sketchMode),
+                   MakeBooleanChecker ())
+    .AddAttribute ("SamplingProbability", ("The probability to sample a packet in sketch mode."),
+                   DoubleValue (1.0),
+                   MakeDoubleAccessor (&FlowMonitor::m_samplingProbability),
+                   MakeDoubleChecker<double> (0, 1))
+    .AddAttribute ("SketchWidth", ("The number of counters per row of the Count-Min sketches."),
+                   UintegerValue (4096),
+                   MakeUintegerAccessor (&FlowMonitor::m_sketchWidth),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("SketchDepth", ("The number of rows of the Count-Min sketches."),
+                   UintegerValue (4),
+                   MakeUintegerAccessor (&FlowMonitor::m_sketchDepth),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("HyperLogLogPrecision", ("The base 2 logarithm of the number of registers "
+                                            "of the HyperLogLog estimators of the number of flows."),
+                   UintegerValue (12),
+                   MakeUintegerAccessor (&FlowMonitor::m_hyperLogLogPrecision),
+                   MakeUintegerChecker<uint8_t> (4, 16))
+    .AddAttribute ("HeavyHitters", ("The number of heaviest flows tracked by the sketches."),
+                   UintegerValue (32),
+                   MakeUintegerAccessor (&FlowMonitor::m_nHeavyHitters),
+                   MakeUintegerChecker<uint32_t> ())
   ;
   return tid;
 }
@@ -80,7 +123,11 @@ FlowMonitor::GetInstanceTypeId (void) const
 }
 
 FlowMonitor::FlowMonitor ()
-  : m_enabled (false)
+  : m_oldestTracked (0),
+    m_newestTracked (0),
+    m_enabled (false),
+    m_sketchMode (false),
+    m_exportFormat (CSV)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -91,6 +138,13 @@ FlowMonitor::DoDispose (void)
   NS_LOG_FUNCTION (this);
   Simulator::Cancel (m_startEvent);
   Simulator::Cancel (m_stopEvent);
+  Simulator::Cancel (m_exportEvent);
+  if (m_exportStream.is_open ())
+    {
+      ExportFlowStats ();
+      m_exportStream.close ();
+    }
+  m_exportedStats.clear ();
   for (std::list<Ptr<FlowClassifier> >::iterator iter = m_classifiers.begin ();
       iter != m_classifiers.end ();
       iter ++)
@@ -105,6 +159,49 @@ FlowMonitor::DoDispose (void)
   Object::DoDispose ();
 }
 
+uint64_t
+FlowMonitor::GetTrackedPacketKey (FlowId flowId, FlowPacketId packetId)
+{
+  return (static_cast<uint64_t> (flowId) << 32) | packetId;
+}
+
+void
+FlowMonitor::LinkTrackedPacket (TrackedPacket *tracked)
+{
+  tracked->older = m_newestTracked;
+  tracked->newer = 0;
+  if (m_newestTracked)
+    {
+      m_newestTracked->newer = tracked;
+    }
+  else
+    {
+      m_oldestTracked = tracked;
+    }
+  m_newestTracked = tracked;
+}
+
+void
+FlowMonitor::UnlinkTrackedPacket (TrackedPacket *tracked)
+{
+  if (tracked->older)
+    {
+      tracked->older->newer = tracked->newer;
+    }
+  else
+    {
+      m_oldestTracked = tracked->newer;
+    }
+  if (tracked->newer)
+    {
+      tracked->newer->older = tracked->older;
+    }
+  else
+    {
+      m_newestTracked = tracked->older;
+    }
+}
+
 inline FlowMonitor::FlowStats&
 FlowMonitor::GetStatsForFlow (FlowId flowId)
 {
@@ -127,6 +224,10 @@ FlowMonitor::GetStatsForFlow (FlowId flowId)
       ref.jitterHistogram.SetDefaultBinWidth (m_jitterBinWidth);
       ref.packetSizeHistogram.SetDefaultBinWidth (m_packetSizeBinWidth);
       ref.flowInterruptionsHistogram.SetDefaultBinWidth (m_flowInterruptionsBinWidth);
+      ref.delayHistogram.SetMaxBins (m_histogramMaxBins);
+      ref.jitterHistogram.SetMaxBins (m_histogramMaxBins);
+      ref.packetSizeHistogram.SetMaxBins (m_histogramMaxBins);
+      ref.flowInterruptionsHistogram.SetMaxBins (m_histogramMaxBins);
       return ref;
     }
   else
@@ -145,11 +246,27 @@ FlowMonitor::ReportFirstTx (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t pack
       NS_LOG_DEBUG ("FlowMonitor not enabled; returning");
       return;
     }
+  if (m_sketchMode)
+    {
+      probe->AddSketchPacket (flowId, packetId, packetSize);
+      m_txSketch.AddPacket (flowId, packetId, packetSize);
+      return;
+    }
   Time now = Simulator::Now ();
-  TrackedPacket &tracked = m_trackedPackets[std::make_pair (flowId, packetId)];
+  uint64_t key = GetTrackedPacketKey (flowId, packetId);
+  std::pair<TrackedPacketMap::iterator, bool> insert
+    = m_trackedPackets.insert (std::make_pair (key, TrackedPacket ()));
+  TrackedPacket &tracked = insert.first->second;
+  if (!insert.second)
+    {
+      // the packet is transmitted again, it becomes the newest one
+      UnlinkTrackedPacket (&tracked);
+    }
   tracked.firstSeenTime = now;
   tracked.lastSeenTime = tracked.firstSeenTime;
   tracked.timesForwarded = 0;
+  tracked.key = key;
+  LinkTrackedPacket (&tracked);
   NS_LOG_DEBUG ("ReportFirstTx: adding tracked packet (flowId=" << flowId << ", packetId=" << packetId
                                                                 << ").");
 
@@ -175,8 +292,12 @@ FlowMonitor::ReportForwarding (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t p
       NS_LOG_DEBUG ("FlowMonitor not enabled; returning");
       return;
     }
-  std::pair<FlowId, FlowPacketId> key (flowId, packetId);
-  TrackedPacketMap::iterator tracked = m_trackedPackets.find (key);
+  if (m_sketchMode)
+    {
+      probe->AddSketchPacket (flowId, packetId, packetSize);
+      return;
+    }
+  TrackedPacketMap::iterator tracked = m_trackedPackets.find (GetTrackedPacketKey (flowId, packetId));
   if (tracked == m_trackedPackets.end ())
     {
       NS_LOG_WARN ("Received packet forward report (flowId=" << flowId << ", packetId=" << packetId
@@ -186,6 +307,8 @@ FlowMonitor::ReportForwarding (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t p
 
   tracked->second.timesForwarded++;
   tracked->second.lastSeenTime = Simulator::Now ();
+  UnlinkTrackedPacket (&tracked->second);
+  LinkTrackedPacket (&tracked->second);
 
   Time delay = (Simulator::Now () - tracked->second.firstSeenTime);
   probe->AddPacketStats (flowId, packetSize, delay);
@@ -201,7 +324,13 @@ FlowMonitor::ReportLastRx (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t packe
       NS_LOG_DEBUG ("FlowMonitor not enabled; returning");
       return;
     }
-  TrackedPacketMap::iterator tracked = m_trackedPackets.find (std::make_pair (flowId, packetId));
+  if (m_sketchMode)
+    {
+      probe->AddSketchPacket (flowId, packetId, packetSize);
+      m_rxSketch.AddPacket (flowId, packetId, packetSize);
+      return;
+    }
+  TrackedPacketMap::iterator tracked = m_trackedPackets.find (GetTrackedPacketKey (flowId, packetId));
   if (tracked == m_trackedPackets.end ())
     {
       NS_LOG_WARN ("Received packet last-tx report (flowId=" << flowId << ", packetId=" << packetId
@@ -254,6 +383,7 @@ FlowMonitor::ReportLastRx (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t packe
   NS_LOG_DEBUG ("ReportLastTx: removing tracked packet (flowId="
                 << flowId << ", packetId=" << packetId << ").");
 
+  UnlinkTrackedPacket (&tracked->second);
   m_trackedPackets.erase (tracked); // we don't need to track this packet anymore
 }
 
@@ -281,13 +411,14 @@ FlowMonitor::ReportDrop (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t packetI
   stats.bytesDropped[reasonCode] += packetSize;
   NS_LOG_DEBUG ("++stats.packetsDropped[" << reasonCode<< "]; // becomes: " << stats.packetsDropped[reasonCode]);
 
-  TrackedPacketMap::iterator tracked = m_trackedPackets.find (std::make_pair (flowId, packetId));
+  TrackedPacketMap::iterator tracked = m_trackedPackets.find (GetTrackedPacketKey (flowId, packetId));
   if (tracked != m_trackedPackets.end ())
     {
       // we don't need to track this packet anymore
       // FIXME: this will not necessarily be true with broadcast/multicast
       NS_LOG_DEBUG ("ReportDrop: removing tracked packet (flowId="
                     << flowId << ", packetId=" << packetId << ").");
+      UnlinkTrackedPacket (&tracked->second);
       m_trackedPackets.erase (tracked);
     }
 }
@@ -305,23 +436,24 @@ FlowMonitor::CheckForLostPackets (Time maxDelay)
   NS_LOG_FUNCTION (this << maxDelay.GetSeconds ());
   Time now = Simulator::Now ();
 
-  for (TrackedPacketMap::iterator iter = m_trackedPackets.begin ();
-       iter != m_trackedPackets.end (); )
+  // the packets are visited from the oldest one, until one was seen recently
+  while (m_oldestTracked && now - m_oldestTracked->lastSeenTime >= maxDelay)
     {
-      if (now - iter->second.lastSeenTime >= maxDelay)
-        {
-          // packet is considered lost, add it to the loss statistics
-          FlowStatsContainerI flow = m_flowStats.find (iter->first.first);
-          NS_ASSERT (flow != m_flowStats.end ());
-          flow->second.lostPackets++;
+      TrackedPacket *tracked = m_oldestTracked;
 
-          // we won't track it anymore
-          m_trackedPackets.erase (iter++);
-        }
-      else
+      // packet is considered lost, add it to the loss statistics,
+      // unless the flow was removed by the streaming export
+      FlowStatsContainerI flow = m_flowStats.find (static_cast<FlowId> (tracked->key >> 32));
+      NS_ASSERT (flow != m_flowStats.end () || m_exportStream.is_open ());
+      if (flow != m_flowStats.end ())
         {
-          iter++;
+          flow->second.lostPackets++;
         }
+
+      // we won't track it anymore
+      uint64_t key = tracked->key;
+      UnlinkTrackedPacket (tracked);
+      m_trackedPackets.erase (key);
     }
 }
 
@@ -338,16 +470,46 @@ FlowMonitor::PeriodicCheckForLostPackets ()
   Simulator::Schedule (PERIODIC_CHECK_INTERVAL, &FlowMonitor::PeriodicCheckForLostPackets, this);
 }
 
+FlowSketch
+FlowMonitor::CreateSketch () const
+{
+  return FlowSketch (m_sketchWidth, m_sketchDepth, m_hyperLogLogPrecision, m_nHeavyHitters, m_samplingProbability);
+}
+
+const FlowSketch&
+FlowMonitor::GetTxSketch () const
+{
+  return m_txSketch;
+}
+
+const FlowSketch&
+FlowMonitor::GetRxSketch () const
+{
+  return m_rxSketch;
+}
+
 void
 FlowMonitor::NotifyConstructionCompleted ()
 {
   Object::NotifyConstructionCompleted ();
+  if (m_sketchMode)
+    {
+      NS_ABORT_MSG_IF (m_samplingProbability <= 0, "The sampling probability must be positive");
+      m_txSketch = CreateSketch ();
+      m_rxSketch = CreateSketch ();
+    }
   Simulator::Schedule (PERIODIC_CHECK_INTERVAL, &FlowMonitor::PeriodicCheckForLostPackets, this);
 }
 
 void
 FlowMonitor::AddProbe (Ptr<FlowProbe> probe)
 {
+  NS_ABORT_MSG_IF (m_sketchMode != m_txSketch.IsEnabled (),
+                   "SketchMode can only be set when the FlowMonitor is created");
+  if (m_sketchMode)
+    {
+      probe->SetSketch (CreateSketch ());
+    }
   m_flowProbes.push_back (probe);
 }
 
@@ -425,9 +587,18 @@ FlowMonitor::SerializeToXmlStream (std::ostream &os, uint16_t indent, bool enabl
   indent += 2;
   os << std::string ( indent, ' ' ) << "<FlowStats>\n";
   indent += 2;
+  // write the flows sorted by FlowId
+  std::vector<FlowId> flowIds;
+  flowIds.reserve (m_flowStats.size ());
   for (FlowStatsContainerCI flowI = m_flowStats.begin ();
        flowI != m_flowStats.end (); flowI++)
     {
+      flowIds.push_back (flowI->first);
+    }
+  std::sort (flowIds.begin (), flowIds.end ());
+  for (std::vector<FlowId>::const_iterator idI = flowIds.begin (); idI != flowIds.end (); idI++)
+    {
+      FlowStatsContainerCI flowI = m_flowStats.find (*idI);
       os << std::string ( indent, ' ' );
 #define ATTRIB(name) << " " # name "=\"" << flowI->second.name << "\""
       os << "<Flow flowId=\"" << flowI->first << "\""
@@ -476,6 +647,12 @@ FlowMonitor::SerializeToXmlStream (std::ostream &os, uint16_t indent, bool enabl
   indent -= 2;
   os << std::string ( indent, ' ' ) << "</FlowStats>\n";
 
+  if (m_sketchMode)
+    {
+      m_txSketch.SerializeToXmlStream (os, indent, "TxSketch");
+      m_rxSketch.SerializeToXmlStream (os, indent, "RxSketch");
+    }
+
   for (std::list<Ptr<FlowClassifier> >::iterator iter = m_classifiers.begin ();
       iter != m_classifiers.end ();
       iter ++)
@@ -520,6 +697,134 @@ FlowMonitor::SerializeToXmlFile (std::string fileName, bool enableHistograms, bo
   os.close ();
 }
 
+void
+FlowMonitor::EnableStreamingExport (std::string fileName, Time interval, ExportFormat format)
+{
+  NS_LOG_FUNCTION (this << fileName << interval.GetSeconds () << format);
+  NS_ABORT_MSG_IF (m_exportStream.is_open (), "Streaming export already enabled");
+  NS_ABORT_MSG_IF (!interval.IsStrictlyPositive (), "The export interval must be positive");
+  m_exportStream.open (fileName.c_str (), std::ios::out|std::ios::binary);
+  NS_ABORT_MSG_IF (!m_exportStream.is_open (), "Could not open " << fileName);
+  m_exportFormat = format;
+  m_exportInterval = interval;
+  if (m_exportFormat == CSV)
+    {
+      m_exportStream << "time,flowId,txBytes,rxBytes,txPackets,rxPackets,lostPackets,"
+                     << "timesForwarded,delaySum,jitterSum\n";
+    }
+  m_exportEvent = Simulator::Schedule (m_exportInterval, &FlowMonitor::PeriodicExportFlowStats, this);
+}
+
+void
+FlowMonitor::PeriodicExportFlowStats ()
+{
+  ExportFlowStats ();
+  m_exportEvent = Simulator::Schedule (m_exportInterval, &FlowMonitor::PeriodicExportFlowStats, this);
+}
+
+void
+FlowMonitor::ExportFlowStats ()
+{
+  NS_LOG_FUNCTION (this);
+  NS_ABORT_MSG_IF (!m_exportStream.is_open (), "Streaming export not enabled");
+  Time now = Simulator::Now ();
+  std::unordered_set<FlowId> removedFlows;
+
+  for (FlowStatsContainerI flowI = m_flowStats.begin (); flowI != m_flowStats.end (); )
+    {
+      const FlowStats &stats = flowI->second;
+      ExportedStats &last = m_exportedStats[flowI->first];
+      if (stats.txPackets != last.txPackets || stats.rxPackets != last.rxPackets
+          || stats.lostPackets != last.lostPackets || stats.timesForwarded != last.timesForwarded)
+        {
+          WriteExportRecord (flowI->first, stats, last);
+          last.delaySum = stats.delaySum;
+          last.jitterSum = stats.jitterSum;
+          last.txBytes = stats.txBytes;
+          last.rxBytes = stats.rxBytes;
+          last.txPackets = stats.txPackets;
+          last.rxPackets = stats.rxPackets;
+          last.lostPackets = stats.lostPackets;
+          last.timesForwarded = stats.timesForwarded;
+        }
+
+      if (m_flowIdleTimeout.IsStrictlyPositive ()
+          && now - std::max (stats.timeLastTxPacket, stats.timeLastRxPacket) >= m_flowIdleTimeout)
+        {
+          NS_LOG_DEBUG ("Removing idle flow " << flowI->first);
+          removedFlows.insert (flowI->first);
+          m_exportedStats.erase (flowI->first);
+          m_flowStats.erase (flowI++);
+        }
+      else
+        {
+          flowI++;
+        }
+    }
+  if (!removedFlows.empty ())
+    {
+      for (uint32_t i = 0; i < m_flowProbes.size (); i++)
+        {
+          m_flowProbes[i]->RemoveStats (removedFlows);
+        }
+      for (std::list<Ptr<FlowClassifier> >::iterator iter = m_classifiers.begin ();
+           iter != m_classifiers.end (); iter++)
+        {
+          (*iter)->RemoveFlows (removedFlows);
+        }
+    }
+  m_exportStream.flush ();
+}
+
+/**
+ * Write an integer in little endian byte order
+ * \param os the output stream
+ * \param value the integer
+ * \param size the number of bytes to write
+ */
+static void
+WriteLittleEndian (std::ostream &os, uint64_t value, uint32_t size)
+{
+  char buffer[8];
+  for (uint32_t i = 0; i < size; i++)
+    {
+      buffer[i] = static_cast<char> ((value >> (8 * i)) & 0xff);
+    }
+  os.write (buffer, size);
+}
+
+void
+FlowMonitor::WriteExportRecord (FlowId flowId, const FlowStats &stats, const ExportedStats &last)
+{
+  int64_t now = Simulator::Now ().GetNanoSeconds ();
+  int64_t delaySum = (stats.delaySum - last.delaySum).GetNanoSeconds ();
+  int64_t jitterSum = (stats.jitterSum - last.jitterSum).GetNanoSeconds ();
+  if (m_exportFormat == CSV)
+    {
+      m_exportStream << now << ',' << flowId << ','
+                     << stats.txBytes - last.txBytes << ','
+                     << stats.rxBytes - last.rxBytes << ','
+                     << stats.txPackets - last.txPackets << ','
+                     << stats.rxPackets - last.rxPackets << ','
+                     << stats.lostPackets - last.lostPackets << ','
+                     << stats.timesForwarded - last.timesForwarded << ','
+                     << delaySum << ',' << jitterSum << '\n';
+    }
+  else
+    {
+      WriteLittleEndian (m_exportStream, now, 8);
+      WriteLittleEndian (m_exportStream, flowId, 4);
+      WriteLittleEndian (m_exportStream, stats.txPackets - last.txPackets, 4);
+      WriteLittleEndian (m_exportStream, stats.rxPackets - last.rxPackets, 4);
+      WriteLittleEndian (m_exportStream, stats.lostPackets - last.lostPackets, 4);
+      WriteLittleEndian (m_exportStream, stats.timesForwarded - last.timesForwarded, 4);
+      WriteLittleEndian (m_exportStream, stats.txBytes - last.txBytes, 8);
+      WriteLittleEndian (m_exportStream, stats.rxBytes - last.rxBytes, 8);
+      WriteLittleEndian (m_exportStream, delaySum, 8);
+      WriteLittleEndian (m_exportStream, jitterSum, 8);
+    }
+}
+
 
 } // namespace ns3
 
@@ -23,12 +23,15 @@
 
 #include <vector>
 #include <map>
+#include <unordered_map>
+#include <fstream>
 
 #include "ns3/ptr.h"
 #include "ns3/object.h"
 #include "ns3/flow-probe.h"
 #include "ns3/flow-classifier.h"
 #include "ns3/histogram.h"
+#include "ns3/flow-sketch.h"
 #include "ns3/nstime.h"
 #include "ns3/event-id.h"
 
@@ -51,6 +54,13 @@ class FlowMonitor : public Object
 {
 public:
 
+  /// Format of the streaming export of the flow statistics
+  enum ExportFormat
+  {
+    CSV,     //!< a line of comma separated values per record
+    BINARY   //!< a record of 60 bytes, in little endian byte order
+  };
+
   /// \brief Structure that represents the measured metrics of an individual packet flow
   struct FlowStats
   {
@@ -203,6 +213,15 @@ public:
   void ReportDrop (Ptr<FlowProbe> probe, FlowId flowId, FlowPacketId packetId,
                    uint32_t packetSize, uint32_t reasonCode);
 
+  /// Get the sketch of the packets transmitted by the sources, filled
+  /// when the SketchMode attribute is set
+  /// \returns the sketch
+  const FlowSketch& GetTxSketch () const;
+  /// Get the sketch of the packets received by the destinations, filled
+  /// when the SketchMode attribute is set
+  /// \returns the sketch
+  const FlowSketch& GetRxSketch () const;
+
   /// Check right now for packets that appear to be lost
   void CheckForLostPackets ();
 
@@ -215,11 +234,11 @@ public:
   // --- methods to get the results ---
 
   /// Container: FlowId, FlowStats
-  typedef std::map<FlowId, FlowStats> FlowStatsContainer;
+  typedef std::unordered_map<FlowId, FlowStats> FlowStatsContainer;
   /// Container Iterator: FlowId, FlowStats
-  typedef std::map<FlowId, FlowStats>::iterator FlowStatsContainerI;
+  typedef std::unordered_map<FlowId, FlowStats>::iterator FlowStatsContainerI;
   /// Container Const Iterator: FlowId, FlowStats
-  typedef std::map<FlowId, FlowStats>::const_iterator FlowStatsContainerCI;
+  typedef std::unordered_map<FlowId, FlowStats>::const_iterator FlowStatsContainerCI;
   /// Container: FlowProbe
   typedef std::vector< Ptr<FlowProbe> > FlowProbeContainer;
   /// Container Iterator: FlowProbe
@@ -230,7 +249,7 @@ public:
   /// Retrieve all collected the flow statistics.  Note, if the
   /// FlowMonitor has not stopped monitoring yet, you should call
   /// CheckForLostPackets() to make sure all possibly lost packets are
-  /// accounted for.
+  /// accounted for.  The flows are not sorted by FlowId.
   /// \returns the flows statistics
   const FlowStatsContainer& GetFlowStats () const;
 
@@ -258,6 +277,33 @@ public:
   /// \param enableProbes if true, include also the per-probe/flow pair statistics in the output
   void SerializeToXmlFile (std::string fileName, bool enableHistograms, bool enableProbes);
 
+  /// Periodically write to a file the changes of the statistics of
+  /// the flows since the previous export, i.e., a record per flow
+  /// whose statistics changed, made of the current time, the FlowId
+  /// and the increments of txBytes, rxBytes, txPackets, rxPackets,
+  /// lostPackets, timesForwarded, delaySum and jitterSum.  The sum of
+  /// the records of a flow gives its statistics.
+  ///
+  /// In CSV format, the file starts with a header line and the times
+  /// are in nanoseconds.  In binary format, a record is made of the
+  /// time in nanoseconds (int64), the FlowId, txPackets, rxPackets,
+  /// lostPackets and timesForwarded (uint32), txBytes and rxBytes
+  /// (uint64), delaySum and jitterSum in nanoseconds (int64).
+  ///
+  /// When the FlowIdleTimeout attribute is not zero, the exported
+  /// flows with no packet transmitted or received for that time are
+  /// removed from the flow statistics and from the classifiers, so that
+  /// the memory used does not grow with the number of flows of the
+  /// simulation: a later packet of a removed flow starts a new flow.
+  /// \param fileName name or path of the output file that will be created
+  /// \param interval the time between two exports
+  /// \param format the format of the file
+  void EnableStreamingExport (std::string fileName, Time interval, ExportFormat format = CSV);
+
+  /// Write the changes of the flow statistics since the previous export
+  /// right now.  Streaming export must be enabled.
+  void ExportFlowStats ();
+
 
 protected:
 
@@ -272,14 +318,37 @@ private:
     Time firstSeenTime; //!< absolute time when the packet was first seen by a probe
     Time lastSeenTime; //!< absolute time when the packet was last seen by a probe
     uint32_t timesForwarded; //!< number of times the packet was reportedly forwarded
+    uint64_t key; //!< key of the packet in m_trackedPackets
+    TrackedPacket *older; //!< packet last seen before this one (null if none)
+    TrackedPacket *newer; //!< packet last seen after this one (null if none)
+  };
+
+  /// Statistics of a flow at the time of the previous export
+  struct ExportedStats
+  {
+    Time delaySum;           //!< sum of the delays
+    Time jitterSum;          //!< sum of the jitters
+    uint64_t txBytes;        //!< transmitted bytes
+    uint64_t rxBytes;        //!< received bytes
+    uint32_t txPackets;      //!< transmitted packets
+    uint32_t rxPackets;      //!< received packets
+    uint32_t lostPackets;    //!< lost packets
+    uint32_t timesForwarded; //!< times the packets were forwarded
   };
 
   /// FlowId --> FlowStats
   FlowStatsContainer m_flowStats;
 
-  /// (FlowId,PacketId) --> TrackedPacket
-  typedef std::map< std::pair<FlowId, FlowPacketId>, TrackedPacket> TrackedPacketMap;
+  /// (FlowId,PacketId) --> TrackedPacket, the FlowId being the 32 most
+  /// significant bits of the key
+  typedef std::unordered_map<uint64_t, TrackedPacket> TrackedPacketMap;
   TrackedPacketMap m_trackedPackets; //!< Tracked packets
+  /// The tracked packets are linked in the order they were last seen,
+  /// which is also the order of their lastSeenTime, as every report
+  /// happens at the current time: the packets to be considered lost are
+  /// found at the oldest end of the list, without scanning the others
+  TrackedPacket *m_oldestTracked;
+  TrackedPacket *m_newestTracked; //!< Tracked packet last seen
   Time m_maxPerHopDelay; //!< Minimum per-hop delay
   FlowProbeContainer m_flowProbes; //!< all the FlowProbes
 
@@ -294,6 +363,42 @@ private:
   double m_packetSizeBinWidth;  //!< packet size bin width (for histograms)
   double m_flowInterruptionsBinWidth; //!< Flow interruptions bin width (for histograms)
   Time m_flowInterruptionsMinTime; //!< Flow interruptions minimum time
+  uint32_t m_histogramMaxBins; //!< Maximum number of bins of the histograms
+
+  bool m_sketchMode;             //!< Whether the flows are measured with sketches
+  double m_samplingProbability;  //!< Probability to sample a packet in sketch mode
+  uint32_t m_sketchWidth;        //!< Number of counters per row of the Count-Min sketches
+  uint32_t m_sketchDepth;        //!< Number of rows of the Count-Min sketches
+  uint8_t m_hyperLogLogPrecision; //!< Precision of the HyperLogLog estimators
+  uint32_t m_nHeavyHitters;      //!< Number of heaviest flows tracked by the sketches
+  FlowSketch m_txSketch;         //!< Sketch of the packets transmitted
+  FlowSketch m_rxSketch;         //!< Sketch of the packets received
+
+  /// Create an empty sketch configured by the attributes
+  /// \returns the sketch
+  FlowSketch CreateSketch () const;
+
+  std::ofstream m_exportStream; //!< Streaming export file
+  ExportFormat m_exportFormat;  //!< Streaming export format
+  Time m_exportInterval;        //!< Time between two streaming exports
+  EventId m_exportEvent;        //!< Streaming export event
+  Time m_flowIdleTimeout;       //!< Idle time after which the exported flows are removed
+  /// FlowId --> statistics at the time of the previous export
+  std::unordered_map<FlowId, ExportedStats> m_exportedStats;
+
+  /// Get the key of a tracked packet
+  /// \param flowId the Flow identification
+  /// \param packetId the Packet identification
+  /// \returns the key
+  static uint64_t GetTrackedPacketKey (FlowId flowId, FlowPacketId packetId);
+
+  /// Append a tracked packet to the newest end of the list of the tracked packets
+  /// \param tracked the tracked packet
+  void LinkTrackedPacket (TrackedPacket *tracked);
+
+  /// Remove a tracked packet from the list of the tracked packets
+  /// \param tracked the tracked packet
+  void UnlinkTrackedPacket (TrackedPacket *tracked);
 
   /// Get the stats for a given flow
   /// \param flowId the Flow identification
@@ -302,6 +407,15 @@ private:
 
   /// Periodic function to check for lost packets and prune statistics
   void PeriodicCheckForLostPackets ();
+
+  /// Periodic function to export the flow statistics
+  void PeriodicExportFlowStats ();
+
+  /// Write a record of the streaming export
+  /// \param flowId the Flow identification
+  /// \param stats the current statistics of the flow
+  /// \param last the statistics of the flow at the previous export
+  void WriteExportRecord (FlowId flowId, const FlowStats &stats, const ExportedStats &last);
 };
 
 
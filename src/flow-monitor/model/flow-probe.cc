@@ -21,6 +21,8 @@
 #include "ns3/flow-probe.h"
 #include "ns3/flow-monitor.h"
 
+#include <algorithm>
+
 namespace ns3 {
 
 /* static */
@@ -75,6 +77,12 @@ FlowProbe::AddPacketDropStats (FlowId flowId, uint32_t packetSize, uint32_t reas
   ++flow.packetsDropped[reasonCode];
   flow.bytesDropped[reasonCode] += packetSize;
 }
+
+void
+FlowProbe::AddSketchPacket (FlowId flowId, FlowPacketId packetId, uint32_t packetSize)
+{
+  m_sketch.AddPacket (flowId, packetId, packetSize);
+}
  
 FlowProbe::Stats
 FlowProbe::GetStats () const 
@@ -82,6 +90,34 @@ FlowProbe::GetStats () const
   return m_stats;
 }
 
+void
+FlowProbe::RemoveStats (const std::unordered_set<FlowId> &flowIds)
+{
+  for (Stats::iterator iter = m_stats.begin (); iter != m_stats.end (); )
+    {
+      if (flowIds.find (iter->first) != flowIds.end ())
+        {
+          m_stats.erase (iter++);
+        }
+      else
+        {
+          iter++;
+        }
+    }
+}
+
+void
+FlowProbe::SetSketch (const FlowSketch &sketch)
+{
+  m_sketch = sketch;
+}
+
+const FlowSketch&
+FlowProbe::GetSketch () const
+{
+  return m_sketch;
+}
+
 void
 FlowProbe::SerializeToXmlStream (std::ostream &os, uint16_t indent, uint32_t index) const
 {
@@ -89,8 +125,17 @@ FlowProbe::SerializeToXmlStream (std::ostream &os, uint16_t indent, uint32_t ind
 
   indent += 2;
 
+  // write the flows sorted by FlowId
+  std::vector<FlowId> flowIds;
+  flowIds.reserve (m_stats.size ());
   for (Stats::const_iterator iter = m_stats.begin (); iter != m_stats.end (); iter++)
     {
+      flowIds.push_back (iter->first);
+    }
+  std::sort (flowIds.begin (), flowIds.end ());
+  for (std::vector<FlowId>::const_iterator idI = flowIds.begin (); idI != flowIds.end (); idI++)
+    {
+      Stats::const_iterator iter = m_stats.find (*idI);
       os << std::string ( indent, ' ' );
       os << "<FlowStats "
          << " flowId=\"" << iter->first << "\""
@@ -116,6 +161,10 @@ FlowProbe::SerializeToXmlStream (std::ostream &os, uint16_t indent, uint32_t ind
       indent -= 2;
       os << std::string ( indent, ' ' ) << "</FlowStats>\n";
     }
+  if (m_sketch.IsEnabled ())
+    {
+      m_sketch.SerializeToXmlStream (os, indent, "FlowSketch");
+    }
   indent -= 2;
   os << std::string ( indent, ' ' ) << "</FlowProbe>\n";
 }
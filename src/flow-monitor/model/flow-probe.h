@@ -22,10 +22,13 @@
 #define FLOW_PROBE_H
 
 #include <map>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "ns3/object.h"
 #include "ns3/flow-classifier.h"
+#include "ns3/flow-sketch.h"
 #include "ns3/nstime.h"
 
 namespace ns3 {
@@ -77,7 +80,7 @@ public:
   };
 
   /// Container to map FlowId -> FlowStats
-  typedef std::map<FlowId, FlowStats> Stats;
+  typedef std::unordered_map<FlowId, FlowStats> Stats;
 
   /// Add a packet data to the flow stats
   /// \param flowId the flow Identifier
@@ -89,6 +92,11 @@ public:
   /// \param packetSize the packet size
   /// \param reasonCode reason code for the drop
   void AddPacketDropStats (FlowId flowId, uint32_t packetSize, uint32_t reasonCode);
+  /// Add a packet to the sketch of the probe, instead of the flow stats
+  /// \param flowId the flow Identifier
+  /// \param packetId the packet Identifier
+  /// \param packetSize the packet size
+  void AddSketchPacket (FlowId flowId, FlowPacketId packetId, uint32_t packetSize);
 
   /// Get the partial flow statistics stored in this probe.  With this
   /// information you can, for example, find out what is the delay
@@ -96,6 +104,21 @@ public:
   /// \returns the partial flow statistics
   Stats GetStats () const;
 
+  /// Remove the partial statistics of some flows, e.g., those removed
+  /// from the FlowMonitor by the streaming export
+  /// \param flowIds the identifiers of the flows
+  void RemoveStats (const std::unordered_set<FlowId> &flowIds);
+
+  /// Set the sketch of the packets seen by this probe, used when the
+  /// FlowMonitor measures the flows with sketches
+  /// \param sketch the (empty) sketch
+  void SetSketch (const FlowSketch &sketch);
+
+  /// Get the sketch of the packets seen by this probe
+  /// \returns the sketch, disabled unless the FlowMonitor measures the
+  /// flows with sketches
+  const FlowSketch& GetSketch () const;
+
   /// Serializes the results to an std::ostream in XML format
   /// \param os the output stream
   /// \param indent number of spaces to use as base indentation level
@@ -105,6 +128,7 @@ public:
 protected:
   Ptr<FlowMonitor> m_flowMonitor; //!< the FlowMonitor instance
   Stats m_stats; //!< The flow stats
+  FlowSketch m_sketch; //!< The sketch of the packets
 
 };
 
@@ -0,0 +1,457 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cmath>
+#include <algorithm>
+
+#include "flow-sketch.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("FlowSketch");
+
+/**
+ * \brief Mix the bits of a key (the finalizer of SplitMix64)
+ * \param key the key
+ * \return the hash of the key
+ */
+static uint64_t
+MixBits (uint64_t key)
+{
+  key += 0x9e3779b97f4a7c15ULL;
+  key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  key = (key ^ (key >> 27)) * 0x94d049bb133111ebULL;
+  return key ^ (key >> 31);
+}
+
+/**
+ * \brief Get the base 2 logarithm of an integer, rounded down
+ * \param value the integer (not zero)
+ * \return the logarithm
+ */
+static uint32_t
+Log2 (uint64_t value)
+{
+  uint32_t log = 0;
+  while (value >>= 1)
+    {
+      log++;
+    }
+  return log;
+}
+
+
+CountMinSketch::CountMinSketch (uint32_t width, uint32_t depth)
+  : m_width (width),
+    m_depth (depth),
+    m_counters (static_cast<std::size_t> (width) * depth, 0),
+    m_total (0)
+{
+  NS_ASSERT_MSG (width > 0 && depth > 0, "The sketch must have at least a counter");
+}
+
+CountMinSketch::CountMinSketch ()
+  : m_width (0),
+    m_depth (0),
+    m_total (0)
+{
+}
+
+uint32_t
+CountMinSketch::GetIndex (uint64_t key, uint32_t row) const
+{
+  return row * m_width + static_cast<uint32_t> (MixBits (key ^ MixBits (row)) % m_width);
+}
+
+uint64_t
+CountMinSketch::Add (uint64_t key, uint64_t count)
+{
+  NS_ASSERT_MSG (m_depth > 0, "Adding to an empty sketch");
+  uint64_t estimate = Estimate (key) + count;
+  // conservative update: no counter is raised above the new estimate
+  for (uint32_t row = 0; row < m_depth; row++)
+    {
+      uint64_t &counter = m_counters[GetIndex (key, row)];
+      counter = std::max (counter, estimate);
+    }
+  m_total += count;
+  return estimate;
+}
+
+uint64_t
+CountMinSketch::Estimate (uint64_t key) const
+{
+  uint64_t estimate = 0;
+  for (uint32_t row = 0; row < m_depth; row++)
+    {
+      uint64_t counter = m_counters[GetIndex (key, row)];
+      if (row == 0 || counter < estimate)
+        {
+          estimate = counter;
+        }
+    }
+  return estimate;
+}
+
+uint64_t
+CountMinSketch::GetTotal (void) const
+{
+  return m_total;
+}
+
+uint32_t
+CountMinSketch::GetWidth (void) const
+{
+  return m_width;
+}
+
+uint32_t
+CountMinSketch::GetDepth (void) const
+{
+  return m_depth;
+}
+
+void
+CountMinSketch::Clear (void)
+{
+  std::fill (m_counters.begin (), m_counters.end (), 0);
+  m_total = 0;
+}
+
+
+HyperLogLog::HyperLogLog (uint8_t precision)
+  : m_precision (precision),
+    m_registers (1u << precision, 0)
+{
+  NS_ASSERT_MSG (precision >= 4 && precision <= 16, "The precision must be between 4 and 16");
+}
+
+HyperLogLog::HyperLogLog ()
+  : m_precision (0)
+{
+}
+
+void
+HyperLogLog::Add (uint64_t key)
+{
+  NS_ASSERT_MSG (m_precision > 0, "Adding to an empty estimator");
+  uint64_t hash = MixBits (key);
+  uint32_t index = static_cast<uint32_t> (hash >> (64 - m_precision));
+  // rank of the first bit set in the rest of the hash
+  uint64_t rest = hash << m_precision;
+  uint8_t rank = 1;
+  while (rank <= 64 - m_precision && !(rest & (1ULL << 63)))
+    {
+      rest <<= 1;
+      rank++;
+    }
+  if (rank > m_registers[index])
+    {
+      m_registers[index] = rank;
+    }
+}
+
+double
+HyperLogLog::Estimate (void) const
+{
+  if (m_precision == 0)
+    {
+      return 0;
+    }
+  double m = m_registers.size ();
+  double alpha;
+  switch (m_precision)
+    {
+    case 4:
+      alpha = 0.673;
+      break;
+    case 5:
+      alpha = 0.697;
+      break;
+    case 6:
+      alpha = 0.709;
+      break;
+    default:
+      alpha = 0.7213 / (1 + 1.079 / m);
+    }
+
+  double sum = 0;
+  uint32_t zeros = 0;
+  for (std::vector<uint8_t>::const_iterator it = m_registers.begin (); it != m_registers.end (); it++)
+    {
+      sum += std::ldexp (1.0, -*it);
+      if (*it == 0)
+        {
+          zeros++;
+        }
+    }
+  double estimate = alpha * m * m / sum;
+  if (estimate <= 2.5 * m && zeros > 0)
+    {
+      // linear counting is more accurate for small cardinalities
+      estimate = m * std::log (m / zeros);
+    }
+  return estimate;
+}
+
+void
+HyperLogLog::Merge (const HyperLogLog &other)
+{
+  NS_ASSERT_MSG (m_precision == other.m_precision, "Merging estimators with different precisions");
+  for (uint32_t i = 0; i < m_registers.size (); i++)
+    {
+      m_registers[i] = std::max (m_registers[i], other.m_registers[i]);
+    }
+}
+
+uint8_t
+HyperLogLog::GetPrecision (void) const
+{
+  return m_precision;
+}
+
+void
+HyperLogLog::Clear (void)
+{
+  std::fill (m_registers.begin (), m_registers.end (), 0);
+}
+
+
+FlowSketch::FlowSketch (uint32_t width, uint32_t depth, uint8_t precision,
+                        uint32_t nHeavyHitters, double samplingProbability)
+  : m_enabled (true),
+    m_packets (width, depth),
+    m_bytes (width, depth),
+    m_flows (precision),
+    m_samplingProbability (samplingProbability),
+    m_nHeavyHitters (nHeavyHitters),
+    m_heavyHittersMin (0)
+{
+  NS_ASSERT_MSG (samplingProbability > 0 && samplingProbability <= 1,
+                 "The sampling probability must be in (0, 1]");
+  if (samplingProbability >= 1)
+    {
+      m_samplingThreshold = UINT64_MAX;
+    }
+  else
+    {
+      m_samplingThreshold = static_cast<uint64_t> (std::ldexp (samplingProbability, 64));
+    }
+}
+
+FlowSketch::FlowSketch ()
+  : m_enabled (false),
+    m_samplingProbability (1),
+    m_samplingThreshold (UINT64_MAX),
+    m_nHeavyHitters (0),
+    m_heavyHittersMin (0)
+{
+}
+
+bool
+FlowSketch::IsEnabled (void) const
+{
+  return m_enabled;
+}
+
+bool
+FlowSketch::IsSampled (FlowId flowId, FlowPacketId packetId) const
+{
+  return m_samplingThreshold == UINT64_MAX
+         || MixBits ((static_cast<uint64_t> (flowId) << 32) | packetId) < m_samplingThreshold;
+}
+
+void
+FlowSketch::AddPacket (FlowId flowId, FlowPacketId packetId, uint32_t packetSize)
+{
+  NS_ASSERT_MSG (m_enabled, "Adding a packet to a disabled sketch");
+  m_flows.Add (flowId);
+  if (!IsSampled (flowId, packetId))
+    {
+      return;
+    }
+
+  uint64_t previous = m_packets.Estimate (flowId);
+  uint64_t packets = m_packets.Add (flowId, 1);
+  uint32_t sizeClass = Log2 (packets);
+  if (previous == 0 || Log2 (previous) != sizeClass)
+    {
+      if (sizeClass >= m_flowSizes.size ())
+        {
+          m_flowSizes.resize (sizeClass + 1, 0);
+        }
+      m_flowSizes[sizeClass]++;
+      // the estimate of a flow also grows with the collisions with other
+      // flows, hence the flow may have been counted in a lower class
+      if (previous > 0 && m_flowSizes[Log2 (previous)] > 0)
+        {
+          m_flowSizes[Log2 (previous)]--;
+        }
+    }
+
+  UpdateHeavyHitters (flowId, m_bytes.Add (flowId, packetSize));
+}
+
+void
+FlowSketch::UpdateHeavyHitters (FlowId flowId, uint64_t bytes)
+{
+  if (m_nHeavyHitters == 0)
+    {
+      return;
+    }
+  std::unordered_map<FlowId, uint64_t>::iterator it = m_heavyHitters.find (flowId);
+  if (it != m_heavyHitters.end ())
+    {
+      it->second = bytes;
+      return;
+    }
+  if (m_heavyHitters.size () == m_nHeavyHitters)
+    {
+      // m_heavyHittersMin is a lower bound of the smallest estimate,
+      // as the estimates of the tracked flows only grow
+      if (bytes <= m_heavyHittersMin)
+        {
+          return;
+        }
+      std::unordered_map<FlowId, uint64_t>::iterator min = m_heavyHitters.begin ();
+      for (it = m_heavyHitters.begin (); it != m_heavyHitters.end (); it++)
+        {
+          if (it->second < min->second)
+            {
+              min = it;
+            }
+        }
+      if (bytes <= min->second)
+        {
+          m_heavyHittersMin = min->second;
+          return;
+        }
+      m_heavyHitters.erase (min);
+    }
+  m_heavyHitters[flowId] = bytes;
+  if (m_heavyHitters.size () == m_nHeavyHitters)
+    {
+      m_heavyHittersMin = UINT64_MAX;
+      for (it = m_heavyHitters.begin (); it != m_heavyHitters.end (); it++)
+        {
+          m_heavyHittersMin = std::min (m_heavyHittersMin, it->second);
+        }
+    }
+}
+
+double
+FlowSketch::GetEstimatedPackets (FlowId flowId) const
+{
+  if (!m_enabled)
+    {
+      return 0;
+    }
+  return m_packets.Estimate (flowId) / m_samplingProbability;
+}
+
+double
+FlowSketch::GetEstimatedBytes (FlowId flowId) const
+{
+  if (!m_enabled)
+    {
+      return 0;
+    }
+  return m_bytes.Estimate (flowId) / m_samplingProbability;
+}
+
+double
+FlowSketch::GetEstimatedFlows (void) const
+{
+  return m_flows.Estimate ();
+}
+
+uint64_t
+FlowSketch::GetSampledPackets (void) const
+{
+  return m_packets.GetTotal ();
+}
+
+/**
+ * \brief Compare two flows by decreasing estimated bytes
+ * \param left the first flow
+ * \param right the second flow
+ * \return true if the first flow is heavier, or as heavy with a smaller FlowId
+ */
+static bool
+IsHeavier (const std::pair<FlowId, double> &left, const std::pair<FlowId, double> &right)
+{
+  return left.second > right.second || (left.second == right.second && left.first < right.first);
+}
+
+std::vector<std::pair<FlowId, double> >
+FlowSketch::GetHeavyHitters (void) const
+{
+  std::vector<std::pair<FlowId, double> > heavyHitters;
+  heavyHitters.reserve (m_heavyHitters.size ());
+  for (std::unordered_map<FlowId, uint64_t>::const_iterator it = m_heavyHitters.begin ();
+       it != m_heavyHitters.end (); it++)
+    {
+      heavyHitters.push_back (std::make_pair (it->first, it->second / m_samplingProbability));
+    }
+  std::sort (heavyHitters.begin (), heavyHitters.end (), IsHeavier);
+  return heavyHitters;
+}
+
+const std::vector<uint32_t>&
+FlowSketch::GetFlowSizeDistribution (void) const
+{
+  return m_flowSizes;
+}
+
+void
+FlowSketch::SerializeToXmlStream (std::ostream &os, uint16_t indent, std::string elementName) const
+{
+  os << std::string (indent, ' ') << "<" << elementName
+     << " samplingProbability=\"" << m_samplingProbability << "\""
+     << " sampledPackets=\"" << GetSampledPackets () << "\""
+     << " estimatedFlows=\"" << GetEstimatedFlows () << "\""
+     << ">\n";
+  indent += 2;
+
+  std::vector<std::pair<FlowId, double> > heavyHitters = GetHeavyHitters ();
+  for (std::vector<std::pair<FlowId, double> >::const_iterator it = heavyHitters.begin ();
+       it != heavyHitters.end (); it++)
+    {
+      os << std::string (indent, ' ')
+         << "<heavyHitter flowId=\"" << it->first << "\""
+         << " bytes=\"" << it->second << "\""
+         << " packets=\"" << GetEstimatedPackets (it->first) << "\""
+         << " />\n";
+    }
+  for (uint32_t k = 0; k < m_flowSizes.size (); k++)
+    {
+      if (m_flowSizes[k])
+        {
+          os << std::string (indent, ' ')
+             << "<flowSizeClass index=\"" << k << "\""
+             << " minPackets=\"" << std::ldexp (1.0, k) / m_samplingProbability << "\""
+             << " flows=\"" << m_flowSizes[k] << "\""
+             << " />\n";
+        }
+    }
+
+  indent -= 2;
+  os << std::string (indent, ' ') << "</" << elementName << ">\n";
+}
+
+} // namespace ns3
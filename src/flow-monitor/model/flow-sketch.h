@@ -0,0 +1,267 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef FLOW_SKETCH_H
+#define FLOW_SKETCH_H
+
+#include <stdint.h>
+#include <vector>
+#include <unordered_map>
+#include <ostream>
+#include <string>
+
+#include "ns3/flow-classifier.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup flow-monitor
+ * \brief Count-Min sketch of the counts of a set of keys
+ *
+ * The counters are arranged in \a depth rows of \a width counters; a key
+ * is mapped to a counter of each row by a hash function, and its count
+ * is estimated by the smallest of its counters.  The counters are updated
+ * conservatively, i.e., only those that would otherwise be smaller than
+ * the new estimate are increased.  The estimate of a key is never smaller
+ * than its count, and exceeds it by more than e/width times the total
+ * count with probability at most exp(-depth).
+ */
+class CountMinSketch
+{
+public:
+  /**
+   * \brief Constructor
+   * \param width the number of counters per row
+   * \param depth the number of rows
+   */
+  CountMinSketch (uint32_t width, uint32_t depth);
+  CountMinSketch ();
+
+  /**
+   * \brief Add to the count of a key
+   * \param key the key
+   * \param count the count to add
+   * \return the new estimate of the count of the key
+   */
+  uint64_t Add (uint64_t key, uint64_t count);
+  /**
+   * \brief Estimate the count of a key
+   * \param key the key
+   * \return the estimate
+   */
+  uint64_t Estimate (uint64_t key) const;
+  /**
+   * \brief Get the sum of the counts added
+   * \return the total count
+   */
+  uint64_t GetTotal (void) const;
+  /**
+   * \return the number of counters per row
+   */
+  uint32_t GetWidth (void) const;
+  /**
+   * \return the number of rows
+   */
+  uint32_t GetDepth (void) const;
+  /**
+   * \brief Reset all the counters
+   */
+  void Clear (void);
+
+private:
+  /**
+   * \brief Get the index of the counter of a key in a row
+   * \param key the key
+   * \param row the row
+   * \return the index in m_counters
+   */
+  uint32_t GetIndex (uint64_t key, uint32_t row) const;
+
+  uint32_t m_width;                 //!< Number of counters per row
+  uint32_t m_depth;                 //!< Number of rows
+  std::vector<uint64_t> m_counters; //!< The counters, row by row
+  uint64_t m_total;                 //!< Sum of the counts added
+};
+
+/**
+ * \ingroup flow-monitor
+ * \brief HyperLogLog estimator of the number of distinct keys
+ *
+ * The keys are hashed to one of 2^precision registers, each keeping the
+ * largest number of leading zeros seen in the rest of the hash.  The
+ * relative standard error of the estimate is about 1.04/sqrt(2^precision).
+ */
+class HyperLogLog
+{
+public:
+  /**
+   * \brief Constructor
+   * \param precision the base 2 logarithm of the number of registers (4 to 16)
+   */
+  HyperLogLog (uint8_t precision);
+  HyperLogLog ();
+
+  /**
+   * \brief Add a key
+   * \param key the key
+   */
+  void Add (uint64_t key);
+  /**
+   * \brief Estimate the number of distinct keys added
+   * \return the estimate
+   */
+  double Estimate (void) const;
+  /**
+   * \brief Add the keys of another estimator with the same precision
+   * \param other the other estimator
+   */
+  void Merge (const HyperLogLog &other);
+  /**
+   * \return the base 2 logarithm of the number of registers
+   */
+  uint8_t GetPrecision (void) const;
+  /**
+   * \brief Reset all the registers
+   */
+  void Clear (void);
+
+private:
+  uint8_t m_precision;              //!< Base 2 logarithm of the number of registers
+  std::vector<uint8_t> m_registers; //!< The registers
+};
+
+/**
+ * \ingroup flow-monitor
+ * \brief Sketch of the flows of a sample of the packets
+ *
+ * A packet is sampled if the hash of its FlowId and FlowPacketId is below
+ * a threshold, so that the same packets are sampled wherever they are
+ * observed.  The sampled packets and bytes of each flow are counted by
+ * Count-Min sketches, from which the heaviest flows in bytes are tracked
+ * and the number of flows per power-of-two class of sampled packets is
+ * kept.  The number of distinct flows is estimated from all the packets by
+ * a HyperLogLog estimator.  The memory used does not depend on the number
+ * of flows, and the estimates are scaled by the inverse of the sampling
+ * probability.
+ */
+class FlowSketch
+{
+public:
+  /**
+   * \brief Constructor
+   * \param width the number of counters per row of the Count-Min sketches
+   * \param depth the number of rows of the Count-Min sketches
+   * \param precision the precision of the HyperLogLog estimator
+   * \param nHeavyHitters the number of heaviest flows tracked
+   * \param samplingProbability the probability to sample a packet
+   */
+  FlowSketch (uint32_t width, uint32_t depth, uint8_t precision,
+              uint32_t nHeavyHitters, double samplingProbability);
+  /// Construct a disabled sketch
+  FlowSketch ();
+
+  /**
+   * \brief Check whether the sketch is enabled
+   * \return false if the sketch was default constructed
+   */
+  bool IsEnabled (void) const;
+  /**
+   * \brief Check whether a packet is sampled
+   * \param flowId the FlowId of the packet
+   * \param packetId the FlowPacketId of the packet
+   * \return true if the packet is sampled
+   */
+  bool IsSampled (FlowId flowId, FlowPacketId packetId) const;
+  /**
+   * \brief Add a packet, which is only counted if sampled
+   * \param flowId the FlowId of the packet
+   * \param packetId the FlowPacketId of the packet
+   * \param packetSize the size of the packet
+   */
+  void AddPacket (FlowId flowId, FlowPacketId packetId, uint32_t packetSize);
+
+  /**
+   * \brief Estimate the number of packets of a flow
+   * \param flowId the FlowId
+   * \return the estimate
+   */
+  double GetEstimatedPackets (FlowId flowId) const;
+  /**
+   * \brief Estimate the number of bytes of a flow
+   * \param flowId the FlowId
+   * \return the estimate
+   */
+  double GetEstimatedBytes (FlowId flowId) const;
+  /**
+   * \brief Estimate the number of distinct flows
+   * \return the estimate
+   */
+  double GetEstimatedFlows (void) const;
+  /**
+   * \brief Get the number of packets sampled
+   * \return the number of packets sampled
+   */
+  uint64_t GetSampledPackets (void) const;
+  /**
+   * \brief Get the heaviest flows
+   * \return the FlowIds and estimated bytes of the heaviest flows, sorted
+   * by decreasing estimated bytes
+   */
+  std::vector<std::pair<FlowId, double> > GetHeavyHitters (void) const;
+  /**
+   * \brief Get the distribution of the flow sizes
+   *
+   * Element k is the number of flows with 2^k to 2^(k+1)-1 sampled
+   * packets, i.e., about 2^k to 2^(k+1) divided by the sampling
+   * probability packets.  The flows with no sampled packet are not
+   * counted.
+   *
+   * \return the number of flows per size class
+   */
+  const std::vector<uint32_t>& GetFlowSizeDistribution (void) const;
+
+  /**
+   * \brief Serializes the estimates to an std::ostream in XML format
+   * \param os the output stream
+   * \param indent number of spaces to use as base indentation level
+   * \param elementName name of the element to serialize
+   */
+  void SerializeToXmlStream (std::ostream &os, uint16_t indent, std::string elementName) const;
+
+private:
+  /**
+   * \brief Update the heaviest flows after a sampled packet
+   * \param flowId the FlowId of the packet
+   * \param bytes the new estimate of the sampled bytes of the flow
+   */
+  void UpdateHeavyHitters (FlowId flowId, uint64_t bytes);
+
+  bool m_enabled;                       //!< Whether the sketch is enabled
+  CountMinSketch m_packets;             //!< Sampled packets per flow
+  CountMinSketch m_bytes;               //!< Sampled bytes per flow
+  HyperLogLog m_flows;                  //!< Distinct flows
+  double m_samplingProbability;         //!< Probability to sample a packet
+  uint64_t m_samplingThreshold;         //!< Threshold of the hash of the sampled packets
+  uint32_t m_nHeavyHitters;             //!< Number of heaviest flows tracked
+  /// FlowId --> estimated sampled bytes of the heaviest flows
+  std::unordered_map<FlowId, uint64_t> m_heavyHitters;
+  uint64_t m_heavyHittersMin;           //!< Smallest estimate of the heaviest flows, when full
+  std::vector<uint32_t> m_flowSizes;    //!< Number of flows per power-of-two class of sampled packets
+};
+
+} // namespace ns3
+
+#endif /* FLOW_SKETCH_H */
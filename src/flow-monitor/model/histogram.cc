@@ -76,10 +76,33 @@ Histogram::GetBinCount (uint32_t index)
   return m_histogram[index];
 }
 
+void
+Histogram::SetMaxBins (uint32_t maxBins)
+{
+  NS_ASSERT (m_histogram.size () == 0); //we can only change the maximum number of bins if no values were added
+  m_maxBins = maxBins;
+}
+
+uint32_t
+Histogram::GetMaxBins (void) const
+{
+  return m_maxBins;
+}
+
 void 
 Histogram::AddValue (double value)
 {
-  uint32_t index = (uint32_t)std::floor (value/m_binWidth);
+  double bin = std::floor (value/m_binWidth);
+  uint32_t index;
+  if (m_maxBins > 0 && bin >= m_maxBins)
+    {
+      // the last bin counts the values beyond it
+      index = m_maxBins - 1;
+    }
+  else
+    {
+      index = (uint32_t)bin;
+    }
 
   //check if we need to resize the vector
   NS_LOG_DEBUG ("AddValue: index=" << index << ", m_histogram.size()=" << m_histogram.size ());
@@ -94,11 +117,13 @@ Histogram::AddValue (double value)
 Histogram::Histogram (double binWidth)
 {
   m_binWidth = binWidth;
+  m_maxBins = 0;
 }
 
 Histogram::Histogram ()
 {
   m_binWidth = DEFAULT_BIN_WIDTH;
+  m_maxBins = 0;
 }
 
 void
@@ -36,6 +36,10 @@ namespace ns3 {
  *
  * This class only handles \a positive bins, i.e., it does \a not handles negative data.
  *
+ * The number of bins grows with the largest value added, unless a maximum
+ * number of bins is set: in that case, the last bin also counts all the
+ * values beyond it, so that the memory used by the histogram is bounded.
+ *
  * \todo Add support for negative data.
  *
  * \todo Add method(s) to estimate parameters from the histogram,
@@ -95,6 +99,21 @@ public:
    * \return the number of data added to the bin
    */
   uint32_t GetBinCount (uint32_t index);
+  /**
+   * \brief Set the maximum number of bins.
+   *
+   * The values beyond the last bin are counted in the last bin.  Note
+   * that you can change the maximum number of bins only if the histogram
+   * is empty.
+   *
+   * \param maxBins the maximum number of bins (0 means no limit)
+   */
+  void SetMaxBins (uint32_t maxBins);
+  /**
+   * \brief Get the maximum number of bins.
+   * \return the maximum number of bins (0 means no limit)
+   */
+  uint32_t GetMaxBins (void) const;
 
   // Method for adding values
   /**
@@ -115,6 +134,7 @@ public:
 private:
   std::vector<uint32_t> m_histogram; //!< Histogram data
   double m_binWidth; //!< Bin width
+  uint32_t m_maxBins; //!< Maximum number of bins (0 if unlimited)
 };
 
 
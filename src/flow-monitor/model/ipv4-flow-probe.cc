@@ -27,6 +27,7 @@
 #include "ns3/pointer.h"
 #include "ns3/config.h"
 #include "ns3/flow-id-tag.h"
+#include "ns3/segmentation-offload.h"
 
 namespace ns3 {
 
@@ -216,6 +217,41 @@ Ipv4FlowProbeTag::IsSrcDstValid (Ipv4Address src, Ipv4Address dst) const
   return ((m_src == src) && (m_dst == dst));
 }
 
+/**
+ * \brief Get the flow probe tags of a packet
+ *
+ * A super-segment carries the tags of all the segments it is made of (see
+ * Ipv4FlowProbe::SegmentsLogger), any other packet carries at most one tag.
+ *
+ * \param packet the packet
+ * \return the flow probe tags of the packet
+ */
+static std::vector<Ipv4FlowProbeTag>
+GetFlowProbeTags (Ptr<const Packet> packet)
+{
+  std::vector<Ipv4FlowProbeTag> tags;
+  Ipv4FlowProbeTag fTag;
+  if (!SegmentationOffload::IsSuperSegment (packet))
+    {
+      if (packet->FindFirstMatchingByteTag (fTag))
+        {
+          tags.push_back (fTag);
+        }
+      return tags;
+    }
+  ByteTagIterator it = packet->GetByteTagIterator ();
+  while (it.HasNext ())
+    {
+      ByteTagIterator::Item item = it.Next ();
+      if (item.GetTypeId () == fTag.GetInstanceTypeId ())
+        {
+          item.GetTag (fTag);
+          tags.push_back (fTag);
+        }
+    }
+  return tags;
+}
+
 ////////////////////////////////////////
 // Ipv4FlowProbe class implementation //
 ////////////////////////////////////////
@@ -306,6 +342,11 @@ Ipv4FlowProbe::SendOutgoingLogger (const Ipv4Header &ipHeader, Ptr<const Packet>
       return;
     }
 
+  if (SegmentationOffload::IsSuperSegment (ipPayload) && SegmentsLogger (ipHeader, ipPayload))
+    {
+      return;
+    }
+
   if (m_classifier->Classify (ipHeader, ipPayload, &flowId, &packetId))
     {
       uint32_t size = (ipPayload->GetSize () + ipHeader.GetSerializedSize ());
@@ -320,6 +361,53 @@ Ipv4FlowProbe::SendOutgoingLogger (const Ipv4Header &ipHeader, Ptr<const Packet>
     }
 }
 
+bool
+Ipv4FlowProbe::SegmentsLogger (const Ipv4Header &ipHeader, Ptr<const Packet> ipPayload)
+{
+  Ptr<Packet> superSegment = ipPayload->Copy ();
+  superSegment->AddHeader (ipHeader);
+  std::vector<Ptr<Packet> > segments;
+  if (!SegmentationOffload::Segment (superSegment, Ipv4L3Protocol::PROT_NUMBER, segments)
+      || segments.size () < 2)
+    {
+      return false;
+    }
+
+  std::vector<Ipv4Header> headers (segments.size ());
+  uint32_t totalSize = 0;
+  for (uint32_t i = 0; i < segments.size (); i++)
+    {
+      segments[i]->RemoveHeader (headers[i]);
+      totalSize += segments[i]->GetSize ();
+    }
+  // each segment carries a copy of the transport header of the super-segment,
+  // followed by the next chunk of its payload
+  uint32_t headerSize = (totalSize - ipPayload->GetSize ()) / (segments.size () - 1);
+
+  // each segment is reported as a packet of its own, and the bytes of the
+  // super-segment it is made of are tagged with its flow id and packet id
+  uint32_t start = 0;
+  uint32_t end = headerSize;
+  for (uint32_t i = 0; i < segments.size (); i++)
+    {
+      end += segments[i]->GetSize () - headerSize;
+      FlowId flowId;
+      FlowPacketId packetId;
+      if (m_classifier->Classify (headers[i], segments[i], &flowId, &packetId))
+        {
+          uint32_t size = (segments[i]->GetSize () + headers[i].GetSerializedSize ());
+          NS_LOG_DEBUG ("ReportFirstTx ("<<this<<", "<<flowId<<", "<<packetId<<", "<<size<<"); "
+                                         << headers[i] << *segments[i]);
+          m_flowMonitor->ReportFirstTx (this, flowId, packetId, size);
+
+          Ipv4FlowProbeTag fTag (flowId, packetId, size, ipHeader.GetSource (), ipHeader.GetDestination ());
+          ipPayload->AddByteTag (fTag, start, end);
+        }
+      start = end;
+    }
+  return true;
+}
+
 void
 Ipv4FlowProbe::ForwardLogger (const Ipv4Header &ipHeader, Ptr<const Packet> ipPayload, uint32_t interface)
 {
@@ -394,15 +482,16 @@ Ipv4FlowProbe::DropLogger (const Ipv4Header &ipHeader, Ptr<const Packet> ipPaylo
     }
 #endif
 
-  Ipv4FlowProbeTag fTag;
-  bool found = ipPayload->FindFirstMatchingByteTag (fTag);
+  std::vector<Ipv4FlowProbeTag> tags = GetFlowProbeTags (ipPayload);
 
-  if (found)
+  for (auto& fTag : tags)
     {
       FlowId flowId = fTag.GetFlowId ();
       FlowPacketId packetId = fTag.GetPacketId ();
 
-      uint32_t size = (ipPayload->GetSize () + ipHeader.GetSerializedSize ());
+      // the segments of a super-segment are reported with their own size
+      uint32_t size = (tags.size () > 1 ? fTag.GetPacketSize ()
+                                          : ipPayload->GetSize () + ipHeader.GetSerializedSize ());
       NS_LOG_DEBUG ("Drop ("<<this<<", "<<flowId<<", "<<packetId<<", "<<size<<", " << reason 
                             << ", destIp=" << ipHeader.GetDestination () << "); "
                             << "HDR: " << ipHeader << " PKT: " << *ipPayload);
@@ -449,43 +538,33 @@ Ipv4FlowProbe::DropLogger (const Ipv4Header &ipHeader, Ptr<const Packet> ipPaylo
 void 
 Ipv4FlowProbe::QueueDropLogger (Ptr<const Packet> ipPayload)
 {
-  Ipv4FlowProbeTag fTag;
-  bool tagFound = ipPayload->FindFirstMatchingByteTag (fTag);
-
-  if (!tagFound)
+  for (auto& fTag : GetFlowProbeTags (ipPayload))
     {
-      return;
-    }
-
-  FlowId flowId = fTag.GetFlowId ();
-  FlowPacketId packetId = fTag.GetPacketId ();
-  uint32_t size = fTag.GetPacketSize ();
+      FlowId flowId = fTag.GetFlowId ();
+      FlowPacketId packetId = fTag.GetPacketId ();
+      uint32_t size = fTag.GetPacketSize ();
 
-  NS_LOG_DEBUG ("Drop ("<<this<<", "<<flowId<<", "<<packetId<<", "<<size<<", " << DROP_QUEUE 
-                        << "); ");
+      NS_LOG_DEBUG ("Drop ("<<this<<", "<<flowId<<", "<<packetId<<", "<<size<<", " << DROP_QUEUE 
+                            << "); ");
 
-  m_flowMonitor->ReportDrop (this, flowId, packetId, size, DROP_QUEUE);
+      m_flowMonitor->ReportDrop (this, flowId, packetId, size, DROP_QUEUE);
+    }
 }
 
 void
 Ipv4FlowProbe::QueueDiscDropLogger (Ptr<const QueueDiscItem> item)
 {
-  Ipv4FlowProbeTag fTag;
-  bool tagFound = item->GetPacket ()->FindFirstMatchingByteTag (fTag);
-
-  if (!tagFound)
+  for (auto& fTag : GetFlowProbeTags (item->GetPacket ()))
     {
-      return;
-    }
-
-  FlowId flowId = fTag.GetFlowId ();
-  FlowPacketId packetId = fTag.GetPacketId ();
-  uint32_t size = fTag.GetPacketSize ();
+      FlowId flowId = fTag.GetFlowId ();
+      FlowPacketId packetId = fTag.GetPacketId ();
+      uint32_t size = fTag.GetPacketSize ();
 
-  NS_LOG_DEBUG ("Drop ("<<this<<", "<<flowId<<", "<<packetId<<", "<<size<<", " << DROP_QUEUE_DISC
-                        << "); ");
+      NS_LOG_DEBUG ("Drop ("<<this<<", "<<flowId<<", "<<packetId<<", "<<size<<", " << DROP_QUEUE_DISC
+                            << "); ");
 
-  m_flowMonitor->ReportDrop (this, flowId, packetId, size, DROP_QUEUE_DISC);
+      m_flowMonitor->ReportDrop (this, flowId, packetId, size, DROP_QUEUE_DISC);
+    }
 }
 
 } // namespace ns3
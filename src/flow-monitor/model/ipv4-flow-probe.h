@@ -91,6 +91,11 @@ private:
   /// \param ipPayload IP payload
   /// \param interface outgoing interface
   void SendOutgoingLogger (const Ipv4Header &ipHeader, Ptr<const Packet> ipPayload, uint32_t interface);
+  /// Log a super-segment being sent as the segments it is made of
+  /// \param ipHeader IP header
+  /// \param ipPayload IP payload
+  /// \return false if the super-segment cannot be split
+  bool SegmentsLogger (const Ipv4Header &ipHeader, Ptr<const Packet> ipPayload);
   /// Log a packet being forwarded
   /// \param ipHeader IP header
   /// \param ipPayload IP payload
@@ -97,6 +97,21 @@ bool operator == (const Ipv6FlowClassifier::FiveTuple &t1,
 
 
 
+size_t
+Ipv6FlowClassifier::FiveTupleHash::operator() (const FiveTuple &tuple) const
+{
+  Ipv6AddressHash addressHash;
+  uint64_t h = addressHash (tuple.sourceAddress);
+  h = h * 0x9e3779b97f4a7c15ULL ^ addressHash (tuple.destinationAddress);
+  h ^= ((static_cast<uint64_t> (tuple.protocol) << 32)
+        | (static_cast<uint32_t> (tuple.sourcePort) << 16) | tuple.destinationPort) * 0x9e3779b97f4a7c15ULL;
+  // mix the bits, so that tuples differing only by the ports spread over the buckets
+  h ^= h >> 31;
+  h *= 0xbf58476d1ce4e5b9ULL;
+  h ^= h >> 29;
+  return static_cast<size_t> (h);
+}
+
 Ipv6FlowClassifier::Ipv6FlowClassifier ()
 {
 }
@@ -149,35 +164,30 @@ Ipv6FlowClassifier::Classify (const Ipv6Header &ipHeader, Ptr<const Packet> ipPa
   tuple.destinationPort = dstPort;
 
   // try to insert the tuple, but check if it already exists
-  std::pair<std::map<FiveTuple, FlowId>::iterator, bool> insert
+  std::pair<std::unordered_map<FiveTuple, FlowId, FiveTupleHash>::iterator, bool> insert
     = m_flowMap.insert (std::pair<FiveTuple, FlowId> (tuple, 0));
 
   // if the insertion succeeded, we need to assign this tuple a new flow identifier
+  FlowPacketId packetId;
   if (insert.second)
     {
       FlowId newFlowId = GetNewFlowId ();
       insert.first->second = newFlowId;
-      m_flowPktIdMap[newFlowId] = 0;
-      m_flowDscpMap[newFlowId];
+      FlowState &state = m_flowStateMap[newFlowId];
+      state.tuple = &insert.first->first;
+      state.lastPacketId = 0;
+      packetId = 0;
     }
   else
     {
-      m_flowPktIdMap[insert.first->second] ++;
+      packetId = ++m_flowStateMap[insert.first->second].lastPacketId;
     }
 
   // increment the counter of packets with the same DSCP value
-  Ipv6Header::DscpType dscp = ipHeader.GetDscp ();
-  std::pair<std::map<Ipv6Header::DscpType, uint32_t>::iterator, bool> dscpInserter
-    = m_flowDscpMap[insert.first->second].insert (std::pair<Ipv6Header::DscpType, uint32_t> (dscp, 1));
-
-  // if the insertion did not succeed, we need to increment the counter
-  if (!dscpInserter.second)
-    {
-      m_flowDscpMap[insert.first->second][dscp] ++;
-    }
+  ++m_flowDscpMap[insert.first->second][ipHeader.GetDscp ()];
 
   *out_flowId = insert.first->second;
-  *out_packetId = m_flowPktIdMap[*out_flowId];
+  *out_packetId = packetId;
 
   return true;
 }
@@ -186,19 +196,37 @@ Ipv6FlowClassifier::Classify (const Ipv6Header &ipHeader, Ptr<const Packet> ipPa
 Ipv6FlowClassifier::FiveTuple
 Ipv6FlowClassifier::FindFlow (FlowId flowId) const
 {
-  for (std::map<FiveTuple, FlowId>::const_iterator
-       iter = m_flowMap.begin (); iter != m_flowMap.end (); iter++)
+  std::unordered_map<FlowId, FlowState>::const_iterator state = m_flowStateMap.find (flowId);
+  if (state != m_flowStateMap.end ())
     {
-      if (iter->second == flowId)
-        {
-          return iter->first;
-        }
+      return *state->second.tuple;
     }
   NS_FATAL_ERROR ("Could not find the flow with ID " << flowId);
   FiveTuple retval = { Ipv6Address::GetZero (), Ipv6Address::GetZero (), 0, 0, 0 };
   return retval;
 }
 
+void
+Ipv6FlowClassifier::RemoveFlows (const std::unordered_set<FlowId> &flowIds)
+{
+  for (std::unordered_set<FlowId>::const_iterator iter = flowIds.begin (); iter != flowIds.end (); iter++)
+    {
+      std::unordered_map<FlowId, FlowState>::iterator state = m_flowStateMap.find (*iter);
+      if (state != m_flowStateMap.end ())
+        {
+          m_flowMap.erase (*state->second.tuple);
+          m_flowStateMap.erase (state);
+          m_flowDscpMap.erase (*iter);
+        }
+    }
+}
+
+uint32_t
+Ipv6FlowClassifier::GetNFlows (void) const
+{
+  return m_flowMap.size ();
+}
+
 bool
 Ipv6FlowClassifier::SortByCount::operator() (std::pair<Ipv6Header::DscpType, uint32_t> left,
                                              std::pair<Ipv6Header::DscpType, uint32_t> right)
@@ -209,7 +237,7 @@ Ipv6FlowClassifier::SortByCount::operator() (std::pair<Ipv6Header::DscpType, uin
 std::vector<std::pair<Ipv6Header::DscpType, uint32_t> >
 Ipv6FlowClassifier::GetDscpCounts (FlowId flowId) const
 {
-  std::map<FlowId, std::map<Ipv6Header::DscpType, uint32_t> >::const_iterator flow
+  std::unordered_map<FlowId, std::map<Ipv6Header::DscpType, uint32_t> >::const_iterator flow
     = m_flowDscpMap.find (flowId);
 
   if (flow == m_flowDscpMap.end ())
@@ -228,20 +256,29 @@ Ipv6FlowClassifier::SerializeToXmlStream (std::ostream &os, uint16_t indent) con
   Indent (os, indent); os << "<Ipv6FlowClassifier>\n";
 
   indent += 2;
-  for (std::map<FiveTuple, FlowId>::const_iterator
+  // write the flows sorted by FlowId
+  std::vector<std::pair<FlowId, const FiveTuple*> > flows;
+  flows.reserve (m_flowMap.size ());
+  for (std::unordered_map<FiveTuple, FlowId, FiveTupleHash>::const_iterator
        iter = m_flowMap.begin (); iter != m_flowMap.end (); iter++)
+    {
+      flows.push_back (std::make_pair (iter->second, &iter->first));
+    }
+  std::sort (flows.begin (), flows.end ());
+  for (std::vector<std::pair<FlowId, const FiveTuple*> >::const_iterator
+       iter = flows.begin (); iter != flows.end (); iter++)
     {
       Indent (os, indent);
-      os << "<Flow flowId=\"" << iter->second << "\""
-         << " sourceAddress=\"" << iter->first.sourceAddress << "\""
-         << " destinationAddress=\"" << iter->first.destinationAddress << "\""
-         << " protocol=\"" << int(iter->first.protocol) << "\""
-         << " sourcePort=\"" << iter->first.sourcePort << "\""
-         << " destinationPort=\"" << iter->first.destinationPort << "\">\n";
+      os << "<Flow flowId=\"" << iter->first << "\""
+         << " sourceAddress=\"" << iter->second->sourceAddress << "\""
+         << " destinationAddress=\"" << iter->second->destinationAddress << "\""
+         << " protocol=\"" << int(iter->second->protocol) << "\""
+         << " sourcePort=\"" << iter->second->sourcePort << "\""
+         << " destinationPort=\"" << iter->second->destinationPort << "\">\n";
 
       indent += 2;
-      std::map<FlowId, std::map<Ipv6Header::DscpType, uint32_t> >::const_iterator flow
-        = m_flowDscpMap.find (iter->second);
+      std::unordered_map<FlowId, std::map<Ipv6Header::DscpType, uint32_t> >::const_iterator flow
+        = m_flowDscpMap.find (iter->first);
 
       if (flow != m_flowDscpMap.end ())
         {
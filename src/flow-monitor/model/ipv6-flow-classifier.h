@@ -24,6 +24,7 @@
 
 #include <stdint.h>
 #include <map>
+#include <unordered_map>
 
 #include "ns3/ipv6-header.h"
 #include "ns3/flow-classifier.h"
@@ -50,6 +51,16 @@ public:
     uint16_t destinationPort;       //!< Destination port
   };
 
+  /// Hash function of a FiveTuple
+  class FiveTupleHash : public std::unary_function<FiveTuple, size_t>
+  {
+  public:
+    /// Returns the hash of the tuple
+    /// \param tuple the tuple
+    /// \return the hash
+    size_t operator() (const FiveTuple &tuple) const;
+  };
+
   Ipv6FlowClassifier ();
 
   /// \brief try to classify the packet into flow-id and packet-id
@@ -91,14 +102,25 @@ public:
 
   virtual void SerializeToXmlStream (std::ostream &os, uint16_t indent) const;
 
+  virtual void RemoveFlows (const std::unordered_set<FlowId> &flowIds);
+
+  /// \returns the number of flows known to the classifier
+  uint32_t GetNFlows (void) const;
+
 private:
 
   /// Map to Flows Identifiers to FlowIds
-  std::map<FiveTuple, FlowId> m_flowMap;
-  /// Map to FlowIds to FlowPacketId
-  std::map<FlowId, FlowPacketId> m_flowPktIdMap;
+  std::unordered_map<FiveTuple, FlowId, FiveTupleHash> m_flowMap;
+  /// State of a flow
+  struct FlowState
+  {
+    const FiveTuple *tuple;    //!< Tuple of the flow, i.e., key of its entry of m_flowMap
+    FlowPacketId lastPacketId; //!< Identifier of the last packet of the flow
+  };
+  /// Map to FlowIds to their state
+  std::unordered_map<FlowId, FlowState> m_flowStateMap;
   /// Map FlowIds to (DSCP value, packet count) pairs
-  std::map<FlowId, std::map<Ipv6Header::DscpType, uint32_t> > m_flowDscpMap;
+  std::unordered_map<FlowId, std::map<Ipv6Header::DscpType, uint32_t> > m_flowDscpMap;
 
 };
 
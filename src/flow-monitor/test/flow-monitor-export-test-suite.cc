@@ -0,0 +1,375 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <fstream>
+#include <sstream>
+#include <map>
+
+#include "ns3/flow-monitor.h"
+#include "ns3/flow-probe.h"
+#include "ns3/ipv4-flow-classifier.h"
+#include "ns3/ipv6-flow-classifier.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/nstime.h"
+#include "ns3/test.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup flow-monitor-test
+ * \ingroup tests
+ *
+ * \brief Probe reporting the packet events scheduled by the test
+ */
+class ExportTestProbe : public FlowProbe
+{
+public:
+  /**
+   * Constructor
+   * \param monitor the FlowMonitor
+   */
+  ExportTestProbe (Ptr<FlowMonitor> monitor)
+    : FlowProbe (monitor)
+  {
+  }
+};
+
+/**
+ * \ingroup flow-monitor-test
+ * \ingroup tests
+ *
+ * \brief FlowMonitor streaming export Test
+ *
+ * Two flows are reported to the FlowMonitor: the first one has two
+ * packets received, the second one has a packet lost.  The sum of the
+ * exported records of each flow must give its statistics, and the idle
+ * flows must be removed once exported.
+ */
+class FlowMonitorExportTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor
+   * \param format the format of the export
+   */
+  FlowMonitorExportTestCase (FlowMonitor::ExportFormat format);
+
+private:
+  virtual void DoRun (void);
+
+  /// Totals of the exported records of a flow
+  struct Totals
+  {
+    Totals () : txBytes (0), rxBytes (0), txPackets (0), rxPackets (0), lostPackets (0), delaySum (0) {}
+    uint64_t txBytes;     //!< transmitted bytes
+    uint64_t rxBytes;     //!< received bytes
+    uint32_t txPackets;   //!< transmitted packets
+    uint32_t rxPackets;   //!< received packets
+    uint32_t lostPackets; //!< lost packets
+    int64_t delaySum;     //!< sum of the delays (ns)
+  };
+
+  /**
+   * Read the exported records
+   * \param fileName the name of the file
+   * \return the totals of each flow
+   */
+  std::map<FlowId, Totals> ReadRecords (std::string fileName);
+
+  /**
+   * Read an integer in little endian byte order
+   * \param is the input stream
+   * \param size the number of bytes to read
+   * \return the integer
+   */
+  static uint64_t ReadLittleEndian (std::istream &is, uint32_t size);
+
+  FlowMonitor::ExportFormat m_format; //!< the format of the export
+};
+
+FlowMonitorExportTestCase::FlowMonitorExportTestCase (FlowMonitor::ExportFormat format)
+  : TestCase (format == FlowMonitor::CSV ? "Streaming export in CSV format" : "Streaming export in binary format"),
+    m_format (format)
+{
+}
+
+uint64_t
+FlowMonitorExportTestCase::ReadLittleEndian (std::istream &is, uint32_t size)
+{
+  uint64_t value = 0;
+  for (uint32_t i = 0; i < size; i++)
+    {
+      value |= static_cast<uint64_t> (static_cast<uint8_t> (is.get ())) << (8 * i);
+    }
+  return value;
+}
+
+std::map<FlowId, FlowMonitorExportTestCase::Totals>
+FlowMonitorExportTestCase::ReadRecords (std::string fileName)
+{
+  std::map<FlowId, Totals> totals;
+  std::ifstream is (fileName.c_str (), std::ios::in|std::ios::binary);
+  NS_TEST_EXPECT_MSG_EQ (is.is_open (), true, "Could not open " << fileName);
+
+  if (m_format == FlowMonitor::CSV)
+    {
+      std::string line;
+      std::getline (is, line);
+      NS_TEST_EXPECT_MSG_EQ (line.substr (0, 12), "time,flowId,", "Unexpected header");
+      while (std::getline (is, line))
+        {
+          std::istringstream fields (line);
+          int64_t time, delaySum, jitterSum;
+          uint64_t flowId, txBytes, rxBytes, txPackets, rxPackets, lostPackets, timesForwarded;
+          char c;
+          fields >> time >> c >> flowId >> c >> txBytes >> c >> rxBytes >> c >> txPackets >> c
+                 >> rxPackets >> c >> lostPackets >> c >> timesForwarded >> c >> delaySum >> c >> jitterSum;
+          NS_TEST_EXPECT_MSG_EQ (fields.fail (), false, "Could not parse " << line);
+          Totals &t = totals[flowId];
+          t.txBytes += txBytes;
+          t.rxBytes += rxBytes;
+          t.txPackets += txPackets;
+          t.rxPackets += rxPackets;
+          t.lostPackets += lostPackets;
+          t.delaySum += delaySum;
+        }
+    }
+  else
+    {
+      while (is.peek () != EOF)
+        {
+          ReadLittleEndian (is, 8);
+          FlowId flowId = ReadLittleEndian (is, 4);
+          Totals &t = totals[flowId];
+          t.txPackets += ReadLittleEndian (is, 4);
+          t.rxPackets += ReadLittleEndian (is, 4);
+          t.lostPackets += ReadLittleEndian (is, 4);
+          ReadLittleEndian (is, 4);
+          t.txBytes += ReadLittleEndian (is, 8);
+          t.rxBytes += ReadLittleEndian (is, 8);
+          t.delaySum += static_cast<int64_t> (ReadLittleEndian (is, 8));
+          ReadLittleEndian (is, 8);
+          NS_TEST_EXPECT_MSG_EQ (is.fail (), false, "Truncated record");
+        }
+    }
+  return totals;
+}
+
+void
+FlowMonitorExportTestCase::DoRun (void)
+{
+  std::string fileName = CreateTempDirFilename ("flow-monitor-export");
+
+  Ptr<FlowMonitor> monitor = CreateObject<FlowMonitor> ();
+  monitor->SetAttribute ("MaxPerHopDelay", TimeValue (Seconds (1)));
+  monitor->SetAttribute ("FlowIdleTimeout", TimeValue (Seconds (2)));
+  Ptr<FlowProbe> probe = CreateObject<ExportTestProbe> (monitor);
+  monitor->EnableStreamingExport (fileName, Seconds (1), m_format);
+
+  // flow 1: two packets received, one after an export
+  Simulator::Schedule (Seconds (0.1), &FlowMonitor::ReportFirstTx, monitor, probe, 1, 0, 100);
+  Simulator::Schedule (Seconds (0.2), &FlowMonitor::ReportLastRx, monitor, probe, 1, 0, 100);
+  Simulator::Schedule (Seconds (0.4), &FlowMonitor::ReportFirstTx, monitor, probe, 1, 1, 100);
+  Simulator::Schedule (Seconds (1.5), &FlowMonitor::ReportLastRx, monitor, probe, 1, 1, 100);
+  // flow 2: a packet lost
+  Simulator::Schedule (Seconds (0.3), &FlowMonitor::ReportFirstTx, monitor, probe, 2, 0, 200);
+
+  Simulator::Stop (Seconds (3.5));
+  Simulator::Run ();
+  // flow 2 is idle since 0.3 s, flow 1 since 1.5 s
+  NS_TEST_EXPECT_MSG_EQ (monitor->GetFlowStats ().size (), 1, "Flow 2 should have been removed");
+  NS_TEST_EXPECT_MSG_EQ (monitor->GetFlowStats ().count (1), 1, "Flow 1 should not have been removed");
+
+  Simulator::Stop (Seconds (1));
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (monitor->GetFlowStats ().size (), 0, "Flow 1 should have been removed");
+  NS_TEST_EXPECT_MSG_EQ (probe->GetStats ().size (), 0, "The probe should not keep the removed flows");
+
+  Simulator::Destroy ();
+  monitor->Dispose ();
+
+  std::map<FlowId, Totals> totals = ReadRecords (fileName);
+  NS_TEST_ASSERT_MSG_EQ (totals.size (), 2, "Unexpected number of flows exported");
+  NS_TEST_EXPECT_MSG_EQ (totals[1].txPackets, 2, "Unexpected transmitted packets of flow 1");
+  NS_TEST_EXPECT_MSG_EQ (totals[1].rxPackets, 2, "Unexpected received packets of flow 1");
+  NS_TEST_EXPECT_MSG_EQ (totals[1].txBytes, 200, "Unexpected transmitted bytes of flow 1");
+  NS_TEST_EXPECT_MSG_EQ (totals[1].rxBytes, 200, "Unexpected received bytes of flow 1");
+  NS_TEST_EXPECT_MSG_EQ (totals[1].lostPackets, 0, "Unexpected lost packets of flow 1");
+  NS_TEST_EXPECT_MSG_EQ (totals[1].delaySum, MilliSeconds (1200).GetNanoSeconds (), "Unexpected delay of flow 1");
+  NS_TEST_EXPECT_MSG_EQ (totals[2].txPackets, 1, "Unexpected transmitted packets of flow 2");
+  NS_TEST_EXPECT_MSG_EQ (totals[2].rxPackets, 0, "Unexpected received packets of flow 2");
+  NS_TEST_EXPECT_MSG_EQ (totals[2].txBytes, 200, "Unexpected transmitted bytes of flow 2");
+  NS_TEST_EXPECT_MSG_EQ (totals[2].lostPackets, 1, "Unexpected lost packets of flow 2");
+}
+
+/**
+ * \ingroup flow-monitor-test
+ * \ingroup tests
+ *
+ * \brief FlowMonitor idle flows removal from the classifiers Test
+ *
+ * A new UDP flow is classified by an IPv4 and an IPv6 classifier every
+ * 100 ms, and its packet reported to the FlowMonitor.  With an export
+ * every second and an idle timeout of one second, the classifiers must
+ * only keep the flows of the last two seconds, and a packet of a removed
+ * flow must start a new flow.
+ */
+class FlowMonitorClassifierRemovalTestCase : public TestCase
+{
+public:
+  FlowMonitorClassifierRemovalTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Classify a packet of a flow and report it to the FlowMonitor
+   * \param sourcePort the source port of the flow
+   * \param flowId the FlowId of the flow
+   * \param packetId the identifier of the packet
+   */
+  void Classify (uint16_t sourcePort, FlowId *flowId, FlowPacketId *packetId);
+  /**
+   * Start a flow
+   * \param sourcePort the source port of the flow
+   */
+  void StartFlow (uint16_t sourcePort);
+  /// Record the number of flows of the classifiers
+  void CheckSize (void);
+
+  Ptr<FlowMonitor> m_monitor;                   //!< the FlowMonitor
+  Ptr<FlowProbe> m_probe;                       //!< the probe reporting the packets
+  Ptr<Ipv4FlowClassifier> m_ipv4Classifier;     //!< the IPv4 classifier
+  Ptr<Ipv6FlowClassifier> m_ipv6Classifier;     //!< the IPv6 classifier
+  uint32_t m_maxFlows;                          //!< the maximum number of flows of the classifiers
+};
+
+FlowMonitorClassifierRemovalTestCase::FlowMonitorClassifierRemovalTestCase ()
+  : TestCase ("Idle flows removed from the classifiers"),
+    m_maxFlows (0)
+{
+}
+
+void
+FlowMonitorClassifierRemovalTestCase::Classify (uint16_t sourcePort, FlowId *flowId, FlowPacketId *packetId)
+{
+  uint8_t ports[4] = { static_cast<uint8_t> (sourcePort >> 8), static_cast<uint8_t> (sourcePort & 0xff), 0, 9 };
+  Ptr<Packet> payload = Create<Packet> (ports, 4);
+
+  Ipv4Header ipv4Header;
+  ipv4Header.SetSource (Ipv4Address ("10.0.0.1"));
+  ipv4Header.SetDestination (Ipv4Address ("10.0.0.2"));
+  ipv4Header.SetProtocol (17);
+  NS_TEST_EXPECT_MSG_EQ (m_ipv4Classifier->Classify (ipv4Header, payload, flowId, packetId), true,
+                         "The IPv4 packet should be classified");
+
+  Ipv6Header ipv6Header;
+  ipv6Header.SetSourceAddress (Ipv6Address ("2001:1::1"));
+  ipv6Header.SetDestinationAddress (Ipv6Address ("2001:1::2"));
+  ipv6Header.SetNextHeader (17);
+  FlowId ipv6FlowId;
+  FlowPacketId ipv6PacketId;
+  NS_TEST_EXPECT_MSG_EQ (m_ipv6Classifier->Classify (ipv6Header, payload, &ipv6FlowId, &ipv6PacketId), true,
+                         "The IPv6 packet should be classified");
+  NS_TEST_EXPECT_MSG_EQ (ipv6FlowId, *flowId, "The classifiers should see the same flows");
+
+  m_monitor->ReportFirstTx (m_probe, *flowId, *packetId, 100);
+  m_monitor->ReportLastRx (m_probe, *flowId, *packetId, 100);
+}
+
+void
+FlowMonitorClassifierRemovalTestCase::StartFlow (uint16_t sourcePort)
+{
+  FlowId flowId;
+  FlowPacketId packetId;
+  Classify (sourcePort, &flowId, &packetId);
+  NS_TEST_EXPECT_MSG_EQ (packetId, 0, "The packet should start a new flow");
+}
+
+void
+FlowMonitorClassifierRemovalTestCase::CheckSize (void)
+{
+  NS_TEST_EXPECT_MSG_EQ (m_ipv6Classifier->GetNFlows (), m_ipv4Classifier->GetNFlows (),
+                         "The classifiers should have the same flows");
+  m_maxFlows = std::max (m_maxFlows, m_ipv4Classifier->GetNFlows ());
+}
+
+void
+FlowMonitorClassifierRemovalTestCase::DoRun (void)
+{
+  std::string fileName = CreateTempDirFilename ("flow-monitor-classifier-removal");
+
+  m_monitor = CreateObject<FlowMonitor> ();
+  m_monitor->SetAttribute ("FlowIdleTimeout", TimeValue (Seconds (1)));
+  m_probe = CreateObject<ExportTestProbe> (m_monitor);
+  m_ipv4Classifier = Create<Ipv4FlowClassifier> ();
+  m_ipv6Classifier = Create<Ipv6FlowClassifier> ();
+  m_monitor->AddFlowClassifier (m_ipv4Classifier);
+  m_monitor->AddFlowClassifier (m_ipv6Classifier);
+  m_monitor->EnableStreamingExport (fileName, Seconds (1), FlowMonitor::BINARY);
+
+  // 100 flows, 10 per second
+  for (uint16_t i = 0; i < 100; i++)
+    {
+      Simulator::Schedule (MilliSeconds (50 + 100 * i), &FlowMonitorClassifierRemovalTestCase::StartFlow, this, 1000 + i);
+      Simulator::Schedule (MilliSeconds (99 + 100 * i), &FlowMonitorClassifierRemovalTestCase::CheckSize, this);
+    }
+  Simulator::Stop (MilliSeconds (10001));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_LT_OR_EQ (m_maxFlows, 20, "The classifiers should only keep the flows of the last two seconds");
+  NS_TEST_EXPECT_MSG_EQ (m_ipv4Classifier->GetNFlows (), 10, "Only the flows of the last second should be kept");
+  NS_TEST_EXPECT_MSG_EQ (m_monitor->GetFlowStats ().size (), 10, "Only the flows of the last second should be kept");
+
+  // a packet of the first flow, removed, starts a new flow; one of the
+  // last flow, not removed, does not
+  FlowId flowId;
+  FlowPacketId packetId;
+  Classify (1000, &flowId, &packetId);
+  NS_TEST_EXPECT_MSG_EQ (flowId, 101, "The removed flow should get a new FlowId");
+  NS_TEST_EXPECT_MSG_EQ (packetId, 0, "The removed flow should start again");
+  Classify (1099, &flowId, &packetId);
+  NS_TEST_EXPECT_MSG_EQ (flowId, 100, "The last flow should keep its FlowId");
+  NS_TEST_EXPECT_MSG_EQ (packetId, 1, "The last flow should go on");
+
+  Simulator::Destroy ();
+  m_monitor->Dispose ();
+  m_monitor = 0;
+  m_probe = 0;
+}
+
+/**
+ * \ingroup flow-monitor-test
+ * \ingroup tests
+ *
+ * \brief FlowMonitor streaming export TestSuite
+ */
+class FlowMonitorExportTestSuite : public TestSuite
+{
+public:
+  FlowMonitorExportTestSuite ();
+};
+
+FlowMonitorExportTestSuite::FlowMonitorExportTestSuite ()
+  : TestSuite ("flow-monitor-export", UNIT)
+{
+  AddTestCase (new FlowMonitorExportTestCase (FlowMonitor::CSV), TestCase::QUICK);
+  AddTestCase (new FlowMonitorExportTestCase (FlowMonitor::BINARY), TestCase::QUICK);
+  AddTestCase (new FlowMonitorClassifierRemovalTestCase, TestCase::QUICK);
+}
+
+static FlowMonitorExportTestSuite g_flowMonitorExportTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,149 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/flow-monitor.h"
+#include "ns3/flow-probe.h"
+#include "ns3/simulator.h"
+#include "ns3/nstime.h"
+#include "ns3/test.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup flow-monitor-test
+ * \ingroup tests
+ *
+ * \brief Probe reporting the packet events scheduled by the test
+ */
+class LossTestProbe : public FlowProbe
+{
+public:
+  /**
+   * Constructor
+   * \param monitor the FlowMonitor
+   */
+  LossTestProbe (Ptr<FlowMonitor> monitor)
+    : FlowProbe (monitor)
+  {
+  }
+};
+
+/**
+ * \ingroup flow-monitor-test
+ * \ingroup tests
+ *
+ * \brief FlowMonitor lost packets Test
+ *
+ * The packets of a flow are transmitted, forwarded, received, dropped
+ * or transmitted again, and the lost packets are checked for with a
+ * maximum delay of one second: besides the dropped packet, only the
+ * packets not seen for at least that long must be counted as lost, and
+ * only once.
+ */
+class FlowMonitorLossTestCase : public TestCase
+{
+public:
+  FlowMonitorLossTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Check for the lost packets and record the number of lost packets
+   * \param monitor the FlowMonitor
+   * \param index the index of the check
+   */
+  void Check (Ptr<FlowMonitor> monitor, uint32_t index);
+
+  uint32_t m_lostPackets[4]; //!< number of lost packets after each check
+};
+
+FlowMonitorLossTestCase::FlowMonitorLossTestCase ()
+  : TestCase ("Lost packets")
+{
+}
+
+void
+FlowMonitorLossTestCase::Check (Ptr<FlowMonitor> monitor, uint32_t index)
+{
+  monitor->CheckForLostPackets (Seconds (1));
+  m_lostPackets[index] = monitor->GetFlowStats ().find (1)->second.lostPackets;
+}
+
+void
+FlowMonitorLossTestCase::DoRun (void)
+{
+  Ptr<FlowMonitor> monitor = CreateObject<FlowMonitor> ();
+  // the periodic checks should not find any lost packet
+  monitor->SetAttribute ("MaxPerHopDelay", TimeValue (Seconds (100)));
+  Ptr<FlowProbe> probe = CreateObject<LossTestProbe> (monitor);
+  monitor->Start (Seconds (0));
+
+  // packet 0: forwarded at 0.8 s, lost at 1.8 s
+  Simulator::Schedule (Seconds (0.1), &FlowMonitor::ReportFirstTx, monitor, probe, 1, 0, 100);
+  Simulator::Schedule (Seconds (0.8), &FlowMonitor::ReportForwarding, monitor, probe, 1, 0, 100);
+  // packet 1: lost at 1.2 s
+  Simulator::Schedule (Seconds (0.2), &FlowMonitor::ReportFirstTx, monitor, probe, 1, 1, 100);
+  // packet 2: received
+  Simulator::Schedule (Seconds (0.3), &FlowMonitor::ReportFirstTx, monitor, probe, 1, 2, 100);
+  Simulator::Schedule (Seconds (0.5), &FlowMonitor::ReportLastRx, monitor, probe, 1, 2, 100);
+  // packet 3: dropped
+  Simulator::Schedule (Seconds (0.4), &FlowMonitor::ReportFirstTx, monitor, probe, 1, 3, 100);
+  Simulator::Schedule (Seconds (0.6), &FlowMonitor::ReportDrop, monitor, probe, 1, 3, 100, 0);
+  // packet 4: transmitted again at 1.3 s, lost at 2.3 s
+  Simulator::Schedule (Seconds (0.9), &FlowMonitor::ReportFirstTx, monitor, probe, 1, 4, 100);
+  Simulator::Schedule (Seconds (1.3), &FlowMonitor::ReportFirstTx, monitor, probe, 1, 4, 100);
+
+  Simulator::Schedule (Seconds (1.1), &FlowMonitorLossTestCase::Check, this, monitor, 0);
+  Simulator::Schedule (Seconds (1.5), &FlowMonitorLossTestCase::Check, this, monitor, 1);
+  Simulator::Schedule (Seconds (2), &FlowMonitorLossTestCase::Check, this, monitor, 2);
+  Simulator::Schedule (Seconds (3), &FlowMonitorLossTestCase::Check, this, monitor, 3);
+
+  Simulator::Stop (Seconds (4));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  // the dropped packet is counted as lost
+  NS_TEST_EXPECT_MSG_EQ (m_lostPackets[0], 1, "Only packet 3 should be lost at 1.1 s");
+  NS_TEST_EXPECT_MSG_EQ (m_lostPackets[1], 2, "Only packets 1 and 3 should be lost at 1.5 s");
+  NS_TEST_EXPECT_MSG_EQ (m_lostPackets[2], 3, "Only packets 0, 1 and 3 should be lost at 2 s");
+  NS_TEST_EXPECT_MSG_EQ (m_lostPackets[3], 4, "Only packet 2 should not be lost at 3 s");
+
+  const FlowMonitor::FlowStats &stats = monitor->GetFlowStats ().find (1)->second;
+  NS_TEST_EXPECT_MSG_EQ (stats.rxPackets, 1, "Only packet 2 should be received");
+  NS_TEST_EXPECT_MSG_EQ (stats.packetsDropped.size (), 1, "Only packet 3 should be dropped");
+  monitor->Dispose ();
+}
+
+/**
+ * \ingroup flow-monitor-test
+ * \ingroup tests
+ *
+ * \brief FlowMonitor lost packets TestSuite
+ */
+class FlowMonitorLossTestSuite : public TestSuite
+{
+public:
+  FlowMonitorLossTestSuite ();
+};
+
+FlowMonitorLossTestSuite::FlowMonitorLossTestSuite ()
+  : TestSuite ("flow-monitor-loss", UNIT)
+{
+  AddTestCase (new FlowMonitorLossTestCase, TestCase::QUICK);
+}
+
+static FlowMonitorLossTestSuite g_flowMonitorLossTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,228 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/flow-monitor-helper.h"
+#include "ns3/flow-monitor.h"
+#include "ns3/ipv4-flow-classifier.h"
+#include "ns3/ipv6-flow-classifier.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv6-address-helper.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/inet6-socket-address.h"
+#include "ns3/tcp-socket-factory.h"
+#include "ns3/icmpv6-l4-protocol.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup flow-monitor-test
+ * \ingroup tests
+ *
+ * \brief FlowMonitor accounting of TCP super-segments
+ *
+ * A bulk transfer is sent with TCP segmentation offload. Each super-segment
+ * must be accounted for as the segments it is split into, so that the sent
+ * and received packets and bytes match and no packet is lost.
+ */
+class FlowMonitorOffloadTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor
+   *
+   * \param ipv6 true to use IPv6, false to use IPv4
+   */
+  FlowMonitorOffloadTestCase (bool ipv6);
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Fill the transmission buffer of the sender
+   * \param socket the sender socket
+   * \param available the space available in the transmission buffer
+   */
+  void Send (Ptr<Socket> socket, uint32_t available);
+  /**
+   * \brief Accept a connection
+   * \param socket the accepted socket
+   * \param from the address of the peer
+   */
+  void Accept (Ptr<Socket> socket, const Address &from);
+  /**
+   * \brief Read the received data
+   * \param socket the receiver socket
+   */
+  void Receive (Ptr<Socket> socket);
+
+  static const uint32_t m_totalBytes = 200000; //!< Size of the transfer
+  static const uint32_t m_segmentSize = 1000;  //!< Segment size
+  bool m_ipv6;          //!< true to use IPv6
+  uint32_t m_sent;      //!< Bytes given to the sender socket
+  uint32_t m_received;  //!< Bytes read from the receiver socket
+};
+
+FlowMonitorOffloadTestCase::FlowMonitorOffloadTestCase (bool ipv6)
+  : TestCase (std::string ("FlowMonitor accounting of TCP super-segments over ") + (ipv6 ? "IPv6" : "IPv4")),
+    m_ipv6 (ipv6),
+    m_sent (0),
+    m_received (0)
+{
+}
+
+void
+FlowMonitorOffloadTestCase::Send (Ptr<Socket> socket, uint32_t available)
+{
+  while (m_sent < m_totalBytes && socket->GetTxAvailable () > 0)
+    {
+      uint32_t size = std::min (socket->GetTxAvailable (), m_totalBytes - m_sent);
+      int sent = socket->Send (Create<Packet> (size));
+      if (sent <= 0)
+        {
+          break;
+        }
+      m_sent += sent;
+    }
+  if (m_sent == m_totalBytes)
+    {
+      socket->Close ();
+    }
+}
+
+void
+FlowMonitorOffloadTestCase::Accept (Ptr<Socket> socket, const Address &from)
+{
+  socket->SetRecvCallback (MakeCallback (&FlowMonitorOffloadTestCase::Receive, this));
+}
+
+void
+FlowMonitorOffloadTestCase::Receive (Ptr<Socket> socket)
+{
+  Ptr<Packet> packet;
+  while ((packet = socket->Recv ()))
+    {
+      m_received += packet->GetSize ();
+    }
+}
+
+void
+FlowMonitorOffloadTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+  SimpleNetDeviceHelper simple;
+  simple.SetChannelAttribute ("Delay", TimeValue (MilliSeconds (10)));
+  NetDeviceContainer devices = simple.Install (nodes);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+
+  Address serverAddress;
+  Address listenAddress;
+  if (m_ipv6)
+    {
+      for (uint32_t i = 0; i < nodes.GetN (); i++)
+        {
+          nodes.Get (i)->GetObject<Icmpv6L4Protocol> ()->SetAttribute ("DAD", BooleanValue (false));
+        }
+      Ipv6AddressHelper address (Ipv6Address ("2001:1::"), Ipv6Prefix (64));
+      Ipv6InterfaceContainer interfaces = address.Assign (devices);
+      serverAddress = Inet6SocketAddress (interfaces.GetAddress (1, 1), 80);
+      listenAddress = Inet6SocketAddress (Ipv6Address::GetAny (), 80);
+    }
+  else
+    {
+      Ipv4AddressHelper address ("10.1.1.0", "255.255.255.0");
+      Ipv4InterfaceContainer interfaces = address.Assign (devices);
+      serverAddress = InetSocketAddress (interfaces.GetAddress (1), 80);
+      listenAddress = InetSocketAddress (Ipv4Address::GetAny (), 80);
+    }
+
+  FlowMonitorHelper flowmon;
+  Ptr<FlowMonitor> monitor = flowmon.InstallAll ();
+
+  Ptr<Socket> server = Socket::CreateSocket (nodes.Get (1), TcpSocketFactory::GetTypeId ());
+  server->SetAttribute ("SegmentSize", UintegerValue (m_segmentSize));
+  server->Bind (listenAddress);
+  server->Listen ();
+  server->SetAcceptCallback (MakeNullCallback<bool, Ptr<Socket>, const Address &> (),
+                             MakeCallback (&FlowMonitorOffloadTestCase::Accept, this));
+
+  Ptr<Socket> client = Socket::CreateSocket (nodes.Get (0), TcpSocketFactory::GetTypeId ());
+  client->SetAttribute ("Tso", BooleanValue (true));
+  client->SetAttribute ("SegmentSize", UintegerValue (m_segmentSize));
+  client->SetAttribute ("SndBufSize", UintegerValue (1 << 20));
+  client->SetSendCallback (MakeCallback (&FlowMonitorOffloadTestCase::Send, this));
+  client->Connect (serverAddress);
+
+  Simulator::Stop (Seconds (10));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_received, m_totalBytes, "The whole data should be received");
+
+  monitor->CheckForLostPackets ();
+  const FlowMonitor::FlowStatsContainer &stats = monitor->GetFlowStats ();
+  NS_TEST_ASSERT_MSG_EQ (stats.size (), 2, "There should be one flow in each direction");
+  for (auto& flow : stats)
+    {
+      NS_TEST_EXPECT_MSG_EQ (flow.second.rxPackets, flow.second.txPackets, "Packets of flow " << flow.first << " not received");
+      NS_TEST_EXPECT_MSG_EQ (flow.second.rxBytes, flow.second.txBytes, "Bytes of flow " << flow.first << " not received");
+      NS_TEST_EXPECT_MSG_EQ (flow.second.lostPackets, 0, "Packets of flow " << flow.first << " lost");
+    }
+
+  // the data flow is the one with the larger number of bytes
+  const FlowMonitor::FlowStats *data = 0;
+  for (auto& flow : stats)
+    {
+      if (data == 0 || flow.second.txBytes > data->txBytes)
+        {
+          data = &flow.second;
+        }
+    }
+  NS_TEST_EXPECT_MSG_GT_OR_EQ (data->txPackets, m_totalBytes / m_segmentSize,
+                               "Each segment of a super-segment should be counted as a packet");
+  NS_TEST_EXPECT_MSG_GT (data->txBytes, m_totalBytes + m_totalBytes / m_segmentSize * 40,
+                         "The headers of each segment should be counted");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup flow-monitor-test
+ * \ingroup tests
+ *
+ * \brief FlowMonitor segmentation offload TestSuite
+ */
+class FlowMonitorOffloadTestSuite : public TestSuite
+{
+public:
+  FlowMonitorOffloadTestSuite ();
+};
+
+FlowMonitorOffloadTestSuite::FlowMonitorOffloadTestSuite ()
+  : TestSuite ("flow-monitor-offload", UNIT)
+{
+  AddTestCase (new FlowMonitorOffloadTestCase (false), TestCase::QUICK);
+  AddTestCase (new FlowMonitorOffloadTestCase (true), TestCase::QUICK);
+}
+
+static FlowMonitorOffloadTestSuite g_flowMonitorOffloadTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,229 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cmath>
+
+#include "ns3/flow-sketch.h"
+#include "ns3/test.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup flow-monitor-test
+ * \ingroup tests
+ *
+ * \brief Count-Min sketch Test
+ *
+ * Key k is added k times, for 10000 keys: no estimate may be below the
+ * count, and the estimates exceeding the count by more than e/width
+ * times the total must be rare.
+ */
+class CountMinSketchTestCase : public TestCase
+{
+public:
+  CountMinSketchTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+CountMinSketchTestCase::CountMinSketchTestCase ()
+  : TestCase ("Count-Min sketch")
+{
+}
+
+void
+CountMinSketchTestCase::DoRun (void)
+{
+  const uint32_t width = 2048;
+  CountMinSketch sketch (width, 4);
+  const uint32_t nKeys = 10000;
+  for (uint32_t k = 1; k <= nKeys; k++)
+    {
+      sketch.Add (k, k);
+    }
+  NS_TEST_EXPECT_MSG_EQ (sketch.GetTotal (), uint64_t (nKeys) * (nKeys + 1) / 2, "Unexpected total");
+
+  double bound = std::exp (1.0) / width * sketch.GetTotal ();
+  uint32_t below = 0;
+  uint32_t beyond = 0;
+  for (uint32_t k = 1; k <= nKeys; k++)
+    {
+      uint64_t estimate = sketch.Estimate (k);
+      if (estimate < k)
+        {
+          below++;
+        }
+      if (estimate > k + bound)
+        {
+          beyond++;
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (below, 0, "An estimate is below the count");
+  // exp(-depth) is less than 2%
+  NS_TEST_EXPECT_MSG_LT (beyond, nKeys / 50, "Too many estimates beyond the error bound");
+
+  sketch.Clear ();
+  NS_TEST_EXPECT_MSG_EQ (sketch.Estimate (nKeys), 0, "The sketch was not cleared");
+  NS_TEST_EXPECT_MSG_EQ (sketch.Add (nKeys, 3), 3, "Unexpected estimate after the first addition");
+}
+
+/**
+ * \ingroup flow-monitor-test
+ * \ingroup tests
+ *
+ * \brief HyperLogLog Test
+ *
+ * The number of distinct keys must be estimated within a few standard
+ * errors, for small and large numbers of keys, including repeated keys
+ * and merged estimators.
+ */
+class HyperLogLogTestCase : public TestCase
+{
+public:
+  HyperLogLogTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+HyperLogLogTestCase::HyperLogLogTestCase ()
+  : TestCase ("HyperLogLog")
+{
+}
+
+void
+HyperLogLogTestCase::DoRun (void)
+{
+  HyperLogLog small (12);
+  for (uint32_t k = 0; k < 100; k++)
+    {
+      small.Add (k);
+      small.Add (k);
+    }
+  NS_TEST_EXPECT_MSG_EQ_TOL (small.Estimate (), 100, 5, "Inaccurate estimate of a few keys");
+
+  // standard error of about 1.6%
+  HyperLogLog first (12);
+  HyperLogLog second (12);
+  for (uint32_t k = 0; k < 100000; k++)
+    {
+      first.Add (k);
+      second.Add (k + 50000);
+    }
+  NS_TEST_EXPECT_MSG_EQ_TOL (first.Estimate (), 100000, 5000, "Inaccurate estimate of many keys");
+  first.Merge (second);
+  NS_TEST_EXPECT_MSG_EQ_TOL (first.Estimate (), 150000, 7500, "Inaccurate estimate of merged keys");
+}
+
+/**
+ * \ingroup flow-monitor-test
+ * \ingroup tests
+ *
+ * \brief Flow sketch Test
+ *
+ * Flow f has f packets of 100 bytes, for 1000 flows.  Without sampling,
+ * the heaviest flows and the flow size distribution must be found; with
+ * sampling, the sizes of the heaviest flows must be estimated within a
+ * few standard deviations.
+ */
+class FlowSketchTestCase : public TestCase
+{
+public:
+  FlowSketchTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+FlowSketchTestCase::FlowSketchTestCase ()
+  : TestCase ("Flow sketch")
+{
+}
+
+void
+FlowSketchTestCase::DoRun (void)
+{
+  const uint32_t nFlows = 1000;
+  FlowSketch exact (8192, 4, 12, 10, 1.0);
+  FlowSketch sampled (8192, 4, 12, 10, 0.1);
+  NS_TEST_EXPECT_MSG_EQ (FlowSketch ().IsEnabled (), false, "A default sketch should be disabled");
+
+  for (FlowId f = 1; f <= nFlows; f++)
+    {
+      for (FlowPacketId p = 0; p < f; p++)
+        {
+          exact.AddPacket (f, p, 100);
+          sampled.AddPacket (f, p, 100);
+        }
+    }
+
+  std::vector<std::pair<FlowId, double> > heavyHitters = exact.GetHeavyHitters ();
+  NS_TEST_ASSERT_MSG_EQ (heavyHitters.size (), 10, "Unexpected number of heavy hitters");
+  for (uint32_t i = 0; i < heavyHitters.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (heavyHitters[i].first, nFlows - i, "Unexpected heavy hitter");
+      NS_TEST_EXPECT_MSG_EQ (heavyHitters[i].second, (nFlows - i) * 100.0, "Unexpected heavy hitter size");
+    }
+  NS_TEST_EXPECT_MSG_EQ (exact.GetEstimatedPackets (500), 500, "Unexpected flow size");
+  NS_TEST_EXPECT_MSG_EQ (exact.GetSampledPackets (), nFlows * (nFlows + 1) / 2, "All packets should be sampled");
+  NS_TEST_EXPECT_MSG_EQ_TOL (exact.GetEstimatedFlows (), nFlows, 50, "Inaccurate number of flows");
+
+  // the flows with 2^k to 2^(k+1)-1 packets
+  const std::vector<uint32_t> &sizes = exact.GetFlowSizeDistribution ();
+  NS_TEST_ASSERT_MSG_EQ (sizes.size (), 10, "Unexpected number of size classes");
+  for (uint32_t k = 0; k < 9; k++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (sizes[k], 1u << k, "Unexpected number of flows in class " << k);
+    }
+  NS_TEST_EXPECT_MSG_EQ (sizes[9], nFlows - 511, "Unexpected number of flows in class 9");
+
+  // about a tenth of the 500500 packets are sampled
+  NS_TEST_EXPECT_MSG_EQ_TOL (sampled.GetSampledPackets (), 50050, 1500, "Unexpected number of sampled packets");
+  NS_TEST_EXPECT_MSG_EQ_TOL (sampled.GetEstimatedFlows (), nFlows, 50, "Inaccurate number of flows");
+  heavyHitters = sampled.GetHeavyHitters ();
+  NS_TEST_ASSERT_MSG_EQ (heavyHitters.size (), 10, "Unexpected number of heavy hitters");
+  for (uint32_t i = 0; i < heavyHitters.size (); i++)
+    {
+      // the standard deviation of the estimate of a flow of 1000 packets
+      // is about 9500 bytes
+      NS_TEST_EXPECT_MSG_GT (heavyHitters[i].first, nFlows - 200, "A small flow is a heavy hitter");
+      NS_TEST_EXPECT_MSG_EQ_TOL (heavyHitters[i].second, heavyHitters[i].first * 100.0, 30000,
+                                 "Inaccurate heavy hitter size");
+    }
+}
+
+/**
+ * \ingroup flow-monitor-test
+ * \ingroup tests
+ *
+ * \brief Flow sketch TestSuite
+ */
+class FlowSketchTestSuite : public TestSuite
+{
+public:
+  FlowSketchTestSuite ();
+};
+
+FlowSketchTestSuite::FlowSketchTestSuite ()
+  : TestSuite ("flow-sketch", UNIT)
+{
+  AddTestCase (new CountMinSketchTestCase, TestCase::QUICK);
+  AddTestCase (new HyperLogLogTestCase, TestCase::QUICK);
+  AddTestCase (new FlowSketchTestCase, TestCase::QUICK);
+}
+
+static FlowSketchTestSuite g_flowSketchTestSuite; //!< Static variable for test initialization
@@ -78,6 +78,20 @@ HistogramTestCase::DoRun (void)
     NS_TEST_EXPECT_MSG_EQ (h0.GetNBins (), 22, "");
     NS_TEST_EXPECT_MSG_EQ (h0.GetBinCount (21), 1, "");
   }
+
+  {
+    // Testing the maximum number of bins
+    Histogram h1 (0.5);
+    h1.SetMaxBins (4);
+    h1.AddValue (0.2);
+    h1.AddValue (1.7);
+    NS_TEST_EXPECT_MSG_EQ (h1.GetNBins (), 4, "");
+    h1.AddValue (1.9);
+    h1.AddValue (1000.0);
+    NS_TEST_EXPECT_MSG_EQ (h1.GetNBins (), 4, "The number of bins should not grow beyond the maximum");
+    NS_TEST_EXPECT_MSG_EQ (h1.GetBinCount (0), 1, "");
+    NS_TEST_EXPECT_MSG_EQ (h1.GetBinCount (3), 3, "The last bin should count the values beyond it");
+  }
 }
 
 /**
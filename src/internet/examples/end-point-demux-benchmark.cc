@@ -0,0 +1,177 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program serves as a benchmark for the end point demultiplexers used
+// by TCP and UDP to deliver the incoming segments to the sockets.
+//
+// The demux of a server node holds a listening end point (*:80) and
+// nEndPoints end points of the connections accepted from distinct peers, as
+// a web server with nEndPoints concurrent clients. The program measures the
+// time taken to allocate the end points, to look up the end points of
+// nLookups incoming segments (one out of ten is a new connection handled by
+// the listening end point) and to deallocate the end points, e.g.:
+//
+//    ./waf --run "end-point-demux-benchmark --nEndPoints=100000"
+//    ./waf --run "end-point-demux-benchmark --nEndPoints=100000 --ipv6=1"
+
+#include <iostream>
+#include <vector>
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "../model/ipv4-end-point-demux.h"
+#include "../model/ipv4-end-point.h"
+#include "../model/ipv6-end-point-demux.h"
+#include "../model/ipv6-end-point.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("EndPointDemuxBenchmark");
+
+/**
+ * \param i the index of a peer
+ * \return the IPv4 address of the peer
+ */
+static Ipv4Address
+GetIpv4Peer (uint32_t i)
+{
+  return Ipv4Address ((10u << 24) + (1u << 20) + i / 16);
+}
+
+/**
+ * \param i the index of a peer
+ * \return the IPv6 address of the peer
+ */
+static Ipv6Address
+GetIpv6Peer (uint32_t i)
+{
+  uint8_t address[16] = { 0x20, 0x01, 0x0d, 0xb8, 0, 2 };
+  address[13] = (i / 16) >> 16;
+  address[14] = (i / 16) >> 8;
+  address[15] = i / 16;
+  return Ipv6Address (address);
+}
+
+/**
+ * \param i the index of a peer
+ * \return the port of the peer
+ */
+static uint16_t
+GetPeerPort (uint32_t i)
+{
+  return 1024 + i % 16;
+}
+
+/**
+ * \brief Print the time taken by a number of operations
+ * \param what the operations
+ * \param n the number of operations
+ * \param ms the time in milliseconds
+ */
+static void
+Report (std::string what, uint32_t n, int64_t ms)
+{
+  std::cout << what << ": " << ms << " ms (" << (n ? ms * 1e6 / n : 0) << " ns per operation)" << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t nEndPoints = 100000;
+  uint32_t nLookups = 1000000;
+  bool ipv6 = false;
+
+  CommandLine cmd;
+  cmd.AddValue ("nEndPoints", "Number of connected end points", nEndPoints);
+  cmd.AddValue ("nLookups", "Number of lookups", nLookups);
+  cmd.AddValue ("ipv6", "Benchmark the IPv6 demux", ipv6);
+  cmd.Parse (argc, argv);
+
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  SystemWallClockMs clock;
+  uint32_t found = 0;
+
+  if (!ipv6)
+    {
+      Ptr<Ipv4Interface> interface = CreateObject<Ipv4Interface> ();
+      interface->AddAddress (Ipv4InterfaceAddress (Ipv4Address ("10.0.0.1"), Ipv4Mask ("/24")));
+      Ipv4Address local ("10.0.0.1");
+      Ipv4EndPointDemux demux;
+      Ipv4EndPoint *listener = demux.Allocate (Ptr<NetDevice> (), 80);
+      std::vector<Ipv4EndPoint *> endPoints;
+
+      clock.Start ();
+      for (uint32_t i = 0; i < nEndPoints; i++)
+        {
+          endPoints.push_back (demux.Allocate (Ptr<NetDevice> (), local, 80, GetIpv4Peer (i), GetPeerPort (i)));
+        }
+      Report ("Allocation", nEndPoints, clock.End ());
+
+      clock.Start ();
+      for (uint32_t i = 0; i < nLookups; i++)
+        {
+          uint32_t peer = rng->GetInteger (0, nEndPoints * 10 / 9);
+          Ipv4EndPointDemux::EndPoints matches = demux.Lookup (local, 80, GetIpv4Peer (peer), GetPeerPort (peer), interface);
+          if (matches.size () == 1 && (peer < nEndPoints ? endPoints[peer] : listener) == matches.front ())
+            {
+              found++;
+            }
+        }
+      Report ("Lookup", nLookups, clock.End ());
+
+      clock.Start ();
+      for (uint32_t i = 0; i < nEndPoints; i++)
+        {
+          demux.DeAllocate (endPoints[i]);
+        }
+      Report ("Deallocation", nEndPoints, clock.End ());
+    }
+  else
+    {
+      Ipv6Address local ("2001:db8:0:1::1");
+      Ipv6EndPointDemux demux;
+      Ipv6EndPoint *listener = demux.Allocate (Ptr<NetDevice> (), 80);
+      std::vector<Ipv6EndPoint *> endPoints;
+
+      clock.Start ();
+      for (uint32_t i = 0; i < nEndPoints; i++)
+        {
+          endPoints.push_back (demux.Allocate (Ptr<NetDevice> (), local, 80, GetIpv6Peer (i), GetPeerPort (i)));
+        }
+      Report ("Allocation", nEndPoints, clock.End ());
+
+      clock.Start ();
+      for (uint32_t i = 0; i < nLookups; i++)
+        {
+          uint32_t peer = rng->GetInteger (0, nEndPoints * 10 / 9);
+          Ipv6EndPointDemux::EndPoints matches = demux.Lookup (local, 80, GetIpv6Peer (peer), GetPeerPort (peer), 0);
+          if (matches.size () == 1 && (peer < nEndPoints ? endPoints[peer] : listener) == matches.front ())
+            {
+              found++;
+            }
+        }
+      Report ("Lookup", nLookups, clock.End ());
+
+      clock.Start ();
+      for (uint32_t i = 0; i < nEndPoints; i++)
+        {
+          demux.DeAllocate (endPoints[i]);
+        }
+      Report ("Deallocation", nEndPoints, clock.End ());
+    }
+
+  std::cout << "Correct lookups: " << found << " out of " << nLookups << std::endl;
+  return 0;
+}
@@ -0,0 +1,259 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <set>
+#include <vector>
+#include <algorithm>
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/net-device.h"
+#include "ns3/channel-list.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv6-l3-protocol.h"
+#include "ns3/ipv6-interface.h"
+#include "ns3/arp-cache.h"
+#include "ns3/ndisc-cache.h"
+#include "neighbor-cache-helper.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("NeighborCacheHelper");
+
+NeighborCacheHelper::NeighborCacheHelper ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+NeighborCacheHelper::PopulateNeighborCache (void) const
+{
+  NS_LOG_FUNCTION (this);
+  std::set<Ptr<Channel> > channels;
+  for (ChannelList::Iterator i = ChannelList::Begin (); i != ChannelList::End (); i++)
+    {
+      if (channels.find (*i) == channels.end ())
+        {
+          std::vector<Ptr<NetDevice> > devices;
+          CollectDevices (*i, channels, devices);
+          PopulateLink (devices);
+        }
+    }
+}
+
+void
+NeighborCacheHelper::PopulateNeighborCache (Ptr<Channel> channel) const
+{
+  NS_LOG_FUNCTION (this << channel);
+  std::set<Ptr<Channel> > channels;
+  std::vector<Ptr<NetDevice> > devices;
+  CollectDevices (channel, channels, devices);
+  PopulateLink (devices);
+}
+
+void
+NeighborCacheHelper::PopulateNeighborCache (const NetDeviceContainer &devices) const
+{
+  NS_LOG_FUNCTION (this);
+  std::set<Ptr<Channel> > channels;
+  for (NetDeviceContainer::Iterator i = devices.Begin (); i != devices.End (); i++)
+    {
+      Ptr<Channel> channel = (*i)->GetChannel ();
+      if (channel != 0 && channels.find (channel) == channels.end ())
+        {
+          std::vector<Ptr<NetDevice> > attached;
+          CollectDevices (channel, channels, attached);
+          PopulateLink (attached);
+        }
+    }
+}
+
+void
+NeighborCacheHelper::PopulateLink (const std::vector<Ptr<NetDevice> > &attached) const
+{
+  NS_LOG_FUNCTION (this << attached.size ());
+
+  // the IP interfaces of the devices attached to the link
+  std::vector<Ptr<NetDevice> > devices;
+  std::vector<Ptr<Ipv4Interface> > ipv4Interfaces;
+  std::vector<Ptr<Ipv6Interface> > ipv6Interfaces;
+  for (std::vector<Ptr<NetDevice> >::const_iterator i = attached.begin (); i != attached.end (); i++)
+    {
+      Ptr<NetDevice> device = *i;
+      Ptr<Node> node = device->GetNode ();
+      Ptr<Ipv4Interface> ipv4Interface;
+      Ptr<Ipv6Interface> ipv6Interface;
+      Ptr<Ipv4L3Protocol> ipv4 = node->GetObject<Ipv4L3Protocol> ();
+      if (ipv4 != 0)
+        {
+          int32_t index = ipv4->GetInterfaceForDevice (device);
+          if (index >= 0)
+            {
+              ipv4Interface = ipv4->GetInterface (index);
+            }
+        }
+      Ptr<Ipv6L3Protocol> ipv6 = node->GetObject<Ipv6L3Protocol> ();
+      if (ipv6 != 0)
+        {
+          int32_t index = ipv6->GetInterfaceForDevice (device);
+          if (index >= 0)
+            {
+              ipv6Interface = ipv6->GetInterface (index);
+            }
+        }
+      if (ipv4Interface != 0 || ipv6Interface != 0)
+        {
+          devices.push_back (device);
+          ipv4Interfaces.push_back (ipv4Interface);
+          ipv6Interfaces.push_back (ipv6Interface);
+        }
+    }
+
+  for (std::size_t i = 0; i < devices.size (); i++)
+    {
+      for (std::size_t j = 0; j < devices.size (); j++)
+        {
+          if (i == j)
+            {
+              continue;
+            }
+          if (ipv4Interfaces[i] != 0 && ipv4Interfaces[j] != 0)
+            {
+              PopulateArpCache (ipv4Interfaces[i], ipv4Interfaces[j], devices[j]->GetAddress ());
+            }
+          if (ipv6Interfaces[i] != 0 && ipv6Interfaces[j] != 0)
+            {
+              PopulateNdiscCache (ipv6Interfaces[i], ipv6Interfaces[j], devices[j]->GetAddress ());
+            }
+        }
+    }
+}
+
+void
+NeighborCacheHelper::CollectDevices (Ptr<Channel> channel, std::set<Ptr<Channel> > &channels,
+                                     std::vector<Ptr<NetDevice> > &devices) const
+{
+  NS_LOG_FUNCTION (this << channel);
+  if (!channels.insert (channel).second)
+    {
+      return;
+    }
+  for (std::size_t i = 0; i < channel->GetNDevices (); i++)
+    {
+      Ptr<NetDevice> device = channel->GetDevice (i);
+      if (std::find (devices.begin (), devices.end (), device) != devices.end ())
+        {
+          continue;
+        }
+      devices.push_back (device);
+      // the channel of a bridge device holds the devices of all the
+      // channels it bridges, including the one of this device if it is a
+      // port of the bridge
+      Ptr<Node> node = device->GetNode ();
+      for (uint32_t j = 0; j < node->GetNDevices (); j++)
+        {
+          Ptr<NetDevice> bridge = node->GetDevice (j);
+          Ptr<Channel> bridged = bridge->GetChannel ();
+          if (!bridge->IsBridge () || bridged == 0 || channels.find (bridged) != channels.end ())
+            {
+              continue;
+            }
+          for (std::size_t k = 0; k < bridged->GetNDevices (); k++)
+            {
+              if (bridged->GetDevice (k) == device)
+                {
+                  // the bridge device itself may have an IP interface
+                  if (std::find (devices.begin (), devices.end (), bridge) == devices.end ())
+                    {
+                      devices.push_back (bridge);
+                    }
+                  CollectDevices (bridged, channels, devices);
+                  break;
+                }
+            }
+        }
+    }
+}
+
+void
+NeighborCacheHelper::PopulateArpCache (Ptr<Ipv4Interface> interface, Ptr<Ipv4Interface> neighbor, Address mac) const
+{
+  NS_LOG_FUNCTION (this << interface << neighbor << mac);
+  Ptr<ArpCache> cache = interface->GetArpCache ();
+  if (cache == 0)
+    {
+      return;
+    }
+  for (uint32_t i = 0; i < neighbor->GetNAddresses (); i++)
+    {
+      Ipv4Address address = neighbor->GetAddress (i).GetLocal ();
+      bool onLink = false;
+      for (uint32_t j = 0; j < interface->GetNAddresses () && !onLink; j++)
+        {
+          Ipv4InterfaceAddress local = interface->GetAddress (j);
+          onLink = local.GetLocal ().CombineMask (local.GetMask ()) == address.CombineMask (local.GetMask ());
+        }
+      if (!onLink)
+        {
+          continue;
+        }
+      ArpCache::Entry *entry = cache->Lookup (address);
+      if (entry == 0)
+        {
+          entry = cache->Add (address);
+        }
+      entry->SetMacAddress (mac);
+      entry->MarkPermanent ();
+      NS_LOG_LOGIC ("Added permanent ARP entry " << address << " to " << mac);
+    }
+}
+
+void
+NeighborCacheHelper::PopulateNdiscCache (Ptr<Ipv6Interface> interface, Ptr<Ipv6Interface> neighbor, Address mac) const
+{
+  NS_LOG_FUNCTION (this << interface << neighbor << mac);
+  Ptr<NdiscCache> cache = interface->GetNdiscCache ();
+  if (cache == 0)
+    {
+      return;
+    }
+  for (uint32_t i = 0; i < neighbor->GetNAddresses (); i++)
+    {
+      Ipv6InterfaceAddress neighborAddress = neighbor->GetAddress (i);
+      Ipv6Address address = neighborAddress.GetAddress ();
+      bool onLink = (neighborAddress.GetScope () == Ipv6InterfaceAddress::LINKLOCAL);
+      for (uint32_t j = 0; j < interface->GetNAddresses () && !onLink; j++)
+        {
+          Ipv6InterfaceAddress local = interface->GetAddress (j);
+          onLink = local.GetScope () == Ipv6InterfaceAddress::GLOBAL
+            && local.GetAddress ().CombinePrefix (local.GetPrefix ()) == address.CombinePrefix (local.GetPrefix ());
+        }
+      if (!onLink)
+        {
+          continue;
+        }
+      NdiscCache::Entry *entry = cache->Lookup (address);
+      if (entry == 0)
+        {
+          entry = cache->Add (address);
+        }
+      entry->SetMacAddress (mac);
+      entry->MarkPermanent ();
+      NS_LOG_LOGIC ("Added permanent NDISC entry " << address << " to " << mac);
+    }
+}
+
+} // namespace ns3
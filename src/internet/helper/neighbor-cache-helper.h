@@ -0,0 +1,114 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NEIGHBOR_CACHE_HELPER_H
+#define NEIGHBOR_CACHE_HELPER_H
+
+#include <set>
+#include <vector>
+#include "ns3/ptr.h"
+#include "ns3/address.h"
+#include "ns3/channel.h"
+#include "ns3/net-device-container.h"
+
+namespace ns3 {
+
+class Ipv4Interface;
+class Ipv6Interface;
+
+/**
+ * \ingroup internet
+ *
+ * \brief Helper class that fills the ARP and NDISC caches from the topology
+ *
+ * In a large LAN, the address resolution of the first packets of every
+ * flow costs broadcast requests received by all the hosts, and delays
+ * the flows. This helper adds permanent entries to the ArpCache and
+ * NdiscCache of the interfaces, for the addresses of the other interfaces
+ * attached to the same link, so that no address resolution takes place. A
+ * link is made of a channel and of the channels bridged with it by the
+ * bridge devices (see NetDevice::IsBridge) of the nodes attached to it.
+ *
+ * The caches must be populated after the addresses are assigned to the
+ * interfaces. IPv4 entries are only added for the addresses in the subnet
+ * of an address of the interface, IPv6 entries for the link-local
+ * addresses and for the addresses with the prefix of an address of the
+ * interface.
+ */
+class NeighborCacheHelper
+{
+public:
+  NeighborCacheHelper ();
+
+  /**
+   * \brief Populate the neighbor caches of the interfaces attached to all
+   * the channels of the simulation.
+   */
+  void PopulateNeighborCache (void) const;
+
+  /**
+   * \brief Populate the neighbor caches of the interfaces attached to the
+   * link of a channel.
+   * \param channel the channel
+   */
+  void PopulateNeighborCache (Ptr<Channel> channel) const;
+
+  /**
+   * \brief Populate the neighbor caches of the interfaces attached to the
+   * links of some devices.
+   * \param devices the devices
+   */
+  void PopulateNeighborCache (const NetDeviceContainer &devices) const;
+
+private:
+  /**
+   * \brief Collect the devices attached to the link of a channel.
+   * \param channel the channel
+   * \param channels the channels of the link visited so far
+   * \param devices the devices of the link collected so far
+   */
+  void CollectDevices (Ptr<Channel> channel, std::set<Ptr<Channel> > &channels,
+                       std::vector<Ptr<NetDevice> > &devices) const;
+
+  /**
+   * \brief Populate the neighbor caches of the interfaces of the devices
+   * attached to a link.
+   * \param attached the devices attached to the link
+   */
+  void PopulateLink (const std::vector<Ptr<NetDevice> > &attached) const;
+
+  /**
+   * \brief Add the addresses of an IPv4 interface to the ARP cache of
+   * another interface.
+   * \param interface the interface whose cache is populated
+   * \param neighbor the neighbor interface
+   * \param mac the MAC address of the neighbor
+   */
+  void PopulateArpCache (Ptr<Ipv4Interface> interface, Ptr<Ipv4Interface> neighbor, Address mac) const;
+
+  /**
+   * \brief Add the addresses of an IPv6 interface to the NDISC cache of
+   * another interface.
+   * \param interface the interface whose cache is populated
+   * \param neighbor the neighbor interface
+   * \param mac the MAC address of the neighbor
+   */
+  void PopulateNdiscCache (Ptr<Ipv6Interface> interface, Ptr<Ipv6Interface> neighbor, Address mac) const;
+};
+
+} // namespace ns3
+
+#endif /* NEIGHBOR_CACHE_HELPER_H */
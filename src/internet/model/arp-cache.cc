@@ -249,6 +249,7 @@ ArpCache::Flush (void)
       delete (*i).second;
     }
   m_arpCache.erase (m_arpCache.begin (), m_arpCache.end ());
+  m_inverseCache.clear ();
   if (m_waitReplyTimer.IsRunning ())
     {
       NS_LOG_LOGIC ("Stopping WaitReplyTimer at " << Simulator::Now ().GetSeconds () << " due to ArpCache flush");
@@ -302,17 +303,36 @@ ArpCache::LookupInverse (Address to)
   NS_LOG_FUNCTION (this << to);
 
   std::list<ArpCache::Entry *> entryList;
-  for (CacheI i = m_arpCache.begin (); i != m_arpCache.end (); i++)
+  std::pair<InverseCacheI, InverseCacheI> range = m_inverseCache.equal_range (to);
+  for (InverseCacheI i = range.first; i != range.second; i++)
     {
-      ArpCache::Entry *entry = (*i).second;
-      if (entry->GetMacAddress () == to)
-        {
-          entryList.push_back (entry);
-        }
+      entryList.push_back (i->second);
     }
   return entryList;
 }
 
+void
+ArpCache::UpdateInverse (ArpCache::Entry *entry, Address macAddress)
+{
+  NS_LOG_FUNCTION (this << entry << macAddress);
+  Address current = entry->GetMacAddress ();
+  if (!current.IsInvalid ())
+    {
+      std::pair<InverseCacheI, InverseCacheI> range = m_inverseCache.equal_range (current);
+      for (InverseCacheI i = range.first; i != range.second; i++)
+        {
+          if (i->second == entry)
+            {
+              m_inverseCache.erase (i);
+              break;
+            }
+        }
+    }
+  if (!macAddress.IsInvalid ())
+    {
+      m_inverseCache.insert (std::make_pair (macAddress, entry));
+    }
+}
 
 ArpCache::Entry *
 ArpCache::Lookup (Ipv4Address to)
@@ -343,15 +363,14 @@ ArpCache::Remove (ArpCache::Entry *entry)
 {
   NS_LOG_FUNCTION (this << entry);
   
-  for (CacheI i = m_arpCache.begin (); i != m_arpCache.end (); i++)
+  CacheI i = m_arpCache.find (entry->GetIpv4Address ());
+  if (i != m_arpCache.end () && (*i).second == entry)
     {
-      if ((*i).second == entry)
-        {
-          m_arpCache.erase (i);
-          entry->ClearPendingPacket (); //clear the pending packets for entry's ipaddress
-          delete entry;
-          return;
-        }
+      UpdateInverse (entry, Address ());
+      m_arpCache.erase (i);
+      entry->ClearPendingPacket (); //clear the pending packets for entry's ipaddress
+      delete entry;
+      return;
     }
   NS_LOG_WARN ("Entry not found in this ARP Cache");
 }
@@ -405,6 +424,7 @@ ArpCache::Entry::MarkAlive (Address macAddress)
 {
   NS_LOG_FUNCTION (this << macAddress);
   NS_ASSERT (m_state == WAIT_REPLY);
+  m_arp->UpdateInverse (this, macAddress);
   m_macAddress = macAddress;
   m_state = ALIVE;
   ClearRetries ();
@@ -460,6 +480,7 @@ void
 ArpCache::Entry::SetMacAddress (Address macAddress)
 {
   NS_LOG_FUNCTION (this);
+  m_arp->UpdateInverse (this, macAddress);
   m_macAddress = macAddress;
 }
 Ipv4Address 
@@ -22,6 +22,7 @@
 
 #include <stdint.h>
 #include <list>
+#include <unordered_map>
 #include "ns3/simulator.h"
 #include "ns3/callback.h"
 #include "ns3/packet.h"
@@ -318,6 +319,14 @@ private:
    * \brief ARP Cache container iterator
    */
   typedef sgi::hash_map<Ipv4Address, ArpCache::Entry *, Ipv4AddressHash>::iterator CacheI;
+  /**
+   * \brief ARP Cache entries indexed by their MAC address
+   */
+  typedef std::unordered_multimap<Address, ArpCache::Entry *, AddressHash> InverseCache;
+  /**
+   * \brief Iterator of the ARP Cache entries indexed by their MAC address
+   */
+  typedef InverseCache::iterator InverseCacheI;
 
   virtual void DoDispose (void);
 
@@ -336,8 +345,15 @@ private:
    * If there are no Arp requests pending, this event is not scheduled.
    */
   void HandleWaitReplyTimeout (void);
+  /**
+   * \brief Update the MAC address of an entry in the inverse index
+   * \param entry the entry
+   * \param macAddress the new MAC address of the entry
+   */
+  void UpdateInverse (ArpCache::Entry *entry, Address macAddress);
   uint32_t m_pendingQueueSize; //!< number of packets waiting for a resolution
   Cache m_arpCache; //!< the ARP cache
+  InverseCache m_inverseCache; //!< the entries with a valid MAC address, indexed by MAC address
   TracedCallback<Ptr<const Packet> > m_dropTrace; //!< trace for packets dropped by the ARP cache queue
 };
 
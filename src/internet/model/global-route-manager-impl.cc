@@ -27,6 +27,7 @@
 #include <queue>
 #include <algorithm>
 #include <iostream>
+#include <set>
 #include "ns3/assert.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
@@ -35,15 +36,44 @@
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/ipv4-list-routing.h"
 #include "ns3/mpi-interface.h"
+#include "ns3/global-value.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-thread.h"
+#endif
 #include "global-router-interface.h"
 #include "global-route-manager-impl.h"
 #include "candidate-queue.h"
 #include "ipv4-global-routing.h"
+#include "prefix-trie.h"
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("GlobalRouteManagerImpl");
 
+/**
+ * \ingroup globalrouting
+ * \brief The number of threads computing the global routes.
+ */
+static GlobalValue g_globalRoutingThreads ("GlobalRoutingThreads",
+                                           "The number of threads computing the SPF trees of the "
+                                           "routers when the global routes are computed",
+                                           UintegerValue (1),
+                                           MakeUintegerChecker<uint32_t> (1));
+
+/**
+ * \ingroup globalrouting
+ * \brief A global switch to keep the SPF trees for the incremental update of the global routes.
+ */
+static GlobalValue g_globalRoutingIncremental ("GlobalRoutingIncremental",
+                                               "Keep the SPF trees of the routers, so that only the "
+                                               "trees affected by a topology change are computed "
+                                               "again when the global routes are updated",
+                                               BooleanValue (false),
+                                               MakeBooleanChecker ());
+
 /**
  * \brief Stream insertion operator.
  *
@@ -423,7 +453,8 @@ SPFVertex::ClearVertexProcessed (void)
 GlobalRouteManagerLSDB::GlobalRouteManagerLSDB ()
   :
     m_database (),
-    m_extdatabase ()
+    m_extdatabase (),
+    m_linkDataIndex ()
 {
   NS_LOG_FUNCTION (this);
 }
@@ -446,6 +477,7 @@ GlobalRouteManagerLSDB::~GlobalRouteManagerLSDB ()
     }
   NS_LOG_LOGIC ("clear map");
   m_database.clear ();
+  m_linkDataIndex.clear ();
 }
 
 void
@@ -468,9 +500,30 @@ GlobalRouteManagerLSDB::Insert (Ipv4Address addr, GlobalRoutingLSA* lsa)
     {
       m_extdatabase.push_back (lsa);
     } 
-  else
+  else if (m_database.insert (LSDBPair_t (addr, lsa)).second)
     {
-      m_database.insert (LSDBPair_t (addr, lsa));
+//
+// Index the LSA by the Link Data of its TransitNetwork link records.  When
+// several LSAs share a Link Data, the one with the lowest address is kept, so
+// that GetLSAByLinkData finds the first LSA in the database order.
+//
+      for (uint32_t j = 0; j < lsa->GetNLinkRecords (); j++)
+        {
+          GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
+          if (lr->GetLinkType () != GlobalRoutingLinkRecord::TransitNetwork)
+            {
+              continue;
+            }
+          LSDBMap_t::iterator i = m_linkDataIndex.find (lr->GetLinkData ());
+          if (i == m_linkDataIndex.end ())
+            {
+              m_linkDataIndex.insert (LSDBPair_t (lr->GetLinkData (), lsa));
+            }
+          else if (addr < i->second->GetLinkStateId ())
+            {
+              i->second = lsa;
+            }
+        }
     }
 }
 
@@ -495,13 +548,10 @@ GlobalRouteManagerLSDB::GetLSA (Ipv4Address addr) const
 //
 // Look up an LSA by its address.
 //
-  LSDBMap_t::const_iterator i;
-  for (i= m_database.begin (); i!= m_database.end (); i++)
+  LSDBMap_t::const_iterator i = m_database.find (addr);
+  if (i != m_database.end ())
     {
-      if (i->first == addr)
-        {
-          return i->second;
-        }
+      return i->second;
     }
   return 0;
 }
@@ -511,26 +561,28 @@ GlobalRouteManagerLSDB::GetLSAByLinkData (Ipv4Address addr) const
 {
   NS_LOG_FUNCTION (this << addr);
 //
-// Look up an LSA by its address.
+// Look up an LSA by the Link Data of one of its TransitNetwork link records.
 //
-  LSDBMap_t::const_iterator i;
-  for (i= m_database.begin (); i!= m_database.end (); i++)
+  LSDBMap_t::const_iterator i = m_linkDataIndex.find (addr);
+  if (i != m_linkDataIndex.end ())
     {
-      GlobalRoutingLSA* temp = i->second;
-// Iterate among temp's Link Records
-      for (uint32_t j = 0; j < temp->GetNLinkRecords (); j++)
-        {
-          GlobalRoutingLinkRecord *lr = temp->GetLinkRecord (j);
-          if ( lr->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork &&
-               lr->GetLinkData () == addr)
-            {
-              return temp;
-            }
-        }
+      return i->second;
     }
   return 0;
 }
 
+GlobalRouteManagerLSDB::Iterator
+GlobalRouteManagerLSDB::Begin () const
+{
+  return m_database.begin ();
+}
+
+GlobalRouteManagerLSDB::Iterator
+GlobalRouteManagerLSDB::End () const
+{
+  return m_database.end ();
+}
+
 // ---------------------------------------------------------------------------
 //
 // GlobalRouteManagerImpl Implementation
@@ -539,19 +591,41 @@ GlobalRouteManagerLSDB::GetLSAByLinkData (Ipv4Address addr) const
 
 GlobalRouteManagerImpl::GlobalRouteManagerImpl () 
   :
-    m_spfroot (0)
+    m_spfroot (0),
+    m_owner (this),
+    m_root (0),
+    m_nSPFCalculations (0),
+    m_pendingRoots (0),
+    m_nextRoot (0)
 {
   NS_LOG_FUNCTION (this);
   m_lsdb = new GlobalRouteManagerLSDB ();
 }
 
+GlobalRouteManagerImpl::GlobalRouteManagerImpl (GlobalRouteManagerImpl* owner)
+  :
+    m_spfroot (0),
+    m_lsdb (owner->m_lsdb),
+    m_owner (owner),
+    m_root (0),
+    m_nSPFCalculations (0),
+    m_pendingRoots (0),
+    m_nextRoot (0)
+{
+  NS_LOG_FUNCTION (this << owner);
+}
+
 GlobalRouteManagerImpl::~GlobalRouteManagerImpl ()
 {
   NS_LOG_FUNCTION (this);
-  if (m_lsdb)
+  if (m_lsdb && m_owner == this)
     {
       delete m_lsdb;
     }
+  for (std::map<Ipv4Address, SPFTree*>::iterator i = m_trees.begin (); i != m_trees.end (); i++)
+    {
+      delete i->second;
+    }
 }
 
 void
@@ -565,6 +639,13 @@ GlobalRouteManagerImpl::DebugUseLsdb (GlobalRouteManagerLSDB* lsdb)
   m_lsdb = lsdb;
 }
 
+uint32_t
+GlobalRouteManagerImpl::GetNSPFCalculations (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_nSPFCalculations;
+}
+
 void
 GlobalRouteManagerImpl::DeleteGlobalRoutes ()
 {
@@ -598,6 +679,11 @@ GlobalRouteManagerImpl::DeleteGlobalRoutes ()
       delete m_lsdb;
       m_lsdb = new GlobalRouteManagerLSDB ();
     }
+  for (std::map<Ipv4Address, SPFTree*>::iterator i = m_trees.begin (); i != m_trees.end (); i++)
+    {
+      delete i->second;
+    }
+  m_trees.clear ();
 }
 
 //
@@ -700,6 +786,78 @@ GlobalRouteManagerImpl::InitializeRoutes ()
 // Walk the list of nodes in the system.
 //
   NS_LOG_INFO ("About to start SPF calculation");
+  std::vector<SPFRoot*> roots;
+  GetRoots (roots);
+  m_nSPFCalculations = 0;
+  ComputeRoutes (roots);
+  NS_LOG_INFO ("Finished SPF calculation");
+}
+
+//
+// Build the routing database again and compare it with the previous one.
+// The routers whose SPF tree cannot be affected by the changes reuse their
+// previous tree: only the routes have to be generated again, since the
+// addresses of the vertices of the tree may have changed.
+//
+void
+GlobalRouteManagerImpl::UpdateRoutes ()
+{
+  NS_LOG_FUNCTION (this);
+  BooleanValue incrementalUpdate;
+  g_globalRoutingIncremental.GetValue (incrementalUpdate);
+  if (!incrementalUpdate.Get () || m_trees.empty ())
+    {
+      DeleteGlobalRoutes ();
+      BuildGlobalRoutingDatabase ();
+      InitializeRoutes ();
+      return;
+    }
+//
+// Keep the previous LSDB and SPF trees while the routes are deleted and the
+// database is built again.
+//
+  std::map<Ipv4Address, SPFTree*> trees;
+  trees.swap (m_trees);
+  GlobalRouteManagerLSDB* lsdb = m_lsdb;
+  m_lsdb = 0;
+  DeleteGlobalRoutes ();
+  m_lsdb = new GlobalRouteManagerLSDB ();
+  BuildGlobalRoutingDatabase ();
+
+  SPFChanges changes;
+  bool incremental = FindChanges (lsdb, changes);
+  NS_LOG_LOGIC ("Incremental update: " << incremental << ", " <<
+                changes.routers.size () << " router LSAs changed");
+
+  std::vector<SPFRoot*> roots;
+  GetRoots (roots);
+  for (std::vector<SPFRoot*>::iterator i = roots.begin (); i != roots.end (); i++)
+    {
+      SPFRoot* root = *i;
+      std::map<Ipv4Address, SPFTree*>::iterator tree = trees.find (root->routerId);
+      if (incremental && tree != trees.end ()
+          && tree->second->interfaces == root->tree.interfaces
+          && !IsTreeAffected (*tree->second, changes))
+        {
+          NS_LOG_LOGIC ("SPF tree of " << root->routerId << " not affected");
+          std::swap (root->tree, *tree->second);
+          root->replay = true;
+        }
+    }
+  m_nSPFCalculations = 0;
+  ComputeRoutes (roots);
+
+  for (std::map<Ipv4Address, SPFTree*>::iterator i = trees.begin (); i != trees.end (); i++)
+    {
+      delete i->second;
+    }
+  delete lsdb;
+}
+
+void
+GlobalRouteManagerImpl::GetRoots (std::vector<SPFRoot*> &roots)
+{
+  NS_LOG_FUNCTION (this);
   NodeList::Iterator listEnd = NodeList::End ();
   for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
     {
@@ -724,159 +882,592 @@ GlobalRouteManagerImpl::InitializeRoutes ()
 //
       if (rtr && rtr->GetNumLSAs () )
         {
-          SPFCalculate (rtr->GetRouterId ());
+          roots.push_back (CreateRoot (node, rtr->GetRouterId ()));
         }
     }
-  NS_LOG_INFO ("Finished SPF calculation");
 }
 
-//
-// This method is derived from quagga ospf_spf_next ().  See RFC2328 Section 
-// 16.1 (2) for further details.
-//
-// We're passed a parameter <v> that is a vertex which is already in the SPF
-// tree.  A vertex represents a router node.  We also get a reference to the
-// SPF candidate queue, which is a priority queue containing the shortest paths
-// to the networks we know about.
-//
-// We examine the links in v's LSA and update the list of candidates with any
-// vertices not already on the list.  If a lower-cost path is found to a
-// vertex already on the candidate list, store the new (lower) cost.
-//
-void
-GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
+GlobalRouteManagerImpl::SPFRoot*
+GlobalRouteManagerImpl::CreateRoot (Ptr<Node> node, Ipv4Address routerId)
 {
-  NS_LOG_FUNCTION (this << v << &candidate);
-
-  SPFVertex* w = 0;
-  GlobalRoutingLSA* w_lsa = 0;
-  GlobalRoutingLinkRecord *l = 0;
-  uint32_t distance = 0;
-  uint32_t numRecordsInVertex = 0;
-//
-// V points to a Router-LSA or Network-LSA
-// Loop over the links in router LSA or attached routers in Network LSA
-//
-  if (v->GetVertexType () == SPFVertex::VertexRouter)
+  NS_LOG_FUNCTION (this << node << routerId);
+  SPFRoot* root = new SPFRoot;
+  root->routerId = routerId;
+  root->checkStub = (NodeList::GetNNodes () > 0);
+  root->replay = false;
+  root->aggregate = false;
+  root->tree.stub = false;
+  if (node == 0)
     {
-      numRecordsInVertex = v->GetLSA ()->GetNLinkRecords (); 
+      return root;
     }
-  if (v->GetVertexType () == SPFVertex::VertexNetwork)
+  Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
+  NS_ASSERT (router);
+  root->routing = router->GetRoutingProtocol ();
+  NS_ASSERT (root->routing);
+  BooleanValue aggregate;
+  root->routing->GetAttribute ("AggregateRoutes", aggregate);
+  root->aggregate = aggregate.Get ();
+//
+// Gather the addresses of the interfaces of the node, so that the outgoing
+// interfaces can be found without accessing the node during the SPF
+// calculation (see FindOutgoingInterfaceId).
+//
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  NS_ASSERT_MSG (ipv4, 
+                 "GlobalRouteManagerImpl::CreateRoot (): "
+                 "GetObject for <Ipv4> interface failed");
+  for (uint32_t i = 0; i < ipv4->GetNInterfaces (); i++)
     {
-      numRecordsInVertex = v->GetLSA ()->GetNAttachedRouters (); 
+      for (uint32_t j = 0; j < ipv4->GetNAddresses (i); j++)
+        {
+          root->tree.interfaces.push_back (std::make_pair (ipv4->GetAddress (i, j).GetLocal (), i));
+        }
     }
+  return root;
+}
 
-  for (uint32_t i = 0; i < numRecordsInVertex; i++)
+void
+GlobalRouteManagerImpl::ComputeRoutes (std::vector<SPFRoot*> &roots)
+{
+  NS_LOG_FUNCTION (this << roots.size ());
+  UintegerValue nThreads;
+  g_globalRoutingThreads.GetValue (nThreads);
+  BooleanValue incremental;
+  g_globalRoutingIncremental.GetValue (incremental);
+//
+// The roots are processed in batches, so that the routes of a batch are
+// installed and freed before the next batch is processed.  The routes are
+// installed by this thread only, in the order of the roots.
+//
+  uint32_t batchSize = 64 * nThreads.Get ();
+  for (uint32_t start = 0; start < roots.size (); start += batchSize)
     {
-// Get w_lsa:  In case of V is Router-LSA
-      if (v->GetVertexType () == SPFVertex::VertexRouter) 
+      uint32_t end = std::min<uint32_t> (start + batchSize, roots.size ());
+      std::vector<SPFRoot*> batch (roots.begin () + start, roots.begin () + end);
+      for (uint32_t i = 0; i < batch.size (); i++)
         {
-          NS_LOG_LOGIC ("Examining link " << i << " of " << 
-                        v->GetVertexId () << "'s " <<
-                        v->GetLSA ()->GetNLinkRecords () << " link records");
-//
-// (a) If this is a link to a stub network, examine the next link in V's LSA.
-// Links to stub networks will be considered in the second stage of the
-// shortest path calculation.
-//
-          l = v->GetLSA ()->GetLinkRecord (i);
-          NS_ASSERT (l != 0);
-          if (l->GetLinkType () == GlobalRoutingLinkRecord::StubNetwork)
+          if (!batch[i]->replay)
             {
-              NS_LOG_LOGIC ("Found a Stub record to " << l->GetLinkId ());
-              continue;
+              m_nSPFCalculations++;
             }
+        }
+      m_pendingRoots = &batch;
+      m_nextRoot = 0;
+#ifdef HAVE_PTHREAD_H
 //
-// (b) Otherwise, W is a transit vertex (router or transit network).  Look up
-// the vertex W's LSA (router-LSA or network-LSA) in Area A's link state
-// database. 
-//
-          if (l->GetLinkType () == GlobalRoutingLinkRecord::PointToPoint)
-            {
-//
-// Lookup the link state advertisement of the new link -- we call it <w> in
-// the link state database.
+// The threads only read the LSDB, and have their own status of the LSAs.
 //
-              w_lsa = m_lsdb->GetLSA (l->GetLinkId ());
-              NS_ASSERT (w_lsa);
-              NS_LOG_LOGIC ("Found a P2P record from " << 
-                            v->GetVertexId () << " to " << w_lsa->GetLinkStateId ());
-            }
-          else if (l->GetLinkType () == 
-                   GlobalRoutingLinkRecord::TransitNetwork)
-            {
-              w_lsa = m_lsdb->GetLSA (l->GetLinkId ());
-              NS_ASSERT (w_lsa);
-              NS_LOG_LOGIC ("Found a Transit record from " << 
-                            v->GetVertexId () << " to " << w_lsa->GetLinkStateId ());
-            }
-          else 
-            {
-              NS_ASSERT_MSG (0, "illegal Link Type");
-            }
+      std::vector<GlobalRouteManagerImpl*> workers;
+      std::vector<Ptr<SystemThread> > threads;
+      for (uint32_t i = 1; i < nThreads.Get () && i < batch.size (); i++)
+        {
+          GlobalRouteManagerImpl* worker = new GlobalRouteManagerImpl (this);
+          workers.push_back (worker);
+          threads.push_back (Create<SystemThread> (MakeCallback (&GlobalRouteManagerImpl::ProcessPendingRoots, worker)));
+          threads.back ()->Start ();
         }
-// Get w_lsa:  In case of V is Network-LSA
-      if (v->GetVertexType () == SPFVertex::VertexNetwork) 
+#endif
+      ProcessPendingRoots ();
+#ifdef HAVE_PTHREAD_H
+      for (uint32_t i = 0; i < threads.size (); i++)
         {
-          w_lsa = m_lsdb->GetLSAByLinkData 
-              (v->GetLSA ()->GetAttachedRouter (i));
-          if (!w_lsa)
+          threads[i]->Join ();
+          delete workers[i];
+        }
+#endif
+      m_pendingRoots = 0;
+
+      for (uint32_t i = 0; i < batch.size (); i++)
+        {
+          SPFRoot* root = batch[i];
+          InstallRoutes (*root);
+          if (incremental.Get () && !root->tree.stub)
             {
-              continue;
+              SPFTree* tree = new SPFTree;
+              std::swap (*tree, root->tree);
+              m_trees[root->routerId] = tree;
             }
-          NS_LOG_LOGIC ("Found a Network LSA from " << 
-                        v->GetVertexId () << " to " << w_lsa->GetLinkStateId ());
+          delete root;
         }
+    }
+  roots.clear ();
+}
 
-// Note:  w_lsa at this point may be either RouterLSA or NetworkLSA
-//
-// (c) If vertex W is already on the shortest-path tree, examine the next
-// link in the LSA.
-//
-// If the link is to a router that is already in the shortest path first tree
-// then we have it covered -- ignore it.
-//
-      if (w_lsa->GetStatus () == GlobalRoutingLSA::LSA_SPF_IN_SPFTREE) 
+void
+GlobalRouteManagerImpl::ProcessPendingRoots (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (;;)
+    {
+      SPFRoot* root;
+      {
+#ifdef HAVE_PTHREAD_H
+        CriticalSection cs (m_owner->m_pendingMutex);
+#endif
+        if (m_owner->m_nextRoot == m_owner->m_pendingRoots->size ())
+          {
+            return;
+          }
+        root = (*m_owner->m_pendingRoots)[m_owner->m_nextRoot++];
+      }
+      ProcessRoot (*root);
+    }
+}
+
+void
+GlobalRouteManagerImpl::ProcessRoot (SPFRoot &root)
+{
+  NS_LOG_FUNCTION (this << root.routerId);
+  m_root = &root;
+  if (root.replay)
+    {
+      SPFGenerateRoutes ();
+    }
+  else
+    {
+      SPFCalculate (root.routerId);
+    }
+  if (root.aggregate)
+    {
+      AggregateRoutes (root.routes);
+    }
+  m_root = 0;
+}
+
+void
+GlobalRouteManagerImpl::InstallRoutes (SPFRoot &root)
+{
+  NS_LOG_FUNCTION (this << root.routerId);
+  if (root.routing == 0)
+    {
+      root.routes.clear ();
+      return;
+    }
+  for (std::vector<SPFRoute>::const_iterator i = root.routes.begin (); i != root.routes.end (); i++)
+    {
+      switch (i->type)
         {
-          NS_LOG_LOGIC ("Skipping ->  LSA "<< 
-                        w_lsa->GetLinkStateId () << " already in SPF tree");
-          continue;
+        case SPFRoute::HOST:
+          root.routing->AddHostRouteTo (i->dest, i->nextHop, i->outIf);
+          break;
+        case SPFRoute::NETWORK:
+          root.routing->AddNetworkRouteTo (i->dest, i->mask, i->nextHop, i->outIf);
+          break;
+        case SPFRoute::EXTERNAL:
+          root.routing->AddASExternalRouteTo (i->dest, i->mask, i->nextHop, i->outIf);
+          break;
         }
-//
-// (d) Calculate the link state cost D of the resulting path from the root to 
-// vertex W.  D is equal to the sum of the link state cost of the (already 
-// calculated) shortest path to vertex V and the advertised cost of the link
-// between vertices V and W.
-//
-      if (v->GetLSA ()->GetLSType () == GlobalRoutingLSA::RouterLSA)
+    }
+  root.routes.clear ();
+}
+
+/**
+ * \brief Test if two LSAs are equal
+ * \param a the first LSA
+ * \param b the second LSA
+ * \returns true if the LSAs are equal
+ */
+static bool
+IsSameLSA (const GlobalRoutingLSA &a, const GlobalRoutingLSA &b)
+{
+  if (a.GetLSType () != b.GetLSType ()
+      || a.GetLinkStateId () != b.GetLinkStateId ()
+      || a.GetAdvertisingRouter () != b.GetAdvertisingRouter ()
+      || a.GetNetworkLSANetworkMask () != b.GetNetworkLSANetworkMask ()
+      || a.GetNLinkRecords () != b.GetNLinkRecords ()
+      || a.GetNAttachedRouters () != b.GetNAttachedRouters ())
+    {
+      return false;
+    }
+  for (uint32_t i = 0; i < a.GetNLinkRecords (); i++)
+    {
+      GlobalRoutingLinkRecord *la = a.GetLinkRecord (i);
+      GlobalRoutingLinkRecord *lb = b.GetLinkRecord (i);
+      if (la->GetLinkType () != lb->GetLinkType ()
+          || la->GetLinkId () != lb->GetLinkId ()
+          || la->GetLinkData () != lb->GetLinkData ()
+          || la->GetMetric () != lb->GetMetric ())
         {
-          NS_ASSERT (l != 0);
-          distance = v->GetDistanceFromRoot () + l->GetMetric ();
+          return false;
         }
-      else
+    }
+  for (uint32_t i = 0; i < a.GetNAttachedRouters (); i++)
+    {
+      if (a.GetAttachedRouter (i) != b.GetAttachedRouter (i))
         {
-          distance = v->GetDistanceFromRoot ();
+          return false;
         }
+    }
+  return true;
+}
 
-      NS_LOG_LOGIC ("Considering w_lsa " << w_lsa->GetLinkStateId ());
+/// Links of a router LSA to other vertices, indexed by type, Link ID and Link Data
+typedef std::map<std::pair<std::pair<int, Ipv4Address>, Ipv4Address>, uint32_t> LinkMap_t;
 
-// Is there already vertex w in candidate list?
-      if (w_lsa->GetStatus () == GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED)
+/**
+ * \brief Get the links of a router LSA to other vertices
+ * \param lsa the LSA
+ * \param links the links, with their metric
+ */
+static void
+GetTransitLinks (const GlobalRoutingLSA &lsa, LinkMap_t &links)
+{
+  for (uint32_t i = 0; i < lsa.GetNLinkRecords (); i++)
+    {
+      GlobalRoutingLinkRecord *l = lsa.GetLinkRecord (i);
+      if (l->GetLinkType () == GlobalRoutingLinkRecord::PointToPoint
+          || l->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork)
         {
-// Calculate nexthop to w
-// We need to figure out how to actually get to the new router represented
-// by <w>.  This will (among other things) find the next hop address to send
-// packets destined for this network to, and also find the outbound interface
-// used to forward the packets.
+          links[std::make_pair (std::make_pair (l->GetLinkType (), l->GetLinkId ()), l->GetLinkData ())] = l->GetMetric ();
+        }
+    }
+}
 
-// prepare vertex w
-          w = new SPFVertex (w_lsa);
-          if (SPFNexthopCalculation (v, w, l, distance))
-            {
-              w_lsa->SetStatus (GlobalRoutingLSA::LSA_SPF_CANDIDATE);
-//
-// Push this new vertex onto the priority queue (ordered by distance from the
-// root node).
+/**
+ * \brief Add the links present in a set of links and not in another one (or
+ * with a different metric) to a list of changed links
+ * \param router the router having the links
+ * \param links the set of links
+ * \param other the other set of links
+ * \param edges the list of changed links
+ */
+static void
+DiffTransitLinks (Ipv4Address router, const LinkMap_t &links, const LinkMap_t &other,
+                  std::vector<std::pair<std::pair<Ipv4Address, Ipv4Address>, uint32_t> > &edges)
+{
+  for (LinkMap_t::const_iterator i = links.begin (); i != links.end (); i++)
+    {
+      LinkMap_t::const_iterator j = other.find (i->first);
+      if (j != other.end () && j->second == i->second)
+        {
+          continue;
+        }
+      Ipv4Address linkId = i->first.first.second;
+      edges.push_back (std::make_pair (std::make_pair (router, linkId), i->second));
+//
+// The network reaches the router through the link to the network, whose
+// Link Data is listed in the network LSA (see GetLSAByLinkData)
+//
+      if (i->first.first.first == GlobalRoutingLinkRecord::TransitNetwork)
+        {
+          edges.push_back (std::make_pair (std::make_pair (linkId, router), 0));
+        }
+    }
+}
+
+bool
+GlobalRouteManagerImpl::FindChanges (GlobalRouteManagerLSDB* lsdb, SPFChanges &changes)
+{
+  NS_LOG_FUNCTION (this << lsdb);
+  if (lsdb->GetNumExtLSAs () != m_lsdb->GetNumExtLSAs ())
+    {
+      return false;
+    }
+  for (uint32_t i = 0; i < lsdb->GetNumExtLSAs (); i++)
+    {
+      if (!IsSameLSA (*lsdb->GetExtLSA (i), *m_lsdb->GetExtLSA (i)))
+        {
+          return false;
+        }
+    }
+//
+// Only the changes of router LSAs are handled incrementally; the addition or
+// removal of a LSA and the change of a network LSA require all the trees to be
+// computed again.
+//
+  GlobalRouteManagerLSDB::Iterator i = lsdb->Begin ();
+  GlobalRouteManagerLSDB::Iterator j = m_lsdb->Begin ();
+  for (; i != lsdb->End () && j != m_lsdb->End (); i++, j++)
+    {
+      if (i->first != j->first)
+        {
+          return false;
+        }
+      if (IsSameLSA (*i->second, *j->second))
+        {
+          continue;
+        }
+      if (i->second->GetLSType () != GlobalRoutingLSA::RouterLSA
+          || j->second->GetLSType () != GlobalRoutingLSA::RouterLSA)
+        {
+          return false;
+        }
+      changes.routers.push_back (i->first);
+      LinkMap_t oldLinks;
+      LinkMap_t newLinks;
+      GetTransitLinks (*i->second, oldLinks);
+      GetTransitLinks (*j->second, newLinks);
+      std::vector<std::pair<std::pair<Ipv4Address, Ipv4Address>, uint32_t> > removed;
+      std::vector<std::pair<std::pair<Ipv4Address, Ipv4Address>, uint32_t> > added;
+      DiffTransitLinks (i->first, oldLinks, newLinks, removed);
+      DiffTransitLinks (i->first, newLinks, oldLinks, added);
+      for (uint32_t k = 0; k < removed.size (); k++)
+        {
+          SPFChanges::Edge edge = { removed[k].first.first, removed[k].first.second, removed[k].second };
+          changes.removed.push_back (edge);
+        }
+      for (uint32_t k = 0; k < added.size (); k++)
+        {
+          SPFChanges::Edge edge = { added[k].first.first, added[k].first.second, added[k].second };
+          changes.added.push_back (edge);
+        }
+    }
+  return i == lsdb->End () && j == m_lsdb->End ();
+}
+
+bool
+GlobalRouteManagerImpl::IsTreeAffected (const SPFTree &tree, const SPFChanges &changes) const
+{
+  NS_LOG_FUNCTION (this);
+  if (tree.stub || tree.ids.empty ())
+    {
+      return true;
+    }
+//
+// The next hops to the routers adjacent to the root, either directly or
+// through a network, are found in the LSAs of these routers.
+//
+  for (std::vector<Ipv4Address>::const_iterator i = changes.routers.begin (); i != changes.routers.end (); i++)
+    {
+      if (*i == tree.ids[0])
+        {
+          return true;
+        }
+      int32_t v = tree.Find (*i);
+      if (v < 0)
+        {
+          continue;
+        }
+      for (uint32_t p = tree.parentStart[v]; p < tree.parentStart[v + 1]; p++)
+        {
+          uint32_t parent = tree.parents[p];
+          if (parent == 0
+              || (m_lsdb->GetLSA (tree.ids[parent])->GetLSType () == GlobalRoutingLSA::NetworkLSA
+                  && tree.IsParent (0, parent)))
+            {
+              return true;
+            }
+        }
+    }
+//
+// A link of the tree has been removed, or a link which may provide an equal
+// or shorter path to a vertex has been added.
+//
+  for (std::vector<SPFChanges::Edge>::const_iterator i = changes.removed.begin (); i != changes.removed.end (); i++)
+    {
+      int32_t from = tree.Find (i->from);
+      int32_t to = tree.Find (i->to);
+      if (from >= 0 && to >= 0 && tree.IsParent (from, to))
+        {
+          return true;
+        }
+    }
+  for (std::vector<SPFChanges::Edge>::const_iterator i = changes.added.begin (); i != changes.added.end (); i++)
+    {
+      int32_t from = tree.Find (i->from);
+      if (from < 0)
+        {
+          continue;
+        }
+      int32_t to = tree.Find (i->to);
+      if (to < 0 || tree.distances[from] + i->metric <= tree.distances[to])
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+GlobalRoutingLSA::SPFStatus
+GlobalRouteManagerImpl::GetLSAStatus (const GlobalRoutingLSA* lsa) const
+{
+  std::unordered_map<const GlobalRoutingLSA*, GlobalRoutingLSA::SPFStatus>::const_iterator i = m_lsaStatus.find (lsa);
+  if (i == m_lsaStatus.end ())
+    {
+      return GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED;
+    }
+  return i->second;
+}
+
+void
+GlobalRouteManagerImpl::SetLSAStatus (const GlobalRoutingLSA* lsa, GlobalRoutingLSA::SPFStatus status)
+{
+  m_lsaStatus[lsa] = status;
+}
+
+int32_t
+GlobalRouteManagerImpl::SPFTree::Find (Ipv4Address id) const
+{
+  std::vector<std::pair<Ipv4Address, uint32_t> >::const_iterator i =
+    std::lower_bound (index.begin (), index.end (), std::make_pair (id, static_cast<uint32_t> (0)));
+  if (i != index.end () && i->first == id)
+    {
+      return i->second;
+    }
+  return -1;
+}
+
+bool
+GlobalRouteManagerImpl::SPFTree::IsParent (uint32_t parent, uint32_t v) const
+{
+  for (uint32_t p = parentStart[v]; p < parentStart[v + 1]; p++)
+    {
+      if (parents[p] == parent)
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+//
+// This method is derived from quagga ospf_spf_next ().  See RFC2328 Section 
+// 16.1 (2) for further details.
+//
+// We're passed a parameter <v> that is a vertex which is already in the SPF
+// tree.  A vertex represents a router node.  We also get a reference to the
+// SPF candidate queue, which is a priority queue containing the shortest paths
+// to the networks we know about.
+//
+// We examine the links in v's LSA and update the list of candidates with any
+// vertices not already on the list.  If a lower-cost path is found to a
+// vertex already on the candidate list, store the new (lower) cost.
+//
+void
+GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
+{
+  NS_LOG_FUNCTION (this << v << &candidate);
+
+  SPFVertex* w = 0;
+  GlobalRoutingLSA* w_lsa = 0;
+  GlobalRoutingLinkRecord *l = 0;
+  uint32_t distance = 0;
+  uint32_t numRecordsInVertex = 0;
+//
+// V points to a Router-LSA or Network-LSA
+// Loop over the links in router LSA or attached routers in Network LSA
+//
+  if (v->GetVertexType () == SPFVertex::VertexRouter)
+    {
+      numRecordsInVertex = v->GetLSA ()->GetNLinkRecords (); 
+    }
+  if (v->GetVertexType () == SPFVertex::VertexNetwork)
+    {
+      numRecordsInVertex = v->GetLSA ()->GetNAttachedRouters (); 
+    }
+
+  for (uint32_t i = 0; i < numRecordsInVertex; i++)
+    {
+// Get w_lsa:  In case of V is Router-LSA
+      if (v->GetVertexType () == SPFVertex::VertexRouter) 
+        {
+          NS_LOG_LOGIC ("Examining link " << i << " of " << 
+                        v->GetVertexId () << "'s " <<
+                        v->GetLSA ()->GetNLinkRecords () << " link records");
+//
+// (a) If this is a link to a stub network, examine the next link in V's LSA.
+// Links to stub networks will be considered in the second stage of the
+// shortest path calculation.
+//
+          l = v->GetLSA ()->GetLinkRecord (i);
+          NS_ASSERT (l != 0);
+          if (l->GetLinkType () == GlobalRoutingLinkRecord::StubNetwork)
+            {
+              NS_LOG_LOGIC ("Found a Stub record to " << l->GetLinkId ());
+              continue;
+            }
+//
+// (b) Otherwise, W is a transit vertex (router or transit network).  Look up
+// the vertex W's LSA (router-LSA or network-LSA) in Area A's link state
+// database. 
+//
+          if (l->GetLinkType () == GlobalRoutingLinkRecord::PointToPoint)
+            {
+//
+// Lookup the link state advertisement of the new link -- we call it <w> in
+// the link state database.
+//
+              w_lsa = m_lsdb->GetLSA (l->GetLinkId ());
+              NS_ASSERT (w_lsa);
+              NS_LOG_LOGIC ("Found a P2P record from " << 
+                            v->GetVertexId () << " to " << w_lsa->GetLinkStateId ());
+            }
+          else if (l->GetLinkType () == 
+                   GlobalRoutingLinkRecord::TransitNetwork)
+            {
+              w_lsa = m_lsdb->GetLSA (l->GetLinkId ());
+              NS_ASSERT (w_lsa);
+              NS_LOG_LOGIC ("Found a Transit record from " << 
+                            v->GetVertexId () << " to " << w_lsa->GetLinkStateId ());
+            }
+          else 
+            {
+              NS_ASSERT_MSG (0, "illegal Link Type");
+            }
+        }
+// Get w_lsa:  In case of V is Network-LSA
+      if (v->GetVertexType () == SPFVertex::VertexNetwork) 
+        {
+          w_lsa = m_lsdb->GetLSAByLinkData 
+              (v->GetLSA ()->GetAttachedRouter (i));
+          if (!w_lsa)
+            {
+              continue;
+            }
+          NS_LOG_LOGIC ("Found a Network LSA from " << 
+                        v->GetVertexId () << " to " << w_lsa->GetLinkStateId ());
+        }
+
+// Note:  w_lsa at this point may be either RouterLSA or NetworkLSA
+//
+// (c) If vertex W is already on the shortest-path tree, examine the next
+// link in the LSA.
+//
+// If the link is to a router that is already in the shortest path first tree
+// then we have it covered -- ignore it.
+//
+      if (GetLSAStatus (w_lsa) == GlobalRoutingLSA::LSA_SPF_IN_SPFTREE) 
+        {
+          NS_LOG_LOGIC ("Skipping ->  LSA "<< 
+                        w_lsa->GetLinkStateId () << " already in SPF tree");
+          continue;
+        }
+//
+// (d) Calculate the link state cost D of the resulting path from the root to 
+// vertex W.  D is equal to the sum of the link state cost of the (already 
+// calculated) shortest path to vertex V and the advertised cost of the link
+// between vertices V and W.
+//
+      if (v->GetLSA ()->GetLSType () == GlobalRoutingLSA::RouterLSA)
+        {
+          NS_ASSERT (l != 0);
+          distance = v->GetDistanceFromRoot () + l->GetMetric ();
+        }
+      else
+        {
+          distance = v->GetDistanceFromRoot ();
+        }
+
+      NS_LOG_LOGIC ("Considering w_lsa " << w_lsa->GetLinkStateId ());
+
+// Is there already vertex w in candidate list?
+      if (GetLSAStatus (w_lsa) == GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED)
+        {
+// Calculate nexthop to w
+// We need to figure out how to actually get to the new router represented
+// by <w>.  This will (among other things) find the next hop address to send
+// packets destined for this network to, and also find the outbound interface
+// used to forward the packets.
+
+// prepare vertex w
+          w = new SPFVertex (w_lsa);
+          if (SPFNexthopCalculation (v, w, l, distance))
+            {
+              SetLSAStatus (w_lsa, GlobalRoutingLSA::LSA_SPF_CANDIDATE);
+//
+// Push this new vertex onto the priority queue (ordered by distance from the
+// root node).
 //
               candidate.Push (w);
               NS_LOG_LOGIC ("Pushing " << 
@@ -888,7 +1479,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
             NS_ASSERT_MSG (0, "SPFNexthopCalculation never " 
                            << "return false, but it does now!");
         }
-      else if (w_lsa->GetStatus () == GlobalRoutingLSA::LSA_SPF_CANDIDATE)
+      else if (GetLSAStatus (w_lsa) == GlobalRoutingLSA::LSA_SPF_CANDIDATE)
         {
 //
 // We have already considered the link represented by <w>.  What wse have to
@@ -1247,7 +1838,21 @@ void
 GlobalRouteManagerImpl::DebugSPFCalculate (Ipv4Address root)
 {
   NS_LOG_FUNCTION (this << root);
-  SPFCalculate (root);
+  Ptr<Node> node;
+  NodeList::Iterator listEnd = NodeList::End ();
+  for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
+    {
+      Ptr<GlobalRouter> rtr = (*i)->GetObject<GlobalRouter> ();
+      if (rtr && rtr->GetRouterId () == root)
+        {
+          node = *i;
+          break;
+        }
+    }
+  SPFRoot* spfRoot = CreateRoot (node, root);
+  ProcessRoot (*spfRoot);
+  InstallRoutes (*spfRoot);
+  delete spfRoot;
 }
 
 //
@@ -1320,12 +1925,13 @@ GlobalRouteManagerImpl::CheckForStubNode (Ipv4Address root)
               if (lr->GetLinkId () == myRouterId)
                 {
                   // Next hop is stored in the LinkID field of lr
-                  Ptr<GlobalRouter> router = rlsa->GetNode ()->GetObject<GlobalRouter> ();
-                  NS_ASSERT (router);
-                  Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-                  NS_ASSERT (gr);
-                  gr->AddNetworkRouteTo (Ipv4Address ("0.0.0.0"), Ipv4Mask ("0.0.0.0"), lr->GetLinkData (), 
-                                         FindOutgoingInterfaceId (transitLink->GetLinkData ()));
+                  SPFRoute route;
+                  route.type = SPFRoute::NETWORK;
+                  route.dest = Ipv4Address ("0.0.0.0");
+                  route.mask = Ipv4Mask ("0.0.0.0");
+                  route.nextHop = lr->GetLinkData ();
+                  route.outIf = FindOutgoingInterfaceId (transitLink->GetLinkData ());
+                  m_root->routes.push_back (route);
                   NS_LOG_LOGIC ("Inserting default route for node " << myRouterId << " to next hop " << 
                                 lr->GetLinkData () << " via interface " << 
                                 FindOutgoingInterfaceId (transitLink->GetLinkData ()));
@@ -1344,10 +1950,12 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
   NS_LOG_FUNCTION (this << root);
 
   SPFVertex *v;
+  SPFTree &tree = m_root->tree;
+  NS_ASSERT (tree.ids.empty ());
 //
-// Initialize the Link State Database.
+// Initialize the status of the Link State Advertisements.
 //
-  m_lsdb->Initialize ();
+  m_lsaStatus.clear ();
 //
 // The candidate queue is a priority queue of SPFVertex objects, with the top
 // of the queue being the closest vertex in terms of distance from the root
@@ -1367,7 +1975,7 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 //
   m_spfroot= v;
   v->SetDistanceFromRoot (0);
-  v->GetLSA ()->SetStatus (GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
+  SetLSAStatus (v->GetLSA (), GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
   NS_LOG_LOGIC ("Starting SPFCalculate for node " << root);
 
 //
@@ -1377,13 +1985,17 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // reached.  Instead, short-circuit this computation and just install
 // a default route in the CheckForStubNode() method.
 //
-  if (NodeList::GetNNodes () > 0 && CheckForStubNode (root))
+  if (m_root->checkStub && CheckForStubNode (root))
     {
       NS_LOG_LOGIC ("SPFCalculate truncated for stub node " << root);
+      tree.stub = true;
       delete m_spfroot;
+      m_spfroot = 0;
       return;
     }
 
+  std::vector<Ipv4Address> parentIds;
+  SPFRecordVertex (v, parentIds);
   for (;;)
     {
 //
@@ -1428,7 +2040,7 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // Update the status field of the vertex to indicate that it is in the SPF
 // tree.
 //
-      v->GetLSA ()->SetStatus (GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
+      SetLSAStatus (v->GetLSA (), GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
 //
 // The current vertex has a parent pointer.  By calling this rather oddly 
 // named method (blame quagga) we add the current vertex to the list of 
@@ -1444,267 +2056,188 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 //
 // RFC2328 16.1. (4). 
 //
-// This is the method that actually adds the routes.  It'll walk the list
-// of nodes in the system, looking for the node corresponding to the router
-// ID of the root of the tree -- that is the router we're building the routes
-// for.  It looks for the Ipv4 interface of that node and remembers it.  So
-// we are only actually adding routes to that one node at the root of the SPF 
-// tree.
+// We record the vertex, with its distance, parents and the next hops and
+// outbound interfaces to reach it from the root, in the tree of the root.
+// The routes to the vertex are added in the order of the tree, once it is
+// complete (see SPFGenerateRoutes).
 //
-// We're going to pop of a pointer to every vertex in the tree except the 
-// root in order of distance from the root.  For each of the vertices, we call
-// SPFIntraAddRouter ().  Down in SPFIntraAddRouter, we look at all of the 
-// point-to-point Global Router Link Records (the links to nodes adjacent to
-// the node represented by the vertex).  We add a route to the IP address 
-// specified by the m_linkData field of each of those link records.  This will
-// be the *local* IP address associated with the interface attached to the 
-// link.  We use the outbound interface and next hop information present in 
-// the vertex <v> which have possibly been inherited from the root.
+      SPFRecordVertex (v, parentIds);
 //
-// To summarize, we're going to look at the node represented by <v> and loop
-// through its point-to-point links, adding a *host* route to the local IP
-// address (at the <v> side) for each of those links.
-//
-      if (v->GetVertexType () == SPFVertex::VertexRouter)
-        {
-          SPFIntraAddRouter (v);
-        }
-      else if (v->GetVertexType () == SPFVertex::VertexNetwork)
-        {
-          SPFIntraAddTransit (v);
-        }
-      else
-        {
-          NS_ASSERT_MSG (0, "illegal SPFVertex type");
-        }
-//
-// RFC2328 16.1. (5). 
+// RFC2328 16.1. (5). 
 //
 // Iterate the algorithm by returning to Step 2 until there are no more
 // candidate vertices.
 
     }  // end for loop
 
-// Second stage of SPF calculation procedure
-  SPFProcessStubs (m_spfroot);
-  for (uint32_t i = 0; i < m_lsdb->GetNumExtLSAs (); i++)
+  tree.exitStart.push_back (tree.exits.size ());
+  tree.parentStart.push_back (tree.parents.size ());
+  std::sort (tree.index.begin (), tree.index.end ());
+  tree.parents.reserve (parentIds.size ());
+  for (std::vector<Ipv4Address>::const_iterator i = parentIds.begin (); i != parentIds.end (); i++)
     {
-      m_spfroot->ClearVertexProcessed ();
-      GlobalRoutingLSA *extlsa = m_lsdb->GetExtLSA (i);
-      NS_LOG_LOGIC ("Processing External LSA with id " << extlsa->GetLinkStateId ());
-      ProcessASExternals (m_spfroot, extlsa);
+      tree.parents.push_back (tree.Find (*i));
     }
 
+// Second stage of SPF calculation procedure
+  SPFProcessStubs (m_spfroot);
+
 //
-// We're all done setting the routing information for the node at the root of
-// the SPF tree.  Delete all of the vertices and corresponding resources.  Go
-// possibly do it again for the next router.
+// Delete all of the vertices and corresponding resources, then add the
+// routes of the node at the root of the SPF tree.
 //
   delete m_spfroot;
   m_spfroot = 0;
+  SPFGenerateRoutes ();
 }
 
 void
-GlobalRouteManagerImpl::ProcessASExternals (SPFVertex* v, GlobalRoutingLSA* extlsa)
+GlobalRouteManagerImpl::SPFRecordVertex (SPFVertex* v, std::vector<Ipv4Address> &parentIds)
 {
-  NS_LOG_FUNCTION (this << v << extlsa);
-  NS_LOG_LOGIC ("Processing external for destination " << 
-                extlsa->GetLinkStateId () <<
-                ", for router "  << v->GetVertexId () <<
-                ", advertised by " << extlsa->GetAdvertisingRouter ());
-  if (v->GetVertexType () == SPFVertex::VertexRouter)
+  NS_LOG_FUNCTION (this << v);
+  SPFTree &tree = m_root->tree;
+  tree.index.push_back (std::make_pair (v->GetVertexId (), tree.ids.size ()));
+  tree.ids.push_back (v->GetVertexId ());
+  tree.distances.push_back (v->GetDistanceFromRoot ());
+  tree.exitStart.push_back (tree.exits.size ());
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
     {
-      GlobalRoutingLSA *rlsa = v->GetLSA ();
-      NS_LOG_LOGIC ("Processing router LSA with id " << rlsa->GetLinkStateId ());
-      if ((rlsa->GetLinkStateId ()) == (extlsa->GetAdvertisingRouter ()))
+      tree.exits.push_back (v->GetRootExitDirection (i));
+    }
+  tree.parentStart.push_back (parentIds.size ());
+  for (uint32_t i = 0;;)
+    {
+      SPFVertex* parent = v->GetParent (i++);
+      if (parent == 0)
         {
-          NS_LOG_LOGIC ("Found advertising router to destination");
-          SPFAddASExternal (extlsa,v);
+          break;
         }
+      parentIds.push_back (parent->GetVertexId ());
     }
+}
+
+// Processing logic from RFC 2328, page 166 and quagga ospf_spf_process_stubs ()
+// stub link records will exist for point-to-point interfaces and for
+// broadcast interfaces for which no neighboring router can be found
+void
+GlobalRouteManagerImpl::SPFProcessStubs (SPFVertex* v)
+{
+  NS_LOG_FUNCTION (this << v);
+  NS_LOG_LOGIC ("Processing stubs for " << v->GetVertexId ());
+  m_root->tree.stubOrder.push_back (m_root->tree.Find (v->GetVertexId ()));
   for (uint32_t i = 0; i < v->GetNChildren (); i++)
     {
       if (!v->GetChild (i)->IsVertexProcessed ())
         {
-          NS_LOG_LOGIC ("Vertex's child " << i << " not yet processed, processing...");
-          ProcessASExternals (v->GetChild (i), extlsa);
+          SPFProcessStubs (v->GetChild (i));
           v->GetChild (i)->SetVertexProcessed (true);
         }
     }
 }
 
-//
-// Adding external routes to routing table - modeled after
-// SPFAddIntraAddStub()
-//
-
 void
-GlobalRouteManagerImpl::SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v)
+GlobalRouteManagerImpl::SPFGenerateRoutes (void)
 {
-  NS_LOG_FUNCTION (this << extlsa << v);
-
-  NS_ASSERT_MSG (m_spfroot, "GlobalRouteManagerImpl::SPFAddASExternal (): Root pointer not set");
-// Two cases to consider: We are advertising the external ourselves
-// => No need to add anything
-// OR find best path to the advertising router
-  if (v->GetVertexId () == m_spfroot->GetVertexId ())
-    {
-      NS_LOG_LOGIC ("External is on local host: " 
-                    << v->GetVertexId () << "; returning");
-      return;
-    }
-  NS_LOG_LOGIC ("External is on remote host: " 
-                << extlsa->GetAdvertisingRouter () << "; installing");
-
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
-
-  NS_LOG_LOGIC ("Vertex ID = " << routerId);
+  NS_LOG_FUNCTION (this);
+  const SPFTree &tree = m_root->tree;
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
+// We're going to look at every vertex in the tree except the root in order
+// of distance from the root.  For router vertices, we call
+// SPFIntraAddRouter (), which adds a *host* route to the local IP address of
+// each of the point-to-point links of the vertex.  For network vertices,
+// we call SPFIntraAddTransit (), which adds a route to the network.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  for (uint32_t v = 1; v < tree.ids.size (); v++)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to QI for that interface.  If there's no GlobalRouter interface, the node
-// in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
+      GlobalRoutingLSA *lsa = m_lsdb->GetLSA (tree.ids[v]);
+      NS_ASSERT_MSG (lsa, "GlobalRouteManagerImpl::SPFGenerateRoutes (): "
+                     "Expected valid LSA for vertex " << tree.ids[v]);
+      if (lsa->GetLSType () == GlobalRoutingLSA::RouterLSA)
         {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << node->GetId ());
-          continue;
+          SPFIntraAddRouter (lsa, v);
         }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
+      else if (lsa->GetLSType () == GlobalRoutingLSA::NetworkLSA)
         {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to QI
-// for that interface.  If the node is acting as an IP version 4 router, it
-// should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "QI for <Ipv4> interface failed");
-//
-// Get the Global Router Link State Advertisement from the vertex we're
-// adding the routes to.  The LSA will have a number of attached Global Router
-// Link Records corresponding to links off of that vertex / node.  We're going
-// to be interested in the records corresponding to point-to-point links.
-//
-          NS_ASSERT_MSG (v->GetLSA (), 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask ();
-          Ipv4Address tempip = extlsa->GetLinkStateId ();
-          tempip = tempip.CombineMask (tempmask);
-
+          SPFIntraAddTransit (lsa, v);
+        }
+      else
+        {
+          NS_ASSERT_MSG (0, "illegal SPFVertex type");
+        }
+    }
 //
-// Here's why we did all of that work.  We're going to add a host route to the
-// host address found in the m_linkData field of the point-to-point link
-// record.  In the case of a point-to-point link, this is the local IP address
-// of the node connected to the link.  Each of these point-to-point links
-// will correspond to a local interface that has an IP address to which
-// the node at the root of the SPF tree can send packets.  The vertex <v> 
-// (corresponding to the node that has these links and interfaces) has 
-// an m_nextHop address precalculated for us that is the address to which the
-// root node should send packets to be forwarded to these IP addresses.
-// Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
-// which the packets should be send for forwarding.
+// Second stage: the stub link records of the routers of the tree, and the
+// AS external destinations advertised by those routers, in the order the
+// vertices have been processed by SPFProcessStubs ().
 //
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all next-hop-IPs and out-going-interfaces for reaching
-          // the stub network gateway 'v' from the root node
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-              if (outIf >= 0)
-                {
-                  gr->AddASExternalRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add external network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative");
-                }
-            }
-          return;
-        } // if
-    } // for
-}
-
-
-// Processing logic from RFC 2328, page 166 and quagga ospf_spf_process_stubs ()
-// stub link records will exist for point-to-point interfaces and for
-// broadcast interfaces for which no neighboring router can be found
-void
-GlobalRouteManagerImpl::SPFProcessStubs (SPFVertex* v)
-{
-  NS_LOG_FUNCTION (this << v);
-  NS_LOG_LOGIC ("Processing stubs for " << v->GetVertexId ());
-  if (v->GetVertexType () == SPFVertex::VertexRouter)
+  for (std::vector<uint32_t>::const_iterator i = tree.stubOrder.begin (); i != tree.stubOrder.end (); i++)
     {
-      GlobalRoutingLSA *rlsa = v->GetLSA ();
+      GlobalRoutingLSA *rlsa = m_lsdb->GetLSA (tree.ids[*i]);
+      if (rlsa->GetLSType () != GlobalRoutingLSA::RouterLSA)
+        {
+          continue;
+        }
       NS_LOG_LOGIC ("Processing router LSA with id " << rlsa->GetLinkStateId ());
-      for (uint32_t i = 0; i < rlsa->GetNLinkRecords (); i++)
+      for (uint32_t j = 0; j < rlsa->GetNLinkRecords (); j++)
         {
-          NS_LOG_LOGIC ("Examining link " << i << " of " << 
-                        v->GetVertexId () << "'s " <<
-                        v->GetLSA ()->GetNLinkRecords () << " link records");
-          GlobalRoutingLinkRecord *l = v->GetLSA ()->GetLinkRecord (i);
+          GlobalRoutingLinkRecord *l = rlsa->GetLinkRecord (j);
           if (l->GetLinkType () == GlobalRoutingLinkRecord::StubNetwork)
             {
               NS_LOG_LOGIC ("Found a Stub record to " << l->GetLinkId ());
-              SPFIntraAddStub (l, v);
-              continue;
+              SPFIntraAddStub (l, *i);
             }
         }
     }
-  for (uint32_t i = 0; i < v->GetNChildren (); i++)
+  for (uint32_t i = 0; i < m_lsdb->GetNumExtLSAs (); i++)
     {
-      if (!v->GetChild (i)->IsVertexProcessed ())
+      GlobalRoutingLSA *extlsa = m_lsdb->GetExtLSA (i);
+      NS_LOG_LOGIC ("Processing External LSA with id " << extlsa->GetLinkStateId () <<
+                    ", advertised by " << extlsa->GetAdvertisingRouter ());
+      int32_t v = tree.Find (extlsa->GetAdvertisingRouter ());
+      if (v >= 0 && m_lsdb->GetLSA (tree.ids[v])->GetLSType () == GlobalRoutingLSA::RouterLSA)
         {
-          SPFProcessStubs (v->GetChild (i));
-          v->GetChild (i)->SetVertexProcessed (true);
+          NS_LOG_LOGIC ("Found advertising router to destination");
+          SPFAddASExternal (extlsa, v);
         }
     }
 }
 
+//
+// Adding external routes to routing table - modeled after
+// SPFAddIntraAddStub()
+//
+
+void
+GlobalRouteManagerImpl::SPFAddASExternal (GlobalRoutingLSA *extlsa, uint32_t v)
+{
+  NS_LOG_FUNCTION (this << extlsa << v);
+
+  NS_ASSERT_MSG (m_root, "GlobalRouteManagerImpl::SPFAddASExternal (): Root pointer not set");
+// Two cases to consider: We are advertising the external ourselves
+// => No need to add anything
+// OR find best path to the advertising router
+  if (v == 0)
+    {
+      NS_LOG_LOGIC ("External is on local host: " 
+                    << m_root->routerId << "; returning");
+      return;
+    }
+  NS_LOG_LOGIC ("External is on remote host: " 
+                << extlsa->GetAdvertisingRouter () << "; installing");
+
+  Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask ();
+  Ipv4Address tempip = extlsa->GetLinkStateId ();
+  tempip = tempip.CombineMask (tempmask);
+  SPFAddRoutes (SPFRoute::EXTERNAL, tempip, tempmask, v);
+}
+
 // RFC2328 16.1. second stage. 
 void
-GlobalRouteManagerImpl::SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex* v)
+GlobalRouteManagerImpl::SPFIntraAddStub (GlobalRoutingLinkRecord *l, uint32_t v)
 {
   NS_LOG_FUNCTION (this << l << v);
 
-  NS_ASSERT_MSG (m_spfroot, 
+  NS_ASSERT_MSG (m_root, 
                  "GlobalRouteManagerImpl::SPFIntraAddStub (): Root pointer not set");
 
   // XXX simplifed logic for the moment.  There are two cases to consider:
@@ -1712,472 +2245,340 @@ GlobalRouteManagerImpl::SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex*
   //    (already handled above)
   // 2) the stub network is on a remote router, so I should use the
   // same next hop that I use to get to vertex v
-  if (v->GetVertexId () == m_spfroot->GetVertexId ())
+  if (v == 0)
     {
-      NS_LOG_LOGIC ("Stub is on local host: " << v->GetVertexId () << "; returning");
+      NS_LOG_LOGIC ("Stub is on local host: " << m_root->routerId << "; returning");
       return;
     }
-  NS_LOG_LOGIC ("Stub is on remote host: " << v->GetVertexId () << "; installing");
-//
-// The root of the Shortest Path First tree is the router to which we are 
-// going to write the actual routing table entries.  The vertex corresponding
-// to this router has a vertex ID which is the router ID of that node.  We're
-// going to use this ID to discover which node it is that we're actually going
-// to update.
-//
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
-
-  NS_LOG_LOGIC ("Vertex ID = " << routerId);
-//
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
-    {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to QI for that interface.  If there's no GlobalRouter interface, the node
-// in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to QI
-// for that interface.  If the node is acting as an IP version 4 router, it
-// should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "QI for <Ipv4> interface failed");
-//
-// Get the Global Router Link State Advertisement from the vertex we're
-// adding the routes to.  The LSA will have a number of attached Global Router
-// Link Records corresponding to links off of that vertex / node.  We're going
-// to be interested in the records corresponding to point-to-point links.
-//
-          NS_ASSERT_MSG (v->GetLSA (), 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask (l->GetLinkData ().Get ());
-          Ipv4Address tempip = l->GetLinkId ();
-          tempip = tempip.CombineMask (tempmask);
-//
-// Here's why we did all of that work.  We're going to add a host route to the
-// host address found in the m_linkData field of the point-to-point link
-// record.  In the case of a point-to-point link, this is the local IP address
-// of the node connected to the link.  Each of these point-to-point links
-// will correspond to a local interface that has an IP address to which
-// the node at the root of the SPF tree can send packets.  The vertex <v> 
-// (corresponding to the node that has these links and interfaces) has 
-// an m_nextHop address precalculated for us that is the address to which the
-// root node should send packets to be forwarded to these IP addresses.
-// Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
-// which the packets should be send for forwarding.
-//
+  NS_LOG_LOGIC ("Stub is on remote host: " << m_root->tree.ids[v] << "; installing");
 
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all next-hop-IPs and out-going-interfaces for reaching
-          // the stub network gateway 'v' from the root node
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-              if (outIf >= 0)
-                {
-                  gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative");
-                }
-            }
-          return;
-        } // if
-    } // for
+  Ipv4Mask tempmask (l->GetLinkData ().Get ());
+  Ipv4Address tempip = l->GetLinkId ();
+  tempip = tempip.CombineMask (tempmask);
+  SPFAddRoutes (SPFRoute::NETWORK, tempip, tempmask, v);
 }
 
-//
 // Return the interface number corresponding to a given IP address and mask
-// This is a wrapper around GetInterfaceForPrefix(), but we first
-// have to find the right node pointer to pass to that function.
+// This mirrors GetInterfaceForPrefix() on the node at the root of the SPF
+// tree, whose interface addresses have been gathered by CreateRoot ().
 // If no such interface is found, return -1 (note:  unit test framework
 // for routing assumes -1 to be a legal return value)
-//
 int32_t
 GlobalRouteManagerImpl::FindOutgoingInterfaceId (Ipv4Address a, Ipv4Mask amask)
 {
   NS_LOG_FUNCTION (this << a << amask);
-//
-// We have an IP address <a> and a vertex ID of the root of the SPF tree.
-// The question is what interface index does this address correspond to.
-// The answer is a little complicated since we have to find a pointer to
-// the node corresponding to the vertex ID, find the Ipv4 interface on that
-// node in order to iterate the interfaces and find the one corresponding to
-// the address in question.
-//
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
-//
-// Walk the list of nodes in the system looking for the one corresponding to
-// the node at the root of the SPF tree.  This is the node for which we are
-// building the routing table.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  const std::vector<std::pair<Ipv4Address, int32_t> > &interfaces = m_root->tree.interfaces;
+  for (std::vector<std::pair<Ipv4Address, int32_t> >::const_iterator i = interfaces.begin ();
+       i != interfaces.end (); i++)
     {
-      Ptr<Node> node = *i;
-
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-//
-// If the node doesn't have a GlobalRouter interface it can't be the one
-// we're interested in.
-//
-      if (rtr == 0)
+      if (i->first.CombineMask (amask) == a.CombineMask (amask))
         {
-          continue;
-        }
-
-      if (rtr->GetRouterId () == routerId)
-        {
-//
-// This is the node we're building the routing table for.  We're going to need
-// the Ipv4 interface to look for the ipv4 interface index.  Since this node
-// is participating in routing IP version 4 packets, it certainly must have 
-// an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::FindOutgoingInterfaceId (): "
-                         "GetObject for <Ipv4> interface failed");
-//
-// Look through the interfaces on this node for one that has the IP address
-// we're looking for.  If we find one, return the corresponding interface
-// index, or -1 if not found.
-//
-          int32_t interface = ipv4->GetInterfaceForPrefix (a, amask);
-
-#if 0
-          if (interface < 0)
-            {
-              NS_FATAL_ERROR ("GlobalRouteManagerImpl::FindOutgoingInterfaceId(): "
-                              "Expected an interface associated with address a:" << a);
-            }
-#endif 
-          return interface;
+          return i->second;
         }
     }
-//
 // Couldn't find it.
-//
-  NS_LOG_LOGIC ("FindOutgoingInterfaceId():Can't find root node " << routerId);
   return -1;
 }
 
-//
 // This method is derived from quagga ospf_intra_add_router ()
 //
 // This is where we are actually going to add the host routes to the routing
 // tables of the individual nodes.
 //
-// The vertex passed as a parameter has just been added to the SPF tree.
-// This vertex must have a valid m_root_oid, corresponding to the outgoing
-// interface on the root router of the tree that is the first hop on the path
-// to the vertex.  The vertex must also have a next hop address, corresponding
-// to the next hop on the path to the vertex.  The vertex has an m_lsa field
-// that has some number of link records.  For each point to point link record,
-// the m_linkData is the local IP address of the link.  This corresponds to
-// a destination IP address, reachable from the root, to which we add a host
-// route.
+// The vertex passed as a parameter is in the SPF tree of the root.  It has
+// root exit directions, i.e., the outgoing interfaces on the root router of
+// the tree that are the first hop on the paths to the vertex, and the next
+// hops on those paths.  The LSA of the vertex has some number of link
+// records.  For each point to point link record, the m_linkData is the local
+// IP address of the link.  This corresponds to a destination IP address,
+// reachable from the root, to which we add a host route.
 //
 void
-GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
+GlobalRouteManagerImpl::SPFIntraAddRouter (GlobalRoutingLSA* lsa, uint32_t v)
 {
-  NS_LOG_FUNCTION (this << v);
+  NS_LOG_FUNCTION (this << lsa << v);
 
-  NS_ASSERT_MSG (m_spfroot, 
+  NS_ASSERT_MSG (m_root, 
                  "GlobalRouteManagerImpl::SPFIntraAddRouter (): Root pointer not set");
+  NS_LOG_LOGIC ("Node " << m_root->routerId <<
+                " found " << lsa->GetNLinkRecords () << " link records in LSA " <<
+                lsa << "with LinkStateId "<< lsa->GetLinkStateId ());
 //
-// The root of the Shortest Path First tree is the router to which we are 
-// going to write the actual routing table entries.  The vertex corresponding
-// to this router has a vertex ID which is the router ID of that node.  We're
-// going to use this ID to discover which node it is that we're actually going
-// to update.
-//
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
-
-  NS_LOG_LOGIC ("Vertex ID = " << routerId);
-//
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
+// Iterate through the link records on the vertex to which we're going to add
+// routes.  We're going to add routing table entries to the tables on the
+// node corresponding to the root of the SPF tree.  These entries will have
+// routes to the IP addresses we find from looking at the local side of the
+// point-to-point links found on the node described by the vertex <v>.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  for (uint32_t j = 0; j < lsa->GetNLinkRecords (); ++j)
     {
-      Ptr<Node> node = *i;
 //
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to GetObject for that interface.  If there's no GlobalRouter interface, 
-// the node in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
+// We are only concerned about point-to-point links
+//
+      GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
+      if (lr->GetLinkType () != GlobalRoutingLinkRecord::PointToPoint)
         {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
           continue;
         }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
+      SPFAddRoutes (SPFRoute::HOST, lr->GetLinkData (), Ipv4Mask::GetOnes (), v);
+    }
+}
 
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to 
-// GetObject for that interface.  If the node is acting as an IP version 4 
-// router, it should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "GetObject for <Ipv4> interface failed");
-//
-// Get the Global Router Link State Advertisement from the vertex we're
-// adding the routes to.  The LSA will have a number of attached Global Router
-// Link Records corresponding to links off of that vertex / node.  We're going
-// to be interested in the records corresponding to point-to-point links.
-//
-          GlobalRoutingLSA *lsa = v->GetLSA ();
-          NS_ASSERT_MSG (lsa, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
+void
+GlobalRouteManagerImpl::SPFIntraAddTransit (GlobalRoutingLSA* lsa, uint32_t v)
+{
+  NS_LOG_FUNCTION (this << lsa << v);
+
+  NS_ASSERT_MSG (m_root, 
+                 "GlobalRouteManagerImpl::SPFIntraAddTransit (): Root pointer not set");
+  Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask ();
+  Ipv4Address tempip = lsa->GetLinkStateId ();
+  tempip = tempip.CombineMask (tempmask);
+  SPFAddRoutes (SPFRoute::NETWORK, tempip, tempmask, v);
+}
 
-          uint32_t nLinkRecords = lsa->GetNLinkRecords ();
-//
-// Iterate through the link records on the vertex to which we're going to add
-// routes.  To make sure we're being clear, we're going to add routing table
-// entries to the tables on the node corresping to the root of the SPF tree.
-// These entries will have routes to the IP addresses we find from looking at
-// the local side of the point-to-point links found on the node described by
-// the vertex <v>.
-//
-          NS_LOG_LOGIC (" Node " << node->GetId () <<
-                        " found " << nLinkRecords << " link records in LSA " << lsa << "with LinkStateId "<< lsa->GetLinkStateId ());
-          for (uint32_t j = 0; j < nLinkRecords; ++j)
-            {
-//
-// We are only concerned about point-to-point links
-//
-              GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
-              if (lr->GetLinkType () != GlobalRoutingLinkRecord::PointToPoint)
-                {
-                  continue;
-                }
-//
-// Here's why we did all of that work.  We're going to add a host route to the
-// host address found in the m_linkData field of the point-to-point link
-// record.  In the case of a point-to-point link, this is the local IP address
-// of the node connected to the link.  Each of these point-to-point links
-// will correspond to a local interface that has an IP address to which
-// the node at the root of the SPF tree can send packets.  The vertex <v> 
-// (corresponding to the node that has these links and interfaces) has 
-// an m_nextHop address precalculated for us that is the address to which the
-// root node should send packets to be forwarded to these IP addresses.
-// Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
-// which the packets should be send for forwarding.
-//
-              Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-              if (router == 0)
-                {
-                  continue;
-                }
-              Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-              NS_ASSERT (gr);
-              // walk through all available exit directions due to ECMP,
-              // and add host route for each of the exit direction toward
-              // the vertex 'v'
-              for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-                {
-                  SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-                  Ipv4Address nextHop = exit.first;
-                  int32_t outIf = exit.second;
-                  if (outIf >= 0)
-                    {
-                      gr->AddHostRouteTo (lr->GetLinkData (), nextHop,
-                                          outIf);
-                      NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                    " adding host route to " << lr->GetLinkData () <<
-                                    " using next hop " << nextHop <<
-                                    " and outgoing interface " << outIf);
-                    }
-                  else
-                    {
-                      NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                    " NOT able to add host route to " << lr->GetLinkData () <<
-                                    " using next hop " << nextHop <<
-                                    " since outgoing interface id is negative " << outIf);
-                    }
-                } // for all routes from the root the vertex 'v'
-            }
 //
-// Done adding the routes for the selected node.
+// Walk through all available exit directions due to ECMP, and add a route to
+// the destination for each of the exit directions toward the vertex 'v'
 //
+void
+GlobalRouteManagerImpl::SPFAddRoutes (SPFRoute::Type type, Ipv4Address dest, Ipv4Mask mask, uint32_t v)
+{
+  NS_LOG_FUNCTION (this << type << dest << mask << v);
+  const SPFTree &tree = m_root->tree;
+  for (uint32_t i = tree.exitStart[v]; i < tree.exitStart[v + 1]; i++)
+    {
+      Ipv4Address nextHop = tree.exits[i].first;
+      int32_t outIf = tree.exits[i].second;
+      if (outIf >= 0)
+        {
+          SPFRoute route;
+          route.type = type;
+          route.dest = dest;
+          route.mask = mask;
+          route.nextHop = nextHop;
+          route.outIf = outIf;
+          m_root->routes.push_back (route);
+          NS_LOG_LOGIC ("(Route " << i - tree.exitStart[v] << ") Node " << m_root->routerId <<
+                        " add route to " << dest << "/" << mask <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
+        }
+      else
+        {
+          NS_LOG_LOGIC ("(Route " << i - tree.exitStart[v] << ") Node " << m_root->routerId <<
+                        " NOT able to add route to " << dest << "/" << mask <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative " << outIf);
+        }
+    }
+}
+
+/**
+ * \brief Next hops (next hop address and outgoing interface) of the routes
+ * to a destination, in the order they are looked up
+ */
+typedef std::vector<std::pair<Ipv4Address, uint32_t> > NextHops_t;
+
+/**
+ * \brief Reduce a list of next hops made of a single repeated next hop to
+ * this next hop, which yields the same forwarding decisions
+ * \param nextHops the next hops
+ */
+static void
+NormalizeNextHops (NextHops_t &nextHops)
+{
+  for (uint32_t i = 1; i < nextHops.size (); i++)
+    {
+      if (nextHops[i] != nextHops[0])
+        {
           return;
         }
     }
+  nextHops.resize (std::min<std::size_t> (nextHops.size (), 1));
 }
+
 void
-GlobalRouteManagerImpl::SPFIntraAddTransit (SPFVertex* v)
+GlobalRouteManagerImpl::AggregateRoutes (std::vector<SPFRoute> &routes)
 {
-  NS_LOG_FUNCTION (this << v);
-
-  NS_ASSERT_MSG (m_spfroot, 
-                 "GlobalRouteManagerImpl::SPFIntraAddTransit (): Root pointer not set");
+  NS_LOG_FUNCTION (routes.size ());
+  typedef std::pair<uint32_t, uint32_t> Prefix_t;   // network and prefix length
 //
-// The root of the Shortest Path First tree is the router to which we are 
-// going to write the actual routing table entries.  The vertex corresponding
-// to this router has a vertex ID which is the router ID of that node.  We're
-// going to use this ID to discover which node it is that we're actually going
-// to update.
+// Gather the next hops of the host routes, by destination, and of the
+// network routes, by prefix, and index the network routes by prefix.
 //
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
-
-  NS_LOG_LOGIC ("Vertex ID = " << routerId);
+  std::map<uint32_t, NextHops_t> hosts;
+  std::map<Prefix_t, NextHops_t> prefixes;
+  PrefixTrie<uint32_t, 4> networks;
+  for (uint32_t i = 0; i < routes.size (); i++)
+    {
+      const SPFRoute &route = routes[i];
+      if (route.type == SPFRoute::HOST)
+        {
+          hosts[route.dest.Get ()].push_back (std::make_pair (route.nextHop, route.outIf));
+        }
+      else if (route.type == SPFRoute::NETWORK)
+        {
+          uint8_t key[4];
+          route.dest.Serialize (key);
+          networks.Insert (key, route.mask.GetPrefixLength (), i);
+          Prefix_t prefix (route.dest.CombineMask (route.mask).Get (), route.mask.GetPrefixLength ());
+          prefixes[prefix].push_back (std::make_pair (route.nextHop, route.outIf));
+        }
+    }
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
+// A host route is redundant if the network routes matching the destination
+// lead to the same forwarding decisions.  The host routes to destinations
+// not matching any network route are handled as /32 network routes below.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  std::set<uint32_t> removedHosts;
+  std::set<Prefix_t> hostPrefixes;
+  std::vector<uint32_t> matches;
+  for (std::map<uint32_t, NextHops_t>::iterator it = hosts.begin (); it != hosts.end (); it++)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to GetObject for that interface.  If there's no GlobalRouter interface, 
-// the node in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
+      uint8_t key[4];
+      Ipv4Address (it->first).Serialize (key);
+      networks.FindAll (key, matches);
+      NormalizeNextHops (it->second);
+      if (matches.empty ())
         {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
+          prefixes[Prefix_t (it->first, 32)] = it->second;
+          hostPrefixes.insert (Prefix_t (it->first, 32));
           continue;
         }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
+      NextHops_t nextHops;
+      for (uint32_t j = 0; j < matches.size (); j++)
+        {
+          nextHops.push_back (std::make_pair (routes[matches[j]].nextHop, routes[matches[j]].outIf));
+        }
+      NormalizeNextHops (nextHops);
+      if (nextHops == it->second)
         {
-          NS_LOG_LOGIC ("setting routes for node " << node->GetId ());
+          NS_LOG_LOGIC ("Host route to " << Ipv4Address (it->first) << " covered by network routes");
+          removedHosts.insert (it->first);
+        }
+    }
 //
-// Routing information is updated using the Ipv4 interface.  We need to 
-// GetObject for that interface.  If the node is acting as an IP version 4 
-// router, it should absolutely have an Ipv4 interface.
+// Prefixes are either nested or disjoint.  A prefix that neither contains
+// nor is contained in another prefix is the only one matching its
+// destinations, hence it can be merged with a sibling prefix having the
+// same next hops.  The prefixes are sorted by network, then by increasing
+// length, so that a prefix follows the prefixes containing it.
 //
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
-                         "GetObject for <Ipv4> interface failed");
+  std::map<NextHops_t, std::vector<std::set<uint32_t> > > groups;
+  std::vector<std::map<Prefix_t, NextHops_t>::iterator> open;
+  std::set<Prefix_t> nested;
+  for (std::map<Prefix_t, NextHops_t>::iterator it = prefixes.begin (); it != prefixes.end (); it++)
+    {
+      while (!open.empty () && open.back ()->first.second != 0
+             && (open.back ()->first.first ^ it->first.first) >> (32 - open.back ()->first.second) != 0)
+        {
+          open.pop_back ();
+        }
+      if (!open.empty ())
+        {
+          nested.insert (it->first);
+          for (uint32_t i = 0; i < open.size (); i++)
+            {
+              nested.insert (open[i]->first);
+            }
+        }
+      open.push_back (it);
+    }
+  for (std::map<Prefix_t, NextHops_t>::iterator it = prefixes.begin (); it != prefixes.end (); it++)
+    {
+      if (nested.find (it->first) == nested.end ())
+        {
+          NormalizeNextHops (it->second);
+          std::vector<std::set<uint32_t> > &group = groups[it->second];
+          group.resize (33);
+          group[it->first.second].insert (it->first.first);
+        }
+    }
 //
-// Get the Global Router Link State Advertisement from the vertex we're
-// adding the routes to.  The LSA will have a number of attached Global Router
-// Link Records corresponding to links off of that vertex / node.  We're going
-// to be interested in the records corresponding to point-to-point links.
+// Merge the sibling prefixes with the same next hops, from the longest
+// prefixes to the shortest ones.  A merged prefix covers exactly the
+// destinations of the prefixes it replaces.
 //
-          GlobalRoutingLSA *lsa = v->GetLSA ();
-          NS_ASSERT_MSG (lsa, 
-                         "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask ();
-          Ipv4Address tempip = lsa->GetLinkStateId ();
-          tempip = tempip.CombineMask (tempmask);
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
+  std::vector<SPFRoute> merged;
+  std::set<Prefix_t> removedPrefixes;
+  for (std::map<NextHops_t, std::vector<std::set<uint32_t> > >::iterator it = groups.begin (); it != groups.end (); it++)
+    {
+      std::vector<std::set<uint32_t> > &group = it->second;
+      std::set<Prefix_t> parents;
+      for (uint32_t length = 32; length > 0; length--)
+        {
+          uint32_t bit = 1u << (32 - length);
+          std::set<uint32_t>::iterator i = group[length].begin ();
+          while (i != group[length].end ())
             {
-              continue;
+              std::set<uint32_t>::iterator sibling = group[length].find (*i ^ bit);
+              if ((*i & bit) == 0 && sibling != group[length].end ())
+                {
+                  group[length - 1].insert (*i);
+                  parents.insert (Prefix_t (*i, length - 1));
+                  parents.erase (Prefix_t (*i, length));
+                  parents.erase (Prefix_t (*sibling, length));
+                  group[length].erase (sibling);
+                  group[length].erase (i++);
+                }
+              else
+                {
+                  i++;
+                }
             }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all available exit directions due to ECMP,
-          // and add host route for each of the exit direction toward
-          // the vertex 'v'
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+        }
+      for (std::set<Prefix_t>::const_iterator i = parents.begin (); i != parents.end (); i++)
+        {
+          uint32_t mask = (i->second == 0 ? 0 : ~((1u << (32 - i->second)) - 1));
+          for (uint32_t j = 0; j < it->first.size (); j++)
             {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-
-              if (outIf >= 0)
+              SPFRoute route;
+              route.type = SPFRoute::NETWORK;
+              route.dest = Ipv4Address (i->first);
+              route.mask = Ipv4Mask (mask);
+              route.nextHop = it->first[j].first;
+              route.outIf = it->first[j].second;
+              merged.push_back (route);
+            }
+          uint32_t last = i->first | ~mask;
+          for (std::map<Prefix_t, NextHops_t>::const_iterator p = prefixes.lower_bound (Prefix_t (i->first, 0));
+               p != prefixes.end () && p->first.first <= last; p++)
+            {
+              if (hostPrefixes.find (p->first) != hostPrefixes.end ())
                 {
-                  gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
+                  removedHosts.insert (p->first.first);
                 }
               else
                 {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative " << outIf);
+                  removedPrefixes.insert (p->first);
                 }
             }
         }
-    } 
+    }
+  if (removedHosts.empty () && removedPrefixes.empty ())
+    {
+      return;
+    }
+  NS_LOG_LOGIC (removedHosts.size () << " host routes and " << removedPrefixes.size () <<
+                " network prefixes aggregated into " << merged.size () << " network routes");
+  std::vector<SPFRoute> aggregated;
+  for (std::vector<SPFRoute>::const_iterator i = routes.begin (); i != routes.end (); i++)
+    {
+      if (i->type == SPFRoute::HOST && removedHosts.find (i->dest.Get ()) != removedHosts.end ())
+        {
+          continue;
+        }
+      if (i->type == SPFRoute::NETWORK
+          && removedPrefixes.find (Prefix_t (i->dest.CombineMask (i->mask).Get (),
+                                             i->mask.GetPrefixLength ())) != removedPrefixes.end ())
+        {
+          continue;
+        }
+      aggregated.push_back (*i);
+    }
+  aggregated.insert (aggregated.end (), merged.begin (), merged.end ());
+  routes.swap (aggregated);
 }
 
 // Derived from quagga ospf_vertex_add_parents ()
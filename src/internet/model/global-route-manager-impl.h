@@ -27,9 +27,14 @@
 #include <queue>
 #include <map>
 #include <vector>
+#include <unordered_map>
 #include "ns3/object.h"
 #include "ns3/ptr.h"
 #include "ns3/ipv4-address.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-mutex.h"
+#endif
 #include "global-router-interface.h"
 
 namespace ns3 {
@@ -674,6 +679,25 @@ public:
    */
   uint32_t GetNumExtLSAs () const;
 
+  /// Const iterator over the IPv4 address / Link State Advertisement pairs
+  typedef std::map<Ipv4Address, GlobalRoutingLSA*>::const_iterator Iterator;
+
+  /**
+   * @brief Get an iterator to the first Link State Advertisement of the
+   * database (External Link State Advertisements excluded).
+   *
+   * @returns an iterator to the first IPv4 address / Link State Advertisement
+   * pair, sorted by address.
+   */
+  Iterator Begin () const;
+  /**
+   * @brief Get an iterator past the last Link State Advertisement of the
+   * database (External Link State Advertisements excluded).
+   *
+   * @returns an iterator past the last IPv4 address / Link State
+   * Advertisement pair.
+   */
+  Iterator End () const;
 
 private:
   typedef std::map<Ipv4Address, GlobalRoutingLSA*> LSDBMap_t; //!< container of IPv4 addresses / Link State Advertisements
@@ -681,6 +705,11 @@ private:
 
   LSDBMap_t m_database; //!< database of IPv4 addresses / Link State Advertisements
   std::vector<GlobalRoutingLSA*> m_extdatabase; //!< database of External Link State Advertisements
+  /**
+   * Index of the Link State Advertisements by the Link Data of their
+   * TransitNetwork link records, used by GetLSAByLinkData
+   */
+  LSDBMap_t m_linkDataIndex;
 
 /**
  * @brief GlobalRouteManagerLSDB copy construction is disallowed.  There's no 
@@ -732,9 +761,37 @@ public:
 /**
  * @brief Compute routes using a Dijkstra SPF computation and populate
  * per-node forwarding tables
+ *
+ * The SPF calculations of the different routers are distributed among the
+ * number of threads given by the GlobalRoutingThreads global value.  If the
+ * GlobalRoutingIncremental global value is true, the SPF trees are kept
+ * for use by a later call to UpdateRoutes.
  */
   virtual void InitializeRoutes ();
 
+/**
+ * @brief Rebuild the routing database and the per-node forwarding tables
+ * after a change of the topology
+ *
+ * If the GlobalRoutingIncremental global value is true and the SPF trees
+ * computed by the last route computation have been kept (see
+ * InitializeRoutes), the new routing database is compared with the
+ * previous one and the SPF calculation is run again only for the routers
+ * whose tree may be affected by the changed Link State Advertisements.  The
+ * routes of the other routers are generated from their previous tree.
+ * Otherwise, this is equivalent to calling DeleteGlobalRoutes,
+ * BuildGlobalRoutingDatabase and InitializeRoutes.
+ */
+  virtual void UpdateRoutes ();
+
+/**
+ * @brief Get the number of SPF calculations run by the last call to
+ * InitializeRoutes or UpdateRoutes
+ *
+ * @returns the number of SPF calculations
+ */
+  uint32_t GetNSPFCalculations (void) const;
+
 /**
  * @brief Debugging routine; allow client code to supply a pre-built LSDB
  */
@@ -747,6 +804,14 @@ public:
   void DebugSPFCalculate (Ipv4Address root);
 
 private:
+/**
+ * @brief Construct an instance computing routes in a thread on behalf of
+ * another instance, from the (shared and read-only) LSDB of that instance.
+ *
+ * @param owner the instance on whose behalf routes are computed
+ */
+  GlobalRouteManagerImpl (GlobalRouteManagerImpl* owner);
+
 /**
  * @brief GlobalRouteManagerImpl copy construction is disallowed.
  * There's no  need for it and a compiler provided shallow copy would be 
@@ -766,8 +831,189 @@ private:
  */
   GlobalRouteManagerImpl& operator= (GlobalRouteManagerImpl& srmi);
 
+  /**
+   * \brief A route computed for the root of a SPF calculation
+   */
+  struct SPFRoute
+  {
+    /// Type of route
+    enum Type
+    {
+      HOST,      //!< host route (Ipv4GlobalRouting::AddHostRouteTo)
+      NETWORK,   //!< network route (Ipv4GlobalRouting::AddNetworkRouteTo)
+      EXTERNAL   //!< external route (Ipv4GlobalRouting::AddASExternalRouteTo)
+    };
+    Type type;             //!< type of route
+    Ipv4Address dest;      //!< destination address (or network)
+    Ipv4Mask mask;         //!< network mask (network and external routes)
+    Ipv4Address nextHop;   //!< next hop address
+    uint32_t outIf;        //!< outgoing interface
+  };
+
+  /**
+   * \brief The shortest path first tree of a router
+   *
+   * The vertices are stored in the order they have been added to the tree
+   * (the root first), and are referred to by their position in this order.
+   * This is all what is needed to generate again the routes of the router
+   * from an updated LSDB, as long as the tree is not affected by the update.
+   */
+  struct SPFTree
+  {
+    /**
+     * \brief Find the position of a vertex
+     * \param id the vertex ID
+     * \returns the position of the vertex, or -1 if it is not in the tree
+     */
+    int32_t Find (Ipv4Address id) const;
+    /**
+     * \brief Test if a vertex is a parent of another vertex
+     * \param parent the position of the parent
+     * \param v the position of the vertex
+     * \returns true if parent is a parent of v
+     */
+    bool IsParent (uint32_t parent, uint32_t v) const;
+
+    bool stub;                                        //!< true if the root is a stub node (no tree)
+    std::vector<Ipv4Address> ids;                     //!< vertex IDs
+    std::vector<uint32_t> distances;                  //!< distances from the root
+    std::vector<uint32_t> exitStart;                  //!< first root exit direction of each vertex (and end marker)
+    std::vector<SPFVertex::NodeExit_t> exits;         //!< root exit directions
+    std::vector<uint32_t> parentStart;                //!< first parent of each vertex (and end marker)
+    std::vector<uint32_t> parents;                    //!< positions of the parents
+    std::vector<uint32_t> stubOrder;                  //!< positions in the order of the second stage
+    std::vector<std::pair<Ipv4Address, uint32_t> > index; //!< vertex IDs and positions, sorted by ID
+    std::vector<std::pair<Ipv4Address, int32_t> > interfaces; //!< addresses and interfaces of the root
+  };
+
+  /**
+   * \brief The routes of a router being computed
+   */
+  struct SPFRoot
+  {
+    Ipv4Address routerId;              //!< router ID of the root
+    Ptr<Ipv4GlobalRouting> routing;    //!< routing protocol to populate (used by the main thread only)
+    bool checkStub;                    //!< whether stub nodes are optimized (see CheckForStubNode)
+    bool replay;                       //!< true to generate the routes from the tree computed previously
+    bool aggregate;                    //!< true to aggregate the host routes (see AggregateRoutes)
+    SPFTree tree;                      //!< the SPF tree
+    std::vector<SPFRoute> routes;      //!< the routes computed
+  };
+
+  /**
+   * \brief The changes of the LSDB relevant to the SPF trees
+   */
+  struct SPFChanges
+  {
+    /// A link between two vertices
+    struct Edge
+    {
+      Ipv4Address from;   //!< ID of the vertex the link is from
+      Ipv4Address to;     //!< ID of the vertex the link is to
+      uint32_t metric;    //!< metric of the link
+    };
+    std::vector<Ipv4Address> routers;  //!< IDs of the routers whose LSA changed
+    std::vector<Edge> removed;         //!< links removed (or whose metric changed)
+    std::vector<Edge> added;           //!< links added (or whose metric changed)
+  };
+
   SPFVertex* m_spfroot; //!< the root node
   GlobalRouteManagerLSDB* m_lsdb; //!< the Link State DataBase (LSDB) of the Global Route Manager
+  GlobalRouteManagerImpl* m_owner; //!< the instance owning the LSDB (this, unless computing routes in a thread)
+  SPFRoot* m_root; //!< the root whose routes are being computed
+  /// status of the LSAs during the SPF calculation
+  std::unordered_map<const GlobalRoutingLSA*, GlobalRoutingLSA::SPFStatus> m_lsaStatus;
+  std::map<Ipv4Address, SPFTree*> m_trees; //!< SPF trees kept for UpdateRoutes
+  uint32_t m_nSPFCalculations; //!< number of SPF calculations
+
+  std::vector<SPFRoot*>* m_pendingRoots; //!< roots whose routes are being computed
+  uint32_t m_nextRoot; //!< index of the next pending root to be processed
+#ifdef HAVE_PTHREAD_H
+  SystemMutex m_pendingMutex; //!< mutex protecting m_nextRoot
+#endif
+
+  /**
+   * \brief Create the root of the routes of a node
+   *
+   * \param node the node
+   * \param routerId the router ID of the node
+   * \returns the root
+   */
+  SPFRoot* CreateRoot (Ptr<Node> node, Ipv4Address routerId);
+
+  /**
+   * \brief Get the roots of all the nodes participating in global routing
+   *
+   * \param roots the roots
+   */
+  void GetRoots (std::vector<SPFRoot*> &roots);
+
+  /**
+   * \brief Compute the routes of a set of roots and install them
+   *
+   * The roots are processed in batches, which are spread over the threads.
+   * The roots are deleted once their routes are installed.
+   *
+   * \param roots the roots
+   */
+  void ComputeRoutes (std::vector<SPFRoot*> &roots);
+
+  /**
+   * \brief Compute the routes of the pending roots of the owner instance
+   * until there is none left
+   *
+   * This is the body of the threads computing routes.
+   */
+  void ProcessPendingRoots (void);
+
+  /**
+   * \brief Compute the routes of a root
+   *
+   * \param root the root
+   */
+  void ProcessRoot (SPFRoot &root);
+
+  /**
+   * \brief Install the routes computed for a root
+   *
+   * \param root the root
+   */
+  void InstallRoutes (SPFRoot &root);
+
+  /**
+   * \brief Find the changes between the current LSDB and a previous one
+   *
+   * \param lsdb the previous LSDB
+   * \param changes the changes between the LSDBs
+   * \returns false if the changes are such that the SPF trees of all the
+   *          routers have to be computed again
+   */
+  bool FindChanges (GlobalRouteManagerLSDB* lsdb, SPFChanges &changes);
+
+  /**
+   * \brief Test if an SPF tree may be affected by changes of the LSDB
+   *
+   * \param tree the tree
+   * \param changes the changes
+   * \returns true if the tree may be affected by the changes
+   */
+  bool IsTreeAffected (const SPFTree &tree, const SPFChanges &changes) const;
+
+  /**
+   * \brief Get the status of a LSA in the current SPF calculation
+   *
+   * \param lsa the LSA
+   * \returns the status of the LSA
+   */
+  GlobalRoutingLSA::SPFStatus GetLSAStatus (const GlobalRoutingLSA* lsa) const;
+
+  /**
+   * \brief Set the status of a LSA in the current SPF calculation
+   *
+   * \param lsa the LSA
+   * \param status the status of the LSA
+   */
+  void SetLSAStatus (const GlobalRoutingLSA* lsa, GlobalRoutingLSA::SPFStatus status);
 
   /**
    * \brief Test if a node is a stub, from an OSPF sense.
@@ -782,31 +1028,45 @@ private:
   bool CheckForStubNode (Ipv4Address root);
 
   /**
-   * \brief Calculate the shortest path first (SPF) tree
+   * \brief Calculate the shortest path first (SPF) tree and the routes of
+   * the current root
    *
    * Equivalent to quagga ospf_spf_calculate
    * \param root the root node
    */
   void SPFCalculate (Ipv4Address root);
 
+  /**
+   * \brief Add a vertex which has just been added to the SPF tree to the
+   * tree of the current root
+   *
+   * \param v the vertex
+   * \param parentIds the IDs of the parents of the vertices of the tree,
+   *        to be resolved to positions once the tree is complete
+   */
+  void SPFRecordVertex (SPFVertex* v, std::vector<Ipv4Address> &parentIds);
+
   /**
    * \brief Process Stub nodes
    *
    * Processing logic from RFC 2328, page 166 and quagga ospf_spf_process_stubs ()
    * stub link records will exist for point-to-point interfaces and for
-   * broadcast interfaces for which no neighboring router can be found
+   * broadcast interfaces for which no neighboring router can be found.
+   * The vertices are recorded in the order they are processed, which is also
+   * the order the AS External LSAs are processed in.
    *
    * \param v vertex to be processed
    */
   void SPFProcessStubs (SPFVertex* v);
 
   /**
-   * \brief Process Autonomous Systems (AS) External LSA
+   * \brief Generate the routes of the current root from its SPF tree
    *
-   * \param v vertex to be processed
-   * \param extlsa external LSA
+   * The routes to the transit vertices are generated in the order the
+   * vertices have been added to the tree, then the routes to the stub
+   * networks, then the routes to the AS external destinations.
    */
-  void ProcessASExternals (SPFVertex* v, GlobalRoutingLSA* extlsa);
+  void SPFGenerateRoutes (void);
 
   /**
    * \brief Examine the links in v's LSA and update the list of candidates with any
@@ -894,51 +1154,79 @@ private:
    * This is where we are actually going to add the host routes to the routing
    * tables of the individual nodes.
    *
-   * The vertex passed as a parameter has just been added to the SPF tree.
-   * This vertex must have a valid m_root_oid, corresponding to the outgoing
-   * interface on the root router of the tree that is the first hop on the path
-   * to the vertex.  The vertex must also have a next hop address, corresponding
-   * to the next hop on the path to the vertex.  The vertex has an m_lsa field
-   * that has some number of link records.  For each point to point link record,
-   * the m_linkData is the local IP address of the link.  This corresponds to
-   * a destination IP address, reachable from the root, to which we add a host
-   * route.
+   * The vertex passed as a parameter is in the SPF tree of the current root.
+   * The vertex has root exit directions, corresponding to the outgoing
+   * interfaces on the root router of the tree that are the first hop on the
+   * paths to the vertex, and to the next hops on those paths.  The LSA of
+   * the vertex has some number of link records.  For each point to point
+   * link record, the m_linkData is the local IP address of the link.  This
+   * corresponds to a destination IP address, reachable from the root, to
+   * which we add a host route.
    *
-   * \param v the vertex
+   * \param lsa the LSA of the vertex
+   * \param v the position of the vertex in the tree
    *
    */
-  void SPFIntraAddRouter (SPFVertex* v);
+  void SPFIntraAddRouter (GlobalRoutingLSA* lsa, uint32_t v);
 
   /**
    * \brief Add a transit to the routing tables
    *
-   * \param v the vertex
+   * \param lsa the LSA of the vertex
+   * \param v the position of the vertex in the tree
    */
-  void SPFIntraAddTransit (SPFVertex* v);
+  void SPFIntraAddTransit (GlobalRoutingLSA* lsa, uint32_t v);
 
   /**
    * \brief Add a stub to the routing tables
    *
    * \param l the global routing link record
-   * \param v the vertex
+   * \param v the position of the vertex in the tree
    */
-  void SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex* v);
+  void SPFIntraAddStub (GlobalRoutingLinkRecord *l, uint32_t v);
 
   /**
    * \brief Add an external route to the routing tables
    *
    * \param extlsa the external LSA
-   * \param v the vertex
+   * \param v the position of the vertex in the tree
+   */
+  void SPFAddASExternal (GlobalRoutingLSA *extlsa, uint32_t v);
+
+  /**
+   * \brief Add the routes to a destination through all the root exit
+   * directions of a vertex
+   *
+   * \param type the type of route
+   * \param dest the destination
+   * \param mask the destination mask
+   * \param v the position of the vertex in the tree
+   */
+  void SPFAddRoutes (SPFRoute::Type type, Ipv4Address dest, Ipv4Mask mask, uint32_t v);
+
+  /**
+   * \brief Aggregate the host routes of a router
+   *
+   * The routes are modified only where the forwarding decisions are not
+   * affected (see Ipv4GlobalRouting::LookupGlobal):
+   *  - the host routes to a destination are removed if the network routes
+   *    matching the destination have the same next hops (in the same order,
+   *    or a single next hop in both cases);
+   *  - the host routes to destinations not matching any network route are
+   *    merged into network routes whenever two sibling prefixes have the
+   *    same next hops, recursively.
+   *
+   * \param routes the routes of the router
    */
-  void SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v);
+  static void AggregateRoutes (std::vector<SPFRoute> &routes);
 
   /**
    * \brief Return the interface number corresponding to a given IP address and mask
    *
-   * This is a wrapper around GetInterfaceForPrefix(), but we first
-   * have to find the right node pointer to pass to that function.
-   * If no such interface is found, return -1 (note:  unit test framework
-   * for routing assumes -1 to be a legal return value)
+   * This mirrors GetInterfaceForPrefix() on the node at the root of the
+   * current calculation, whose interface addresses have been gathered
+   * beforehand.  If no such interface is found, return -1 (note:  unit test
+   * framework for routing assumes -1 to be a legal return value)
    *
    * \param a the target IP address
    * \param amask the target subnet mask
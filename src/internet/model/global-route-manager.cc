@@ -58,6 +58,14 @@ GlobalRouteManager::InitializeRoutes (void)
   InitializeRoutes ();
 }
 
+void
+GlobalRouteManager::UpdateGlobalRoutes (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  SimulationSingleton<GlobalRouteManagerImpl>::Get ()->
+  UpdateRoutes ();
+}
+
 uint32_t
 GlobalRouteManager::AllocateRouterId (void)
 {
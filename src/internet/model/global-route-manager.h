@@ -65,6 +65,17 @@ public:
  */
   static void InitializeRoutes ();
 
+/**
+ * @brief Rebuild the routing database and update the per-node forwarding
+ * tables after a change of the topology
+ *
+ * If the GlobalRoutingIncremental global value is true, the SPF calculation
+ * is only run again for the routers whose shortest path tree may be
+ * affected by the change.  Otherwise, this is equivalent to calling
+ * DeleteGlobalRoutes, BuildGlobalRoutingDatabase and InitializeRoutes.
+ */
+  static void UpdateGlobalRoutes ();
+
 private:
 /**
  * @brief Global Route Manager copy construction is disallowed.  There's no 
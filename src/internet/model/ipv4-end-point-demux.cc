@@ -22,6 +22,8 @@
 #include "ipv4-end-point.h"
 #include "ipv4-interface-address.h"
 #include "ns3/log.h"
+#include <algorithm>
+#include <vector>
 
 
 namespace ns3 {
@@ -49,24 +51,21 @@ bool
 Ipv4EndPointDemux::LookupPortLocal (uint16_t port)
 {
   NS_LOG_FUNCTION (this << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
-    {
-      if ((*i)->GetLocalPort  () == port) 
-        {
-          return true;
-        }
-    }
-  return false;
+  return m_localPorts.find (port) != m_localPorts.end ();
 }
 
 bool
 Ipv4EndPointDemux::LookupLocal (Ptr<NetDevice> boundNetDevice, Ipv4Address addr, uint16_t port)
 {
   NS_LOG_FUNCTION (this << addr << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  PortEndPointsI it = m_localPorts.find (port);
+  if (it == m_localPorts.end ())
     {
-      if ((*i)->GetLocalPort () == port &&
-          (*i)->GetLocalAddress () == addr &&
+      return false;
+    }
+  for (EndPointsI i = it->second.begin (); i != it->second.end (); i++) 
+    {
+      if ((*i)->GetLocalAddress () == addr &&
           (*i)->GetBoundNetDevice () == boundNetDevice)
         {
           return true;
@@ -86,7 +85,7 @@ Ipv4EndPointDemux::Allocate (void)
       return 0;
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (Ipv4Address::GetAny (), port);
-  m_endPoints.push_back (endPoint);
+  Insert (endPoint);
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -102,7 +101,7 @@ Ipv4EndPointDemux::Allocate (Ipv4Address address)
       return 0;
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
+  Insert (endPoint);
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -125,7 +124,7 @@ Ipv4EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice, Ipv4Address address,
       return 0;
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
+  Insert (endPoint);
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -136,21 +135,45 @@ Ipv4EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
                              Ipv4Address peerAddress, uint16_t peerPort)
 {
   NS_LOG_FUNCTION (this << localAddress << localPort << peerAddress << peerPort << boundNetDevice);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  if (peerAddress != Ipv4Address::GetAny () && peerPort != 0)
     {
-      if ((*i)->GetLocalPort () == localPort &&
-          (*i)->GetLocalAddress () == localAddress &&
-          (*i)->GetPeerPort () == peerPort &&
-          (*i)->GetPeerAddress () == peerAddress &&
-          ((*i)->GetBoundNetDevice () == boundNetDevice || (*i)->GetBoundNetDevice () == 0))
+      // the end points with the same four-tuple are in the four-tuple index
+      FourTuple tuple;
+      tuple.localAddress = localAddress;
+      tuple.localPort = localPort;
+      tuple.peerAddress = peerAddress;
+      tuple.peerPort = peerPort;
+      std::pair<ConnectedEndPointsI, ConnectedEndPointsI> range = m_connected.equal_range (tuple);
+      for (ConnectedEndPointsI i = range.first; i != range.second; i++)
         {
-          NS_LOG_WARN ("Duplicated endpoint.");
-          return 0;
+          if (i->second->GetBoundNetDevice () == boundNetDevice || i->second->GetBoundNetDevice () == 0)
+            {
+              NS_LOG_WARN ("Duplicated endpoint.");
+              return 0;
+            }
+        }
+    }
+  else
+    {
+      PortEndPointsI it = m_localPorts.find (localPort);
+      if (it != m_localPorts.end ())
+        {
+          for (EndPointsI i = it->second.begin (); i != it->second.end (); i++) 
+            {
+              if ((*i)->GetLocalAddress () == localAddress &&
+                  (*i)->GetPeerPort () == peerPort &&
+                  (*i)->GetPeerAddress () == peerAddress &&
+                  ((*i)->GetBoundNetDevice () == boundNetDevice || (*i)->GetBoundNetDevice () == 0))
+                {
+                  NS_LOG_WARN ("Duplicated endpoint.");
+                  return 0;
+                }
+            }
         }
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (localAddress, localPort);
   endPoint->SetPeer (peerAddress, peerPort);
-  m_endPoints.push_back (endPoint);
+  Insert (endPoint);
 
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
 
@@ -161,15 +184,105 @@ void
 Ipv4EndPointDemux::DeAllocate (Ipv4EndPoint *endPoint)
 {
   NS_LOG_FUNCTION (this << endPoint);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  if (endPoint->m_demux != this)
+    {
+      return;
+    }
+  Unindex (endPoint);
+  PortEndPointsI it = m_localPorts.find (endPoint->GetLocalPort ());
+  it->second.erase (endPoint->m_portPosition);
+  if (it->second.empty ())
+    {
+      m_localPorts.erase (it);
+    }
+  m_endPoints.erase (endPoint->m_demuxPosition);
+  delete endPoint;
+}
+
+void
+Ipv4EndPointDemux::Insert (Ipv4EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  endPoint->m_demuxPosition = m_endPoints.insert (m_endPoints.end (), endPoint);
+  EndPoints &endPoints = m_localPorts[endPoint->GetLocalPort ()];
+  endPoint->m_portPosition = endPoints.insert (endPoints.end (), endPoint);
+  endPoint->m_demux = this;
+  Index (endPoint);
+}
+
+void
+Ipv4EndPointDemux::Index (Ipv4EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  FourTuple tuple;
+  if (GetFourTuple (endPoint, tuple))
+    {
+      m_connected.insert (std::make_pair (tuple, endPoint));
+    }
+  else
+    {
+      m_wildcards.insert (std::make_pair (tuple.localPort, endPoint));
+    }
+}
+
+void
+Ipv4EndPointDemux::Unindex (Ipv4EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  FourTuple tuple;
+  if (GetFourTuple (endPoint, tuple))
     {
-      if (*i == endPoint)
+      std::pair<ConnectedEndPointsI, ConnectedEndPointsI> range = m_connected.equal_range (tuple);
+      for (ConnectedEndPointsI i = range.first; i != range.second; i++)
         {
-          delete endPoint;
-          m_endPoints.erase (i);
-          break;
+          if (i->second == endPoint)
+            {
+              m_connected.erase (i);
+              return;
+            }
         }
     }
+  else
+    {
+      std::pair<WildcardEndPointsI, WildcardEndPointsI> range = m_wildcards.equal_range (tuple.localPort);
+      for (WildcardEndPointsI i = range.first; i != range.second; i++)
+        {
+          if (i->second == endPoint)
+            {
+              m_wildcards.erase (i);
+              return;
+            }
+        }
+    }
+}
+
+bool
+Ipv4EndPointDemux::GetFourTuple (Ipv4EndPoint *endPoint, FourTuple &tuple)
+{
+  tuple.localAddress = endPoint->GetLocalAddress ();
+  tuple.localPort = endPoint->GetLocalPort ();
+  tuple.peerAddress = endPoint->GetPeerAddress ();
+  tuple.peerPort = endPoint->GetPeerPort ();
+  return tuple.peerAddress != Ipv4Address::GetAny () && tuple.peerPort != 0;
+}
+
+bool
+Ipv4EndPointDemux::FourTuple::operator== (const FourTuple &other) const
+{
+  return localPort == other.localPort && peerPort == other.peerPort
+         && localAddress == other.localAddress && peerAddress == other.peerAddress;
+}
+
+size_t
+Ipv4EndPointDemux::FourTupleHash::operator() (const FourTuple &tuple) const
+{
+  uint64_t h = (static_cast<uint64_t> (tuple.localAddress.Get ()) << 32) | tuple.peerAddress.Get ();
+  h ^= ((static_cast<uint64_t> (tuple.localPort) << 16) | tuple.peerPort) * 0x9e3779b97f4a7c15ULL;
+  // final mix of MurmurHash3, so that all the bits affect the bucket
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  return static_cast<size_t> (h);
 }
 
 /*
@@ -208,7 +321,52 @@ Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport,
   EndPoints retval4; // Exact match on all 4
 
   NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr << ":" << dport);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+
+  // The candidates are the end points connected to the source whose local
+  // address may match the destination address (the destination address
+  // itself, the wildcard address and the subnet-directed addresses of the
+  // incoming interface), and the wildcard end points bound to the
+  // destination port.
+  std::vector<Ipv4EndPoint *> candidates;
+  std::vector<Ipv4Address> localAddresses;
+  localAddresses.push_back (daddr);
+  if (daddr != Ipv4Address::GetAny ())
+    {
+      localAddresses.push_back (Ipv4Address::GetAny ());
+    }
+  if (incomingInterface != 0)
+    {
+      for (uint32_t i = 0; i < incomingInterface->GetNAddresses (); i++)
+        {
+          Ipv4InterfaceAddress addr = incomingInterface->GetAddress (i);
+          Ipv4Address addrNetpart = addr.GetLocal ().CombineMask (addr.GetMask ());
+          if (addrNetpart == daddr.CombineMask (addr.GetMask ())
+              && std::find (localAddresses.begin (), localAddresses.end (), addrNetpart) == localAddresses.end ())
+            {
+              localAddresses.push_back (addrNetpart);
+            }
+        }
+    }
+  FourTuple tuple;
+  tuple.localPort = dport;
+  tuple.peerAddress = saddr;
+  tuple.peerPort = sport;
+  for (std::vector<Ipv4Address>::const_iterator it = localAddresses.begin (); it != localAddresses.end (); it++)
+    {
+      tuple.localAddress = *it;
+      std::pair<ConnectedEndPointsI, ConnectedEndPointsI> range = m_connected.equal_range (tuple);
+      for (ConnectedEndPointsI i = range.first; i != range.second; i++)
+        {
+          candidates.push_back (i->second);
+        }
+    }
+  std::pair<WildcardEndPointsI, WildcardEndPointsI> range = m_wildcards.equal_range (dport);
+  for (WildcardEndPointsI i = range.first; i != range.second; i++)
+    {
+      candidates.push_back (i->second);
+    }
+
+  for (std::vector<Ipv4EndPoint *>::const_iterator i = candidates.begin (); i != candidates.end (); i++) 
     {
       Ipv4EndPoint* endP = *i;
 
@@ -347,12 +505,13 @@ Ipv4EndPointDemux::SimpleLookup (Ipv4Address daddr,
   // function.
   uint32_t genericity = 3;
   Ipv4EndPoint *generic = 0;
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  PortEndPointsI it = m_localPorts.find (dport);
+  if (it == m_localPorts.end ())
+    {
+      return 0;
+    }
+  for (EndPointsI i = it->second.begin (); i != it->second.end (); i++) 
     {
-      if ((*i)->GetLocalPort () != dport) 
-        {
-          continue;
-        }
       if ((*i)->GetLocalAddress () == daddr &&
           (*i)->GetPeerPort () == sport &&
           (*i)->GetPeerAddress () == saddr) 
@@ -22,6 +22,7 @@
 #define IPV4_END_POINT_H
 
 #include <stdint.h>
+#include <list>
 #include "ns3/ipv4-address.h"
 #include "ns3/callback.h"
 #include "ns3/net-device.h"
@@ -32,6 +33,7 @@ namespace ns3 {
 
 class Header;
 class Packet;
+class Ipv4EndPointDemux;
 
 /**
  * \ingroup ipv4
@@ -227,6 +229,24 @@ private:
    * \brief true if the endpoint can receive packets.
    */
   bool m_rxEnabled;
+  friend class Ipv4EndPointDemux;
+
+  /**
+   * \brief The demux where the endpoint is allocated (if any), which is
+   * notified when the local address or the peer change.
+   */
+  Ipv4EndPointDemux *m_demux;
+
+  /**
+   * \brief The position of the endpoint in the list of endpoints of the demux.
+   */
+  std::list<Ipv4EndPoint *>::iterator m_demuxPosition;
+
+  /**
+   * \brief The position of the endpoint in the list of endpoints of the demux
+   * with the same local port.
+   */
+  std::list<Ipv4EndPoint *>::iterator m_portPosition;
 };
 
 } // namespace ns3
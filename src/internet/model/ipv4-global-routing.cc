@@ -28,6 +28,7 @@
 #include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/boolean.h"
 #include "ns3/node.h"
+#include "ns3/ipv4-header.h"
 #include "ipv4-global-routing.h"
 #include "global-route-manager.h"
 
@@ -53,13 +54,57 @@ Ipv4GlobalRouting::GetTypeId (void)
                    BooleanValue (false),
                    MakeBooleanAccessor (&Ipv4GlobalRouting::m_respondToInterfaceEvents),
                    MakeBooleanChecker ())
+    .AddAttribute ("FlowEcmpRouting",
+                   "Set to true if packets are routed among ECMP based on a hash of their flow "
+                   "(addresses, protocol and ports), so that the packets of a flow follow the same "
+                   "path; takes precedence over RandomEcmpRouting",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&Ipv4GlobalRouting::m_flowEcmpRouting),
+                   MakeBooleanChecker ())
+    .AddAttribute ("AggregateRoutes",
+                   "Set to true if the global route manager should aggregate the host routes of "
+                   "this node into network routes when this does not change the forwarding decisions",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&Ipv4GlobalRouting::m_aggregateRoutes),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
 
+/**
+ * \brief Add a route to an index of the routes by destination prefix
+ * \param trie the index
+ * \param route the route
+ */
+static void
+IndexRoute (PrefixTrie<Ipv4RoutingTableEntry *, 4> &trie, Ipv4RoutingTableEntry *route)
+{
+  uint8_t prefix[4];
+  route->GetDestNetwork ().Serialize (prefix);
+  trie.Insert (prefix, route->GetDestNetworkMask ().GetPrefixLength (), route);
+}
+
+/**
+ * \brief Remove a route from an index of the routes by destination prefix
+ * \param trie the index
+ * \param route the route
+ */
+static void
+UnindexRoute (PrefixTrie<Ipv4RoutingTableEntry *, 4> &trie, Ipv4RoutingTableEntry *route)
+{
+  uint8_t prefix[4];
+  route->GetDestNetwork ().Serialize (prefix);
+  bool removed = trie.Remove (prefix, route->GetDestNetworkMask ().GetPrefixLength (), route);
+  NS_ASSERT (removed);
+  (void) removed;
+}
+
 Ipv4GlobalRouting::Ipv4GlobalRouting () 
   : m_randomEcmpRouting (false),
-    m_respondToInterfaceEvents (false)
+    m_respondToInterfaceEvents (false),
+    m_flowEcmpRouting (false),
+    m_aggregateRoutes (false),
+    m_nodeId (0)
 {
   NS_LOG_FUNCTION (this);
 
@@ -80,6 +125,7 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, nextHop, interface);
   m_hostRoutes.push_back (route);
+  IndexRoute (m_hostRouteTrie, route);
 }
 
 void 
@@ -90,6 +136,7 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, interface);
   m_hostRoutes.push_back (route);
+  IndexRoute (m_hostRouteTrie, route);
 }
 
 void 
@@ -105,6 +152,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_networkRoutes.push_back (route);
+  IndexRoute (m_networkRouteTrie, route);
 }
 
 void 
@@ -118,6 +166,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         networkMask,
                                                         interface);
   m_networkRoutes.push_back (route);
+  IndexRoute (m_networkRouteTrie, route);
 }
 
 void 
@@ -133,94 +182,136 @@ Ipv4GlobalRouting::AddASExternalRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_ASexternalRoutes.push_back (route);
+  IndexRoute (m_ASexternalRouteTrie, route);
 }
 
 
+uint32_t
+Ipv4GlobalRouting::GetFlowHash (const Ipv4Header &header, Ptr<const Packet> p, bool ports)
+{
+  NS_LOG_FUNCTION (this << &header << p << ports);
+  uint8_t buffer[17];
+  header.GetSource ().Serialize (buffer);
+  header.GetDestination ().Serialize (buffer + 4);
+  buffer[8] = header.GetProtocol ();
+  buffer[9] = (m_nodeId >> 24) & 0xff;
+  buffer[10] = (m_nodeId >> 16) & 0xff;
+  buffer[11] = (m_nodeId >> 8) & 0xff;
+  buffer[12] = m_nodeId & 0xff;
+  uint32_t size = 13;
+  // the source and destination ports are the first 4 bytes of the TCP (6)
+  // and UDP (17) headers, which are only present in the first fragment
+  if (ports && p != 0 && p->GetSize () >= 4
+      && (header.GetProtocol () == 6 || header.GetProtocol () == 17)
+      && header.GetFragmentOffset () == 0)
+    {
+      p->CopyData (buffer + size, 4);
+      size += 4;
+    }
+  m_flowHasher.clear ();
+  return m_flowHasher.GetHash32 (reinterpret_cast<const char *> (buffer), size);
+}
+
+void
+Ipv4GlobalRouting::CacheNodeId (void)
+{
+  NS_LOG_FUNCTION (this);
+  Ptr<Node> node = m_ipv4->GetObject<Node> ();
+  if (node != 0)
+    {
+      m_nodeId = node->GetId ();
+    }
+}
+
 Ptr<Ipv4Route>
-Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
+Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif,
+                                 const Ipv4Header *header, Ptr<const Packet> p, bool ports)
 {
-  NS_LOG_FUNCTION (this << dest << oif);
+  NS_LOG_FUNCTION (this << dest << oif << header << p << ports);
   NS_LOG_LOGIC ("Looking for route for destination " << dest);
   Ptr<Ipv4Route> rtentry = 0;
   // store all available routes that bring packets to their destination
   typedef std::vector<Ipv4RoutingTableEntry*> RouteVec_t;
   RouteVec_t allRoutes;
 
+  // the routes are looked up in the indexes, which return them in the
+  // order of the route lists
+  uint8_t key[4];
+  dest.Serialize (key);
+  std::vector<Ipv4RoutingTableEntry *> matches;
+
   NS_LOG_LOGIC ("Number of m_hostRoutes = " << m_hostRoutes.size ());
-  for (HostRoutesCI i = m_hostRoutes.begin (); 
-       i != m_hostRoutes.end (); 
-       i++) 
+  const RouteTrie::Entries *hostRoutes = m_hostRouteTrie.Find (key, 32);
+  if (hostRoutes != 0)
     {
-      NS_ASSERT ((*i)->IsHost ());
-      if ((*i)->GetDest ().IsEqual (dest)) 
+      for (RouteTrie::Entries::const_iterator i = hostRoutes->begin ();
+           i != hostRoutes->end ();
+           i++)
         {
+          NS_ASSERT (i->value->IsHost ());
           if (oif != 0)
             {
-              if (oif != m_ipv4->GetNetDevice ((*i)->GetInterface ()))
+              if (oif != m_ipv4->GetNetDevice (i->value->GetInterface ()))
                 {
                   NS_LOG_LOGIC ("Not on requested interface, skipping");
                   continue;
                 }
             }
-          allRoutes.push_back (*i);
-          NS_LOG_LOGIC (allRoutes.size () << "Found global host route" << *i); 
+          allRoutes.push_back (i->value);
+          NS_LOG_LOGIC (allRoutes.size () << "Found global host route" << i->value);
         }
     }
   if (allRoutes.size () == 0) // if no host route is found
     {
       NS_LOG_LOGIC ("Number of m_networkRoutes" << m_networkRoutes.size ());
-      for (NetworkRoutesI j = m_networkRoutes.begin (); 
-           j != m_networkRoutes.end (); 
-           j++) 
+      m_networkRouteTrie.FindAll (key, matches);
+      for (RouteVec_t::const_iterator j = matches.begin ();
+           j != matches.end ();
+           j++)
         {
-          Ipv4Mask mask = (*j)->GetDestNetworkMask ();
-          Ipv4Address entry = (*j)->GetDestNetwork ();
-          if (mask.IsMatch (dest, entry)) 
+          if (oif != 0)
             {
-              if (oif != 0)
+              if (oif != m_ipv4->GetNetDevice ((*j)->GetInterface ()))
                 {
-                  if (oif != m_ipv4->GetNetDevice ((*j)->GetInterface ()))
-                    {
-                      NS_LOG_LOGIC ("Not on requested interface, skipping");
-                      continue;
-                    }
+                  NS_LOG_LOGIC ("Not on requested interface, skipping");
+                  continue;
                 }
-              allRoutes.push_back (*j);
-              NS_LOG_LOGIC (allRoutes.size () << "Found global network route" << *j);
             }
+          allRoutes.push_back (*j);
+          NS_LOG_LOGIC (allRoutes.size () << "Found global network route" << *j);
         }
     }
   if (allRoutes.size () == 0)  // consider external if no host/network found
     {
-      for (ASExternalRoutesI k = m_ASexternalRoutes.begin ();
-           k != m_ASexternalRoutes.end ();
+      m_ASexternalRouteTrie.FindAll (key, matches);
+      for (RouteVec_t::const_iterator k = matches.begin ();
+           k != matches.end ();
            k++)
         {
-          Ipv4Mask mask = (*k)->GetDestNetworkMask ();
-          Ipv4Address entry = (*k)->GetDestNetwork ();
-          if (mask.IsMatch (dest, entry))
+          NS_LOG_LOGIC ("Found external route" << *k);
+          if (oif != 0)
             {
-              NS_LOG_LOGIC ("Found external route" << *k);
-              if (oif != 0)
+              if (oif != m_ipv4->GetNetDevice ((*k)->GetInterface ()))
                 {
-                  if (oif != m_ipv4->GetNetDevice ((*k)->GetInterface ()))
-                    {
-                      NS_LOG_LOGIC ("Not on requested interface, skipping");
-                      continue;
-                    }
+                  NS_LOG_LOGIC ("Not on requested interface, skipping");
+                  continue;
                 }
-              allRoutes.push_back (*k);
-              break;
             }
+          allRoutes.push_back (*k);
+          break;
         }
     }
   if (allRoutes.size () > 0 ) // if route(s) is found
     {
-      // pick up one of the routes uniformly at random if random
-      // ECMP routing is enabled, or always select the first route
-      // consistently if random ECMP routing is disabled
+      // pick up one of the routes based on the hash of the flow if flow
+      // ECMP routing is enabled, uniformly at random if random ECMP routing
+      // is enabled, or always select the first route consistently otherwise
       uint32_t selectIndex;
-      if (m_randomEcmpRouting)
+      if (m_flowEcmpRouting && header != 0)
+        {
+          selectIndex = (allRoutes.size () > 1 ? GetFlowHash (*header, p, ports) % allRoutes.size () : 0);
+        }
+      else if (m_randomEcmpRouting)
         {
           selectIndex = m_rand->GetInteger (0, allRoutes.size ()-1);
         }
@@ -319,6 +410,7 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
           if (tmp  == index)
             {
               NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_hostRoutes.size ());
+              UnindexRoute (m_hostRouteTrie, *i);
               delete *i;
               m_hostRoutes.erase (i);
               NS_LOG_LOGIC ("Done removing host route " << index << "; host route remaining size = " << m_hostRoutes.size ());
@@ -336,6 +428,7 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
       if (tmp == index)
         {
           NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_networkRoutes.size ());
+          UnindexRoute (m_networkRouteTrie, *j);
           delete *j;
           m_networkRoutes.erase (j);
           NS_LOG_LOGIC ("Done removing network route " << index << "; network route remaining size = " << m_networkRoutes.size ());
@@ -352,6 +445,7 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
       if (tmp == index)
         {
           NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_ASexternalRoutes.size ());
+          UnindexRoute (m_ASexternalRouteTrie, *k);
           delete *k;
           m_ASexternalRoutes.erase (k);
           NS_LOG_LOGIC ("Done removing network route " << index << "; network route remaining size = " << m_networkRoutes.size ());
@@ -392,6 +486,9 @@ Ipv4GlobalRouting::DoDispose (void)
     {
       delete (*l);
     }
+  m_hostRouteTrie.Clear ();
+  m_networkRouteTrie.Clear ();
+  m_ASexternalRouteTrie.Clear ();
 
   Ipv4RoutingProtocol::DoDispose ();
 }
@@ -468,7 +565,10 @@ Ipv4GlobalRouting::RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<Net
 // See if this is a unicast packet we have a route for.
 //
   NS_LOG_LOGIC ("Unicast destination- looking up");
-  Ptr<Ipv4Route> rtentry = LookupGlobal (header.GetDestination (), oif);
+  // UDP sockets look up their route before adding the UDP header, hence
+  // only the ports of TCP packets are known here
+  Ptr<Ipv4Route> rtentry = LookupGlobal (header.GetDestination (), oif, &header, p,
+                                         header.GetProtocol () == 6);
   if (rtentry)
     {
       sockerr = Socket::ERROR_NOTERROR;
@@ -517,7 +617,7 @@ Ipv4GlobalRouting::RouteInput  (Ptr<const Packet> p, const Ipv4Header &header, P
     }
   // Next, try to find a route
   NS_LOG_LOGIC ("Unicast destination- looking up global route");
-  Ptr<Ipv4Route> rtentry = LookupGlobal (header.GetDestination ());
+  Ptr<Ipv4Route> rtentry = LookupGlobal (header.GetDestination (), 0, &header, p, true);
   if (rtentry != 0)
     {
       NS_LOG_LOGIC ("Found unicast destination- calling unicast callback");
@@ -535,11 +635,11 @@ void
 Ipv4GlobalRouting::NotifyInterfaceUp (uint32_t i)
 {
   NS_LOG_FUNCTION (this << i);
+  // the IPv4 instance may have been aggregated to the node after SetIpv4
+  CacheNodeId ();
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::UpdateGlobalRoutes ();
     }
 }
 
@@ -549,9 +649,7 @@ Ipv4GlobalRouting::NotifyInterfaceDown (uint32_t i)
   NS_LOG_FUNCTION (this << i);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::UpdateGlobalRoutes ();
     }
 }
 
@@ -561,9 +659,7 @@ Ipv4GlobalRouting::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress ad
   NS_LOG_FUNCTION (this << interface << address);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::UpdateGlobalRoutes ();
     }
 }
 
@@ -573,9 +669,7 @@ Ipv4GlobalRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress
   NS_LOG_FUNCTION (this << interface << address);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::UpdateGlobalRoutes ();
     }
 }
 
@@ -585,6 +679,7 @@ Ipv4GlobalRouting::SetIpv4 (Ptr<Ipv4> ipv4)
   NS_LOG_FUNCTION (this << ipv4);
   NS_ASSERT (m_ipv4 == 0 && ipv4 != 0);
   m_ipv4 = ipv4;
+  CacheNodeId ();
 }
 
 
@@ -28,6 +28,8 @@
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/random-variable-stream.h"
+#include "ns3/prefix-trie.h"
+#include "ns3/hash.h"
 
 namespace ns3 {
 
@@ -238,6 +240,14 @@ private:
   bool m_respondToInterfaceEvents;
   /// A uniform random number generator for randomly routing packets among ECMP 
   Ptr<UniformRandomVariable> m_rand;
+  /// Set to true if packets are routed among ECMP based on a hash of their flow
+  bool m_flowEcmpRouting;
+  /// Set to true if the global route manager should aggregate the host routes of this node
+  bool m_aggregateRoutes;
+  /// Hash function used to route packets among ECMP by flow
+  Hasher m_flowHasher;
+  /// ID of the node, added to the flow hash so that the nodes do not all make the same choice
+  uint32_t m_nodeId;
 
   /// container of Ipv4RoutingTableEntry (routes to hosts)
   typedef std::list<Ipv4RoutingTableEntry *> HostRoutes;
@@ -260,18 +270,50 @@ private:
   /// iterator of container of Ipv4RoutingTableEntry (routes to external AS)
   typedef std::list<Ipv4RoutingTableEntry *>::iterator ASExternalRoutesI;
 
+  /// index of the routes by destination prefix
+  typedef PrefixTrie<Ipv4RoutingTableEntry *, 4> RouteTrie;
+
   /**
    * \brief Lookup in the forwarding table for destination.
    * \param dest destination address
    * \param oif output interface if any (put 0 otherwise)
+   * \param header the header of the packet, to route it by flow (if any)
+   * \param p the packet, starting with the transport header (if any)
+   * \param ports whether the ports of the packet can be used to route it by flow
    * \return Ipv4Route to route the packet to reach dest address
    */
-  Ptr<Ipv4Route> LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif = 0);
+  Ptr<Ipv4Route> LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif = 0,
+                               const Ipv4Header *header = 0, Ptr<const Packet> p = 0,
+                               bool ports = false);
+
+  /**
+   * \brief Compute the hash of the flow of a packet.
+   *
+   * The hash covers the source and destination addresses, the protocol, the
+   * ID of the node (so that the nodes do not all make the same choice) and,
+   * if requested and available, the source and destination ports.
+   *
+   * \param header the IPv4 header of the packet
+   * \param p the packet, starting with the transport header (may be null)
+   * \param ports whether the ports of TCP and UDP packets can be read from
+   *        the packet
+   * \return the hash of the flow
+   */
+  uint32_t GetFlowHash (const Ipv4Header &header, Ptr<const Packet> p, bool ports);
+
+  /**
+   * \brief Store the ID of the node, if the IPv4 instance is aggregated to it.
+   */
+  void CacheNodeId (void);
 
   HostRoutes m_hostRoutes;             //!< Routes to hosts
   NetworkRoutes m_networkRoutes;       //!< Routes to networks
   ASExternalRoutes m_ASexternalRoutes; //!< External routes imported
 
+  RouteTrie m_hostRouteTrie;           //!< Routes to hosts, by destination
+  RouteTrie m_networkRouteTrie;        //!< Routes to networks, by destination
+  RouteTrie m_ASexternalRouteTrie;     //!< External routes, by destination
+
   Ptr<Ipv4> m_ipv4; //!< associated IPv4 instance
 };
 
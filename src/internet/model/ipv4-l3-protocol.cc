@@ -33,6 +33,7 @@
 #include "ns3/boolean.h"
 #include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/traffic-control-layer.h"
+#include "ns3/segmentation-offload.h"
 
 #include "loopback-net-device.h"
 #include "arp-l3-protocol.h"
@@ -814,7 +815,8 @@ Ipv4L3Protocol::Send (Ptr<Packet> packet,
   if (route && route->GetGateway () != Ipv4Address ())
     {
       NS_LOG_LOGIC ("Ipv4L3Protocol::Send case 3:  passed in with route");
-      ipHeader = BuildHeader (source, destination, protocol, packet->GetSize (), ttl, tos, mayFragment);
+      ipHeader = BuildHeader (source, destination, protocol, packet->GetSize (), ttl, tos, mayFragment,
+                              SegmentationOffload::GetNSegments (packet));
       int32_t interface = GetInterfaceForDevice (route->GetOutputDevice ());
       m_sendOutgoingTrace (ipHeader, packet, interface);
       SendRealOut (route, packet->Copy (), ipHeader);
@@ -833,7 +835,8 @@ Ipv4L3Protocol::Send (Ptr<Packet> packet,
   NS_LOG_LOGIC ("Ipv4L3Protocol::Send case 5:  passed in with no route " << destination);
   Socket::SocketErrno errno_; 
   Ptr<NetDevice> oif (0); // unused for now
-  ipHeader = BuildHeader (source, destination, protocol, packet->GetSize (), ttl, tos, mayFragment);
+  ipHeader = BuildHeader (source, destination, protocol, packet->GetSize (), ttl, tos, mayFragment,
+                          SegmentationOffload::GetNSegments (packet));
   Ptr<Ipv4Route> newRoute;
   if (m_routingProtocol != 0)
     {
@@ -867,9 +870,10 @@ Ipv4L3Protocol::BuildHeader (
   uint16_t payloadSize,
   uint8_t ttl,
   uint8_t tos,
-  bool mayFragment)
+  bool mayFragment,
+  uint16_t nIdentifications)
 {
-  NS_LOG_FUNCTION (this << source << destination << (uint16_t)protocol << payloadSize << (uint16_t)ttl << (uint16_t)tos << mayFragment);
+  NS_LOG_FUNCTION (this << source << destination << (uint16_t)protocol << payloadSize << (uint16_t)ttl << (uint16_t)tos << mayFragment << nIdentifications);
   Ipv4Header ipHeader;
   ipHeader.SetSource (source);
   ipHeader.SetDestination (destination);
@@ -887,7 +891,7 @@ Ipv4L3Protocol::BuildHeader (
     {
       ipHeader.SetMayFragment ();
       ipHeader.SetIdentification (m_identification[key]);
-      m_identification[key]++;
+      m_identification[key] += nIdentifications;
     }
   else
     {
@@ -897,7 +901,7 @@ Ipv4L3Protocol::BuildHeader (
       // >> Originating sources MAY set the IPv4 ID field of atomic datagrams
       //    to any value.
       ipHeader.SetIdentification (m_identification[key]);
-      m_identification[key]++;
+      m_identification[key] += nIdentifications;
     }
   if (Node::ChecksumEnabled ())
     {
@@ -924,12 +928,24 @@ Ipv4L3Protocol::SendRealOut (Ptr<Ipv4Route> route,
   Ptr<Ipv4Interface> outInterface = GetInterface (interface);
   NS_LOG_LOGIC ("Send via NetDevice ifIndex " << outDev->GetIfIndex () << " ipv4InterfaceIndex " << interface);
 
+  // Super-segments are split by the devices supporting segmentation offload;
+  // they are split here (generic segmentation offload) for the other devices
+  bool offload = false;
+  if (SegmentationOffload::IsSuperSegment (packet))
+    {
+      offload = outDev->SupportsSegmentationOffload ();
+      if (!offload && SendSegments (route, packet, ipHeader))
+        {
+          return;
+        }
+    }
+
   if (!route->GetGateway ().IsEqual (Ipv4Address ("0.0.0.0")))
     {
       if (outInterface->IsUp ())
         {
           NS_LOG_LOGIC ("Send to gateway " << route->GetGateway ());
-          if ( packet->GetSize () + ipHeader.GetSerializedSize () > outInterface->GetDevice ()->GetMtu () )
+          if ( !offload && packet->GetSize () + ipHeader.GetSerializedSize () > outInterface->GetDevice ()->GetMtu () )
             {
               std::list<Ipv4PayloadHeaderPair> listFragments;
               DoFragmentation (packet, ipHeader, outInterface->GetDevice ()->GetMtu (), listFragments);
@@ -956,7 +972,7 @@ Ipv4L3Protocol::SendRealOut (Ptr<Ipv4Route> route,
       if (outInterface->IsUp ())
         {
           NS_LOG_LOGIC ("Send to destination " << ipHeader.GetDestination ());
-          if ( packet->GetSize () + ipHeader.GetSerializedSize () > outInterface->GetDevice ()->GetMtu () )
+          if ( !offload && packet->GetSize () + ipHeader.GetSerializedSize () > outInterface->GetDevice ()->GetMtu () )
             {
               std::list<Ipv4PayloadHeaderPair> listFragments;
               DoFragmentation (packet, ipHeader, outInterface->GetDevice ()->GetMtu (), listFragments);
@@ -981,6 +997,30 @@ Ipv4L3Protocol::SendRealOut (Ptr<Ipv4Route> route,
     }
 }
 
+bool
+Ipv4L3Protocol::SendSegments (Ptr<Ipv4Route> route, Ptr<const Packet> packet, Ipv4Header const &ipHeader)
+{
+  NS_LOG_FUNCTION (this << route << packet << &ipHeader);
+  Ptr<Packet> superSegment = packet->Copy ();
+  superSegment->AddHeader (ipHeader);
+  std::vector<Ptr<Packet> > segments;
+  if (!SegmentationOffload::Segment (superSegment, PROT_NUMBER, segments))
+    {
+      return false;
+    }
+  for (std::vector<Ptr<Packet> >::iterator it = segments.begin (); it != segments.end (); it++)
+    {
+      Ipv4Header header;
+      (*it)->RemoveHeader (header);
+      if (Node::ChecksumEnabled ())
+        {
+          header.EnableChecksum ();
+        }
+      SendRealOut (route, *it, header);
+    }
+  return true;
+}
+
 // This function analogous to Linux ip_mr_forward()
 void
 Ipv4L3Protocol::IpMulticastForward (Ptr<Ipv4MulticastRoute> mrtentry, Ptr<const Packet> p, const Ipv4Header &header)
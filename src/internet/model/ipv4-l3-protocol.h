@@ -305,6 +305,9 @@ private:
    * \param ttl Time to Live
    * \param tos Type of Service
    * \param mayFragment true if the packet can be fragmented
+   * \param nIdentifications the number of consecutive identifications to
+   *        allocate, the first of which is set in the header (a super-segment
+   *        needs one for each of its segments)
    * \return newly created IPv4 header
    */
   Ipv4Header BuildHeader (
@@ -314,7 +317,8 @@ private:
     uint16_t payloadSize,
     uint8_t ttl,
     uint8_t tos,
-    bool mayFragment);
+    bool mayFragment,
+    uint16_t nIdentifications = 1);
 
   /**
    * \brief Send packet with route.
@@ -327,6 +331,21 @@ private:
                Ptr<Packet> packet,
                Ipv4Header const &ipHeader);
 
+  /**
+   * \brief Split a super-segment and send its segments with route.
+   *
+   * Used when the output device does not support segmentation offload.
+   *
+   * \param route route
+   * \param packet the super-segment to send
+   * \param ipHeader IPv4 header of the super-segment
+   * \returns false if the packet could not be split
+   */
+  bool
+  SendSegments (Ptr<Ipv4Route> route,
+                Ptr<const Packet> packet,
+                Ipv4Header const &ipHeader);
+
   /**
    * \brief Forward a packet.
    * \param rtentry route
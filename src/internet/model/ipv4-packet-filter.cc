@@ -64,5 +64,70 @@ Ipv4PacketFilter::CheckProtocol (Ptr<QueueDiscItem> item) const
 
 // ------------------------------------------------------------------------- //
 
+NS_OBJECT_ENSURE_REGISTERED (Ipv4FiveTuplePacketFilter);
+
+TypeId
+Ipv4FiveTuplePacketFilter::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::Ipv4FiveTuplePacketFilter")
+    .SetParent<Ipv4PacketFilter> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<Ipv4FiveTuplePacketFilter> ()
+  ;
+  return tid;
+}
+
+Ipv4FiveTuplePacketFilter::Ipv4FiveTuplePacketFilter ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+Ipv4FiveTuplePacketFilter::~Ipv4FiveTuplePacketFilter ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+Ipv4FiveTuplePacketFilter::AddRule (const FiveTupleRule &rule, int32_t value)
+{
+  NS_LOG_FUNCTION (this << value);
+  m_classifier.AddRule (rule, value);
+}
+
+uint32_t
+Ipv4FiveTuplePacketFilter::GetNRules (void) const
+{
+  return m_classifier.GetNRules ();
+}
+
+int32_t
+Ipv4FiveTuplePacketFilter::DoClassify (Ptr<QueueDiscItem> item) const
+{
+  NS_LOG_FUNCTION (this << item);
+
+  const Ipv4Header &hdr = StaticCast<Ipv4QueueDiscItem> (item)->GetHeader ();
+  uint8_t prot = hdr.GetProtocol ();
+  uint16_t srcPort = 0;
+  uint16_t destPort = 0;
+
+  if (prot == 6 && hdr.GetFragmentOffset () == 0) // TCP
+    {
+      TcpHeader tcpHdr;
+      item->GetPacket ()->PeekHeader (tcpHdr);
+      srcPort = tcpHdr.GetSourcePort ();
+      destPort = tcpHdr.GetDestinationPort ();
+    }
+  else if (prot == 17 && hdr.GetFragmentOffset () == 0) // UDP
+    {
+      UdpHeader udpHdr;
+      item->GetPacket ()->PeekHeader (udpHdr);
+      srcPort = udpHdr.GetSourcePort ();
+      destPort = udpHdr.GetDestinationPort ();
+    }
+
+  int32_t ret = m_classifier.Classify (FiveTupleClassifier::MakeKey (hdr.GetSource (), hdr.GetDestination (), prot,
+                                                                     srcPort, destPort, hdr.GetDscp ()));
+  return (ret == FiveTupleClassifier::NO_MATCH ? PacketFilter::PF_NO_MATCH : ret);
+}
 
 } // namespace ns3
@@ -26,6 +26,7 @@
 
 #include "ns3/object.h"
 #include "ns3/packet-filter.h"
+#include "ns3/five-tuple-classifier.h"
 
 namespace ns3 {
 
@@ -51,6 +52,46 @@ private:
   virtual int32_t DoClassify (Ptr<QueueDiscItem> item) const = 0;
 };
 
+/**
+ * \ingroup ipv4
+ * \ingroup traffic-control
+ *
+ * Ipv4FiveTuplePacketFilter classifies Ipv4 packets based on their 5-tuple
+ * and DSCP, by matching them against a list of rules (see FiveTupleRule). The
+ * rules are compiled into a FiveTupleClassifier as they are added, so that
+ * the cost of classifying a packet does not grow with the number of rules.
+ * If a packet matches multiple rules, the value of the rule added first is
+ * returned.
+ */
+class Ipv4FiveTuplePacketFilter: public Ipv4PacketFilter {
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  Ipv4FiveTuplePacketFilter ();
+  virtual ~Ipv4FiveTuplePacketFilter ();
+
+  /**
+   * \brief Add a rule, with a lower precedence than the rules already added
+   * \param rule the rule
+   * \param value the value returned for the packets matching the rule (non-negative)
+   */
+  void AddRule (const FiveTupleRule &rule, int32_t value);
+  /**
+   * \brief Get the number of rules
+   * \return the number of rules
+   */
+  uint32_t GetNRules (void) const;
+
+private:
+  virtual int32_t DoClassify (Ptr<QueueDiscItem> item) const;
+
+  FiveTupleClassifier m_classifier;   //!< the compiled rules
+};
+
 } // namespace ns3
 
 #endif /* IPV4_PACKET_FILTER */
@@ -31,6 +31,7 @@
 #include "ns3/ptr.h"
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
+#include "ns3/prefix-trie.h"
 
 namespace ns3 {
 
@@ -386,6 +387,9 @@ private:
   /// Iterator for container for the network routes
   typedef std::list<std::pair <Ipv4RoutingTableEntry *, uint32_t> >::iterator NetworkRoutesI;
 
+  /// Index of the network routes by destination prefix
+  typedef PrefixTrie<NetworkRoutesI, 4> NetworkRouteTrie;
+
   /// Container for the multicast routes
   typedef std::list<Ipv4MulticastRoutingTableEntry *> MulticastRoutes;
 
@@ -413,11 +417,30 @@ private:
   Ptr<Ipv4MulticastRoute> LookupStatic (Ipv4Address origin, Ipv4Address group,
                                         uint32_t interface);
 
+  /**
+   * \brief Add a network route at the end of the forwarding table.
+   * \param route the route
+   * \param metric the metric of the route
+   */
+  void InsertNetworkRoute (Ipv4RoutingTableEntry *route, uint32_t metric);
+
+  /**
+   * \brief Remove a network route from the forwarding table and delete it.
+   * \param it the route
+   * \return the route following the removed one
+   */
+  NetworkRoutesI EraseNetworkRoute (NetworkRoutesI it);
+
   /**
    * \brief the forwarding table for network.
    */
   NetworkRoutes m_networkRoutes;
 
+  /**
+   * \brief the network routes, by destination prefix.
+   */
+  NetworkRouteTrie m_networkRouteTrie;
+
   /**
    * \brief the forwarding table for multicast.
    */
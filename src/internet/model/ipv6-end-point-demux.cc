@@ -21,6 +21,7 @@
 #include "ipv6-end-point-demux.h"
 #include "ipv6-end-point.h"
 #include "ns3/log.h"
+#include <vector>
 
 namespace ns3 {
 
@@ -48,23 +49,20 @@ Ipv6EndPointDemux::~Ipv6EndPointDemux ()
 bool Ipv6EndPointDemux::LookupPortLocal (uint16_t port)
 {
   NS_LOG_FUNCTION (this << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
-    {
-      if ((*i)->GetLocalPort  () == port)
-        {
-          return true;
-        }
-    }
-  return false;
+  return m_localPorts.find (port) != m_localPorts.end ();
 }
 
 bool Ipv6EndPointDemux::LookupLocal (Ptr<NetDevice> boundNetDevice, Ipv6Address addr, uint16_t port)
 {
   NS_LOG_FUNCTION (this << addr << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  PortEndPointsI it = m_localPorts.find (port);
+  if (it == m_localPorts.end ())
+    {
+      return false;
+    }
+  for (EndPointsI i = it->second.begin (); i != it->second.end (); i++)
     {
-      if ((*i)->GetLocalPort () == port &&
-          (*i)->GetLocalAddress () == addr &&
+      if ((*i)->GetLocalAddress () == addr &&
           (*i)->GetBoundNetDevice () == boundNetDevice)
         {
           return true;
@@ -83,7 +81,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate ()
       return 0;
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (Ipv6Address::GetAny (), port);
-  m_endPoints.push_back (endPoint);
+  Insert (endPoint);
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -98,7 +96,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address address)
       return 0;
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
+  Insert (endPoint);
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -119,7 +117,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice, Ipv6Ad
       return 0;
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
+  Insert (endPoint);
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -129,21 +127,45 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
                                            Ipv6Address peerAddress, uint16_t peerPort)
 {
   NS_LOG_FUNCTION (this << boundNetDevice << localAddress << localPort << peerAddress << peerPort);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  if (peerAddress != Ipv6Address::GetAny () && peerPort != 0)
     {
-      if ((*i)->GetLocalPort () == localPort &&
-          (*i)->GetLocalAddress () == localAddress &&
-          (*i)->GetPeerPort () == peerPort &&
-          (*i)->GetPeerAddress () == peerAddress &&
-          ((*i)->GetBoundNetDevice () == boundNetDevice || (*i)->GetBoundNetDevice () == 0))
+      // the end points with the same four-tuple are in the four-tuple index
+      FourTuple tuple;
+      tuple.localAddress = localAddress;
+      tuple.localPort = localPort;
+      tuple.peerAddress = peerAddress;
+      tuple.peerPort = peerPort;
+      std::pair<ConnectedEndPointsI, ConnectedEndPointsI> range = m_connected.equal_range (tuple);
+      for (ConnectedEndPointsI i = range.first; i != range.second; i++)
         {
-          NS_LOG_WARN ("Duplicated endpoint.");
-          return 0;
+          if (i->second->GetBoundNetDevice () == boundNetDevice || i->second->GetBoundNetDevice () == 0)
+            {
+              NS_LOG_WARN ("Duplicated endpoint.");
+              return 0;
+            }
+        }
+    }
+  else
+    {
+      PortEndPointsI it = m_localPorts.find (localPort);
+      if (it != m_localPorts.end ())
+        {
+          for (EndPointsI i = it->second.begin (); i != it->second.end (); i++)
+            {
+              if ((*i)->GetLocalAddress () == localAddress &&
+                  (*i)->GetPeerPort () == peerPort &&
+                  (*i)->GetPeerAddress () == peerAddress &&
+                  ((*i)->GetBoundNetDevice () == boundNetDevice || (*i)->GetBoundNetDevice () == 0))
+                {
+                  NS_LOG_WARN ("Duplicated endpoint.");
+                  return 0;
+                }
+            }
         }
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (localAddress, localPort);
   endPoint->SetPeer (peerAddress, peerPort);
-  m_endPoints.push_back (endPoint);
+  Insert (endPoint);
 
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
 
@@ -153,17 +175,99 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
 void Ipv6EndPointDemux::DeAllocate (Ipv6EndPoint *endPoint)
 {
   NS_LOG_FUNCTION (this);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  if (endPoint->m_demux != this)
+    {
+      return;
+    }
+  Unindex (endPoint);
+  PortEndPointsI it = m_localPorts.find (endPoint->GetLocalPort ());
+  it->second.erase (endPoint->m_portPosition);
+  if (it->second.empty ())
+    {
+      m_localPorts.erase (it);
+    }
+  m_endPoints.erase (endPoint->m_demuxPosition);
+  delete endPoint;
+}
+
+void Ipv6EndPointDemux::Insert (Ipv6EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  endPoint->m_demuxPosition = m_endPoints.insert (m_endPoints.end (), endPoint);
+  EndPoints &endPoints = m_localPorts[endPoint->GetLocalPort ()];
+  endPoint->m_portPosition = endPoints.insert (endPoints.end (), endPoint);
+  endPoint->m_demux = this;
+  Index (endPoint);
+}
+
+void Ipv6EndPointDemux::Index (Ipv6EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  FourTuple tuple;
+  if (GetFourTuple (endPoint, tuple))
+    {
+      m_connected.insert (std::make_pair (tuple, endPoint));
+    }
+  else
+    {
+      m_wildcards.insert (std::make_pair (tuple.localPort, endPoint));
+    }
+}
+
+void Ipv6EndPointDemux::Unindex (Ipv6EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  FourTuple tuple;
+  if (GetFourTuple (endPoint, tuple))
+    {
+      std::pair<ConnectedEndPointsI, ConnectedEndPointsI> range = m_connected.equal_range (tuple);
+      for (ConnectedEndPointsI i = range.first; i != range.second; i++)
+        {
+          if (i->second == endPoint)
+            {
+              m_connected.erase (i);
+              return;
+            }
+        }
+    }
+  else
     {
-      if (*i == endPoint)
+      std::pair<WildcardEndPointsI, WildcardEndPointsI> range = m_wildcards.equal_range (tuple.localPort);
+      for (WildcardEndPointsI i = range.first; i != range.second; i++)
         {
-          delete endPoint;
-          m_endPoints.erase (i);
-          break;
+          if (i->second == endPoint)
+            {
+              m_wildcards.erase (i);
+              return;
+            }
         }
     }
 }
 
+bool Ipv6EndPointDemux::GetFourTuple (Ipv6EndPoint *endPoint, FourTuple &tuple)
+{
+  tuple.localAddress = endPoint->GetLocalAddress ();
+  tuple.localPort = endPoint->GetLocalPort ();
+  tuple.peerAddress = endPoint->GetPeerAddress ();
+  tuple.peerPort = endPoint->GetPeerPort ();
+  return tuple.peerAddress != Ipv6Address::GetAny () && tuple.peerPort != 0;
+}
+
+bool Ipv6EndPointDemux::FourTuple::operator== (const FourTuple &other) const
+{
+  return localPort == other.localPort && peerPort == other.peerPort
+         && localAddress == other.localAddress && peerAddress == other.peerAddress;
+}
+
+size_t Ipv6EndPointDemux::FourTupleHash::operator() (const FourTuple &tuple) const
+{
+  Ipv6AddressHash addressHash;
+  size_t h = addressHash (tuple.localAddress);
+  h ^= addressHash (tuple.peerAddress) + 0x9e3779b9 + (h << 6) + (h >> 2);
+  h ^= ((static_cast<size_t> (tuple.localPort) << 16) | tuple.peerPort) + 0x9e3779b9 + (h << 6) + (h >> 2);
+  return h;
+}
+
 /*
  * If we have an exact match, we return it.
  * Otherwise, if we find a generic match, we return it.
@@ -181,7 +285,37 @@ Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::Lookup (Ipv6Address daddr, uint1
   EndPoints retval4; /* Exact match on all 4 */
 
   NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+
+  /* The candidates are the end points connected to the source and bound to
+     the destination address or to the wildcard address, and the wildcard
+     end points bound to the destination port. */
+  std::vector<Ipv6EndPoint *> candidates;
+  FourTuple tuple;
+  tuple.localAddress = daddr;
+  tuple.localPort = dport;
+  tuple.peerAddress = saddr;
+  tuple.peerPort = sport;
+  std::pair<ConnectedEndPointsI, ConnectedEndPointsI> connected = m_connected.equal_range (tuple);
+  for (ConnectedEndPointsI i = connected.first; i != connected.second; i++)
+    {
+      candidates.push_back (i->second);
+    }
+  if (daddr != Ipv6Address::GetAny ())
+    {
+      tuple.localAddress = Ipv6Address::GetAny ();
+      connected = m_connected.equal_range (tuple);
+      for (ConnectedEndPointsI i = connected.first; i != connected.second; i++)
+        {
+          candidates.push_back (i->second);
+        }
+    }
+  std::pair<WildcardEndPointsI, WildcardEndPointsI> wildcards = m_wildcards.equal_range (dport);
+  for (WildcardEndPointsI i = wildcards.first; i != wildcards.second; i++)
+    {
+      candidates.push_back (i->second);
+    }
+
+  for (std::vector<Ipv6EndPoint *>::const_iterator i = candidates.begin (); i != candidates.end (); i++)
     {
       Ipv6EndPoint* endP = *i;
 
@@ -293,15 +427,15 @@ Ipv6EndPoint* Ipv6EndPointDemux::SimpleLookup (Ipv6Address dst, uint16_t dport,
   uint32_t genericity = 3;
   Ipv6EndPoint *generic = 0;
 
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  PortEndPointsI it = m_localPorts.find (dport);
+  if (it == m_localPorts.end ())
+    {
+      return 0;
+    }
+  for (EndPointsI i = it->second.begin (); i != it->second.end (); i++)
     {
       uint32_t tmp = 0;
 
-      if ((*i)->GetLocalPort () != dport)
-        {
-          continue;
-        }
-
       if ((*i)->GetLocalAddress () == dst && (*i)->GetPeerPort () == sport
           && (*i)->GetPeerAddress () == src)
         {
@@ -23,6 +23,7 @@
 
 #include <stdint.h>
 #include <list>
+#include <unordered_map>
 #include "ns3/ipv6-address.h"
 #include "ipv6-interface.h"
 
@@ -34,6 +35,11 @@ class Ipv6EndPoint;
  * \ingroup ipv6
  *
  * \brief Demultiplexer for end points.
+ *
+ * Besides the list of endpoints, the demux indexes the endpoints whose peer
+ * is set by their four-tuple, and the other (wildcard) endpoints and all
+ * the endpoints by their local port, so that the cost of a lookup does not
+ * grow with the number of connections.
  */
 class Ipv6EndPointDemux
 {
@@ -178,6 +184,94 @@ private:
    * \brief A list of IPv6 end points.
    */
   EndPoints m_endPoints;
+  friend class Ipv6EndPoint;
+
+  /**
+   * \brief Add an end point to the list of end points and to the indexes.
+   * \param endPoint the end point
+   */
+  void Insert (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Add an end point to the four-tuple or to the wildcard index.
+   * \param endPoint the end point
+   */
+  void Index (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Remove an end point from the four-tuple or from the wildcard index.
+   * \param endPoint the end point
+   */
+  void Unindex (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief The four-tuple of an end point.
+   */
+  struct FourTuple
+  {
+    Ipv6Address localAddress;  //!< the local address
+    uint16_t localPort;         //!< the local port
+    Ipv6Address peerAddress;   //!< the peer address
+    uint16_t peerPort;          //!< the peer port
+
+    /**
+     * \brief Compare two four-tuples.
+     * \param other the other four-tuple
+     * \return true if the four-tuples are equal
+     */
+    bool operator== (const FourTuple &other) const;
+  };
+
+  /**
+   * \brief Hash function of the four-tuples.
+   */
+  struct FourTupleHash
+  {
+    /**
+     * \brief Hash a four-tuple.
+     * \param tuple the four-tuple
+     * \return the hash value
+     */
+    size_t operator() (const FourTuple &tuple) const;
+  };
+
+  /**
+   * \brief Build the four-tuple of an end point.
+   * \param endPoint the end point
+   * \param tuple the four-tuple
+   * \return true if the peer address and port of the end point are set
+   */
+  static bool GetFourTuple (Ipv6EndPoint *endPoint, FourTuple &tuple);
+
+  /// End points indexed by their four-tuple
+  typedef std::unordered_multimap<FourTuple, Ipv6EndPoint *, FourTupleHash> ConnectedEndPoints;
+  /// Iterator to the end points indexed by their four-tuple
+  typedef ConnectedEndPoints::iterator ConnectedEndPointsI;
+  /// End points indexed by their local port
+  typedef std::unordered_multimap<uint16_t, Ipv6EndPoint *> WildcardEndPoints;
+  /// Iterator to the end points indexed by their local port
+  typedef WildcardEndPoints::iterator WildcardEndPointsI;
+  /// Lists of end points indexed by their local port
+  typedef std::unordered_map<uint16_t, EndPoints> PortEndPoints;
+  /// Iterator to the lists of end points indexed by their local port
+  typedef PortEndPoints::iterator PortEndPointsI;
+
+  /**
+   * \brief The end points whose peer address and port are set, indexed by
+   * their four-tuple.
+   */
+  ConnectedEndPoints m_connected;
+
+  /**
+   * \brief The other end points, indexed by their local port.
+   */
+  WildcardEndPoints m_wildcards;
+
+  /**
+   * \brief All the end points, indexed by their local port, in the order of
+   * the list of end points.
+   */
+  PortEndPoints m_localPorts;
 };
 
 } /* namespace ns3 */
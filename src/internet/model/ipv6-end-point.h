@@ -22,6 +22,7 @@
 #define IPV6_END_POINT_H
 
 #include <stdint.h>
+#include <list>
 
 #include "ns3/ipv6-address.h"
 #include "ns3/callback.h"
@@ -34,6 +35,7 @@ namespace ns3
 
 class Header;
 class Packet;
+class Ipv6EndPointDemux;
 
 /**
  * \ingroup ipv6
@@ -236,6 +238,24 @@ private:
    * \brief true if the endpoint can receive packets.
    */
   bool m_rxEnabled;
+  friend class Ipv6EndPointDemux;
+
+  /**
+   * \brief The demux where the endpoint is allocated (if any), which is
+   * notified when the local address or the peer change.
+   */
+  Ipv6EndPointDemux *m_demux;
+
+  /**
+   * \brief The position of the endpoint in the list of endpoints of the demux.
+   */
+  std::list<Ipv6EndPoint *>::iterator m_demuxPosition;
+
+  /**
+   * \brief The position of the endpoint in the list of endpoints of the demux
+   * with the same local port.
+   */
+  std::list<Ipv6EndPoint *>::iterator m_portPosition;
 };
 
 } /* namespace ns3 */
@@ -31,6 +31,7 @@
 #include "ns3/mac16-address.h"
 #include "ns3/mac64-address.h"
 #include "ns3/traffic-control-layer.h"
+#include "ns3/segmentation-offload.h"
 
 #include "loopback-net-device.h"
 #include "ipv6-l3-protocol.h"
@@ -1115,6 +1116,18 @@ void Ipv6L3Protocol::SendRealOut (Ptr<Ipv6Route> route, Ptr<Packet> packet, Ipv6
   Ptr<Ipv6Interface> outInterface = GetInterface (interface);
   NS_LOG_LOGIC ("Send via NetDevice ifIndex " << dev->GetIfIndex () << " Ipv6InterfaceIndex " << interface);
 
+  // Super-segments are split by the devices supporting segmentation offload;
+  // they are split here (generic segmentation offload) for the other devices
+  bool offload = false;
+  if (SegmentationOffload::IsSuperSegment (packet))
+    {
+      offload = dev->SupportsSegmentationOffload ();
+      if (!offload && SendSegments (route, packet, ipHeader))
+        {
+          return;
+        }
+    }
+
   // Check packet size
   std::list<Ipv6ExtensionFragment::Ipv6PayloadHeaderPair> fragments;
 
@@ -1125,7 +1138,7 @@ void Ipv6L3Protocol::SendRealOut (Ptr<Ipv6Route> route, Ptr<Packet> packet, Ipv6
       targetMtu = dev->GetMtu ();
     }
 
-  if (packet->GetSize () > targetMtu + 40) /* 40 => size of IPv6 header */
+  if (!offload && packet->GetSize () > targetMtu + 40) /* 40 => size of IPv6 header */
     {
       // Router => drop
 
@@ -1218,6 +1231,25 @@ void Ipv6L3Protocol::SendRealOut (Ptr<Ipv6Route> route, Ptr<Packet> packet, Ipv6
     }
 }
 
+bool Ipv6L3Protocol::SendSegments (Ptr<Ipv6Route> route, Ptr<const Packet> packet, Ipv6Header const& ipHeader)
+{
+  NS_LOG_FUNCTION (this << route << packet << ipHeader);
+  Ptr<Packet> superSegment = packet->Copy ();
+  superSegment->AddHeader (ipHeader);
+  std::vector<Ptr<Packet> > segments;
+  if (!SegmentationOffload::Segment (superSegment, PROT_NUMBER, segments))
+    {
+      return false;
+    }
+  for (std::vector<Ptr<Packet> >::iterator it = segments.begin (); it != segments.end (); it++)
+    {
+      Ipv6Header header;
+      (*it)->RemoveHeader (header);
+      SendRealOut (route, *it, header);
+    }
+  return true;
+}
+
 void Ipv6L3Protocol::IpForward (Ptr<const NetDevice> idev, Ptr<Ipv6Route> rtentry, Ptr<const Packet> p, const Ipv6Header& header)
 {
   NS_LOG_FUNCTION (this << rtentry << p << header);
@@ -584,6 +584,18 @@ private:
    */
   void SendRealOut (Ptr<Ipv6Route> route, Ptr<Packet> packet, Ipv6Header const& ipHeader);
 
+  /**
+   * \brief Split a super-segment and send its segments with route.
+   *
+   * Used when the output device does not support segmentation offload.
+   *
+   * \param route route
+   * \param packet the super-segment to send
+   * \param ipHeader IPv6 header of the super-segment
+   * \returns false if the packet could not be split
+   */
+  bool SendSegments (Ptr<Ipv6Route> route, Ptr<const Packet> packet, Ipv6Header const& ipHeader);
+
   /**
    * \brief Forward a packet.
    * \param idev Pointer to ingress network device
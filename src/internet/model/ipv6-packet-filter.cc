@@ -64,5 +64,70 @@ Ipv6PacketFilter::CheckProtocol (Ptr<QueueDiscItem> item) const
 
 // ------------------------------------------------------------------------- //
 
+NS_OBJECT_ENSURE_REGISTERED (Ipv6FiveTuplePacketFilter);
+
+TypeId
+Ipv6FiveTuplePacketFilter::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::Ipv6FiveTuplePacketFilter")
+    .SetParent<Ipv6PacketFilter> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<Ipv6FiveTuplePacketFilter> ()
+  ;
+  return tid;
+}
+
+Ipv6FiveTuplePacketFilter::Ipv6FiveTuplePacketFilter ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+Ipv6FiveTuplePacketFilter::~Ipv6FiveTuplePacketFilter ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+Ipv6FiveTuplePacketFilter::AddRule (const FiveTupleRule &rule, int32_t value)
+{
+  NS_LOG_FUNCTION (this << value);
+  m_classifier.AddRule (rule, value);
+}
+
+uint32_t
+Ipv6FiveTuplePacketFilter::GetNRules (void) const
+{
+  return m_classifier.GetNRules ();
+}
+
+int32_t
+Ipv6FiveTuplePacketFilter::DoClassify (Ptr<QueueDiscItem> item) const
+{
+  NS_LOG_FUNCTION (this << item);
+
+  const Ipv6Header &hdr = StaticCast<Ipv6QueueDiscItem> (item)->GetHeader ();
+  uint8_t prot = hdr.GetNextHeader ();
+  uint16_t srcPort = 0;
+  uint16_t destPort = 0;
+
+  if (prot == 6) // TCP
+    {
+      TcpHeader tcpHdr;
+      item->GetPacket ()->PeekHeader (tcpHdr);
+      srcPort = tcpHdr.GetSourcePort ();
+      destPort = tcpHdr.GetDestinationPort ();
+    }
+  else if (prot == 17) // UDP
+    {
+      UdpHeader udpHdr;
+      item->GetPacket ()->PeekHeader (udpHdr);
+      srcPort = udpHdr.GetSourcePort ();
+      destPort = udpHdr.GetDestinationPort ();
+    }
+
+  int32_t ret = m_classifier.Classify (FiveTupleClassifier::MakeKey (hdr.GetSourceAddress (), hdr.GetDestinationAddress (),
+                                                                     prot, srcPort, destPort, hdr.GetDscp ()));
+  return (ret == FiveTupleClassifier::NO_MATCH ? PacketFilter::PF_NO_MATCH : ret);
+}
 
 } // namespace ns3
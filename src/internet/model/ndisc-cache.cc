@@ -94,9 +94,10 @@ NdiscCache::Entry* NdiscCache::Lookup (Ipv6Address dst)
 {
   NS_LOG_FUNCTION (this << dst);
 
-  if (m_ndCache.find (dst) != m_ndCache.end ())
+  CacheI it = m_ndCache.find (dst);
+  if (it != m_ndCache.end ())
     {
-      NdiscCache::Entry* entry = m_ndCache[dst];
+      NdiscCache::Entry* entry = it->second;
       NS_LOG_LOGIC ("Found an entry:" << dst << " to " << entry->GetMacAddress ());
       return entry;
     }
@@ -109,18 +110,36 @@ std::list<NdiscCache::Entry*> NdiscCache::LookupInverse (Address dst)
   NS_LOG_FUNCTION (this << dst);
 
   std::list<NdiscCache::Entry *> entryList;
-  for (CacheI i = m_ndCache.begin (); i != m_ndCache.end (); i++)
+  std::pair<InverseCacheI, InverseCacheI> range = m_inverseCache.equal_range (dst);
+  for (InverseCacheI i = range.first; i != range.second; i++)
     {
-      NdiscCache::Entry *entry = (*i).second;
-      if (entry->GetMacAddress () == dst)
-        {
-          NS_LOG_LOGIC ("Found an entry:" << (*i).first << " to " << (*i).second);
-          entryList.push_back (entry);
-        }
+      NS_LOG_LOGIC ("Found an entry:" << i->second->GetIpv6Address () << " to " << i->second);
+      entryList.push_back (i->second);
     }
   return entryList;
 }
 
+void NdiscCache::UpdateInverse (NdiscCache::Entry* entry, Address mac)
+{
+  NS_LOG_FUNCTION (this << entry << mac);
+  Address current = entry->GetMacAddress ();
+  if (!current.IsInvalid ())
+    {
+      std::pair<InverseCacheI, InverseCacheI> range = m_inverseCache.equal_range (current);
+      for (InverseCacheI i = range.first; i != range.second; i++)
+        {
+          if (i->second == entry)
+            {
+              m_inverseCache.erase (i);
+              break;
+            }
+        }
+    }
+  if (!mac.IsInvalid ())
+    {
+      m_inverseCache.insert (std::make_pair (mac, entry));
+    }
+}
 
 NdiscCache::Entry* NdiscCache::Add (Ipv6Address to)
 {
@@ -137,15 +156,13 @@ void NdiscCache::Remove (NdiscCache::Entry* entry)
 {
   NS_LOG_FUNCTION_NOARGS ();
 
-  for (CacheI i = m_ndCache.begin (); i != m_ndCache.end (); i++)
+  CacheI i = m_ndCache.find (entry->GetIpv6Address ());
+  if (i != m_ndCache.end () && (*i).second == entry)
     {
-      if ((*i).second == entry)
-        {
-          m_ndCache.erase (i);
-          entry->ClearWaitingPacket ();
-          delete entry;
-          return;
-        }
+      UpdateInverse (entry, Address ());
+      m_ndCache.erase (i);
+      entry->ClearWaitingPacket ();
+      delete entry;
     }
 }
 
@@ -159,6 +176,7 @@ void NdiscCache::Flush ()
     }
 
   m_ndCache.erase (m_ndCache.begin (), m_ndCache.end ());
+  m_inverseCache.clear ();
 }
 
 void NdiscCache::SetUnresQlen (uint32_t unresQlen)
@@ -408,6 +426,12 @@ void NdiscCache::Entry::SetIpv6Address (Ipv6Address ipv6Address)
   m_ipv6Address = ipv6Address;
 }
 
+Ipv6Address NdiscCache::Entry::GetIpv6Address () const
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return m_ipv6Address;
+}
+
 Time NdiscCache::Entry::GetLastReachabilityConfirmation () const
 {
   NS_LOG_FUNCTION_NOARGS ();
@@ -504,6 +528,7 @@ std::list<NdiscCache::Ipv6PayloadHeaderPair> NdiscCache::Entry::MarkReachable (A
 {
   NS_LOG_FUNCTION (this << mac);
   m_state = REACHABLE;
+  m_ndCache->UpdateInverse (this, mac);
   m_macAddress = mac;
   return m_waiting;
 }
@@ -530,6 +555,7 @@ std::list<NdiscCache::Ipv6PayloadHeaderPair> NdiscCache::Entry::MarkStale (Addre
 {
   NS_LOG_FUNCTION (this << mac);
   m_state = STALE;
+  m_ndCache->UpdateInverse (this, mac);
   m_macAddress = mac;
   return m_waiting;
 }
@@ -592,6 +618,7 @@ Address NdiscCache::Entry::GetMacAddress () const
 void NdiscCache::Entry::SetMacAddress (Address mac)
 {
   NS_LOG_FUNCTION (this << mac << int(m_state));
+  m_ndCache->UpdateInverse (this, mac);
   m_macAddress = mac;
 }
 
@@ -23,6 +23,7 @@
 
 #include <stdint.h>
 #include <list>
+#include <unordered_map>
 
 #include "ns3/packet.h"
 #include "ns3/nstime.h"
@@ -342,6 +343,12 @@ public:
      */
     void SetIpv6Address (Ipv6Address ipv6Address);
 
+    /**
+     * \brief Get the IPv6 address.
+     * \return IPv6 address
+     */
+    Ipv6Address GetIpv6Address () const;
+
 private:
     /**
      * \brief The IPv6 address.
@@ -412,6 +419,16 @@ private:
    */
   typedef sgi::hash_map<Ipv6Address, NdiscCache::Entry *, Ipv6AddressHash>::iterator CacheI;
 
+  /**
+   * \brief Neighbor Discovery Cache entries indexed by their MAC address
+   */
+  typedef std::unordered_multimap<Address, NdiscCache::Entry *, AddressHash> InverseCache;
+
+  /**
+   * \brief Iterator of the Neighbor Discovery Cache entries indexed by their MAC address
+   */
+  typedef InverseCache::iterator InverseCacheI;
+
   /**
    * \brief Copy constructor.
    *
@@ -432,6 +449,13 @@ private:
    */
   void DoDispose ();
 
+  /**
+   * \brief Update the MAC address of an entry in the inverse index.
+   * \param entry the entry
+   * \param mac the new MAC address of the entry
+   */
+  void UpdateInverse (NdiscCache::Entry* entry, Address mac);
+
   /**
    * \brief The NetDevice.
    */
@@ -452,6 +476,11 @@ private:
    */
   Cache m_ndCache;
 
+  /**
+   * \brief The entries with a valid MAC address, indexed by MAC address.
+   */
+  InverseCache m_inverseCache;
+
   /**
    * \brief Max number of packet stored in m_waiting.
    */
@@ -0,0 +1,462 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PREFIX_TRIE_H
+#define PREFIX_TRIE_H
+
+#include <stdint.h>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include "ns3/assert.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup ipv4Routing
+ *
+ * \brief Path-compressed binary trie mapping address prefixes to values
+ *
+ * The routing protocols store their routes in lists, which are scanned
+ * on every lookup. A PrefixTrie indexes the routes by destination prefix,
+ * so that the routes matching an address are found in a number of steps
+ * bounded by the address length, regardless of the number of routes.
+ *
+ * Keys are addresses of N bytes in network order (4 for IPv4, 16 for
+ * IPv6); the bits beyond the prefix length are ignored. Several values
+ * can be stored with the same prefix. Each value is stored along with its
+ * insertion order, so that a routing protocol can reproduce the order of
+ * its route list: a value added at the end of the list is ordered after
+ * all the values stored, and one added at the front of the list before
+ * all of them.
+ *
+ * \tparam T the type of the values (e.g., a pointer to a routing table entry)
+ * \tparam N the size of the keys, in bytes
+ */
+template <typename T, uint32_t N>
+class PrefixTrie
+{
+public:
+  /// A value stored in the trie
+  struct Entry
+  {
+    T value;          //!< the value
+    uint64_t order;   //!< the insertion order of the value
+  };
+  /// The values stored with a prefix, in insertion order
+  typedef std::vector<Entry> Entries;
+
+  PrefixTrie ();
+  ~PrefixTrie ();
+
+  /**
+   * \brief Add a value
+   * \param prefix the prefix (N bytes)
+   * \param length the length of the prefix, in bits
+   * \param value the value
+   * \param front true to order the value before all the values stored,
+   *        false to order it after them
+   */
+  void Insert (const uint8_t *prefix, uint32_t length, T value, bool front = false);
+
+  /**
+   * \brief Remove the first occurrence of a value
+   * \param prefix the prefix (N bytes) the value was added with
+   * \param length the length of the prefix, in bits
+   * \param value the value
+   * \return true if the value was found and removed
+   */
+  bool Remove (const uint8_t *prefix, uint32_t length, T value);
+
+  /**
+   * \brief Remove all the values
+   */
+  void Clear (void);
+
+  /**
+   * \return the number of values stored
+   */
+  uint32_t GetSize (void) const;
+
+  /**
+   * \param prefix the prefix (N bytes)
+   * \param length the length of the prefix, in bits
+   * \return the values stored with exactly this prefix, or 0 if none
+   */
+  const Entries * Find (const uint8_t *prefix, uint32_t length) const;
+
+  /**
+   * \brief Get the values whose prefix matches an address
+   * \param key the address (N bytes)
+   * \param matches the values of each matching prefix, from the longest to
+   *        the shortest prefix (cleared first)
+   */
+  void FindMatches (const uint8_t *key, std::vector<const Entries *> &matches) const;
+
+  /**
+   * \brief Get the values whose prefix matches an address
+   * \param key the address (N bytes)
+   * \param values the values of all the matching prefixes, in insertion
+   *        order (cleared first)
+   */
+  void FindAll (const uint8_t *key, std::vector<T> &values) const;
+
+private:
+  /// A node of the trie
+  struct Node
+  {
+    uint8_t key[N];       //!< the prefix, with the bits beyond the length cleared
+    uint32_t length;      //!< the prefix length
+    Node *child[2];       //!< the subtries, by value of the bit following the prefix
+    Entries entries;      //!< the values stored with this prefix
+  };
+
+  /// Copy constructor (disabled)
+  PrefixTrie (const PrefixTrie &);
+  /**
+   * Assignment operator (disabled)
+   * \return this object
+   */
+  PrefixTrie & operator= (const PrefixTrie &);
+
+  /**
+   * \param key the key
+   * \param i the index of the bit (0 is the most significant bit)
+   * \return the value of the bit
+   */
+  static uint32_t GetBit (const uint8_t *key, uint32_t i);
+  /**
+   * \param a the first key
+   * \param b the second key
+   * \param max the maximum length to compare, in bits
+   * \return the length of the common prefix of the two keys, up to max
+   */
+  static uint32_t GetCommonLength (const uint8_t *a, const uint8_t *b, uint32_t max);
+  /**
+   * \param key the prefix
+   * \param length the prefix length
+   * \return a new node without children nor values
+   */
+  static Node * CreateNode (const uint8_t *key, uint32_t length);
+  /**
+   * \brief Delete a subtrie
+   * \param node the root of the subtrie
+   */
+  static void DeleteNodes (Node *node);
+  /**
+   * \param key the address
+   * \param node a node of the trie
+   * \return true if the prefix of the node matches the address
+   */
+  static bool IsMatch (const uint8_t *key, const Node *node);
+  /**
+   * \param a an entry
+   * \param b another entry
+   * \return true if the first entry was inserted before the second one
+   */
+  static bool IsEarlier (const Entry *a, const Entry *b);
+
+  Node *m_root;         //!< the root (the prefix of length 0)
+  uint32_t m_size;      //!< the number of values stored
+  uint64_t m_order;     //!< the insertion order of the next value added at the end
+  uint64_t m_frontOrder; //!< the insertion order of the next value added at the front
+};
+
+/**
+ * Implementation of the templates.
+ */
+
+template <typename T, uint32_t N>
+PrefixTrie<T, N>::PrefixTrie ()
+  : m_size (0),
+    m_order (1ULL << 63),
+    m_frontOrder ((1ULL << 63) - 1)
+{
+  uint8_t zero[N] = {};
+  m_root = CreateNode (zero, 0);
+}
+
+template <typename T, uint32_t N>
+PrefixTrie<T, N>::~PrefixTrie ()
+{
+  DeleteNodes (m_root);
+}
+
+template <typename T, uint32_t N>
+uint32_t
+PrefixTrie<T, N>::GetBit (const uint8_t *key, uint32_t i)
+{
+  return (key[i >> 3] >> (7 - (i & 7))) & 1;
+}
+
+template <typename T, uint32_t N>
+uint32_t
+PrefixTrie<T, N>::GetCommonLength (const uint8_t *a, const uint8_t *b, uint32_t max)
+{
+  for (uint32_t i = 0; i * 8 < max; i++)
+    {
+      uint8_t diff = a[i] ^ b[i];
+      if (diff != 0)
+        {
+          uint32_t length = i * 8;
+          while ((diff & 0x80) == 0)
+            {
+              diff <<= 1;
+              length++;
+            }
+          return std::min (length, max);
+        }
+    }
+  return max;
+}
+
+template <typename T, uint32_t N>
+typename PrefixTrie<T, N>::Node *
+PrefixTrie<T, N>::CreateNode (const uint8_t *key, uint32_t length)
+{
+  NS_ASSERT (length <= N * 8);
+  Node *node = new Node;
+  std::memcpy (node->key, key, N);
+  for (uint32_t i = length; i < N * 8; i++)
+    {
+      node->key[i >> 3] &= ~(0x80 >> (i & 7));
+    }
+  node->length = length;
+  node->child[0] = 0;
+  node->child[1] = 0;
+  return node;
+}
+
+template <typename T, uint32_t N>
+void
+PrefixTrie<T, N>::DeleteNodes (Node *node)
+{
+  if (node != 0)
+    {
+      DeleteNodes (node->child[0]);
+      DeleteNodes (node->child[1]);
+      delete node;
+    }
+}
+
+template <typename T, uint32_t N>
+bool
+PrefixTrie<T, N>::IsMatch (const uint8_t *key, const Node *node)
+{
+  return GetCommonLength (key, node->key, node->length) == node->length;
+}
+
+template <typename T, uint32_t N>
+bool
+PrefixTrie<T, N>::IsEarlier (const Entry *a, const Entry *b)
+{
+  return a->order < b->order;
+}
+
+template <typename T, uint32_t N>
+void
+PrefixTrie<T, N>::Insert (const uint8_t *prefix, uint32_t length, T value, bool front)
+{
+  NS_ASSERT (length <= N * 8);
+  Entry entry;
+  entry.value = value;
+  entry.order = (front ? m_frontOrder-- : m_order++);
+  m_size++;
+
+  Node *node = m_root;
+  while (node->length < length)
+    {
+      uint32_t bit = GetBit (prefix, node->length);
+      Node *child = node->child[bit];
+      if (child == 0)
+        {
+          child = CreateNode (prefix, length);
+          node->child[bit] = child;
+          node = child;
+          break;
+        }
+      uint32_t common = GetCommonLength (child->key, prefix, std::min (child->length, length));
+      if (common == child->length)
+        {
+          node = child;
+          continue;
+        }
+      // the new prefix diverges from the child or is a prefix of it:
+      // insert a node with the common prefix above the child
+      Node *branch = CreateNode (prefix, common);
+      branch->child[GetBit (child->key, common)] = child;
+      node->child[bit] = branch;
+      node = branch;
+      if (common < length)
+        {
+          Node *leaf = CreateNode (prefix, length);
+          branch->child[GetBit (prefix, common)] = leaf;
+          node = leaf;
+        }
+      break;
+    }
+  if (front)
+    {
+      node->entries.insert (node->entries.begin (), entry);
+    }
+  else
+    {
+      node->entries.push_back (entry);
+    }
+}
+
+template <typename T, uint32_t N>
+bool
+PrefixTrie<T, N>::Remove (const uint8_t *prefix, uint32_t length, T value)
+{
+  Node *grandparent = 0;
+  Node *parent = 0;
+  Node *node = m_root;
+  while (node->length < length)
+    {
+      Node *child = node->child[GetBit (prefix, node->length)];
+      if (child == 0 || child->length > length || !IsMatch (prefix, child))
+        {
+          return false;
+        }
+      grandparent = parent;
+      parent = node;
+      node = child;
+    }
+
+  typename Entries::iterator it = node->entries.begin ();
+  while (it != node->entries.end () && !(it->value == value))
+    {
+      it++;
+    }
+  if (it == node->entries.end ())
+    {
+      return false;
+    }
+  node->entries.erase (it);
+  m_size--;
+
+  if (node == m_root || !node->entries.empty () || (node->child[0] != 0 && node->child[1] != 0))
+    {
+      return true;
+    }
+  // the node is no longer needed: replace it with its only child, if any
+  Node *child = (node->child[0] != 0 ? node->child[0] : node->child[1]);
+  parent->child[parent->child[1] == node ? 1 : 0] = child;
+  delete node;
+  if (child == 0 && parent != m_root && parent->entries.empty ())
+    {
+      // the parent was a branching node and has a single child left
+      Node *other = (parent->child[0] != 0 ? parent->child[0] : parent->child[1]);
+      grandparent->child[grandparent->child[1] == parent ? 1 : 0] = other;
+      delete parent;
+    }
+  return true;
+}
+
+template <typename T, uint32_t N>
+void
+PrefixTrie<T, N>::Clear (void)
+{
+  DeleteNodes (m_root->child[0]);
+  DeleteNodes (m_root->child[1]);
+  m_root->child[0] = 0;
+  m_root->child[1] = 0;
+  m_root->entries.clear ();
+  m_size = 0;
+}
+
+template <typename T, uint32_t N>
+uint32_t
+PrefixTrie<T, N>::GetSize (void) const
+{
+  return m_size;
+}
+
+template <typename T, uint32_t N>
+const typename PrefixTrie<T, N>::Entries *
+PrefixTrie<T, N>::Find (const uint8_t *prefix, uint32_t length) const
+{
+  const Node *node = m_root;
+  while (node->length < length)
+    {
+      node = node->child[GetBit (prefix, node->length)];
+      if (node == 0 || node->length > length || !IsMatch (prefix, node))
+        {
+          return 0;
+        }
+    }
+  return (node->entries.empty () ? 0 : &node->entries);
+}
+
+template <typename T, uint32_t N>
+void
+PrefixTrie<T, N>::FindMatches (const uint8_t *key, std::vector<const Entries *> &matches) const
+{
+  matches.clear ();
+  const Node *node = m_root;
+  while (node != 0)
+    {
+      if (!node->entries.empty ())
+        {
+          matches.push_back (&node->entries);
+        }
+      if (node->length == N * 8)
+        {
+          break;
+        }
+      node = node->child[GetBit (key, node->length)];
+      if (node != 0 && !IsMatch (key, node))
+        {
+          break;
+        }
+    }
+  std::reverse (matches.begin (), matches.end ());
+}
+
+template <typename T, uint32_t N>
+void
+PrefixTrie<T, N>::FindAll (const uint8_t *key, std::vector<T> &values) const
+{
+  values.clear ();
+  std::vector<const Entries *> matches;
+  FindMatches (key, matches);
+  if (matches.size () == 1)
+    {
+      for (typename Entries::const_iterator it = matches[0]->begin (); it != matches[0]->end (); it++)
+        {
+          values.push_back (it->value);
+        }
+      return;
+    }
+  std::vector<const Entry *> sorted;
+  for (uint32_t i = 0; i < matches.size (); i++)
+    {
+      for (typename Entries::const_iterator it = matches[i]->begin (); it != matches[i]->end (); it++)
+        {
+          sorted.push_back (&(*it));
+        }
+    }
+  std::sort (sorted.begin (), sorted.end (), &PrefixTrie<T, N>::IsEarlier);
+  for (uint32_t i = 0; i < sorted.size (); i++)
+    {
+      values.push_back (sorted[i]->value);
+    }
+}
+
+} // namespace ns3
+
+#endif /* PREFIX_TRIE_H */
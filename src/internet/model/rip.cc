@@ -19,6 +19,7 @@
  */
 
 #include <iomanip>
+#include <algorithm>
 #include "rip.h"
 #include "ns3/log.h"
 #include "ns3/abort.h"
@@ -44,10 +45,16 @@ NS_LOG_COMPONENT_DEFINE ("Rip");
 
 NS_OBJECT_ENSURE_REGISTERED (Rip);
 
+Rip::Route::Route ()
+  : entry (0), queued (false)
+{
+}
+
 Rip::Rip ()
   : m_ipv4 (0), m_splitHorizonStrategy (Rip::POISON_REVERSE), m_initialized (false)
 {
   m_rng = CreateObject<UniformRandomVariable> ();
+  m_timerWheel = CreateObject<TimerWheel> ();
 }
 
 Rip::~Rip ()
@@ -375,9 +382,9 @@ void Rip::NotifyInterfaceDown (uint32_t interface)
   /* remove all routes that are going through this interface */
   for (RoutesI it = m_routes.begin (); it != m_routes.end (); it++)
     {
-      if (it->first->GetInterface () == interface)
+      if (it->entry->GetInterface () == interface)
         {
-          InvalidateRoute (it->first);
+          InvalidateRoute (it);
         }
     }
 
@@ -445,12 +452,12 @@ void Rip::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address)
   // which reference this network
   for (RoutesI it = m_routes.begin (); it != m_routes.end (); it++)
     {
-      if (it->first->GetInterface () == interface
-          && it->first->IsNetwork ()
-          && it->first->GetDestNetwork () == networkAddress
-          && it->first->GetDestNetworkMask () == networkMask)
+      if (it->entry->GetInterface () == interface
+          && it->entry->IsNetwork ()
+          && it->entry->GetDestNetwork () == networkAddress
+          && it->entry->GetDestNetworkMask () == networkMask)
         {
-          InvalidateRoute (it->first);
+          InvalidateRoute (it);
         }
     }
 
@@ -498,7 +505,7 @@ void Rip::PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Unit unit) c
       *os << "Destination     Gateway         Genmask         Flags Metric Ref    Use Iface" << std::endl;
       for (RoutesCI it = m_routes.begin (); it != m_routes.end (); it++)
         {
-          RipRoutingTableEntry* route = it->first;
+          RipRoutingTableEntry* route = it->entry;
           RipRoutingTableEntry::Status_e status = route->GetRouteStatus();
 
           if (status == RipRoutingTableEntry::RIP_VALID)
@@ -544,11 +551,16 @@ void Rip::DoDispose ()
 {
   NS_LOG_FUNCTION (this);
 
+  m_routesIndex.Clear ();
+  m_changedRoutes.clear ();
+  m_deletedRoutes.clear ();
   for (RoutesI j = m_routes.begin ();  j != m_routes.end (); j = m_routes.erase (j))
     {
-      delete j->first;
+      delete j->entry;
     }
   m_routes.clear ();
+  m_timerWheel->Dispose ();
+  m_timerWheel = 0;
 
   m_nextTriggeredUpdate.Cancel ();
   m_nextUnsolicitedUpdate.Cancel ();
@@ -575,7 +587,6 @@ Ptr<Ipv4Route> Rip::Lookup (Ipv4Address dst, Ptr<NetDevice> interface)
   NS_LOG_FUNCTION (this << dst << interface);
 
   Ptr<Ipv4Route> rtentry = 0;
-  uint16_t longestMask = 0;
 
   /* when sending on local multicast, there have to be interface specified */
   if (dst.IsLocalMulticast ())
@@ -589,50 +600,45 @@ Ptr<Ipv4Route> Rip::Lookup (Ipv4Address dst, Ptr<NetDevice> interface)
       return rtentry;
     }
 
-  for (RoutesI it = m_routes.begin (); it != m_routes.end (); it++)
-    {
-      RipRoutingTableEntry* j = it->first;
+  uint8_t dstBytes[4];
+  dst.Serialize (dstBytes);
+  std::vector<const RoutesIndex::Entries *> matches;
+  m_routesIndex.FindMatches (dstBytes, matches);
 
-      if (j->GetRouteStatus () == RipRoutingTableEntry::RIP_VALID)
+  // the longest prefix first; among the routes to a prefix, the last one in the table wins
+  for (uint32_t i = 0; i < matches.size () && !rtentry; i++)
+    {
+      for (RoutesIndex::Entries::const_reverse_iterator it = matches[i]->rbegin (); it != matches[i]->rend (); it++)
         {
-          Ipv4Mask mask = j->GetDestNetworkMask ();
-          uint16_t maskLen = mask.GetPrefixLength ();
-          Ipv4Address entry = j->GetDestNetwork ();
+          RipRoutingTableEntry* j = it->value->entry;
 
-          NS_LOG_LOGIC ("Searching for route to " << dst << ", mask length " << maskLen);
-
-          if (mask.IsMatch (dst, entry))
+          if (j->GetRouteStatus () != RipRoutingTableEntry::RIP_VALID)
             {
-              NS_LOG_LOGIC ("Found global network route " << j << ", mask length " << maskLen);
-
-              /* if interface is given, check the route will output on this interface */
-              if (!interface || interface == m_ipv4->GetNetDevice (j->GetInterface ()))
-                {
-                  if (maskLen < longestMask)
-                    {
-                      NS_LOG_LOGIC ("Previous match longer, skipping");
-                      continue;
-                    }
-
-                  longestMask = maskLen;
+              continue;
+            }
 
-                  Ipv4RoutingTableEntry* route = j;
-                  uint32_t interfaceIdx = route->GetInterface ();
-                  rtentry = Create<Ipv4Route> ();
+          NS_LOG_LOGIC ("Found global network route " << j << ", mask length " << j->GetDestNetworkMask ().GetPrefixLength ());
 
-                  if (route->GetDest ().IsAny ()) /* default route */
-                    {
-                      rtentry->SetSource (m_ipv4->SourceAddressSelection (interfaceIdx, route->GetGateway ()));
-                    }
-                  else
-                    {
-                      rtentry->SetSource (m_ipv4->SourceAddressSelection (interfaceIdx, route->GetDest ()));
-                    }
+          /* if interface is given, check the route will output on this interface */
+          if (!interface || interface == m_ipv4->GetNetDevice (j->GetInterface ()))
+            {
+              Ipv4RoutingTableEntry* route = j;
+              uint32_t interfaceIdx = route->GetInterface ();
+              rtentry = Create<Ipv4Route> ();
 
-                  rtentry->SetDestination (route->GetDest ());
-                  rtentry->SetGateway (route->GetGateway ());
-                  rtentry->SetOutputDevice (m_ipv4->GetNetDevice (interfaceIdx));
+              if (route->GetDest ().IsAny ()) /* default route */
+                {
+                  rtentry->SetSource (m_ipv4->SourceAddressSelection (interfaceIdx, route->GetGateway ()));
+                }
+              else
+                {
+                  rtentry->SetSource (m_ipv4->SourceAddressSelection (interfaceIdx, route->GetDest ()));
                 }
+
+              rtentry->SetDestination (route->GetDest ());
+              rtentry->SetGateway (route->GetGateway ());
+              rtentry->SetOutputDevice (m_ipv4->GetNetDevice (interfaceIdx));
+              break;
             }
         }
     }
@@ -651,9 +657,8 @@ void Rip::AddNetworkRouteTo (Ipv4Address network, Ipv4Mask networkPrefix, Ipv4Ad
   RipRoutingTableEntry* route = new RipRoutingTableEntry (network, networkPrefix, nextHop, interface);
   route->SetRouteMetric (1);
   route->SetRouteStatus (RipRoutingTableEntry::RIP_VALID);
-  route->SetRouteChanged (true);
 
-  m_routes.push_back (std::make_pair (route, EventId ()));
+  QueueChangedRoute (InsertRoute (route, false));
 }
 
 void Rip::AddNetworkRouteTo (Ipv4Address network, Ipv4Mask networkPrefix, uint32_t interface)
@@ -663,47 +668,78 @@ void Rip::AddNetworkRouteTo (Ipv4Address network, Ipv4Mask networkPrefix, uint32
   RipRoutingTableEntry* route = new RipRoutingTableEntry (network, networkPrefix, interface);
   route->SetRouteMetric (1);
   route->SetRouteStatus (RipRoutingTableEntry::RIP_VALID);
-  route->SetRouteChanged (true);
 
-  m_routes.push_back (std::make_pair (route, EventId ()));
+  QueueChangedRoute (InsertRoute (route, false));
 }
 
-void Rip::InvalidateRoute (RipRoutingTableEntry *route)
+Rip::RoutesI Rip::InsertRoute (RipRoutingTableEntry *route, bool front)
 {
-  NS_LOG_FUNCTION (this << *route);
+  NS_LOG_FUNCTION (this << *route << front);
 
-  for (RoutesI it = m_routes.begin (); it != m_routes.end (); it++)
+  RoutesI it;
+  if (front)
     {
-      if (it->first == route)
-        {
-          route->SetRouteStatus (RipRoutingTableEntry::RIP_INVALID);
-          route->SetRouteMetric (m_linkDown);
-          route->SetRouteChanged (true);
-          if (it->second.IsRunning ())
-            {
-              it->second.Cancel ();
-            }
-          it->second = Simulator::Schedule (m_garbageCollectionDelay, &Rip::DeleteRoute, this, route);
-          return;
-        }
+      m_routes.emplace_front ();
+      it = m_routes.begin ();
     }
-  NS_ABORT_MSG ("RIP::InvalidateRoute - cannot find the route to update");
+  else
+    {
+      m_routes.emplace_back ();
+      it = --m_routes.end ();
+    }
+  it->entry = route;
+  it->timer.SetWheel (m_timerWheel);
+
+  uint8_t prefix[4];
+  route->GetDestNetwork ().Serialize (prefix);
+  m_routesIndex.Insert (prefix, route->GetDestNetworkMask ().GetPrefixLength (), it, front);
+  return it;
 }
 
-void Rip::DeleteRoute (RipRoutingTableEntry *route)
+void Rip::QueueChangedRoute (RoutesI route)
 {
-  NS_LOG_FUNCTION (this << *route);
+  NS_LOG_FUNCTION (this << *route->entry);
 
-  for (RoutesI it = m_routes.begin (); it != m_routes.end (); it++)
+  route->entry->SetRouteChanged (true);
+  if (!route->queued)
     {
-      if (it->first == route)
-        {
-          delete route;
-          m_routes.erase (it);
-          return;
-        }
+      route->queued = true;
+      m_changedRoutes.push_back (route);
+    }
+}
+
+void Rip::InvalidateRoute (RoutesI route)
+{
+  NS_LOG_FUNCTION (this << *route->entry);
+
+  route->entry->SetRouteStatus (RipRoutingTableEntry::RIP_INVALID);
+  route->entry->SetRouteMetric (m_linkDown);
+  QueueChangedRoute (route);
+  route->timer.Schedule (m_garbageCollectionDelay, &Rip::DeleteRoute, this, route);
+}
+
+void Rip::DeleteRoute (RoutesI route)
+{
+  NS_LOG_FUNCTION (this << *route->entry);
+
+  uint8_t prefix[4];
+  route->entry->GetDestNetwork ().Serialize (prefix);
+  if (!m_routesIndex.Remove (prefix, route->entry->GetDestNetworkMask ().GetPrefixLength (), route))
+    {
+      NS_ABORT_MSG ("RIP::DeleteRoute - cannot find the route to delete");
+    }
+
+  delete route->entry;
+  if (route->queued)
+    {
+      // the next update skips the route and frees it
+      route->entry = 0;
+      m_deletedRoutes.splice (m_deletedRoutes.end (), m_routes, route);
+    }
+  else
+    {
+      m_routes.erase (route);
     }
-  NS_ABORT_MSG ("RIP::DeleteRoute - cannot find the route to delete");
 }
 
 
@@ -815,30 +851,30 @@ void Rip::HandleRequests (RipHeader requestHdr, Ipv4Address senderAddress, uint1
 
               for (RoutesI rtIter = m_routes.begin (); rtIter != m_routes.end (); rtIter++)
                 {
-                  bool splitHorizoning = (rtIter->first->GetInterface () == incomingInterface);
+                  bool splitHorizoning = (rtIter->entry->GetInterface () == incomingInterface);
 
-                  Ipv4InterfaceAddress rtDestAddr = Ipv4InterfaceAddress(rtIter->first->GetDestNetwork (), rtIter->first->GetDestNetworkMask ());
+                  Ipv4InterfaceAddress rtDestAddr = Ipv4InterfaceAddress(rtIter->entry->GetDestNetwork (), rtIter->entry->GetDestNetworkMask ());
 
                   bool isGlobal = (rtDestAddr.GetScope () == Ipv4InterfaceAddress::GLOBAL);
-                  bool isDefaultRoute = ((rtIter->first->GetDestNetwork () == Ipv4Address::GetAny ()) &&
-                      (rtIter->first->GetDestNetworkMask () == Ipv4Mask::GetZero ()) &&
-                      (rtIter->first->GetInterface () != incomingInterface));
+                  bool isDefaultRoute = ((rtIter->entry->GetDestNetwork () == Ipv4Address::GetAny ()) &&
+                      (rtIter->entry->GetDestNetworkMask () == Ipv4Mask::GetZero ()) &&
+                      (rtIter->entry->GetInterface () != incomingInterface));
 
                   if ((isGlobal || isDefaultRoute) &&
-                      (rtIter->first->GetRouteStatus () == RipRoutingTableEntry::RIP_VALID) )
+                      (rtIter->entry->GetRouteStatus () == RipRoutingTableEntry::RIP_VALID) )
                     {
                       RipRte rte;
-                      rte.SetPrefix (rtIter->first->GetDestNetwork ());
-                      rte.SetSubnetMask (rtIter->first->GetDestNetworkMask ());
+                      rte.SetPrefix (rtIter->entry->GetDestNetwork ());
+                      rte.SetSubnetMask (rtIter->entry->GetDestNetworkMask ());
                       if (m_splitHorizonStrategy == POISON_REVERSE && splitHorizoning)
                         {
                           rte.SetRouteMetric (m_linkDown);
                         }
                       else
                         {
-                          rte.SetRouteMetric (rtIter->first->GetRouteMetric ());
+                          rte.SetRouteMetric (rtIter->entry->GetRouteMetric ());
                         }
-                      rte.SetRouteTag (rtIter->first->GetRouteTag ());
+                      rte.SetRouteTag (rtIter->entry->GetRouteTag ());
                       if ((m_splitHorizonStrategy != SPLIT_HORIZON) ||
                           (m_splitHorizonStrategy == SPLIT_HORIZON && !splitHorizoning))
                         {
@@ -890,19 +926,19 @@ void Rip::HandleRequests (RipHeader requestHdr, Ipv4Address senderAddress, uint1
           for (RoutesI rtIter = m_routes.begin (); rtIter != m_routes.end (); rtIter++)
             {
 
-              Ipv4InterfaceAddress rtDestAddr = Ipv4InterfaceAddress (rtIter->first->GetDestNetwork (), rtIter->first->GetDestNetworkMask ());
+              Ipv4InterfaceAddress rtDestAddr = Ipv4InterfaceAddress (rtIter->entry->GetDestNetwork (), rtIter->entry->GetDestNetworkMask ());
               if ((rtDestAddr.GetScope () == Ipv4InterfaceAddress::GLOBAL) &&
-                  (rtIter->first->GetRouteStatus () == RipRoutingTableEntry::RIP_VALID))
+                  (rtIter->entry->GetRouteStatus () == RipRoutingTableEntry::RIP_VALID))
                 {
                   Ipv4Address requestedAddress = iter->GetPrefix ();
                   requestedAddress.CombineMask (iter->GetSubnetMask ());
-                  Ipv4Address rtAddress = rtIter->first->GetDestNetwork ();
-                  rtAddress.CombineMask (rtIter->first->GetDestNetworkMask ());
+                  Ipv4Address rtAddress = rtIter->entry->GetDestNetwork ();
+                  rtAddress.CombineMask (rtIter->entry->GetDestNetworkMask ());
 
                   if (requestedAddress == rtAddress)
                     {
-                      iter->SetRouteMetric (rtIter->first->GetRouteMetric ());
-                      iter->SetRouteTag (rtIter->first->GetRouteTag ());
+                      iter->SetRouteMetric (rtIter->entry->GetRouteMetric ());
+                      iter->SetRouteTag (rtIter->entry->GetRouteTag ());
                       hdr.AddRte (*iter);
                       found = true;
                       break;
@@ -974,71 +1010,74 @@ void Rip::HandleResponses (RipHeader hdr, Ipv4Address senderAddress, uint32_t in
           rteMetric = m_linkDown;
         }
 
-      RoutesI it;
+      uint8_t prefix[4];
+      rteAddr.Serialize (prefix);
+      const RoutesIndex::Entries *routes = m_routesIndex.Find (prefix, rtePrefixMask.GetPrefixLength ());
+
       bool found = false;
-      for (it = m_routes.begin (); it != m_routes.end (); it++)
+      if (routes)
         {
-          if (it->first->GetDestNetwork () == rteAddr &&
-              it->first->GetDestNetworkMask () == rtePrefixMask)
+          for (RoutesIndex::Entries::const_iterator rtIter = routes->begin (); rtIter != routes->end (); rtIter++)
             {
-              found = true;
-              if (rteMetric < it->first->GetRouteMetric ())
-                {
-                  if (senderAddress != it->first->GetGateway ())
-                    {
-                      RipRoutingTableEntry* route = new RipRoutingTableEntry (rteAddr, rtePrefixMask, senderAddress, incomingInterface);
-                      delete it->first;
-                      it->first = route;
-                    }
-                  it->first->SetRouteMetric (rteMetric);
-                  it->first->SetRouteStatus (RipRoutingTableEntry::RIP_VALID);
-                  it->first->SetRouteTag (iter->GetRouteTag ());
-                  it->first->SetRouteChanged (true);
-                  it->second.Cancel ();
-                  it->second = Simulator::Schedule (m_timeoutDelay, &Rip::InvalidateRoute, this, it->first);
-                  changed = true;
-                }
-              else if (rteMetric == it->first->GetRouteMetric ())
+              RoutesI it = rtIter->value;
+              if (it->entry->GetDestNetwork () == rteAddr &&
+                  it->entry->GetDestNetworkMask () == rtePrefixMask)
                 {
-                  if (senderAddress == it->first->GetGateway ())
+                  found = true;
+                  if (rteMetric < it->entry->GetRouteMetric ())
                     {
-                      it->second.Cancel ();
-                      it->second = Simulator::Schedule (m_timeoutDelay, &Rip::InvalidateRoute, this, it->first);
-                    }
-                  else
-                    {
-                      if (Simulator::GetDelayLeft (it->second) < m_timeoutDelay/2)
+                      if (senderAddress != it->entry->GetGateway ())
                         {
                           RipRoutingTableEntry* route = new RipRoutingTableEntry (rteAddr, rtePrefixMask, senderAddress, incomingInterface);
-                          route->SetRouteMetric (rteMetric);
-                          route->SetRouteStatus (RipRoutingTableEntry::RIP_VALID);
-                          route->SetRouteTag (iter->GetRouteTag ());
-                          route->SetRouteChanged (true);
-                          delete it->first;
-                          it->first = route;
-                          it->second.Cancel ();
-                          it->second = Simulator::Schedule (m_timeoutDelay, &Rip::InvalidateRoute, this, route);
-                          changed = true;
+                          delete it->entry;
+                          it->entry = route;
                         }
+                      it->entry->SetRouteMetric (rteMetric);
+                      it->entry->SetRouteStatus (RipRoutingTableEntry::RIP_VALID);
+                      it->entry->SetRouteTag (iter->GetRouteTag ());
+                      QueueChangedRoute (it);
+                      it->timer.Schedule (m_timeoutDelay, &Rip::InvalidateRoute, this, it);
+                      changed = true;
                     }
-                }
-              else if (rteMetric > it->first->GetRouteMetric () && senderAddress == it->first->GetGateway ())
-                {
-                  it->second.Cancel ();
-                  if (rteMetric < m_linkDown)
+                  else if (rteMetric == it->entry->GetRouteMetric ())
                     {
-                      it->first->SetRouteMetric (rteMetric);
-                      it->first->SetRouteStatus (RipRoutingTableEntry::RIP_VALID);
-                      it->first->SetRouteTag (iter->GetRouteTag ());
-                      it->first->SetRouteChanged (true);
-                      it->second.Cancel ();
-                      it->second = Simulator::Schedule (m_timeoutDelay, &Rip::InvalidateRoute, this, it->first);
+                      if (senderAddress == it->entry->GetGateway ())
+                        {
+                          it->timer.Schedule (m_timeoutDelay, &Rip::InvalidateRoute, this, it);
+                        }
+                      else
+                        {
+                          if (it->timer.GetDelayLeft () < m_timeoutDelay/2)
+                            {
+                              RipRoutingTableEntry* route = new RipRoutingTableEntry (rteAddr, rtePrefixMask, senderAddress, incomingInterface);
+                              route->SetRouteMetric (rteMetric);
+                              route->SetRouteStatus (RipRoutingTableEntry::RIP_VALID);
+                              route->SetRouteTag (iter->GetRouteTag ());
+                              delete it->entry;
+                              it->entry = route;
+                              QueueChangedRoute (it);
+                              it->timer.Schedule (m_timeoutDelay, &Rip::InvalidateRoute, this, it);
+                              changed = true;
+                            }
+                        }
                     }
-                  else
+                  else if (rteMetric > it->entry->GetRouteMetric () && senderAddress == it->entry->GetGateway ())
                     {
-                      InvalidateRoute (it->first);
+                      it->timer.Cancel ();
+                      if (rteMetric < m_linkDown)
+                        {
+                          it->entry->SetRouteMetric (rteMetric);
+                          it->entry->SetRouteStatus (RipRoutingTableEntry::RIP_VALID);
+                          it->entry->SetRouteTag (iter->GetRouteTag ());
+                          QueueChangedRoute (it);
+                          it->timer.Schedule (m_timeoutDelay, &Rip::InvalidateRoute, this, it);
+                        }
+                      else
+                        {
+                          InvalidateRoute (it);
+                        }
+                      changed = true;
                     }
-                  changed = true;
                 }
             }
         }
@@ -1049,10 +1088,9 @@ void Rip::HandleResponses (RipHeader hdr, Ipv4Address senderAddress, uint32_t in
           RipRoutingTableEntry* route = new RipRoutingTableEntry (rteAddr, rtePrefixMask, senderAddress, incomingInterface);
           route->SetRouteMetric (rteMetric);
           route->SetRouteStatus (RipRoutingTableEntry::RIP_VALID);
-          route->SetRouteChanged (true);
-          m_routes.push_front (std::make_pair (route, EventId ()));
-          EventId invalidateEvent = Simulator::Schedule (m_timeoutDelay, &Rip::InvalidateRoute, this, route);
-          (m_routes.begin ())->second = invalidateEvent;
+          RoutesI it = InsertRoute (route, true);
+          QueueChangedRoute (it);
+          it->timer.Schedule (m_timeoutDelay, &Rip::InvalidateRoute, this, it);
           changed = true;
         }
     }
@@ -1067,6 +1105,27 @@ void Rip::DoSendRouteUpdate (bool periodic)
 {
   NS_LOG_FUNCTION (this << (periodic ? " periodic" : " triggered"));
 
+  // a periodic update sends the whole table, a triggered one the queued routes
+  std::vector<RipRoutingTableEntry *> routes;
+  if (periodic)
+    {
+      routes.reserve (m_routes.size ());
+      for (RoutesI rtIter = m_routes.begin (); rtIter != m_routes.end (); rtIter++)
+        {
+          routes.push_back (rtIter->entry);
+        }
+    }
+  else
+    {
+      for (std::vector<RoutesI>::iterator rtIter = m_changedRoutes.begin (); rtIter != m_changedRoutes.end (); rtIter++)
+        {
+          if ((*rtIter)->entry != 0 && (*rtIter)->entry->IsRouteChanged ())
+            {
+              routes.push_back ((*rtIter)->entry);
+            }
+        }
+    }
+
   for (SocketListI iter = m_sendSocketList.begin (); iter != m_sendSocketList.end (); iter++ )
     {
       uint32_t interface = iter->second;
@@ -1084,44 +1143,44 @@ void Rip::DoSendRouteUpdate (bool periodic)
           RipHeader hdr;
           hdr.SetCommand (RipHeader::RESPONSE);
 
-          for (RoutesI rtIter = m_routes.begin (); rtIter != m_routes.end (); rtIter++)
+          for (std::vector<RipRoutingTableEntry *>::iterator rtIter = routes.begin (); rtIter != routes.end (); rtIter++)
             {
-              bool splitHorizoning = (rtIter->first->GetInterface () == interface);
-              Ipv4InterfaceAddress rtDestAddr = Ipv4InterfaceAddress(rtIter->first->GetDestNetwork (), rtIter->first->GetDestNetworkMask ());
+              bool splitHorizoning = ((*rtIter)->GetInterface () == interface);
+              Ipv4InterfaceAddress rtDestAddr = Ipv4InterfaceAddress((*rtIter)->GetDestNetwork (), (*rtIter)->GetDestNetworkMask ());
 
-              NS_LOG_DEBUG ("Processing RT " << rtDestAddr << " " << int(rtIter->first->IsRouteChanged ()));
+              NS_LOG_DEBUG ("Processing RT " << rtDestAddr << " " << int((*rtIter)->IsRouteChanged ()));
 
               bool isGlobal = (rtDestAddr.GetScope () == Ipv4InterfaceAddress::GLOBAL);
-              bool isDefaultRoute = ((rtIter->first->GetDestNetwork () == Ipv4Address::GetAny ()) &&
-                  (rtIter->first->GetDestNetworkMask () == Ipv4Mask::GetZero ()) &&
-                  (rtIter->first->GetInterface () != interface));
+              bool isDefaultRoute = (((*rtIter)->GetDestNetwork () == Ipv4Address::GetAny ()) &&
+                  ((*rtIter)->GetDestNetworkMask () == Ipv4Mask::GetZero ()) &&
+                  ((*rtIter)->GetInterface () != interface));
 
               bool sameNetwork = false;
               for (uint32_t index = 0; index < m_ipv4->GetNAddresses (interface); index++)
                 {
                   Ipv4InterfaceAddress addr = m_ipv4->GetAddress (interface, index);
-                  if (addr.GetLocal ().CombineMask (addr.GetMask ()) == rtIter->first->GetDestNetwork ())
+                  if (addr.GetLocal ().CombineMask (addr.GetMask ()) == (*rtIter)->GetDestNetwork ())
                     {
                       sameNetwork = true;
                     }
                 }
 
               if ((isGlobal || isDefaultRoute) &&
-                  (periodic || rtIter->first->IsRouteChanged ()) &&
+                  (periodic || (*rtIter)->IsRouteChanged ()) &&
                   !sameNetwork)
                 {
                   RipRte rte;
-                  rte.SetPrefix (rtIter->first->GetDestNetwork ());
-                  rte.SetSubnetMask (rtIter->first->GetDestNetworkMask ());
+                  rte.SetPrefix ((*rtIter)->GetDestNetwork ());
+                  rte.SetSubnetMask ((*rtIter)->GetDestNetworkMask ());
                   if (m_splitHorizonStrategy == POISON_REVERSE && splitHorizoning)
                     {
                       rte.SetRouteMetric (m_linkDown);
                     }
                   else
                     {
-                      rte.SetRouteMetric (rtIter->first->GetRouteMetric ());
+                      rte.SetRouteMetric ((*rtIter)->GetRouteMetric ());
                     }
-                  rte.SetRouteTag (rtIter->first->GetRouteTag ());
+                  rte.SetRouteTag ((*rtIter)->GetRouteTag ());
                   if (m_splitHorizonStrategy == SPLIT_HORIZON && !splitHorizoning)
                     {
                       hdr.AddRte (rte);
@@ -1148,10 +1207,16 @@ void Rip::DoSendRouteUpdate (bool periodic)
             }
         }
     }
-  for (RoutesI rtIter = m_routes.begin (); rtIter != m_routes.end (); rtIter++)
+  for (std::vector<RipRoutingTableEntry *>::iterator rtIter = routes.begin (); rtIter != routes.end (); rtIter++)
     {
-      rtIter->first->SetRouteChanged (false);
+      (*rtIter)->SetRouteChanged (false);
     }
+  for (std::vector<RoutesI>::iterator rtIter = m_changedRoutes.begin (); rtIter != m_changedRoutes.end (); rtIter++)
+    {
+      (*rtIter)->queued = false;
+    }
+  m_changedRoutes.clear ();
+  m_deletedRoutes.clear ();
 }
 
 void Rip::SendTriggeredRouteUpdate ()
@@ -1175,12 +1240,17 @@ void Rip::SendTriggeredRouteUpdate ()
   //     and 5 seconds.  Triggered updates may be suppressed if a regular
   //     update is due by the time the triggered update would be sent.
   // Here we rely on this:
-  // When an update occurs (either Triggered or Periodic) the "IsChanged ()"
-  // route field will be cleared.
-  // Hence, the following Triggered Update will be fired, but will not send
-  // any route update.
+  // When a route changes, it is queued until the next update (either
+  // Triggered or Periodic), which clears the queue and the "IsChanged ()"
+  // route field. Hence, the following Triggered Update only sends the routes
+  // changed since the previous update, if any.
 
   Time delay = Seconds (m_rng->GetValue (m_minTriggeredUpdateDelay.GetSeconds (), m_maxTriggeredUpdateDelay.GetSeconds ()));
+  if (m_nextUnsolicitedUpdate.IsRunning () && Simulator::GetDelayLeft (m_nextUnsolicitedUpdate) <= delay)
+    {
+      NS_LOG_LOGIC ("Suppressing Triggered Update, an Unsolicited Update is due before");
+      return;
+    }
   m_nextTriggeredUpdate = Simulator::Schedule (delay, &Rip::DoSendRouteUpdate, this, false);
 }
 
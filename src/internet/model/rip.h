@@ -22,6 +22,7 @@
 #define RIP_H
 
 #include <list>
+#include <vector>
 
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/ipv4-interface.h"
@@ -30,6 +31,8 @@
 #include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/random-variable-stream.h"
 #include "ns3/rip-header.h"
+#include "ns3/prefix-trie.h"
+#include "ns3/timer-wheel.h"
 
 namespace ns3 {
 
@@ -52,6 +55,13 @@ namespace ns3 {
  * Even with triggered updates, the convergence is in the order of magnitude of
  * O(|V|*|E|) * 5 seconds, which is still quite long for complex topologies.
  *
+ * The routes are indexed by destination prefix (see PrefixTrie), so that
+ * the lookups do not depend on the size of the routing table, and their
+ * timeouts are armed in a TimerWheel of the router, so that refreshing a
+ * route does not schedule any event. The routes changed between two updates
+ * are queued, and a Triggered Update only sends the queued routes; it is
+ * suppressed if the next Unsolicited Update is due before it.
+ *
  * \todo: Add routing table compression (CIDR). The most evident result: without
  * it a router will announce to be the default router *and* more RTEs, which is silly.
  */
@@ -264,14 +274,26 @@ protected:
   void DoInitialize ();
 
 private:
-  /// Container for the network routes - pair RipRoutingTableEntry *, EventId (update event)
-  typedef std::list<std::pair <RipRoutingTableEntry *, EventId> > Routes;
+  /// A network route and its timer
+  struct Route
+  {
+    Route ();
+    RipRoutingTableEntry *entry; //!< the route
+    WheelTimer timer;            //!< timer invalidating or deleting the route
+    bool queued;                 //!< true if the route is in the triggered update queue
+  };
+
+  /// Container for the network routes
+  typedef std::list<Route> Routes;
 
   /// Const Iterator for container for the network routes
-  typedef std::list<std::pair <RipRoutingTableEntry *, EventId> >::const_iterator RoutesCI;
+  typedef std::list<Route>::const_iterator RoutesCI;
 
   /// Iterator for container for the network routes
-  typedef std::list<std::pair <RipRoutingTableEntry *, EventId> >::iterator RoutesI;
+  typedef std::list<Route>::iterator RoutesI;
+
+  /// Index of the network routes by destination prefix
+  typedef PrefixTrie<RoutesI, 4> RoutesIndex;
 
 
   /**
@@ -359,19 +381,41 @@ private:
    */
   void SendUnsolicitedRouteUpdate (void);
 
+  /**
+   * \brief Add a route to the table and to its index.
+   * \param route the route
+   * \param front true to add the route at the front of the table
+   * \returns the route in the table
+   */
+  RoutesI InsertRoute (RipRoutingTableEntry *route, bool front);
+
+  /**
+   * \brief Mark a route as changed and queue it for the next Triggered Update.
+   * \param route the route
+   */
+  void QueueChangedRoute (RoutesI route);
+
   /**
    * \brief Invalidate a route.
    * \param route the route to be removed
    */
-  void InvalidateRoute (RipRoutingTableEntry *route);
+  void InvalidateRoute (RoutesI route);
 
   /**
    * \brief Delete a route.
+   *
+   * A route still in the triggered update queue is kept, without its
+   * entry, in m_deletedRoutes until the next update.
+   *
    * \param route the route to be removed
    */
-  void DeleteRoute (RipRoutingTableEntry *route);
+  void DeleteRoute (RoutesI route);
 
   Routes m_routes; //!<  the forwarding table for network.
+  RoutesIndex m_routesIndex; //!< the routes, indexed by destination prefix
+  std::vector<RoutesI> m_changedRoutes; //!< the routes changed since the last update
+  Routes m_deletedRoutes; //!< the deleted routes still in m_changedRoutes
+  Ptr<TimerWheel> m_timerWheel; //!< the wheel of the timers of the routes
   Ptr<Ipv4> m_ipv4; //!< IPv4 reference
   Time m_startupDelay; //!< Random delay before protocol startup.
   Time m_minTriggeredUpdateDelay; //!< Min cooldown delay after a Triggered Update.
@@ -19,6 +19,7 @@
  */
 
 #include <iomanip>
+#include <algorithm>
 #include "ripng.h"
 #include "ns3/log.h"
 #include "ns3/abort.h"
@@ -44,10 +45,16 @@ NS_LOG_COMPONENT_DEFINE ("RipNg");
 
 NS_OBJECT_ENSURE_REGISTERED (RipNg);
 
+RipNg::Route::Route ()
+  : entry (0), queued (false)
+{
+}
+
 RipNg::RipNg ()
   : m_ipv6 (0), m_splitHorizonStrategy (RipNg::POISON_REVERSE), m_initialized (false)
 {
   m_rng = CreateObject<UniformRandomVariable> ();
+  m_timerWheel = CreateObject<TimerWheel> ();
 }
 
 RipNg::~RipNg ()
@@ -347,9 +354,9 @@ void RipNg::NotifyInterfaceDown (uint32_t interface)
   /* remove all routes that are going through this interface */
   for (RoutesI it = m_routes.begin (); it != m_routes.end (); it++)
     {
-      if (it->first->GetInterface () == interface)
+      if (it->entry->GetInterface () == interface)
         {
-          InvalidateRoute (it->first);
+          InvalidateRoute (it);
         }
     }
 
@@ -417,12 +424,12 @@ void RipNg::NotifyRemoveAddress (uint32_t interface, Ipv6InterfaceAddress addres
   // which reference this network
   for (RoutesI it = m_routes.begin (); it != m_routes.end (); it++)
     {
-      if (it->first->GetInterface () == interface
-          && it->first->IsNetwork ()
-          && it->first->GetDestNetwork () == networkAddress
-          && it->first->GetDestNetworkPrefix () == networkMask)
+      if (it->entry->GetInterface () == interface
+          && it->entry->IsNetwork ()
+          && it->entry->GetDestNetwork () == networkAddress
+          && it->entry->GetDestNetworkPrefix () == networkMask)
         {
-          InvalidateRoute (it->first);
+          InvalidateRoute (it);
         }
     }
 
@@ -482,7 +489,7 @@ void RipNg::PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Unit unit)
       *os << "Destination                    Next Hop                   Flag Met Ref Use If" << std::endl;
       for (RoutesCI it = m_routes.begin (); it != m_routes.end (); it++)
         {
-          RipNgRoutingTableEntry* route = it->first;
+          RipNgRoutingTableEntry* route = it->entry;
           RipNgRoutingTableEntry::Status_e status = route->GetRouteStatus();
 
           if (status == RipNgRoutingTableEntry::RIPNG_VALID)
@@ -527,11 +534,16 @@ void RipNg::DoDispose ()
 {
   NS_LOG_FUNCTION (this);
 
+  m_routesIndex.Clear ();
+  m_changedRoutes.clear ();
+  m_deletedRoutes.clear ();
   for (RoutesI j = m_routes.begin ();  j != m_routes.end (); j = m_routes.erase (j))
     {
-      delete j->first;
+      delete j->entry;
     }
   m_routes.clear ();
+  m_timerWheel->Dispose ();
+  m_timerWheel = 0;
 
   m_nextTriggeredUpdate.Cancel ();
   m_nextUnsolicitedUpdate.Cancel ();
@@ -558,7 +570,6 @@ Ptr<Ipv6Route> RipNg::Lookup (Ipv6Address dst, Ptr<NetDevice> interface)
   NS_LOG_FUNCTION (this << dst << interface);
 
   Ptr<Ipv6Route> rtentry = 0;
-  uint16_t longestMask = 0;
 
   /* when sending on link-local multicast, there have to be interface specified */
   if (dst.IsLinkLocalMulticast ())
@@ -572,54 +583,49 @@ Ptr<Ipv6Route> RipNg::Lookup (Ipv6Address dst, Ptr<NetDevice> interface)
       return rtentry;
     }
 
-  for (RoutesI it = m_routes.begin (); it != m_routes.end (); it++)
-    {
-      RipNgRoutingTableEntry* j = it->first;
+  uint8_t dstBytes[16];
+  dst.GetBytes (dstBytes);
+  std::vector<const RoutesIndex::Entries *> matches;
+  m_routesIndex.FindMatches (dstBytes, matches);
 
-      if (j->GetRouteStatus () == RipNgRoutingTableEntry::RIPNG_VALID)
+  // the longest prefix first; among the routes to a prefix, the last one in the table wins
+  for (uint32_t i = 0; i < matches.size () && !rtentry; i++)
+    {
+      for (RoutesIndex::Entries::const_reverse_iterator it = matches[i]->rbegin (); it != matches[i]->rend (); it++)
         {
-          Ipv6Prefix mask = j->GetDestNetworkPrefix ();
-          uint16_t maskLen = mask.GetPrefixLength ();
-          Ipv6Address entry = j->GetDestNetwork ();
-
-          NS_LOG_LOGIC ("Searching for route to " << dst << ", mask length " << maskLen);
+          RipNgRoutingTableEntry* j = it->value->entry;
 
-          if (mask.IsMatch (dst, entry))
+          if (j->GetRouteStatus () != RipNgRoutingTableEntry::RIPNG_VALID)
             {
-              NS_LOG_LOGIC ("Found global network route " << j << ", mask length " << maskLen);
-
-              /* if interface is given, check the route will output on this interface */
-              if (!interface || interface == m_ipv6->GetNetDevice (j->GetInterface ()))
-                {
-                  if (maskLen < longestMask)
-                    {
-                      NS_LOG_LOGIC ("Previous match longer, skipping");
-                      continue;
-                    }
-
-                  longestMask = maskLen;
+              continue;
+            }
 
-                  Ipv6RoutingTableEntry* route = j;
-                  uint32_t interfaceIdx = route->GetInterface ();
-                  rtentry = Create<Ipv6Route> ();
+          NS_LOG_LOGIC ("Found global network route " << j << ", mask length " << j->GetDestNetworkPrefix ().GetPrefixLength ());
 
-                  if (route->GetGateway ().IsAny ())
-                    {
-                      rtentry->SetSource (m_ipv6->SourceAddressSelection (interfaceIdx, route->GetDest ()));
-                    }
-                  else if (route->GetDest ().IsAny ()) /* default route */
-                    {
-                      rtentry->SetSource (m_ipv6->SourceAddressSelection (interfaceIdx, route->GetPrefixToUse ().IsAny () ? dst : route->GetPrefixToUse ()));
-                    }
-                  else
-                    {
-                      rtentry->SetSource (m_ipv6->SourceAddressSelection (interfaceIdx, route->GetDest ()));
-                    }
+          /* if interface is given, check the route will output on this interface */
+          if (!interface || interface == m_ipv6->GetNetDevice (j->GetInterface ()))
+            {
+              Ipv6RoutingTableEntry* route = j;
+              uint32_t interfaceIdx = route->GetInterface ();
+              rtentry = Create<Ipv6Route> ();
 
-                  rtentry->SetDestination (route->GetDest ());
-                  rtentry->SetGateway (route->GetGateway ());
-                  rtentry->SetOutputDevice (m_ipv6->GetNetDevice (interfaceIdx));
+              if (route->GetGateway ().IsAny ())
+                {
+                  rtentry->SetSource (m_ipv6->SourceAddressSelection (interfaceIdx, route->GetDest ()));
                 }
+              else if (route->GetDest ().IsAny ()) /* default route */
+                {
+                  rtentry->SetSource (m_ipv6->SourceAddressSelection (interfaceIdx, route->GetPrefixToUse ().IsAny () ? dst : route->GetPrefixToUse ()));
+                }
+              else
+                {
+                  rtentry->SetSource (m_ipv6->SourceAddressSelection (interfaceIdx, route->GetDest ()));
+                }
+
+              rtentry->SetDestination (route->GetDest ());
+              rtentry->SetGateway (route->GetGateway ());
+              rtentry->SetOutputDevice (m_ipv6->GetNetDevice (interfaceIdx));
+              break;
             }
         }
     }
@@ -643,9 +649,8 @@ void RipNg::AddNetworkRouteTo (Ipv6Address network, Ipv6Prefix networkPrefix, Ip
   RipNgRoutingTableEntry* route = new RipNgRoutingTableEntry (network, networkPrefix, nextHop, interface, prefixToUse);
   route->SetRouteMetric (1);
   route->SetRouteStatus (RipNgRoutingTableEntry::RIPNG_VALID);
-  route->SetRouteChanged (true);
 
-  m_routes.push_back (std::make_pair (route, EventId ()));
+  QueueChangedRoute (InsertRoute (route, false));
 }
 
 void RipNg::AddNetworkRouteTo (Ipv6Address network, Ipv6Prefix networkPrefix, uint32_t interface)
@@ -655,47 +660,78 @@ void RipNg::AddNetworkRouteTo (Ipv6Address network, Ipv6Prefix networkPrefix, ui
   RipNgRoutingTableEntry* route = new RipNgRoutingTableEntry (network, networkPrefix, interface);
   route->SetRouteMetric (1);
   route->SetRouteStatus (RipNgRoutingTableEntry::RIPNG_VALID);
-  route->SetRouteChanged (true);
 
-  m_routes.push_back (std::make_pair (route, EventId ()));
+  QueueChangedRoute (InsertRoute (route, false));
 }
 
-void RipNg::InvalidateRoute (RipNgRoutingTableEntry *route)
+RipNg::RoutesI RipNg::InsertRoute (RipNgRoutingTableEntry *route, bool front)
 {
-  NS_LOG_FUNCTION (this << *route);
+  NS_LOG_FUNCTION (this << *route << front);
 
-  for (RoutesI it = m_routes.begin (); it != m_routes.end (); it++)
+  RoutesI it;
+  if (front)
     {
-      if (it->first == route)
-        {
-          route->SetRouteStatus (RipNgRoutingTableEntry::RIPNG_INVALID);
-          route->SetRouteMetric (m_linkDown);
-          route->SetRouteChanged (true);
-          if (it->second.IsRunning ())
-            {
-              it->second.Cancel ();
-            }
-          it->second = Simulator::Schedule (m_garbageCollectionDelay, &RipNg::DeleteRoute, this, route);
-          return;
-        }
+      m_routes.emplace_front ();
+      it = m_routes.begin ();
+    }
+  else
+    {
+      m_routes.emplace_back ();
+      it = --m_routes.end ();
     }
-  NS_ABORT_MSG ("Ripng::InvalidateRoute - cannot find the route to update");
+  it->entry = route;
+  it->timer.SetWheel (m_timerWheel);
+
+  uint8_t prefix[16];
+  route->GetDestNetwork ().GetBytes (prefix);
+  m_routesIndex.Insert (prefix, route->GetDestNetworkPrefix ().GetPrefixLength (), it, front);
+  return it;
 }
 
-void RipNg::DeleteRoute (RipNgRoutingTableEntry *route)
+void RipNg::QueueChangedRoute (RoutesI route)
 {
-  NS_LOG_FUNCTION (this << *route);
+  NS_LOG_FUNCTION (this << *route->entry);
 
-  for (RoutesI it = m_routes.begin (); it != m_routes.end (); it++)
+  route->entry->SetRouteChanged (true);
+  if (!route->queued)
     {
-      if (it->first == route)
-        {
-          delete route;
-          m_routes.erase (it);
-          return;
-        }
+      route->queued = true;
+      m_changedRoutes.push_back (route);
+    }
+}
+
+void RipNg::InvalidateRoute (RoutesI route)
+{
+  NS_LOG_FUNCTION (this << *route->entry);
+
+  route->entry->SetRouteStatus (RipNgRoutingTableEntry::RIPNG_INVALID);
+  route->entry->SetRouteMetric (m_linkDown);
+  QueueChangedRoute (route);
+  route->timer.Schedule (m_garbageCollectionDelay, &RipNg::DeleteRoute, this, route);
+}
+
+void RipNg::DeleteRoute (RoutesI route)
+{
+  NS_LOG_FUNCTION (this << *route->entry);
+
+  uint8_t prefix[16];
+  route->entry->GetDestNetwork ().GetBytes (prefix);
+  if (!m_routesIndex.Remove (prefix, route->entry->GetDestNetworkPrefix ().GetPrefixLength (), route))
+    {
+      NS_ABORT_MSG ("Ripng::DeleteRoute - cannot find the route to delete");
+    }
+
+  delete route->entry;
+  if (route->queued)
+    {
+      // the next update skips the route and frees it
+      route->entry = 0;
+      m_deletedRoutes.splice (m_deletedRoutes.end (), m_routes, route);
+    }
+  else
+    {
+      m_routes.erase (route);
     }
-  NS_ABORT_MSG ("Ripng::DeleteRoute - cannot find the route to delete");
 }
 
 
@@ -800,30 +836,30 @@ void RipNg::HandleRequests (RipNgHeader requestHdr, Ipv6Address senderAddress, u
 
               for (RoutesI rtIter = m_routes.begin (); rtIter != m_routes.end (); rtIter++)
                 {
-                  bool splitHorizoning = (rtIter->first->GetInterface () == incomingInterface);
+                  bool splitHorizoning = (rtIter->entry->GetInterface () == incomingInterface);
 
-                  Ipv6InterfaceAddress rtDestAddr = Ipv6InterfaceAddress (rtIter->first->GetDestNetwork (), rtIter->first->GetDestNetworkPrefix ());
+                  Ipv6InterfaceAddress rtDestAddr = Ipv6InterfaceAddress (rtIter->entry->GetDestNetwork (), rtIter->entry->GetDestNetworkPrefix ());
 
                   bool isGlobal = (rtDestAddr.GetScope () == Ipv6InterfaceAddress::GLOBAL);
-                  bool isDefaultRoute = ((rtIter->first->GetDestNetwork () == Ipv6Address::GetAny ()) &&
-                      (rtIter->first->GetDestNetworkPrefix () == Ipv6Prefix::GetZero ()) &&
-                      (rtIter->first->GetInterface () != incomingInterface));
+                  bool isDefaultRoute = ((rtIter->entry->GetDestNetwork () == Ipv6Address::GetAny ()) &&
+                      (rtIter->entry->GetDestNetworkPrefix () == Ipv6Prefix::GetZero ()) &&
+                      (rtIter->entry->GetInterface () != incomingInterface));
 
                   if ((isGlobal || isDefaultRoute) &&
-                      (rtIter->first->GetRouteStatus () == RipNgRoutingTableEntry::RIPNG_VALID) )
+                      (rtIter->entry->GetRouteStatus () == RipNgRoutingTableEntry::RIPNG_VALID) )
                     {
                       RipNgRte rte;
-                      rte.SetPrefix (rtIter->first->GetDestNetwork ());
-                      rte.SetPrefixLen (rtIter->first->GetDestNetworkPrefix ().GetPrefixLength ());
+                      rte.SetPrefix (rtIter->entry->GetDestNetwork ());
+                      rte.SetPrefixLen (rtIter->entry->GetDestNetworkPrefix ().GetPrefixLength ());
                       if (m_splitHorizonStrategy == POISON_REVERSE && splitHorizoning)
                         {
                           rte.SetRouteMetric (m_linkDown);
                         }
                       else
                         {
-                          rte.SetRouteMetric (rtIter->first->GetRouteMetric ());
+                          rte.SetRouteMetric (rtIter->entry->GetRouteMetric ());
                         }
-                      rte.SetRouteTag (rtIter->first->GetRouteTag ());
+                      rte.SetRouteTag (rtIter->entry->GetRouteTag ());
                       if ((m_splitHorizonStrategy != SPLIT_HORIZON) ||
                           (m_splitHorizonStrategy == SPLIT_HORIZON && !splitHorizoning))
                         {
@@ -885,19 +921,19 @@ void RipNg::HandleRequests (RipNgHeader requestHdr, Ipv6Address senderAddress, u
           bool found = false;
           for (RoutesI rtIter = m_routes.begin (); rtIter != m_routes.end (); rtIter++)
             {
-              Ipv6InterfaceAddress rtDestAddr = Ipv6InterfaceAddress(rtIter->first->GetDestNetwork (), rtIter->first->GetDestNetworkPrefix ());
+              Ipv6InterfaceAddress rtDestAddr = Ipv6InterfaceAddress(rtIter->entry->GetDestNetwork (), rtIter->entry->GetDestNetworkPrefix ());
               if ((rtDestAddr.GetScope () == Ipv6InterfaceAddress::GLOBAL) &&
-                  (rtIter->first->GetRouteStatus () == RipNgRoutingTableEntry::RIPNG_VALID))
+                  (rtIter->entry->GetRouteStatus () == RipNgRoutingTableEntry::RIPNG_VALID))
                 {
                   Ipv6Address requestedAddress = iter->GetPrefix ();
                   requestedAddress.CombinePrefix (Ipv6Prefix (iter->GetPrefixLen ()));
-                  Ipv6Address rtAddress = rtIter->first->GetDestNetwork ();
-                  rtAddress.CombinePrefix (rtIter->first->GetDestNetworkPrefix ());
+                  Ipv6Address rtAddress = rtIter->entry->GetDestNetwork ();
+                  rtAddress.CombinePrefix (rtIter->entry->GetDestNetworkPrefix ());
 
                   if (requestedAddress == rtAddress)
                     {
-                      iter->SetRouteMetric (rtIter->first->GetRouteMetric ());
-                      iter->SetRouteTag (rtIter->first->GetRouteTag ());
+                      iter->SetRouteMetric (rtIter->entry->GetRouteMetric ());
+                      iter->SetRouteTag (rtIter->entry->GetRouteTag ());
                       hdr.AddRte (*iter);
                       found = true;
                       break;
@@ -985,71 +1021,74 @@ void RipNg::HandleResponses (RipNgHeader hdr, Ipv6Address senderAddress, uint32_
         {
           rteMetric = m_linkDown;
         }
-      RoutesI it;
+      uint8_t prefix[16];
+      rteAddr.GetBytes (prefix);
+      const RoutesIndex::Entries *routes = m_routesIndex.Find (prefix, rtePrefix.GetPrefixLength ());
+
       bool found = false;
-      for (it = m_routes.begin (); it != m_routes.end (); it++)
+      if (routes)
         {
-          if (it->first->GetDestNetwork () == rteAddr &&
-              it->first->GetDestNetworkPrefix () == rtePrefix)
+          for (RoutesIndex::Entries::const_iterator rtIter = routes->begin (); rtIter != routes->end (); rtIter++)
             {
-              found = true;
-              if (rteMetric < it->first->GetRouteMetric ())
-                {
-                  if (senderAddress != it->first->GetGateway ())
-                    {
-                      RipNgRoutingTableEntry* route = new RipNgRoutingTableEntry (rteAddr, rtePrefix, senderAddress, incomingInterface, Ipv6Address::GetAny ());
-                      delete it->first;
-                      it->first = route;
-                    }
-                  it->first->SetRouteMetric (rteMetric);
-                  it->first->SetRouteStatus (RipNgRoutingTableEntry::RIPNG_VALID);
-                  it->first->SetRouteTag (iter->GetRouteTag ());
-                  it->first->SetRouteChanged (true);
-                  it->second.Cancel ();
-                  it->second = Simulator::Schedule (m_timeoutDelay, &RipNg::InvalidateRoute, this, it->first);
-                  changed = true;
-                }
-              else if (rteMetric == it->first->GetRouteMetric ())
+              RoutesI it = rtIter->value;
+              if (it->entry->GetDestNetwork () == rteAddr &&
+                  it->entry->GetDestNetworkPrefix () == rtePrefix)
                 {
-                  if (senderAddress == it->first->GetGateway ())
-                    {
-                      it->second.Cancel ();
-                      it->second = Simulator::Schedule (m_timeoutDelay, &RipNg::InvalidateRoute, this, it->first);
-                    }
-                  else
+                  found = true;
+                  if (rteMetric < it->entry->GetRouteMetric ())
                     {
-                      if (Simulator::GetDelayLeft (it->second) < m_timeoutDelay/2)
+                      if (senderAddress != it->entry->GetGateway ())
                         {
                           RipNgRoutingTableEntry* route = new RipNgRoutingTableEntry (rteAddr, rtePrefix, senderAddress, incomingInterface, Ipv6Address::GetAny ());
-                          route->SetRouteMetric (rteMetric);
-                          route->SetRouteStatus (RipNgRoutingTableEntry::RIPNG_VALID);
-                          route->SetRouteTag (iter->GetRouteTag ());
-                          route->SetRouteChanged (true);
-                          delete it->first;
-                          it->first = route;
-                          it->second.Cancel ();
-                          it->second = Simulator::Schedule (m_timeoutDelay, &RipNg::InvalidateRoute, this, route);
-                          changed = true;
+                          delete it->entry;
+                          it->entry = route;
                         }
+                      it->entry->SetRouteMetric (rteMetric);
+                      it->entry->SetRouteStatus (RipNgRoutingTableEntry::RIPNG_VALID);
+                      it->entry->SetRouteTag (iter->GetRouteTag ());
+                      QueueChangedRoute (it);
+                      it->timer.Schedule (m_timeoutDelay, &RipNg::InvalidateRoute, this, it);
+                      changed = true;
                     }
-                }
-              else if (rteMetric > it->first->GetRouteMetric () && senderAddress == it->first->GetGateway ())
-                {
-                  it->second.Cancel ();
-                  if (rteMetric < m_linkDown)
+                  else if (rteMetric == it->entry->GetRouteMetric ())
                     {
-                      it->first->SetRouteMetric (rteMetric);
-                      it->first->SetRouteStatus (RipNgRoutingTableEntry::RIPNG_VALID);
-                      it->first->SetRouteTag (iter->GetRouteTag ());
-                      it->first->SetRouteChanged (true);
-                      it->second.Cancel ();
-                      it->second = Simulator::Schedule (m_timeoutDelay, &RipNg::InvalidateRoute, this, it->first);
+                      if (senderAddress == it->entry->GetGateway ())
+                        {
+                          it->timer.Schedule (m_timeoutDelay, &RipNg::InvalidateRoute, this, it);
+                        }
+                      else
+                        {
+                          if (it->timer.GetDelayLeft () < m_timeoutDelay/2)
+                            {
+                              RipNgRoutingTableEntry* route = new RipNgRoutingTableEntry (rteAddr, rtePrefix, senderAddress, incomingInterface, Ipv6Address::GetAny ());
+                              route->SetRouteMetric (rteMetric);
+                              route->SetRouteStatus (RipNgRoutingTableEntry::RIPNG_VALID);
+                              route->SetRouteTag (iter->GetRouteTag ());
+                              delete it->entry;
+                              it->entry = route;
+                              QueueChangedRoute (it);
+                              it->timer.Schedule (m_timeoutDelay, &RipNg::InvalidateRoute, this, it);
+                              changed = true;
+                            }
+                        }
                     }
-                  else
+                  else if (rteMetric > it->entry->GetRouteMetric () && senderAddress == it->entry->GetGateway ())
                     {
-                      InvalidateRoute (it->first);
+                      it->timer.Cancel ();
+                      if (rteMetric < m_linkDown)
+                        {
+                          it->entry->SetRouteMetric (rteMetric);
+                          it->entry->SetRouteStatus (RipNgRoutingTableEntry::RIPNG_VALID);
+                          it->entry->SetRouteTag (iter->GetRouteTag ());
+                          QueueChangedRoute (it);
+                          it->timer.Schedule (m_timeoutDelay, &RipNg::InvalidateRoute, this, it);
+                        }
+                      else
+                        {
+                          InvalidateRoute (it);
+                        }
+                      changed = true;
                     }
-                  changed = true;
                 }
             }
         }
@@ -1060,10 +1099,9 @@ void RipNg::HandleResponses (RipNgHeader hdr, Ipv6Address senderAddress, uint32_
           RipNgRoutingTableEntry* route = new RipNgRoutingTableEntry (rteAddr, rtePrefix, senderAddress, incomingInterface, Ipv6Address::GetAny ());
           route->SetRouteMetric (rteMetric);
           route->SetRouteStatus (RipNgRoutingTableEntry::RIPNG_VALID);
-          route->SetRouteChanged (true);
-          m_routes.push_front (std::make_pair (route, EventId ()));
-          EventId invalidateEvent = Simulator::Schedule (m_timeoutDelay, &RipNg::InvalidateRoute, this, route);
-          (m_routes.begin ())->second = invalidateEvent;
+          RoutesI it = InsertRoute (route, true);
+          QueueChangedRoute (it);
+          it->timer.Schedule (m_timeoutDelay, &RipNg::InvalidateRoute, this, it);
           changed = true;
         }
     }
@@ -1078,6 +1116,27 @@ void RipNg::DoSendRouteUpdate (bool periodic)
 {
   NS_LOG_FUNCTION (this << (periodic ? " periodic" : " triggered"));
 
+  // a periodic update sends the whole table, a triggered one the queued routes
+  std::vector<RipNgRoutingTableEntry *> routes;
+  if (periodic)
+    {
+      routes.reserve (m_routes.size ());
+      for (RoutesI rtIter = m_routes.begin (); rtIter != m_routes.end (); rtIter++)
+        {
+          routes.push_back (rtIter->entry);
+        }
+    }
+  else
+    {
+      for (std::vector<RoutesI>::iterator rtIter = m_changedRoutes.begin (); rtIter != m_changedRoutes.end (); rtIter++)
+        {
+          if ((*rtIter)->entry != 0 && (*rtIter)->entry->IsRouteChanged ())
+            {
+              routes.push_back ((*rtIter)->entry);
+            }
+        }
+    }
+
   for (SocketListI iter = m_sendSocketList.begin (); iter != m_sendSocketList.end (); iter++ )
     {
       uint32_t interface = iter->second;
@@ -1095,33 +1154,33 @@ void RipNg::DoSendRouteUpdate (bool periodic)
           RipNgHeader hdr;
           hdr.SetCommand (RipNgHeader::RESPONSE);
 
-          for (RoutesI rtIter = m_routes.begin (); rtIter != m_routes.end (); rtIter++)
+          for (std::vector<RipNgRoutingTableEntry *>::iterator rtIter = routes.begin (); rtIter != routes.end (); rtIter++)
             {
-              bool splitHorizoning = (rtIter->first->GetInterface () == interface);
-              Ipv6InterfaceAddress rtDestAddr = Ipv6InterfaceAddress(rtIter->first->GetDestNetwork (), rtIter->first->GetDestNetworkPrefix ());
+              bool splitHorizoning = ((*rtIter)->GetInterface () == interface);
+              Ipv6InterfaceAddress rtDestAddr = Ipv6InterfaceAddress((*rtIter)->GetDestNetwork (), (*rtIter)->GetDestNetworkPrefix ());
 
-              NS_LOG_DEBUG ("Processing RT " << rtDestAddr << " " << int(rtIter->first->IsRouteChanged ()));
+              NS_LOG_DEBUG ("Processing RT " << rtDestAddr << " " << int((*rtIter)->IsRouteChanged ()));
 
               bool isGlobal = (rtDestAddr.GetScope () == Ipv6InterfaceAddress::GLOBAL);
-              bool isDefaultRoute = ((rtIter->first->GetDestNetwork () == Ipv6Address::GetAny ()) &&
-                  (rtIter->first->GetDestNetworkPrefix () == Ipv6Prefix::GetZero ()) &&
-                  (rtIter->first->GetInterface () != interface));
+              bool isDefaultRoute = (((*rtIter)->GetDestNetwork () == Ipv6Address::GetAny ()) &&
+                  ((*rtIter)->GetDestNetworkPrefix () == Ipv6Prefix::GetZero ()) &&
+                  ((*rtIter)->GetInterface () != interface));
 
               if ((isGlobal || isDefaultRoute) &&
-                  (periodic || rtIter->first->IsRouteChanged ()))
+                  (periodic || (*rtIter)->IsRouteChanged ()))
                 {
                   RipNgRte rte;
-                  rte.SetPrefix (rtIter->first->GetDestNetwork ());
-                  rte.SetPrefixLen (rtIter->first->GetDestNetworkPrefix ().GetPrefixLength ());
+                  rte.SetPrefix ((*rtIter)->GetDestNetwork ());
+                  rte.SetPrefixLen ((*rtIter)->GetDestNetworkPrefix ().GetPrefixLength ());
                   if (m_splitHorizonStrategy == POISON_REVERSE && splitHorizoning)
                     {
                       rte.SetRouteMetric (m_linkDown);
                     }
                   else
                     {
-                      rte.SetRouteMetric (rtIter->first->GetRouteMetric ());
+                      rte.SetRouteMetric ((*rtIter)->GetRouteMetric ());
                     }
-                  rte.SetRouteTag (rtIter->first->GetRouteTag ());
+                  rte.SetRouteTag ((*rtIter)->GetRouteTag ());
                   if (m_splitHorizonStrategy == SPLIT_HORIZON && !splitHorizoning)
                     {
                       hdr.AddRte (rte);
@@ -1148,10 +1207,16 @@ void RipNg::DoSendRouteUpdate (bool periodic)
             }
         }
     }
-  for (RoutesI rtIter = m_routes.begin (); rtIter != m_routes.end (); rtIter++)
+  for (std::vector<RipNgRoutingTableEntry *>::iterator rtIter = routes.begin (); rtIter != routes.end (); rtIter++)
+    {
+      (*rtIter)->SetRouteChanged (false);
+    }
+  for (std::vector<RoutesI>::iterator rtIter = m_changedRoutes.begin (); rtIter != m_changedRoutes.end (); rtIter++)
     {
-      rtIter->first->SetRouteChanged (false);
+      (*rtIter)->queued = false;
     }
+  m_changedRoutes.clear ();
+  m_deletedRoutes.clear ();
 }
 
 void RipNg::SendTriggeredRouteUpdate ()
@@ -1175,12 +1240,17 @@ void RipNg::SendTriggeredRouteUpdate ()
   //     and 5 seconds.  Triggered updates may be suppressed if a regular
   //     update is due by the time the triggered update would be sent.
   // Here we rely on this:
-  // When an update occurs (either Triggered or Periodic) the "IsChanged ()"
-  // route field will be cleared.
-  // Hence, the following Triggered Update will be fired, but will not send
-  // any route update.
+  // When a route changes, it is queued until the next update (either
+  // Triggered or Periodic), which clears the queue and the "IsChanged ()"
+  // route field. Hence, the following Triggered Update only sends the routes
+  // changed since the previous update, if any.
 
   Time delay = Seconds (m_rng->GetValue (m_minTriggeredUpdateDelay.GetSeconds (), m_maxTriggeredUpdateDelay.GetSeconds ()));
+  if (m_nextUnsolicitedUpdate.IsRunning () && Simulator::GetDelayLeft (m_nextUnsolicitedUpdate) <= delay)
+    {
+      NS_LOG_LOGIC ("Suppressing Triggered Update, an Unsolicited Update is due before");
+      return;
+    }
   m_nextTriggeredUpdate = Simulator::Schedule (delay, &RipNg::DoSendRouteUpdate, this, false);
 }
 
@@ -22,6 +22,7 @@
 #include "ns3/log.h"
 #include "ns3/nstime.h"
 #include "ns3/boolean.h"
+#include "ns3/enum.h"
 #include "ns3/object-vector.h"
 
 #include "ns3/packet.h"
@@ -29,6 +30,8 @@
 #include "ns3/simulator.h"
 #include "ns3/ipv4-route.h"
 #include "ns3/ipv6-route.h"
+#include "ns3/segmentation-offload.h"
+#include "ns3/timer-wheel.h"
 
 #include "tcp-l4-protocol.h"
 #include "tcp-header.h"
@@ -41,6 +44,7 @@
 #include "ipv6-routing-protocol.h"
 #include "tcp-socket-factory-impl.h"
 #include "tcp-socket-base.h"
+#include "tcp-pacing-wheel.h"
 #include "tcp-congestion-ops.h"
 #include "tcp-recovery-ops.h"
 #include "rtt-estimator.h"
@@ -90,6 +94,24 @@ TcpL4Protocol::GetTypeId (void)
                    ObjectVectorValue (),
                    MakeObjectVectorAccessor (&TcpL4Protocol::m_sockets),
                    MakeObjectVectorChecker<TcpSocketBase> ())
+    .AddAttribute ("PacingMode",
+                   "How the paced sockets wait for the departure of their next segment: "
+                   "with a timer per socket, with the timing wheel of the node "
+                   "(see TcpPacingWheel) or by tagging the segments with their "
+                   "earliest departure time, to be enforced by a queue disc "
+                   "(e.g., EdtQueueDisc)",
+                   EnumValue (TcpL4Protocol::PACING_TIMER),
+                   MakeEnumAccessor (&TcpL4Protocol::m_pacingMode),
+                   MakeEnumChecker (TcpL4Protocol::PACING_TIMER, "Timer",
+                                    TcpL4Protocol::PACING_WHEEL, "Wheel",
+                                    TcpL4Protocol::PACING_EDT, "Edt"))
+    .AddAttribute ("TimerWheel",
+                   "If true, the retransmission and delayed ACK timers of the "
+                   "sockets are armed in a TimerWheel shared by the sockets of "
+                   "the node, so that rearming them does not schedule any event",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&TcpL4Protocol::m_useTimerWheel),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
@@ -99,6 +121,8 @@ TcpL4Protocol::TcpL4Protocol ()
 {
   NS_LOG_FUNCTION_NOARGS ();
   NS_LOG_LOGIC ("Made a TcpL4Protocol " << this);
+  SegmentationOffload::Register (Ipv4L3Protocol::PROT_NUMBER, MakeCallback (&TcpL4Protocol::SegmentIpv4));
+  SegmentationOffload::Register (Ipv6L3Protocol::PROT_NUMBER, MakeCallback (&TcpL4Protocol::SegmentIpv6));
 }
 
 TcpL4Protocol::~TcpL4Protocol ()
@@ -162,6 +186,18 @@ TcpL4Protocol::DoDispose (void)
   NS_LOG_FUNCTION (this);
   m_sockets.clear ();
 
+  if (m_pacingWheel != 0)
+    {
+      m_pacingWheel->Dispose ();
+      m_pacingWheel = 0;
+    }
+
+  if (m_timerWheel != 0)
+    {
+      m_timerWheel->Dispose ();
+      m_timerWheel = 0;
+    }
+
   if (m_endPoints != 0)
     {
       delete m_endPoints;
@@ -218,6 +254,42 @@ TcpL4Protocol::CreateSocket (void)
   return CreateSocket (m_congestionTypeId, m_recoveryTypeId);
 }
 
+TcpL4Protocol::PacingMode_t
+TcpL4Protocol::GetPacingMode (void) const
+{
+  return m_pacingMode;
+}
+
+Ptr<TcpPacingWheel>
+TcpL4Protocol::GetPacingWheel (void)
+{
+  if (m_pacingMode != PACING_WHEEL)
+    {
+      return 0;
+    }
+  if (m_pacingWheel == 0)
+    {
+      NS_LOG_LOGIC ("Creating the pacing wheel");
+      m_pacingWheel = CreateObject<TcpPacingWheel> ();
+    }
+  return m_pacingWheel;
+}
+
+Ptr<TimerWheel>
+TcpL4Protocol::GetTimerWheel (void)
+{
+  if (!m_useTimerWheel)
+    {
+      return 0;
+    }
+  if (m_timerWheel == 0)
+    {
+      NS_LOG_LOGIC ("Creating the timer wheel");
+      m_timerWheel = CreateObject<TimerWheel> ();
+    }
+  return m_timerWheel;
+}
+
 Ipv4EndPoint *
 TcpL4Protocol::Allocate (void)
 {
@@ -551,6 +623,100 @@ TcpL4Protocol::Receive (Ptr<Packet> packet,
   return IpL4Protocol::RX_OK;
 }
 
+bool
+TcpL4Protocol::SplitSegment (Ptr<Packet> payload, const TcpHeader &header, uint16_t segmentSize,
+                             const Address &source, const Address &destination,
+                             std::vector<Ptr<Packet> > &segments)
+{
+  uint8_t lastFlags = header.GetFlags ();
+  uint8_t flags = lastFlags & ~(TcpHeader::FIN | TcpHeader::PSH);
+  uint32_t size = payload->GetSize ();
+  if (size == 0)
+    {
+      return false;
+    }
+  for (uint32_t offset = 0; offset < size; offset += segmentSize)
+    {
+      uint32_t length = std::min<uint32_t> (segmentSize, size - offset);
+      Ptr<Packet> segment = payload->CreateFragment (offset, length);
+      TcpHeader segmentHeader = header;
+      segmentHeader.SetSequenceNumber (header.GetSequenceNumber () + offset);
+      segmentHeader.SetFlags (offset + length < size ? flags : lastFlags);
+      if (offset == 0)
+        {
+          flags &= ~TcpHeader::CWR;
+          lastFlags &= ~TcpHeader::CWR;
+        }
+      if (Node::ChecksumEnabled ())
+        {
+          segmentHeader.EnableChecksums ();
+        }
+      segmentHeader.InitializeChecksum (source, destination, PROT_NUMBER);
+      segment->AddHeader (segmentHeader);
+      segments.push_back (segment);
+    }
+  return true;
+}
+
+bool
+TcpL4Protocol::SegmentIpv4 (Ptr<Packet> packet, uint16_t segmentSize, std::vector<Ptr<Packet> > &segments)
+{
+  Ipv4Header ipHeader;
+  packet->RemoveHeader (ipHeader);
+  if (ipHeader.GetProtocol () != PROT_NUMBER || ipHeader.IsLastFragment () == false
+      || ipHeader.GetFragmentOffset () != 0)
+    {
+      return false;
+    }
+  TcpHeader tcpHeader;
+  packet->RemoveHeader (tcpHeader);
+  std::vector<Ptr<Packet> > tcpSegments;
+  if (!SplitSegment (packet, tcpHeader, segmentSize, ipHeader.GetSource (), ipHeader.GetDestination (), tcpSegments))
+    {
+      return false;
+    }
+  for (uint32_t i = 0; i < tcpSegments.size (); i++)
+    {
+      Ipv4Header segmentIpHeader = ipHeader;
+      segmentIpHeader.SetPayloadSize (tcpSegments[i]->GetSize ());
+      // Ipv4L3Protocol allocated one identification per segment to the super-segment
+      segmentIpHeader.SetIdentification (ipHeader.GetIdentification () + i);
+      if (Node::ChecksumEnabled ())
+        {
+          segmentIpHeader.EnableChecksum ();
+        }
+      tcpSegments[i]->AddHeader (segmentIpHeader);
+      segments.push_back (tcpSegments[i]);
+    }
+  return true;
+}
+
+bool
+TcpL4Protocol::SegmentIpv6 (Ptr<Packet> packet, uint16_t segmentSize, std::vector<Ptr<Packet> > &segments)
+{
+  Ipv6Header ipHeader;
+  packet->RemoveHeader (ipHeader);
+  if (ipHeader.GetNextHeader () != PROT_NUMBER)
+    {
+      return false;
+    }
+  TcpHeader tcpHeader;
+  packet->RemoveHeader (tcpHeader);
+  std::vector<Ptr<Packet> > tcpSegments;
+  if (!SplitSegment (packet, tcpHeader, segmentSize, ipHeader.GetSourceAddress (), ipHeader.GetDestinationAddress (), tcpSegments))
+    {
+      return false;
+    }
+  for (uint32_t i = 0; i < tcpSegments.size (); i++)
+    {
+      Ipv6Header segmentIpHeader = ipHeader;
+      segmentIpHeader.SetPayloadLength (tcpSegments[i]->GetSize ());
+      tcpSegments[i]->AddHeader (segmentIpHeader);
+      segments.push_back (tcpSegments[i]);
+    }
+  return true;
+}
+
 void
 TcpL4Protocol::SendPacketV4 (Ptr<Packet> packet, const TcpHeader &outgoing,
                              const Ipv4Address &saddr, const Ipv4Address &daddr,
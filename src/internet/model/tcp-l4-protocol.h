@@ -22,6 +22,7 @@
 #define TCP_L4_PROTOCOL_H
 
 #include <stdint.h>
+#include <vector>
 
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv6-address.h"
@@ -38,6 +39,8 @@ class Ipv4EndPointDemux;
 class Ipv6EndPointDemux;
 class Ipv4Interface;
 class TcpSocketBase;
+class TcpPacingWheel;
+class TimerWheel;
 class Ipv4EndPoint;
 class Ipv6EndPoint;
 class NetDevice;
@@ -86,6 +89,16 @@ public:
   static TypeId GetTypeId (void);
   static const uint8_t PROT_NUMBER; //!< protocol number (0x6)
 
+  /**
+   * \brief How the paced sockets wait for the departure of their next segment
+   */
+  typedef enum
+  {
+    PACING_TIMER,  //!< Each socket has its own timer
+    PACING_WHEEL,  //!< The sockets share the timing wheel of the node
+    PACING_EDT     //!< The sockets tag the segments with their earliest departure time and send them at once
+  } PacingMode_t;
+
   TcpL4Protocol ();
   virtual ~TcpL4Protocol ();
 
@@ -128,6 +141,30 @@ public:
     */
   Ptr<Socket> CreateSocket (TypeId congestionTypeId);
 
+  /**
+   * \brief Get the pacing mode of the sockets
+   * \return the pacing mode
+   */
+  PacingMode_t GetPacingMode (void) const;
+
+  /**
+   * \brief Get the timing wheel shared by the paced sockets
+   *
+   * The wheel is created upon the first call.
+   *
+   * \return the timing wheel, or 0 if the pacing mode is not PACING_WHEEL
+   */
+  Ptr<TcpPacingWheel> GetPacingWheel (void);
+
+  /**
+   * \brief Get the timer wheel of the retransmission and delayed ACK timers
+   *
+   * The wheel is created upon the first call.
+   *
+   * \return the timer wheel, or 0 if the TimerWheel attribute is false
+   */
+  Ptr<TimerWheel> GetTimerWheel (void);
+
   /**
    * \brief Allocate an IPv4 Endpoint
    * \return the Endpoint
@@ -269,6 +306,33 @@ public:
   virtual IpL4Protocol::DownTargetCallback GetDownTarget (void) const;
   virtual IpL4Protocol::DownTargetCallback6 GetDownTarget6 (void) const;
 
+  /**
+   * \brief Split an IPv4 packet carrying a TCP super-segment
+   *
+   * This is the segmenter registered for IPv4 (see SegmentationOffload).
+   * The payload is split into segments of segmentSize bytes, whose sequence
+   * numbers follow each other. The PSH and FIN flags are only set in the
+   * last segment and the CWR flag only in the first one.
+   *
+   * \param packet the packet, starting with the IPv4 header
+   * \param segmentSize the size of the payload of each segment
+   * \param segments the vector to fill with the segments
+   * \returns false if the packet does not carry a TCP segment
+   */
+  static bool SegmentIpv4 (Ptr<Packet> packet, uint16_t segmentSize, std::vector<Ptr<Packet> > &segments);
+
+  /**
+   * \brief Split an IPv6 packet carrying a TCP super-segment
+   *
+   * This is the segmenter registered for IPv6 (see SegmentationOffload).
+   *
+   * \param packet the packet, starting with the IPv6 header
+   * \param segmentSize the size of the payload of each segment
+   * \param segments the vector to fill with the segments
+   * \returns false if the packet does not carry a TCP segment
+   */
+  static bool SegmentIpv6 (Ptr<Packet> packet, uint16_t segmentSize, std::vector<Ptr<Packet> > &segments);
+
 protected:
   virtual void DoDispose (void);
 
@@ -314,12 +378,32 @@ protected:
                          const Address &incomingDAddr);
 
 private:
+  /**
+   * \brief Split the payload of a TCP super-segment
+   *
+   * \param payload the payload of the super-segment
+   * \param header the TCP header of the super-segment
+   * \param segmentSize the size of the payload of each segment
+   * \param source the source address, for the checksum
+   * \param destination the destination address, for the checksum
+   * \param segments the vector to fill with the segments, starting with
+   *        their TCP header
+   * \returns false if the payload is empty
+   */
+  static bool SplitSegment (Ptr<Packet> payload, const TcpHeader &header, uint16_t segmentSize,
+                            const Address &source, const Address &destination,
+                            std::vector<Ptr<Packet> > &segments);
+
   Ptr<Node> m_node;                //!< the node this stack is associated with
   Ipv4EndPointDemux *m_endPoints;  //!< A list of IPv4 end points.
   Ipv6EndPointDemux *m_endPoints6; //!< A list of IPv6 end points.
   TypeId m_rttTypeId;              //!< The RTT Estimator TypeId
   TypeId m_congestionTypeId;       //!< The socket TypeId
   TypeId m_recoveryTypeId;         //!< The recovery TypeId
+  PacingMode_t m_pacingMode;       //!< The pacing mode of the sockets
+  Ptr<TcpPacingWheel> m_pacingWheel; //!< The timing wheel of the paced sockets
+  bool m_useTimerWheel;            //!< True if the sockets arm their timers in the timer wheel
+  Ptr<TimerWheel> m_timerWheel;    //!< The timer wheel of the sockets
   std::vector<Ptr<TcpSocketBase> > m_sockets;      //!< list of sockets
   IpL4Protocol::DownTargetCallback m_downTarget;   //!< Callback to send packets over IPv4
   IpL4Protocol::DownTargetCallback6 m_downTarget6; //!< Callback to send packets over IPv6
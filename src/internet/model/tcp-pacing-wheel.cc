@@ -0,0 +1,218 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include <algorithm>
+#include "tcp-pacing-wheel.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpPacingWheel");
+
+NS_OBJECT_ENSURE_REGISTERED (TcpPacingWheel);
+
+TypeId
+TcpPacingWheel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpPacingWheel")
+    .SetParent<Object> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<TcpPacingWheel> ()
+    .AddAttribute ("Granularity",
+                   "Width of a slot of the wheel. Departure times are rounded up "
+                   "to a multiple of the granularity.",
+                   TimeValue (MicroSeconds (10)),
+                   MakeTimeAccessor (&TcpPacingWheel::m_granularity),
+                   MakeTimeChecker ())
+    .AddAttribute ("Slots",
+                   "Number of slots of the wheel. Departure times farther than "
+                   "Slots * Granularity in the future are kept in an overflow list.",
+                   UintegerValue (1024),
+                   MakeUintegerAccessor (&TcpPacingWheel::m_nSlots),
+                   MakeUintegerChecker<uint32_t> (1))
+  ;
+  return tid;
+}
+
+TcpPacingWheel::TcpPacingWheel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TcpPacingWheel::~TcpPacingWheel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+TcpPacingWheel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_event.Cancel ();
+  m_slots.clear ();
+  m_occupied.clear ();
+  m_overflow.clear ();
+  m_expired.clear ();
+  m_nSlotted = 0;
+  Object::DoDispose ();
+}
+
+Time
+TcpPacingWheel::Schedule (Time departure, Callback<void> handler)
+{
+  NS_LOG_FUNCTION (this << departure);
+
+  if (m_slots.empty ())
+    {
+      NS_ABORT_MSG_IF (!m_granularity.IsStrictlyPositive (), "The granularity of the pacing wheel must be positive");
+      m_slots.resize (m_nSlots);
+      m_occupied.resize ((m_nSlots + 63) / 64, 0);
+    }
+
+  int64_t granularity = m_granularity.GetTimeStep ();
+  int64_t now = Simulator::Now ().GetTimeStep ();
+  uint64_t nowTick = (now + granularity - 1) / granularity;
+
+  // keep the wheel aligned with the current time when it is empty, so that
+  // the departure times of the near future fit into the slots
+  if (m_nSlotted == 0 && !m_expiring && nowTick > m_nextTick)
+    {
+      Advance (nowTick);
+    }
+
+  uint64_t tick = departure.IsStrictlyPositive () ? (departure.GetTimeStep () + granularity - 1) / granularity : 0;
+  tick = std::max (tick, std::max (nowTick, m_nextTick));
+  Insert (tick, handler);
+
+  // the handlers scheduled while a slot is served are taken into account by
+  // ScheduleNext once all the handlers of the slot have been invoked
+  if (!m_expiring && (!m_event.IsRunning () || tick < m_eventTick))
+    {
+      m_event.Cancel ();
+      m_eventTick = tick;
+      m_event = Simulator::Schedule (TimeStep (tick * granularity - now), &TcpPacingWheel::Expire, this);
+    }
+  return TimeStep (tick * granularity);
+}
+
+uint32_t
+TcpPacingWheel::GetNPending (void) const
+{
+  return m_nSlotted + m_overflow.size ();
+}
+
+Time
+TcpPacingWheel::GetGranularity (void) const
+{
+  return m_granularity;
+}
+
+void
+TcpPacingWheel::Insert (uint64_t tick, Callback<void> handler)
+{
+  if (tick >= m_nextTick + m_nSlots)
+    {
+      m_overflow.insert (std::make_pair (tick, handler));
+      return;
+    }
+  uint32_t slot = tick % m_nSlots;
+  m_slots[slot].push_back (handler);
+  m_occupied[slot / 64] |= (uint64_t (1) << (slot % 64));
+  m_nSlotted++;
+}
+
+void
+TcpPacingWheel::Advance (uint64_t tick)
+{
+  m_nextTick = tick;
+  while (!m_overflow.empty () && m_overflow.begin ()->first < m_nextTick + m_nSlots)
+    {
+      Insert (m_overflow.begin ()->first, m_overflow.begin ()->second);
+      m_overflow.erase (m_overflow.begin ());
+    }
+}
+
+void
+TcpPacingWheel::Expire (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint64_t tick = m_eventTick;
+
+  // bring the handlers of this tick into the wheel, if they overflowed
+  Advance (tick);
+  uint32_t slot = tick % m_nSlots;
+  m_expired.swap (m_slots[slot]);
+  m_occupied[slot / 64] &= ~(uint64_t (1) << (slot % 64));
+  m_nSlotted -= m_expired.size ();
+  Advance (tick + 1);
+
+  NS_LOG_LOGIC ("Serving " << m_expired.size () << " handlers at tick " << tick);
+  m_expiring = true;
+  for (std::size_t i = 0; i < m_expired.size (); i++)
+    {
+      m_expired[i] ();
+    }
+  m_expired.clear ();
+  m_expiring = false;
+
+  ScheduleNext ();
+}
+
+void
+TcpPacingWheel::ScheduleNext (void)
+{
+  uint64_t tick;
+  if (m_nSlotted > 0)
+    {
+      // look for the first non-empty slot from the next tick to serve
+      uint32_t start = m_nextTick % m_nSlots;
+      uint32_t i = 0;
+      while (i < m_nSlots)
+        {
+          uint32_t slot = (start + i) % m_nSlots;
+          uint64_t word = m_occupied[slot / 64] >> (slot % 64);
+          if (word == 0)
+            {
+              i += std::min (64 - slot % 64, m_nSlots - slot);
+              continue;
+            }
+          while ((word & 1) == 0)
+            {
+              word >>= 1;
+              i++;
+            }
+          break;
+        }
+      NS_ASSERT (i < m_nSlots);
+      tick = m_nextTick + i;
+    }
+  else if (!m_overflow.empty ())
+    {
+      tick = m_overflow.begin ()->first;
+    }
+  else
+    {
+      return;
+    }
+
+  m_eventTick = tick;
+  m_event = Simulator::Schedule (TimeStep (tick * m_granularity.GetTimeStep ()) - Simulator::Now (),
+                                 &TcpPacingWheel::Expire, this);
+}
+
+} // namespace ns3
@@ -0,0 +1,127 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef TCP_PACING_WHEEL_H
+#define TCP_PACING_WHEEL_H
+
+#include <map>
+#include <vector>
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/callback.h"
+#include "ns3/event-id.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup tcp
+ *
+ * \brief Timing wheel holding the departure times of the paced sockets of a node
+ *
+ * With one timer per socket, every paced segment costs an insertion (and
+ * often a cancellation) in the simulator event list, whose size grows with
+ * the number of paced flows. The timing wheel keeps the departure times of
+ * all the paced sockets of a node in an array of slots, each covering
+ * Granularity of time, and schedules a single simulator event for the
+ * earliest non-empty slot. All the handlers of a slot are invoked by that
+ * event, hence departure times are rounded up to the slot boundary (as the
+ * timer slack of the Linux fq queue disc).
+ *
+ * Departure times farther than Slots * Granularity in the future are kept in
+ * an overflow list and moved into the wheel as time advances.
+ *
+ * Entries can not be cancelled: the handlers are expected to check whether
+ * they are still relevant, e.g., by comparing the current time with the
+ * time returned by Schedule.
+ */
+class TcpPacingWheel : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  TcpPacingWheel ();
+  virtual ~TcpPacingWheel ();
+
+  /**
+   * \brief Schedule a handler at a departure time
+   *
+   * The handler is invoked at the first slot boundary not earlier than the
+   * departure time. Departure times in the past are served at the next slot
+   * boundary which has not been served yet.
+   *
+   * \param departure the departure time
+   * \param handler the handler to invoke
+   * \returns the time at which the handler will be invoked
+   */
+  Time Schedule (Time departure, Callback<void> handler);
+
+  /**
+   * \brief Get the number of scheduled handlers
+   * \returns the number of handlers not invoked yet
+   */
+  uint32_t GetNPending (void) const;
+
+  /**
+   * \brief Get the width of a slot
+   * \returns the granularity of the departure times
+   */
+  Time GetGranularity (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief Invoke the handlers of the slot of the scheduled event
+   */
+  void Expire (void);
+  /**
+   * \brief Schedule the event of the earliest non-empty slot, if any
+   */
+  void ScheduleNext (void);
+  /**
+   * \brief Insert a handler in the slot of a tick, or in the overflow list
+   * \param tick the tick
+   * \param handler the handler
+   */
+  void Insert (uint64_t tick, Callback<void> handler);
+  /**
+   * \brief Mark the ticks before the given one as served and move the
+   *        overflowing handlers whose tick entered the wheel into the slots
+   * \param tick the next tick to serve
+   */
+  void Advance (uint64_t tick);
+
+  Time m_granularity;      //!< Width of a slot
+  uint32_t m_nSlots;       //!< Number of slots
+
+  std::vector<std::vector<Callback<void> > > m_slots;   //!< Handlers of each slot
+  std::vector<uint64_t> m_occupied;                     //!< Bitmap of the non-empty slots
+  std::multimap<uint64_t, Callback<void> > m_overflow;  //!< Handlers beyond the wheel, by tick
+  std::vector<Callback<void> > m_expired;               //!< Handlers being invoked
+  uint64_t m_nextTick {0};  //!< Next tick to serve; the slots hold ticks m_nextTick to m_nextTick+m_nSlots-1
+  uint32_t m_nSlotted {0};  //!< Number of handlers in the slots
+  bool m_expiring {false};  //!< True while the handlers of a slot are invoked
+  EventId m_event;          //!< Event of the earliest non-empty slot
+  uint64_t m_eventTick {0}; //!< Tick of m_event
+};
+
+} // namespace ns3
+
+#endif /* TCP_PACING_WHEEL_H */
@@ -155,8 +155,13 @@ TcpRxBuffer::Add (Ptr<Packet> p, TcpHeader const& tcph)
       if (maxSeq < tailSeq) tailSeq = maxSeq;
       if (tailSeq < headSeq) headSeq = tailSeq;
     }
-  // Remove overlapped bytes from packet
-  BufIterator i = m_data.begin ();
+  // Remove overlapped bytes from packet. Stored packets do not overlap, so
+  // only the last one starting before headSeq can cover it
+  BufIterator i = m_data.upper_bound (headSeq);
+  if (i != m_data.begin ())
+    {
+      --i;
+    }
   while (i != m_data.end () && i->first <= tailSeq)
     {
       SequenceNumber32 lastByteSeq = i->first + SequenceNumber32 (i->second->GetSize ());
@@ -198,25 +203,27 @@ TcpRxBuffer::Add (Ptr<Packet> p, TcpHeader const& tcph)
 
   if (headSeq > m_nextRxSeq)
     {
-      // Generate a new SACK block
-      UpdateSackList (headSeq, tailSeq);
+      // Generate a new SACK block, reporting all the contiguous data around
+      TcpOptionSack::SackBlock range = AddRange (headSeq, tailSeq);
+      UpdateSackList (range.first, range.second);
     }
 
   NS_LOG_LOGIC ("Buffered packet of seqno=" << headSeq << " len=" << p->GetSize ());
   // Update variables
   m_size += p->GetSize ();      // Occupancy
-  for (i = m_data.begin (); i != m_data.end (); ++i)
+  if (headSeq == m_nextRxSeq)
     {
-      if (i->first < m_nextRxSeq)
+      // In-sequence data, followed by the out-of-order range it fills the
+      // gap to, if any (the ranges inside only held the data it replaced)
+      SequenceNumber32 nextRxSeq = tailSeq;
+      std::map<SequenceNumber32, SequenceNumber32>::iterator range = m_ranges.begin ();
+      while (range != m_ranges.end () && range->first <= tailSeq)
         {
-          continue;
+          nextRxSeq = std::max (nextRxSeq, range->second);
+          range = m_ranges.erase (range);
         }
-      else if (i->first > m_nextRxSeq)
-        {
-          break;
-        };
-      m_nextRxSeq = i->first + SequenceNumber32 (i->second->GetSize ());
-      m_availBytes += i->second->GetSize ();
+      m_availBytes += nextRxSeq - m_nextRxSeq;
+      m_nextRxSeq = nextRxSeq;
       ClearSackList (m_nextRxSeq);
     }
   NS_LOG_LOGIC ("Updated buffer occupancy=" << m_size << " nextRxSeq=" << m_nextRxSeq);
@@ -271,65 +278,64 @@ TcpRxBuffer::UpdateSackList (const SequenceNumber32 &head, const SequenceNumber3
   //     following SACK blocks in the SACK option may be listed in
   //     arbitrary order.
 
-  m_sackList.push_front (current);
-
-  // We have inserted the block at the beginning of the list. Now, we should
-  // check if any existing blocks overlap with that.
-  bool updated = false;
+  // The block is a whole range of contiguous data, so the blocks previously
+  // reported are either disjoint from it or included in it: the latter have
+  // been merged into the block, and are removed from the list.
   TcpOptionSack::SackList::iterator it = m_sackList.begin ();
-  TcpOptionSack::SackBlock begin = *it;
-  TcpOptionSack::SackBlock merged;
-  ++it;
-
-  // Iterates until we examined all blocks in the list (maximum 4)
   while (it != m_sackList.end ())
     {
-      current = *it;
-
-      // This is a left merge:
-      // [current_first; current_second] [beg_first; beg_second]
-      if (begin.first == current.second)
-        {
-          NS_ASSERT (current.first < begin.second);
-          merged = TcpOptionSack::SackBlock (current.first, begin.second);
-          updated = true;
-        }
-      // while this is a right merge
-      // [begin_first; begin_second] [current_first; current_second]
-      else if (begin.second == current.first)
+      if (it->first >= current.first && it->second <= current.second)
         {
-          NS_ASSERT (begin.first < current.second);
-          merged = TcpOptionSack::SackBlock (begin.first, current.second);
-          updated = true;
+          it = m_sackList.erase (it);
         }
-
-      // If we have merged the blocks (and the result is in merged) we should
-      // delete the current block (it), the first block, and insert the merged
-      // one at the beginning.
-      if (updated)
+      else
         {
-          m_sackList.erase (it);
-          m_sackList.pop_front ();
-          m_sackList.push_front (merged);
-          it = m_sackList.begin ();
-          begin = *it;
-          updated = false;
+          NS_ASSERT (it->second < current.first || it->first > current.second);
+          ++it;
         }
-
-      ++it;
     }
 
+  m_sackList.push_front (current);
+
   // Since the maximum blocks that fits into a TCP header are 4, there's no
   // point on maintaining the others.
   if (m_sackList.size () > 4)
     {
       m_sackList.pop_back ();
     }
+}
 
-  // Please note that, if a block b is discarded and then a block contiguous
-  // to b is received, only that new block (without the b part) is reported.
-  // This is perfectly fine for the RFC point (a), given that we do not report any
-  // overlapping blocks shortly after.
+TcpOptionSack::SackBlock
+TcpRxBuffer::AddRange (const SequenceNumber32 &head, const SequenceNumber32 &tail)
+{
+  NS_LOG_FUNCTION (this << head << tail);
+
+  SequenceNumber32 first = head;
+  SequenceNumber32 last = tail;
+
+  // Merge with the range ending at head, if any...
+  std::map<SequenceNumber32, SequenceNumber32>::iterator it = m_ranges.upper_bound (head);
+  if (it != m_ranges.begin ())
+    {
+      std::map<SequenceNumber32, SequenceNumber32>::iterator previous = it;
+      --previous;
+      if (previous->second >= head)
+        {
+          first = previous->first;
+          last = std::max (last, previous->second);
+          m_ranges.erase (previous);
+        }
+    }
+  // ...and with the ranges starting up to tail (those inside the block
+  // only held the data it replaced)
+  while (it != m_ranges.end () && it->first <= tail)
+    {
+      last = std::max (last, it->second);
+      it = m_ranges.erase (it);
+    }
+
+  m_ranges[first] = last;
+  return TcpOptionSack::SackBlock (first, last);
 }
 
 void
@@ -369,7 +375,7 @@ TcpRxBuffer::Extract (uint32_t maxSize)
   NS_LOG_LOGIC ("Requested to extract " << extractSize << " bytes from TcpRxBuffer of size=" << m_size);
   if (extractSize == 0) return nullptr;  // No contiguous block to return
   NS_ASSERT (m_data.size ()); // At least we have something to extract
-  Ptr<Packet> outPkt = Create<Packet> (); // The packet that contains all the data to return
+  Ptr<Packet> outPkt = nullptr; // The packet that contains all the data to return
   BufIterator i;
   while (extractSize)
     { // Check the buffered data for delivery
@@ -378,8 +384,16 @@ TcpRxBuffer::Extract (uint32_t maxSize)
       // Check if we send the whole pkt or just a partial
       uint32_t pktSize = i->second->GetSize ();
       if (pktSize <= extractSize)
-        { // Whole packet is extracted
-          outPkt->AddAtEnd (i->second);
+        { // Whole packet is extracted; the first one is copied (which does
+          // not copy its data), as others may hold a reference to it
+          if (outPkt == nullptr)
+            {
+              outPkt = i->second->Copy ();
+            }
+          else
+            {
+              outPkt->AddAtEnd (i->second);
+            }
           m_data.erase (i);
           m_size -= pktSize;
           m_availBytes -= pktSize;
@@ -387,7 +401,14 @@ TcpRxBuffer::Extract (uint32_t maxSize)
         }
       else
         { // Partial is extracted and done
-          outPkt->AddAtEnd (i->second->CreateFragment (0, extractSize));
+          if (outPkt == nullptr)
+            {
+              outPkt = i->second->CreateFragment (0, extractSize);
+            }
+          else
+            {
+              outPkt->AddAtEnd (i->second->CreateFragment (0, extractSize));
+            }
           m_data[i->first + SequenceNumber32 (extractSize)] = i->second->CreateFragment (extractSize, pktSize - extractSize);
           m_data.erase (i);
           m_size -= extractSize;
@@ -395,11 +416,13 @@ TcpRxBuffer::Extract (uint32_t maxSize)
           extractSize = 0;
         }
     }
-  if (outPkt->GetSize () == 0)
+  if (outPkt == nullptr || outPkt->GetSize () == 0)
     {
       NS_LOG_LOGIC ("Nothing extracted.");
       return nullptr;
     }
+  // the packet tags of the sender are not handed to the application
+  outPkt->RemoveAllPacketTags ();
   NS_LOG_LOGIC ("Extracted " << outPkt->GetSize ( ) << " bytes, bufsize=" << m_size
                              << ", num pkts in buffer=" << m_data.size ());
   return outPkt;
@@ -67,6 +67,16 @@ class Packet;
  * For more information about the SACK list, please check the documentation of
  * the method GetSackList.
  *
+ * Out-of-order data
+ * -----------------
+ *
+ * The segments are stored as they are received, indexed by their sequence
+ * number, and they are never copied to merge them. Instead, the out-of-order
+ * data is also described by a set of coalesced ranges of contiguous bytes:
+ * a segment is placed, RCV.NXT advanced and the first SACK block built in a
+ * time logarithmic in the number of buffered segments, rather than walking
+ * all of them.
+ *
  * \see GetSackList
  * \see UpdateSackList
  */
@@ -197,11 +207,24 @@ private:
    * (or other) options, it is even less. For more detail about this function,
    * please see the source code and in-line comments.
    *
+   * The block is the whole range of contiguous out-of-order data containing
+   * the segment just received (see AddRange), as RFC 2018 requires for the
+   * first block.
+   *
    * \param head sequence number of the block at the beginning
    * \param tail sequence number of the block at the end
    */
   void UpdateSackList (const SequenceNumber32 &head, const SequenceNumber32 &tail);
 
+  /**
+   * \brief Add a block of out-of-order data to the coalesced ranges
+   *
+   * \param head sequence number of the first byte of the block
+   * \param tail sequence number following the last byte of the block
+   * \return the range of contiguous out-of-order data containing the block
+   */
+  TcpOptionSack::SackBlock AddRange (const SequenceNumber32 &head, const SequenceNumber32 &tail);
+
   /**
    * \brief Remove old blocks from the sack list
    *
@@ -226,6 +249,7 @@ private:
   uint32_t m_maxBuffer;                      //!< Upper bound of the number of data bytes in buffer (RCV.WND)
   uint32_t m_availBytes;                     //!< Number of bytes available to read, i.e. contiguous block at head
   std::map<SequenceNumber32, Ptr<Packet> > m_data; //!< Corresponding data (may be null)
+  std::map<SequenceNumber32, SequenceNumber32> m_ranges; //!< Coalesced ranges of out-of-order data, from first to one past last byte
 };
 
 } //namespace ns3
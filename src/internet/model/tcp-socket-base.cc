@@ -43,8 +43,11 @@
 #include "ns3/trace-source-accessor.h"
 #include "ns3/data-rate.h"
 #include "ns3/object.h"
+#include "ns3/segmentation-offload.h"
+#include "ns3/departure-time-tag.h"
 #include "tcp-socket-base.h"
 #include "tcp-l4-protocol.h"
+#include "tcp-pacing-wheel.h"
 #include "ipv4-end-point.h"
 #include "ipv6-end-point.h"
 #include "ipv6-l3-protocol.h"
@@ -68,6 +71,13 @@ NS_LOG_COMPONENT_DEFINE ("TcpSocketBase");
 
 NS_OBJECT_ENSURE_REGISTERED (TcpSocketBase);
 
+/**
+ * Maximum size of the payload of a super-segment (TSO) or of coalesced
+ * segments (GRO), so that the total length of an IPv4 packet carrying it,
+ * with the largest TCP header, fits in 16 bits
+ */
+static const uint32_t OFFLOAD_MAX_SIZE = 65535 - 20 - 60;
+
 TypeId
 TcpSocketBase::GetTypeId (void)
 {
@@ -146,6 +156,20 @@ TcpSocketBase::GetTypeId (void)
                    MakeEnumAccessor (&TcpSocketBase::m_ecnMode),
                    MakeEnumChecker (EcnMode_t::NoEcn, "NoEcn",
                                     EcnMode_t::ClassicEcn, "ClassicEcn"))
+    .AddAttribute ("Tso",
+                   "Enable TCP segmentation offload: new data is sent in "
+                   "super-segments of up to 64 KB, split into segments by "
+                   "the devices (or by the network layer)",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&TcpSocketBase::m_tso),
+                   MakeBooleanChecker ())
+    .AddAttribute ("Gro",
+                   "Enable generic receive offload: the in-order data "
+                   "segments received at the same time are coalesced before "
+                   "being processed",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&TcpSocketBase::m_gro),
+                   MakeBooleanChecker ())
     .AddTraceSource ("RTO",
                      "Retransmission timeout",
                      MakeTraceSourceAccessor (&TcpSocketBase::m_rto),
@@ -336,7 +360,9 @@ TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
     m_ecnMode (sock.m_ecnMode),
     m_ecnEchoSeq (sock.m_ecnEchoSeq),
     m_ecnCESeq (sock.m_ecnCESeq),
-    m_ecnCWRSeq (sock.m_ecnCWRSeq)
+    m_ecnCWRSeq (sock.m_ecnCWRSeq),
+    m_tso (sock.m_tso),
+    m_gro (sock.m_gro)
 {
   NS_LOG_FUNCTION (this);
   NS_LOG_LOGIC ("Invoked the copy constructor");
@@ -359,6 +385,8 @@ TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
 
   m_tcb->m_currentPacingRate = m_tcb->m_maxPacingRate;
   m_pacingTimer.SetFunction (&TcpSocketBase::NotifyPacingPerformed, this);
+  m_retxEvent.SetWheel (sock.m_retxEvent.GetWheel ());
+  m_delAckEvent.SetWheel (sock.m_delAckEvent.GetWheel ());
 
   if (sock.m_congestionControl)
     {
@@ -450,6 +478,8 @@ void
 TcpSocketBase::SetTcp (Ptr<TcpL4Protocol> tcp)
 {
   m_tcp = tcp;
+  m_retxEvent.SetWheel (tcp->GetTimerWheel ());
+  m_delAckEvent.SetWheel (tcp->GetTimerWheel ());
 }
 
 /* Set an RTT estimator with this socket */
@@ -1132,7 +1162,7 @@ TcpSocketBase::ForwardUp (Ptr<Packet> packet, Ipv4Header header, uint16_t port,
       m_congestionControl->CwndEvent (m_tcb, TcpSocketState::CA_EVENT_ECN_NO_CE);
     }
 
-  DoForwardUp (packet, fromAddress, toAddress);
+  GroReceive (packet, fromAddress, toAddress);
 }
 
 void
@@ -1171,9 +1201,94 @@ TcpSocketBase::ForwardUp6 (Ptr<Packet> packet, Ipv6Header header, uint16_t port,
       m_congestionControl->CwndEvent (m_tcb, TcpSocketState::CA_EVENT_ECN_NO_CE);
     }
 
+  GroReceive (packet, fromAddress, toAddress);
+}
+
+void
+TcpSocketBase::GroReceive (Ptr<Packet> packet, const Address &fromAddress,
+                           const Address &toAddress)
+{
+  if (!m_gro)
+    {
+      DoForwardUp (packet, fromAddress, toAddress);
+      return;
+    }
+
+  // Only the data segments with no other flag than ACK and PSH, and no SACK
+  // option, are coalesced
+  TcpHeader tcpHeader;
+  uint32_t headerSize = packet->PeekHeader (tcpHeader);
+  uint32_t payloadSize = packet->GetSize () - headerSize;
+  bool mergeable = payloadSize > 0
+    && (tcpHeader.GetFlags () & ~TcpHeader::PSH) == TcpHeader::ACK
+    && !tcpHeader.HasOption (TcpOption::SACK);
+
+  if (m_groPacket != nullptr)
+    {
+      // The segment must follow the coalesced ones and carry the same
+      // acknowledgment, window and options
+      if (mergeable
+          && tcpHeader.GetSequenceNumber () == m_groHeader.GetSequenceNumber () + m_groPacket->GetSize ()
+          && tcpHeader.GetAckNumber () == m_groHeader.GetAckNumber ()
+          && tcpHeader.GetWindowSize () == m_groHeader.GetWindowSize ()
+          && tcpHeader.GetLength () == m_groHeader.GetLength ()
+          && m_groPacket->GetSize () + payloadSize <= OFFLOAD_MAX_SIZE)
+        {
+          bool sameTs = true;
+          if (tcpHeader.HasOption (TcpOption::TS))
+            {
+              Ptr<const TcpOptionTS> ts = DynamicCast<const TcpOptionTS> (tcpHeader.GetOption (TcpOption::TS));
+              Ptr<const TcpOptionTS> groTs = DynamicCast<const TcpOptionTS> (m_groHeader.GetOption (TcpOption::TS));
+              sameTs = groTs != nullptr && ts->GetTimestamp () == groTs->GetTimestamp ()
+                && ts->GetEcho () == groTs->GetEcho ();
+            }
+          if (sameTs)
+            {
+              packet->RemoveHeader (tcpHeader);
+              m_groPacket->AddAtEnd (packet);
+              m_groHeader.SetFlags (m_groHeader.GetFlags () | tcpHeader.GetFlags ());
+              NS_LOG_LOGIC ("Coalesced segment " << tcpHeader.GetSequenceNumber () <<
+                            ", " << m_groPacket->GetSize () << " bytes held");
+              if (tcpHeader.GetFlags () & TcpHeader::PSH)
+                {
+                  GroFlush ();
+                }
+              return;
+            }
+        }
+      GroFlush ();
+    }
+
+  // Hold the in-sequence segments, waiting for the following ones
+  if (mergeable && m_state == ESTABLISHED && !(tcpHeader.GetFlags () & TcpHeader::PSH)
+      && tcpHeader.GetSequenceNumber () == m_rxBuffer->NextRxSequence ())
+    {
+      packet->RemoveHeader (tcpHeader);
+      m_groPacket = packet;
+      m_groHeader = tcpHeader;
+      m_groFromAddress = fromAddress;
+      m_groToAddress = toAddress;
+      m_groEvent = Simulator::ScheduleNow (&TcpSocketBase::GroFlush, this);
+      return;
+    }
   DoForwardUp (packet, fromAddress, toAddress);
 }
 
+void
+TcpSocketBase::GroFlush (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_groEvent.Cancel ();
+  if (m_groPacket == nullptr)
+    {
+      return;
+    }
+  Ptr<Packet> packet = m_groPacket;
+  m_groPacket = nullptr;
+  packet->AddHeader (m_groHeader);
+  DoForwardUp (packet, m_groFromAddress, m_groToAddress);
+}
+
 void
 TcpSocketBase::ForwardIcmp (Ipv4Address icmpSource, uint8_t icmpTtl,
                             uint8_t icmpType, uint8_t icmpCode,
@@ -1335,7 +1450,7 @@ TcpSocketBase::DoForwardUp (Ptr<Packet> packet, const Address &fromAddress,
     { // Zero window: Enter persist state to send 1 byte to probe
       NS_LOG_LOGIC (this << " Enter zerowindow persist state");
       NS_LOG_LOGIC (this << " Cancelled ReTxTimeout event which was set to expire at " <<
-                    (Simulator::Now () + Simulator::GetDelayLeft (m_retxEvent)).GetSeconds ());
+                    (Simulator::Now () + m_retxEvent.GetDelayLeft ()).GetSeconds ());
       m_retxEvent.Cancel ();
       NS_LOG_LOGIC ("Schedule persist timeout at time " <<
                     Simulator::Now ().GetSeconds () << " to expire at time " <<
@@ -1966,6 +2081,19 @@ TcpSocketBase::ProcessAck (const SequenceNumber32 &ackNumber, bool scoreboardUpd
             }
           else
             {
+              if (m_tso)
+                {
+                  // A receiver coalescing segments (GRO) acks a whole
+                  // super-segment at once; the window is increased as if
+                  // the segments were acked by DelAckCount, as they are by
+                  // a receiver without GRO
+                  uint32_t ackedPerAck = std::max<uint32_t> (m_delAckMaxCount, 1);
+                  while (segsAcked > ackedPerAck)
+                    {
+                      m_congestionControl->IncreaseWindow (m_tcb, ackedPerAck);
+                      segsAcked -= ackedPerAck;
+                    }
+                }
               m_congestionControl->IncreaseWindow (m_tcb, segsAcked);
 
               m_tcb->m_cWndInfl = m_tcb->m_cWnd;
@@ -2436,7 +2564,7 @@ TcpSocketBase::Destroy (void)
       m_tcp->RemoveSocket (this);
     }
   NS_LOG_LOGIC (this << " Cancelled ReTxTimeout event which was set to expire at " <<
-                (Simulator::Now () + Simulator::GetDelayLeft (m_retxEvent)).GetSeconds ());
+                (Simulator::Now () + m_retxEvent.GetDelayLeft ()).GetSeconds ());
   CancelAllTimers ();
 }
 
@@ -2452,7 +2580,7 @@ TcpSocketBase::Destroy6 (void)
       m_tcp->RemoveSocket (this);
     }
   NS_LOG_LOGIC (this << " Cancelled ReTxTimeout event which was set to expire at " <<
-                (Simulator::Now () + Simulator::GetDelayLeft (m_retxEvent)).GetSeconds ());
+                (Simulator::Now () + m_retxEvent.GetDelayLeft ()).GetSeconds ());
   CancelAllTimers ();
 }
 
@@ -2578,7 +2706,7 @@ TcpSocketBase::SendEmptyPacket (uint8_t flags)
       NS_LOG_LOGIC ("Schedule retransmission timeout at time "
                     << Simulator::Now ().GetSeconds () << " to expire at time "
                     << (Simulator::Now () + m_rto.Get ()).GetSeconds ());
-      m_retxEvent = Simulator::Schedule (m_rto, &TcpSocketBase::SendEmptyPacket, this, flags);
+      m_retxEvent.Schedule (m_rto, &TcpSocketBase::SendEmptyPacket, this, flags);
     }
 }
 
@@ -2840,24 +2968,35 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
       isRetransmission = true;
     }
 
-  Ptr<Packet> p = m_txBuffer->CopyFromSequence (maxSize, seq);
+  Ptr<Packet> p = m_txBuffer->CopyFromSequence (std::min (maxSize, m_tcb->m_segmentSize), seq);
   uint32_t sz = p->GetSize (); // Size of packet
+  if (maxSize > m_tcb->m_segmentSize)
+    {
+      // Super-segment (TSO): the data is taken from the Tx buffer one segment
+      // at a time, so that the scoreboard still tracks every segment
+      while (sz < maxSize && sz % m_tcb->m_segmentSize == 0)
+        {
+          Ptr<Packet> segment = m_txBuffer->CopyFromSequence (std::min (maxSize - sz, m_tcb->m_segmentSize),
+                                                              seq + SequenceNumber32 (sz));
+          if (segment->GetSize () == 0)
+            {
+              break;
+            }
+          p->AddAtEnd (segment);
+          sz += segment->GetSize ();
+        }
+      if (sz > m_tcb->m_segmentSize)
+        {
+          p->AddPacketTag (SegmentationOffloadTag (m_tcb->m_segmentSize));
+        }
+    }
   uint8_t flags = withAck ? TcpHeader::ACK : 0;
   uint32_t remainingData = m_txBuffer->SizeFromSequence (seq + SequenceNumber32 (sz));
 
   if (m_tcb->m_pacing)
     {
       NS_LOG_INFO ("Pacing is enabled");
-      if (m_pacingTimer.IsExpired ())
-        {
-          NS_LOG_DEBUG ("Current Pacing Rate " << m_tcb->m_currentPacingRate);
-          NS_LOG_DEBUG ("Timer is in expired state, activate it " << m_tcb->m_currentPacingRate.CalculateBytesTxTime (sz));
-          m_pacingTimer.Schedule (m_tcb->m_currentPacingRate.CalculateBytesTxTime (sz));
-        }
-      else
-        {
-          NS_LOG_INFO ("Timer is already in running state");
-        }
+      SchedulePacing (p, sz);
     }
 
   if (withAck)
@@ -2926,7 +3065,7 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
       NS_LOG_LOGIC (this << " SendDataPacket Schedule ReTxTimeout at time " <<
                     Simulator::Now ().GetSeconds () << " to expire at time " <<
                     (Simulator::Now () + m_rto.Get ()).GetSeconds () );
-      m_retxEvent = Simulator::Schedule (m_rto, &TcpSocketBase::ReTxTimeout, this);
+      m_retxEvent.Schedule (m_rto, &TcpSocketBase::ReTxTimeout, this);
     }
 
   m_txTrace (p, header, this);
@@ -3020,9 +3159,9 @@ TcpSocketBase::SendPendingData (bool withAck)
       if (m_tcb->m_pacing)
         {
           NS_LOG_INFO ("Pacing is enabled");
-          if (m_pacingTimer.IsRunning ())
+          if (IsPacingBlocked ())
             {
-              NS_LOG_INFO ("Skipping Packet due to pacing" << m_pacingTimer.GetDelayLeft ());
+              NS_LOG_INFO ("Skipping Packet due to pacing");
               break;
             }
           NS_LOG_INFO ("Timer is not running");
@@ -3077,6 +3216,21 @@ TcpSocketBase::SendPendingData (bool withAck)
 
           uint32_t s = std::min (availableWindow, m_tcb->m_segmentSize);
 
+          // With TSO, new data is sent in a super-segment made of as many
+          // full segments as the window allows. The remainder is sent on its
+          // own, subject to Nagle's algorithm as above. With pacing, the
+          // super-segment carries about 1 ms of data (as Linux autosizing)
+          if (m_tso && next == m_tcb->m_highTxMark)
+            {
+              uint32_t tsoSize = std::min (std::min (availableWindow, availableData), OFFLOAD_MAX_SIZE);
+              if (m_tcb->m_pacing)
+                {
+                  uint64_t pacingSize = m_tcb->m_currentPacingRate.GetBitRate () / 8000;
+                  tsoSize = static_cast<uint32_t> (std::min<uint64_t> (tsoSize, std::max<uint64_t> (pacingSize, 2 * m_tcb->m_segmentSize)));
+                }
+              s = std::max (s, tsoSize - tsoSize % m_tcb->m_segmentSize);
+            }
+
           // (C.2) If any of the data octets sent in (C.1) are below HighData,
           //       HighRxt MUST be set to the highest sequence number of the
           //       retransmitted segment unless NextSeg () rule (4) was
@@ -3108,17 +3262,6 @@ TcpSocketBase::SendPendingData (bool withAck)
                         " sent seq " << m_tcb->m_nextTxSequence <<
                         " size " << sz);
           ++nPacketsSent;
-          if (m_tcb->m_pacing)
-            {
-              NS_LOG_INFO ("Pacing is enabled");
-              if (m_pacingTimer.IsExpired ())
-                {
-                  NS_LOG_DEBUG ("Current Pacing Rate " << m_tcb->m_currentPacingRate);
-                  NS_LOG_DEBUG ("Timer is in expired state, activate it " << m_tcb->m_currentPacingRate.CalculateBytesTxTime (sz));
-                  m_pacingTimer.Schedule (m_tcb->m_currentPacingRate.CalculateBytesTxTime (sz));
-                  break;
-                }
-            }
         }
 
       // (C.4) The estimate of the amount of data outstanding in the
@@ -3282,8 +3425,10 @@ TcpSocketBase::ReceivedData (Ptr<Packet> p, const TcpHeader& tcpHeader)
         }
     }
   else
-    { // In-sequence packet: ACK if delayed ack count allows
-      if (++m_delAckCount >= m_delAckMaxCount)
+    { // In-sequence packet: ACK if delayed ack count allows. Coalesced
+      // segments (GRO) count as the number of segments they are made of
+      m_delAckCount += m_gro ? std::max<uint32_t> (1, (p->GetSize () + m_tcb->m_segmentSize - 1) / m_tcb->m_segmentSize) : 1;
+      if (m_delAckCount >= m_delAckMaxCount)
         {
           m_delAckEvent.Cancel ();
           m_delAckCount = 0;
@@ -3302,10 +3447,9 @@ TcpSocketBase::ReceivedData (Ptr<Packet> p, const TcpHeader& tcpHeader)
         }
       else if (m_delAckEvent.IsExpired ())
         {
-          m_delAckEvent = Simulator::Schedule (m_delAckTimeout,
-                                               &TcpSocketBase::DelAckTimeout, this);
+          m_delAckEvent.Schedule (m_delAckTimeout, &TcpSocketBase::DelAckTimeout, this);
           NS_LOG_LOGIC (this << " scheduled delayed ACK at " <<
-                        (Simulator::Now () + Simulator::GetDelayLeft (m_delAckEvent)).GetSeconds ());
+                        (Simulator::Now () + m_delAckEvent.GetDelayLeft ()).GetSeconds ());
         }
     }
 }
@@ -3380,7 +3524,7 @@ TcpSocketBase::NewAck (SequenceNumber32 const& ack, bool resetRTO)
   if (m_state != SYN_RCVD && resetRTO)
     { // Set RTO unless the ACK is received in SYN_RCVD state
       NS_LOG_LOGIC (this << " Cancelled ReTxTimeout event which was set to expire at " <<
-                    (Simulator::Now () + Simulator::GetDelayLeft (m_retxEvent)).GetSeconds ());
+                    (Simulator::Now () + m_retxEvent.GetDelayLeft ()).GetSeconds ());
       m_retxEvent.Cancel ();
       // On receiving a "New" ack we restart retransmission timer .. RFC 6298
       // RFC 6298, clause 2.4
@@ -3389,7 +3533,7 @@ TcpSocketBase::NewAck (SequenceNumber32 const& ack, bool resetRTO)
       NS_LOG_LOGIC (this << " Schedule ReTxTimeout at time " <<
                     Simulator::Now ().GetSeconds () << " to expire at time " <<
                     (Simulator::Now () + m_rto.Get ()).GetSeconds ());
-      m_retxEvent = Simulator::Schedule (m_rto, &TcpSocketBase::ReTxTimeout, this);
+      m_retxEvent.Schedule (m_rto, &TcpSocketBase::ReTxTimeout, this);
     }
 
   // Note the highest ACK and tell app to send more
@@ -3407,7 +3551,7 @@ TcpSocketBase::NewAck (SequenceNumber32 const& ack, bool resetRTO)
   if (m_txBuffer->Size () == 0 && m_state != FIN_WAIT_1 && m_state != CLOSING)
     { // No retransmit timer if no data to retransmit
       NS_LOG_LOGIC (this << " Cancelled ReTxTimeout event which was set to expire at " <<
-                    (Simulator::Now () + Simulator::GetDelayLeft (m_retxEvent)).GetSeconds ());
+                    (Simulator::Now () + m_retxEvent.GetDelayLeft ()).GetSeconds ());
       m_retxEvent.Cancel ();
     }
 }
@@ -3531,7 +3675,7 @@ TcpSocketBase::ReTxTimeout ()
   m_congestionControl->CongestionStateSet (m_tcb, TcpSocketState::CA_LOSS);
   m_tcb->m_congState = TcpSocketState::CA_LOSS;
 
-  m_pacingTimer.Cancel ();
+  CancelPacing ();
 
   NS_LOG_DEBUG ("RTO. Reset cwnd to " <<  m_tcb->m_cWnd << ", ssthresh to " <<
                 m_tcb->m_ssThresh << ", restart from seqnum " <<
@@ -3671,7 +3815,8 @@ TcpSocketBase::CancelAllTimers ()
   m_lastAckEvent.Cancel ();
   m_timewaitEvent.Cancel ();
   m_sendPendingDataEvent.Cancel ();
-  m_pacingTimer.Cancel ();
+  CancelPacing ();
+  m_groEvent.Cancel ();
 }
 
 /* Move TCP to Time_Wait state and schedule a transition to Closed state */
@@ -4229,6 +4374,85 @@ TcpSocketBase::NotifyPacingPerformed (void)
   SendPendingData (m_connected);
 }
 
+bool
+TcpSocketBase::IsPacingBlocked (void) const
+{
+  return m_pacingTimer.IsRunning () || m_pacingWheelPending;
+}
+
+void
+TcpSocketBase::SchedulePacing (Ptr<Packet> p, uint32_t sz)
+{
+  NS_LOG_FUNCTION (this << p << sz);
+  NS_LOG_DEBUG ("Current Pacing Rate " << m_tcb->m_currentPacingRate);
+  Time txTime = m_tcb->m_currentPacingRate.CalculateBytesTxTime (sz);
+  Time now = Simulator::Now ();
+  TcpL4Protocol::PacingMode_t mode = m_tcp ? m_tcp->GetPacingMode () : TcpL4Protocol::PACING_TIMER;
+
+  if (mode == TcpL4Protocol::PACING_EDT)
+    {
+      // The segment leaves at its earliest departure time, enforced by the
+      // queue disc, and the next one can not leave earlier than txTime later
+      Time departure = std::max (m_pacingDeparture, now);
+      p->AddPacketTag (DepartureTimeTag (departure));
+      m_pacingDeparture = departure + txTime;
+      NS_LOG_DEBUG ("Departure at " << departure.As (Time::S) << ", next one at " << m_pacingDeparture.As (Time::S));
+      return;
+    }
+
+  Ptr<TcpPacingWheel> wheel = (mode == TcpL4Protocol::PACING_WHEEL) ? m_tcp->GetPacingWheel () : 0;
+  if (wheel == 0)
+    {
+      if (m_pacingTimer.IsExpired ())
+        {
+          NS_LOG_DEBUG ("Timer is in expired state, activate it " << txTime);
+          m_pacingTimer.Schedule (txTime);
+        }
+      else
+        {
+          NS_LOG_INFO ("Timer is already in running state");
+        }
+      return;
+    }
+
+  if (m_pacingWheelPending)
+    {
+      NS_LOG_INFO ("Departure is already scheduled");
+      return;
+    }
+  // The next departure follows the previous one, rather than the current
+  // time, so that the rounding of the departure times by the wheel does not
+  // lower the pacing rate. An idle socket does not accumulate credit, though.
+  Time departure = std::max (m_pacingDeparture, now - wheel->GetGranularity ()) + txTime;
+  m_pacingDeparture = departure;
+  m_pacingWheelPending = true;
+  m_pacingWakeup = wheel->Schedule (departure, MakeCallback (&TcpSocketBase::PacingWheelExpired,
+                                                             Ptr<TcpSocketBase> (this)));
+  NS_LOG_DEBUG ("Departure at " << departure.As (Time::S) << ", served at " << m_pacingWakeup.As (Time::S));
+}
+
+void
+TcpSocketBase::PacingWheelExpired (void)
+{
+  NS_LOG_FUNCTION (this);
+  // the entries of the wheel are not cancelled, hence ignore the stale ones
+  if (!m_pacingWheelPending || Simulator::Now () != m_pacingWakeup)
+    {
+      return;
+    }
+  m_pacingWheelPending = false;
+  NotifyPacingPerformed ();
+}
+
+void
+TcpSocketBase::CancelPacing (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_pacingTimer.Cancel ();
+  m_pacingWheelPending = false;
+  m_pacingDeparture = Seconds (0);
+}
+
 void
 TcpSocketBase::SetEcn (EcnMode_t ecnMode)
 {
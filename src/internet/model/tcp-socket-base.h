@@ -28,10 +28,12 @@
 #include "ns3/ipv4-header.h"
 #include "ns3/ipv6-header.h"
 #include "ns3/timer.h"
+#include "ns3/timer-wheel.h"
 #include "ns3/sequence-number.h"
 #include "ns3/data-rate.h"
 #include "ns3/node.h"
 #include "ns3/tcp-socket-state.h"
+#include "ns3/tcp-header.h"
 
 namespace ns3 {
 
@@ -700,6 +702,28 @@ protected:
   virtual void DoForwardUp (Ptr<Packet> packet, const Address &fromAddress,
                             const Address &toAddress);
 
+  /**
+   * \brief Coalesce an incoming packet with the previous ones (GRO)
+   *
+   * Called by ForwardUp() and ForwardUp6(). If the Gro attribute is set,
+   * in-sequence data segments are held and merged with the following
+   * contiguous segments received at the same time (e.g., the segments of a
+   * train of packets delivered by a device), and the whole data is passed
+   * to DoForwardUp() as a single segment. Otherwise, the packet is passed
+   * to DoForwardUp() at once.
+   *
+   * \param packet the incoming packet
+   * \param fromAddress the address of the sender of packet
+   * \param toAddress the address of the receiver of packet (hopefully, us)
+   */
+  void GroReceive (Ptr<Packet> packet, const Address &fromAddress,
+                   const Address &toAddress);
+
+  /**
+   * \brief Pass the coalesced segments, if any, to DoForwardUp()
+   */
+  void GroFlush (void);
+
   /**
    * \brief Called by the L3 protocol when it received an ICMP packet to pass on to TCP.
    *
@@ -1162,6 +1186,34 @@ protected:
    */
   void NotifyPacingPerformed (void);
 
+  /**
+   * \brief Check whether pacing prevents the socket from sending a segment
+   * \return true if the departure of the next segment is in the future
+   */
+  bool IsPacingBlocked (void) const;
+
+  /**
+   * \brief Schedule the departure of the next segment after a segment is sent
+   *
+   * Depending on the pacing mode of TcpL4Protocol, the socket waits for its
+   * own timer or for the timing wheel of the node, or tags the segment with
+   * its earliest departure time and does not wait at all.
+   *
+   * \param p the segment being sent
+   * \param sz the size of the segment payload
+   */
+  void SchedulePacing (Ptr<Packet> p, uint32_t sz);
+
+  /**
+   * \brief Called by the timing wheel of the node when the next segment can be sent
+   */
+  void PacingWheelExpired (void);
+
+  /**
+   * \brief Cancel the scheduled departure of the next segment
+   */
+  void CancelPacing (void);
+
   /**
    * \brief Add Tags for the Socket
    * \param p Packet
@@ -1170,9 +1222,9 @@ protected:
 
 protected:
   // Counters and events
-  EventId           m_retxEvent     {}; //!< Retransmission event
+  WheelTimer        m_retxEvent     {}; //!< Retransmission event
   EventId           m_lastAckEvent  {}; //!< Last ACK timeout event
-  EventId           m_delAckEvent   {}; //!< Delayed ACK timeout event
+  WheelTimer        m_delAckEvent   {}; //!< Delayed ACK timeout event
   EventId           m_persistEvent  {}; //!< Persist event: Send 1 byte to probe for a non-zero Rx window
   EventId           m_timewaitEvent {}; //!< TIME_WAIT expiration event: Move this socket to CLOSED state
 
@@ -1266,12 +1318,24 @@ protected:
 
   // Pacing related variable
   Timer m_pacingTimer {Timer::REMOVE_ON_DESTROY}; //!< Pacing Event
+  Time m_pacingDeparture {Seconds (0)};  //!< Earliest departure time of the next segment
+  Time m_pacingWakeup {Seconds (0)};     //!< Time at which the timing wheel serves the socket
+  bool m_pacingWheelPending {false};     //!< True if the socket waits for the timing wheel
 
   // Parameters related to Explicit Congestion Notification
   EcnMode_t                     m_ecnMode    {EcnMode_t::NoEcn};      //!< Socket ECN capability
   TracedValue<SequenceNumber32> m_ecnEchoSeq {0};      //!< Sequence number of the last received ECN Echo
   TracedValue<SequenceNumber32> m_ecnCESeq   {0};      //!< Sequence number of the last received Congestion Experienced
   TracedValue<SequenceNumber32> m_ecnCWRSeq  {0};      //!< Sequence number of the last sent CWR
+
+  // Segmentation offload
+  bool             m_tso {false};      //!< Send super-segments split by the devices (TSO/GSO)
+  bool             m_gro {false};      //!< Coalesce the in-order received segments (GRO)
+  Ptr<Packet>      m_groPacket;        //!< Payload of the coalesced segments
+  TcpHeader        m_groHeader;        //!< TCP header of the coalesced segments
+  Address          m_groFromAddress;   //!< Source address of the coalesced segments
+  Address          m_groToAddress;     //!< Destination address of the coalesced segments
+  EventId          m_groEvent {};      //!< Event delivering the coalesced segments
 };
 
 /**
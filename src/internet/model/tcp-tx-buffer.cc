@@ -96,7 +96,8 @@ TcpTxBuffer::GetTypeId (void)
  * initialized below is insignificant.
  */
 TcpTxBuffer::TcpTxBuffer (uint32_t n)
-  : m_maxBuffer (32768), m_size (0), m_sentSize (0), m_firstByteSeq (n)
+  : m_maxBuffer (32768), m_size (0), m_sentSize (0), m_firstByteSeq (n),
+    m_lostUpTo (n), m_lostHigh (n), m_nextSegHint (n)
 {
 }
 
@@ -169,6 +170,7 @@ TcpTxBuffer::SetHeadSequence (const SequenceNumber32& seq)
   // if you change the head with data already sent, something bad will happen
   NS_ASSERT (m_sentList.size () == 0);
   m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
+  m_lostUpTo = m_lostHigh = m_nextSegHint = seq;
 }
 
 bool
@@ -294,8 +296,12 @@ TcpTxBuffer::GetNewSegment (uint32_t numBytes)
   NS_ASSERT (it != m_appList.end ());
 
   m_appList.erase (it);
-  m_sentList.insert (m_sentList.end (), item);
+  m_sentIndex[item->m_startSeq] = m_sentList.insert (m_sentList.end (), item);
   m_sentSize += item->m_packet->GetSize ();
+  if (item->m_lost)
+    {
+      UpdateLostHigh (item);
+    }
 
   return item;
 }
@@ -308,41 +314,44 @@ TcpTxBuffer::GetTransmittedSegment (uint32_t numBytes, const SequenceNumber32 &s
   NS_ASSERT (numBytes <= m_sentSize);
   NS_ASSERT (m_sentList.size () >= 1);
 
-  auto it = m_sentList.begin ();
   bool listEdited = false;
   uint32_t s = numBytes;
 
   // Avoid to merge different packet for this retransmission if flags are
   // different.
-  for (; it != m_sentList.end(); ++it)
+  SentIndex::iterator index = m_sentIndex.find (seq);
+  if (index != m_sentIndex.end ())
     {
-      if ((*it)->m_startSeq == seq)
+      auto it = index->second;
+      auto next = it;
+      next++;
+      if (next != m_sentList.end ())
         {
-          auto next = it;
-          next++;
-          if (next != m_sentList.end ())
+          // Next is not sacked... there is the possibility to merge
+          if (! (*next)->m_sacked)
             {
-              // Next is not sacked... there is the possibility to merge
-              if (! (*next)->m_sacked)
-                {
-                  s = std::min(s, (*it)->m_packet->GetSize () + (*next)->m_packet->GetSize ());
-                }
-              else
-                {
-                  // Next is sacked... better to retransmit only the first segment
-                  s = std::min(s, (*it)->m_packet->GetSize ());
-                }
+              s = std::min(s, (*it)->m_packet->GetSize () + (*next)->m_packet->GetSize ());
             }
           else
             {
+              // Next is sacked... better to retransmit only the first segment
               s = std::min(s, (*it)->m_packet->GetSize ());
             }
-          break;
+        }
+      else
+        {
+          s = std::min(s, (*it)->m_packet->GetSize ());
         }
     }
 
   TcpTxItem *item = GetPacketFromList (m_sentList, m_firstByteSeq, s, seq, &listEdited);
 
+  // Merging may have cleared the retransmitted flag of the items from seq on
+  if (seq < m_nextSegHint)
+    {
+      m_nextSegHint = seq;
+    }
+
   if (! item->m_retrans)
     {
       m_retrans += item->m_packet->GetSize ();
@@ -374,6 +383,26 @@ TcpTxBuffer::FindHighestSacked () const
   return ret;
 }
 
+TcpTxBuffer::PacketList::iterator
+TcpTxBuffer::FindSentItem (const SequenceNumber32 &seq) const
+{
+  SentIndex::const_iterator index = m_sentIndex.lower_bound (seq);
+  if (index == m_sentIndex.end ())
+    {
+      return const_cast<PacketList &> (m_sentList).end ();
+    }
+  return index->second;
+}
+
+void
+TcpTxBuffer::UpdateLostHigh (const TcpTxItem *item)
+{
+  SequenceNumber32 end = item->m_startSeq + item->m_packet->GetSize ();
+  if (end > m_lostHigh)
+    {
+      m_lostHigh = end;
+    }
+}
 
 void
 TcpTxBuffer::SplitItems (TcpTxItem *t1, TcpTxItem *t2, uint32_t size) const
@@ -398,7 +427,7 @@ TcpTxBuffer::SplitItems (TcpTxItem *t1, TcpTxItem *t2, uint32_t size) const
 TcpTxItem*
 TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listStartFrom,
                                 uint32_t numBytes, const SequenceNumber32 &seq,
-                                bool *listEdited) const
+                                bool *listEdited)
 {
   NS_LOG_FUNCTION (this << numBytes << seq);
 
@@ -434,12 +463,25 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
   TcpTxItem *outItem = nullptr;
   PacketList::iterator it = list.begin ();
   SequenceNumber32 beginOfCurrentPacket = listStartFrom;
+  bool indexed = (&list == &m_sentList);
+
+  if (indexed)
+    {
+      // Start from the sent item containing seq
+      SentIndex::iterator index = m_sentIndex.upper_bound (seq);
+      if (index != m_sentIndex.begin ())
+        {
+          --index;
+          it = index->second;
+          beginOfCurrentPacket = (*it)->m_startSeq;
+        }
+    }
 
   while (it != list.end ())
     {
       currentItem = *it;
       currentPacket = currentItem->m_packet;
-      NS_ASSERT_MSG (list != m_sentList || currentItem->m_startSeq >= m_firstByteSeq,
+      NS_ASSERT_MSG (!indexed || currentItem->m_startSeq >= m_firstByteSeq,
                      "start: " << m_firstByteSeq << " currentItem start: " <<
                      currentItem->m_startSeq);
 
@@ -469,7 +511,12 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
               SplitItems (firstPart, currentItem, seq - beginOfCurrentPacket);
 
               // insert firstPart before currentItem
-              list.insert (it, firstPart);
+              PacketList::iterator firstPartIt = list.insert (it, firstPart);
+              if (indexed)
+                {
+                  m_sentIndex[firstPart->m_startSeq] = firstPartIt;
+                  m_sentIndex[currentItem->m_startSeq] = it;
+                }
               if (listEdited)
                 {
                   *listEdited = true;
@@ -516,6 +563,10 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
                   TcpTxItem *previous = *(--it);
 
                   list.erase (it);
+                  if (indexed)
+                    {
+                      m_sentIndex.erase (previous->m_startSeq);
+                    }
 
                   MergeItems (previous, currentItem);
                   delete currentItem;
@@ -535,7 +586,12 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
               SplitItems (firstPart, currentItem, numBytes);
 
               // insert firstPart before currentItem
-              list.insert (it, firstPart);
+              PacketList::iterator firstPartIt = list.insert (it, firstPart);
+              if (indexed)
+                {
+                  m_sentIndex[firstPart->m_startSeq] = firstPartIt;
+                  m_sentIndex[currentItem->m_startSeq] = it;
+                }
               if (listEdited)
                 {
                   *listEdited = true;
@@ -565,6 +621,10 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
 
           MergeItems (currentItem, next);
           list.erase (it);
+          if (indexed)
+            {
+              m_sentIndex.erase (next->m_startSeq);
+            }
 
           delete next;
 
@@ -693,6 +753,7 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
 
           RemoveFromCounts (item, pktSize);
 
+          m_sentIndex.erase (item->m_startSeq);
           i = m_sentList.erase (i);
           NS_LOG_INFO ("Removed " << *item << " lost: " << m_lostOut <<
                        " retrans: " << m_retrans << " sacked: " << m_sackedOut <<
@@ -705,7 +766,9 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
           NS_LOG_INFO (*item);
           // PacketTags are preserved when fragmenting
           item->m_packet = item->m_packet->CreateFragment (offset, pktSize);
+          m_sentIndex.erase (item->m_startSeq);
           item->m_startSeq += offset;
+          m_sentIndex[item->m_startSeq] = i;
           m_size -= offset;
           m_sentSize -= offset;
           m_firstByteSeq += offset;
@@ -735,6 +798,7 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
           // when adding Reno dupacks in the count.
           head->m_sacked = false;
           m_sackedOut -= head->m_packet->GetSize ();
+          m_lostUpTo = m_nextSegHint = m_firstByteSeq;
           NS_LOG_INFO ("Moving the SACK flag from the HEAD to another segment");
           AddRenoSack ();
           MarkHeadAsLost ();
@@ -750,6 +814,11 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
       m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
     }
 
+  // The watermarks can not point before SND.UNA
+  m_lostUpTo = std::max (m_lostUpTo, m_firstByteSeq.Get ());
+  m_lostHigh = std::max (m_lostHigh, m_firstByteSeq.Get ());
+  m_nextSegHint = std::max (m_nextSegHint, m_firstByteSeq.Get ());
+
   NS_LOG_DEBUG ("Discarded up to " << seq << " lost: " << m_lostOut <<
                 " retrans: " << m_retrans << " sacked: " << m_sackedOut);
   NS_LOG_LOGIC ("Buffer status after discarding data " << *this);
@@ -768,18 +837,19 @@ TcpTxBuffer::Update (const TcpOptionSack::SackList &list)
 
   for (auto option_it = list.begin (); option_it != list.end (); ++option_it)
     {
-      PacketList::iterator item_it = m_sentList.begin ();
-      SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
-
       if (m_firstByteSeq + m_sentSize < (*option_it).first && !modified)
         {
           NS_LOG_INFO ("Not updating scoreboard, the option block is outside the sent list");
           return false;
         }
 
+      // The items starting before the block can not be sacked by it
+      PacketList::iterator item_it = FindSentItem ((*option_it).first);
+
       while (item_it != m_sentList.end ())
         {
           uint32_t pktSize = (*item_it)->m_packet->GetSize ();
+          SequenceNumber32 beginOfCurrentPacket = (*item_it)->m_startSeq;
 
           // Check the boundary of this packet ... only mark as sacked if
           // it is precisely mapped over the option. It means that if the receiver
@@ -829,7 +899,6 @@ TcpTxBuffer::Update (const TcpOptionSack::SackList &list)
               break;
             }
 
-          beginOfCurrentPacket += pktSize;
           ++item_it;
         }
     }
@@ -853,46 +922,49 @@ TcpTxBuffer::UpdateLostCount ()
 {
   NS_LOG_FUNCTION (this);
   uint32_t sacked = 0;
-  SequenceNumber32 beginOfCurrentPacket = m_highestSack.second;
   if (m_highestSack.first == m_sentList.end ())
     {
-      NS_LOG_INFO ("Status before the update: " << *this <<
-                   ", will start from the latest sent item");
-    }
-  else
-    {
-      NS_LOG_INFO ("Status before the update: " << *this <<
-                   ", will start from item " << *(*m_highestSack.first));
+      NS_LOG_INFO ("Nothing sacked, nothing to mark as lost");
+      return;
     }
+  NS_LOG_INFO ("Status before the update: " << *this <<
+               ", will start from item " << *(*m_highestSack.first));
 
-  for (auto it = m_highestSack.first; it != m_sentList.begin(); --it)
+  // Find the dupThresh-th sacked item, going back from the highest one; the
+  // items before it are lost, unless sacked. The head is never sacked.
+  PacketList::const_iterator threshIt = m_sentList.end ();
+  for (auto it = m_highestSack.first; it != m_sentList.begin (); --it)
     {
-      TcpTxItem *item = *it;
-      if (item->m_sacked)
+      if ((*it)->m_sacked && ++sacked >= m_dupAckThresh)
         {
-          sacked++;
+          threshIt = it;
+          break;
         }
+    }
+
+  if (threshIt == m_sentList.end ())
+    {
+      NS_LOG_INFO ("Less than " << m_dupAckThresh << " sacked items");
+      return;
+    }
 
-      if (sacked >= m_dupAckThresh)
+  // The items before m_lostUpTo have already been marked
+  SequenceNumber32 threshSeq = (*threshIt)->m_startSeq;
+  if (threshSeq > m_lostUpTo)
+    {
+      for (auto it = FindSentItem (m_lostUpTo); it != threshIt; ++it)
         {
+          TcpTxItem *item = *it;
           if (!item->m_sacked && !item->m_lost)
             {
               item->m_lost = true;
               m_lostOut += item->m_packet->GetSize ();
+              UpdateLostHigh (item);
             }
         }
-      beginOfCurrentPacket -= item->m_packet->GetSize ();
+      m_lostUpTo = threshSeq;
     }
 
-  if (sacked >= m_dupAckThresh)
-    {
-      TcpTxItem *item = *m_sentList.begin ();
-      if (!item->m_lost)
-        {
-          item->m_lost = true;
-          m_lostOut += item->m_packet->GetSize ();
-        }
-    }
   NS_LOG_INFO ("Status after the update: " << *this);
   ConsistencyCheck ();
 }
@@ -902,35 +974,25 @@ TcpTxBuffer::IsLost (const SequenceNumber32 &seq) const
 {
   NS_LOG_FUNCTION (this << seq);
 
-  SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
-  PacketList::const_iterator it;
-
   if (seq >= m_highestSack.second)
     {
       return false;
     }
 
-  // In theory, using a map and hints when inserting elements can improve
-  // performance
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  // The first lost or sacked item starting at or after seq decides
+  for (auto it = FindSentItem (seq); it != m_sentList.end (); ++it)
     {
-      // Search for the right iterator before calling IsLost()
-      if (beginOfCurrentPacket >= seq)
+      if ((*it)->m_lost == true)
         {
-          if ((*it)->m_lost == true)
-            {
-              NS_LOG_INFO ("seq=" << seq << " is lost because of lost flag");
-              return true;
-            }
-
-          if ((*it)->m_sacked == true)
-            {
-              NS_LOG_INFO ("seq=" << seq << " is not lost because of sacked flag");
-              return false;
-            }
+          NS_LOG_INFO ("seq=" << seq << " is lost because of lost flag");
+          return true;
         }
 
-      beginOfCurrentPacket += (*it)->m_packet->GetSize ();
+      if ((*it)->m_sacked == true)
+        {
+          NS_LOG_INFO ("seq=" << seq << " is not lost because of sacked flag");
+          return false;
+        }
     }
 
   return false;
@@ -954,19 +1016,40 @@ TcpTxBuffer::NextSeg (SequenceNumber32 *seq, bool isRecovery) const
    *
    *     (1.c) IsLost (S2) returns true.
    */
-  PacketList::const_iterator it;
+  PacketList::const_iterator it = m_sentList.begin ();
   TcpTxItem *item;
   SequenceNumber32 seqPerRule3;
   bool isSeqPerRule3Valid = false;
-  SequenceNumber32 beginOfCurrentPkt = m_firstByteSeq;
+  bool hintFound = false;
 
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  // The items before m_nextSegHint are sacked or retransmitted: skip them
+  SentIndex::const_iterator index = m_sentIndex.upper_bound (m_nextSegHint);
+  if (index != m_sentIndex.begin ())
+    {
+      it = (--index)->second;
+    }
+
+  for (; it != m_sentList.end (); ++it)
     {
       item = *it;
+      SequenceNumber32 beginOfCurrentPkt = item->m_startSeq;
+
+      // No item is lost from m_lostHigh on, so rule (1) can not succeed
+      if (hintFound && beginOfCurrentPkt >= m_lostHigh
+          && (!isRecovery || seqPerRule3.GetValue () != 0))
+        {
+          break;
+        }
 
       // Condition 1.a , 1.b , and 1.c
       if (item->m_retrans == false && item->m_sacked == false)
         {
+          if (!hintFound)
+            {
+              hintFound = true;
+              m_nextSegHint = beginOfCurrentPkt;
+            }
+
           if (item->m_lost)
             {
               NS_LOG_INFO("IsLost, returning" << beginOfCurrentPkt);
@@ -980,9 +1063,11 @@ TcpTxBuffer::NextSeg (SequenceNumber32 *seq, bool isRecovery) const
               seqPerRule3 = beginOfCurrentPkt;
             }
         }
+    }
 
-      // Nothing found, iterate
-      beginOfCurrentPkt += item->m_packet->GetSize ();
+  if (!hintFound)
+    {
+      m_nextSegHint = m_firstByteSeq + m_sentSize;
     }
 
   /* (2) If no sequence number 'S2' per rule (1) exists but there
@@ -1186,6 +1271,7 @@ TcpTxBuffer::ResetRenoSack ()
     }
 
   m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
+  m_lostUpTo = m_nextSegHint = m_firstByteSeq;
 }
 
 void
@@ -1203,6 +1289,8 @@ TcpTxBuffer::ResetSentList ()
       m_sentList.pop_back ();
     }
 
+  m_sentIndex.clear ();
+  m_lostUpTo = m_lostHigh = m_nextSegHint = m_firstByteSeq;
   m_sentSize = 0;
   m_lostOut = 0;
   m_retrans = 0;
@@ -1218,8 +1306,11 @@ TcpTxBuffer::ResetLastSegmentSent ()
     {
       TcpTxItem *item = m_sentList.back ();
 
+      m_sentIndex.erase (item->m_startSeq);
       m_sentList.pop_back ();
       m_sentSize -= item->m_packet->GetSize ();
+      m_lostUpTo = std::min (m_lostUpTo, item->m_startSeq);
+      m_nextSegHint = std::min (m_nextSegHint, item->m_startSeq);
       if (item->m_retrans)
         {
           m_retrans -= item->m_packet->GetSize ();
@@ -1246,6 +1337,10 @@ TcpTxBuffer::SetSentListLost (bool resetSack)
       m_lostOut = 0;
     }
 
+  // Every item is now lost or sacked, and none is retransmitted
+  m_lostUpTo = m_lostHigh = m_firstByteSeq + m_sentSize;
+  m_nextSegHint = m_firstByteSeq;
+
   for (auto it = m_sentList.begin (); it != m_sentList.end (); ++it)
     {
       if (resetSack)
@@ -1303,6 +1398,7 @@ TcpTxBuffer::DeleteRetransmittedFlagFromHead ()
     {
       m_sentList.front ()->m_retrans = false;
       m_retrans -= m_sentList.front ()->m_packet->GetSize ();
+      m_nextSegHint = m_firstByteSeq;
     }
   ConsistencyCheck ();
 }
@@ -1331,7 +1427,9 @@ TcpTxBuffer::MarkHeadAsLost ()
         {
           m_sentList.front()->m_lost = true;
           m_lostOut += m_sentList.front ()->m_packet->GetSize ();
+          UpdateLostHigh (m_sentList.front ());
         }
+      m_nextSegHint = m_firstByteSeq;
     }
   ConsistencyCheck ();
 }
@@ -1384,8 +1482,24 @@ TcpTxBuffer::ConsistencyCheck () const
   uint32_t lost = 0;
   uint32_t retrans = 0;
 
+  NS_ASSERT_MSG (m_sentIndex.size () == m_sentList.size (), "Indexed " <<
+                 m_sentIndex.size () << " sent items out of " << m_sentList.size ());
+
   for (auto it = m_sentList.begin (); it != m_sentList.end (); ++it)
     {
+      SequenceNumber32 start = (*it)->m_startSeq;
+      SentIndex::const_iterator index = m_sentIndex.find (start);
+      NS_ASSERT_MSG (index != m_sentIndex.end () && index->second == it,
+                     "Sent item " << **it << " is not indexed");
+      NS_ASSERT_MSG (start >= m_lostUpTo || (*it)->m_sacked || (*it)->m_lost,
+                     "Sent item " << **it << " before " << m_lostUpTo <<
+                     " is neither sacked nor lost");
+      NS_ASSERT_MSG (start >= m_nextSegHint || (*it)->m_sacked || (*it)->m_retrans,
+                     "Sent item " << **it << " before " << m_nextSegHint <<
+                     " is neither sacked nor retransmitted");
+      NS_ASSERT_MSG (start + (*it)->m_packet->GetSize () <= m_lostHigh || !(*it)->m_lost,
+                     "Sent item " << **it << " after " << m_lostHigh << " is lost");
+
       if ((*it)->m_sacked)
         {
           sacked += (*it)->m_packet->GetSize ();
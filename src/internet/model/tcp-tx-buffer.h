@@ -28,6 +28,7 @@
 #include "ns3/nstime.h"
 #include "ns3/tcp-option-sack.h"
 #include "ns3/packet.h"
+#include <map>
 
 namespace ns3 {
 class Packet;
@@ -105,6 +106,16 @@ public:
  * documentation) and maintaining the scoreboard is a matter of travelling the
  * list and set the SACK flag on the corresponding segment sent.
  *
+ * So that the cost of the scoreboard operations does not grow with the
+ * number of segments in flight, the items of the sent list are also indexed
+ * by their starting sequence number in a balanced search tree (std::map).
+ * The SACK blocks, the lost checks and the retransmissions look up the first
+ * item involved in logarithmic time, instead of walking the list from its
+ * head. The lost marking (UpdateLostCount) and the search for the next
+ * segment to transmit (NextSeg) also remember the sequence numbers below
+ * which the sent items need no further processing, so that each item is
+ * visited a bounded number of times between two resets of the scoreboard.
+ *
  * Item properties
  * ---------------
  *
@@ -426,12 +437,25 @@ private:
    * The {New}Reno cases, for now, are managed in TcpSocketBase through the
    * call to MarkHeadAsLost.
    * This function is, therefore, called after a SACK option has been received,
-   * and updates the lost count. It can be probably optimized by not walking
-   * the entire list, but a subset.
+   * and updates the lost count. Only the items between m_lostUpTo and the
+   * dupThresh-th sacked item from the highest one are visited.
    *
    */
   void UpdateLostCount ();
 
+  /**
+   * \brief Find the first sent item starting at or after a sequence number
+   * \param seq the sequence number
+   * \return an iterator to the item, or the end of the sent list
+   */
+  PacketList::iterator FindSentItem (const SequenceNumber32 &seq) const;
+
+  /**
+   * \brief Raise the sequence number above which no sent byte is lost
+   * \param item an item marked as lost
+   */
+  void UpdateLostHigh (const TcpTxItem *item);
+
   /**
    * \brief Remove the size specified from the lostOut, retrans, sacked count
    *
@@ -560,7 +584,7 @@ private:
    */
   TcpTxItem* GetPacketFromList (PacketList &list, const SequenceNumber32 &startingSeq,
                                 uint32_t numBytes, const SequenceNumber32 &requestedSeq,
-                                bool *listEdited = nullptr) const;
+                                bool *listEdited = nullptr);
 
   /**
    * \brief Merge two TcpTxItem
@@ -608,6 +632,13 @@ private:
   TracedValue<SequenceNumber32> m_firstByteSeq; //!< Sequence number of the first byte in data (SND.UNA)
   std::pair <PacketList::const_iterator, SequenceNumber32> m_highestSack; //!< Highest SACK byte
 
+  typedef std::map<SequenceNumber32, PacketList::iterator> SentIndex; //!< index of the sent items by starting sequence number
+
+  SentIndex m_sentIndex;            //!< Items of m_sentList indexed by their starting sequence number
+  SequenceNumber32 m_lostUpTo;      //!< The sent items starting before this sequence are sacked or lost
+  SequenceNumber32 m_lostHigh;      //!< No sent byte at or after this sequence is lost
+  mutable SequenceNumber32 m_nextSegHint; //!< The sent items starting before this sequence are sacked or retransmitted
+
   uint32_t m_lostOut   {0}; //!< Number of lost bytes
   uint32_t m_sackedOut {0}; //!< Number of sacked bytes
   uint32_t m_retrans   {0}; //!< Number of retransmitted bytes
@@ -0,0 +1,293 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv4-interface-address.h"
+#include "../model/ipv4-end-point-demux.h"
+#include "../model/ipv4-end-point.h"
+#include "../model/ipv6-end-point-demux.h"
+#include "../model/ipv6-end-point.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Ipv4EndPointDemux test: a listening end point and many connected
+ * end points share the same local port, and the lookups must find the most
+ * specific end point as the end points are connected, re-addressed and
+ * deallocated.
+ */
+class Ipv4EndPointDemuxTestCase : public TestCase
+{
+public:
+  Ipv4EndPointDemuxTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Look up a single end point
+   * \param demux the demux
+   * \param daddr destination address
+   * \param dport destination port
+   * \param saddr source address
+   * \param sport source port
+   * \param interface the incoming interface
+   * \return the end point found, or 0
+   */
+  Ipv4EndPoint * LookupOne (Ipv4EndPointDemux &demux, Ipv4Address daddr, uint16_t dport,
+                            Ipv4Address saddr, uint16_t sport, Ptr<Ipv4Interface> interface);
+};
+
+Ipv4EndPointDemuxTestCase::Ipv4EndPointDemuxTestCase ()
+  : TestCase ("Check the lookups of the IPv4 end point demux")
+{
+}
+
+Ipv4EndPoint *
+Ipv4EndPointDemuxTestCase::LookupOne (Ipv4EndPointDemux &demux, Ipv4Address daddr, uint16_t dport,
+                                      Ipv4Address saddr, uint16_t sport, Ptr<Ipv4Interface> interface)
+{
+  Ipv4EndPointDemux::EndPoints endPoints = demux.Lookup (daddr, dport, saddr, sport, interface);
+  return endPoints.empty () ? 0 : endPoints.front ();
+}
+
+void
+Ipv4EndPointDemuxTestCase::DoRun (void)
+{
+  Ptr<Ipv4Interface> interface = CreateObject<Ipv4Interface> ();
+  interface->SetDevice (CreateObject<SimpleNetDevice> ());
+  interface->AddAddress (Ipv4InterfaceAddress (Ipv4Address ("10.1.1.1"), Ipv4Mask ("/24")));
+  Ipv4Address local ("10.1.1.1");
+
+  Ipv4EndPointDemux demux;
+  Ipv4EndPoint *listener = demux.Allocate (Ptr<NetDevice> (), 80);
+  NS_TEST_ASSERT_MSG_NE (listener, 0, "Failed to allocate the listening end point");
+  NS_TEST_EXPECT_MSG_EQ (demux.Allocate (Ptr<NetDevice> (), 80), 0, "Duplicated end point");
+
+  // connections accepted by the listener
+  std::vector<Ipv4EndPoint *> connected;
+  for (uint32_t i = 0; i < 200; i++)
+    {
+      Ipv4EndPoint *endPoint = demux.Allocate (Ptr<NetDevice> (), local, 80, Ipv4Address (0x0a020000 + i), 1024 + i);
+      NS_TEST_ASSERT_MSG_NE (endPoint, 0, "Failed to allocate a connected end point");
+      connected.push_back (endPoint);
+    }
+  NS_TEST_EXPECT_MSG_EQ (demux.Allocate (Ptr<NetDevice> (), local, 80, Ipv4Address (0x0a020000), 1024), 0,
+                         "Duplicated end point");
+  for (uint32_t i = 0; i < connected.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (LookupOne (demux, local, 80, Ipv4Address (0x0a020000 + i), 1024 + i, interface),
+                             connected[i], "Wrong end point for connection " << i);
+    }
+  // new connections and broadcasts reach the listener
+  NS_TEST_EXPECT_MSG_EQ (LookupOne (demux, local, 80, Ipv4Address (0x0a020000), 999, interface),
+                         listener, "Wrong end point for a new connection");
+  NS_TEST_EXPECT_MSG_EQ (LookupOne (demux, Ipv4Address ("10.1.1.255"), 80, Ipv4Address ("10.3.0.1"), 1, interface),
+                         listener, "Wrong end point for a broadcast");
+  NS_TEST_EXPECT_MSG_EQ (LookupOne (demux, local, 81, Ipv4Address (0x0a020000), 1024, interface),
+                         0, "Unexpected end point");
+  NS_TEST_EXPECT_MSG_EQ (demux.SimpleLookup (local, 80, Ipv4Address (0x0a020005), 1029), connected[5],
+                         "Wrong end point for the simple lookup");
+
+  // an end point bound to the subnet receives the subnet-directed broadcasts
+  Ipv4EndPoint *subnet = demux.Allocate (Ptr<NetDevice> (), Ipv4Address ("10.1.1.0"), 90);
+  NS_TEST_ASSERT_MSG_NE (subnet, 0, "Failed to allocate the subnet end point");
+  NS_TEST_EXPECT_MSG_EQ (LookupOne (demux, Ipv4Address ("10.1.1.255"), 90, Ipv4Address ("10.3.0.1"), 1, interface),
+                         subnet, "Wrong end point for a subnet-directed broadcast");
+  subnet->SetPeer (Ipv4Address ("10.3.0.1"), 1);
+  NS_TEST_EXPECT_MSG_EQ (LookupOne (demux, Ipv4Address ("10.1.1.255"), 90, Ipv4Address ("10.3.0.1"), 1, interface),
+                         subnet, "Wrong end point for a connected subnet end point");
+  NS_TEST_EXPECT_MSG_EQ (LookupOne (demux, Ipv4Address ("10.1.1.255"), 90, Ipv4Address ("10.3.0.2"), 1, interface),
+                         0, "Unexpected end point for another peer");
+  demux.DeAllocate (subnet);
+
+  // an active open: ephemeral port, then local address and peer are set
+  Ipv4EndPoint *client = demux.Allocate ();
+  NS_TEST_ASSERT_MSG_NE (client, 0, "Failed to allocate the client end point");
+  uint16_t port = client->GetLocalPort ();
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (port), true, "The ephemeral port should be in use");
+  client->SetLocalAddress (local);
+  client->SetPeer (Ipv4Address ("10.4.0.1"), 80);
+  NS_TEST_EXPECT_MSG_EQ (LookupOne (demux, local, port, Ipv4Address ("10.4.0.1"), 80, interface),
+                         client, "Wrong end point for the client");
+  NS_TEST_EXPECT_MSG_EQ (LookupOne (demux, local, port, Ipv4Address ("10.4.0.2"), 80, interface),
+                         0, "Unexpected end point for another peer");
+  client->SetPeer (Ipv4Address::GetAny (), 0);
+  NS_TEST_EXPECT_MSG_EQ (LookupOne (demux, local, port, Ipv4Address ("10.4.0.2"), 80, interface),
+                         client, "Wrong end point for the disconnected client");
+  demux.DeAllocate (client);
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (port), false, "The ephemeral port should be free");
+
+  // end points with rx disabled are skipped
+  connected[7]->SetRxEnabled (false);
+  NS_TEST_EXPECT_MSG_EQ (LookupOne (demux, local, 80, Ipv4Address (0x0a020007), 1031, interface),
+                         listener, "The listener should receive the packets of a closed connection");
+
+  // deallocated connections fall back to the listener
+  for (uint32_t i = 0; i < connected.size (); i += 2)
+    {
+      demux.DeAllocate (connected[i]);
+    }
+  for (uint32_t i = 1; i < connected.size (); i += 2)
+    {
+      NS_TEST_EXPECT_MSG_EQ (LookupOne (demux, local, 80, Ipv4Address (0x0a020000 + i), 1024 + i, interface),
+                             (i == 7 ? listener : connected[i]), "Wrong end point for connection " << i);
+      NS_TEST_EXPECT_MSG_EQ (LookupOne (demux, local, 80, Ipv4Address (0x0a020000 + i - 1), 1023 + i, interface),
+                             listener, "Wrong end point for closed connection " << i - 1);
+    }
+  NS_TEST_EXPECT_MSG_EQ (demux.GetAllEndPoints ().size (), 1 + connected.size () / 2, "Unexpected number of end points");
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupLocal (Ptr<NetDevice> (), Ipv4Address::GetAny (), 80), true, "Missing listener");
+  demux.DeAllocate (listener);
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupLocal (Ptr<NetDevice> (), Ipv4Address::GetAny (), 80), false, "Unexpected listener");
+  NS_TEST_EXPECT_MSG_EQ (LookupOne (demux, local, 80, Ipv4Address (0x0a020000), 999, interface),
+                         0, "Unexpected end point");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Ipv6EndPointDemux test: a listening end point and many connected
+ * end points share the same local port, and the lookups must find the most
+ * specific end point as the end points are connected and deallocated.
+ */
+class Ipv6EndPointDemuxTestCase : public TestCase
+{
+public:
+  Ipv6EndPointDemuxTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Look up a single end point
+   * \param demux the demux
+   * \param daddr destination address
+   * \param dport destination port
+   * \param saddr source address
+   * \param sport source port
+   * \return the end point found, or 0
+   */
+  Ipv6EndPoint * LookupOne (Ipv6EndPointDemux &demux, Ipv6Address daddr, uint16_t dport,
+                            Ipv6Address saddr, uint16_t sport);
+
+  /**
+   * \param i the index of a peer
+   * \return the address of the peer
+   */
+  static Ipv6Address GetPeer (uint32_t i);
+};
+
+Ipv6EndPointDemuxTestCase::Ipv6EndPointDemuxTestCase ()
+  : TestCase ("Check the lookups of the IPv6 end point demux")
+{
+}
+
+Ipv6EndPoint *
+Ipv6EndPointDemuxTestCase::LookupOne (Ipv6EndPointDemux &demux, Ipv6Address daddr, uint16_t dport,
+                                      Ipv6Address saddr, uint16_t sport)
+{
+  Ipv6EndPointDemux::EndPoints endPoints = demux.Lookup (daddr, dport, saddr, sport, 0);
+  return endPoints.empty () ? 0 : endPoints.front ();
+}
+
+Ipv6Address
+Ipv6EndPointDemuxTestCase::GetPeer (uint32_t i)
+{
+  uint8_t address[16] = { 0x20, 0x01, 0x0d, 0xb8, 0, 2 };
+  address[14] = i >> 8;
+  address[15] = i & 0xff;
+  return Ipv6Address (address);
+}
+
+void
+Ipv6EndPointDemuxTestCase::DoRun (void)
+{
+  Ipv6Address local ("2001:db8:0:1::1");
+
+  Ipv6EndPointDemux demux;
+  Ipv6EndPoint *listener = demux.Allocate (Ptr<NetDevice> (), 80);
+  NS_TEST_ASSERT_MSG_NE (listener, 0, "Failed to allocate the listening end point");
+
+  std::vector<Ipv6EndPoint *> connected;
+  for (uint32_t i = 0; i < 200; i++)
+    {
+      Ipv6EndPoint *endPoint = demux.Allocate (Ptr<NetDevice> (), local, 80, GetPeer (i), 1024 + i);
+      NS_TEST_ASSERT_MSG_NE (endPoint, 0, "Failed to allocate a connected end point");
+      connected.push_back (endPoint);
+    }
+  NS_TEST_EXPECT_MSG_EQ (demux.Allocate (Ptr<NetDevice> (), local, 80, GetPeer (0), 1024), 0,
+                         "Duplicated end point");
+  for (uint32_t i = 0; i < connected.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (LookupOne (demux, local, 80, GetPeer (i), 1024 + i),
+                             connected[i], "Wrong end point for connection " << i);
+    }
+  NS_TEST_EXPECT_MSG_EQ (LookupOne (demux, local, 80, GetPeer (0), 999),
+                         listener, "Wrong end point for a new connection");
+  NS_TEST_EXPECT_MSG_EQ (demux.SimpleLookup (local, 80, GetPeer (5), 1029), connected[5],
+                         "Wrong end point for the simple lookup");
+
+  Ipv6EndPoint *client = demux.Allocate ();
+  NS_TEST_ASSERT_MSG_NE (client, 0, "Failed to allocate the client end point");
+  uint16_t port = client->GetLocalPort ();
+  client->SetLocalAddress (local);
+  client->SetPeer (GetPeer (1000), 80);
+  NS_TEST_EXPECT_MSG_EQ (LookupOne (demux, local, port, GetPeer (1000), 80),
+                         client, "Wrong end point for the client");
+  NS_TEST_EXPECT_MSG_EQ (LookupOne (demux, local, port, GetPeer (1001), 80),
+                         0, "Unexpected end point for another peer");
+  demux.DeAllocate (client);
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (port), false, "The ephemeral port should be free");
+
+  for (uint32_t i = 0; i < connected.size (); i += 2)
+    {
+      demux.DeAllocate (connected[i]);
+    }
+  for (uint32_t i = 1; i < connected.size (); i += 2)
+    {
+      NS_TEST_EXPECT_MSG_EQ (LookupOne (demux, local, 80, GetPeer (i), 1024 + i),
+                             connected[i], "Wrong end point for connection " << i);
+      NS_TEST_EXPECT_MSG_EQ (LookupOne (demux, local, 80, GetPeer (i - 1), 1023 + i),
+                             listener, "Wrong end point for closed connection " << i - 1);
+    }
+  NS_TEST_EXPECT_MSG_EQ (demux.GetEndPoints ().size (), 1 + connected.size () / 2, "Unexpected number of end points");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief End point demux TestSuite
+ */
+class EndPointDemuxTestSuite : public TestSuite
+{
+public:
+  EndPointDemuxTestSuite ();
+};
+
+EndPointDemuxTestSuite::EndPointDemuxTestSuite ()
+  : TestSuite ("end-point-demux", UNIT)
+{
+  AddTestCase (new Ipv4EndPointDemuxTestCase (), TestCase::QUICK);
+  AddTestCase (new Ipv6EndPointDemuxTestCase (), TestCase::QUICK);
+}
+
+static EndPointDemuxTestSuite g_endPointDemuxTestSuite; //!< Static variable for test initialization
@@ -15,6 +15,9 @@
  */
 
 #include <vector>
+#include <set>
+#include <algorithm>
+#include <sstream>
 #include "ns3/boolean.h"
 #include "ns3/config.h"
 #include "ns3/inet-socket-address.h"
@@ -42,6 +45,9 @@
 #include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/ipv4-global-routing.h"
 #include "ns3/bridge-helper.h"
+#include "ns3/global-route-manager-impl.h"
+#include "ns3/simulation-singleton.h"
+#include "ns3/tcp-header.h"
 
 using namespace ns3;
 
@@ -1244,6 +1250,331 @@ Ipv4GlobalRoutingSlash32TestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 GlobalRouting incremental and parallel route computation test
+ *
+ * Eight routers r0...r7 are connected in a line by point-to-point links,
+ * with an additional link between r1 and r5.  Router r3 is also attached
+ * to a stub network.  The routes computed by threads and updated
+ * incrementally after some interfaces are set down are checked against a
+ * full computation by a single thread.
+ */
+class Ipv4GlobalRoutingUpdateTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingUpdateTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Get the global routes of all the routers
+   * \param sorted whether the routes of each router are sorted
+   * \returns the routes of each router
+   */
+  std::vector<std::vector<std::string> > GetRoutes (bool sorted) const;
+
+  /**
+   * \brief Recompute the routes
+   * \param incremental whether the routes are updated incrementally
+   * \param nThreads the number of threads computing the routes
+   */
+  void Recompute (bool incremental, uint32_t nThreads);
+
+  NodeContainer m_nodes; //!< the routers
+};
+
+Ipv4GlobalRoutingUpdateTestCase::Ipv4GlobalRoutingUpdateTestCase ()
+  : TestCase ("Incremental and parallel global route computation")
+{
+}
+
+std::vector<std::vector<std::string> >
+Ipv4GlobalRoutingUpdateTestCase::GetRoutes (bool sorted) const
+{
+  std::vector<std::vector<std::string> > routes;
+  for (uint32_t i = 0; i < m_nodes.GetN (); i++)
+    {
+      Ptr<Ipv4GlobalRouting> routing = m_nodes.Get (i)->GetObject<Ipv4> ()->GetRoutingProtocol ()->GetObject<Ipv4GlobalRouting> ();
+      std::vector<std::string> nodeRoutes;
+      for (uint32_t j = 0; j < routing->GetNRoutes (); j++)
+        {
+          std::ostringstream oss;
+          oss << *routing->GetRoute (j);
+          nodeRoutes.push_back (oss.str ());
+        }
+      if (sorted)
+        {
+          std::sort (nodeRoutes.begin (), nodeRoutes.end ());
+        }
+      routes.push_back (nodeRoutes);
+    }
+  return routes;
+}
+
+void
+Ipv4GlobalRoutingUpdateTestCase::Recompute (bool incremental, uint32_t nThreads)
+{
+  Config::SetGlobal ("GlobalRoutingIncremental", BooleanValue (incremental));
+  Config::SetGlobal ("GlobalRoutingThreads", UintegerValue (nThreads));
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+}
+
+void
+Ipv4GlobalRoutingUpdateTestCase::DoRun (void)
+{
+  m_nodes.Create (8);
+  SimpleNetDeviceHelper simpleHelper;
+  simpleHelper.SetNetDevicePointToPointMode (true);
+  std::vector<NetDeviceContainer> links;
+  for (uint32_t i = 0; i + 1 < m_nodes.GetN (); i++)
+    {
+      links.push_back (simpleHelper.Install (NodeContainer (m_nodes.Get (i), m_nodes.Get (i + 1))));
+    }
+  links.push_back (simpleHelper.Install (NodeContainer (m_nodes.Get (1), m_nodes.Get (5))));
+  SimpleNetDeviceHelper lanHelper;
+  NetDeviceContainer lan = lanHelper.Install (m_nodes.Get (3));
+
+  InternetStackHelper internet;
+  Ipv4GlobalRoutingHelper ipv4RoutingHelper;
+  internet.SetRoutingHelper (ipv4RoutingHelper);
+  internet.Install (m_nodes);
+
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.252");
+  for (uint32_t i = 0; i < links.size (); i++)
+    {
+      ipv4.Assign (links[i]);
+      ipv4.NewNetwork ();
+    }
+  ipv4.SetBase ("10.2.1.0", "255.255.255.0");
+  ipv4.Assign (lan);
+
+  GlobalRouteManagerImpl* manager = SimulationSingleton<GlobalRouteManagerImpl>::Get ();
+
+  // all the trees are computed, by three threads
+  Config::SetGlobal ("GlobalRoutingIncremental", BooleanValue (true));
+  Config::SetGlobal ("GlobalRoutingThreads", UintegerValue (3));
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  NS_TEST_EXPECT_MSG_EQ (manager->GetNSPFCalculations (), 8, "Unexpected number of SPF calculations");
+  std::vector<std::vector<std::string> > initial = GetRoutes (false);
+
+  // without any change, only the routes of the stub routers r0 and r7 are
+  // computed again
+  Recompute (true, 3);
+  NS_TEST_EXPECT_MSG_EQ (manager->GetNSPFCalculations (), 2, "Unexpected number of SPF calculations");
+  NS_TEST_EXPECT_MSG_EQ ((GetRoutes (false) == initial), true, "The routes should not change");
+
+  // the stub network of r3 goes down: the trees of r3 and of its neighbors
+  // r2 and r4 are computed again
+  Ptr<Ipv4> ipv4r3 = m_nodes.Get (3)->GetObject<Ipv4> ();
+  ipv4r3->SetDown (ipv4r3->GetInterfaceForDevice (lan.Get (0)));
+  Recompute (true, 3);
+  NS_TEST_EXPECT_MSG_EQ (manager->GetNSPFCalculations (), 5, "Unexpected number of SPF calculations");
+  std::vector<std::vector<std::string> > stubDown = GetRoutes (true);
+
+  // the link between r4 and r5 goes down
+  Ptr<Ipv4> ipv4r4 = m_nodes.Get (4)->GetObject<Ipv4> ();
+  uint32_t r4r5 = ipv4r4->GetInterfaceForDevice (links[4].Get (0));
+  ipv4r4->SetDown (r4r5);
+  Recompute (true, 1);
+  std::vector<std::vector<std::string> > linkDown = GetRoutes (true);
+
+  // check the routes against a full computation
+  Recompute (false, 1);
+  NS_TEST_EXPECT_MSG_EQ (manager->GetNSPFCalculations (), 8, "Unexpected number of SPF calculations");
+  NS_TEST_EXPECT_MSG_EQ ((GetRoutes (true) == linkDown), true, "Incremental routes differ from full computation");
+  ipv4r4->SetUp (r4r5);
+  Recompute (false, 1);
+  NS_TEST_EXPECT_MSG_EQ ((GetRoutes (true) == stubDown), true, "Incremental routes differ from full computation");
+  ipv4r3->SetUp (ipv4r3->GetInterfaceForDevice (lan.Get (0)));
+  Recompute (false, 1);
+  NS_TEST_EXPECT_MSG_EQ ((GetRoutes (false) == initial), true, "Routes computed by threads differ from full computation");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 GlobalRouting flow ECMP and route aggregation Test
+ *
+ * Two equal-cost paths r0 - r1 - r3 and r0 - r2 - r3 lead to the leaves
+ * r4 to r7 of r3. The packets of a flow must follow the same path while
+ * different flows use both paths, and the aggregation of the routes must
+ * reduce the routing tables without changing any forwarding decision.
+ */
+class Ipv4GlobalRoutingEcmpTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingEcmpTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Get the routing protocol of a router
+   * \param i the index of the router
+   * \returns the global routing protocol
+   */
+  Ptr<Ipv4GlobalRouting> GetRouting (uint32_t i) const;
+
+  /**
+   * \brief Look up a route for a TCP packet
+   * \param i the index of the router
+   * \param dest the destination
+   * \param port the source port
+   * \returns the gateway and the output device of the route, or an empty
+   *          string if none
+   */
+  std::string Lookup (uint32_t i, Ipv4Address dest, uint16_t port) const;
+
+  /**
+   * \brief Get the forwarding decisions of all the routers
+   * \returns the gateway and output device for a set of destinations and flows
+   */
+  std::vector<std::string> GetDecisions (void) const;
+
+  /**
+   * \returns the total number of routes
+   */
+  uint32_t GetNRoutes (void) const;
+
+  NodeContainer m_nodes; //!< the routers
+};
+
+Ipv4GlobalRoutingEcmpTestCase::Ipv4GlobalRoutingEcmpTestCase ()
+  : TestCase ("Flow ECMP and route aggregation")
+{
+}
+
+Ptr<Ipv4GlobalRouting>
+Ipv4GlobalRoutingEcmpTestCase::GetRouting (uint32_t i) const
+{
+  return m_nodes.Get (i)->GetObject<Ipv4> ()->GetRoutingProtocol ()->GetObject<Ipv4GlobalRouting> ();
+}
+
+std::string
+Ipv4GlobalRoutingEcmpTestCase::Lookup (uint32_t i, Ipv4Address dest, uint16_t port) const
+{
+  Ptr<Packet> p = Create<Packet> (100);
+  TcpHeader tcpHeader;
+  tcpHeader.SetSourcePort (port);
+  tcpHeader.SetDestinationPort (80);
+  p->AddHeader (tcpHeader);
+  Ipv4Header header;
+  header.SetSource (m_nodes.Get (i)->GetObject<Ipv4> ()->GetAddress (1, 0).GetLocal ());
+  header.SetDestination (dest);
+  header.SetProtocol (6);
+  Socket::SocketErrno sockerr;
+  Ptr<Ipv4Route> route = GetRouting (i)->RouteOutput (p, header, 0, sockerr);
+  if (route == 0)
+    {
+      return "";
+    }
+  std::ostringstream oss;
+  oss << route->GetGateway () << " " << route->GetOutputDevice ()->GetIfIndex ();
+  return oss.str ();
+}
+
+std::vector<std::string>
+Ipv4GlobalRoutingEcmpTestCase::GetDecisions (void) const
+{
+  std::vector<std::string> decisions;
+  for (uint32_t i = 0; i < m_nodes.GetN (); i++)
+    {
+      for (uint32_t a = 0; a < 48; a++)
+        {
+          for (uint16_t port = 1000; port < 1008; port++)
+            {
+              decisions.push_back (Lookup (i, Ipv4Address ((10u << 24) | (1 << 16) | (1 << 8) | a), port));
+            }
+        }
+    }
+  return decisions;
+}
+
+uint32_t
+Ipv4GlobalRoutingEcmpTestCase::GetNRoutes (void) const
+{
+  uint32_t n = 0;
+  for (uint32_t i = 0; i < m_nodes.GetN (); i++)
+    {
+      n += GetRouting (i)->GetNRoutes ();
+    }
+  return n;
+}
+
+void
+Ipv4GlobalRoutingEcmpTestCase::DoRun (void)
+{
+  m_nodes.Create (8);
+  SimpleNetDeviceHelper simpleHelper;
+  simpleHelper.SetNetDevicePointToPointMode (true);
+  uint32_t links[][2] = { {0, 1}, {0, 2}, {1, 3}, {2, 3}, {3, 4}, {3, 5}, {3, 6}, {3, 7} };
+  std::vector<NetDeviceContainer> devices;
+  for (uint32_t i = 0; i < 8; i++)
+    {
+      devices.push_back (simpleHelper.Install (NodeContainer (m_nodes.Get (links[i][0]), m_nodes.Get (links[i][1]))));
+    }
+
+  InternetStackHelper internet;
+  Ipv4GlobalRoutingHelper ipv4RoutingHelper;
+  internet.SetRoutingHelper (ipv4RoutingHelper);
+  internet.Install (m_nodes);
+
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.252");
+  for (uint32_t i = 0; i < devices.size (); i++)
+    {
+      ipv4.Assign (devices[i]);
+      ipv4.NewNetwork ();
+    }
+  for (uint32_t i = 0; i < m_nodes.GetN (); i++)
+    {
+      GetRouting (i)->SetAttribute ("FlowEcmpRouting", BooleanValue (true));
+    }
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  // the packets of a flow from r0 to r4 follow the same path, and the flows
+  // use both paths
+  std::set<std::string> paths;
+  for (uint16_t port = 1000; port < 1016; port++)
+    {
+      std::string path = Lookup (0, Ipv4Address ("10.1.1.18"), port);
+      NS_TEST_EXPECT_MSG_EQ (Lookup (0, Ipv4Address ("10.1.1.18"), port), path, "The packets of a flow should follow the same path");
+      paths.insert (path);
+    }
+  NS_TEST_EXPECT_MSG_EQ (paths.size (), 2, "The flows should use both paths");
+
+  // aggregate the routes
+  std::vector<std::string> decisions = GetDecisions ();
+  uint32_t nRoutes = GetNRoutes ();
+  for (uint32_t i = 0; i < m_nodes.GetN (); i++)
+    {
+      GetRouting (i)->SetAttribute ("AggregateRoutes", BooleanValue (true));
+    }
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+  NS_TEST_EXPECT_MSG_LT (GetNRoutes (), nRoutes, "The routes should be aggregated");
+  NS_TEST_EXPECT_MSG_EQ ((GetDecisions () == decisions), true, "The aggregation should not change the forwarding decisions");
+
+  // the subnets of the leaves are aggregated at r0
+  Ptr<Ipv4GlobalRouting> routing = GetRouting (0);
+  bool found = false;
+  for (uint32_t j = 0; j < routing->GetNRoutes (); j++)
+    {
+      Ipv4RoutingTableEntry *route = routing->GetRoute (j);
+      found |= (route->GetDestNetwork () == Ipv4Address ("10.1.1.16") && route->GetDestNetworkMask () == Ipv4Mask ("/28"));
+    }
+  NS_TEST_EXPECT_MSG_EQ (found, true, "The subnets of the leaves should be aggregated");
+
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -1267,6 +1598,8 @@ Ipv4GlobalRoutingTestSuite::Ipv4GlobalRoutingTestSuite ()
     AddTestCase (new TwoBridgeTest, TestCase::QUICK);
     AddTestCase (new Ipv4DynamicGlobalRoutingTestCase, TestCase::QUICK);
     AddTestCase (new Ipv4GlobalRoutingSlash32TestCase, TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingUpdateTestCase, TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingEcmpTestCase, TestCase::QUICK);
   }
 
 static Ipv4GlobalRoutingTestSuite g_globalRoutingTestSuite; //!< Static variable for test initialization
@@ -27,6 +27,7 @@
 #include "ns3/socket.h"
 #include "ns3/boolean.h"
 #include "ns3/enum.h"
+#include "ns3/nstime.h"
 
 #include "ns3/log.h"
 #include "ns3/node.h"
@@ -44,6 +45,8 @@
 
 #include <string>
 #include <limits>
+#include <map>
+#include <vector>
 
 using namespace ns3;
 
@@ -681,6 +684,378 @@ Ipv4RipSplitHorizonStrategyTest::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 RIP update Test base class.
+ *
+ * A single RIP router is connected to a fake neighbor, which injects
+ * crafted RIP responses and records the updates sent by the router.
+ * The triggered update cooldown is fixed, so that the time of each
+ * triggered update is known in advance.
+ */
+class Ipv4RipUpdateTestBase : public TestCase
+{
+protected:
+  /// Metric of each prefix carried by an update.
+  typedef std::map<Ipv4Address, uint8_t> Update;
+
+  /**
+   * \brief Constructor.
+   * \param name The test case name.
+   */
+  Ipv4RipUpdateTestBase (std::string name);
+
+  /**
+   * \brief Create the router and the fake neighbor.
+   * \param rip The RIP helper used for the router.
+   */
+  void CreateTopology (RipHelper rip);
+
+  /**
+   * \brief Make the fake neighbor announce some /24 routes.
+   * \param routes The routes and their metrics.
+   */
+  void SendRoutes (Update routes);
+
+  /**
+   * \brief Schedule an announcement of the fake neighbor.
+   * \param at The announcement time.
+   * \param routes The routes and their metrics.
+   */
+  void ScheduleRoutes (Time at, Update routes);
+
+  /**
+   * \brief Check a route of the router.
+   * \param destination The destination to look up.
+   * \param expected True if a route must be found.
+   */
+  void CheckRoute (Ipv4Address destination, bool expected);
+
+  /**
+   * \brief Check an update received from the router.
+   * \param index The update index.
+   * \param at The expected update time.
+   * \param routes The expected routes and their metrics.
+   */
+  void CheckUpdate (uint32_t index, Time at, Update routes);
+
+  /**
+   * \brief Receive an update from the router.
+   * \param socket The receiving socket.
+   */
+  void ReceiveUpdate (Ptr<Socket> socket);
+
+  Ptr<Node> m_router;               //!< The RIP router.
+  Ptr<Socket> m_txSocket;           //!< Fake neighbor sending socket.
+  Ptr<Socket> m_rxSocket;           //!< Fake neighbor receiving socket.
+  std::vector<Time> m_updateTimes;  //!< Reception time of each update.
+  std::vector<Update> m_updates;    //!< Routes carried by each update.
+};
+
+Ipv4RipUpdateTestBase::Ipv4RipUpdateTestBase (std::string name)
+  : TestCase (name)
+{
+}
+
+void
+Ipv4RipUpdateTestBase::CreateTopology (RipHelper rip)
+{
+  Ptr<Node> fakeNode = CreateObject<Node> ();
+  m_router = CreateObject<Node> ();
+
+  InternetStackHelper internetRouter;
+  internetRouter.SetRoutingHelper (rip);
+  internetRouter.Install (m_router);
+
+  InternetStackHelper internetNodes;
+  internetNodes.Install (fakeNode);
+
+  Ptr<SimpleNetDevice> fakeDev = CreateObject<SimpleNetDevice> ();
+  fakeDev->SetAddress (Mac48Address ("00:00:00:00:00:01"));
+  fakeNode->AddDevice (fakeDev);
+
+  Ptr<SimpleNetDevice> routerDev = CreateObject<SimpleNetDevice> ();
+  routerDev->SetAddress (Mac48Address ("00:00:00:00:00:02"));
+  m_router->AddDevice (routerDev);
+
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  fakeDev->SetChannel (channel);
+  routerDev->SetChannel (channel);
+
+  NetDeviceContainer net;
+  net.Add (fakeDev);
+  net.Add (routerDev);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase (Ipv4Address ("10.0.0.0"), Ipv4Mask ("255.255.255.0"));
+  ipv4.Assign (net);
+
+  Ptr<SocketFactory> socketFactory = fakeNode->GetObject<UdpSocketFactory> ();
+  m_txSocket = socketFactory->CreateSocket ();
+  m_txSocket->BindToNetDevice (fakeDev);
+  NS_TEST_EXPECT_MSG_EQ (m_txSocket->Bind (InetSocketAddress (Ipv4Address ("10.0.0.1"), 520)), 0, "trivial");
+
+  m_rxSocket = socketFactory->CreateSocket ();
+  m_rxSocket->BindToNetDevice (fakeDev);
+  NS_TEST_EXPECT_MSG_EQ (m_rxSocket->Bind (InetSocketAddress (Ipv4Address ("224.0.0.9"), 520)), 0, "trivial");
+  m_rxSocket->SetRecvCallback (MakeCallback (&Ipv4RipUpdateTestBase::ReceiveUpdate, this));
+}
+
+void
+Ipv4RipUpdateTestBase::SendRoutes (Update routes)
+{
+  RipHeader hdr;
+  hdr.SetCommand (RipHeader::RESPONSE);
+  for (Update::const_iterator iter = routes.begin (); iter != routes.end (); iter++)
+    {
+      RipRte rte;
+      rte.SetPrefix (iter->first);
+      rte.SetSubnetMask (Ipv4Mask ("255.255.255.0"));
+      rte.SetRouteMetric (iter->second);
+      hdr.AddRte (rte);
+    }
+  Ptr<Packet> p = Create<Packet> ();
+  p->AddHeader (hdr);
+  m_txSocket->SendTo (p, 0, InetSocketAddress (Ipv4Address ("224.0.0.9"), 520));
+}
+
+void
+Ipv4RipUpdateTestBase::ScheduleRoutes (Time at, Update routes)
+{
+  Simulator::ScheduleWithContext (m_txSocket->GetNode ()->GetId (), at,
+                                  &Ipv4RipUpdateTestBase::SendRoutes, this, routes);
+}
+
+void
+Ipv4RipUpdateTestBase::CheckRoute (Ipv4Address destination, bool expected)
+{
+  Ipv4Header header;
+  header.SetDestination (destination);
+  Socket::SocketErrno sockerr;
+  Ptr<Ipv4Route> route = m_router->GetObject<Ipv4> ()->GetRoutingProtocol ()->RouteOutput (0, header, 0, sockerr);
+  NS_TEST_EXPECT_MSG_EQ ((route != 0), expected, "RIP: wrong route to " << destination << " at " << Simulator::Now ().As (Time::NS));
+}
+
+void
+Ipv4RipUpdateTestBase::CheckUpdate (uint32_t index, Time at, Update routes)
+{
+  NS_TEST_ASSERT_MSG_LT (index, m_updates.size (), "RIP: update " << index << " not received");
+  NS_TEST_EXPECT_MSG_EQ (m_updateTimes[index], at, "RIP: update " << index << " sent at the wrong time");
+  NS_TEST_EXPECT_MSG_EQ (m_updates[index].size (), routes.size (), "RIP: update " << index << " has the wrong number of RTEs");
+  for (Update::const_iterator iter = routes.begin (); iter != routes.end (); iter++)
+    {
+      Update::const_iterator found = m_updates[index].find (iter->first);
+      NS_TEST_EXPECT_MSG_EQ ((found != m_updates[index].end ()), true, "RIP: update " << index << " misses " << iter->first);
+      if (found != m_updates[index].end ())
+        {
+          NS_TEST_EXPECT_MSG_EQ (int (found->second), int (iter->second), "RIP: update " << index << " has the wrong metric for " << iter->first);
+        }
+    }
+}
+
+void
+Ipv4RipUpdateTestBase::ReceiveUpdate (Ptr<Socket> socket)
+{
+  Address srcAddr;
+  Ptr<Packet> receivedPacket = socket->RecvFrom (std::numeric_limits<uint32_t>::max (), 0, srcAddr);
+
+  RipHeader hdr;
+  receivedPacket->RemoveHeader (hdr);
+  if (hdr.GetCommand () != RipHeader::RESPONSE)
+    {
+      return;
+    }
+
+  Update update;
+  std::list<RipRte> rtes = hdr.GetRteList ();
+  for (std::list<RipRte>::iterator iter = rtes.begin (); iter != rtes.end (); iter++)
+    {
+      update[iter->GetPrefix ()] = iter->GetRouteMetric ();
+    }
+  m_updateTimes.push_back (Simulator::Now ());
+  m_updates.push_back (update);
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 RIP triggered updates Test
+ */
+class Ipv4RipTriggeredUpdateTest : public Ipv4RipUpdateTestBase
+{
+public:
+  virtual void DoRun (void);
+  Ipv4RipTriggeredUpdateTest ();
+
+private:
+  /**
+   * \brief Schedule a route change shortly before the second unsolicited
+   * update, with a cooldown longer than the time left to it.
+   */
+  void ChangeBeforeUnsolicitedUpdate (void);
+};
+
+Ipv4RipTriggeredUpdateTest::Ipv4RipTriggeredUpdateTest ()
+  : Ipv4RipUpdateTestBase ("RIP triggered updates")
+{
+}
+
+void
+Ipv4RipTriggeredUpdateTest::ChangeBeforeUnsolicitedUpdate (void)
+{
+  NS_TEST_ASSERT_MSG_GT (m_updates.size (), 2, "RIP: no unsolicited update");
+
+  Ptr<Rip> rip = DynamicCast<Rip> (m_router->GetObject<Ipv4> ()->GetRoutingProtocol ());
+  rip->SetAttribute ("MinTriggeredCooldown", TimeValue (Seconds (100)));
+  rip->SetAttribute ("MaxTriggeredCooldown", TimeValue (Seconds (100)));
+
+  // the next unsolicited update is due in [1, 51] seconds from the change
+  Update routes;
+  routes[Ipv4Address ("10.3.0.0")] = 5;
+  ScheduleRoutes (m_updateTimes[2] + Seconds (99) - Simulator::Now (), routes);
+}
+
+void
+Ipv4RipTriggeredUpdateTest::DoRun (void)
+{
+  RipHelper ripRouting;
+  ripRouting.Set ("SplitHorizon", EnumValue (Rip::NO_SPLIT_HORIZON));
+  ripRouting.Set ("UnsolicitedRoutingUpdate", TimeValue (Seconds (100)));
+  ripRouting.Set ("TimeoutDelay", TimeValue (Seconds (1000)));
+  ripRouting.Set ("MinTriggeredCooldown", TimeValue (Seconds (2)));
+  ripRouting.Set ("MaxTriggeredCooldown", TimeValue (Seconds (2)));
+  CreateTopology (ripRouting);
+
+  Update routes;
+  routes[Ipv4Address ("10.1.0.0")] = 1;
+  routes[Ipv4Address ("10.2.0.0")] = 1;
+  routes[Ipv4Address ("10.3.0.0")] = 1;
+  ScheduleRoutes (Seconds (5), routes);
+
+  // only the metric of 10.2.0.0 changes, the other RTEs refresh the routes
+  routes[Ipv4Address ("10.2.0.0")] = 3;
+  ScheduleRoutes (Seconds (10), routes);
+
+  // the first unsolicited update is sent in [100, 150] seconds
+  Simulator::Schedule (Seconds (151), &Ipv4RipTriggeredUpdateTest::ChangeBeforeUnsolicitedUpdate, this);
+
+  Simulator::Stop (Seconds (400));
+  Simulator::Run ();
+
+  Update expected;
+  expected[Ipv4Address ("10.1.0.0")] = 2;
+  expected[Ipv4Address ("10.2.0.0")] = 2;
+  expected[Ipv4Address ("10.3.0.0")] = 2;
+  CheckUpdate (0, Seconds (7), expected);
+
+  Update changed;
+  changed[Ipv4Address ("10.2.0.0")] = 4;
+  CheckUpdate (1, Seconds (12), changed);
+
+  // the first unsolicited update carries the whole table
+  expected[Ipv4Address ("10.2.0.0")] = 4;
+  NS_TEST_ASSERT_MSG_GT (m_updates.size (), 2, "RIP: no unsolicited update");
+  NS_TEST_EXPECT_MSG_GT_OR_EQ (m_updateTimes[2], Seconds (100), "RIP: unsolicited update sent too early");
+  NS_TEST_EXPECT_MSG_LT_OR_EQ (m_updateTimes[2], Seconds (150), "RIP: unsolicited update sent too late");
+  CheckUpdate (2, m_updateTimes[2], expected);
+
+  // the triggered update is suppressed, the next unsolicited update
+  // carries the change
+  expected[Ipv4Address ("10.3.0.0")] = 6;
+  NS_TEST_ASSERT_MSG_GT (m_updates.size (), 3, "RIP: no second unsolicited update");
+  NS_TEST_EXPECT_MSG_LT_OR_EQ (m_updateTimes[3], m_updateTimes[2] + Seconds (150), "RIP: unsolicited update sent too late");
+  CheckUpdate (3, m_updateTimes[3], expected);
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 RIP route timeout and garbage collection Test
+ */
+class Ipv4RipRouteTimersTest : public Ipv4RipUpdateTestBase
+{
+public:
+  virtual void DoRun (void);
+  Ipv4RipRouteTimersTest ();
+};
+
+Ipv4RipRouteTimersTest::Ipv4RipRouteTimersTest ()
+  : Ipv4RipUpdateTestBase ("RIP route timeout and garbage collection")
+{
+}
+
+void
+Ipv4RipRouteTimersTest::DoRun (void)
+{
+  RipHelper ripRouting;
+  ripRouting.Set ("SplitHorizon", EnumValue (Rip::NO_SPLIT_HORIZON));
+  ripRouting.Set ("UnsolicitedRoutingUpdate", TimeValue (Seconds (1000)));
+  ripRouting.Set ("TimeoutDelay", TimeValue (Seconds (10)));
+  ripRouting.Set ("GarbageCollectionDelay", TimeValue (Seconds (5)));
+  ripRouting.Set ("MinTriggeredCooldown", TimeValue (Seconds (2)));
+  ripRouting.Set ("MaxTriggeredCooldown", TimeValue (Seconds (2)));
+  CreateTopology (ripRouting);
+
+  // Pairs of routes learned 2 ns apart, and routes learned so that a
+  // triggered update is sent right between the timeouts (or the garbage
+  // collections) of a pair.
+  Update y1, y2, w1, x1, x2, w2;
+  y1[Ipv4Address ("10.1.0.0")] = 1;
+  y2[Ipv4Address ("10.2.0.0")] = 1;
+  w1[Ipv4Address ("10.9.0.0")] = 1;
+  x1[Ipv4Address ("10.3.0.0")] = 1;
+  x2[Ipv4Address ("10.4.0.0")] = 1;
+  w2[Ipv4Address ("10.8.0.0")] = 1;
+  ScheduleRoutes (Seconds (20), y1);
+  ScheduleRoutes (Seconds (20) + NanoSeconds (2), y2);
+  ScheduleRoutes (Seconds (28) + NanoSeconds (1), w1);
+  ScheduleRoutes (Seconds (50), x1);
+  ScheduleRoutes (Seconds (50) + NanoSeconds (2), x2);
+  ScheduleRoutes (Seconds (63) + NanoSeconds (1), w2);
+
+  // the routes time out exactly after TimeoutDelay
+  Simulator::Schedule (Seconds (30) - NanoSeconds (1), &Ipv4RipRouteTimersTest::CheckRoute, this, Ipv4Address ("10.1.0.1"), true);
+  Simulator::Schedule (Seconds (30) + NanoSeconds (1), &Ipv4RipRouteTimersTest::CheckRoute, this, Ipv4Address ("10.1.0.1"), false);
+  Simulator::Schedule (Seconds (30) + NanoSeconds (1), &Ipv4RipRouteTimersTest::CheckRoute, this, Ipv4Address ("10.2.0.1"), true);
+  Simulator::Schedule (Seconds (30) + NanoSeconds (3), &Ipv4RipRouteTimersTest::CheckRoute, this, Ipv4Address ("10.2.0.1"), false);
+
+  Simulator::Stop (Seconds (1600));
+  Simulator::Run ();
+
+  Update expected;
+  expected[Ipv4Address ("10.1.0.0")] = 2;
+  expected[Ipv4Address ("10.2.0.0")] = 2;
+  CheckUpdate (0, Seconds (22), expected);
+
+  // 10.1.0.0 timed out, 10.2.0.0 did not yet
+  expected.clear ();
+  expected[Ipv4Address ("10.9.0.0")] = 2;
+  expected[Ipv4Address ("10.1.0.0")] = 16;
+  CheckUpdate (1, Seconds (30) + NanoSeconds (1), expected);
+
+  // 10.2.0.0 and 10.9.0.0 were deleted while still queued
+  expected.clear ();
+  expected[Ipv4Address ("10.3.0.0")] = 2;
+  expected[Ipv4Address ("10.4.0.0")] = 2;
+  CheckUpdate (2, Seconds (52), expected);
+
+  // 10.3.0.0 was deleted while still queued, 10.4.0.0 was not deleted yet
+  expected.clear ();
+  expected[Ipv4Address ("10.8.0.0")] = 2;
+  expected[Ipv4Address ("10.4.0.0")] = 16;
+  CheckUpdate (3, Seconds (65) + NanoSeconds (1), expected);
+
+  // all the routes are gone, the unsolicited update has nothing to send
+  NS_TEST_EXPECT_MSG_EQ (m_updates.size (), 4, "RIP: deleted routes sent in an unsolicited update");
+
+  Simulator::Destroy ();
+}
+
 
 /**
  * \ingroup internet-test
@@ -698,6 +1073,8 @@ public:
     AddTestCase (new Ipv4RipSplitHorizonStrategyTest (Rip::POISON_REVERSE), TestCase::QUICK);
     AddTestCase (new Ipv4RipSplitHorizonStrategyTest (Rip::SPLIT_HORIZON), TestCase::QUICK);
     AddTestCase (new Ipv4RipSplitHorizonStrategyTest (Rip::NO_SPLIT_HORIZON), TestCase::QUICK);
+    AddTestCase (new Ipv4RipTriggeredUpdateTest, TestCase::QUICK);
+    AddTestCase (new Ipv4RipRouteTimersTest, TestCase::QUICK);
   }
 };
 
@@ -35,6 +35,7 @@
 #include "ns3/simple-net-device-helper.h"
 #include "ns3/socket-factory.h"
 #include "ns3/udp-socket-factory.h"
+#include "ns3/ipv4-static-routing.h"
 
 using namespace ns3;
 
@@ -201,6 +202,101 @@ Ipv4StaticRoutingSlash32TestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 StaticRouting lookup Test: the route with the longest
+ * matching prefix and the lowest metric is selected, taking into account
+ * the output device and the removal of routes.
+ */
+class Ipv4StaticRoutingLookupTestCase : public TestCase
+{
+public:
+  Ipv4StaticRoutingLookupTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief Look up a route
+   * \param routing the static routing protocol
+   * \param dest the destination
+   * \param oif the output device, if any
+   * \return the gateway of the route, or 255.255.255.255 if none
+   */
+  Ipv4Address Lookup (Ptr<Ipv4StaticRouting> routing, const char *dest, Ptr<NetDevice> oif = 0);
+};
+
+Ipv4StaticRoutingLookupTestCase::Ipv4StaticRoutingLookupTestCase ()
+  : TestCase ("Static routing longest prefix match")
+{
+}
+
+Ipv4Address
+Ipv4StaticRoutingLookupTestCase::Lookup (Ptr<Ipv4StaticRouting> routing, const char *dest, Ptr<NetDevice> oif)
+{
+  Ipv4Header header;
+  header.SetDestination (Ipv4Address (dest));
+  Socket::SocketErrno sockerr;
+  Ptr<Ipv4Route> route = routing->RouteOutput (Create<Packet> (), header, oif, sockerr);
+  return (route != 0 ? route->GetGateway () : Ipv4Address::GetBroadcast ());
+}
+
+void
+Ipv4StaticRoutingLookupTestCase::DoRun (void)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.Install (node);
+  SimpleNetDeviceHelper devHelper;
+  NetDeviceContainer devices = devHelper.Install (NodeContainer (node, node, node));
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("192.168.0.0", "255.255.255.0");
+  ipv4.Assign (NetDeviceContainer (devices.Get (0)));
+  ipv4.SetBase ("192.168.1.0", "255.255.255.0");
+  ipv4.Assign (NetDeviceContainer (devices.Get (1)));
+  ipv4.SetBase ("192.168.2.0", "255.255.255.0");
+  ipv4.Assign (NetDeviceContainer (devices.Get (2)));
+
+  Ipv4StaticRoutingHelper helper;
+  Ptr<Ipv4StaticRouting> routing = helper.GetStaticRouting (node->GetObject<Ipv4> ());
+  routing->SetDefaultRoute (Ipv4Address ("192.168.0.100"), 1, 10);
+  routing->SetDefaultRoute (Ipv4Address ("192.168.1.100"), 2, 5);
+  routing->AddNetworkRouteTo (Ipv4Address ("10.0.0.0"), Ipv4Mask ("/8"), Ipv4Address ("192.168.0.1"), 1);
+  routing->AddNetworkRouteTo (Ipv4Address ("10.1.0.0"), Ipv4Mask ("/16"), Ipv4Address ("192.168.1.1"), 2, 3);
+  routing->AddNetworkRouteTo (Ipv4Address ("10.1.0.0"), Ipv4Mask ("/16"), Ipv4Address ("192.168.2.1"), 3, 3);
+  routing->AddNetworkRouteTo (Ipv4Address ("10.1.0.0"), Ipv4Mask ("/16"), Ipv4Address ("192.168.0.2"), 1, 4);
+  routing->AddHostRouteTo (Ipv4Address ("10.1.1.1"), Ipv4Address ("192.168.0.3"), 1);
+  routing->AddHostRouteTo (Ipv4Address ("10.1.1.1"), Ipv4Address ("192.168.1.3"), 2);
+
+  // lowest metric among the default routes
+  NS_TEST_EXPECT_MSG_EQ (Lookup (routing, "172.16.0.1"), Ipv4Address ("192.168.1.100"), "Wrong default route");
+  NS_TEST_EXPECT_MSG_EQ (Lookup (routing, "10.2.0.1"), Ipv4Address ("192.168.0.1"), "Wrong /8 route");
+  // lowest metric, and last route among those with the same metric
+  NS_TEST_EXPECT_MSG_EQ (Lookup (routing, "10.1.2.1"), Ipv4Address ("192.168.2.1"), "Wrong /16 route");
+  // first host route
+  NS_TEST_EXPECT_MSG_EQ (Lookup (routing, "10.1.1.1"), Ipv4Address ("192.168.0.3"), "Wrong host route");
+  // output device
+  NS_TEST_EXPECT_MSG_EQ (Lookup (routing, "10.1.1.1", devices.Get (1)), Ipv4Address ("192.168.1.3"), "Wrong host route");
+  NS_TEST_EXPECT_MSG_EQ (Lookup (routing, "10.1.1.1", devices.Get (2)), Ipv4Address ("192.168.2.1"), "Wrong /16 route");
+  NS_TEST_EXPECT_MSG_EQ (Lookup (routing, "10.1.2.1", devices.Get (0)), Ipv4Address ("192.168.0.2"), "Wrong /16 route");
+  NS_TEST_EXPECT_MSG_EQ (Lookup (routing, "10.2.0.1", devices.Get (2)), Ipv4Address::GetBroadcast (), "Unexpected route");
+
+  // removal of the routes through an interface
+  node->GetObject<Ipv4> ()->SetDown (3);
+  NS_TEST_EXPECT_MSG_EQ (Lookup (routing, "10.1.2.1"), Ipv4Address ("192.168.1.1"), "Wrong /16 route");
+  node->GetObject<Ipv4> ()->SetDown (1);
+  NS_TEST_EXPECT_MSG_EQ (Lookup (routing, "10.1.1.1"), Ipv4Address ("192.168.1.3"), "Wrong host route");
+  NS_TEST_EXPECT_MSG_EQ (Lookup (routing, "10.2.0.1"), Ipv4Address ("192.168.1.100"), "Wrong default route");
+  for (uint32_t i = routing->GetNRoutes (); i > 0; i--)
+    {
+      routing->RemoveRoute (i - 1);
+    }
+  NS_TEST_EXPECT_MSG_EQ (Lookup (routing, "10.2.0.1"), Ipv4Address::GetBroadcast (), "Unexpected route");
+
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -217,6 +313,7 @@ Ipv4StaticRoutingTestSuite::Ipv4StaticRoutingTestSuite ()
   : TestSuite ("ipv4-static-routing", UNIT)
 {
   AddTestCase (new Ipv4StaticRoutingSlash32TestCase, TestCase::QUICK);
+  AddTestCase (new Ipv4StaticRoutingLookupTestCase, TestCase::QUICK);
 }
 
 static Ipv4StaticRoutingTestSuite ipv4StaticRoutingTestSuite; //!< Static variable for test initialization
@@ -27,6 +27,7 @@
 #include "ns3/socket.h"
 #include "ns3/boolean.h"
 #include "ns3/enum.h"
+#include "ns3/nstime.h"
 
 #include "ns3/log.h"
 #include "ns3/node.h"
@@ -39,10 +40,13 @@
 #include "ns3/udp-l4-protocol.h"
 #include "ns3/ripng.h"
 #include "ns3/ripng-helper.h"
+#include "ns3/ipv6-route.h"
 #include "ns3/node-container.h"
 
 #include <string>
 #include <limits>
+#include <map>
+#include <vector>
 
 using namespace ns3;
 
@@ -678,6 +682,381 @@ Ipv6RipngSplitHorizonStrategyTest::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv6 RIPng update Test base class.
+ *
+ * A single RIPng router is connected to a fake neighbor, which injects
+ * crafted RIPng responses and records the updates sent by the router.
+ * The triggered update cooldown is fixed, so that the time of each
+ * triggered update is known in advance.
+ */
+class Ipv6RipngUpdateTestBase : public TestCase
+{
+protected:
+  /// Metric of each prefix carried by an update.
+  typedef std::map<Ipv6Address, uint8_t> Update;
+
+  /**
+   * \brief Constructor.
+   * \param name The test case name.
+   */
+  Ipv6RipngUpdateTestBase (std::string name);
+
+  /**
+   * \brief Create the router and the fake neighbor.
+   * \param rip The RIP helper used for the router.
+   */
+  void CreateTopology (RipNgHelper rip);
+
+  /**
+   * \brief Make the fake neighbor announce some /64 routes.
+   * \param routes The routes and their metrics.
+   */
+  void SendRoutes (Update routes);
+
+  /**
+   * \brief Schedule an announcement of the fake neighbor.
+   * \param at The announcement time.
+   * \param routes The routes and their metrics.
+   */
+  void ScheduleRoutes (Time at, Update routes);
+
+  /**
+   * \brief Check a route of the router.
+   * \param destination The destination to look up.
+   * \param expected True if a route must be found.
+   */
+  void CheckRoute (Ipv6Address destination, bool expected);
+
+  /**
+   * \brief Check an update received from the router.
+   * \param index The update index.
+   * \param at The expected update time.
+   * \param routes The expected routes and their metrics.
+   */
+  void CheckUpdate (uint32_t index, Time at, Update routes);
+
+  /**
+   * \brief Receive an update from the router.
+   * \param socket The receiving socket.
+   */
+  void ReceiveUpdate (Ptr<Socket> socket);
+
+  Ptr<Node> m_router;               //!< The RIP router.
+  Ptr<Socket> m_txSocket;           //!< Fake neighbor sending socket.
+  Ptr<Socket> m_rxSocket;           //!< Fake neighbor receiving socket.
+  std::vector<Time> m_updateTimes;  //!< Reception time of each update.
+  std::vector<Update> m_updates;    //!< Routes carried by each update.
+};
+
+Ipv6RipngUpdateTestBase::Ipv6RipngUpdateTestBase (std::string name)
+  : TestCase (name)
+{
+}
+
+void
+Ipv6RipngUpdateTestBase::CreateTopology (RipNgHelper rip)
+{
+  Ptr<Node> fakeNode = CreateObject<Node> ();
+  m_router = CreateObject<Node> ();
+
+  InternetStackHelper internetRouter;
+  internetRouter.SetRoutingHelper (rip);
+  internetRouter.Install (m_router);
+
+  InternetStackHelper internetNodes;
+  internetNodes.Install (fakeNode);
+
+  Ptr<SimpleNetDevice> fakeDev = CreateObject<SimpleNetDevice> ();
+  fakeDev->SetAddress (Mac48Address ("00:00:00:00:00:01"));
+  fakeNode->AddDevice (fakeDev);
+
+  Ptr<SimpleNetDevice> routerDev = CreateObject<SimpleNetDevice> ();
+  routerDev->SetAddress (Mac48Address ("00:00:00:00:00:02"));
+  m_router->AddDevice (routerDev);
+
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  fakeDev->SetChannel (channel);
+  routerDev->SetChannel (channel);
+
+  NetDeviceContainer net;
+  net.Add (fakeDev);
+  net.Add (routerDev);
+  Ipv6AddressHelper ipv6;
+  ipv6.AssignWithoutAddress (net);
+
+  Ptr<SocketFactory> socketFactory = fakeNode->GetObject<UdpSocketFactory> ();
+  m_txSocket = socketFactory->CreateSocket ();
+  m_txSocket->BindToNetDevice (fakeDev);
+  NS_TEST_EXPECT_MSG_EQ (m_txSocket->Bind (Inet6SocketAddress (Ipv6Address ("fe80::200:ff:fe00:1"), 521)), 0, "trivial");
+
+  m_rxSocket = socketFactory->CreateSocket ();
+  m_rxSocket->BindToNetDevice (fakeDev);
+  NS_TEST_EXPECT_MSG_EQ (m_rxSocket->Bind (Inet6SocketAddress (Ipv6Address ("ff02::9"), 521)), 0, "trivial");
+  m_rxSocket->SetRecvCallback (MakeCallback (&Ipv6RipngUpdateTestBase::ReceiveUpdate, this));
+}
+
+void
+Ipv6RipngUpdateTestBase::SendRoutes (Update routes)
+{
+  RipNgHeader hdr;
+  hdr.SetCommand (RipNgHeader::RESPONSE);
+  for (Update::const_iterator iter = routes.begin (); iter != routes.end (); iter++)
+    {
+      RipNgRte rte;
+      rte.SetPrefix (iter->first);
+      rte.SetPrefixLen (64);
+      rte.SetRouteMetric (iter->second);
+      hdr.AddRte (rte);
+    }
+  Ptr<Packet> p = Create<Packet> ();
+  SocketIpv6HopLimitTag tag;
+  tag.SetHopLimit (255);
+  p->AddPacketTag (tag);
+  p->AddHeader (hdr);
+  m_txSocket->SendTo (p, 0, Inet6SocketAddress (Ipv6Address ("ff02::9"), 521));
+}
+
+void
+Ipv6RipngUpdateTestBase::ScheduleRoutes (Time at, Update routes)
+{
+  Simulator::ScheduleWithContext (m_txSocket->GetNode ()->GetId (), at,
+                                  &Ipv6RipngUpdateTestBase::SendRoutes, this, routes);
+}
+
+void
+Ipv6RipngUpdateTestBase::CheckRoute (Ipv6Address destination, bool expected)
+{
+  Ipv6Header header;
+  header.SetDestinationAddress (destination);
+  Socket::SocketErrno sockerr;
+  Ptr<Ipv6Route> route = m_router->GetObject<Ipv6> ()->GetRoutingProtocol ()->RouteOutput (0, header, 0, sockerr);
+  NS_TEST_EXPECT_MSG_EQ ((route != 0), expected, "RIPng: wrong route to " << destination << " at " << Simulator::Now ().As (Time::NS));
+}
+
+void
+Ipv6RipngUpdateTestBase::CheckUpdate (uint32_t index, Time at, Update routes)
+{
+  NS_TEST_ASSERT_MSG_LT (index, m_updates.size (), "RIPng: update " << index << " not received");
+  NS_TEST_EXPECT_MSG_EQ (m_updateTimes[index], at, "RIPng: update " << index << " sent at the wrong time");
+  NS_TEST_EXPECT_MSG_EQ (m_updates[index].size (), routes.size (), "RIPng: update " << index << " has the wrong number of RTEs");
+  for (Update::const_iterator iter = routes.begin (); iter != routes.end (); iter++)
+    {
+      Update::const_iterator found = m_updates[index].find (iter->first);
+      NS_TEST_EXPECT_MSG_EQ ((found != m_updates[index].end ()), true, "RIPng: update " << index << " misses " << iter->first);
+      if (found != m_updates[index].end ())
+        {
+          NS_TEST_EXPECT_MSG_EQ (int (found->second), int (iter->second), "RIPng: update " << index << " has the wrong metric for " << iter->first);
+        }
+    }
+}
+
+void
+Ipv6RipngUpdateTestBase::ReceiveUpdate (Ptr<Socket> socket)
+{
+  Address srcAddr;
+  Ptr<Packet> receivedPacket = socket->RecvFrom (std::numeric_limits<uint32_t>::max (), 0, srcAddr);
+
+  RipNgHeader hdr;
+  receivedPacket->RemoveHeader (hdr);
+  if (hdr.GetCommand () != RipNgHeader::RESPONSE)
+    {
+      return;
+    }
+
+  Update update;
+  std::list<RipNgRte> rtes = hdr.GetRteList ();
+  for (std::list<RipNgRte>::iterator iter = rtes.begin (); iter != rtes.end (); iter++)
+    {
+      update[iter->GetPrefix ()] = iter->GetRouteMetric ();
+    }
+  m_updateTimes.push_back (Simulator::Now ());
+  m_updates.push_back (update);
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv6 RIPng triggered updates Test
+ */
+class Ipv6RipngTriggeredUpdateTest : public Ipv6RipngUpdateTestBase
+{
+public:
+  virtual void DoRun (void);
+  Ipv6RipngTriggeredUpdateTest ();
+
+private:
+  /**
+   * \brief Schedule a route change shortly before the second unsolicited
+   * update, with a cooldown longer than the time left to it.
+   */
+  void ChangeBeforeUnsolicitedUpdate (void);
+};
+
+Ipv6RipngTriggeredUpdateTest::Ipv6RipngTriggeredUpdateTest ()
+  : Ipv6RipngUpdateTestBase ("RIPng triggered updates")
+{
+}
+
+void
+Ipv6RipngTriggeredUpdateTest::ChangeBeforeUnsolicitedUpdate (void)
+{
+  NS_TEST_ASSERT_MSG_GT (m_updates.size (), 2, "RIPng: no unsolicited update");
+
+  Ptr<RipNg> rip = DynamicCast<RipNg> (m_router->GetObject<Ipv6> ()->GetRoutingProtocol ());
+  rip->SetAttribute ("MinTriggeredCooldown", TimeValue (Seconds (100)));
+  rip->SetAttribute ("MaxTriggeredCooldown", TimeValue (Seconds (100)));
+
+  // the next unsolicited update is due in [1, 51] seconds from the change
+  Update routes;
+  routes[Ipv6Address ("2001:3::")] = 5;
+  ScheduleRoutes (m_updateTimes[2] + Seconds (99) - Simulator::Now (), routes);
+}
+
+void
+Ipv6RipngTriggeredUpdateTest::DoRun (void)
+{
+  RipNgHelper ripRouting;
+  ripRouting.Set ("SplitHorizon", EnumValue (RipNg::NO_SPLIT_HORIZON));
+  ripRouting.Set ("UnsolicitedRoutingUpdate", TimeValue (Seconds (100)));
+  ripRouting.Set ("TimeoutDelay", TimeValue (Seconds (1000)));
+  ripRouting.Set ("MinTriggeredCooldown", TimeValue (Seconds (2)));
+  ripRouting.Set ("MaxTriggeredCooldown", TimeValue (Seconds (2)));
+  CreateTopology (ripRouting);
+
+  Update routes;
+  routes[Ipv6Address ("2001:1::")] = 1;
+  routes[Ipv6Address ("2001:2::")] = 1;
+  routes[Ipv6Address ("2001:3::")] = 1;
+  ScheduleRoutes (Seconds (5), routes);
+
+  // only the metric of 2001:2:: changes, the other RTEs refresh the routes
+  routes[Ipv6Address ("2001:2::")] = 3;
+  ScheduleRoutes (Seconds (10), routes);
+
+  // the first unsolicited update is sent in [100, 150] seconds
+  Simulator::Schedule (Seconds (151), &Ipv6RipngTriggeredUpdateTest::ChangeBeforeUnsolicitedUpdate, this);
+
+  Simulator::Stop (Seconds (400));
+  Simulator::Run ();
+
+  Update expected;
+  expected[Ipv6Address ("2001:1::")] = 2;
+  expected[Ipv6Address ("2001:2::")] = 2;
+  expected[Ipv6Address ("2001:3::")] = 2;
+  CheckUpdate (0, Seconds (7), expected);
+
+  Update changed;
+  changed[Ipv6Address ("2001:2::")] = 4;
+  CheckUpdate (1, Seconds (12), changed);
+
+  // the first unsolicited update carries the whole table
+  expected[Ipv6Address ("2001:2::")] = 4;
+  NS_TEST_ASSERT_MSG_GT (m_updates.size (), 2, "RIPng: no unsolicited update");
+  NS_TEST_EXPECT_MSG_GT_OR_EQ (m_updateTimes[2], Seconds (100), "RIPng: unsolicited update sent too early");
+  NS_TEST_EXPECT_MSG_LT_OR_EQ (m_updateTimes[2], Seconds (150), "RIPng: unsolicited update sent too late");
+  CheckUpdate (2, m_updateTimes[2], expected);
+
+  // the triggered update is suppressed, the next unsolicited update
+  // carries the change
+  expected[Ipv6Address ("2001:3::")] = 6;
+  NS_TEST_ASSERT_MSG_GT (m_updates.size (), 3, "RIPng: no second unsolicited update");
+  NS_TEST_EXPECT_MSG_LT_OR_EQ (m_updateTimes[3], m_updateTimes[2] + Seconds (150), "RIPng: unsolicited update sent too late");
+  CheckUpdate (3, m_updateTimes[3], expected);
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv6 RIPng route timeout and garbage collection Test
+ */
+class Ipv6RipngRouteTimersTest : public Ipv6RipngUpdateTestBase
+{
+public:
+  virtual void DoRun (void);
+  Ipv6RipngRouteTimersTest ();
+};
+
+Ipv6RipngRouteTimersTest::Ipv6RipngRouteTimersTest ()
+  : Ipv6RipngUpdateTestBase ("RIPng route timeout and garbage collection")
+{
+}
+
+void
+Ipv6RipngRouteTimersTest::DoRun (void)
+{
+  RipNgHelper ripRouting;
+  ripRouting.Set ("SplitHorizon", EnumValue (RipNg::NO_SPLIT_HORIZON));
+  ripRouting.Set ("UnsolicitedRoutingUpdate", TimeValue (Seconds (1000)));
+  ripRouting.Set ("TimeoutDelay", TimeValue (Seconds (10)));
+  ripRouting.Set ("GarbageCollectionDelay", TimeValue (Seconds (5)));
+  ripRouting.Set ("MinTriggeredCooldown", TimeValue (Seconds (2)));
+  ripRouting.Set ("MaxTriggeredCooldown", TimeValue (Seconds (2)));
+  CreateTopology (ripRouting);
+
+  // Pairs of routes learned 2 ns apart, and routes learned so that a
+  // triggered update is sent right between the timeouts (or the garbage
+  // collections) of a pair.
+  Update y1, y2, w1, x1, x2, w2;
+  y1[Ipv6Address ("2001:1::")] = 1;
+  y2[Ipv6Address ("2001:2::")] = 1;
+  w1[Ipv6Address ("2001:9::")] = 1;
+  x1[Ipv6Address ("2001:3::")] = 1;
+  x2[Ipv6Address ("2001:4::")] = 1;
+  w2[Ipv6Address ("2001:8::")] = 1;
+  ScheduleRoutes (Seconds (20), y1);
+  ScheduleRoutes (Seconds (20) + NanoSeconds (2), y2);
+  ScheduleRoutes (Seconds (28) + NanoSeconds (1), w1);
+  ScheduleRoutes (Seconds (50), x1);
+  ScheduleRoutes (Seconds (50) + NanoSeconds (2), x2);
+  ScheduleRoutes (Seconds (63) + NanoSeconds (1), w2);
+
+  // the routes time out exactly after TimeoutDelay
+  Simulator::Schedule (Seconds (30) - NanoSeconds (1), &Ipv6RipngRouteTimersTest::CheckRoute, this, Ipv6Address ("2001:1::1"), true);
+  Simulator::Schedule (Seconds (30) + NanoSeconds (1), &Ipv6RipngRouteTimersTest::CheckRoute, this, Ipv6Address ("2001:1::1"), false);
+  Simulator::Schedule (Seconds (30) + NanoSeconds (1), &Ipv6RipngRouteTimersTest::CheckRoute, this, Ipv6Address ("2001:2::1"), true);
+  Simulator::Schedule (Seconds (30) + NanoSeconds (3), &Ipv6RipngRouteTimersTest::CheckRoute, this, Ipv6Address ("2001:2::1"), false);
+
+  Simulator::Stop (Seconds (1600));
+  Simulator::Run ();
+
+  Update expected;
+  expected[Ipv6Address ("2001:1::")] = 2;
+  expected[Ipv6Address ("2001:2::")] = 2;
+  CheckUpdate (0, Seconds (22), expected);
+
+  // 2001:1:: timed out, 2001:2:: did not yet
+  expected.clear ();
+  expected[Ipv6Address ("2001:9::")] = 2;
+  expected[Ipv6Address ("2001:1::")] = 16;
+  CheckUpdate (1, Seconds (30) + NanoSeconds (1), expected);
+
+  // 2001:2:: and 2001:9:: were deleted while still queued
+  expected.clear ();
+  expected[Ipv6Address ("2001:3::")] = 2;
+  expected[Ipv6Address ("2001:4::")] = 2;
+  CheckUpdate (2, Seconds (52), expected);
+
+  // 2001:3:: was deleted while still queued, 2001:4:: was not deleted yet
+  expected.clear ();
+  expected[Ipv6Address ("2001:8::")] = 2;
+  expected[Ipv6Address ("2001:4::")] = 16;
+  CheckUpdate (3, Seconds (65) + NanoSeconds (1), expected);
+
+  // all the routes are gone, the unsolicited update has nothing to send
+  NS_TEST_EXPECT_MSG_EQ (m_updates.size (), 4, "RIPng: deleted routes sent in an unsolicited update");
+
+  Simulator::Destroy ();
+}
+
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -694,6 +1073,8 @@ public:
     AddTestCase (new Ipv6RipngSplitHorizonStrategyTest (RipNg::POISON_REVERSE), TestCase::QUICK);
     AddTestCase (new Ipv6RipngSplitHorizonStrategyTest (RipNg::SPLIT_HORIZON), TestCase::QUICK);
     AddTestCase (new Ipv6RipngSplitHorizonStrategyTest (RipNg::NO_SPLIT_HORIZON), TestCase::QUICK);
+    AddTestCase (new Ipv6RipngTriggeredUpdateTest, TestCase::QUICK);
+    AddTestCase (new Ipv6RipngRouteTimersTest, TestCase::QUICK);
   }
 };
 
@@ -0,0 +1,258 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <list>
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/mac48-address.h"
+#include "ns3/socket.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/inet6-socket-address.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv6-address-helper.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv6-l3-protocol.h"
+#include "ns3/ipv6-interface.h"
+#include "ns3/arp-cache.h"
+#include "ns3/ndisc-cache.h"
+#include "ns3/neighbor-cache-helper.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Lookup of the ARP and NDISC cache entries by MAC address
+ */
+class NeighborCacheInverseTestCase : public TestCase
+{
+public:
+  NeighborCacheInverseTestCase ();
+  virtual void DoRun (void);
+};
+
+NeighborCacheInverseTestCase::NeighborCacheInverseTestCase ()
+  : TestCase ("Lookup of the neighbor cache entries by MAC address")
+{
+}
+
+void
+NeighborCacheInverseTestCase::DoRun (void)
+{
+  Mac48Address mac1 ("00:00:00:00:00:01");
+  Mac48Address mac2 ("00:00:00:00:00:02");
+
+  Ptr<ArpCache> arp = CreateObject<ArpCache> ();
+  ArpCache::Entry *a1 = arp->Add (Ipv4Address ("10.0.0.1"));
+  ArpCache::Entry *a2 = arp->Add (Ipv4Address ("10.0.0.2"));
+  ArpCache::Entry *a3 = arp->Add (Ipv4Address ("10.0.0.3"));
+  NS_TEST_EXPECT_MSG_EQ (arp->LookupInverse (mac1).size (), 0, "Unresolved entries should not be found");
+  a1->SetMacAddress (mac1);
+  a2->SetMacAddress (mac1);
+  a3->SetMacAddress (mac2);
+  NS_TEST_EXPECT_MSG_EQ (arp->LookupInverse (mac1).size (), 2, "Wrong number of entries for the MAC address");
+  a2->SetMacAddress (mac2);
+  std::list<ArpCache::Entry *> entries = arp->LookupInverse (mac1);
+  NS_TEST_ASSERT_MSG_EQ (entries.size (), 1, "The entry should have moved to the new MAC address");
+  NS_TEST_EXPECT_MSG_EQ (entries.front (), a1, "Wrong entry for the MAC address");
+  NS_TEST_EXPECT_MSG_EQ (arp->LookupInverse (mac2).size (), 2, "Wrong number of entries for the MAC address");
+  arp->Remove (a3);
+  entries = arp->LookupInverse (mac2);
+  NS_TEST_ASSERT_MSG_EQ (entries.size (), 1, "The removed entry should not be found");
+  NS_TEST_EXPECT_MSG_EQ (entries.front (), a2, "Wrong entry for the MAC address");
+  NS_TEST_EXPECT_MSG_EQ (arp->Lookup (Ipv4Address ("10.0.0.3")), 0, "The removed entry should not be found");
+  arp->Flush ();
+  NS_TEST_EXPECT_MSG_EQ (arp->LookupInverse (mac1).size (), 0, "The cache should be empty");
+  arp->Dispose ();
+
+  Ptr<NdiscCache> ndisc = CreateObject<NdiscCache> ();
+  NdiscCache::Entry *n1 = ndisc->Add (Ipv6Address ("2001::1"));
+  NdiscCache::Entry *n2 = ndisc->Add (Ipv6Address ("2001::2"));
+  n1->SetMacAddress (mac1);
+  n2->MarkStale (mac1);
+  NS_TEST_EXPECT_MSG_EQ (ndisc->LookupInverse (mac1).size (), 2, "Wrong number of entries for the MAC address");
+  n2->MarkReachable (mac2);
+  NS_TEST_ASSERT_MSG_EQ (ndisc->LookupInverse (mac2).size (), 1, "The entry should have moved to the new MAC address");
+  NS_TEST_EXPECT_MSG_EQ (ndisc->LookupInverse (mac2).front (), n2, "Wrong entry for the MAC address");
+  ndisc->Remove (n1);
+  NS_TEST_EXPECT_MSG_EQ (ndisc->LookupInverse (mac1).size (), 0, "The removed entry should not be found");
+  ndisc->Dispose ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Neighbor caches populated from the topology
+ *
+ * The hosts of a LAN send a datagram to each other after their caches have
+ * been populated: the datagrams must be delivered after the channel delay,
+ * without any address resolution.
+ */
+class NeighborCachePopulateTestCase : public TestCase
+{
+public:
+  NeighborCachePopulateTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Send a datagram
+   * \param socket the sending socket
+   * \param to the destination
+   */
+  void SendData (Ptr<Socket> socket, Address to);
+  /**
+   * \brief Receive a datagram
+   * \param socket the receiving socket
+   */
+  void ReceiveData (Ptr<Socket> socket);
+
+  uint32_t m_received;  //!< Number of datagrams received
+  Time m_sendTime;      //!< Time at which the datagrams are sent
+  Time m_delay;         //!< Delay of the channel
+};
+
+NeighborCachePopulateTestCase::NeighborCachePopulateTestCase ()
+  : TestCase ("Neighbor caches populated from the topology"),
+    m_received (0),
+    m_sendTime (Seconds (1)),
+    m_delay (MilliSeconds (2))
+{
+}
+
+void
+NeighborCachePopulateTestCase::SendData (Ptr<Socket> socket, Address to)
+{
+  socket->SendTo (Create<Packet> (100), 0, to);
+}
+
+void
+NeighborCachePopulateTestCase::ReceiveData (Ptr<Socket> socket)
+{
+  Ptr<Packet> packet;
+  while ((packet = socket->Recv ()))
+    {
+      NS_TEST_EXPECT_MSG_EQ (Simulator::Now (), m_sendTime + m_delay, "The datagram should not wait for an address resolution");
+      m_received++;
+    }
+}
+
+void
+NeighborCachePopulateTestCase::DoRun (void)
+{
+  const uint32_t nHosts = 4;
+  NodeContainer nodes;
+  nodes.Create (nHosts);
+  SimpleNetDeviceHelper simple;
+  simple.SetChannelAttribute ("Delay", TimeValue (m_delay));
+  NetDeviceContainer devices = simple.Install (nodes);
+
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  Ipv4AddressHelper ipv4 ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer ipv4Interfaces = ipv4.Assign (devices);
+  Ipv6AddressHelper ipv6;
+  ipv6.SetBase (Ipv6Address ("2001:1::"), Ipv6Prefix (64));
+  Ipv6InterfaceContainer ipv6Interfaces = ipv6.Assign (devices);
+
+  NeighborCacheHelper neighborCache;
+  neighborCache.PopulateNeighborCache (devices);
+
+  for (uint32_t i = 0; i < nHosts; i++)
+    {
+      Ptr<NetDevice> device = devices.Get (i);
+      Ptr<Ipv4L3Protocol> l3 = nodes.Get (i)->GetObject<Ipv4L3Protocol> ();
+      Ptr<ArpCache> arp = l3->GetInterface (l3->GetInterfaceForDevice (device))->GetArpCache ();
+      Ptr<Ipv6L3Protocol> l3v6 = nodes.Get (i)->GetObject<Ipv6L3Protocol> ();
+      Ptr<NdiscCache> ndisc = l3v6->GetInterface (l3v6->GetInterfaceForDevice (device))->GetNdiscCache ();
+      for (uint32_t j = 0; j < nHosts; j++)
+        {
+          ArpCache::Entry *entry = arp->Lookup (ipv4Interfaces.GetAddress (j));
+          NdiscCache::Entry *ndiscEntry = ndisc->Lookup (ipv6Interfaces.GetAddress (j, 1));
+          if (i == j)
+            {
+              NS_TEST_EXPECT_MSG_EQ (entry, 0, "No entry should be added for the own address");
+              NS_TEST_EXPECT_MSG_EQ (ndiscEntry, 0, "No entry should be added for the own address");
+              continue;
+            }
+          NS_TEST_ASSERT_MSG_NE (entry, 0, "Missing ARP entry");
+          NS_TEST_EXPECT_MSG_EQ (entry->IsPermanent (), true, "The ARP entry should be permanent");
+          NS_TEST_EXPECT_MSG_EQ (entry->GetMacAddress (), devices.Get (j)->GetAddress (), "Wrong MAC address");
+          NS_TEST_ASSERT_MSG_NE (ndiscEntry, 0, "Missing NDISC entry");
+          NS_TEST_EXPECT_MSG_EQ (ndiscEntry->IsPermanent (), true, "The NDISC entry should be permanent");
+          NS_TEST_EXPECT_MSG_EQ (ndiscEntry->GetMacAddress (), devices.Get (j)->GetAddress (), "Wrong MAC address");
+          NS_TEST_ASSERT_MSG_NE (ndisc->Lookup (ipv6Interfaces.GetAddress (j, 0)), 0, "Missing NDISC entry for the link-local address");
+        }
+    }
+
+  // each host sends a datagram to the next one, over IPv4 and IPv6
+  std::list<Ptr<Socket> > sockets;
+  for (uint32_t i = 0; i < nHosts; i++)
+    {
+      Ptr<Socket> receiver = Socket::CreateSocket (nodes.Get (i), UdpSocketFactory::GetTypeId ());
+      receiver->Bind (InetSocketAddress (Ipv4Address::GetAny (), 1234));
+      receiver->SetRecvCallback (MakeCallback (&NeighborCachePopulateTestCase::ReceiveData, this));
+      Ptr<Socket> receiver6 = Socket::CreateSocket (nodes.Get (i), UdpSocketFactory::GetTypeId ());
+      receiver6->Bind (Inet6SocketAddress (Ipv6Address::GetAny (), 1234));
+      receiver6->SetRecvCallback (MakeCallback (&NeighborCachePopulateTestCase::ReceiveData, this));
+      Ptr<Socket> sender = Socket::CreateSocket (nodes.Get (i), UdpSocketFactory::GetTypeId ());
+      sender->Bind ();
+      Ptr<Socket> sender6 = Socket::CreateSocket (nodes.Get (i), UdpSocketFactory::GetTypeId ());
+      sender6->Bind6 ();
+      uint32_t next = (i + 1) % nHosts;
+      Simulator::Schedule (m_sendTime, &NeighborCachePopulateTestCase::SendData, this, sender,
+                           InetSocketAddress (ipv4Interfaces.GetAddress (next), 1234));
+      Simulator::Schedule (m_sendTime, &NeighborCachePopulateTestCase::SendData, this, sender6,
+                           Inet6SocketAddress (ipv6Interfaces.GetAddress (next, 1), 1234));
+      sockets.push_back (receiver);
+      sockets.push_back (receiver6);
+      sockets.push_back (sender);
+      sockets.push_back (sender6);
+    }
+
+  Simulator::Stop (Seconds (2));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_received, 2 * nHosts, "All the datagrams should be received");
+
+  sockets.clear ();
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Neighbor cache TestSuite
+ */
+class NeighborCacheTestSuite : public TestSuite
+{
+public:
+  NeighborCacheTestSuite () : TestSuite ("neighbor-cache", UNIT)
+  {
+    AddTestCase (new NeighborCacheInverseTestCase (), TestCase::QUICK);
+    AddTestCase (new NeighborCachePopulateTestCase (), TestCase::QUICK);
+  }
+};
+
+static NeighborCacheTestSuite g_neighborCacheTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,212 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/prefix-trie.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/random-variable-stream.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief PrefixTrie test: random prefixes are added, at the end or at the
+ * front of the stored prefixes, and removed, and the matches of random
+ * addresses are compared with those found by a linear scan of the stored
+ * prefixes.
+ */
+class PrefixTrieTestCase : public TestCase
+{
+public:
+  PrefixTrieTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /// A stored prefix
+  struct Route
+  {
+    Ipv4Address network;  //!< the network
+    Ipv4Mask mask;        //!< the mask
+    uint32_t id;          //!< the value stored with the prefix
+  };
+
+  /**
+   * \brief Check the matches of an address against a linear scan
+   * \param trie the trie
+   * \param routes the stored prefixes, in the order of their values
+   * \param address the address
+   */
+  void CheckMatches (const PrefixTrie<uint32_t, 4> &trie, const std::vector<Route> &routes,
+                     Ipv4Address address);
+};
+
+PrefixTrieTestCase::PrefixTrieTestCase ()
+  : TestCase ("Check the prefix trie against a linear scan")
+{
+}
+
+void
+PrefixTrieTestCase::CheckMatches (const PrefixTrie<uint32_t, 4> &trie,
+                                  const std::vector<Route> &routes, Ipv4Address address)
+{
+  uint8_t key[4];
+  address.Serialize (key);
+
+  std::vector<uint32_t> expected;
+  uint16_t longest = 0;
+  for (std::vector<Route>::const_iterator it = routes.begin (); it != routes.end (); it++)
+    {
+      if (it->mask.IsMatch (address, it->network))
+        {
+          expected.push_back (it->id);
+          longest = std::max (longest, it->mask.GetPrefixLength ());
+        }
+    }
+  std::vector<uint32_t> found;
+  trie.FindAll (key, found);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), expected.size (), "Unexpected number of matches for " << address);
+  for (uint32_t i = 0; i < found.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (found[i], expected[i], "Unexpected match for " << address);
+    }
+
+  std::vector<const PrefixTrie<uint32_t, 4>::Entries *> matches;
+  trie.FindMatches (key, matches);
+  if (expected.empty ())
+    {
+      NS_TEST_EXPECT_MSG_EQ (matches.size (), 0, "Unexpected matches for " << address);
+      return;
+    }
+  NS_TEST_ASSERT_MSG_GT (matches.size (), 0, "Missing matches for " << address);
+  // the first prefix is the longest one; its values are in insertion order
+  std::vector<uint32_t> longestIds;
+  for (std::vector<Route>::const_iterator it = routes.begin (); it != routes.end (); it++)
+    {
+      if (it->mask.IsMatch (address, it->network) && it->mask.GetPrefixLength () == longest)
+        {
+          longestIds.push_back (it->id);
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (matches[0]->size (), longestIds.size (), "Unexpected longest match for " << address);
+  for (uint32_t i = 0; i < longestIds.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ ((*matches[0])[i].value, longestIds[i], "Unexpected longest match for " << address);
+    }
+}
+
+void
+PrefixTrieTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (1);
+
+  PrefixTrie<uint32_t, 4> trie;
+  std::vector<Route> routes;
+  uint32_t nextId = 0;
+
+  // a few overlapping prefixes, including a default route and duplicates,
+  // some added at the front
+  const char *networks[] = { "0.0.0.0", "10.0.0.0", "10.1.0.0", "10.1.1.0", "10.1.1.0", "10.1.1.1", "10.128.0.0", "10.1.1.1" };
+  const char *masks[] = { "/0", "/8", "/16", "/24", "/24", "/32", "/9", "/32" };
+  const bool front[] = { false, false, false, false, true, false, false, true };
+  for (uint32_t i = 0; i < sizeof (networks) / sizeof (networks[0]); i++)
+    {
+      Route route;
+      route.network = Ipv4Address (networks[i]);
+      route.mask = Ipv4Mask (masks[i]);
+      route.id = nextId++;
+      uint8_t prefix[4];
+      route.network.Serialize (prefix);
+      trie.Insert (prefix, route.mask.GetPrefixLength (), route.id, front[i]);
+      routes.insert (front[i] ? routes.begin () : routes.end (), route);
+    }
+  CheckMatches (trie, routes, Ipv4Address ("10.1.1.1"));
+  CheckMatches (trie, routes, Ipv4Address ("10.1.1.2"));
+  CheckMatches (trie, routes, Ipv4Address ("10.200.0.1"));
+  CheckMatches (trie, routes, Ipv4Address ("192.168.0.1"));
+
+  uint8_t prefix[4];
+  Ipv4Address ("10.1.1.0").Serialize (prefix);
+  NS_TEST_ASSERT_MSG_NE (trie.Find (prefix, 24), 0, "Missing exact match");
+  NS_TEST_EXPECT_MSG_EQ (trie.Find (prefix, 24)->size (), 2, "Unexpected exact match");
+  NS_TEST_EXPECT_MSG_EQ ((*trie.Find (prefix, 24))[0].value, 4, "The value added at the front should be first");
+  NS_TEST_EXPECT_MSG_EQ (trie.Find (prefix, 23), 0, "Unexpected exact match");
+  NS_TEST_EXPECT_MSG_EQ (trie.Remove (prefix, 24, 1000), false, "Unexpected removal");
+
+  // random insertions and removals, with prefixes concentrated in a few
+  // networks so that they overlap
+  for (uint32_t round = 0; round < 2000; round++)
+    {
+      if (routes.empty () || rng->GetValue () < 0.6)
+        {
+          Route route;
+          uint32_t address = (10u << 24) | (rng->GetInteger (0, 3) << 16) | rng->GetInteger (0, 0xffff);
+          route.mask = Ipv4Mask (~((1ull << (32 - rng->GetInteger (8, 32))) - 1) & 0xffffffff);
+          route.network = Ipv4Address (address);
+          route.id = nextId++;
+          route.network.Serialize (prefix);
+          bool atFront = rng->GetValue () < 0.3;
+          trie.Insert (prefix, route.mask.GetPrefixLength (), route.id, atFront);
+          routes.insert (atFront ? routes.begin () : routes.end (), route);
+        }
+      else
+        {
+          uint32_t index = rng->GetInteger (0, routes.size () - 1);
+          routes[index].network.Serialize (prefix);
+          NS_TEST_EXPECT_MSG_EQ (trie.Remove (prefix, routes[index].mask.GetPrefixLength (), routes[index].id),
+                                 true, "Failed removal");
+          routes.erase (routes.begin () + index);
+        }
+      NS_TEST_ASSERT_MSG_EQ (trie.GetSize (), routes.size (), "Unexpected size");
+      if (round % 10 == 0)
+        {
+          Ipv4Address address ((10u << 24) | (rng->GetInteger (0, 4) << 16) | rng->GetInteger (0, 0xffff));
+          CheckMatches (trie, routes, address);
+          if (!routes.empty ())
+            {
+              CheckMatches (trie, routes, routes[rng->GetInteger (0, routes.size () - 1)].network);
+            }
+        }
+    }
+
+  trie.Clear ();
+  NS_TEST_EXPECT_MSG_EQ (trie.GetSize (), 0, "The trie should be empty");
+  routes.clear ();
+  CheckMatches (trie, routes, Ipv4Address ("10.1.1.1"));
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief PrefixTrie TestSuite
+ */
+class PrefixTrieTestSuite : public TestSuite
+{
+public:
+  PrefixTrieTestSuite ();
+};
+
+PrefixTrieTestSuite::PrefixTrieTestSuite ()
+  : TestSuite ("prefix-trie", UNIT)
+{
+  AddTestCase (new PrefixTrieTestCase (), TestCase::QUICK);
+}
+
+static PrefixTrieTestSuite g_prefixTrieTestSuite; //!< Static variable for test initialization
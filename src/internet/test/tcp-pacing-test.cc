@@ -0,0 +1,349 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/config.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include "ns3/string.h"
+#include "ns3/enum.h"
+#include "ns3/data-rate.h"
+#include "ns3/packet.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/traffic-control-helper.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/tcp-socket-factory.h"
+#include "ns3/tcp-socket-base.h"
+#include "ns3/tcp-l4-protocol.h"
+#include "ns3/tcp-pacing-wheel.h"
+#include "ns3/tcp-header.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check the times at which the timing wheel invokes its handlers
+ *
+ * The wheel has 8 slots of 10 us, hence the departure times farther than
+ * 80 us in the future go through the overflow list.
+ */
+class TcpPacingWheelTestCase : public TestCase
+{
+public:
+  TcpPacingWheelTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Schedule a handler and check the time returned by the wheel
+   * \param departure the departure time
+   * \param expected the expected invocation time
+   * \param id the identifier of the handler
+   */
+  void Schedule (Time departure, Time expected, uint32_t id);
+  /**
+   * \brief Handler scheduled on the wheel
+   * \param test the test case
+   * \param id the identifier of the handler
+   * \param expected the expected invocation time
+   */
+  static void Handler (TcpPacingWheelTestCase *test, uint32_t id, Time expected);
+  /**
+   * \brief Record and check the invocation of a handler
+   * \param id the identifier of the handler
+   * \param expected the expected invocation time
+   */
+  void Invoked (uint32_t id, Time expected);
+
+  Ptr<TcpPacingWheel> m_wheel; //!< The wheel
+  std::vector<uint32_t> m_invoked; //!< Identifiers of the invoked handlers
+};
+
+TcpPacingWheelTestCase::TcpPacingWheelTestCase ()
+  : TestCase ("Timing wheel of the paced sockets")
+{
+}
+
+void
+TcpPacingWheelTestCase::Schedule (Time departure, Time expected, uint32_t id)
+{
+  Time served = m_wheel->Schedule (departure, MakeBoundCallback (&TcpPacingWheelTestCase::Handler, this, id, expected));
+  NS_TEST_EXPECT_MSG_EQ (served, expected, "Unexpected invocation time of handler " << id);
+}
+
+void
+TcpPacingWheelTestCase::Handler (TcpPacingWheelTestCase *test, uint32_t id, Time expected)
+{
+  test->Invoked (id, expected);
+}
+
+void
+TcpPacingWheelTestCase::Invoked (uint32_t id, Time expected)
+{
+  NS_TEST_EXPECT_MSG_EQ (Simulator::Now (), expected, "Handler " << id << " invoked at the wrong time");
+  m_invoked.push_back (id);
+  if (id == 1)
+    {
+      // a departure time in the past, or in the slot being served, is
+      // served at the next slot
+      Schedule (MicroSeconds (10), MicroSeconds (40), 10);
+      Schedule (MicroSeconds (75), MicroSeconds (80), 11);
+      // beyond the wheel
+      Schedule (MicroSeconds (120), MicroSeconds (120), 12);
+    }
+}
+
+void
+TcpPacingWheelTestCase::DoRun (void)
+{
+  m_wheel = CreateObject<TcpPacingWheel> ();
+  m_wheel->SetAttribute ("Granularity", TimeValue (MicroSeconds (10)));
+  m_wheel->SetAttribute ("Slots", UintegerValue (8));
+
+  Schedule (MicroSeconds (25), MicroSeconds (30), 1);
+  Schedule (MicroSeconds (30), MicroSeconds (30), 2);
+  Schedule (MicroSeconds (0), MicroSeconds (0), 3);
+  Schedule (MicroSeconds (500), MicroSeconds (500), 4);
+  Schedule (MicroSeconds (95), MicroSeconds (100), 5);
+  NS_TEST_EXPECT_MSG_EQ (m_wheel->GetNPending (), 5, "Wrong number of pending handlers");
+
+  Simulator::Run ();
+
+  uint32_t order[] = { 3, 1, 2, 10, 11, 5, 12, 4 };
+  NS_TEST_ASSERT_MSG_EQ (m_invoked.size (), 8, "Wrong number of invoked handlers");
+  for (uint32_t i = 0; i < 8; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_invoked[i], order[i], "Handlers invoked in the wrong order");
+    }
+  NS_TEST_EXPECT_MSG_EQ (m_wheel->GetNPending (), 0, "Wrong number of pending handlers");
+
+  // after an idle period, the wheel is aligned with the current time
+  m_invoked.clear ();
+  Simulator::Schedule (MilliSeconds (10) - Simulator::Now (), &TcpPacingWheelTestCase::Schedule, this,
+                       MilliSeconds (10) + MicroSeconds (55), MilliSeconds (10) + MicroSeconds (60), 20);
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_invoked.size (), 1, "The handler should have been invoked");
+
+  m_wheel->Dispose ();
+  m_wheel = 0;
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Paced bulk transfer with a given pacing mode
+ *
+ * The sender paces its segments at 10 Mbps over a 100 Mbps link. The
+ * segments must reach the receiver spaced by (at least) their transmission
+ * time at the pacing rate, whatever the pacing mode.
+ */
+class TcpPacingModeTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Constructor
+   * \param mode the pacing mode
+   * \param name the name of the pacing mode
+   */
+  TcpPacingModeTestCase (TcpL4Protocol::PacingMode_t mode, std::string name);
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Fill the transmission buffer of the sender
+   * \param socket the sender socket
+   * \param available the space available in the transmission buffer
+   */
+  void Send (Ptr<Socket> socket, uint32_t available);
+  /**
+   * \brief Accept a connection
+   * \param socket the accepted socket
+   * \param from the address of the peer
+   */
+  void Accept (Ptr<Socket> socket, const Address &from);
+  /**
+   * \brief Read the received data
+   * \param socket the receiver socket
+   */
+  void Receive (Ptr<Socket> socket);
+  /**
+   * \brief Record the arrival of a data packet at the receiver socket
+   * \param packet the packet
+   * \param header the TCP header
+   * \param socket the socket
+   */
+  void Rx (Ptr<const Packet> packet, const TcpHeader &header, Ptr<const TcpSocketBase> socket);
+
+  static const uint32_t m_totalBytes = 500000;  //!< Size of the transfer
+  static const uint32_t m_segmentSize = 1000;   //!< Segment size
+  TcpL4Protocol::PacingMode_t m_mode;           //!< Pacing mode
+  uint32_t m_sent;                              //!< Bytes given to the sender socket
+  uint32_t m_received;                          //!< Bytes read from the receiver socket
+  std::vector<Time> m_arrivals;                 //!< Arrival times of the data packets
+};
+
+TcpPacingModeTestCase::TcpPacingModeTestCase (TcpL4Protocol::PacingMode_t mode, std::string name)
+  : TestCase ("Paced bulk transfer, pacing mode " + name),
+    m_mode (mode),
+    m_sent (0),
+    m_received (0)
+{
+}
+
+void
+TcpPacingModeTestCase::Send (Ptr<Socket> socket, uint32_t available)
+{
+  // write whole segments only, so that all the data packets have the same size
+  while (m_sent < m_totalBytes && socket->GetTxAvailable () >= m_segmentSize)
+    {
+      uint32_t size = std::min (socket->GetTxAvailable () / m_segmentSize * m_segmentSize, m_totalBytes - m_sent);
+      int sent = socket->Send (Create<Packet> (size));
+      if (sent <= 0)
+        {
+          break;
+        }
+      m_sent += sent;
+    }
+  if (m_sent == m_totalBytes)
+    {
+      socket->Close ();
+    }
+}
+
+void
+TcpPacingModeTestCase::Accept (Ptr<Socket> socket, const Address &from)
+{
+  socket->SetRecvCallback (MakeCallback (&TcpPacingModeTestCase::Receive, this));
+  socket->TraceConnectWithoutContext ("Rx", MakeCallback (&TcpPacingModeTestCase::Rx, this));
+}
+
+void
+TcpPacingModeTestCase::Receive (Ptr<Socket> socket)
+{
+  Ptr<Packet> packet;
+  while ((packet = socket->Recv ()))
+    {
+      m_received += packet->GetSize ();
+    }
+}
+
+void
+TcpPacingModeTestCase::Rx (Ptr<const Packet> packet, const TcpHeader &header, Ptr<const TcpSocketBase> socket)
+{
+  if (packet->GetSize () > 0)
+    {
+      m_arrivals.push_back (Simulator::Now ());
+    }
+}
+
+void
+TcpPacingModeTestCase::DoRun (void)
+{
+  DataRate pacingRate ("10Mbps");
+  Config::SetDefault ("ns3::TcpSocketState::EnablePacing", BooleanValue (true));
+  Config::SetDefault ("ns3::TcpSocketState::MaxPacingRate", DataRateValue (pacingRate));
+
+  NodeContainer nodes;
+  nodes.Create (2);
+  SimpleNetDeviceHelper simple;
+  simple.SetChannelAttribute ("Delay", TimeValue (MilliSeconds (1)));
+  simple.SetDeviceAttribute ("DataRate", DataRateValue (DataRate ("100Mbps")));
+  NetDeviceContainer devices = simple.Install (nodes);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  if (m_mode == TcpL4Protocol::PACING_EDT)
+    {
+      TrafficControlHelper tch;
+      tch.SetRootQueueDisc ("ns3::EdtQueueDisc");
+      tch.Install (devices);
+    }
+  Ipv4AddressHelper address ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = address.Assign (devices);
+  nodes.Get (0)->GetObject<TcpL4Protocol> ()->SetAttribute ("PacingMode", EnumValue (m_mode));
+
+  Ptr<Socket> server = Socket::CreateSocket (nodes.Get (1), TcpSocketFactory::GetTypeId ());
+  server->SetAttribute ("SegmentSize", UintegerValue (m_segmentSize));
+  server->Bind (InetSocketAddress (Ipv4Address::GetAny (), 80));
+  server->Listen ();
+  server->SetAcceptCallback (MakeNullCallback<bool, Ptr<Socket>, const Address &> (),
+                             MakeCallback (&TcpPacingModeTestCase::Accept, this));
+
+  Ptr<Socket> client = Socket::CreateSocket (nodes.Get (0), TcpSocketFactory::GetTypeId ());
+  client->SetAttribute ("SegmentSize", UintegerValue (m_segmentSize));
+  client->SetSendCallback (MakeCallback (&TcpPacingModeTestCase::Send, this));
+  client->Connect (InetSocketAddress (interfaces.GetAddress (1), 80));
+
+  Simulator::Stop (Seconds (10));
+  Simulator::Run ();
+  // release the sockets before their timers outlive the simulator
+  server = 0;
+  client = 0;
+  Simulator::Destroy ();
+  Config::Reset ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_received, m_totalBytes, "The whole data should be received");
+  NS_TEST_ASSERT_MSG_EQ (m_arrivals.size (), m_totalBytes / m_segmentSize, "Wrong number of data packets");
+
+  // the segments (and their 52 bytes of headers) are paced; the timing
+  // wheel may serve a segment up to its granularity (10 us) earlier than
+  // the previous segment plus the transmission time
+  Time txTime = pacingRate.CalculateBytesTxTime (m_segmentSize);
+  Time minGap = txTime - MicroSeconds (10);
+  uint32_t tooClose = 0;
+  for (uint32_t i = 1; i < m_arrivals.size (); i++)
+    {
+      if (m_arrivals[i] - m_arrivals[i - 1] < minGap)
+        {
+          tooClose++;
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (tooClose, 0, "Segments not paced");
+  Time duration = m_arrivals.back () - m_arrivals.front ();
+  Time paced = txTime * (m_arrivals.size () - 1);
+  NS_TEST_EXPECT_MSG_GT_OR_EQ (duration, paced - MicroSeconds (10), "Transfer faster than the pacing rate");
+  NS_TEST_EXPECT_MSG_LT (duration, paced * 11 / 10, "Transfer much slower than the pacing rate");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief TCP pacing TestSuite
+ */
+class TcpPacingTestSuite : public TestSuite
+{
+public:
+  TcpPacingTestSuite ();
+};
+
+TcpPacingTestSuite::TcpPacingTestSuite ()
+  : TestSuite ("tcp-pacing", UNIT)
+{
+  AddTestCase (new TcpPacingWheelTestCase (), TestCase::QUICK);
+  AddTestCase (new TcpPacingModeTestCase (TcpL4Protocol::PACING_TIMER, "Timer"), TestCase::QUICK);
+  AddTestCase (new TcpPacingModeTestCase (TcpL4Protocol::PACING_WHEEL, "Wheel"), TestCase::QUICK);
+  AddTestCase (new TcpPacingModeTestCase (TcpL4Protocol::PACING_EDT, "Edt"), TestCase::QUICK);
+}
+
+static TcpPacingTestSuite g_tcpPacingTestSuite; //!< Static variable for test initialization
@@ -18,6 +18,7 @@
 #include "ns3/test.h"
 #include "ns3/packet.h"
 #include "ns3/log.h"
+#include "ns3/socket.h"
 
 #include "ns3/tcp-rx-buffer.h"
 
@@ -44,6 +45,14 @@ private:
    * \brief Test the SACK list update.
    */
   void TestUpdateSACKList ();
+  /**
+   * \brief Test the coalescing of overlapping and adjacent segments.
+   */
+  void TestCoalescing ();
+  /**
+   * \brief Test that the extracted data does not alter the received packets.
+   */
+  void TestExtract ();
 };
 
 TcpRxBufferTestCase::TcpRxBufferTestCase ()
@@ -55,6 +64,8 @@ void
 TcpRxBufferTestCase::DoRun ()
 {
   TestUpdateSACKList ();
+  TestCoalescing ();
+  TestExtract ();
 }
 
 void
@@ -338,6 +349,91 @@ TcpRxBufferTestCase::TestUpdateSACKList ()
                          "SACK list should contain no element");
 }
 
+void
+TcpRxBufferTestCase::TestCoalescing ()
+{
+  TcpRxBuffer rxBuf;
+  TcpOptionSack::SackList sackList;
+  TcpHeader h;
+  rxBuf.SetNextRxSequence (SequenceNumber32 (1));
+  rxBuf.SetMaxBufferSize (100000);
+
+  // Six isolated blocks: only the last four are reported
+  for (uint32_t i = 0; i < 6; ++i)
+    {
+      h.SetSequenceNumber (SequenceNumber32 (201 + 200 * i));
+      rxBuf.Add (Create<Packet> (100), h);
+    }
+  sackList = rxBuf.GetSackList ();
+  NS_TEST_ASSERT_MSG_EQ (sackList.size (), 4, "SACK list should contain four elements");
+  NS_TEST_ASSERT_MSG_EQ (sackList.front ().first, SequenceNumber32 (1201),
+                         "SACK block different than expected");
+
+  // Fill the gap after the first block, which is no more in the list: the
+  // first SACK block reports the whole contiguous data
+  h.SetSequenceNumber (SequenceNumber32 (301));
+  rxBuf.Add (Create<Packet> (100), h);
+  sackList = rxBuf.GetSackList ();
+  NS_TEST_ASSERT_MSG_EQ (sackList.front ().first, SequenceNumber32 (201),
+                         "SACK block different than expected");
+  NS_TEST_ASSERT_MSG_EQ (sackList.front ().second, SequenceNumber32 (501),
+                         "SACK block different than expected");
+  NS_TEST_ASSERT_MSG_EQ (sackList.size (), 4, "SACK list should contain four elements");
+
+  // A segment overlapping the first block, and embedding the others
+  h.SetSequenceNumber (SequenceNumber32 (451));
+  rxBuf.Add (Create<Packet> (1000), h);
+  sackList = rxBuf.GetSackList ();
+  NS_TEST_ASSERT_MSG_EQ (sackList.front ().first, SequenceNumber32 (201),
+                         "SACK block different than expected");
+  NS_TEST_ASSERT_MSG_EQ (sackList.front ().second, SequenceNumber32 (1451),
+                         "SACK block different than expected");
+  NS_TEST_ASSERT_MSG_EQ (sackList.size (), 1, "SACK list should contain one element");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Size (), 1250, "Unexpected buffer occupancy");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Available (), 0, "No data should be available");
+
+  // In-sequence data overlapping the out-of-order data
+  h.SetSequenceNumber (SequenceNumber32 (1));
+  rxBuf.Add (Create<Packet> (300), h);
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.NextRxSequence (), SequenceNumber32 (1451),
+                         "Sequence number differs from expected");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.GetSackListSize (), 0, "SACK list should be empty");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Available (), 1450, "Unexpected available data");
+
+  // The data is extracted in pieces, whatever the segments
+  Ptr<Packet> p = rxBuf.Extract (150);
+  NS_TEST_ASSERT_MSG_EQ (p->GetSize (), 150, "Unexpected extracted size");
+  p = rxBuf.Extract (2000);
+  NS_TEST_ASSERT_MSG_EQ (p->GetSize (), 1300, "Unexpected extracted size");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Size (), 0, "The buffer should be empty");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Extract (2000), 0, "Nothing should be extracted");
+}
+
+void
+TcpRxBufferTestCase::TestExtract ()
+{
+  TcpRxBuffer rxBuf;
+  TcpHeader h;
+  rxBuf.SetNextRxSequence (SequenceNumber32 (1));
+
+  SocketPriorityTag priorityTag;
+  priorityTag.SetPriority (3);
+  Ptr<Packet> first = Create<Packet> (100);
+  first->AddPacketTag (priorityTag);
+  h.SetSequenceNumber (SequenceNumber32 (1));
+  rxBuf.Add (first, h);
+  h.SetSequenceNumber (SequenceNumber32 (101));
+  rxBuf.Add (Create<Packet> (100), h);
+
+  Ptr<Packet> p = rxBuf.Extract (200);
+  NS_TEST_ASSERT_MSG_EQ (p->GetSize (), 200, "Unexpected extracted size");
+  NS_TEST_EXPECT_MSG_EQ (p->PeekPacketTag (priorityTag), false,
+                         "The extracted data should not carry the packet tags of the sender");
+  NS_TEST_EXPECT_MSG_EQ (first->GetSize (), 100, "The received packet should not be modified");
+  NS_TEST_EXPECT_MSG_EQ (first->PeekPacketTag (priorityTag), true,
+                         "The received packet should keep its packet tags");
+}
+
 void
 TcpRxBufferTestCase::DoTeardown ()
 {
@@ -0,0 +1,398 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <set>
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include "ns3/string.h"
+#include "ns3/packet.h"
+#include "ns3/segmentation-offload.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/tcp-socket-factory.h"
+#include "ns3/tcp-socket-base.h"
+#include "ns3/tcp-l4-protocol.h"
+#include "ns3/tcp-header.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv6-header.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/ipv6-l3-protocol.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief TCP super-segments are split by the segmenters registered by
+ * TcpL4Protocol for IPv4 and IPv6.
+ */
+class TcpSegmenterTestCase : public TestCase
+{
+public:
+  TcpSegmenterTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Check the TCP header and the payload of a segment
+   * \param segment the segment, starting with the TCP header
+   * \param index the index of the segment
+   * \param count the number of segments
+   */
+  void CheckTcpSegment (Ptr<Packet> segment, uint32_t index, uint32_t count);
+};
+
+TcpSegmenterTestCase::TcpSegmenterTestCase ()
+  : TestCase ("Split TCP super-segments over IPv4 and IPv6")
+{
+}
+
+void
+TcpSegmenterTestCase::CheckTcpSegment (Ptr<Packet> segment, uint32_t index, uint32_t count)
+{
+  TcpHeader tcpHeader;
+  segment->RemoveHeader (tcpHeader);
+  NS_TEST_EXPECT_MSG_EQ (tcpHeader.GetSequenceNumber (), SequenceNumber32 (1000 + 1000 * index),
+                         "Unexpected sequence number");
+  NS_TEST_EXPECT_MSG_EQ (tcpHeader.GetAckNumber (), SequenceNumber32 (77), "Unexpected ack number");
+  NS_TEST_EXPECT_MSG_EQ (segment->GetSize (), (index + 1 < count ? 1000 : 500), "Unexpected payload size");
+  uint8_t flags = TcpHeader::ACK;
+  if (index == 0)
+    {
+      flags |= TcpHeader::CWR;
+    }
+  if (index + 1 == count)
+    {
+      flags |= TcpHeader::PSH | TcpHeader::FIN;
+    }
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t) tcpHeader.GetFlags (), (uint32_t) flags, "Unexpected flags");
+  SegmentationOffloadTag tag;
+  NS_TEST_EXPECT_MSG_EQ (segment->PeekPacketTag (tag), false, "The segments should not be tagged");
+}
+
+void
+TcpSegmenterTestCase::DoRun (void)
+{
+  // the segmenters are registered by TcpL4Protocol
+  Ptr<TcpL4Protocol> tcp = CreateObject<TcpL4Protocol> ();
+
+  TcpHeader tcpHeader;
+  tcpHeader.SetSequenceNumber (SequenceNumber32 (1000));
+  tcpHeader.SetAckNumber (SequenceNumber32 (77));
+  tcpHeader.SetFlags (TcpHeader::ACK | TcpHeader::PSH | TcpHeader::FIN | TcpHeader::CWR);
+  tcpHeader.SetSourcePort (49153);
+  tcpHeader.SetDestinationPort (80);
+
+  // IPv4
+  Ptr<Packet> packet = Create<Packet> (3500);
+  packet->AddHeader (tcpHeader);
+  Ipv4Header ipv4Header;
+  ipv4Header.SetSource (Ipv4Address ("10.0.0.1"));
+  ipv4Header.SetDestination (Ipv4Address ("10.0.0.2"));
+  ipv4Header.SetProtocol (TcpL4Protocol::PROT_NUMBER);
+  ipv4Header.SetPayloadSize (packet->GetSize ());
+  ipv4Header.SetIdentification (7);
+  packet->AddHeader (ipv4Header);
+
+  std::vector<Ptr<Packet> > segments;
+  NS_TEST_EXPECT_MSG_EQ (SegmentationOffload::Segment (packet, Ipv4L3Protocol::PROT_NUMBER, segments), false,
+                         "A packet without tag is not a super-segment");
+  packet->AddPacketTag (SegmentationOffloadTag (1000));
+  NS_TEST_ASSERT_MSG_EQ (SegmentationOffload::Segment (packet, Ipv4L3Protocol::PROT_NUMBER, segments), true,
+                         "The super-segment should be split");
+  NS_TEST_ASSERT_MSG_EQ (segments.size (), 4, "Unexpected number of segments");
+  for (uint32_t i = 0; i < segments.size (); i++)
+    {
+      Ipv4Header header;
+      segments[i]->RemoveHeader (header);
+      NS_TEST_EXPECT_MSG_EQ (header.GetPayloadSize (), segments[i]->GetSize (), "Unexpected payload size");
+      NS_TEST_EXPECT_MSG_EQ (header.GetIdentification (), 7 + i, "Unexpected identification");
+      NS_TEST_EXPECT_MSG_EQ (header.GetDestination (), Ipv4Address ("10.0.0.2"), "Unexpected destination");
+      CheckTcpSegment (segments[i], i, segments.size ());
+    }
+
+  // a tagged packet which does not carry TCP is not split
+  Ptr<Packet> udp = Create<Packet> (3500);
+  Ipv4Header udpHeader = ipv4Header;
+  udpHeader.SetProtocol (17);
+  udp->AddHeader (udpHeader);
+  udp->AddPacketTag (SegmentationOffloadTag (1000));
+  segments.clear ();
+  NS_TEST_EXPECT_MSG_EQ (SegmentationOffload::Segment (udp, Ipv4L3Protocol::PROT_NUMBER, segments), false,
+                         "Only TCP super-segments can be split");
+
+  // IPv6
+  packet = Create<Packet> (3500);
+  packet->AddHeader (tcpHeader);
+  Ipv6Header ipv6Header;
+  ipv6Header.SetSourceAddress (Ipv6Address ("2001:db8::1"));
+  ipv6Header.SetDestinationAddress (Ipv6Address ("2001:db8::2"));
+  ipv6Header.SetNextHeader (TcpL4Protocol::PROT_NUMBER);
+  ipv6Header.SetPayloadLength (packet->GetSize ());
+  packet->AddHeader (ipv6Header);
+  packet->AddPacketTag (SegmentationOffloadTag (1000));
+  segments.clear ();
+  NS_TEST_ASSERT_MSG_EQ (SegmentationOffload::Segment (packet, Ipv6L3Protocol::PROT_NUMBER, segments), true,
+                         "The super-segment should be split");
+  NS_TEST_ASSERT_MSG_EQ (segments.size (), 4, "Unexpected number of segments");
+  for (uint32_t i = 0; i < segments.size (); i++)
+    {
+      Ipv6Header header;
+      segments[i]->RemoveHeader (header);
+      NS_TEST_EXPECT_MSG_EQ (header.GetPayloadLength (), segments[i]->GetSize (), "Unexpected payload length");
+      CheckTcpSegment (segments[i], i, segments.size ());
+    }
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief A bulk transfer with TSO and GRO enabled delivers the same byte
+ * stream with fewer packets handled by the sockets. The devices do not
+ * split the super-segments, hence the network layer does it (GSO).
+ */
+class TcpOffloadTransferTestCase : public TestCase
+{
+public:
+  TcpOffloadTransferTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Fill the transmission buffer of the sender
+   * \param socket the sender socket
+   * \param available the space available in the transmission buffer
+   */
+  void Send (Ptr<Socket> socket, uint32_t available);
+  /**
+   * \brief Accept a connection
+   * \param socket the accepted socket
+   * \param from the address of the peer
+   */
+  void Accept (Ptr<Socket> socket, const Address &from);
+  /**
+   * \brief Read and check the received data
+   * \param socket the receiver socket
+   */
+  void Receive (Ptr<Socket> socket);
+  /**
+   * \brief Count the data packets sent by the sender socket
+   * \param packet the packet
+   * \param header the TCP header
+   * \param socket the socket
+   */
+  void Tx (Ptr<const Packet> packet, const TcpHeader &header, Ptr<const TcpSocketBase> socket);
+  /**
+   * \brief Count the data packets processed by the receiver socket
+   * \param packet the packet
+   * \param header the TCP header
+   * \param socket the socket
+   */
+  void Rx (Ptr<const Packet> packet, const TcpHeader &header, Ptr<const TcpSocketBase> socket);
+  /**
+   * \brief Check the identification of the IP packets sent by the sender
+   * \param packet the packet, including the IP header
+   * \param ipv4 the IPv4 protocol
+   * \param interface the interface index
+   */
+  void IpTx (Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface);
+
+  static const uint32_t m_totalBytes = 2000000; //!< Size of the transfer
+  static const uint32_t m_segmentSize = 1000;   //!< Segment size
+  uint32_t m_sent;            //!< Bytes given to the sender socket
+  uint32_t m_received;        //!< Bytes read from the receiver socket
+  uint32_t m_errors;          //!< Received bytes not matching the sent ones
+  uint32_t m_txPackets;       //!< Data packets sent by the sender socket
+  uint32_t m_txSuperSegments; //!< Super-segments sent by the sender socket
+  uint32_t m_rxPackets;       //!< Data packets processed by the receiver socket
+  uint32_t m_rxCoalesced;     //!< Coalesced packets processed by the receiver socket
+  std::set<uint16_t> m_ipIds; //!< Identifications of the IP packets sent by the sender
+  uint32_t m_duplicateIpIds;  //!< IP packets sent with an identification already used
+};
+
+TcpOffloadTransferTestCase::TcpOffloadTransferTestCase ()
+  : TestCase ("Bulk transfer with TCP segmentation and receive offload"),
+    m_sent (0),
+    m_received (0),
+    m_errors (0),
+    m_txPackets (0),
+    m_txSuperSegments (0),
+    m_rxPackets (0),
+    m_rxCoalesced (0),
+    m_duplicateIpIds (0)
+{
+}
+
+void
+TcpOffloadTransferTestCase::Send (Ptr<Socket> socket, uint32_t available)
+{
+  uint8_t buffer[4000];
+  while (m_sent < m_totalBytes && socket->GetTxAvailable () > 0)
+    {
+      uint32_t size = std::min (std::min<uint32_t> (sizeof (buffer), socket->GetTxAvailable ()), m_totalBytes - m_sent);
+      for (uint32_t i = 0; i < size; i++)
+        {
+          buffer[i] = (m_sent + i) % 251;
+        }
+      int sent = socket->Send (Create<Packet> (buffer, size));
+      if (sent <= 0)
+        {
+          break;
+        }
+      m_sent += sent;
+    }
+  if (m_sent == m_totalBytes)
+    {
+      socket->Close ();
+    }
+}
+
+void
+TcpOffloadTransferTestCase::Accept (Ptr<Socket> socket, const Address &from)
+{
+  socket->SetRecvCallback (MakeCallback (&TcpOffloadTransferTestCase::Receive, this));
+  socket->TraceConnectWithoutContext ("Rx", MakeCallback (&TcpOffloadTransferTestCase::Rx, this));
+}
+
+void
+TcpOffloadTransferTestCase::Receive (Ptr<Socket> socket)
+{
+  Ptr<Packet> packet;
+  while ((packet = socket->Recv ()))
+    {
+      std::vector<uint8_t> buffer (packet->GetSize ());
+      packet->CopyData (buffer.data (), buffer.size ());
+      for (uint32_t i = 0; i < buffer.size (); i++)
+        {
+          if (buffer[i] != (m_received + i) % 251)
+            {
+              m_errors++;
+            }
+        }
+      m_received += buffer.size ();
+    }
+}
+
+void
+TcpOffloadTransferTestCase::Tx (Ptr<const Packet> packet, const TcpHeader &header, Ptr<const TcpSocketBase> socket)
+{
+  if (packet->GetSize () > 0)
+    {
+      m_txPackets++;
+      if (packet->GetSize () > m_segmentSize)
+        {
+          m_txSuperSegments++;
+        }
+    }
+}
+
+void
+TcpOffloadTransferTestCase::Rx (Ptr<const Packet> packet, const TcpHeader &header, Ptr<const TcpSocketBase> socket)
+{
+  if (packet->GetSize () > 0)
+    {
+      m_rxPackets++;
+      if (packet->GetSize () > m_segmentSize)
+        {
+          m_rxCoalesced++;
+        }
+    }
+}
+
+void
+TcpOffloadTransferTestCase::IpTx (Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface)
+{
+  Ipv4Header header;
+  packet->PeekHeader (header);
+  if (!m_ipIds.insert (header.GetIdentification ()).second)
+    {
+      m_duplicateIpIds++;
+    }
+}
+
+void
+TcpOffloadTransferTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+  SimpleNetDeviceHelper simple;
+  simple.SetChannelAttribute ("Delay", TimeValue (MilliSeconds (10)));
+  NetDeviceContainer devices = simple.Install (nodes);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  Ipv4AddressHelper address ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = address.Assign (devices);
+  nodes.Get (0)->GetObject<Ipv4L3Protocol> ()->TraceConnectWithoutContext ("Tx",
+                                                                          MakeCallback (&TcpOffloadTransferTestCase::IpTx, this));
+
+  Ptr<Socket> server = Socket::CreateSocket (nodes.Get (1), TcpSocketFactory::GetTypeId ());
+  server->SetAttribute ("Gro", BooleanValue (true));
+  server->SetAttribute ("SegmentSize", UintegerValue (m_segmentSize));
+  server->SetAttribute ("RcvBufSize", UintegerValue (1 << 20));
+  server->Bind (InetSocketAddress (Ipv4Address::GetAny (), 80));
+  server->Listen ();
+  server->SetAcceptCallback (MakeNullCallback<bool, Ptr<Socket>, const Address &> (),
+                             MakeCallback (&TcpOffloadTransferTestCase::Accept, this));
+
+  Ptr<Socket> client = Socket::CreateSocket (nodes.Get (0), TcpSocketFactory::GetTypeId ());
+  client->SetAttribute ("Tso", BooleanValue (true));
+  client->SetAttribute ("SegmentSize", UintegerValue (m_segmentSize));
+  client->SetAttribute ("SndBufSize", UintegerValue (1 << 20));
+  client->TraceConnectWithoutContext ("Tx", MakeCallback (&TcpOffloadTransferTestCase::Tx, this));
+  client->SetSendCallback (MakeCallback (&TcpOffloadTransferTestCase::Send, this));
+  client->Connect (InetSocketAddress (interfaces.GetAddress (1), 80));
+
+  Simulator::Stop (Seconds (10));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_received, m_totalBytes, "The whole data should be received");
+  NS_TEST_EXPECT_MSG_EQ (m_errors, 0, "The data should be received in order");
+  NS_TEST_EXPECT_MSG_GT (m_txSuperSegments, 0, "Super-segments should be sent");
+  NS_TEST_EXPECT_MSG_LT (m_txPackets, m_totalBytes / m_segmentSize / 4, "Too many packets sent");
+  NS_TEST_EXPECT_MSG_GT (m_rxCoalesced, 0, "Segments should be coalesced");
+  NS_TEST_EXPECT_MSG_LT (m_rxPackets, m_totalBytes / m_segmentSize / 4, "Too many packets processed");
+  NS_TEST_EXPECT_MSG_GT (m_ipIds.size (), m_totalBytes / m_segmentSize, "Each segment should be sent in its own IP packet");
+  NS_TEST_EXPECT_MSG_EQ (m_duplicateIpIds, 0, "The IP identification of each segment should be unique");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief TCP segmentation offload TestSuite
+ */
+class TcpSegmentationOffloadTestSuite : public TestSuite
+{
+public:
+  TcpSegmentationOffloadTestSuite ();
+};
+
+TcpSegmentationOffloadTestSuite::TcpSegmentationOffloadTestSuite ()
+  : TestSuite ("tcp-segmentation-offload", UNIT)
+{
+  AddTestCase (new TcpSegmenterTestCase (), TestCase::QUICK);
+  AddTestCase (new TcpOffloadTransferTestCase (), TestCase::QUICK);
+}
+
+static TcpSegmentationOffloadTestSuite g_tcpSegmentationOffloadTestSuite; //!< Static variable for test initialization
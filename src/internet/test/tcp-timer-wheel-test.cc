@@ -0,0 +1,269 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include <vector>
+#include <algorithm>
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include "ns3/pointer.h"
+#include "ns3/packet.h"
+#include "ns3/error-model.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/tcp-socket-factory.h"
+#include "ns3/tcp-l4-protocol.h"
+#include "ns3/arp-l3-protocol.h"
+#include "ns3/string.h"
+#include "ns3/timer-wheel.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Error model dropping the packets of given ranks
+ */
+class TcpTimerWheelErrorModel : public ErrorModel
+{
+public:
+  /**
+   * \brief Constructor
+   * \param drops the ranks of the packets to drop, in increasing order
+   */
+  TcpTimerWheelErrorModel (std::vector<uint32_t> drops);
+
+private:
+  virtual bool DoCorrupt (Ptr<Packet> p);
+  virtual void DoReset (void);
+
+  std::vector<uint32_t> m_drops;  //!< Ranks of the packets to drop
+  uint32_t m_rank;                //!< Rank of the next packet
+};
+
+TcpTimerWheelErrorModel::TcpTimerWheelErrorModel (std::vector<uint32_t> drops)
+  : m_drops (drops),
+    m_rank (0)
+{
+}
+
+bool
+TcpTimerWheelErrorModel::DoCorrupt (Ptr<Packet> p)
+{
+  return std::find (m_drops.begin (), m_drops.end (), m_rank++) != m_drops.end ();
+}
+
+void
+TcpTimerWheelErrorModel::DoReset (void)
+{
+  m_rank = 0;
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Bulk transfer with the timers of the sockets in a timer wheel
+ *
+ * The same lossy transfer is run with the timers scheduled in the simulator
+ * and armed in the timer wheel of the nodes. Since the wheel timers expire at
+ * their exact expiration time, the packets must arrive at the same times,
+ * while most of the rearms of the retransmission and delayed ACK timers must
+ * not reach the simulator.
+ */
+class TcpTimerWheelTestCase : public TestCase
+{
+public:
+  TcpTimerWheelTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Run the transfer
+   * \param timerWheel true to arm the timers in the timer wheel
+   * \param arrivals the arrival times of the packets at the receiver
+   */
+  void RunTransfer (bool timerWheel, std::vector<Time> &arrivals);
+  /**
+   * \brief Fill the transmission buffer of the sender
+   * \param socket the sender socket
+   * \param available the space available in the transmission buffer
+   */
+  void Send (Ptr<Socket> socket, uint32_t available);
+  /**
+   * \brief Accept a connection
+   * \param socket the accepted socket
+   * \param from the address of the peer
+   */
+  void Accept (Ptr<Socket> socket, const Address &from);
+  /**
+   * \brief Read the received data
+   * \param socket the receiver socket
+   */
+  void Receive (Ptr<Socket> socket);
+
+  static const uint32_t m_totalBytes = 300000;  //!< Size of the transfer
+  uint32_t m_sent;                              //!< Bytes given to the sender socket
+  uint32_t m_received;                          //!< Bytes read from the receiver socket
+  std::vector<Time> *m_arrivals;                //!< Arrival times of the data at the receiver
+  Ptr<TimerWheel> m_wheel;                      //!< Timer wheel of the sender, if any
+};
+
+TcpTimerWheelTestCase::TcpTimerWheelTestCase ()
+  : TestCase ("Lossy bulk transfer with the timers in a timer wheel"),
+    m_sent (0),
+    m_received (0),
+    m_arrivals (0)
+{
+}
+
+void
+TcpTimerWheelTestCase::Send (Ptr<Socket> socket, uint32_t available)
+{
+  while (m_sent < m_totalBytes && socket->GetTxAvailable () > 0)
+    {
+      uint32_t size = std::min (socket->GetTxAvailable (), m_totalBytes - m_sent);
+      int sent = socket->Send (Create<Packet> (size));
+      if (sent <= 0)
+        {
+          break;
+        }
+      m_sent += sent;
+    }
+  if (m_sent == m_totalBytes)
+    {
+      socket->Close ();
+    }
+}
+
+void
+TcpTimerWheelTestCase::Accept (Ptr<Socket> socket, const Address &from)
+{
+  socket->SetRecvCallback (MakeCallback (&TcpTimerWheelTestCase::Receive, this));
+}
+
+void
+TcpTimerWheelTestCase::Receive (Ptr<Socket> socket)
+{
+  Ptr<Packet> packet;
+  while ((packet = socket->Recv ()))
+    {
+      m_received += packet->GetSize ();
+      m_arrivals->push_back (Simulator::Now ());
+    }
+}
+
+void
+TcpTimerWheelTestCase::RunTransfer (bool timerWheel, std::vector<Time> &arrivals)
+{
+  m_sent = 0;
+  m_received = 0;
+  m_arrivals = &arrivals;
+
+  NodeContainer nodes;
+  nodes.Create (2);
+  SimpleNetDeviceHelper simple;
+  simple.SetChannelAttribute ("Delay", TimeValue (MilliSeconds (5)));
+  simple.SetDeviceAttribute ("DataRate", DataRateValue (DataRate ("10Mbps")));
+  NetDeviceContainer devices = simple.Install (nodes);
+  // drop a few data segments, including a retransmission
+  std::vector<uint32_t> drops;
+  drops.push_back (20);
+  drops.push_back (21);
+  drops.push_back (90);
+  drops.push_back (150);
+  Ptr<TcpTimerWheelErrorModel> errorModel = CreateObject<TcpTimerWheelErrorModel> (drops);
+  devices.Get (1)->SetAttribute ("ReceiveErrorModel", PointerValue (errorModel));
+
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  Ipv4AddressHelper address ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = address.Assign (devices);
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      // the ARP requests are jittered with a random variable, whose stream
+      // differs between the two transfers
+      nodes.Get (i)->GetObject<ArpL3Protocol> ()->SetAttribute ("RequestJitter",
+                                                                StringValue ("ns3::ConstantRandomVariable[Constant=0.0]"));
+      nodes.Get (i)->GetObject<TcpL4Protocol> ()->SetAttribute ("TimerWheel", BooleanValue (timerWheel));
+    }
+  m_wheel = nodes.Get (0)->GetObject<TcpL4Protocol> ()->GetTimerWheel ();
+
+  Ptr<Socket> server = Socket::CreateSocket (nodes.Get (1), TcpSocketFactory::GetTypeId ());
+  server->Bind (InetSocketAddress (Ipv4Address::GetAny (), 80));
+  server->Listen ();
+  server->SetAcceptCallback (MakeNullCallback<bool, Ptr<Socket>, const Address &> (),
+                             MakeCallback (&TcpTimerWheelTestCase::Accept, this));
+
+  Ptr<Socket> client = Socket::CreateSocket (nodes.Get (0), TcpSocketFactory::GetTypeId ());
+  client->SetAttribute ("SegmentSize", UintegerValue (1000));
+  client->SetSendCallback (MakeCallback (&TcpTimerWheelTestCase::Send, this));
+  client->Connect (InetSocketAddress (interfaces.GetAddress (1), 80));
+
+  Simulator::Stop (Seconds (20));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_received, m_totalBytes, "The whole data should be received");
+
+  server = 0;
+  client = 0;
+  Simulator::Destroy ();
+}
+
+void
+TcpTimerWheelTestCase::DoRun (void)
+{
+  std::vector<Time> simulatorArrivals;
+  RunTransfer (false, simulatorArrivals);
+  NS_TEST_EXPECT_MSG_EQ ((m_wheel == 0), true, "The timer wheel should not be created");
+
+  std::vector<Time> wheelArrivals;
+  RunTransfer (true, wheelArrivals);
+  NS_TEST_ASSERT_MSG_NE (m_wheel, 0, "The timer wheel should be created");
+
+  NS_TEST_ASSERT_MSG_EQ (wheelArrivals.size (), simulatorArrivals.size (), "Different number of receptions");
+  for (uint32_t i = 0; i < wheelArrivals.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (wheelArrivals[i], simulatorArrivals[i], "Data received at a different time");
+    }
+
+  // the retransmission timer is rearmed on every new ACK, but expires once
+  // per loss at most (and once in FIN_WAIT_2)
+  NS_TEST_EXPECT_MSG_GT (m_wheel->GetNRemoved (), 100, "The timers should be rearmed in the wheel");
+  NS_TEST_EXPECT_MSG_LT (m_wheel->GetNScheduled (), 10, "Too many timers handed to the simulator");
+  m_wheel = 0;
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief TCP timer wheel TestSuite
+ */
+class TcpTimerWheelTestSuite : public TestSuite
+{
+public:
+  TcpTimerWheelTestSuite () : TestSuite ("tcp-timer-wheel", UNIT)
+  {
+    AddTestCase (new TcpTimerWheelTestCase (), TestCase::QUICK);
+  }
+};
+
+static TcpTimerWheelTestSuite g_tcpTimerWheelTestSuite; //!< Static variable for test initialization
@@ -49,6 +49,8 @@ private:
   void TestTransmittedBlock ();
   /** \brief Test the generation of the "next" block */
   void TestNextSeg ();
+  /** \brief Test the scoreboard of a window with thousands of segments */
+  void TestLargeWindow ();
 };
 
 TcpTxBufferTestCase::TcpTxBufferTestCase ()
@@ -81,6 +83,8 @@ TcpTxBufferTestCase::DoRun ()
                        &TcpTxBufferTestCase::TestTransmittedBlock, this);
   Simulator::Schedule (Seconds (0.0),
                        &TcpTxBufferTestCase::TestNextSeg, this);
+  Simulator::Schedule (Seconds (0.0),
+                       &TcpTxBufferTestCase::TestLargeWindow, this);
 
   Simulator::Run ();
   Simulator::Destroy ();
@@ -267,6 +271,84 @@ TcpTxBufferTestCase::TestNextSeg ()
                          "Data inside the buffer");
 }
 
+void
+TcpTxBufferTestCase::TestLargeWindow ()
+{
+  TcpTxBuffer txBuf;
+  SequenceNumber32 head (1);
+  SequenceNumber32 ret;
+  uint32_t segmentSize = 100;
+  uint32_t segments = 5000;
+  uint32_t lossInterval = 100;
+  txBuf.SetHeadSequence (head);
+  txBuf.SetSegmentSize (segmentSize);
+  txBuf.SetDupAckThresh (3);
+  txBuf.SetMaxBufferSize (segments * segmentSize);
+  txBuf.Add (Create<Packet> (segments * segmentSize));
+
+  for (uint32_t i = 0; i < segments; ++i)
+    {
+      txBuf.CopyFromSequence (segmentSize, head + (segmentSize * i));
+    }
+
+  // One segment out of lossInterval is lost; each of the others is acked by
+  // a SACK block reporting the data received since the last hole
+  Ptr<TcpOptionSack> sack = CreateObject<TcpOptionSack> ();
+  for (uint32_t i = 1; i < segments; ++i)
+    {
+      if (i % lossInterval == 0)
+        {
+          continue;
+        }
+      SequenceNumber32 begin = head + (segmentSize * (i - i % lossInterval + 1));
+      sack->ClearSackList ();
+      sack->AddSackBlock (TcpOptionSack::SackBlock (begin, head + (segmentSize * (i + 1))));
+      txBuf.Update (sack->GetSackList ());
+
+      // A hole is lost when dupThresh segments above it are sacked
+      uint32_t lostHoles = (i - 2) / lossInterval + 1;
+      if (i % lossInterval < 3)
+        {
+          lostHoles = i / lossInterval;
+        }
+      NS_TEST_ASSERT_MSG_EQ (txBuf.GetLost (), lostHoles * segmentSize,
+                             "Unexpected lost bytes after sacking segment " << i);
+    }
+
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetSacked (), (segments - segments / lossInterval) * segmentSize,
+                         "Unexpected sacked bytes");
+  for (uint32_t i = 0; i < segments; i += 7)
+    {
+      NS_TEST_ASSERT_MSG_EQ (txBuf.IsLost (head + (segmentSize * i)), (i % lossInterval == 0),
+                             "Unexpected loss status of segment " << i);
+    }
+
+  // NextSeg returns the holes in order, then nothing as there is no new data
+  for (uint32_t i = 0; i < segments; i += lossInterval)
+    {
+      NS_TEST_ASSERT_MSG_EQ (txBuf.NextSeg (&ret, false), true,
+                             "No NextSeq with lost segments");
+      NS_TEST_ASSERT_MSG_EQ (ret, head + (segmentSize * i),
+                             "Different NextSeq than the lost segment " << i);
+      txBuf.CopyFromSequence (segmentSize, ret);
+    }
+  NS_TEST_ASSERT_MSG_EQ (txBuf.NextSeg (&ret, false), false,
+                         "NextSeq returned with every hole retransmitted");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetRetransmitsCount (), segments / lossInterval * segmentSize,
+                         "Unexpected retransmitted bytes");
+
+  // The holes are filled, one at a time
+  for (uint32_t i = lossInterval; i <= segments; i += lossInterval)
+    {
+      txBuf.DiscardUpTo (head + (segmentSize * i));
+      NS_TEST_ASSERT_MSG_EQ (txBuf.GetLost (), (segments - i) / lossInterval * segmentSize,
+                             "Unexpected lost bytes after the ACK of " << i << " segments");
+      NS_TEST_ASSERT_MSG_EQ (txBuf.GetSacked (), (segments - i) / lossInterval * (lossInterval - 1) * segmentSize,
+                             "Unexpected sacked bytes after the ACK of " << i << " segments");
+    }
+  NS_TEST_ASSERT_MSG_EQ (txBuf.Size (), 0, "Data inside the buffer");
+}
+
 void
 TcpTxBufferTestCase::TestNewBlock ()
 {
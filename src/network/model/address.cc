@@ -232,6 +232,18 @@ bool operator < (const Address &a, const Address &b)
   return false;
 }
 
+size_t AddressHash::operator() (Address const &x) const
+{
+  // FNV-1a over the length and the value of the address
+  size_t hash = 2166136261U;
+  hash = (hash ^ x.m_len) * 16777619U;
+  for (uint8_t i = 0; i < x.m_len; i++)
+    {
+      hash = (hash ^ x.m_data[i]) * 16777619U;
+    }
+  return hash;
+}
+
 std::ostream& operator<< (std::ostream& os, const Address & address)
 {
   os.setf (std::ios::hex, std::ios::basefield);
@@ -270,6 +270,8 @@ private:
    */
   friend std::istream& operator>> (std::istream& is, Address & address);
 
+  friend class AddressHash;
+
   uint8_t m_type; //!< Type of the address
   uint8_t m_len;  //!< Length of the address
   uint8_t m_data[MAX_SIZE]; //!< The address value
@@ -283,6 +285,24 @@ bool operator < (const Address &a, const Address &b);
 std::ostream& operator<< (std::ostream& os, const Address & address);
 std::istream& operator>> (std::istream& is, Address & address);
 
+/**
+ * \ingroup address
+ *
+ * \brief Class providing an hash for addresses
+ *
+ * The type of the address is not hashed, since an address of type zero
+ * is equal to the addresses of any type with the same value.
+ */
+class AddressHash : public std::unary_function<Address, size_t> {
+public:
+  /**
+   * Returns the hash of the address
+   * \param x the address
+   * \return the hash
+   */
+  size_t operator() (Address const &x) const;
+};
+
 
 } // namespace ns3
 
@@ -18,6 +18,7 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 #include "buffer.h"
+#include "packet-census.h"
 #include "ns3/assert.h"
 #include "ns3/log.h"
 
@@ -100,6 +101,7 @@ Buffer::Recycle (struct Buffer::Data *data)
   NS_LOG_FUNCTION (data);
   NS_ASSERT (data->m_count == 0);
   NS_ASSERT (!IS_UNINITIALIZED (g_freeList));
+  PacketCensus::NotifyBufferDataRecycled (data->m_size);
   g_maxSize = std::max (g_maxSize, data->m_size);
   /* feed into free list */
   if (data->m_size < g_maxSize ||
@@ -133,6 +135,7 @@ Buffer::Create (uint32_t dataSize)
           if (data->m_size >= dataSize) 
             {
               data->m_count = 1;
+              PacketCensus::NotifyBufferDataCreated (data->m_size);
               return data;
             }
           Buffer::Deallocate (data);
@@ -140,6 +143,7 @@ Buffer::Create (uint32_t dataSize)
     }
   struct Buffer::Data *data = Buffer::Allocate (dataSize);
   NS_ASSERT (data->m_count == 1);
+  PacketCensus::NotifyBufferDataCreated (data->m_size);
   return data;
 }
 #else /* BUFFER_FREE_LIST */
@@ -148,6 +152,7 @@ Buffer::Recycle (struct Buffer::Data *data)
 {
   NS_LOG_FUNCTION (data);
   NS_ASSERT (data->m_count == 0);
+  PacketCensus::NotifyBufferDataRecycled (data->m_size);
   Deallocate (data);
 }
 
@@ -155,7 +160,9 @@ Buffer::Data *
 Buffer::Create (uint32_t size)
 {
   NS_LOG_FUNCTION (size);
-  return Allocate (size);
+  struct Buffer::Data *data = Allocate (size);
+  PacketCensus::NotifyBufferDataCreated (data->m_size);
+  return data;
 }
 #endif /* BUFFER_FREE_LIST */
 
@@ -19,6 +19,7 @@
  */
 
 #include "ns3/log.h"
+#include "ns3/queue-item.h"
 #include "net-device.h"
 
 namespace ns3 {
@@ -41,4 +42,32 @@ NetDevice::~NetDevice ()
   NS_LOG_FUNCTION (this);
 }
 
+uint32_t
+NetDevice::SendBatch (const std::vector<Ptr<QueueDiscItem> > &items)
+{
+  NS_LOG_FUNCTION (this << items.size ());
+
+  uint32_t nSent = 0;
+  for (auto& item : items)
+    {
+      if (Send (item->GetPacket (), item->GetAddress (), item->GetProtocol ()))
+        {
+          nSent++;
+        }
+    }
+  return nSent;
+}
+
+uint32_t
+NetDevice::GetMaxBatchSize (void) const
+{
+  return 1;
+}
+
+bool
+NetDevice::SupportsSegmentationOffload (void) const
+{
+  return false;
+}
+
 } // namespace ns3
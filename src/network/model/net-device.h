@@ -22,6 +22,7 @@
 #define NET_DEVICE_H
 
 #include <stdint.h>
+#include <vector>
 #include "ns3/callback.h"
 #include "ns3/object.h"
 #include "ns3/ptr.h"
@@ -34,6 +35,7 @@ namespace ns3 {
 
 class Node;
 class Channel;
+class QueueDiscItem;
 
 /**
  * \ingroup network
@@ -359,6 +361,41 @@ public:
    */
   virtual bool SupportsSendFrom (void) const = 0;
 
+  /**
+   * \param items the packets to send, each along with the mac address of its
+   *        destination (already resolved) and its protocol number
+   *
+   * Called from higher layers (e.g., the traffic control layer) to send a
+   * burst of packets into the Network Device at once, similarly to the
+   * xmit_more flag of Linux drivers. The default implementation calls Send
+   * for every packet; devices supporting batches may override this method
+   * to pay the per-transmission costs (e.g., starting the transmitter) once
+   * per batch.
+   *
+   * \return the number of packets successfully sent
+   */
+  virtual uint32_t SendBatch (const std::vector<Ptr<QueueDiscItem> > &items);
+
+  /**
+   * \return the maximum number of packets this device accepts in a single
+   *         call to SendBatch. The default implementation returns 1, i.e.,
+   *         packets are handed to the device one at a time.
+   *
+   * If the device supports flow control, a stopped transmission queue is only
+   * woken up when there is room for this number of packets (or the queue is
+   * empty), so that the upper layers can send a whole batch.
+   */
+  virtual uint32_t GetMaxBatchSize (void) const;
+
+  /**
+   * \return true if this device splits the super-segments (i.e., the packets
+   *         carrying a SegmentationOffloadTag) it is asked to send into
+   *         segments, false otherwise. The default implementation returns
+   *         false, in which case the network layer splits the super-segments
+   *         before handing them to the device.
+   */
+  virtual bool SupportsSegmentationOffload (void) const;
+
 };
 
 } // namespace ns3
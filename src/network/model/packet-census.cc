@@ -0,0 +1,476 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "packet-census.h"
+#include "packet.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/simulator.h"
+#include "ns3/config.h"
+#include "ns3/object.h"
+#include "ns3/output-stream-wrapper.h"
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <unordered_map>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PacketCensus");
+
+bool PacketCensus::m_enabled = false;
+uint64_t PacketCensus::m_bufferBytes = 0;
+
+namespace {
+
+/// Information about a live packet
+struct PacketInfo
+{
+  uint32_t node;          //!< context of the last event that handled the packet
+  const Object *queue;    //!< queue storing the packet, if any
+  TypeId queueType;       //!< type of the queue storing the packet, if any
+  Time created;           //!< creation time
+};
+
+/// Map of the live packets
+typedef std::unordered_map<const Packet *, PacketInfo> PacketMap;
+
+/// Live packets (allocated when the census is enabled, so as not to depend
+/// on the order of destruction of static objects)
+PacketMap *g_packets = 0;
+
+/// Largest number of live packets
+uint32_t g_peak = 0;
+
+/**
+ * \param node a node ID (or a simulation context)
+ * \return the name of the node
+ */
+std::string
+NodeName (uint32_t node)
+{
+  if (node == Simulator::NO_CONTEXT)
+    {
+      return "(no node)";
+    }
+  std::ostringstream oss;
+  oss << "/NodeList/" << node;
+  return oss.str ();
+}
+
+/**
+ * \brief Name the queues that can be found through the attribute system
+ * \param names the map of queues to names (updated)
+ */
+void
+FindQueueNames (std::map<const Object *, std::string> &names)
+{
+  std::vector<std::string> paths;
+  paths.push_back ("/NodeList/*/DeviceList/*/TxQueue");
+  TypeId tid;
+  if (TypeId::LookupByNameFailSafe ("ns3::TrafficControlLayer", &tid))
+    {
+      paths.push_back ("/NodeList/*/$ns3::TrafficControlLayer/RootQueueDiscList/*/InternalQueueList/*");
+      paths.push_back ("/NodeList/*/$ns3::TrafficControlLayer/RootQueueDiscList/*/QueueDiscClassList/*/QueueDisc/InternalQueueList/*");
+    }
+  for (std::vector<std::string>::const_iterator it = paths.begin (); it != paths.end (); it++)
+    {
+      Config::MatchContainer matches = Config::LookupMatches (*it);
+      for (uint32_t i = 0; i < matches.GetN (); i++)
+        {
+          const Object *queue = PeekPointer (matches.Get (i));
+          if (names.find (queue) != names.end ())
+            {
+              std::string path = matches.GetMatchedPath (i);
+              if (!path.empty () && path[path.size () - 1] == '/')
+                {
+                  path.erase (path.size () - 1);
+                }
+              names[queue] = path;
+            }
+        }
+    }
+}
+
+/**
+ * \param a an entry
+ * \param b another entry
+ * \return true if a holds more packets than b
+ */
+bool
+MorePackets (const PacketCensus::Entry &a, const PacketCensus::Entry &b)
+{
+  if (a.nPackets != b.nPackets)
+    {
+      return a.nPackets > b.nPackets;
+    }
+  return a.name < b.name;
+}
+
+/**
+ * \brief Account for a packet in an entry
+ * \param entries the entries
+ * \param name the name of the entry
+ * \param p the packet
+ * \param created the creation time of the packet
+ */
+void
+Account (std::map<std::string, PacketCensus::Entry> &entries, const std::string &name,
+         const Packet *p, Time created)
+{
+  std::map<std::string, PacketCensus::Entry>::iterator it = entries.find (name);
+  if (it == entries.end ())
+    {
+      PacketCensus::Entry entry;
+      entry.name = name;
+      entry.nPackets = 0;
+      entry.nBytes = 0;
+      entry.oldestUid = p->GetUid ();
+      entry.oldestTime = created;
+      it = entries.insert (std::make_pair (name, entry)).first;
+    }
+  it->second.nPackets++;
+  it->second.nBytes += p->GetSize ();
+  if (created < it->second.oldestTime
+      || (created == it->second.oldestTime && p->GetUid () < it->second.oldestUid))
+    {
+      it->second.oldestUid = p->GetUid ();
+      it->second.oldestTime = created;
+    }
+}
+
+/**
+ * \param entries the entries
+ * \param n the maximum number of entries to return
+ * \return the n entries with the largest number of packets
+ */
+std::vector<PacketCensus::Entry>
+Top (const std::map<std::string, PacketCensus::Entry> &entries, uint32_t n)
+{
+  std::vector<PacketCensus::Entry> top;
+  for (std::map<std::string, PacketCensus::Entry>::const_iterator it = entries.begin ();
+       it != entries.end (); it++)
+    {
+      top.push_back (it->second);
+    }
+  std::sort (top.begin (), top.end (), MorePackets);
+  if (top.size () > n)
+    {
+      top.resize (n);
+    }
+  return top;
+}
+
+/**
+ * \brief Print a list of entries
+ * \param os the output stream
+ * \param title the title of the list
+ * \param entries the entries
+ */
+void
+PrintEntries (std::ostream &os, const std::string &title, const std::vector<PacketCensus::Entry> &entries)
+{
+  os << "  " << title << ":" << std::endl;
+  for (std::vector<PacketCensus::Entry>::const_iterator it = entries.begin (); it != entries.end (); it++)
+    {
+      os << "    " << std::setw (8) << it->nPackets << " packets "
+         << std::setw (12) << it->nBytes << " bytes  "
+         << it->name
+         << " (oldest uid " << it->oldestUid
+         << ", age " << (Simulator::Now () - it->oldestTime).GetSeconds () << "s)"
+         << std::endl;
+    }
+}
+
+} // unnamed namespace
+
+void
+PacketCensus::Enable (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  if (g_packets == 0)
+    {
+      g_packets = new PacketMap;
+    }
+  m_enabled = true;
+}
+
+void
+PacketCensus::Disable (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  m_enabled = false;
+  delete g_packets;
+  g_packets = 0;
+  g_peak = 0;
+}
+
+uint32_t
+PacketCensus::GetNPackets (void)
+{
+  return (g_packets != 0 ? g_packets->size () : 0);
+}
+
+uint32_t
+PacketCensus::GetPeakNPackets (void)
+{
+  return g_peak;
+}
+
+uint64_t
+PacketCensus::GetNBytes (void)
+{
+  uint64_t bytes = 0;
+  if (g_packets != 0)
+    {
+      for (PacketMap::const_iterator it = g_packets->begin (); it != g_packets->end (); it++)
+        {
+          bytes += it->first->GetSize ();
+        }
+    }
+  return bytes;
+}
+
+uint64_t
+PacketCensus::GetNBufferBytes (void)
+{
+  return m_bufferBytes;
+}
+
+std::vector<PacketCensus::Entry>
+PacketCensus::GetTopHolders (uint32_t n)
+{
+  NS_LOG_FUNCTION (n);
+  std::map<std::string, Entry> holders;
+  if (g_packets == 0)
+    {
+      return std::vector<Entry> ();
+    }
+
+  // name the queues holding packets, preferably by their configuration path
+  std::map<const Object *, std::string> queueNames;
+  for (PacketMap::const_iterator it = g_packets->begin (); it != g_packets->end (); it++)
+    {
+      if (it->second.queue != 0 && queueNames.find (it->second.queue) == queueNames.end ())
+        {
+          queueNames[it->second.queue] = NodeName (it->second.node) + " "
+            + it->second.queueType.GetName ();
+        }
+    }
+  if (!queueNames.empty ())
+    {
+      FindQueueNames (queueNames);
+    }
+
+  for (PacketMap::const_iterator it = g_packets->begin (); it != g_packets->end (); it++)
+    {
+      std::string name = (it->second.queue != 0 ? queueNames[it->second.queue]
+                                                : NodeName (it->second.node));
+      Account (holders, name, it->first, it->second.created);
+    }
+  return Top (holders, n);
+}
+
+std::vector<PacketCensus::Entry>
+PacketCensus::GetTopOrigins (uint32_t n)
+{
+  NS_LOG_FUNCTION (n);
+  std::map<std::string, Entry> origins;
+  if (g_packets == 0)
+    {
+      return std::vector<Entry> ();
+    }
+
+  for (PacketMap::const_iterator it = g_packets->begin (); it != g_packets->end (); it++)
+    {
+      PacketCensusTag tag;
+      std::string name = "(unknown)";
+      if (it->first->FindFirstMatchingByteTag (tag))
+        {
+          name = NodeName (tag.GetNode ());
+        }
+      Account (origins, name, it->first, it->second.created);
+    }
+  return Top (origins, n);
+}
+
+void
+PacketCensus::Report (std::ostream &os, uint32_t n)
+{
+  NS_LOG_FUNCTION (&os << n);
+  os << "Packet census at " << Simulator::Now ().GetSeconds () << "s: "
+     << GetNPackets () << " packets (peak " << GetPeakNPackets () << "), "
+     << GetNBytes () << " bytes, " << GetNBufferBytes () << " buffer bytes" << std::endl;
+  PrintEntries (os, "top holders", GetTopHolders (n));
+  PrintEntries (os, "top origins", GetTopOrigins (n));
+}
+
+void
+PacketCensus::EnablePeriodicReport (Time interval, Ptr<OutputStreamWrapper> stream, uint32_t n)
+{
+  NS_LOG_FUNCTION (interval << stream << n);
+  NS_ABORT_MSG_UNLESS (interval.IsStrictlyPositive (), "The report interval must be positive");
+  Enable ();
+  Simulator::ScheduleWithContext (Simulator::NO_CONTEXT, interval,
+                                  &PacketCensus::PeriodicReport, interval, stream, n);
+}
+
+void
+PacketCensus::PeriodicReport (Time interval, Ptr<OutputStreamWrapper> stream, uint32_t n)
+{
+  NS_LOG_FUNCTION (interval << stream << n);
+  Report (*stream->GetStream (), n);
+  // do not keep the simulation alive if no other event is scheduled
+  if (!Simulator::IsFinished ())
+    {
+      Simulator::Schedule (interval, &PacketCensus::PeriodicReport, interval, stream, n);
+    }
+}
+
+void
+PacketCensus::NotifyCreate (const Packet *p, bool fresh)
+{
+  NS_ASSERT (g_packets != 0);
+  PacketInfo info;
+  info.node = Simulator::GetContext ();
+  info.queue = 0;
+  info.created = Simulator::Now ();
+  g_packets->insert (std::make_pair (p, info));
+  g_peak = std::max<uint32_t> (g_peak, g_packets->size ());
+
+  if (fresh && p->GetSize () > 0)
+    {
+      PacketCensusTag tag;
+      tag.SetNode (info.node);
+      p->AddByteTag (tag);
+    }
+}
+
+void
+PacketCensus::NotifyDestroy (const Packet *p)
+{
+  if (g_packets != 0)
+    {
+      g_packets->erase (p);
+    }
+}
+
+void
+PacketCensus::NotifyEnqueue (Ptr<const Packet> p, const Object *queue)
+{
+  if (g_packets == 0)
+    {
+      return;
+    }
+  PacketMap::iterator it = g_packets->find (PeekPointer (p));
+  if (it != g_packets->end ())
+    {
+      it->second.node = Simulator::GetContext ();
+      it->second.queue = queue;
+      it->second.queueType = queue->GetInstanceTypeId ();
+    }
+}
+
+void
+PacketCensus::NotifyEnqueue (Ptr<Packet> p, const Object *queue)
+{
+  NotifyEnqueue (Ptr<const Packet> (p), queue);
+}
+
+void
+PacketCensus::NotifyDequeue (Ptr<const Packet> p)
+{
+  if (g_packets == 0)
+    {
+      return;
+    }
+  PacketMap::iterator it = g_packets->find (PeekPointer (p));
+  if (it != g_packets->end ())
+    {
+      it->second.node = Simulator::GetContext ();
+      it->second.queue = 0;
+    }
+}
+
+void
+PacketCensus::NotifyDequeue (Ptr<Packet> p)
+{
+  NotifyDequeue (Ptr<const Packet> (p));
+}
+
+
+NS_OBJECT_ENSURE_REGISTERED (PacketCensusTag);
+
+TypeId
+PacketCensusTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::PacketCensusTag")
+    .SetParent<Tag> ()
+    .SetGroupName ("Network")
+    .AddConstructor<PacketCensusTag> ()
+  ;
+  return tid;
+}
+
+TypeId
+PacketCensusTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+PacketCensusTag::PacketCensusTag ()
+  : m_node (Simulator::NO_CONTEXT)
+{
+}
+
+void
+PacketCensusTag::SetNode (uint32_t node)
+{
+  m_node = node;
+}
+
+uint32_t
+PacketCensusTag::GetNode (void) const
+{
+  return m_node;
+}
+
+uint32_t
+PacketCensusTag::GetSerializedSize (void) const
+{
+  return 4;
+}
+
+void
+PacketCensusTag::Serialize (TagBuffer i) const
+{
+  i.WriteU32 (m_node);
+}
+
+void
+PacketCensusTag::Deserialize (TagBuffer i)
+{
+  m_node = i.ReadU32 ();
+}
+
+void
+PacketCensusTag::Print (std::ostream &os) const
+{
+  os << "node=" << m_node;
+}
+
+} // namespace ns3
@@ -0,0 +1,302 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PACKET_CENSUS_H
+#define PACKET_CENSUS_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "ns3/ptr.h"
+#include "ns3/nstime.h"
+#include "ns3/tag.h"
+
+namespace ns3 {
+
+class Packet;
+class Object;
+class OutputStreamWrapper;
+
+/**
+ * \ingroup packet
+ *
+ * \brief Census of the packets alive in the simulation
+ *
+ * Once enabled (see Enable), the census keeps track of every Packet object
+ * created afterwards until it is destroyed, so as to find out which parts of
+ * a simulation hold packets (and hence memory). Each live packet is
+ * attributed to a holder:
+ *  - the queue (Queue) storing the packet, if any, identified by the path of
+ *    the device attribute pointing to the queue (e.g.,
+ *    /NodeList/1/DeviceList/2/TxQueue) if found, or by the node running the
+ *    event that enqueued the packet and the type of the queue otherwise;
+ *  - the node running the event that created the packet or that removed it
+ *    from the last queue, otherwise (e.g., packets stored by sockets,
+ *    applications or scheduled events).
+ *
+ * Also, each live packet is attributed to the node where its bytes were
+ * originated. To this end, a PacketCensusTag (a byte tag) is added to the
+ * packets created with a non-null size, so that fragments and reassembled
+ * packets carry the origin of their bytes.
+ *
+ * The census reports the number of live packets, their total size and the
+ * number of bytes allocated for the data of packet buffers (Buffer::Data),
+ * which is shared among copies of a packet. A report listing the holders and
+ * the origins with the largest number of packets can be printed at any time
+ * (Report) or periodically (EnablePeriodicReport).
+ *
+ * The census is disabled by default: when disabled, its cost is a test of a
+ * boolean flag at packet construction and destruction and at queue
+ * operations.
+ */
+class PacketCensus
+{
+public:
+  /// Number of packets and bytes attributed to a holder or to an origin
+  struct Entry
+  {
+    std::string name;      //!< name of the holder or of the origin
+    uint32_t nPackets;     //!< number of live packets
+    uint64_t nBytes;       //!< total size of the live packets
+    uint64_t oldestUid;    //!< UID of the oldest live packet
+    Time oldestTime;       //!< creation time of the oldest live packet
+  };
+
+  /**
+   * \brief Enable the census of the packets created from now on
+   */
+  static void Enable (void);
+
+  /**
+   * \brief Disable the census and forget all the tracked packets
+   */
+  static void Disable (void);
+
+  /**
+   * \return true if the census is enabled
+   */
+  static bool IsEnabled (void);
+
+  /**
+   * \return the number of live packets
+   */
+  static uint32_t GetNPackets (void);
+
+  /**
+   * \return the largest number of live packets since the census was enabled
+   */
+  static uint32_t GetPeakNPackets (void);
+
+  /**
+   * \return the total size of the live packets
+   */
+  static uint64_t GetNBytes (void);
+
+  /**
+   * \return the number of bytes allocated for the data of the buffers in use.
+   *         These bytes are counted even if the census is disabled.
+   */
+  static uint64_t GetNBufferBytes (void);
+
+  /**
+   * \param n the maximum number of holders to return
+   * \return the holders of the largest number of live packets, sorted by
+   *         decreasing number of packets
+   */
+  static std::vector<Entry> GetTopHolders (uint32_t n);
+
+  /**
+   * \param n the maximum number of origins to return
+   * \return the nodes that originated the largest number of live packets,
+   *         sorted by decreasing number of packets
+   */
+  static std::vector<Entry> GetTopOrigins (uint32_t n);
+
+  /**
+   * \brief Print a report of the live packets
+   * \param os the output stream
+   * \param n the maximum number of holders and origins to print
+   */
+  static void Report (std::ostream &os, uint32_t n = 10);
+
+  /**
+   * \brief Print a report of the live packets periodically
+   *
+   * Reports are printed as long as other events are scheduled, hence the
+   * periodic report does not keep the simulation alive.
+   *
+   * \param interval the interval between reports
+   * \param stream the output stream
+   * \param n the maximum number of holders and origins to print
+   */
+  static void EnablePeriodicReport (Time interval, Ptr<OutputStreamWrapper> stream, uint32_t n = 10);
+
+  /**
+   * \brief Notify the creation of a packet
+   * \param p the packet
+   * \param fresh true if the packet bytes have been created (rather than
+   *        copied from another packet)
+   */
+  static void NotifyCreate (const Packet *p, bool fresh);
+
+  /**
+   * \brief Notify the destruction of a packet
+   * \param p the packet
+   */
+  static void NotifyDestroy (const Packet *p);
+
+  /**
+   * \brief Notify that a packet has been stored in a queue
+   * \param p the packet
+   * \param queue the queue
+   */
+  static void NotifyEnqueue (Ptr<const Packet> p, const Object *queue);
+
+  /**
+   * \brief Notify that a packet has been stored in a queue
+   * \param p the packet
+   * \param queue the queue
+   */
+  static void NotifyEnqueue (Ptr<Packet> p, const Object *queue);
+
+  /**
+   * \brief Notify that an item (holding a packet) has been stored in a queue
+   * \param item the item
+   * \param queue the queue
+   */
+  template <typename Item>
+  static void NotifyEnqueue (Ptr<Item> item, const Object *queue);
+
+  /**
+   * \brief Notify that a packet has been removed from a queue
+   * \param p the packet
+   */
+  static void NotifyDequeue (Ptr<const Packet> p);
+
+  /**
+   * \brief Notify that a packet has been removed from a queue
+   * \param p the packet
+   */
+  static void NotifyDequeue (Ptr<Packet> p);
+
+  /**
+   * \brief Notify that an item (holding a packet) has been removed from a queue
+   * \param item the item
+   */
+  template <typename Item>
+  static void NotifyDequeue (Ptr<Item> item);
+
+  /**
+   * \brief Notify that buffer data has been put in use
+   * \param size the size of the data
+   */
+  static void NotifyBufferDataCreated (uint32_t size);
+
+  /**
+   * \brief Notify that buffer data is no longer in use
+   * \param size the size of the data
+   */
+  static void NotifyBufferDataRecycled (uint32_t size);
+
+private:
+  /**
+   * \brief Print a periodic report and schedule the next one
+   * \param interval the interval between reports
+   * \param stream the output stream
+   * \param n the maximum number of holders and origins to print
+   */
+  static void PeriodicReport (Time interval, Ptr<OutputStreamWrapper> stream, uint32_t n);
+
+  static bool m_enabled;          //!< whether the census is enabled
+  static uint64_t m_bufferBytes;  //!< bytes of buffer data in use
+};
+
+/**
+ * \ingroup packet
+ *
+ * \brief Byte tag storing the node where the tagged bytes were created
+ */
+class PacketCensusTag : public Tag
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+
+  PacketCensusTag ();
+
+  /**
+   * \param node the ID of the node where the bytes were created
+   */
+  void SetNode (uint32_t node);
+
+  /**
+   * \return the ID of the node where the bytes were created
+   */
+  uint32_t GetNode (void) const;
+
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer i) const;
+  virtual void Deserialize (TagBuffer i);
+  virtual void Print (std::ostream &os) const;
+
+private:
+  uint32_t m_node;   //!< the ID of the node where the bytes were created
+};
+
+
+/**
+ * Implementation of inline methods and templates.
+ */
+
+inline bool
+PacketCensus::IsEnabled (void)
+{
+  return m_enabled;
+}
+
+inline void
+PacketCensus::NotifyBufferDataCreated (uint32_t size)
+{
+  m_bufferBytes += size;
+}
+
+inline void
+PacketCensus::NotifyBufferDataRecycled (uint32_t size)
+{
+  m_bufferBytes -= size;
+}
+
+template <typename Item>
+void
+PacketCensus::NotifyEnqueue (Ptr<Item> item, const Object *queue)
+{
+  NotifyEnqueue (Ptr<const Packet> (item->GetPacket ()), queue);
+}
+
+template <typename Item>
+void
+PacketCensus::NotifyDequeue (Ptr<Item> item)
+{
+  NotifyDequeue (Ptr<const Packet> (item->GetPacket ()));
+}
+
+} // namespace ns3
+
+#endif /* PACKET_CENSUS_H */
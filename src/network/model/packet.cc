@@ -18,6 +18,7 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 #include "packet.h"
+#include "packet-census.h"
 #include "ns3/assert.h"
 #include "ns3/log.h"
 #include "ns3/simulator.h"
@@ -140,6 +141,10 @@ Packet::Packet ()
     m_nixVector (0)
 {
   m_globalUid++;
+  if (PacketCensus::IsEnabled ())
+    {
+      PacketCensus::NotifyCreate (this, true);
+    }
 }
 
 Packet::Packet (const Packet &o)
@@ -150,6 +155,18 @@ Packet::Packet (const Packet &o)
 {
   o.m_nixVector ? m_nixVector = o.m_nixVector->Copy ()
     : m_nixVector = 0;
+  if (PacketCensus::IsEnabled ())
+    {
+      PacketCensus::NotifyCreate (this, false);
+    }
+}
+
+Packet::~Packet ()
+{
+  if (PacketCensus::IsEnabled ())
+    {
+      PacketCensus::NotifyDestroy (this);
+    }
 }
 
 Packet &
@@ -182,6 +199,10 @@ Packet::Packet (uint32_t size)
     m_nixVector (0)
 {
   m_globalUid++;
+  if (PacketCensus::IsEnabled ())
+    {
+      PacketCensus::NotifyCreate (this, true);
+    }
 }
 Packet::Packet (uint8_t const *buffer, uint32_t size, bool magic)
   : m_buffer (0, false),
@@ -192,6 +213,10 @@ Packet::Packet (uint8_t const *buffer, uint32_t size, bool magic)
 {
   NS_ASSERT (magic);
   Deserialize (buffer, size);
+  if (PacketCensus::IsEnabled ())
+    {
+      PacketCensus::NotifyCreate (this, false);
+    }
 }
 
 Packet::Packet (uint8_t const*buffer, uint32_t size)
@@ -211,6 +236,10 @@ Packet::Packet (uint8_t const*buffer, uint32_t size)
   m_buffer.AddAtStart (size);
   Buffer::Iterator i = m_buffer.Begin ();
   i.Write (buffer, size);
+  if (PacketCensus::IsEnabled ())
+    {
+      PacketCensus::NotifyCreate (this, true);
+    }
 }
 
 Packet::Packet (const Buffer &buffer,  const ByteTagList &byteTagList, 
@@ -221,6 +250,10 @@ Packet::Packet (const Buffer &buffer,  const ByteTagList &byteTagList,
     m_metadata (metadata),
     m_nixVector (0)
 {
+  if (PacketCensus::IsEnabled ())
+    {
+      PacketCensus::NotifyCreate (this, false);
+    }
 }
 
 Ptr<Packet>
@@ -825,6 +858,17 @@ Packet::AddByteTag (const Tag &tag) const
                                 GetSize ());
   tag.Serialize (buffer);
 }
+void
+Packet::AddByteTag (const Tag &tag, uint32_t start, uint32_t end) const
+{
+  NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ().GetName () << tag.GetSerializedSize () << start << end);
+  NS_ASSERT_MSG (start <= end && end <= GetSize (), "Invalid byte range");
+  ByteTagList *list = const_cast<ByteTagList *> (&m_byteTagList);
+  TagBuffer buffer = list->Add (tag.GetInstanceTypeId (), tag.GetSerializedSize (),
+                                start,
+                                end);
+  tag.Serialize (buffer);
+}
 ByteTagIterator 
 Packet::GetByteTagIterator (void) const
 {
@@ -242,6 +242,10 @@ public:
    * \param o object to copy
    */
   Packet (const Packet &o);
+  /**
+   * \brief Destructor
+   */
+  ~Packet ();
   /**
    * \brief Basic assignment
    * \param o object to copy
@@ -571,6 +575,17 @@ public:
    * packet).
    */
   void AddByteTag (const Tag &tag) const;
+  /**
+   * \brief Tag the indicated byte range of this packet with a new byte tag.
+   *
+   * \param tag the new tag to add to this packet
+   * \param start the offset of the first byte tagged by this tag
+   * \param end the offset of the first byte not tagged by this tag
+   *
+   * Only the fragments of this packet (see CreateFragment) that include
+   * some of the bytes in the given range carry the tag.
+   */
+  void AddByteTag (const Tag &tag, uint32_t start, uint32_t end) const;
   /**
    * \brief Returns an iterator over the set of byte tags included in this packet
    *
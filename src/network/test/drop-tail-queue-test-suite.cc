@@ -19,6 +19,7 @@
 #include "ns3/test.h"
 #include "ns3/drop-tail-queue.h"
 #include "ns3/string.h"
+#include "ns3/enum.h"
 
 using namespace ns3;
 
@@ -31,12 +32,22 @@ using namespace ns3;
 class DropTailQueueTestCase : public TestCase
 {
 public:
-  DropTailQueueTestCase ();
+  /**
+   * Constructor
+   *
+   * \param container the type of container used by the queue
+   */
+  DropTailQueueTestCase (QueueBase::ContainerType container);
   virtual void DoRun (void);
+
+private:
+  QueueBase::ContainerType m_container; //!< type of container used by the queue
 };
 
-DropTailQueueTestCase::DropTailQueueTestCase ()
-  : TestCase ("Sanity check on the drop tail queue implementation")
+DropTailQueueTestCase::DropTailQueueTestCase (QueueBase::ContainerType container)
+  : TestCase (std::string ("Sanity check on the drop tail queue implementation (")
+              + (container == QueueBase::LIST_CONTAINER ? "list" : "ring buffer") + ")"),
+    m_container (container)
 {
 }
 void
@@ -45,6 +56,8 @@ DropTailQueueTestCase::DoRun (void)
   Ptr<DropTailQueue<Packet> > queue = CreateObject<DropTailQueue<Packet> > ();
   NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("MaxSize", StringValue ("3p")), true,
                          "Verify that we can actually set the attribute");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("Container", EnumValue (m_container)), true,
+                         "Verify that we can actually set the attribute");
 
   Ptr<Packet> p1, p2, p3, p4;
   p1 = Create<Packet> ();
@@ -95,7 +108,8 @@ public:
   DropTailQueueTestSuite ()
     : TestSuite ("drop-tail-queue", UNIT)
   {
-    AddTestCase (new DropTailQueueTestCase (), TestCase::QUICK);
+    AddTestCase (new DropTailQueueTestCase (QueueBase::LIST_CONTAINER), TestCase::QUICK);
+    AddTestCase (new DropTailQueueTestCase (QueueBase::RING_BUFFER_CONTAINER), TestCase::QUICK);
   }
 };
 
@@ -0,0 +1,205 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/packet-census.h"
+#include "ns3/packet.h"
+#include "ns3/node.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/drop-tail-queue.h"
+#include "ns3/simulator.h"
+#include <vector>
+#include <sstream>
+
+using namespace ns3;
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Packet census test: packets are created on two nodes, stored in the
+ * transmission queue of a device and in a local container, and the live
+ * packets attributed to each holder and to each origin are checked.
+ */
+class PacketCensusTestCase : public TestCase
+{
+public:
+  PacketCensusTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Create packets and store them in the queue
+   * \param n the number of packets
+   */
+  void CreateAndEnqueue (uint32_t n);
+  /**
+   * Create packets and store them in the local container
+   * \param n the number of packets
+   */
+  void CreateAndHold (uint32_t n);
+  /**
+   * Dequeue a packet and store it in the local container
+   */
+  void DequeueAndHold (void);
+  /**
+   * Store a fragment of the packet at the head of the queue
+   */
+  void HoldFragment (void);
+  /**
+   * Check the census
+   */
+  void CheckCensus (void);
+
+  Ptr<Queue<Packet> > m_queue;        //!< the transmission queue
+  std::vector<Ptr<Packet> > m_held;   //!< the local container
+  std::string m_queueName;            //!< the expected name of the queue
+  std::string m_node0Name;            //!< the expected name of the first node
+  std::string m_node1Name;            //!< the expected name of the second node
+};
+
+PacketCensusTestCase::PacketCensusTestCase ()
+  : TestCase ("Check the attribution of live packets to holders and origins")
+{
+}
+
+void
+PacketCensusTestCase::CreateAndEnqueue (uint32_t n)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      m_queue->Enqueue (Create<Packet> (100));
+    }
+}
+
+void
+PacketCensusTestCase::CreateAndHold (uint32_t n)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      m_held.push_back (Create<Packet> (200));
+    }
+}
+
+void
+PacketCensusTestCase::DequeueAndHold (void)
+{
+  m_held.push_back (m_queue->Dequeue ());
+}
+
+void
+PacketCensusTestCase::HoldFragment (void)
+{
+  m_held.push_back (m_queue->Peek ()->CreateFragment (0, 50));
+}
+
+void
+PacketCensusTestCase::CheckCensus (void)
+{
+  // node 1: 4 packets in the queue; node 0: 2 packets of 200 bytes, one
+  // packet of 100 bytes dequeued from the queue and one fragment of 50 bytes
+  NS_TEST_EXPECT_MSG_EQ (PacketCensus::GetNPackets (), 8, "Unexpected number of live packets");
+  NS_TEST_EXPECT_MSG_EQ (PacketCensus::GetNBytes (), 4 * 100 + 2 * 200 + 100 + 50,
+                         "Unexpected number of live bytes");
+
+  std::vector<PacketCensus::Entry> holders = PacketCensus::GetTopHolders (10);
+  NS_TEST_ASSERT_MSG_EQ (holders.size (), 2, "Unexpected number of holders");
+  NS_TEST_EXPECT_MSG_EQ (holders[0].name, m_node0Name, "Unexpected top holder");
+  NS_TEST_EXPECT_MSG_EQ (holders[0].nPackets, 4, "Unexpected number of packets");
+  NS_TEST_EXPECT_MSG_EQ (holders[0].nBytes, 2 * 200 + 100 + 50, "Unexpected number of bytes");
+  NS_TEST_EXPECT_MSG_EQ (holders[1].name, m_queueName, "Unexpected second holder");
+  NS_TEST_EXPECT_MSG_EQ (holders[1].nPackets, 4, "Unexpected number of packets");
+  NS_TEST_EXPECT_MSG_EQ (holders[1].nBytes, 4 * 100, "Unexpected number of bytes");
+  NS_TEST_EXPECT_MSG_EQ (holders[1].oldestTime, Seconds (1), "Unexpected age of the oldest packet");
+
+  holders = PacketCensus::GetTopHolders (1);
+  NS_TEST_EXPECT_MSG_EQ (holders.size (), 1, "Unexpected number of holders");
+
+  // the dequeued packet and the fragment were originated by node 1
+  std::vector<PacketCensus::Entry> origins = PacketCensus::GetTopOrigins (10);
+  NS_TEST_ASSERT_MSG_EQ (origins.size (), 2, "Unexpected number of origins");
+  NS_TEST_EXPECT_MSG_EQ (origins[0].name, m_node1Name, "Unexpected top origin");
+  NS_TEST_EXPECT_MSG_EQ (origins[0].nPackets, 6, "Unexpected number of packets");
+  NS_TEST_EXPECT_MSG_EQ (origins[1].name, m_node0Name, "Unexpected second origin");
+  NS_TEST_EXPECT_MSG_EQ (origins[1].nPackets, 2, "Unexpected number of packets");
+
+  std::ostringstream oss;
+  PacketCensus::Report (oss);
+  NS_TEST_EXPECT_MSG_NE (oss.str ().find (m_queueName), std::string::npos,
+                         "The report should list the queue");
+}
+
+void
+PacketCensusTestCase::DoRun (void)
+{
+  PacketCensus::Enable ();
+  NS_TEST_EXPECT_MSG_EQ (PacketCensus::IsEnabled (), true, "The census should be enabled");
+  NS_TEST_EXPECT_MSG_EQ (PacketCensus::GetNPackets (), 0, "No packet should be alive");
+
+  Ptr<Node> n0 = CreateObject<Node> ();
+  Ptr<Node> n1 = CreateObject<Node> ();
+  Ptr<SimpleNetDevice> dev = CreateObject<SimpleNetDevice> ();
+  n1->AddDevice (dev);
+  m_queue = CreateObject<DropTailQueue<Packet> > ();
+  dev->SetQueue (m_queue);
+  std::ostringstream oss;
+  oss << "/NodeList/" << n0->GetId ();
+  m_node0Name = oss.str ();
+  oss.str ("");
+  oss << "/NodeList/" << n1->GetId ();
+  m_node1Name = oss.str ();
+  m_queueName = m_node1Name + "/DeviceList/0/TxQueue";
+
+  Simulator::ScheduleWithContext (n1->GetId (), Seconds (1), &PacketCensusTestCase::CreateAndEnqueue, this, 5);
+  Simulator::ScheduleWithContext (n0->GetId (), Seconds (2), &PacketCensusTestCase::CreateAndHold, this, 2);
+  Simulator::ScheduleWithContext (n0->GetId (), Seconds (3), &PacketCensusTestCase::DequeueAndHold, this);
+  Simulator::ScheduleWithContext (n0->GetId (), Seconds (3), &PacketCensusTestCase::HoldFragment, this);
+  Simulator::Schedule (Seconds (4), &PacketCensusTestCase::CheckCensus, this);
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (PacketCensus::GetPeakNPackets (), 8, "Unexpected peak number of packets");
+  uint64_t bufferBytes = PacketCensus::GetNBufferBytes ();
+
+  m_held.clear ();
+  m_queue->Flush ();
+  NS_TEST_EXPECT_MSG_EQ (PacketCensus::GetNPackets (), 0, "No packet should be alive");
+  NS_TEST_EXPECT_MSG_LT (PacketCensus::GetNBufferBytes (), bufferBytes, "Buffer data should be released");
+
+  m_queue = 0;
+  Simulator::Destroy ();
+  PacketCensus::Disable ();
+  NS_TEST_EXPECT_MSG_EQ (PacketCensus::IsEnabled (), false, "The census should be disabled");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Packet census TestSuite
+ */
+class PacketCensusTestSuite : public TestSuite
+{
+public:
+  PacketCensusTestSuite ();
+};
+
+PacketCensusTestSuite::PacketCensusTestSuite ()
+  : TestSuite ("packet-census", UNIT)
+{
+  AddTestCase (new PacketCensusTestCase (), TestCase::QUICK);
+}
+
+static PacketCensusTestSuite g_packetCensusTestSuite; //!< Static variable for test initialization
@@ -731,6 +731,17 @@ PacketTest::DoRun (void)
     CHECK (tmp, 1, E (25, 0, 50));
   }
 
+  /* Test byte tags on a byte range */
+  {
+    Ptr<Packet> tmp = Create<Packet> (100);
+    tmp->AddByteTag (ATestTag<30> (), 0, 40);
+    tmp->AddByteTag (ATestTag<31> (), 40, 100);
+    CHECK (tmp, 2, E (30, 0, 40), E (31, 40, 100));
+    CHECK (tmp->CreateFragment (0, 40), 1, E (30, 0, 40));
+    CHECK (tmp->CreateFragment (40, 60), 1, E (31, 0, 60));
+    CHECK (tmp->CreateFragment (30, 20), 2, E (30, 0, 10), E (31, 10, 20));
+  }
+
   /* Test ALargeTestTag */
   {
     Ptr<Packet> tmp = Create<Packet> (0);
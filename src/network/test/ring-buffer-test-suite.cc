@@ -0,0 +1,175 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/ring-buffer.h"
+#include <list>
+
+using namespace ns3;
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * RingBuffer unit tests: the content of the ring buffer is compared with
+ * that of a std::list subject to the same sequence of operations.
+ */
+class RingBufferTestCase : public TestCase
+{
+public:
+  RingBufferTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Check that the ring buffer and the list store the same elements
+   * \param ring the ring buffer
+   * \param list the list
+   */
+  void CheckSame (const RingBuffer<uint32_t> &ring, const std::list<uint32_t> &list);
+};
+
+RingBufferTestCase::RingBufferTestCase ()
+  : TestCase ("Check the ring buffer against std::list")
+{
+}
+
+void
+RingBufferTestCase::CheckSame (const RingBuffer<uint32_t> &ring, const std::list<uint32_t> &list)
+{
+  NS_TEST_ASSERT_MSG_EQ (ring.GetSize (), list.size (), "Unexpected number of elements");
+  auto it = list.begin ();
+  for (auto pos = ring.Begin (); pos != ring.End (); pos = ring.Next (pos), it++)
+    {
+      NS_TEST_ASSERT_MSG_EQ ((it != list.end ()), true, "Too many elements");
+      NS_TEST_ASSERT_MSG_EQ (ring.At (pos), *it, "Unexpected element");
+    }
+  NS_TEST_ASSERT_MSG_EQ ((it == list.end ()), true, "Too few elements");
+}
+
+void
+RingBufferTestCase::DoRun (void)
+{
+  RingBuffer<uint32_t> ring;
+  std::list<uint32_t> list;
+
+  NS_TEST_EXPECT_MSG_EQ (ring.IsEmpty (), true, "The ring buffer should be empty");
+  NS_TEST_EXPECT_MSG_EQ (ring.Begin (), ring.End (), "Begin and End should match");
+
+  // Push at both ends, beyond the initial capacity
+  for (uint32_t i = 0; i < 40; i++)
+    {
+      ring.PushBack (i);
+      list.push_back (i);
+      ring.PushFront (1000 + i);
+      list.push_front (1000 + i);
+    }
+  CheckSame (ring, list);
+
+  // Remove every third element, while holding a position to the next one
+  auto pos = ring.Begin ();
+  auto it = list.begin ();
+  uint32_t count = 0;
+  while (pos != ring.End ())
+    {
+      if (count++ % 3 == 0)
+        {
+          auto curr = pos;
+          pos = ring.Next (pos);
+          ring.Erase (curr);
+          it = list.erase (it);
+        }
+      else
+        {
+          pos = ring.Next (pos);
+          it++;
+        }
+    }
+  CheckSame (ring, list);
+
+  // Insert in the middle, both next to a tombstone and not
+  pos = ring.Next (ring.Next (ring.Begin ()));
+  it = std::next (list.begin (), 2);
+  ring.Insert (pos, 5000);
+  list.insert (it, 5000);
+  CheckSame (ring, list);
+
+  pos = ring.Next (ring.Begin ());
+  it = std::next (list.begin (), 1);
+  ring.Insert (pos, 5001);
+  list.insert (it, 5001);
+  CheckSame (ring, list);
+
+  // Removing the last element moves End backwards
+  pos = ring.Begin ();
+  while (ring.Next (pos) != ring.End ())
+    {
+      pos = ring.Next (pos);
+    }
+  ring.Erase (pos);
+  list.pop_back ();
+  CheckSame (ring, list);
+
+  // Interleave pushes and pops to wrap around the storage many times,
+  // with some tombstones left in the middle to exercise compaction
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      ring.PushBack (i);
+      list.push_back (i);
+      if (i % 7 == 0)
+        {
+          ring.PushBack (i);
+          list.push_back (i);
+          pos = ring.Next (ring.Begin ());
+          ring.Erase (pos);
+          list.erase (std::next (list.begin ()));
+        }
+      ring.Erase (ring.Begin ());
+      list.pop_front ();
+    }
+  CheckSame (ring, list);
+
+  while (!ring.IsEmpty ())
+    {
+      ring.Erase (ring.Begin ());
+      list.pop_front ();
+    }
+  CheckSame (ring, list);
+  NS_TEST_EXPECT_MSG_EQ (ring.Begin (), ring.End (), "Begin and End should match");
+
+  ring.PushBack (1);
+  ring.PushBack (2);
+  ring.Clear ();
+  NS_TEST_EXPECT_MSG_EQ (ring.IsEmpty (), true, "The ring buffer should be empty");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief RingBuffer TestSuite
+ */
+class RingBufferTestSuite : public TestSuite
+{
+public:
+  RingBufferTestSuite ()
+    : TestSuite ("ring-buffer", UNIT)
+  {
+    AddTestCase (new RingBufferTestCase (), TestCase::QUICK);
+  }
+};
+
+static RingBufferTestSuite g_ringBufferTestSuite; //!< Static variable for test initialization
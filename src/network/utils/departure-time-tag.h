@@ -0,0 +1,72 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef DEPARTURE_TIME_TAG_H
+#define DEPARTURE_TIME_TAG_H
+
+#include "ns3/tag.h"
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup network
+ *
+ * \brief Packet tag carrying the earliest departure time of a packet
+ *
+ * A sender pacing its packets with the Earliest Departure Time (EDT) model
+ * hands them down the stack as soon as they are generated, tagged with the
+ * time at which they are allowed to leave the node (as the tstamp field of
+ * the Linux sk_buff). A queue disc (e.g., EdtQueueDisc) holds the packets
+ * until their departure time.
+ */
+class DepartureTimeTag : public Tag
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer buf) const;
+  virtual void Deserialize (TagBuffer buf);
+  virtual void Print (std::ostream &os) const;
+  DepartureTimeTag ();
+
+  /**
+   * Constructs a DepartureTimeTag with the given departure time
+   *
+   * \param departure the earliest departure time
+   */
+  DepartureTimeTag (Time departure);
+  /**
+   * Sets the earliest departure time
+   * \param departure the earliest departure time
+   */
+  void SetDepartureTime (Time departure);
+  /**
+   * Gets the earliest departure time
+   * \returns the earliest departure time
+   */
+  Time GetDepartureTime (void) const;
+private:
+  Time m_departure; //!< Earliest departure time
+};
+
+} // namespace ns3
+
+#endif /* DEPARTURE_TIME_TAG_H */
@@ -24,6 +24,7 @@
 #include "ns3/simulator.h"
 #include "ns3/uinteger.h"
 #include "ns3/queue-item.h"
+#include <algorithm>
 
 namespace ns3 {
 
@@ -53,6 +54,29 @@ NetDeviceQueue::IsStopped (void) const
   return m_stoppedByDevice || m_stoppedByQueueLimits;
 }
 
+uint32_t
+NetDeviceQueue::GetBulkLimit (void) const
+{
+  NS_LOG_FUNCTION (this);
+
+  if (IsStopped ())
+    {
+      return 0;
+    }
+
+  // If the device queue is not stopped, there is room for at least one packet
+  uint32_t limit = (m_availableCallback ? std::max<uint32_t> (m_availableCallback (), 1) : 1);
+
+  if (m_queueLimits)
+    {
+      // A packet can be sent as long as the available bytes are not negative
+      NS_ASSERT_MSG (m_device, "Aggregated NetDevice not set");
+      int32_t available = std::max (m_queueLimits->Available (), 0);
+      limit = std::min (limit, available / m_device->GetMtu () + 1u);
+    }
+  return limit;
+}
+
 void
 NetDeviceQueue::Start (void)
 {
@@ -249,7 +273,7 @@ NetDeviceQueueInterface::SetSelectQueueCallback (SelectQueueCallback cb)
   m_selectQueueCallback = cb;
 }
 
-NetDeviceQueueInterface::SelectQueueCallback
+const NetDeviceQueueInterface::SelectQueueCallback&
 NetDeviceQueueInterface::GetSelectQueueCallback (void) const
 {
   return m_selectQueueCallback;
@@ -27,6 +27,7 @@
 #include "ns3/ptr.h"
 #include "ns3/log.h"
 #include "ns3/net-device.h"
+#include "ns3/queue-size.h"
 
 namespace ns3 {
 
@@ -86,6 +87,21 @@ public:
    */
   bool IsStopped (void) const;
 
+  /**
+   * \brief Get the number of packets that can be sent to the device before
+   *        the device transmission queue is stopped.
+   * \return the number of packets (zero if the transmission queue is stopped)
+   *
+   * Called by queue discs to determine how many packets can be dequeued and
+   * handed to the device in a single batch. The room left in the device queue
+   * is computed in terms of MTU-sized packets (provided that the device queue
+   * traces have been connected through ConnectQueueTraces, otherwise a single
+   * packet is allowed) and is further limited by the bytes available according
+   * to the queue limits object, if any.
+   * This is the analogous to the qdisc_avail_bulklimit function of the Linux kernel.
+   */
+  uint32_t GetBulkLimit (void) const;
+
   /**
    * \brief Notify this NetDeviceQueue that the NetDeviceQueueInterface was
    *        aggregated to an object.
@@ -197,11 +213,21 @@ public:
   void ConnectQueueTraces (Ptr<QueueType> queue);
 
 private:
+  /**
+   * \brief Get the number of MTU-sized packets that can be stored in the given queue
+   * \param queue the device queue
+   * \return the number of MTU-sized packets that can be stored in the queue
+   */
+  template <typename QueueType>
+  uint32_t GetNMtuPacketsAvailable (QueueType* queue) const;
+
   bool m_stoppedByDevice;         //!< True if the queue has been stopped by the device
   bool m_stoppedByQueueLimits;    //!< True if the queue has been stopped by a queue limits object
   Ptr<QueueLimits> m_queueLimits; //!< Queue limits object
   WakeCallback m_wakeCallback;    //!< Wake callback
   Ptr<NetDevice> m_device;        //!< the netdevice aggregated to the NetDeviceQueueInterface
+  /// Returns the number of MTU-sized packets that can be stored in the device queue
+  std::function<uint32_t (void)> m_availableCallback;
 
   NS_LOG_TEMPLATE_DECLARE;        //!< redefinition of the log component
 };
@@ -280,7 +306,7 @@ public:
    * Called by the traffic control layer to get the select queue callback set
    * by a multi-queue device.
    */
-  SelectQueueCallback GetSelectQueueCallback (void) const;
+  const SelectQueueCallback& GetSelectQueueCallback (void) const;
 
 protected:
   /**
@@ -308,6 +334,9 @@ NetDeviceQueue::ConnectQueueTraces (Ptr<QueueType> queue)
 {
   NS_ASSERT (queue != 0);
 
+  QueueType* q = PeekPointer (queue);
+  m_availableCallback = [this, q] () { return GetNMtuPacketsAvailable (q); };
+
   queue->TraceConnectWithoutContext ("Enqueue",
                                      MakeCallback (&NetDeviceQueue::PacketEnqueued<QueueType>, this)
                                      .Bind (PeekPointer (queue)));
@@ -319,6 +348,23 @@ NetDeviceQueue::ConnectQueueTraces (Ptr<QueueType> queue)
                                      .Bind (PeekPointer (queue)));
 }
 
+template <typename QueueType>
+uint32_t
+NetDeviceQueue::GetNMtuPacketsAvailable (QueueType* queue) const
+{
+  NS_ASSERT_MSG (m_device, "Aggregated NetDevice not set");
+
+  uint32_t maxSize = queue->GetMaxSize ().GetValue ();
+  uint32_t currentSize = queue->GetCurrentSize ().GetValue ();
+  uint32_t room = (maxSize > currentSize ? maxSize - currentSize : 0);
+
+  if (queue->GetMaxSize ().GetUnit () == QueueSizeUnit::PACKETS)
+    {
+      return room;
+    }
+  return room / m_device->GetMtu ();
+}
+
 template <typename QueueType>
 void
 NetDeviceQueue::PacketEnqueued (QueueType* queue, Ptr<const typename QueueType::ItemType> item)
@@ -328,13 +374,10 @@ NetDeviceQueue::PacketEnqueued (QueueType* queue, Ptr<const typename QueueType::
   // Inform BQL
   NotifyQueuedBytes (item->GetSize ());
 
-  NS_ASSERT_MSG (m_device, "Aggregated NetDevice not set");
-  Ptr<Packet> p = Create<Packet> (m_device->GetMtu ());
-
   // After enqueuing a packet, we need to check whether the queue is able to
-  // store another packet. If not, we stop the queue
+  // store another (MTU-sized) packet. If not, we stop the queue
 
-  if (queue->GetCurrentSize () + p > queue->GetMaxSize ())
+  if (GetNMtuPacketsAvailable (queue) == 0)
     {
       NS_LOG_DEBUG ("The device queue is being stopped (" << queue->GetCurrentSize ()
                     << " inside)");
@@ -351,14 +394,17 @@ NetDeviceQueue::PacketDequeued (QueueType* queue, Ptr<const typename QueueType::
   // Inform BQL
   NotifyTransmittedBytes (item->GetSize ());
 
-  NS_ASSERT_MSG (m_device, "Aggregated NetDevice not set");
-  Ptr<Packet> p = Create<Packet> (m_device->GetMtu ());
+  // After dequeuing a packet, if there is room for another (MTU-sized) packet
+  // we call Wake () that ensures that the queue is not stopped and restarts
+  // the queue disc if the queue was stopped. If the device accepts batches of
+  // packets, we wait until there is room for a whole batch (or the queue is
+  // empty), as Linux drivers do by means of a wake threshold, so that the
+  // queue disc can send a burst of packets when it is restarted
 
-  // After dequeuing a packet, if there is room for another packet we
-  // call Wake () that ensures that the queue is not stopped and restarts
-  // the queue disc if the queue was stopped
+  uint32_t available = GetNMtuPacketsAvailable (queue);
 
-  if (queue->GetCurrentSize () + p <= queue->GetMaxSize ())
+  if (available > 0 && (available >= m_device->GetMaxBatchSize ()
+                        || queue->GetCurrentSize ().GetValue () == 0))
     {
       Wake ();
     }
@@ -42,6 +42,15 @@ QueueBase::GetTypeId (void)
                    MakeQueueSizeAccessor (&QueueBase::SetMaxSize,
                                           &QueueBase::GetMaxSize),
                    MakeQueueSizeChecker ())
+    .AddAttribute ("Container",
+                   "The type of container used to store the items. The ring buffer "
+                   "stores the items contiguously and avoids a memory allocation "
+                   "per enqueued item. It can only be changed while the queue is empty.",
+                   EnumValue (LIST_CONTAINER),
+                   MakeEnumAccessor (&QueueBase::SetContainerType,
+                                     &QueueBase::GetContainerType),
+                   MakeEnumChecker (LIST_CONTAINER, "List",
+                                    RING_BUFFER_CONTAINER, "RingBuffer"))
     .AddTraceSource ("PacketsInQueue",
                      "Number of packets currently stored in the queue",
                      MakeTraceSourceAccessor (&QueueBase::m_nPackets),
@@ -64,7 +73,8 @@ QueueBase::QueueBase () :
   m_nTotalDroppedBytesAfterDequeue (0),
   m_nTotalDroppedPackets (0),
   m_nTotalDroppedPacketsBeforeEnqueue (0),
-  m_nTotalDroppedPacketsAfterDequeue (0)
+  m_nTotalDroppedPacketsAfterDequeue (0),
+  m_containerType (LIST_CONTAINER)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -225,4 +235,21 @@ QueueBase::GetMaxSize (void) const
   return m_maxSize;
 }
 
+void
+QueueBase::SetContainerType (ContainerType type)
+{
+  NS_LOG_FUNCTION (this << type);
+
+  NS_ABORT_MSG_IF (m_nPackets.Get () > 0 && type != m_containerType,
+                   "The container type cannot be changed while the queue is not empty");
+  m_containerType = type;
+}
+
+QueueBase::ContainerType
+QueueBase::GetContainerType (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_containerType;
+}
+
 } // namespace ns3
@@ -31,6 +31,8 @@
 #include "ns3/log.h"
 #include "ns3/queue-size.h"
 #include "ns3/queue-item.h"
+#include "ns3/ring-buffer.h"
+#include "ns3/packet-census.h"
 #include <string>
 #include <sstream>
 #include <list>
@@ -58,6 +60,15 @@ public:
    */
   static TypeId GetTypeId (void);
 
+  /**
+   * \brief Enumeration of the containers that can be used to store the items
+   */
+  enum ContainerType
+  {
+    LIST_CONTAINER,            /**< std::list, one node allocated per item */
+    RING_BUFFER_CONTAINER      /**< contiguous ring buffer (see RingBuffer) */
+  };
+
   QueueBase ();
   virtual ~QueueBase ();
 
@@ -179,6 +190,20 @@ public:
    */
   QueueSize GetMaxSize (void) const;
 
+  /**
+   * \brief Set the type of container used to store the items
+   *
+   * The container type can only be changed while the queue is empty.
+   *
+   * \param type the container type
+   */
+  void SetContainerType (ContainerType type);
+
+  /**
+   * \return the type of container used to store the items
+   */
+  ContainerType GetContainerType (void) const;
+
 #if 0
   // average calculation requires keeping around
   // a buffer with the date of arrival of past received packets
@@ -216,6 +241,7 @@ private:
   uint32_t m_nTotalDroppedPacketsAfterDequeue;  //!< Total dropped packets after dequeue
 
   QueueSize m_maxSize;                //!< max queue size
+  ContainerType m_containerType;      //!< type of container storing the items
 
   /// Friend class
   template <typename Item>
@@ -300,8 +326,57 @@ public:
 
 protected:
 
-  /// Const iterator.
-  typedef typename std::list<Ptr<Item> >::const_iterator ConstIterator;
+  /**
+   * \brief Const iterator.
+   *
+   * Iterates over the items stored in either the list container or the
+   * ring buffer container, depending on the container type of the queue.
+   * In both cases, an iterator remains valid after the removal of other items.
+   */
+  class ConstIterator
+  {
+  public:
+    ConstIterator ();
+    /**
+     * \return a reference to the item
+     */
+    const Ptr<Item>& operator* (void) const;
+    /**
+     * \return a pointer to the item
+     */
+    const Ptr<Item>* operator-> (void) const;
+    /**
+     * \return this iterator, advanced to the next item
+     */
+    ConstIterator& operator++ (void);
+    /**
+     * \return a copy of this iterator, which is then advanced to the next item
+     */
+    ConstIterator operator++ (int);
+    /**
+     * \param o the iterator to compare with
+     * \return true if the two iterators refer to the same item
+     */
+    bool operator== (const ConstIterator &o) const;
+    /**
+     * \param o the iterator to compare with
+     * \return true if the two iterators refer to different items
+     */
+    bool operator!= (const ConstIterator &o) const;
+
+  private:
+    friend class Queue<Item>;
+    /**
+     * \return the position of the item in the ring buffer, or the End ()
+     *         position of the ring buffer if the item has been removed from
+     *         the tail of the ring buffer
+     */
+    typename RingBuffer<Ptr<Item> >::Position GetPosition (void) const;
+
+    typename std::list<Ptr<Item> >::const_iterator m_listIt;  //!< list iterator
+    const RingBuffer<Ptr<Item> > *m_ring;                     //!< ring buffer (0 if list)
+    typename RingBuffer<Ptr<Item> >::Position m_pos;          //!< ring buffer position
+  };
 
   /**
    * \brief Get a const iterator which refers to the first item in the queue.
@@ -385,7 +460,15 @@ protected:
   void DropAfterDequeue (Ptr<Item> item);
 
 private:
-  std::list<Ptr<Item> > m_packets;          //!< the items in the queue
+  /**
+   * Remove the item at the given position from the container in use
+   * \param pos the position of the item to remove
+   * \return the item.
+   */
+  Ptr<Item> Erase (ConstIterator pos);
+
+  std::list<Ptr<Item> > m_packets;          //!< the items in the queue (list container)
+  RingBuffer<Ptr<Item> > m_ring;            //!< the items in the queue (ring buffer container)
   NS_LOG_TEMPLATE_DECLARE;                  //!< the log component
 
   /// Traced callback: fired when a packet is enqueued
@@ -443,6 +526,82 @@ Queue<Item>::~Queue ()
 {
 }
 
+template <typename Item>
+Queue<Item>::ConstIterator::ConstIterator ()
+  : m_ring (0),
+    m_pos (0)
+{
+}
+
+template <typename Item>
+typename RingBuffer<Ptr<Item> >::Position
+Queue<Item>::ConstIterator::GetPosition (void) const
+{
+  return (m_pos < m_ring->End () ? m_pos : m_ring->End ());
+}
+
+template <typename Item>
+const Ptr<Item>&
+Queue<Item>::ConstIterator::operator* (void) const
+{
+  if (m_ring != 0)
+    {
+      return m_ring->At (m_pos);
+    }
+  return *m_listIt;
+}
+
+template <typename Item>
+const Ptr<Item>*
+Queue<Item>::ConstIterator::operator-> (void) const
+{
+  return &(**this);
+}
+
+template <typename Item>
+typename Queue<Item>::ConstIterator&
+Queue<Item>::ConstIterator::operator++ (void)
+{
+  if (m_ring != 0)
+    {
+      m_pos = m_ring->Next (m_pos);
+    }
+  else
+    {
+      ++m_listIt;
+    }
+  return *this;
+}
+
+template <typename Item>
+typename Queue<Item>::ConstIterator
+Queue<Item>::ConstIterator::operator++ (int)
+{
+  ConstIterator tmp = *this;
+  ++(*this);
+  return tmp;
+}
+
+template <typename Item>
+bool
+Queue<Item>::ConstIterator::operator== (const ConstIterator &o) const
+{
+  if (m_ring != 0)
+    {
+      // the tail of the ring buffer moves backwards when trailing items are
+      // removed, hence positions past the end all refer to the end
+      return m_ring == o.m_ring && GetPosition () == o.GetPosition ();
+    }
+  return o.m_ring == 0 && m_listIt == o.m_listIt;
+}
+
+template <typename Item>
+bool
+Queue<Item>::ConstIterator::operator!= (const ConstIterator &o) const
+{
+  return !(*this == o);
+}
+
 template <typename Item>
 bool
 Queue<Item>::DoEnqueue (ConstIterator pos, Ptr<Item> item)
@@ -456,7 +615,14 @@ Queue<Item>::DoEnqueue (ConstIterator pos, Ptr<Item> item)
       return false;
     }
 
-  m_packets.insert (pos, item);
+  if (m_containerType == RING_BUFFER_CONTAINER)
+    {
+      m_ring.Insert (pos.GetPosition (), item);
+    }
+  else
+    {
+      m_packets.insert (pos.m_listIt, item);
+    }
 
   uint32_t size = item->GetSize ();
   m_nBytes += size;
@@ -465,6 +631,11 @@ Queue<Item>::DoEnqueue (ConstIterator pos, Ptr<Item> item)
   m_nPackets++;
   m_nTotalReceivedPackets++;
 
+  if (PacketCensus::IsEnabled ())
+    {
+      PacketCensus::NotifyEnqueue (item, this);
+    }
+
   NS_LOG_LOGIC ("m_traceEnqueue (p)");
   m_traceEnqueue (item);
 
@@ -483,8 +654,7 @@ Queue<Item>::DoDequeue (ConstIterator pos)
       return 0;
     }
 
-  Ptr<Item> item = *pos;
-  m_packets.erase (pos);
+  Ptr<Item> item = Erase (pos);
 
   if (item != 0)
     {
@@ -494,6 +664,11 @@ Queue<Item>::DoDequeue (ConstIterator pos)
       m_nBytes -= item->GetSize ();
       m_nPackets--;
 
+      if (PacketCensus::IsEnabled ())
+        {
+          PacketCensus::NotifyDequeue (item);
+        }
+
       NS_LOG_LOGIC ("m_traceDequeue (p)");
       m_traceDequeue (item);
     }
@@ -512,8 +687,7 @@ Queue<Item>::DoRemove (ConstIterator pos)
       return 0;
     }
 
-  Ptr<Item> item = *pos;
-  m_packets.erase (pos);
+  Ptr<Item> item = Erase (pos);
 
   if (item != 0)
     {
@@ -523,6 +697,11 @@ Queue<Item>::DoRemove (ConstIterator pos)
       m_nBytes -= item->GetSize ();
       m_nPackets--;
 
+      if (PacketCensus::IsEnabled ())
+        {
+          PacketCensus::NotifyDequeue (item);
+        }
+
       // packets are first dequeued and then dropped
       NS_LOG_LOGIC ("m_traceDequeue (p)");
       m_traceDequeue (item);
@@ -532,6 +711,22 @@ Queue<Item>::DoRemove (ConstIterator pos)
   return item;
 }
 
+template <typename Item>
+Ptr<Item>
+Queue<Item>::Erase (ConstIterator pos)
+{
+  Ptr<Item> item = *pos;
+  if (m_containerType == RING_BUFFER_CONTAINER)
+    {
+      m_ring.Erase (pos.m_pos);
+    }
+  else
+    {
+      m_packets.erase (pos.m_listIt);
+    }
+  return item;
+}
+
 template <typename Item>
 void
 Queue<Item>::Flush (void)
@@ -561,13 +756,33 @@ Queue<Item>::DoPeek (ConstIterator pos) const
 template <typename Item>
 typename Queue<Item>::ConstIterator Queue<Item>::Head (void) const
 {
-  return m_packets.cbegin ();
+  ConstIterator it;
+  if (m_containerType == RING_BUFFER_CONTAINER)
+    {
+      it.m_ring = &m_ring;
+      it.m_pos = m_ring.Begin ();
+    }
+  else
+    {
+      it.m_listIt = m_packets.cbegin ();
+    }
+  return it;
 }
 
 template <typename Item>
 typename Queue<Item>::ConstIterator Queue<Item>::Tail (void) const
 {
-  return m_packets.cend ();
+  ConstIterator it;
+  if (m_containerType == RING_BUFFER_CONTAINER)
+    {
+      it.m_ring = &m_ring;
+      it.m_pos = m_ring.End ();
+    }
+  else
+    {
+      it.m_listIt = m_packets.cend ();
+    }
+  return it;
 }
 
 template <typename Item>
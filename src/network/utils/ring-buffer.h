@@ -0,0 +1,374 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include "ns3/assert.h"
+#include <vector>
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * \ingroup queue
+ *
+ * \brief Contiguous double-ended container with O(1) removal at any position
+ *
+ * Elements are stored in a power-of-two sized circular array and are
+ * addressed through logical positions (signed 64-bit indices) which are
+ * not affected by insertions or removals at either end. Removing an element
+ * which is neither the first nor the last one leaves a tombstone in its
+ * slot, so that the positions of all the other elements are preserved;
+ * tombstones are skipped by Next () and are trimmed as soon as they reach
+ * either end of the buffer. Tombstones in the middle of the buffer are
+ * reclaimed when the storage needs to grow.
+ *
+ * Positions remain valid across removals of other elements. As with
+ * std::deque, insertions may invalidate all positions.
+ */
+template <typename T>
+class RingBuffer
+{
+public:
+  /// Logical position of an element
+  typedef int64_t Position;
+
+  RingBuffer ();
+
+  /**
+   * \return the number of (live) elements stored in the buffer
+   */
+  uint32_t GetSize (void) const;
+
+  /**
+   * \return true if no element is stored in the buffer
+   */
+  bool IsEmpty (void) const;
+
+  /**
+   * \return the position of the first element (equal to End () if empty)
+   */
+  Position Begin (void) const;
+
+  /**
+   * \return the position past the last element
+   */
+  Position End (void) const;
+
+  /**
+   * \param pos a position
+   * \return the position of the first element following pos, or End ()
+   */
+  Position Next (Position pos) const;
+
+  /**
+   * \param pos the position of an element
+   * \return a reference to the element
+   */
+  const T& At (Position pos) const;
+
+  /**
+   * \param value the element to append
+   */
+  void PushBack (const T &value);
+
+  /**
+   * \param value the element to prepend
+   */
+  void PushFront (const T &value);
+
+  /**
+   * Insert an element before the given position. Insertions at either end
+   * and insertions next to a tombstone take constant time; otherwise, the
+   * elements following pos are shifted by one slot.
+   *
+   * \param pos the position before which the element is inserted
+   * \param value the element to insert
+   * \return the position of the inserted element
+   */
+  Position Insert (Position pos, const T &value);
+
+  /**
+   * Remove the element at the given position in constant (amortized) time.
+   *
+   * \param pos the position of the element to remove
+   */
+  void Erase (Position pos);
+
+  /**
+   * Remove all the elements.
+   */
+  void Clear (void);
+
+private:
+  /// A slot of the circular array
+  struct Slot
+  {
+    T value;          //!< the stored element
+    bool live;        //!< false if the slot is empty or holds a tombstone
+  };
+
+  /**
+   * \param pos a logical position
+   * \return the slot associated with the given position
+   */
+  Slot& GetSlot (Position pos);
+  /**
+   * \param pos a logical position
+   * \return the slot associated with the given position
+   */
+  const Slot& GetSlot (Position pos) const;
+  /**
+   * Make room for at least one more element, either by doubling the storage
+   * or by compacting tombstones away.
+   */
+  void Reserve (void);
+  /**
+   * Drop the tombstones found at the head and at the tail of the buffer.
+   */
+  void Trim (void);
+
+  std::vector<Slot> m_slots;   //!< circular array (size is a power of two)
+  Position m_begin;            //!< logical position of the first slot in use
+  Position m_end;              //!< logical position past the last slot in use
+  uint32_t m_nElements;        //!< number of live elements
+};
+
+
+/**
+ * Implementation of the templates declared above.
+ */
+
+template <typename T>
+RingBuffer<T>::RingBuffer ()
+  : m_slots (16),
+    m_begin (0),
+    m_end (0),
+    m_nElements (0)
+{
+}
+
+template <typename T>
+uint32_t
+RingBuffer<T>::GetSize (void) const
+{
+  return m_nElements;
+}
+
+template <typename T>
+bool
+RingBuffer<T>::IsEmpty (void) const
+{
+  return m_nElements == 0;
+}
+
+template <typename T>
+typename RingBuffer<T>::Position
+RingBuffer<T>::Begin (void) const
+{
+  return m_begin;
+}
+
+template <typename T>
+typename RingBuffer<T>::Position
+RingBuffer<T>::End (void) const
+{
+  return m_end;
+}
+
+template <typename T>
+typename RingBuffer<T>::Slot&
+RingBuffer<T>::GetSlot (Position pos)
+{
+  return m_slots[static_cast<uint64_t> (pos) & (m_slots.size () - 1)];
+}
+
+template <typename T>
+const typename RingBuffer<T>::Slot&
+RingBuffer<T>::GetSlot (Position pos) const
+{
+  return m_slots[static_cast<uint64_t> (pos) & (m_slots.size () - 1)];
+}
+
+template <typename T>
+typename RingBuffer<T>::Position
+RingBuffer<T>::Next (Position pos) const
+{
+  do
+    {
+      pos++;
+    }
+  while (pos < m_end && !GetSlot (pos).live);
+
+  return (pos < m_end ? pos : m_end);
+}
+
+template <typename T>
+const T&
+RingBuffer<T>::At (Position pos) const
+{
+  NS_ASSERT (pos >= m_begin && pos < m_end && GetSlot (pos).live);
+  return GetSlot (pos).value;
+}
+
+template <typename T>
+void
+RingBuffer<T>::Reserve (void)
+{
+  uint64_t used = m_end - m_begin;
+  if (used < m_slots.size ())
+    {
+      return;
+    }
+
+  // Reclaim the tombstones if they occupy at least half of the storage,
+  // otherwise double the storage
+  std::vector<Slot> slots (m_nElements <= used / 2 ? m_slots.size () : 2 * m_slots.size ());
+  Position pos = m_begin;
+  for (Position i = m_begin; i < m_end; i++)
+    {
+      Slot &slot = GetSlot (i);
+      if (slot.live)
+        {
+          Slot &dst = slots[static_cast<uint64_t> (pos) & (slots.size () - 1)];
+          dst.value = slot.value;
+          dst.live = true;
+          pos++;
+        }
+    }
+  m_slots.swap (slots);
+  m_end = pos;
+}
+
+template <typename T>
+void
+RingBuffer<T>::PushBack (const T &value)
+{
+  Reserve ();
+  Slot &slot = GetSlot (m_end++);
+  slot.value = value;
+  slot.live = true;
+  m_nElements++;
+}
+
+template <typename T>
+void
+RingBuffer<T>::PushFront (const T &value)
+{
+  Reserve ();
+  Slot &slot = GetSlot (--m_begin);
+  slot.value = value;
+  slot.live = true;
+  m_nElements++;
+}
+
+template <typename T>
+typename RingBuffer<T>::Position
+RingBuffer<T>::Insert (Position pos, const T &value)
+{
+  NS_ASSERT (pos >= m_begin && pos <= m_end);
+
+  if (pos == m_end)
+    {
+      PushBack (value);
+      return m_end - 1;
+    }
+  if (pos == m_begin)
+    {
+      PushFront (value);
+      return m_begin;
+    }
+  if (!GetSlot (pos - 1).live)
+    {
+      // reuse the tombstone preceding pos
+      Slot &slot = GetSlot (pos - 1);
+      slot.value = value;
+      slot.live = true;
+      m_nElements++;
+      return pos - 1;
+    }
+
+  // Reserve () may compact the buffer, hence count the live elements
+  // preceding pos to find the insertion point again
+  uint32_t rank = 0;
+  for (Position i = m_begin; i < pos; i++)
+    {
+      rank += (GetSlot (i).live ? 1 : 0);
+    }
+  Reserve ();
+  pos = m_begin;
+  for (; rank > 0; pos++)
+    {
+      rank -= (GetSlot (pos).live ? 1 : 0);
+    }
+  // shift the elements following pos by one slot
+  for (Position i = m_end; i > pos; i--)
+    {
+      GetSlot (i) = GetSlot (i - 1);
+    }
+  m_end++;
+  Slot &slot = GetSlot (pos);
+  slot.value = value;
+  slot.live = true;
+  m_nElements++;
+  return pos;
+}
+
+template <typename T>
+void
+RingBuffer<T>::Trim (void)
+{
+  while (m_begin < m_end && !GetSlot (m_begin).live)
+    {
+      m_begin++;
+    }
+  while (m_end > m_begin && !GetSlot (m_end - 1).live)
+    {
+      m_end--;
+    }
+}
+
+template <typename T>
+void
+RingBuffer<T>::Erase (Position pos)
+{
+  NS_ASSERT (pos >= m_begin && pos < m_end && GetSlot (pos).live);
+
+  Slot &slot = GetSlot (pos);
+  slot.value = T ();
+  slot.live = false;
+  m_nElements--;
+  Trim ();
+}
+
+template <typename T>
+void
+RingBuffer<T>::Clear (void)
+{
+  for (Position i = m_begin; i < m_end; i++)
+    {
+      Slot &slot = GetSlot (i);
+      slot.value = T ();
+      slot.live = false;
+    }
+  m_begin = m_end = 0;
+  m_nElements = 0;
+}
+
+} // namespace ns3
+
+#endif /* RING_BUFFER_H */
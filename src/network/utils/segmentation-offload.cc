@@ -0,0 +1,147 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include <algorithm>
+#include <map>
+#include "segmentation-offload.h"
+#include "ns3/packet.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SegmentationOffload");
+
+NS_OBJECT_ENSURE_REGISTERED (SegmentationOffloadTag);
+
+TypeId
+SegmentationOffloadTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::SegmentationOffloadTag")
+    .SetParent<Tag> ()
+    .SetGroupName ("Network")
+    .AddConstructor<SegmentationOffloadTag> ()
+  ;
+  return tid;
+}
+TypeId
+SegmentationOffloadTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+uint32_t
+SegmentationOffloadTag::GetSerializedSize (void) const
+{
+  return 2;
+}
+void
+SegmentationOffloadTag::Serialize (TagBuffer buf) const
+{
+  buf.WriteU16 (m_segmentSize);
+}
+void
+SegmentationOffloadTag::Deserialize (TagBuffer buf)
+{
+  m_segmentSize = buf.ReadU16 ();
+}
+void
+SegmentationOffloadTag::Print (std::ostream &os) const
+{
+  os << "SegmentSize=" << m_segmentSize;
+}
+SegmentationOffloadTag::SegmentationOffloadTag ()
+  : Tag (),
+    m_segmentSize (0)
+{
+}
+
+SegmentationOffloadTag::SegmentationOffloadTag (uint16_t segmentSize)
+  : Tag (),
+    m_segmentSize (segmentSize)
+{
+}
+
+void
+SegmentationOffloadTag::SetSegmentSize (uint16_t segmentSize)
+{
+  m_segmentSize = segmentSize;
+}
+uint16_t
+SegmentationOffloadTag::GetSegmentSize (void) const
+{
+  return m_segmentSize;
+}
+
+/**
+ * \brief Get the registered segmenters
+ * \returns the segmenters, indexed by layer 3 protocol number
+ */
+static std::map<uint16_t, SegmentationOffload::Segmenter> &
+GetSegmenters (void)
+{
+  static std::map<uint16_t, SegmentationOffload::Segmenter> segmenters;
+  return segmenters;
+}
+
+void
+SegmentationOffload::Register (uint16_t protocol, Segmenter segmenter)
+{
+  NS_LOG_FUNCTION (protocol);
+  GetSegmenters ()[protocol] = segmenter;
+}
+
+bool
+SegmentationOffload::IsSuperSegment (Ptr<const Packet> packet)
+{
+  SegmentationOffloadTag tag;
+  return packet->PeekPacketTag (tag);
+}
+
+uint16_t
+SegmentationOffload::GetNSegments (Ptr<const Packet> packet)
+{
+  SegmentationOffloadTag tag;
+  if (!packet->PeekPacketTag (tag) || tag.GetSegmentSize () == 0)
+    {
+      return 1;
+    }
+  return std::max<uint32_t> ((packet->GetSize () + tag.GetSegmentSize () - 1) / tag.GetSegmentSize (), 1);
+}
+
+bool
+SegmentationOffload::Segment (Ptr<const Packet> packet, uint16_t protocol, std::vector<Ptr<Packet> > &segments)
+{
+  NS_LOG_FUNCTION (packet << protocol);
+  SegmentationOffloadTag tag;
+  if (!packet->PeekPacketTag (tag) || tag.GetSegmentSize () == 0)
+    {
+      return false;
+    }
+  std::map<uint16_t, Segmenter>::const_iterator it = GetSegmenters ().find (protocol);
+  if (it == GetSegmenters ().end ())
+    {
+      NS_LOG_LOGIC ("No segmenter registered for protocol " << protocol);
+      return false;
+    }
+  Ptr<Packet> copy = packet->Copy ();
+  copy->RemovePacketTag (tag);
+  if (!it->second (copy, tag.GetSegmentSize (), segments))
+    {
+      return false;
+    }
+  NS_LOG_LOGIC ("Split " << packet->GetSize () << " bytes into " << segments.size () << " segments");
+  return true;
+}
+
+} // namespace ns3
@@ -0,0 +1,141 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef SEGMENTATION_OFFLOAD_H
+#define SEGMENTATION_OFFLOAD_H
+
+#include <vector>
+#include "ns3/tag.h"
+#include "ns3/callback.h"
+#include "ns3/ptr.h"
+
+namespace ns3 {
+
+class Packet;
+
+/**
+ * \ingroup network
+ *
+ * \brief Packet tag marking a super-segment to be split by the device
+ *
+ * A transport protocol emulating segmentation offload (TSO/GSO) hands
+ * packets larger than the MTU down the stack, tagged with the size of the
+ * segments they are made of. The network layer does not fragment such
+ * packets, and the devices split them into segments (see
+ * SegmentationOffload) only when they are serialized on the wire.
+ */
+class SegmentationOffloadTag : public Tag
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer buf) const;
+  virtual void Deserialize (TagBuffer buf);
+  virtual void Print (std::ostream &os) const;
+  SegmentationOffloadTag ();
+
+  /**
+   * Constructs a SegmentationOffloadTag with the given segment size
+   *
+   * \param segmentSize the size of the payload of each segment
+   */
+  SegmentationOffloadTag (uint16_t segmentSize);
+  /**
+   * Sets the segment size
+   * \param segmentSize the size of the payload of each segment
+   */
+  void SetSegmentSize (uint16_t segmentSize);
+  /**
+   * Gets the segment size
+   * \returns the size of the payload of each segment
+   */
+  uint16_t GetSegmentSize (void) const;
+private:
+  uint16_t m_segmentSize; //!< Size of the payload of each segment
+};
+
+/**
+ * \ingroup network
+ *
+ * \brief Split super-segments into the segments they are made of
+ *
+ * The devices do not know the format of the headers of the upper layers,
+ * hence the protocols able to produce super-segments register a segmenter
+ * for the layer 3 protocol number (e.g., 0x0800 for IPv4) of the packets
+ * they send. A device (or the network layer, if the device does not split
+ * super-segments itself) calls Segment to obtain the segments to serialize.
+ */
+class SegmentationOffload
+{
+public:
+  /**
+   * \brief Segmenter callback
+   *
+   * The arguments are the packet to split (starting with the layer 3
+   * header), the size of the payload of each segment and the vector to
+   * fill with the segments. It returns false if the packet can not be split.
+   */
+  typedef Callback<bool, Ptr<Packet>, uint16_t, std::vector<Ptr<Packet> > &> Segmenter;
+
+  /**
+   * \brief Register the segmenter of a layer 3 protocol
+   * \param protocol the layer 3 protocol number
+   * \param segmenter the segmenter
+   */
+  static void Register (uint16_t protocol, Segmenter segmenter);
+
+  /**
+   * \brief Check whether a packet is a super-segment
+   * \param packet the packet
+   * \returns true if the packet carries a SegmentationOffloadTag
+   */
+  static bool IsSuperSegment (Ptr<const Packet> packet);
+
+  /**
+   * \brief Get the maximum number of segments a packet is split into
+   *
+   * The number is computed as if the whole packet (including the headers of
+   * the layers above the one calling this function) was payload, hence it may
+   * exceed by one the actual number of segments.
+   *
+   * \param packet the packet
+   * \returns the maximum number of segments, or 1 if the packet is not a
+   *          super-segment
+   */
+  static uint16_t GetNSegments (Ptr<const Packet> packet);
+
+  /**
+   * \brief Split a super-segment
+   *
+   * The segments do not carry the SegmentationOffloadTag anymore, but they
+   * carry the other packet tags of the super-segment, as well as its uid.
+   *
+   * \param packet the packet, starting with the layer 3 header
+   * \param protocol the layer 3 protocol number
+   * \param segments the vector to fill with the segments
+   * \returns false if the packet is not a super-segment or no segmenter is
+   *          registered for the protocol
+   */
+  static bool Segment (Ptr<const Packet> packet, uint16_t protocol, std::vector<Ptr<Packet> > &segments);
+};
+
+} // namespace ns3
+
+#endif /* SEGMENTATION_OFFLOAD_H */
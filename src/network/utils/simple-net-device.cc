@@ -27,6 +27,7 @@
 #include "ns3/trace-source-accessor.h"
 #include "ns3/boolean.h"
 #include "ns3/string.h"
+#include "ns3/uinteger.h"
 #include "ns3/tag.h"
 #include "ns3/simulator.h"
 #include "ns3/queue.h"
@@ -210,6 +211,12 @@ SimpleNetDevice::GetTypeId (void)
                    DataRateValue (DataRate ("0b/s")),
                    MakeDataRateAccessor (&SimpleNetDevice::m_bps),
                    MakeDataRateChecker ())
+    .AddAttribute ("MaxBatchSize",
+                   "The maximum number of packets the device accepts at once "
+                   "from the traffic control layer (1 disables batching)",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&SimpleNetDevice::m_maxBatchSize),
+                   MakeUintegerChecker<uint32_t> (1))
     .AddTraceSource ("PhyRxDrop",
                      "Trace source indicating a packet has been dropped "
                      "by the device during reception",
@@ -224,7 +231,8 @@ SimpleNetDevice::SimpleNetDevice ()
     m_node (0),
     m_mtu (0xffff),
     m_ifIndex (0),
-    m_linkUp (false)
+    m_linkUp (false),
+    m_maxBatchSize (1)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -560,4 +568,11 @@ SimpleNetDevice::SupportsSendFrom (void) const
   return true;
 }
 
+uint32_t
+SimpleNetDevice::GetMaxBatchSize (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_maxBatchSize;
+}
+
 } // namespace ns3
@@ -134,6 +134,7 @@ public:
 
   virtual void SetPromiscReceiveCallback (PromiscReceiveCallback cb);
   virtual bool SupportsSendFrom (void) const;
+  virtual uint32_t GetMaxBatchSize (void) const;
 
 protected:
   virtual void DoDispose (void);
@@ -174,6 +175,7 @@ private:
 
   Ptr<Queue<Packet> > m_queue; //!< The Queue for outgoing packets.
   DataRate m_bps; //!< The device nominal Data rate. Zero means infinite
+  uint32_t m_maxBatchSize; //!< Maximum number of packets accepted by SendBatch
   EventId TransmitCompleteEvent; //!< the Tx Complete event
 
   /**
@@ -0,0 +1,123 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/ipv6-nix-vector-helper.h"
+
+/*
+ *  Simple point to point links, as in nix-simple, with IPv6:
+ *
+ *  n0 -- n1 -- n2 -- n3
+ *
+ *  n0 has UdpEchoClient 
+ *  n3 has UdpEchoServer
+ *
+ *  n0 IP: 2001:1::200:ff:fe00:1
+ *  n1 IP: 2001:1::200:ff:fe00:2, 2001:2::200:ff:fe00:3
+ *  n2 IP: 2001:2::200:ff:fe00:4, 2001:3::200:ff:fe00:5
+ *  n3 IP: 2001:3::200:ff:fe00:6
+ *
+ */
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("NixSimpleV6Example");
+
+int
+main (int argc, char *argv[])
+{
+  CommandLine cmd;
+  cmd.Parse (argc, argv);
+  
+  LogComponentEnable ("UdpEchoClientApplication", LOG_LEVEL_INFO);
+  LogComponentEnable ("UdpEchoServerApplication", LOG_LEVEL_INFO);
+
+  NodeContainer nodes12;
+  nodes12.Create (2);
+
+  NodeContainer nodes23;
+  nodes23.Add (nodes12.Get (1));
+  nodes23.Create (1);
+
+  NodeContainer nodes34;
+  nodes34.Add (nodes23.Get (1));
+  nodes34.Create (1);
+
+  PointToPointHelper pointToPoint;
+  pointToPoint.SetDeviceAttribute ("DataRate", StringValue ("5Mbps"));
+  pointToPoint.SetChannelAttribute ("Delay", StringValue ("2ms"));
+
+  NodeContainer allNodes = NodeContainer (nodes12, nodes23.Get (1), nodes34.Get (1));
+
+  // NixHelper to install IPv6 nix-vector routing
+  // on all nodes
+  Ipv6NixVectorHelper nixRouting;
+  InternetStackHelper stack;
+  stack.SetIpv4StackInstall (false);
+  stack.SetRoutingHelper (nixRouting); // has effect on the next Install ()
+  stack.Install (allNodes);
+
+  NetDeviceContainer devices12;
+  NetDeviceContainer devices23;
+  NetDeviceContainer devices34;
+  devices12 = pointToPoint.Install (nodes12);
+  devices23 = pointToPoint.Install (nodes23);
+  devices34 = pointToPoint.Install (nodes34);
+
+  Ipv6AddressHelper address1;
+  address1.SetBase (Ipv6Address ("2001:1::"), Ipv6Prefix (64));
+  Ipv6AddressHelper address2;
+  address2.SetBase (Ipv6Address ("2001:2::"), Ipv6Prefix (64));
+  Ipv6AddressHelper address3;
+  address3.SetBase (Ipv6Address ("2001:3::"), Ipv6Prefix (64));
+
+  Ipv6InterfaceContainer interfaces12 = address1.Assign (devices12);
+  Ipv6InterfaceContainer interfaces23 = address2.Assign (devices23);
+  Ipv6InterfaceContainer interfaces34 = address3.Assign (devices34);
+
+  // n1 and n2 forward the packets
+  interfaces12.SetForwarding (1, true);
+  interfaces23.SetForwarding (0, true);
+  interfaces23.SetForwarding (1, true);
+  interfaces34.SetForwarding (0, true);
+
+  UdpEchoServerHelper echoServer (9);
+
+  ApplicationContainer serverApps = echoServer.Install (nodes34.Get (1));
+  serverApps.Start (Seconds (1.0));
+  serverApps.Stop (Seconds (10.0));
+
+  UdpEchoClientHelper echoClient (interfaces34.GetAddress (1, 1), 9);
+  echoClient.SetAttribute ("MaxPackets", UintegerValue (1));
+  echoClient.SetAttribute ("Interval", TimeValue (Seconds (1.)));
+  echoClient.SetAttribute ("PacketSize", UintegerValue (1024));
+
+  ApplicationContainer clientApps = echoClient.Install (nodes12.Get (0));
+  clientApps.Start (Seconds (2.0));
+  clientApps.Stop (Seconds (10.0));
+
+  // Trace routing tables
+  Ptr<OutputStreamWrapper> routingStream = Create<OutputStreamWrapper> ("nix-simple-v6.routes", std::ios::out);
+  nixRouting.PrintRoutingTableAllAt (Seconds (8), routingStream);
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+  return 0;
+}
@@ -20,6 +20,7 @@
 
 #include "ipv4-nix-vector-helper.h"
 #include "ns3/ipv4-nix-vector-routing.h"
+#include "ns3/nix-vector-tree-cache.h"
 
 namespace ns3 {
 
@@ -47,4 +48,10 @@ Ipv4NixVectorHelper::Create (Ptr<Node> node) const
   node->AggregateObject (agent);
   return agent;
 }
+
+void
+Ipv4NixVectorHelper::PrecomputeTrees (NodeContainer sources, uint32_t nThreads)
+{
+  NixVectorTreeCache::Get (NixVectorTreeCache::IPV4)->Precompute (sources, nThreads);
+}
 } // namespace ns3
@@ -22,6 +22,7 @@
 #define IPV4_NIX_VECTOR_HELPER_H
 
 #include "ns3/object-factory.h"
+#include "ns3/node-container.h"
 #include "ns3/ipv4-routing-helper.h"
 
 namespace ns3 {
@@ -66,6 +67,19 @@ public:
   */
   virtual Ptr<Ipv4RoutingProtocol> Create (Ptr<Node> node) const;
 
+  /**
+   * \brief Compute the breadth first search trees of the given nodes
+   *
+   * The nix-vectors of the packets sent by these nodes are then built
+   * from their trees, without a search when the first packet to each
+   * destination is sent.  The trees are computed after the topology
+   * and the addresses are set up, and are shared by all the nodes.
+   *
+   * \param sources the nodes whose trees are computed
+   * \param nThreads the number of threads computing the trees
+   */
+  static void PrecomputeTrees (NodeContainer sources, uint32_t nThreads = 1);
+
 private:
   /**
    * \brief Assignment operator declared private and not implemented to disallow
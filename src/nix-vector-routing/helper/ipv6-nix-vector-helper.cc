@@ -0,0 +1,53 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ipv6-nix-vector-helper.h"
+#include "ns3/ipv6-nix-vector-routing.h"
+#include "ns3/nix-vector-tree-cache.h"
+
+namespace ns3 {
+
+Ipv6NixVectorHelper::Ipv6NixVectorHelper ()
+{
+  m_agentFactory.SetTypeId ("ns3::Ipv6NixVectorRouting");
+}
+
+Ipv6NixVectorHelper::Ipv6NixVectorHelper (const Ipv6NixVectorHelper &o)
+  : m_agentFactory (o.m_agentFactory)
+{
+}
+
+Ipv6NixVectorHelper* 
+Ipv6NixVectorHelper::Copy (void) const 
+{
+  return new Ipv6NixVectorHelper (*this); 
+}
+
+Ptr<Ipv6RoutingProtocol> 
+Ipv6NixVectorHelper::Create (Ptr<Node> node) const
+{
+  Ptr<Ipv6NixVectorRouting> agent = m_agentFactory.Create<Ipv6NixVectorRouting> ();
+  agent->SetNode (node);
+  node->AggregateObject (agent);
+  return agent;
+}
+
+void
+Ipv6NixVectorHelper::PrecomputeTrees (NodeContainer sources, uint32_t nThreads)
+{
+  NixVectorTreeCache::Get (NixVectorTreeCache::IPV6)->Precompute (sources, nThreads);
+}
+} // namespace ns3
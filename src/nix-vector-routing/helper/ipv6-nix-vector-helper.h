@@ -0,0 +1,88 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef IPV6_NIX_VECTOR_HELPER_H
+#define IPV6_NIX_VECTOR_HELPER_H
+
+#include "ns3/object-factory.h"
+#include "ns3/node-container.h"
+#include "ns3/ipv6-routing-helper.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup nix-vector-routing
+ *
+ * \brief Helper class that adds IPv6 Nix-vector routing to nodes.
+ *
+ * This class is expected to be used in conjunction with 
+ * ns3::InternetStackHelper::SetRoutingHelper
+ *
+ */
+class Ipv6NixVectorHelper : public Ipv6RoutingHelper
+{
+public:
+  /**
+   * Construct an Ipv6NixVectorHelper to make life easier while adding Nix-vector
+   * routing to nodes.
+   */
+  Ipv6NixVectorHelper ();
+
+  /**
+   * \brief Construct an Ipv6NixVectorHelper from another previously 
+   * initialized instance (Copy Constructor).
+   */
+  Ipv6NixVectorHelper (const Ipv6NixVectorHelper &);
+
+  /**
+   * \returns pointer to clone of this Ipv6NixVectorHelper 
+   * 
+   * This method is mainly for internal use by the other helpers;
+   * clients are expected to free the dynamic memory allocated by this method
+   */
+  Ipv6NixVectorHelper* Copy (void) const;
+
+  /**
+  * \param node the node on which the routing protocol will run
+  * \returns a newly-created routing protocol
+  *
+  * This method will be called by ns3::InternetStackHelper::Install
+  */
+  virtual Ptr<Ipv6RoutingProtocol> Create (Ptr<Node> node) const;
+
+  /**
+   * \brief Compute the breadth first search trees of the given nodes
+   *
+   * \see Ipv4NixVectorHelper::PrecomputeTrees
+   *
+   * \param sources the nodes whose trees are computed
+   * \param nThreads the number of threads computing the trees
+   */
+  static void PrecomputeTrees (NodeContainer sources, uint32_t nThreads = 1);
+
+private:
+  /**
+   * \brief Assignment operator declared private and not implemented to disallow
+   * assignment and prevent the compiler from happily inserting its own.
+   * \return Nothing useful.
+   */
+  Ipv6NixVectorHelper &operator = (const Ipv6NixVectorHelper &);
+
+  ObjectFactory m_agentFactory; //!< Object factory
+};
+} // namespace ns3
+
+#endif /* IPV6_NIX_VECTOR_HELPER_H */
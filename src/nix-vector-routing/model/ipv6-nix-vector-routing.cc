@@ -0,0 +1,595 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <iomanip>
+
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/names.h"
+#include "ns3/simulator.h"
+#include "ns3/channel.h"
+#include "ns3/net-device-container.h"
+
+#include "ipv6-nix-vector-routing.h"
+#include "nix-vector-tree-cache.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("Ipv6NixVectorRouting");
+
+NS_OBJECT_ENSURE_REGISTERED (Ipv6NixVectorRouting);
+
+TypeId
+Ipv6NixVectorRouting::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::Ipv6NixVectorRouting")
+    .SetParent<Ipv6RoutingProtocol> ()
+    .SetGroupName ("NixVectorRouting")
+    .AddConstructor<Ipv6NixVectorRouting> ()
+  ;
+  return tid;
+}
+
+Ipv6NixVectorRouting::Ipv6NixVectorRouting ()
+  : m_nixCacheVersion (0),
+    m_ipv6RouteCacheVersion (0),
+    m_totalNeighbors (0)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+}
+
+Ipv6NixVectorRouting::~Ipv6NixVectorRouting ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+}
+
+void
+Ipv6NixVectorRouting::SetIpv6 (Ptr<Ipv6> ipv6)
+{
+  NS_ASSERT (ipv6 != 0);
+  NS_ASSERT (m_ipv6 == 0);
+  NS_LOG_DEBUG ("Created Ipv6NixVectorProtocol");
+
+  m_ipv6 = ipv6;
+}
+
+void
+Ipv6NixVectorRouting::DoDispose ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  m_node = 0;
+  m_ipv6 = 0;
+
+  Ipv6RoutingProtocol::DoDispose ();
+}
+
+void
+Ipv6NixVectorRouting::SetNode (Ptr<Node> node)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  m_node = node;
+}
+
+void
+Ipv6NixVectorRouting::FlushGlobalNixRoutingCache (void) const
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  // the caches of the nodes are flushed when they are next used, as the
+  // version of the trees changes
+  NS_LOG_LOGIC ("Flushing Nix caches.");
+  NixVectorTreeCache::Get (NixVectorTreeCache::IPV6)->Flush ();
+}
+
+void
+Ipv6NixVectorRouting::FlushNixCache (void) const
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  m_nixCache.clear ();
+}
+
+void
+Ipv6NixVectorRouting::FlushIpv6RouteCache (void) const
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  m_ipv6RouteCache.clear ();
+}
+
+Ptr<NixVector>
+Ipv6NixVectorRouting::GetNixVector (Ptr<Node> source, Ipv6Address dest, Ptr<NetDevice> oif)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  NixVectorTreeCache *treeCache = NixVectorTreeCache::Get (NixVectorTreeCache::IPV6);
+
+  // First, we have to figure out the node
+  // associated with this IP
+  int32_t destId = treeCache->GetNodeId (dest);
+  if (destId < 0)
+    {
+      NS_LOG_ERROR ("Couldn't find dest node given the IP" << dest);
+      NS_LOG_ERROR ("No routing path exists");
+      return 0;
+    }
+
+  // Do not process packets to self
+  if (source->GetId () == static_cast<uint32_t> (destId))
+    {
+      NS_LOG_DEBUG ("Do not process packets to self");
+      return 0;
+    }
+
+  Ptr<NixVector> nixVector = treeCache->BuildNixVector (source->GetId (), destId, oif);
+  if (!nixVector)
+    {
+      NS_LOG_ERROR ("No routing path exists");
+    }
+  return nixVector;
+}
+
+Ptr<NixVector>
+Ipv6NixVectorRouting::GetNixVectorInCache (Ipv6Address address)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  CheckCacheStateAndFlush ();
+
+  Ipv6NixMap_t::iterator iter = m_nixCache.find (address);
+  if (iter != m_nixCache.end ())
+    {
+      NS_LOG_LOGIC ("Found Nix-vector in cache.");
+      return iter->second;
+    }
+
+  // not in cache
+  return 0;
+}
+
+Ptr<Ipv6Route>
+Ipv6NixVectorRouting::GetIpv6RouteInCache (Ipv6Address address)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  CheckCacheStateAndFlush ();
+
+  Ipv6RouteMap_t::iterator iter = m_ipv6RouteCache.find (address);
+  if (iter != m_ipv6RouteCache.end ())
+    {
+      NS_LOG_LOGIC ("Found Ipv6Route in cache.");
+      return iter->second;
+    }
+
+  // not in cache
+  return 0;
+}
+
+uint32_t
+Ipv6NixVectorRouting::FindTotalNeighbors (void)
+{
+  uint32_t numberOfDevices = m_node->GetNDevices ();
+  uint32_t totalNeighbors = 0;
+
+  // scan through the net devices on the parent node
+  // and then look at the nodes adjacent to them
+  for (uint32_t i = 0; i < numberOfDevices; i++)
+    {
+      Ptr<NetDevice> localNetDevice = m_node->GetDevice (i);
+      Ptr<Channel> channel = localNetDevice->GetChannel ();
+      if (channel == 0)
+        {
+          continue;
+        }
+
+      NetDeviceContainer netDeviceContainer;
+      NixVectorTreeCache::GetAdjacentNetDevices (localNetDevice, channel, netDeviceContainer);
+
+      totalNeighbors += netDeviceContainer.GetN ();
+    }
+
+  return totalNeighbors;
+}
+
+uint32_t
+Ipv6NixVectorRouting::FindNetDeviceForNixIndex (uint32_t nodeIndex, Ipv6Address & gatewayIp)
+{
+  uint32_t numberOfDevices = m_node->GetNDevices ();
+  uint32_t index = 0;
+  uint32_t totalNeighbors = 0;
+
+  // scan through the net devices on the parent node
+  // and then look at the nodes adjacent to them
+  for (uint32_t i = 0; i < numberOfDevices; i++)
+    {
+      Ptr<NetDevice> localNetDevice = m_node->GetDevice (i);
+      Ptr<Channel> channel = localNetDevice->GetChannel ();
+      if (channel == 0)
+        {
+          continue;
+        }
+
+      NetDeviceContainer netDeviceContainer;
+      NixVectorTreeCache::GetAdjacentNetDevices (localNetDevice, channel, netDeviceContainer);
+
+      // check how many neighbors we have
+      if (nodeIndex < (totalNeighbors + netDeviceContainer.GetN ()))
+        {
+          // found the proper net device
+          index = i;
+          Ptr<NetDevice> gatewayDevice = netDeviceContainer.Get (nodeIndex-totalNeighbors);
+          Ptr<Node> gatewayNode = gatewayDevice->GetNode ();
+          Ptr<Ipv6> ipv6 = gatewayNode->GetObject<Ipv6> ();
+
+          // the next hop is reached through its link-local address
+          uint32_t interfaceIndex = (ipv6)->GetInterfaceForDevice (gatewayDevice);
+          gatewayIp = ipv6->GetAddress (interfaceIndex, 0).GetAddress ();
+          for (uint32_t j = 0; j < ipv6->GetNAddresses (interfaceIndex); j++)
+            {
+              Ipv6InterfaceAddress ifAddr = ipv6->GetAddress (interfaceIndex, j);
+              if (ifAddr.GetScope () == Ipv6InterfaceAddress::LINKLOCAL)
+                {
+                  gatewayIp = ifAddr.GetAddress ();
+                  break;
+                }
+            }
+          break;
+        }
+      totalNeighbors += netDeviceContainer.GetN ();
+    }
+
+  return index;
+}
+
+Ptr<Ipv6Route>
+Ipv6NixVectorRouting::RouteOutput (Ptr<Packet> p, const Ipv6Header &header, Ptr<NetDevice> oif, Socket::SocketErrno &sockerr)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  Ptr<Ipv6Route> rtentry;
+  Ptr<NixVector> nixVectorInCache;
+  Ptr<NixVector> nixVectorForPacket;
+  Ipv6Address destAddress = header.GetDestinationAddress ();
+
+  CheckCacheStateAndFlush ();
+
+  NS_LOG_DEBUG ("Dest IP from header: " << destAddress);
+
+  // the destinations on the link are reached through the
+  // given output interface, without a nix-vector
+  if (destAddress.IsMulticast () || destAddress.IsLinkLocal ())
+    {
+      if (!oif)
+        {
+          NS_LOG_LOGIC ("No output interface for the on-link destination " << destAddress);
+          sockerr = Socket::ERROR_NOROUTETOHOST;
+          return 0;
+        }
+      int32_t interfaceIndex = m_ipv6->GetInterfaceForDevice (oif);
+      NS_ASSERT_MSG (interfaceIndex != -1, "Interface index not found for device");
+
+      rtentry = Create<Ipv6Route> ();
+      rtentry->SetSource (m_ipv6->SourceAddressSelection (interfaceIndex, destAddress));
+      rtentry->SetGateway (Ipv6Address::GetZero ());
+      rtentry->SetDestination (destAddress);
+      rtentry->SetOutputDevice (oif);
+      sockerr = Socket::ERROR_NOTERROR;
+      return rtentry;
+    }
+
+  // check if cache
+  nixVectorInCache = GetNixVectorInCache (destAddress);
+
+  // not in cache
+  if (!nixVectorInCache)
+    {
+      NS_LOG_LOGIC ("Nix-vector not in cache, build: ");
+      // Build the nix-vector, given this node and the
+      // dest IP address
+      nixVectorInCache = GetNixVector (m_node, destAddress, oif);
+
+      // cache it, unless it goes through a specific output interface
+      if (!oif)
+        {
+          m_nixCache.insert (Ipv6NixMap_t::value_type (destAddress, nixVectorInCache));
+        }
+    }
+
+  // path exists
+  if (nixVectorInCache)
+    {
+      NS_LOG_LOGIC ("Nix-vector contents: " << *nixVectorInCache);
+
+      // create a new nix vector to be used,
+      // we want to keep the cached version clean
+      nixVectorForPacket = nixVectorInCache->Copy ();
+
+      // Get the interface number that we go out of, by extracting
+      // from the nix-vector
+      if (m_totalNeighbors == 0)
+        {
+          m_totalNeighbors = FindTotalNeighbors ();
+        }
+      uint32_t numberOfBits = nixVectorForPacket->BitCount (m_totalNeighbors);
+      uint32_t nodeIndex = nixVectorForPacket->ExtractNeighborIndex (numberOfBits);
+
+      // Search here in a cache for this node index
+      // and look for a Ipv6Route
+      rtentry = GetIpv6RouteInCache (destAddress);
+
+      if (!rtentry || !(rtentry->GetOutputDevice () == oif))
+        {
+          // not in cache or a different specified output
+          // device is to be used
+
+          // first, make sure we erase existing (incorrect)
+          // rtentry from the map
+          if (rtentry)
+            {
+              m_ipv6RouteCache.erase (destAddress);
+            }
+
+          NS_LOG_LOGIC ("Ipv6Route not in cache, build: ");
+          Ipv6Address gatewayIp;
+          uint32_t index = FindNetDeviceForNixIndex (nodeIndex, gatewayIp);
+          int32_t interfaceIndex = 0;
+
+          if (!oif)
+            {
+              interfaceIndex = (m_ipv6)->GetInterfaceForDevice (m_node->GetDevice (index));
+            }
+          else
+            {
+              interfaceIndex = (m_ipv6)->GetInterfaceForDevice (oif);
+            }
+
+          NS_ASSERT_MSG (interfaceIndex != -1, "Interface index not found for device");
+
+          // start filling in the Ipv6Route info
+          rtentry = Create<Ipv6Route> ();
+          rtentry->SetSource (m_ipv6->SourceAddressSelection (interfaceIndex, destAddress));
+
+          rtentry->SetGateway (gatewayIp);
+          rtentry->SetDestination (destAddress);
+          rtentry->SetOutputDevice (m_ipv6->GetNetDevice (interfaceIndex));
+
+          sockerr = Socket::ERROR_NOTERROR;
+
+          // add rtentry to cache
+          m_ipv6RouteCache.insert (Ipv6RouteMap_t::value_type (destAddress, rtentry));
+        }
+
+      NS_LOG_LOGIC ("Nix-vector contents: " << *nixVectorInCache << " : Remaining bits: " << nixVectorForPacket->GetRemainingBits ());
+
+      // Add  nix-vector in the packet class
+      // make sure the packet exists first
+      if (p)
+        {
+          NS_LOG_LOGIC ("Adding Nix-vector to packet: " << *nixVectorForPacket);
+          p->SetNixVector (nixVectorForPacket);
+        }
+    }
+  else // path doesn't exist
+    {
+      NS_LOG_ERROR ("No path to the dest: " << destAddress);
+      sockerr = Socket::ERROR_NOROUTETOHOST;
+    }
+
+  return rtentry;
+}
+
+bool
+Ipv6NixVectorRouting::RouteInput (Ptr<const Packet> p, const Ipv6Header &header, Ptr<const NetDevice> idev,
+                                  UnicastForwardCallback ucb, MulticastForwardCallback mcb,
+                                  LocalDeliverCallback lcb, ErrorCallback ecb)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  CheckCacheStateAndFlush ();
+
+  NS_ASSERT (m_ipv6 != 0);
+  // Check if input device supports IP
+  NS_ASSERT (m_ipv6->GetInterfaceForDevice (idev) >= 0);
+  uint32_t iif = m_ipv6->GetInterfaceForDevice (idev);
+
+  // The multicast packets are not routed with nix-vectors: let another
+  // routing protocol handle them
+  if (header.GetDestinationAddress ().IsMulticast ())
+    {
+      NS_LOG_LOGIC ("Multicast destination");
+      return false;
+    }
+
+  // Get the nix-vector from the packet
+  Ptr<NixVector> nixVector = p->GetNixVector ();
+  if (!nixVector)
+    {
+      NS_LOG_LOGIC ("No nix-vector in the packet");
+      return false;
+    }
+
+  // The path of a nix-vector ends at the destination node, whichever
+  // interface it arrives on.  Ipv6L3Protocol delivers the packets for the
+  // addresses of the input interface, but, with the strong end system
+  // model, passes those for the other interfaces of the node here.
+  if (nixVector->GetRemainingBits () == 0)
+    {
+      if (m_ipv6->GetInterfaceForAddress (header.GetDestinationAddress ()) >= 0 && !lcb.IsNull ())
+        {
+          NS_LOG_LOGIC ("Local delivery to " << header.GetDestinationAddress ());
+          lcb (p, header, iif);
+          return true;
+        }
+      NS_LOG_LOGIC ("End of the nix-vector, but not for this node");
+      if (!ecb.IsNull ())
+        {
+          ecb (p, header, Socket::ERROR_NOROUTETOHOST);
+        }
+      return true;
+    }
+
+  // Check if input device supports IP forwarding
+  if (m_ipv6->IsForwarding (iif) == false)
+    {
+      NS_LOG_LOGIC ("Forwarding disabled for this interface");
+      if (!ecb.IsNull ())
+        {
+          ecb (p, header, Socket::ERROR_NOROUTETOHOST);
+        }
+      return true;
+    }
+
+  Ptr<Ipv6Route> rtentry;
+
+  // Get the interface number that we go out of, by extracting
+  // from the nix-vector
+  if (m_totalNeighbors == 0)
+    {
+      m_totalNeighbors = FindTotalNeighbors ();
+    }
+  uint32_t numberOfBits = nixVector->BitCount (m_totalNeighbors);
+  uint32_t nodeIndex = nixVector->ExtractNeighborIndex (numberOfBits);
+
+  rtentry = GetIpv6RouteInCache (header.GetDestinationAddress ());
+  // not in cache
+  if (!rtentry)
+    {
+      NS_LOG_LOGIC ("Ipv6Route not in cache, build: ");
+      Ipv6Address gatewayIp;
+      uint32_t index = FindNetDeviceForNixIndex (nodeIndex, gatewayIp);
+      uint32_t interfaceIndex = (m_ipv6)->GetInterfaceForDevice (m_node->GetDevice (index));
+
+      // start filling in the Ipv6Route info
+      rtentry = Create<Ipv6Route> ();
+      rtentry->SetSource (m_ipv6->SourceAddressSelection (interfaceIndex, header.GetDestinationAddress ()));
+
+      rtentry->SetGateway (gatewayIp);
+      rtentry->SetDestination (header.GetDestinationAddress ());
+      rtentry->SetOutputDevice (m_ipv6->GetNetDevice (interfaceIndex));
+
+      // add rtentry to cache
+      m_ipv6RouteCache.insert (Ipv6RouteMap_t::value_type (header.GetDestinationAddress (), rtentry));
+    }
+
+  NS_LOG_LOGIC ("At Node " << m_node->GetId () << ", Extracting " << numberOfBits <<
+                " bits from Nix-vector: " << nixVector << " : " << *nixVector);
+
+  // call the unicast callback
+  ucb (idev, rtentry, p, header);
+
+  return true;
+}
+
+void
+Ipv6NixVectorRouting::PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Unit unit) const
+{
+
+  CheckCacheStateAndFlush ();
+
+  std::ostream* os = stream->GetStream ();
+
+  *os << "Node: " << m_ipv6->GetObject<Node> ()->GetId ()
+      << ", Time: " << Now().As (unit)
+      << ", Local time: " << GetObject<Node> ()->GetLocalTime ().As (unit)
+      << ", Nix Routing" << std::endl;
+
+  *os << "NixCache:" << std::endl;
+  if (m_nixCache.size () > 0)
+    {
+      *os << "Destination                   NixVector" << std::endl;
+      for (Ipv6NixMap_t::const_iterator it = m_nixCache.begin (); it != m_nixCache.end (); it++)
+        {
+          std::ostringstream dest;
+          dest << it->first;
+          *os << std::setiosflags (std::ios::left) << std::setw (30) << dest.str ();
+          *os << *(it->second) << std::endl;
+        }
+    }
+  *os << "Ipv6RouteCache:" << std::endl;
+  if (m_ipv6RouteCache.size () > 0)
+    {
+      *os << "Destination                   Gateway                       Source                          OutputDevice" << std::endl;
+      for (Ipv6RouteMap_t::const_iterator it = m_ipv6RouteCache.begin (); it != m_ipv6RouteCache.end (); it++)
+        {
+          std::ostringstream dest, gw, src;
+          dest << it->second->GetDestination ();
+          *os << std::setiosflags (std::ios::left) << std::setw (30) << dest.str ();
+          gw << it->second->GetGateway ();
+          *os << std::setiosflags (std::ios::left) << std::setw (30) << gw.str ();
+          src << it->second->GetSource ();
+          *os << std::setiosflags (std::ios::left) << std::setw (30) << src.str ();
+          *os << "  ";
+          if (Names::FindName (it->second->GetOutputDevice ()) != "")
+            {
+              *os << Names::FindName (it->second->GetOutputDevice ());
+            }
+          else
+            {
+              *os << it->second->GetOutputDevice ()->GetIfIndex ();
+            }
+          *os << std::endl;
+        }
+    }
+  *os << std::endl;
+}
+
+// virtual functions from Ipv6RoutingProtocol
+void
+Ipv6NixVectorRouting::NotifyInterfaceUp (uint32_t i)
+{
+  NixVectorTreeCache::Get (NixVectorTreeCache::IPV6)->NotifyInterfaceChange (m_node->GetId ());
+}
+void
+Ipv6NixVectorRouting::NotifyInterfaceDown (uint32_t i)
+{
+  NixVectorTreeCache::Get (NixVectorTreeCache::IPV6)->NotifyInterfaceChange (m_node->GetId ());
+}
+void
+Ipv6NixVectorRouting::NotifyAddAddress (uint32_t interface, Ipv6InterfaceAddress address)
+{
+  NixVectorTreeCache::Get (NixVectorTreeCache::IPV6)->NotifyAddressChange ();
+}
+void
+Ipv6NixVectorRouting::NotifyRemoveAddress (uint32_t interface, Ipv6InterfaceAddress address)
+{
+  NixVectorTreeCache::Get (NixVectorTreeCache::IPV6)->NotifyAddressChange ();
+}
+void
+Ipv6NixVectorRouting::NotifyAddRoute (Ipv6Address dst, Ipv6Prefix mask, Ipv6Address nextHop, uint32_t interface, Ipv6Address prefixToUse)
+{
+}
+void
+Ipv6NixVectorRouting::NotifyRemoveRoute (Ipv6Address dst, Ipv6Prefix mask, Ipv6Address nextHop, uint32_t interface, Ipv6Address prefixToUse)
+{
+}
+
+void
+Ipv6NixVectorRouting::CheckCacheStateAndFlush (void) const
+{
+  NixVectorTreeCache *treeCache = NixVectorTreeCache::Get (NixVectorTreeCache::IPV6);
+  uint32_t nixCacheVersion = treeCache->GetTreeVersion (m_node->GetId ());
+  if (nixCacheVersion != m_nixCacheVersion)
+    {
+      FlushNixCache ();
+      m_nixCacheVersion = nixCacheVersion;
+    }
+  uint32_t ipv6RouteCacheVersion = treeCache->GetVersion ();
+  if (ipv6RouteCacheVersion != m_ipv6RouteCacheVersion)
+    {
+      FlushIpv6RouteCache ();
+      m_ipv6RouteCacheVersion = ipv6RouteCacheVersion;
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,621 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/simulator.h"
+#include "ns3/node-list.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-thread.h"
+#endif
+
+#include "nix-vector-tree-cache.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("NixVectorTreeCache");
+
+NixVectorTreeCache*
+NixVectorTreeCache::Get (Family family)
+{
+  static NixVectorTreeCache ipv4Cache (IPV4);
+  static NixVectorTreeCache ipv6Cache (IPV6);
+  return family == IPV4 ? &ipv4Cache : &ipv6Cache;
+}
+
+NixVectorTreeCache::NixVectorTreeCache (Family family)
+  : m_family (family),
+    m_epoch (0),
+    m_version (0),
+    m_addressesDirty (true),
+    m_destroyScheduled (false),
+    m_nTreesComputed (0),
+    m_nextSource (0)
+{
+  NS_LOG_FUNCTION (this << family);
+}
+
+NixVectorTreeCache::~NixVectorTreeCache ()
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t i = 0; i < m_trees.size (); i++)
+    {
+      delete m_trees[i];
+    }
+}
+
+void
+NixVectorTreeCache::GetAdjacentNetDevices (Ptr<NetDevice> netDevice, Ptr<Channel> channel, NetDeviceContainer & netDeviceContainer)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  for (std::size_t i = 0; i < channel->GetNDevices (); i++)
+    {
+      Ptr<NetDevice> remoteDevice = channel->GetDevice (i);
+      if (remoteDevice != netDevice)
+        {
+          Ptr<BridgeNetDevice> bd;
+          // There is no bit on a net device that says it is being bridged,
+          // so we have to look for bridges on the node to which the device
+          // is attached.
+          Ptr<Node> node = remoteDevice->GetNode ();
+          for (uint32_t j = 0; j < node->GetNDevices () && !bd; ++j)
+            {
+              Ptr<NetDevice> ndTest = node->GetDevice (j);
+              if (ndTest->IsBridge ())
+                {
+                  Ptr<BridgeNetDevice> bnd = ndTest->GetObject<BridgeNetDevice> ();
+                  NS_ABORT_MSG_UNLESS (bnd, "NixVectorTreeCache::GetAdjacentNetDevices (): GetObject for <BridgeNetDevice> failed");
+                  for (uint32_t k = 0; k < bnd->GetNBridgePorts (); ++k)
+                    {
+                      if (bnd->GetBridgePort (k) == remoteDevice)
+                        {
+                          NS_LOG_LOGIC ("Net device " << remoteDevice << " is bridged by " << bnd);
+                          bd = bnd;
+                          break;
+                        }
+                    }
+                }
+            }
+          // we have a bridged device, we need to add all
+          // bridged devices
+          if (bd)
+            {
+              NS_LOG_LOGIC ("Looking through bridge ports of bridge net device " << bd);
+              for (uint32_t j = 0; j < bd->GetNBridgePorts (); ++j)
+                {
+                  Ptr<NetDevice> ndBridged = bd->GetBridgePort (j);
+                  if (ndBridged == remoteDevice)
+                    {
+                      NS_LOG_LOGIC ("That bridge port is me, don't walk backward");
+                      continue;
+                    }
+                  Ptr<Channel> chBridged = ndBridged->GetChannel ();
+                  if (chBridged == 0)
+                    {
+                      continue;
+                    }
+                  GetAdjacentNetDevices (ndBridged, chBridged, netDeviceContainer);
+                }
+            }
+          else
+            {
+              netDeviceContainer.Add (channel->GetDevice (i));
+            }
+        }
+    }
+}
+
+void
+NixVectorTreeCache::Update (void)
+{
+  if (m_vertices.size () != NodeList::GetNNodes ())
+    {
+      BuildGraph ();
+    }
+  else if (!m_dirtyNodes.empty ())
+    {
+      std::set<uint32_t> dirtyNodes;
+      dirtyNodes.swap (m_dirtyNodes);
+      for (std::set<uint32_t>::const_iterator it = dirtyNodes.begin (); it != dirtyNodes.end (); it++)
+        {
+          NS_LOG_LOGIC ("Checking the devices of node " << *it);
+          Vertex &vertex = m_vertices[*it];
+          std::vector<Port> ports = GetPorts (NodeList::GetNode (*it), vertex);
+          bool sameDevices = (ports.size () == vertex.ports.size ());
+          for (uint32_t i = 0; i < ports.size () && sameDevices; i++)
+            {
+              sameDevices = (ports[i].device == vertex.ports[i].device
+                             && ports[i].neighbors == vertex.ports[i].neighbors);
+            }
+          if (!sameDevices)
+            {
+              // the topology changed, the neighbors of other nodes may
+              // have changed as well
+              NS_LOG_LOGIC ("The devices of node " << *it << " changed, rebuilding the graph");
+              BuildGraph ();
+              break;
+            }
+          for (uint32_t i = 0; i < ports.size (); i++)
+            {
+              if (ports[i].up != vertex.ports[i].up)
+                {
+                  NS_LOG_LOGIC ("Port " << i << " of node " << *it << " is " << (ports[i].up ? "up" : "down"));
+                  vertex.ports[i].up = ports[i].up;
+                  DropTrees (*it, vertex.ports[i]);
+                  m_version++;
+                }
+            }
+        }
+    }
+
+  if (m_addressesDirty)
+    {
+      NS_LOG_LOGIC ("Indexing the addresses of the nodes");
+      m_ipv4Nodes.clear ();
+      m_ipv6Nodes.clear ();
+      // the first node with an address is the one it is mapped to
+      for (uint32_t i = 0; i < m_vertices.size (); i++)
+        {
+          Ptr<Ipv4> ipv4 = m_vertices[i].ipv4;
+          for (uint32_t j = 0; ipv4 && j < ipv4->GetNInterfaces (); j++)
+            {
+              for (uint32_t k = 0; k < ipv4->GetNAddresses (j); k++)
+                {
+                  m_ipv4Nodes.insert (std::make_pair (ipv4->GetAddress (j, k).GetLocal (), i));
+                }
+            }
+          Ptr<Ipv6> ipv6 = m_vertices[i].ipv6;
+          for (uint32_t j = 0; ipv6 && j < ipv6->GetNInterfaces (); j++)
+            {
+              for (uint32_t k = 0; k < ipv6->GetNAddresses (j); k++)
+                {
+                  m_ipv6Nodes.insert (std::make_pair (ipv6->GetAddress (j, k).GetAddress (), i));
+                }
+            }
+        }
+      m_addressesDirty = false;
+      m_epoch++;
+      m_version++;
+    }
+}
+
+void
+NixVectorTreeCache::BuildGraph (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  uint32_t nNodes = NodeList::GetNNodes ();
+  for (uint32_t i = 0; i < m_trees.size (); i++)
+    {
+      delete m_trees[i];
+    }
+  m_trees.assign (nNodes, 0);
+  m_treeVersions.resize (nNodes, 0);
+  m_epoch++;
+  m_version++;
+
+  m_vertices.clear ();
+  m_vertices.resize (nNodes);
+  for (uint32_t i = 0; i < nNodes; i++)
+    {
+      Ptr<Node> node = NodeList::GetNode (i);
+      Vertex &vertex = m_vertices[i];
+      if (m_family == IPV4)
+        {
+          vertex.ipv4 = node->GetObject<Ipv4> ();
+        }
+      else
+        {
+          vertex.ipv6 = node->GetObject<Ipv6> ();
+        }
+      vertex.ports = GetPorts (node, vertex);
+    }
+  m_dirtyNodes.clear ();
+  m_addressesDirty = true;
+
+  if (!m_destroyScheduled)
+    {
+      Simulator::ScheduleDestroy (&NixVectorTreeCache::Clear, this);
+      m_destroyScheduled = true;
+    }
+}
+
+std::vector<NixVectorTreeCache::Port>
+NixVectorTreeCache::GetPorts (Ptr<Node> node, const Vertex &vertex) const
+{
+  std::vector<Port> ports;
+  for (uint32_t i = 0; i < node->GetNDevices (); i++)
+    {
+      Ptr<NetDevice> device = node->GetDevice (i);
+      Ptr<Channel> channel = device->GetChannel ();
+      if (channel == 0)
+        {
+          continue;
+        }
+
+      Port port;
+      port.device = device;
+      port.interface = -1;
+      if (vertex.ipv4)
+        {
+          port.interface = vertex.ipv4->GetInterfaceForDevice (device);
+        }
+      else if (vertex.ipv6)
+        {
+          port.interface = vertex.ipv6->GetInterfaceForDevice (device);
+        }
+      port.bridge = device->IsBridge ();
+      port.up = IsUp (vertex, port);
+
+      NetDeviceContainer netDeviceContainer;
+      GetAdjacentNetDevices (device, channel, netDeviceContainer);
+      for (NetDeviceContainer::Iterator iter = netDeviceContainer.Begin (); iter != netDeviceContainer.End (); iter++)
+        {
+          port.neighbors.push_back ((*iter)->GetNode ()->GetId ());
+        }
+      ports.push_back (port);
+    }
+  return ports;
+}
+
+bool
+NixVectorTreeCache::IsUp (const Vertex &vertex, const Port &port) const
+{
+  if (port.interface >= 0)
+    {
+      if (vertex.ipv4 && !vertex.ipv4->IsUp (port.interface))
+        {
+          return false;
+        }
+      if (vertex.ipv6 && !vertex.ipv6->IsUp (port.interface))
+        {
+          return false;
+        }
+    }
+  return port.device->IsLinkUp ();
+}
+
+void
+NixVectorTreeCache::RefreshPorts (void)
+{
+  for (uint32_t i = 0; i < m_vertices.size (); i++)
+    {
+      Vertex &vertex = m_vertices[i];
+      for (uint32_t j = 0; j < vertex.ports.size (); j++)
+        {
+          vertex.ports[j].up = IsUp (vertex, vertex.ports[j]);
+        }
+    }
+}
+
+void
+NixVectorTreeCache::DropTrees (uint32_t nodeId, const Port &port)
+{
+  NS_LOG_FUNCTION (this << nodeId);
+  for (uint32_t source = 0; source < m_trees.size (); source++)
+    {
+      const Tree *tree = m_trees[source];
+      if (tree == 0)
+        {
+          continue;
+        }
+      bool drop = false;
+      for (uint32_t i = 0; i < port.neighbors.size () && !drop; i++)
+        {
+          uint32_t neighbor = port.neighbors[i];
+          if (port.up)
+            {
+              // the new edge may provide a path, a shorter one, or an
+              // equally short one that is discovered first
+              drop = (tree->parent[nodeId] != -1
+                      && (tree->parent[neighbor] == -1 || tree->depth[nodeId] + 1 <= tree->depth[neighbor]));
+            }
+          else
+            {
+              // only the edges of the tree matter
+              drop = (tree->parent[neighbor] == static_cast<int32_t> (nodeId));
+            }
+        }
+      if (drop)
+        {
+          DropTree (source);
+        }
+    }
+}
+
+void
+NixVectorTreeCache::DropTree (uint32_t source)
+{
+  NS_LOG_LOGIC ("Dropping the tree of node " << source);
+  delete m_trees[source];
+  m_trees[source] = 0;
+  m_treeVersions[source]++;
+  m_version++;
+}
+
+const NixVectorTreeCache::Tree*
+NixVectorTreeCache::GetTree (uint32_t source)
+{
+  if (m_trees[source] == 0)
+    {
+      NS_LOG_LOGIC ("Computing the tree of node " << source);
+      RefreshPorts ();
+      Tree *tree = new Tree;
+      ComputeTree (source, -1, *tree);
+      m_trees[source] = tree;
+      m_nTreesComputed++;
+    }
+  return m_trees[source];
+}
+
+void
+NixVectorTreeCache::ComputeTree (uint32_t source, int32_t firstPort, Tree &tree) const
+{
+  uint32_t nNodes = m_vertices.size ();
+  tree.parent.assign (nNodes, -1);
+  tree.depth.assign (nNodes, 0);
+
+  // discovered nodes with unexplored children, from the head index on
+  std::vector<uint32_t> greyNodeList;
+  greyNodeList.reserve (nNodes);
+
+  // Add the source node to the queue, set its parent to itself
+  greyNodeList.push_back (source);
+  tree.parent[source] = source;
+
+  for (uint32_t head = 0; head < greyNodeList.size (); head++)
+    {
+      uint32_t currNode = greyNodeList[head];
+      const std::vector<Port> &ports = m_vertices[currNode].ports;
+      for (uint32_t i = 0; i < ports.size (); i++)
+        {
+          // if a specific output interface was given, the source goes
+          // this way only
+          if (!ports[i].up || (currNode == source && firstPort >= 0 && static_cast<int32_t> (i) != firstPort))
+            {
+              continue;
+            }
+          const std::vector<uint32_t> &neighbors = ports[i].neighbors;
+          for (uint32_t j = 0; j < neighbors.size (); j++)
+            {
+              // push the nodes not pushed before, i.e., with no parent
+              if (tree.parent[neighbors[j]] == -1)
+                {
+                  tree.parent[neighbors[j]] = currNode;
+                  tree.depth[neighbors[j]] = tree.depth[currNode] + 1;
+                  greyNodeList.push_back (neighbors[j]);
+                }
+            }
+        }
+    }
+}
+
+Ptr<NixVector>
+NixVectorTreeCache::BuildNixVector (uint32_t source, uint32_t dest, Ptr<NetDevice> oif)
+{
+  NS_LOG_FUNCTION (this << source << dest << oif);
+
+  Update ();
+  NS_ASSERT (source < m_vertices.size () && dest < m_vertices.size ());
+
+  Tree oifTree;
+  const Tree *tree;
+  if (oif)
+    {
+      int32_t firstPort = -1;
+      const std::vector<Port> &ports = m_vertices[source].ports;
+      for (uint32_t i = 0; i < ports.size () && firstPort < 0; i++)
+        {
+          if (ports[i].device == oif)
+            {
+              firstPort = i;
+            }
+        }
+      if (firstPort < 0)
+        {
+          NS_LOG_LOGIC ("The output interface has no channel");
+          return 0;
+        }
+      RefreshPorts ();
+      ComputeTree (source, firstPort, oifTree);
+      tree = &oifTree;
+    }
+  else
+    {
+      tree = GetTree (source);
+    }
+
+  if (tree->parent[dest] == -1)
+    {
+      return 0;
+    }
+
+  // walk the path back from the destination, as the nix-vector starts
+  // with the index of the last hop
+  Ptr<NixVector> nixVector = Create<NixVector> ();
+  for (uint32_t node = dest; node != source; node = tree->parent[node])
+    {
+      uint32_t parentNode = tree->parent[node];
+      const std::vector<Port> &ports = m_vertices[parentNode].ports;
+      uint32_t destId = 0;
+      uint32_t totalNeighbors = 0;
+      for (uint32_t i = 0; i < ports.size (); i++)
+        {
+          if (ports[i].bridge)
+            {
+              continue;
+            }
+          for (uint32_t j = 0; j < ports[i].neighbors.size (); j++)
+            {
+              if (ports[i].neighbors[j] == node)
+                {
+                  destId = totalNeighbors;
+                }
+              totalNeighbors++;
+            }
+        }
+      NS_LOG_LOGIC ("Adding Nix: " << destId << " with "
+                                   << nixVector->BitCount (totalNeighbors) << " bits, for node " << parentNode);
+      nixVector->AddNeighborIndex (destId, nixVector->BitCount (totalNeighbors));
+    }
+  return nixVector;
+}
+
+void
+NixVectorTreeCache::Precompute (NodeContainer sources, uint32_t nThreads)
+{
+  NS_LOG_FUNCTION (this << sources.GetN () << nThreads);
+
+  Update ();
+  RefreshPorts ();
+  m_pendingSources.clear ();
+  for (NodeContainer::Iterator i = sources.Begin (); i != sources.End (); i++)
+    {
+      uint32_t source = (*i)->GetId ();
+      if (m_trees[source] == 0)
+        {
+          m_trees[source] = new Tree;
+          m_pendingSources.push_back (source);
+        }
+    }
+
+  m_nextSource = 0;
+#ifdef HAVE_PTHREAD_H
+  // the threads only read the graph, and each fills its own trees
+  std::vector<Ptr<SystemThread> > threads;
+  for (uint32_t i = 1; i < nThreads && i < m_pendingSources.size (); i++)
+    {
+      threads.push_back (Create<SystemThread> (MakeCallback (&NixVectorTreeCache::ProcessPendingSources, this)));
+      threads.back ()->Start ();
+    }
+#endif
+  ProcessPendingSources ();
+#ifdef HAVE_PTHREAD_H
+  for (uint32_t i = 0; i < threads.size (); i++)
+    {
+      threads[i]->Join ();
+    }
+#endif
+  m_nTreesComputed += m_pendingSources.size ();
+  m_pendingSources.clear ();
+}
+
+void
+NixVectorTreeCache::ProcessPendingSources (void)
+{
+  for (;;)
+    {
+      uint32_t source;
+      {
+#ifdef HAVE_PTHREAD_H
+        CriticalSection cs (m_pendingMutex);
+#endif
+        if (m_nextSource == m_pendingSources.size ())
+          {
+            return;
+          }
+        source = m_pendingSources[m_nextSource++];
+      }
+      ComputeTree (source, -1, *m_trees[source]);
+    }
+}
+
+int32_t
+NixVectorTreeCache::GetNodeId (Ipv4Address address)
+{
+  Update ();
+  std::unordered_map<Ipv4Address, uint32_t, Ipv4AddressHash>::const_iterator it = m_ipv4Nodes.find (address);
+  if (it == m_ipv4Nodes.end ())
+    {
+      return -1;
+    }
+  return it->second;
+}
+
+int32_t
+NixVectorTreeCache::GetNodeId (Ipv6Address address)
+{
+  Update ();
+  std::unordered_map<Ipv6Address, uint32_t, Ipv6AddressHash>::const_iterator it = m_ipv6Nodes.find (address);
+  if (it == m_ipv6Nodes.end ())
+    {
+      return -1;
+    }
+  return it->second;
+}
+
+uint32_t
+NixVectorTreeCache::GetTreeVersion (uint32_t source)
+{
+  Update ();
+  NS_ASSERT (source < m_treeVersions.size ());
+  return m_treeVersions[source] + m_epoch;
+}
+
+uint32_t
+NixVectorTreeCache::GetVersion (void)
+{
+  Update ();
+  return m_version;
+}
+
+void
+NixVectorTreeCache::NotifyInterfaceChange (uint32_t nodeId)
+{
+  m_dirtyNodes.insert (nodeId);
+}
+
+void
+NixVectorTreeCache::NotifyAddressChange (void)
+{
+  m_addressesDirty = true;
+}
+
+void
+NixVectorTreeCache::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t i = 0; i < m_trees.size (); i++)
+    {
+      delete m_trees[i];
+    }
+  m_trees.clear ();
+  // the graph is built again by the next Update
+  m_vertices.clear ();
+  m_dirtyNodes.clear ();
+  m_addressesDirty = true;
+  m_epoch++;
+  m_version++;
+}
+
+uint32_t
+NixVectorTreeCache::GetNTreesComputed (void) const
+{
+  return m_nTreesComputed;
+}
+
+void
+NixVectorTreeCache::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  Flush ();
+  m_ipv4Nodes.clear ();
+  m_ipv6Nodes.clear ();
+  m_destroyScheduled = false;
+}
+
+} // namespace ns3
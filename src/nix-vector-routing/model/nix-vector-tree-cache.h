@@ -0,0 +1,286 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NIX_VECTOR_TREE_CACHE_H
+#define NIX_VECTOR_TREE_CACHE_H
+
+#include <set>
+#include <vector>
+#include <unordered_map>
+
+#include "ns3/core-config.h"
+#include "ns3/ptr.h"
+#include "ns3/node.h"
+#include "ns3/node-container.h"
+#include "ns3/net-device.h"
+#include "ns3/net-device-container.h"
+#include "ns3/channel.h"
+#include "ns3/nix-vector.h"
+#include "ns3/ipv4.h"
+#include "ns3/ipv6.h"
+#include "ns3/bridge-net-device.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-mutex.h"
+#endif
+
+namespace ns3 {
+
+/**
+ * \ingroup nix-vector-routing
+ *
+ * \brief The breadth first search trees of the nodes, shared by the
+ * nix-vector routing protocols of all the nodes
+ *
+ * The cache keeps a graph of the nodes, whose edges are the devices of
+ * the nodes and the neighbors reached through their channels, and the tree
+ * of the shortest paths from each node that sent a packet.  A single
+ * breadth first search from a node provides its nix-vectors to all the
+ * destinations, which are built by walking the tree back from the
+ * destination.  The trees are rooted at the sources, so that they select
+ * the same paths as a search towards each destination.
+ *
+ * When an interface goes up or down, only the trees that may change are
+ * dropped: the trees using an edge that went down, and the trees reaching
+ * the node of an edge that came up no later than its other end.  The trees
+ * of many sources can be computed beforehand by several threads, see
+ * Precompute ().
+ *
+ * There is a cache for IPv4 and one for IPv6, as the state of the
+ * interfaces and the addresses differ.  The routing protocols compare the
+ * versions returned by GetTreeVersion () and GetVersion () with those of
+ * their own caches to flush them lazily.
+ */
+class NixVectorTreeCache
+{
+public:
+  /// The address family of a cache
+  enum Family
+  {
+    IPV4,
+    IPV6
+  };
+
+  /**
+   * \brief Get the cache of an address family
+   * \param family the address family
+   * \return the cache
+   */
+  static NixVectorTreeCache* Get (Family family);
+
+  /**
+   * \brief Given a net-device returns all the adjacent net-devices,
+   * essentially getting the neighbors on that channel
+   * \param [in] netDevice the NetDevice attached to the channel.
+   * \param [in] channel the channel to check
+   * \param [out] netDeviceContainer the NetDeviceContainer of the NetDevices in the channel.
+   */
+  static void GetAdjacentNetDevices (Ptr<NetDevice> netDevice, Ptr<Channel> channel, NetDeviceContainer & netDeviceContainer);
+
+  /**
+   * \brief Build the nix-vector of the shortest path between two nodes
+   *
+   * The tree of the source is computed, if needed, unless an output
+   * interface is given: in that case, a search whose first hop is that
+   * interface is performed, whose tree is not kept.
+   *
+   * \param source the id of the source node
+   * \param dest the id of the destination node
+   * \param oif the output interface to use from the source node, if not null
+   * \return the nix-vector, or null if the destination is unreachable
+   */
+  Ptr<NixVector> BuildNixVector (uint32_t source, uint32_t dest, Ptr<NetDevice> oif);
+
+  /**
+   * \brief Compute the trees of the given nodes
+   *
+   * The trees already computed are kept.
+   *
+   * \param sources the source nodes
+   * \param nThreads the number of threads computing the trees
+   */
+  void Precompute (NodeContainer sources, uint32_t nThreads);
+
+  /**
+   * \brief Get the id of the node with the given address
+   * \param address the address
+   * \return the id of the node, or -1 if no node has the address
+   */
+  int32_t GetNodeId (Ipv4Address address);
+  /**
+   * \brief Get the id of the node with the given address
+   * \param address the address
+   * \return the id of the node, or -1 if no node has the address
+   */
+  int32_t GetNodeId (Ipv6Address address);
+
+  /**
+   * \brief Get the version of the nix-vectors of a source
+   *
+   * The version changes whenever the nix-vectors of the source may change,
+   * i.e., its tree is dropped or an address changes.
+   *
+   * \param source the id of the source node
+   * \return the version
+   */
+  uint32_t GetTreeVersion (uint32_t source);
+  /**
+   * \brief Get the version of the cache
+   *
+   * The version changes whenever any tree is dropped or an address
+   * changes.
+   *
+   * \return the version
+   */
+  uint32_t GetVersion (void);
+
+  /**
+   * \brief Record that an interface of a node went up or down
+   * \param nodeId the id of the node
+   */
+  void NotifyInterfaceChange (uint32_t nodeId);
+  /**
+   * \brief Record that an address was added or removed
+   */
+  void NotifyAddressChange (void);
+  /**
+   * \brief Drop all the trees and the graph
+   */
+  void Flush (void);
+
+  /**
+   * \brief Get the number of trees computed
+   * \return the number of breadth first searches run, whose tree was kept
+   */
+  uint32_t GetNTreesComputed (void) const;
+
+private:
+  /**
+   * \brief Construct the cache of an address family
+   * \param family the address family
+   */
+  NixVectorTreeCache (Family family);
+  ~NixVectorTreeCache ();
+
+  /// A device of a node with a channel
+  struct Port
+  {
+    Ptr<NetDevice> device;            //!< the device
+    int32_t interface;                //!< the interface of the device (-1 if none)
+    bool bridge;                      //!< whether the device is a bridge
+    bool up;                          //!< whether the port could be used when last checked
+    std::vector<uint32_t> neighbors;  //!< the nodes adjacent through the channel
+  };
+
+  /// A node of the graph
+  struct Vertex
+  {
+    Ptr<Ipv4> ipv4;                   //!< the IPv4 stack (IPv4 cache only)
+    Ptr<Ipv6> ipv6;                   //!< the IPv6 stack (IPv6 cache only)
+    std::vector<Port> ports;          //!< the devices with a channel
+  };
+
+  /// A tree of shortest paths
+  struct Tree
+  {
+    std::vector<int32_t> parent;      //!< the parent of each node (-1 if unreachable)
+    std::vector<uint32_t> depth;      //!< the depth of each node
+  };
+
+  /**
+   * \brief Process the changes recorded since the last call
+   */
+  void Update (void);
+  /**
+   * \brief Build the graph of the nodes
+   */
+  void BuildGraph (void);
+  /**
+   * \brief Get the ports of a node
+   * \param node the node
+   * \param vertex the vertex of the node, whose stacks are set
+   * \return the ports
+   */
+  std::vector<Port> GetPorts (Ptr<Node> node, const Vertex &vertex) const;
+  /**
+   * \brief Check whether a port can be used
+   * \param vertex the vertex of the port
+   * \param port the port
+   * \return true if the port is up
+   */
+  bool IsUp (const Vertex &vertex, const Port &port) const;
+  /**
+   * \brief Check the state of the ports of all the nodes
+   */
+  void RefreshPorts (void);
+  /**
+   * \brief Drop the trees that may change because a port of a node went up or down
+   * \param nodeId the id of the node
+   * \param port the port
+   */
+  void DropTrees (uint32_t nodeId, const Port &port);
+  /**
+   * \brief Drop the tree of a source
+   * \param source the id of the source node
+   */
+  void DropTree (uint32_t source);
+  /**
+   * \brief Get the tree of a source, computing it if needed
+   * \param source the id of the source node
+   * \return the tree
+   */
+  const Tree* GetTree (uint32_t source);
+  /**
+   * \brief Breadth first search from a source
+   *
+   * This method only reads the graph, hence it can be run by several
+   * threads at a time.
+   *
+   * \param source the id of the source node
+   * \param firstPort the only port to use from the source (-1 for all)
+   * \param tree the tree to fill
+   */
+  void ComputeTree (uint32_t source, int32_t firstPort, Tree &tree) const;
+  /**
+   * \brief Compute the trees of the pending sources (body of the threads)
+   */
+  void ProcessPendingSources (void);
+  /**
+   * \brief Clear the cache when the simulation is destroyed
+   */
+  void Clear (void);
+
+  Family m_family;                                  //!< the address family
+  std::vector<Vertex> m_vertices;                   //!< the graph, indexed by node id
+  std::vector<Tree*> m_trees;                       //!< the trees, indexed by source id (null if not computed)
+  std::vector<uint32_t> m_treeVersions;             //!< the number of times the tree of each source was dropped
+  uint32_t m_epoch;                                 //!< incremented when all the trees are dropped or an address changes
+  uint32_t m_version;                               //!< incremented when any tree is dropped or an address changes
+  std::set<uint32_t> m_dirtyNodes;                  //!< the nodes whose interfaces changed
+  bool m_addressesDirty;                            //!< whether the addresses changed
+  std::unordered_map<Ipv4Address, uint32_t, Ipv4AddressHash> m_ipv4Nodes;  //!< the node of each IPv4 address
+  std::unordered_map<Ipv6Address, uint32_t, Ipv6AddressHash> m_ipv6Nodes;  //!< the node of each IPv6 address
+  bool m_destroyScheduled;                          //!< whether Clear is scheduled at the end of the simulation
+  uint32_t m_nTreesComputed;                        //!< the number of trees computed
+  std::vector<uint32_t> m_pendingSources;           //!< the sources whose tree is computed by the threads
+  uint32_t m_nextSource;                            //!< the next pending source to process
+#ifdef HAVE_PTHREAD_H
+  SystemMutex m_pendingMutex;                       //!< protects m_nextSource
+#endif
+};
+
+} // namespace ns3
+
+#endif /* NIX_VECTOR_TREE_CACHE_H */
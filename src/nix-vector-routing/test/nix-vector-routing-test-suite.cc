@@ -0,0 +1,357 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/node-container.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/simple-channel.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv6-address-helper.h"
+#include "ns3/ipv4.h"
+#include "ns3/ipv6.h"
+#include "ns3/socket.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/inet6-socket-address.h"
+#include "ns3/ipv4-nix-vector-helper.h"
+#include "ns3/ipv6-nix-vector-helper.h"
+#include "ns3/nix-vector-tree-cache.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup nix-vector-routing
+ * \defgroup nix-vector-routing-test Nix-vector routing module tests
+ */
+
+/**
+ * \ingroup nix-vector-routing-test
+ * \ingroup tests
+ *
+ * \brief Nix-vector tree cache Test
+ *
+ * A random topology of point-to-point links and shared channels is built.
+ * The nix-vectors between all the pairs of nodes given by the cache, whose
+ * trees are kept and dropped as the interfaces go down and up, must be
+ * those computed from scratch after a flush, and those computed by
+ * several threads must be those computed by a single one.  Packets must
+ * also be delivered by the routing protocol before and after an interface
+ * of their source goes down.
+ */
+class NixVectorTreeCacheTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor
+   * \param family the address family of the cache and of the routing
+   */
+  NixVectorTreeCacheTestCase (NixVectorTreeCache::Family family);
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Get the nix-vectors between all the pairs of distinct nodes
+   * \param cache the cache
+   * \returns the nix-vectors, printed, "-" standing for an unreachable node
+   */
+  std::vector<std::string> GetNixVectors (NixVectorTreeCache *cache) const;
+
+  /**
+   * \brief Set the state of the first interface of a node
+   * \param node the node
+   * \param up true to set the interface up, false to set it down
+   */
+  void SetInterface (Ptr<Node> node, bool up);
+
+  /**
+   * \brief Send a packet from the source socket
+   * \param socket the socket
+   */
+  void SendPacket (Ptr<Socket> socket);
+
+  /**
+   * \brief Receive the packets of the destination socket
+   * \param socket the socket
+   */
+  void ReceivePacket (Ptr<Socket> socket);
+
+  NixVectorTreeCache::Family m_family; //!< address family
+  uint32_t m_nNodes;                   //!< number of nodes
+  uint32_t m_received;                 //!< number of packets received
+};
+
+NixVectorTreeCacheTestCase::NixVectorTreeCacheTestCase (NixVectorTreeCache::Family family)
+  : TestCase (family == NixVectorTreeCache::IPV4 ? "IPv4 nix-vector tree cache" : "IPv6 nix-vector tree cache"),
+    m_family (family),
+    m_nNodes (30),
+    m_received (0)
+{
+}
+
+std::vector<std::string>
+NixVectorTreeCacheTestCase::GetNixVectors (NixVectorTreeCache *cache) const
+{
+  std::vector<std::string> nixVectors;
+  for (uint32_t source = 0; source < m_nNodes; source++)
+    {
+      for (uint32_t dest = 0; dest < m_nNodes; dest++)
+        {
+          if (source == dest)
+            {
+              continue;
+            }
+          Ptr<NixVector> nixVector = cache->BuildNixVector (source, dest, 0);
+          std::ostringstream oss;
+          if (nixVector)
+            {
+              oss << *nixVector;
+            }
+          else
+            {
+              oss << "-";
+            }
+          nixVectors.push_back (oss.str ());
+        }
+    }
+  return nixVectors;
+}
+
+void
+NixVectorTreeCacheTestCase::SetInterface (Ptr<Node> node, bool up)
+{
+  if (m_family == NixVectorTreeCache::IPV4)
+    {
+      Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+      if (up)
+        {
+          ipv4->SetUp (1);
+        }
+      else
+        {
+          ipv4->SetDown (1);
+        }
+    }
+  else
+    {
+      Ptr<Ipv6> ipv6 = node->GetObject<Ipv6> ();
+      if (up)
+        {
+          ipv6->SetUp (1);
+        }
+      else
+        {
+          ipv6->SetDown (1);
+        }
+    }
+}
+
+void
+NixVectorTreeCacheTestCase::SendPacket (Ptr<Socket> socket)
+{
+  socket->Send (Create<Packet> (100));
+}
+
+void
+NixVectorTreeCacheTestCase::ReceivePacket (Ptr<Socket> socket)
+{
+  while (socket->Recv ())
+    {
+      m_received++;
+    }
+}
+
+void
+NixVectorTreeCacheTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (m_nNodes);
+
+  // a ring, so that the nodes stay connected when a link goes down, with
+  // random chords and a few shared channels
+  SimpleNetDeviceHelper simple;
+  std::vector<NetDeviceContainer> links;
+  for (uint32_t i = 0; i < m_nNodes; i++)
+    {
+      links.push_back (simple.Install (NodeContainer (nodes.Get (i), nodes.Get ((i + 1) % m_nNodes))));
+    }
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  random->SetStream (1);
+  for (uint32_t i = 0; i < m_nNodes / 2; i++)
+    {
+      uint32_t a = random->GetInteger (0, m_nNodes - 1);
+      uint32_t b = random->GetInteger (0, m_nNodes - 1);
+      if (a != b)
+        {
+          links.push_back (simple.Install (NodeContainer (nodes.Get (a), nodes.Get (b))));
+        }
+    }
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      NodeContainer lan;
+      uint32_t first = random->GetInteger (0, m_nNodes - 1);
+      for (uint32_t j = 0; j < 4; j++)
+        {
+          lan.Add (nodes.Get ((first + 7 * j) % m_nNodes));
+        }
+      links.push_back (simple.Install (lan));
+    }
+
+  InternetStackHelper internet;
+  Ipv4NixVectorHelper ipv4Nix;
+  Ipv6NixVectorHelper ipv6Nix;
+  if (m_family == NixVectorTreeCache::IPV4)
+    {
+      internet.SetIpv6StackInstall (false);
+      internet.SetRoutingHelper (ipv4Nix);
+    }
+  else
+    {
+      internet.SetIpv4StackInstall (false);
+      internet.SetRoutingHelper (ipv6Nix);
+    }
+  internet.Install (nodes);
+
+  Ipv4AddressHelper ipv4Addresses ("10.0.0.0", "255.255.255.0");
+  Ipv6AddressHelper ipv6Addresses (Ipv6Address ("2001:1::"), Ipv6Prefix (64));
+  for (uint32_t i = 0; i < links.size (); i++)
+    {
+      if (m_family == NixVectorTreeCache::IPV4)
+        {
+          ipv4Addresses.Assign (links[i]);
+          ipv4Addresses.NewNetwork ();
+        }
+      else
+        {
+          Ipv6InterfaceContainer interfaces = ipv6Addresses.Assign (links[i]);
+          for (uint32_t j = 0; j < interfaces.GetN (); j++)
+            {
+              interfaces.SetForwarding (j, true);
+            }
+          ipv6Addresses.NewNetwork ();
+        }
+    }
+
+  NixVectorTreeCache *cache = NixVectorTreeCache::Get (m_family);
+  cache->Flush ();
+  uint32_t nTrees = cache->GetNTreesComputed ();
+
+  // the trees are computed once, then reused
+  std::vector<std::string> initial = GetNixVectors (cache);
+  NS_TEST_EXPECT_MSG_EQ (cache->GetNTreesComputed (), nTrees + m_nNodes, "One tree per source should be computed");
+  uint32_t nUnreachable = 0;
+  for (uint32_t i = 0; i < initial.size (); i++)
+    {
+      nUnreachable += initial[i] == "-";
+    }
+  NS_TEST_EXPECT_MSG_EQ (nUnreachable, 0, "All the nodes should be reachable");
+  NS_TEST_EXPECT_MSG_EQ ((GetNixVectors (cache) == initial), true, "The cached nix-vectors should not change");
+  NS_TEST_EXPECT_MSG_EQ (cache->GetNTreesComputed (), nTrees + m_nNodes, "No tree should be computed again");
+
+  // node 0 loses its link to node 1: the trees using that link are
+  // dropped, and the nix-vectors must match those computed from scratch
+  uint32_t version = cache->GetTreeVersion (0);
+  SetInterface (nodes.Get (0), false);
+  std::vector<std::string> down = GetNixVectors (cache);
+  NS_TEST_EXPECT_MSG_NE (cache->GetTreeVersion (0), version, "The tree of node 0 should be dropped");
+  NS_TEST_EXPECT_MSG_EQ ((down != initial), true, "The nix-vectors should change when the link goes down");
+  NS_TEST_EXPECT_MSG_LT (cache->GetNTreesComputed (), nTrees + 2 * m_nNodes, "Only some trees should be computed again");
+  cache->Flush ();
+  NS_TEST_EXPECT_MSG_EQ ((GetNixVectors (cache) == down), true,
+                         "The cached nix-vectors should match the uncached ones after the link goes down");
+
+  // the link comes back up
+  SetInterface (nodes.Get (0), true);
+  std::vector<std::string> up = GetNixVectors (cache);
+  NS_TEST_EXPECT_MSG_EQ ((up == initial), true, "The nix-vectors should be restored when the link comes back up");
+  cache->Flush ();
+  NS_TEST_EXPECT_MSG_EQ ((GetNixVectors (cache) == up), true,
+                         "The cached nix-vectors should match the uncached ones after the link comes back up");
+
+  // trees precomputed by one thread, then by several
+  cache->Flush ();
+  nTrees = cache->GetNTreesComputed ();
+  cache->Precompute (nodes, 1);
+  NS_TEST_EXPECT_MSG_EQ (cache->GetNTreesComputed (), nTrees + m_nNodes, "One tree per source should be precomputed");
+  std::vector<std::string> sequential = GetNixVectors (cache);
+  NS_TEST_EXPECT_MSG_EQ (cache->GetNTreesComputed (), nTrees + m_nNodes, "No tree should be computed on demand");
+  NS_TEST_EXPECT_MSG_EQ ((sequential == initial), true, "The precomputed nix-vectors should match the computed ones");
+  cache->Flush ();
+  SetInterface (nodes.Get (0), false);
+  cache->Precompute (nodes, 4);
+  NS_TEST_EXPECT_MSG_EQ ((GetNixVectors (cache) == down), true,
+                         "The nix-vectors precomputed by several threads should match those of a single one");
+  SetInterface (nodes.Get (0), true);
+  cache->Precompute (nodes, 4);
+  NS_TEST_EXPECT_MSG_EQ ((GetNixVectors (cache) == initial), true,
+                         "The nix-vectors precomputed by several threads should follow the link state");
+
+  // the routing delivers packets from node 0 to node 1, before and after
+  // the link between them goes down
+  Ptr<Socket> sink = Socket::CreateSocket (nodes.Get (1), UdpSocketFactory::GetTypeId ());
+  sink->SetRecvCallback (MakeCallback (&NixVectorTreeCacheTestCase::ReceivePacket, this));
+  Ptr<Socket> source = Socket::CreateSocket (nodes.Get (0), UdpSocketFactory::GetTypeId ());
+  if (m_family == NixVectorTreeCache::IPV4)
+    {
+      sink->Bind (InetSocketAddress (Ipv4Address::GetAny (), 9));
+      Ipv4Address dest = nodes.Get (1)->GetObject<Ipv4> ()->GetAddress (2, 0).GetLocal ();
+      source->Connect (InetSocketAddress (dest, 9));
+    }
+  else
+    {
+      sink->Bind (Inet6SocketAddress (Ipv6Address::GetAny (), 9));
+      // the global address of the link to node 2, as node 1 is no longer
+      // a neighbor of node 0 on the link between them
+      Ipv6Address dest = nodes.Get (1)->GetObject<Ipv6> ()->GetAddress (2, 1).GetAddress ();
+      source->Connect (Inet6SocketAddress (dest, 9));
+    }
+  Simulator::Schedule (Seconds (2), &NixVectorTreeCacheTestCase::SendPacket, this, source);
+  Simulator::Schedule (Seconds (3), &NixVectorTreeCacheTestCase::SetInterface, this, nodes.Get (0), false);
+  Simulator::Schedule (Seconds (4), &NixVectorTreeCacheTestCase::SendPacket, this, source);
+  Simulator::Stop (Seconds (5));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_received, 2, "Both packets should be received");
+}
+
+/**
+ * \ingroup nix-vector-routing-test
+ * \ingroup tests
+ *
+ * \brief Nix-vector routing TestSuite
+ */
+class NixVectorRoutingTestSuite : public TestSuite
+{
+public:
+  NixVectorRoutingTestSuite ();
+};
+
+NixVectorRoutingTestSuite::NixVectorRoutingTestSuite ()
+  : TestSuite ("nix-vector-routing", UNIT)
+{
+  AddTestCase (new NixVectorTreeCacheTestCase (NixVectorTreeCache::IPV4), TestCase::QUICK);
+  AddTestCase (new NixVectorTreeCacheTestCase (NixVectorTreeCache::IPV6), TestCase::QUICK);
+}
+
+static NixVectorRoutingTestSuite g_nixVectorRoutingTestSuite; //!< Static variable for test initialization
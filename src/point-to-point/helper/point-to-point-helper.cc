@@ -26,6 +26,7 @@
 #include "ns3/point-to-point-remote-channel.h"
 #include "ns3/queue.h"
 #include "ns3/net-device-queue-interface.h"
+#include "ns3/uinteger.h"
 #include "ns3/config.h"
 #include "ns3/packet.h"
 #include "ns3/names.h"
@@ -40,6 +41,7 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("PointToPointHelper");
 
 PointToPointHelper::PointToPointHelper ()
+  : m_nTxQueues (1)
 {
   m_queueFactory.SetTypeId ("ns3::DropTailQueue<Packet>");
   m_deviceFactory.SetTypeId ("ns3::PointToPointNetDevice");
@@ -69,6 +71,33 @@ PointToPointHelper::SetDeviceAttribute (std::string n1, const AttributeValue &v1
   m_deviceFactory.Set (n1, v1);
 }
 
+void
+PointToPointHelper::SetNTxQueues (std::size_t nTxQueues)
+{
+  NS_ABORT_MSG_IF (nTxQueues < 1 || nTxQueues > 256, "Invalid number of transmission queues");
+  m_nTxQueues = nTxQueues;
+}
+
+void
+PointToPointHelper::InstallTxQueues (Ptr<PointToPointNetDevice> device)
+{
+  Ptr<NetDeviceQueueInterface> ndqi = CreateObjectWithAttributes<NetDeviceQueueInterface> ("NTxQueues",
+                                                                                          UintegerValue (m_nTxQueues));
+  for (std::size_t i = 0; i < m_nTxQueues; i++)
+    {
+      Ptr<Queue<Packet> > queue = m_queueFactory.Create<Queue<Packet> > ();
+      device->AddTxQueue (queue);
+      ndqi->GetTxQueue (i)->ConnectQueueTraces (queue);
+    }
+  if (m_nTxQueues > 1)
+    {
+      std::size_t nTxQueues = m_nTxQueues;
+      ndqi->SetSelectQueueCallback ([nTxQueues] (Ptr<QueueItem> item)
+                                    { return PointToPointNetDevice::SelectTxQueue (item, nTxQueues); });
+    }
+  device->AggregateObject (ndqi);
+}
+
 void 
 PointToPointHelper::SetChannelAttribute (std::string n1, const AttributeValue &v1)
 {
@@ -170,10 +199,13 @@ PointToPointHelper::EnableAsciiInternal (
       // The "+", '-', and 'd' events are driven by trace sources actually in the
       // transmit queue.
       //
-      Ptr<Queue<Packet> > queue = device->GetQueue ();
-      asciiTraceHelper.HookDefaultEnqueueSinkWithoutContext<Queue<Packet> > (queue, "Enqueue", theStream);
-      asciiTraceHelper.HookDefaultDropSinkWithoutContext<Queue<Packet> > (queue, "Drop", theStream);
-      asciiTraceHelper.HookDefaultDequeueSinkWithoutContext<Queue<Packet> > (queue, "Dequeue", theStream);
+      for (std::size_t i = 0; i < device->GetNTxQueues (); i++)
+        {
+          Ptr<Queue<Packet> > queue = device->GetTxQueue (i);
+          asciiTraceHelper.HookDefaultEnqueueSinkWithoutContext<Queue<Packet> > (queue, "Enqueue", theStream);
+          asciiTraceHelper.HookDefaultDropSinkWithoutContext<Queue<Packet> > (queue, "Drop", theStream);
+          asciiTraceHelper.HookDefaultDequeueSinkWithoutContext<Queue<Packet> > (queue, "Dequeue", theStream);
+        }
 
       // PhyRxDrop trace source for "d" event
       asciiTraceHelper.HookDefaultDropSinkWithoutContext<PointToPointNetDevice> (device, "PhyRxDrop", theStream);
@@ -232,20 +264,12 @@ PointToPointHelper::Install (Ptr<Node> a, Ptr<Node> b)
   Ptr<PointToPointNetDevice> devA = m_deviceFactory.Create<PointToPointNetDevice> ();
   devA->SetAddress (Mac48Address::Allocate ());
   a->AddDevice (devA);
-  Ptr<Queue<Packet> > queueA = m_queueFactory.Create<Queue<Packet> > ();
-  devA->SetQueue (queueA);
   Ptr<PointToPointNetDevice> devB = m_deviceFactory.Create<PointToPointNetDevice> ();
   devB->SetAddress (Mac48Address::Allocate ());
   b->AddDevice (devB);
-  Ptr<Queue<Packet> > queueB = m_queueFactory.Create<Queue<Packet> > ();
-  devB->SetQueue (queueB);
-  // Aggregate NetDeviceQueueInterface objects
-  Ptr<NetDeviceQueueInterface> ndqiA = CreateObject<NetDeviceQueueInterface> ();
-  ndqiA->GetTxQueue (0)->ConnectQueueTraces (queueA);
-  devA->AggregateObject (ndqiA);
-  Ptr<NetDeviceQueueInterface> ndqiB = CreateObject<NetDeviceQueueInterface> ();
-  ndqiB->GetTxQueue (0)->ConnectQueueTraces (queueB);
-  devB->AggregateObject (ndqiB);
+  // Create the transmission queues and aggregate NetDeviceQueueInterface objects
+  InstallTxQueues (devA);
+  InstallTxQueues (devB);
 
   // If MPI is enabled, we need to see if both nodes have the same system id 
   // (rank), and the rank is the same as this instance.  If both are true, 
@@ -32,6 +32,7 @@ namespace ns3 {
 
 class NetDevice;
 class Node;
+class PointToPointNetDevice;
 
 /**
  * \brief Build a set of PointToPointNetDevice objects
@@ -87,6 +88,20 @@ public:
    */
   void SetDeviceAttribute (std::string name, const AttributeValue &value);
 
+  /**
+   * Set the number of transmission queues of the devices.
+   *
+   * \param nTxQueues the number of transmission queues (between 1 and 256)
+   *
+   * Each PointToPointNetDevice created by PointToPointHelper::Install is
+   * given this number of queues (of the type set by SetQueue) and a
+   * NetDeviceQueueInterface with as many device transmission queues, whose
+   * select queue callback is PointToPointNetDevice::SelectTxQueue. Each
+   * transmission queue can then be managed by a distinct child queue disc of
+   * an mq queue disc. The default is a single transmission queue.
+   */
+  void SetNTxQueues (std::size_t nTxQueues);
+
   /**
    * Set an attribute value to be propagated to each Channel created by the
    * helper.
@@ -157,6 +172,13 @@ private:
    * NetDevice-specific implementation mechanism for hooking the trace and
    * writing to the trace file.
    *
+   * The pcap traces are fed by the PromiscSniffer trace source of the
+   * device. When the device sends trains of packets (see the MaxTrainSize
+   * attribute of PointToPointNetDevice), all the packets of a train are
+   * written when the train starts (transmit side) or when its last bit
+   * arrives (receive side); the exact per-packet times are reported by the
+   * PhyTxTrain and PhyRxTrain trace sources of the device.
+   *
    * \param prefix Filename prefix to use for pcap files.
    * \param nd Net device for which you want to enable tracing.
    * \param promiscuous If true capture all possible packets available at the device.
@@ -181,10 +203,19 @@ private:
     Ptr<NetDevice> nd,
     bool explicitFilename);
 
+  /**
+   * \brief Create the transmission queues of a device and aggregate a
+   *        NetDeviceQueueInterface to it
+   *
+   * \param device the device
+   */
+  void InstallTxQueues (Ptr<PointToPointNetDevice> device);
+
   ObjectFactory m_queueFactory;         //!< Queue Factory
   ObjectFactory m_channelFactory;       //!< Channel Factory
   ObjectFactory m_remoteChannelFactory; //!< Remote Channel Factory
   ObjectFactory m_deviceFactory;        //!< Device Factory
+  std::size_t m_nTxQueues;              //!< Number of transmission queues of the devices
 };
 
 } // namespace ns3
@@ -106,6 +106,44 @@ PointToPointChannel::TransmitStart (
   return true;
 }
 
+bool
+PointToPointChannel::TransmitTrainStart (const std::vector<Ptr<Packet> > &packets,
+                                         Ptr<PointToPointNetDevice> src,
+                                         const std::vector<Time> &txStartTimes,
+                                         const std::vector<Time> &txEndTimes)
+{
+  NS_LOG_FUNCTION (this << packets.size () << src);
+  NS_ASSERT (packets.size () == txStartTimes.size () && packets.size () == txEndTimes.size ()
+             && !packets.empty ());
+
+  NS_ASSERT (m_link[0].m_state != INITIALIZING);
+  NS_ASSERT (m_link[1].m_state != INITIALIZING);
+
+  uint32_t wire = src == m_link[0].m_src ? 0 : 1;
+
+  std::vector<Ptr<Packet> > copies;
+  std::vector<Time> rxTimes;
+  copies.reserve (packets.size ());
+  rxTimes.reserve (packets.size ());
+
+  for (std::size_t i = 0; i < packets.size (); i++)
+    {
+      NS_LOG_LOGIC ("UID is " << packets[i]->GetUid () << ")");
+      copies.push_back (packets[i]->Copy ());
+      rxTimes.push_back (Simulator::Now () + txEndTimes[i] + m_delay);
+
+      // Call the tx anim callback on the net device, with the transmission
+      // time of the packet, as for a packet sent alone
+      m_txrxPointToPoint (packets[i], src, m_link[wire].m_dst, txEndTimes[i] - txStartTimes[i],
+                          txEndTimes[i] + m_delay);
+    }
+
+  Simulator::ScheduleWithContext (m_link[wire].m_dst->GetNode ()->GetId (),
+                                  txEndTimes.back () + m_delay, &PointToPointNetDevice::ReceiveTrain,
+                                  m_link[wire].m_dst, copies, rxTimes);
+  return true;
+}
+
 std::size_t
 PointToPointChannel::GetNDevices (void) const
 {
@@ -20,6 +20,7 @@
 #define POINT_TO_POINT_CHANNEL_H
 
 #include <list>
+#include <vector>
 #include "ns3/channel.h"
 #include "ns3/ptr.h"
 #include "ns3/nstime.h"
@@ -80,6 +81,26 @@ public:
    */
   virtual bool TransmitStart (Ptr<const Packet> p, Ptr<PointToPointNetDevice> src, Time txTime);
 
+  /**
+   * \brief Transmit a train of back-to-back packets over this channel
+   *
+   * The packets are delivered to the destination device with a single event,
+   * scheduled when the last bit of the last packet arrives. The destination
+   * device is given the exact time at which each packet arrived.
+   *
+   * \param packets the packets to transmit
+   * \param src Source PointToPointNetDevice
+   * \param txStartTimes the time (relative to now) at which the transmission
+   *        of each packet starts
+   * \param txEndTimes the time (relative to now) at which the transmission
+   *        of each packet completes
+   * \returns true if successful (currently always true)
+   */
+  virtual bool TransmitTrainStart (const std::vector<Ptr<Packet> > &packets,
+                                   Ptr<PointToPointNetDevice> src,
+                                   const std::vector<Time> &txStartTimes,
+                                   const std::vector<Time> &txEndTimes);
+
   /**
    * \brief Get number of devices on this channel
    * \returns number of devices on this channel
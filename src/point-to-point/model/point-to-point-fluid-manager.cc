@@ -0,0 +1,487 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "point-to-point-fluid-manager.h"
+#include "point-to-point-net-device.h"
+#include "point-to-point-channel.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include "ns3/object-map.h"
+#include "ns3/trace-source-accessor.h"
+#include "ns3/log.h"
+#include <cmath>
+#include <limits>
+#include <list>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PointToPointFluidManager");
+
+NS_OBJECT_ENSURE_REGISTERED (PointToPointFluidManager);
+
+TypeId
+PointToPointFluidManager::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::PointToPointFluidManager")
+    .SetParent<Object> ()
+    .SetGroupName ("PointToPoint")
+    .AddConstructor<PointToPointFluidManager> ()
+    .AddAttribute ("SegmentSize",
+                   "The number of payload bytes carried by each segment of a flow",
+                   UintegerValue (1448),
+                   MakeUintegerAccessor (&PointToPointFluidManager::m_segmentSize),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("HeaderSize",
+                   "The number of header bytes (TCP, IP and PPP) added to each segment",
+                   UintegerValue (54),
+                   MakeUintegerAccessor (&PointToPointFluidManager::m_headerSize),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("StartupRtts",
+                   "The number of round trip times needed to establish a connection "
+                   "before data is transferred",
+                   DoubleValue (1.0),
+                   MakeDoubleAccessor (&PointToPointFluidManager::m_startupRtts),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("LoadInterval",
+                   "The interval over which the packet-level load of the links crossed "
+                   "by fluid flows is measured. At the end of each interval, the capacity "
+                   "left by the packet-level traffic is shared among the fluid flows. "
+                   "A null interval disables the measurement.",
+                   TimeValue (MilliSeconds (100)),
+                   MakeTimeAccessor (&PointToPointFluidManager::m_loadInterval),
+                   MakeTimeChecker (Seconds (0)))
+    .AddTraceSource ("FlowCompleted",
+                     "A fluid flow has been completely received by the destination",
+                     MakeTraceSourceAccessor (&PointToPointFluidManager::m_flowCompletedTrace),
+                     "ns3::PointToPointFluidManager::FlowCompletedTracedCallback")
+  ;
+  return tid;
+}
+
+PointToPointFluidManager::PointToPointFluidManager ()
+  : m_nextFlowId (1),
+    m_lastUpdate (Seconds (0)),
+    m_lastMeasurement (Seconds (0))
+{
+  NS_LOG_FUNCTION (this);
+  m_packetLevelQueueDiscs.insert ("ns3::RedQueueDisc");
+  m_packetLevelQueueDiscs.insert ("ns3::CoDelQueueDisc");
+  m_packetLevelQueueDiscs.insert ("ns3::FqCoDelQueueDisc");
+  m_packetLevelQueueDiscs.insert ("ns3::PieQueueDisc");
+  m_packetLevelQueueDiscs.insert ("ns3::CakeQueueDisc");
+}
+
+PointToPointFluidManager::~PointToPointFluidManager ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+PointToPointFluidManager::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_completionEvent.Cancel ();
+  m_loadEvent.Cancel ();
+  for (auto& link : m_linkLoads)
+    {
+      link.first->TraceDisconnectWithoutContext ("PhyTxBegin",
+                                                 MakeBoundCallback (&PointToPointFluidManager::PacketSent,
+                                                                    &link.second));
+    }
+  m_linkLoads.clear ();
+  m_flows.clear ();
+  m_packetLevelFlowCallback = MakeNullCallback<void, uint32_t, Ptr<Node>, Ptr<Node>, uint64_t> ();
+  Object::DoDispose ();
+}
+
+void
+PointToPointFluidManager::SetPacketLevelFlowCallback (PacketLevelFlowCallback cb)
+{
+  NS_LOG_FUNCTION (this);
+  m_packetLevelFlowCallback = cb;
+}
+
+void
+PointToPointFluidManager::AddPacketLevelQueueDisc (std::string typeName)
+{
+  NS_LOG_FUNCTION (this << typeName);
+  m_packetLevelQueueDiscs.insert (typeName);
+}
+
+uint32_t
+PointToPointFluidManager::AddFlow (Ptr<Node> src, Ptr<Node> dst, uint64_t bytes)
+{
+  NS_LOG_FUNCTION (this << src << dst << bytes);
+
+  uint32_t flowId = m_nextFlowId++;
+  Flow flow;
+
+  if (!FindPath (src, dst, flow.path))
+    {
+      NS_LOG_LOGIC ("Flow " << flowId << " is modeled at the packet level");
+      if (!m_packetLevelFlowCallback.IsNull ())
+        {
+          m_packetLevelFlowCallback (flowId, src, dst, bytes);
+        }
+      return flowId;
+    }
+
+  flow.startTime = Simulator::Now ();
+  flow.delay = Seconds (0);
+  for (auto& link : flow.path)
+    {
+      TimeValue delay;
+      link->GetChannel ()->GetAttribute ("Delay", delay);
+      flow.delay += delay.Get ();
+      MonitorLink (link);
+    }
+  uint64_t nSegments = (bytes + m_segmentSize - 1) / m_segmentSize;
+  flow.remaining = 8.0 * (bytes + nSegments * m_headerSize);
+  flow.rate = 0;
+  flow.active = false;
+  m_flows[flowId] = flow;
+
+  if (m_loadInterval.IsStrictlyPositive () && !m_loadEvent.IsRunning ())
+    {
+      // the bytes sent while no fluid flow was in progress are not counted
+      for (auto& link : m_linkLoads)
+        {
+          link.second.txBytes = 0;
+        }
+      m_lastMeasurement = Simulator::Now ();
+      m_loadEvent = Simulator::Schedule (m_loadInterval, &PointToPointFluidManager::MeasureLoad, this);
+    }
+
+  NS_LOG_LOGIC ("Flow " << flowId << " crosses " << flow.path.size () << " links");
+  Time startup = Seconds (2 * m_startupRtts * flow.delay.GetSeconds ());
+  Simulator::Schedule (startup, &PointToPointFluidManager::ActivateFlow, this, flowId);
+  return flowId;
+}
+
+bool
+PointToPointFluidManager::IsFluidFlow (uint32_t flowId) const
+{
+  return m_flows.find (flowId) != m_flows.end ();
+}
+
+uint32_t
+PointToPointFluidManager::GetNActiveFlows (void) const
+{
+  uint32_t n = 0;
+  for (auto& flow : m_flows)
+    {
+      n += (flow.second.active ? 1 : 0);
+    }
+  return n;
+}
+
+double
+PointToPointFluidManager::GetFlowRate (uint32_t flowId) const
+{
+  auto it = m_flows.find (flowId);
+  NS_ASSERT_MSG (it != m_flows.end (), "Flow " << flowId << " is not a fluid flow in progress");
+  return it->second.rate;
+}
+
+bool
+PointToPointFluidManager::FindPath (Ptr<Node> src, Ptr<Node> dst, std::vector<Link> &path) const
+{
+  NS_LOG_FUNCTION (this << src << dst);
+
+  // Breadth-first search over the point-to-point links, storing for each
+  // node the link used to reach it
+  std::map<Ptr<Node>, Link> parent;
+  std::list<Ptr<Node> > toVisit;
+  parent[src] = 0;
+  toVisit.push_back (src);
+
+  while (!toVisit.empty () && parent.find (dst) == parent.end ())
+    {
+      Ptr<Node> node = toVisit.front ();
+      toVisit.pop_front ();
+
+      for (uint32_t i = 0; i < node->GetNDevices (); i++)
+        {
+          Ptr<PointToPointNetDevice> dev = DynamicCast<PointToPointNetDevice> (node->GetDevice (i));
+          if (dev == 0 || dev->GetChannel () == 0 || dev->GetChannel ()->GetNDevices () != 2)
+            {
+              continue;
+            }
+          Ptr<Channel> channel = dev->GetChannel ();
+          Ptr<NetDevice> peer = channel->GetDevice (channel->GetDevice (0) == dev ? 1 : 0);
+          Ptr<Node> neighbor = peer->GetNode ();
+          if (parent.find (neighbor) == parent.end ())
+            {
+              parent[neighbor] = dev;
+              toVisit.push_back (neighbor);
+            }
+        }
+    }
+
+  if (src == dst || parent.find (dst) == parent.end ())
+    {
+      return false;
+    }
+
+  path.clear ();
+  for (Ptr<Node> node = dst; node != src; node = parent[node]->GetNode ())
+    {
+      if (!IsFluidLink (parent[node]))
+        {
+          return false;
+        }
+      path.insert (path.begin (), parent[node]);
+    }
+  return true;
+}
+
+bool
+PointToPointFluidManager::IsFluidLink (Link link) const
+{
+  // The point-to-point module does not depend on the traffic-control module,
+  // hence the root queue disc is retrieved through the attribute system
+  TypeId tcTid;
+  if (!TypeId::LookupByNameFailSafe ("ns3::TrafficControlLayer", &tcTid))
+    {
+      return true;
+    }
+  Ptr<Object> tc = link->GetNode ()->GetObject<Object> (tcTid);
+  if (tc == 0)
+    {
+      return true;
+    }
+  ObjectMapValue qdiscs;
+  tc->GetAttribute ("RootQueueDiscList", qdiscs);
+  Ptr<Object> qdisc = qdiscs.Get (link->GetIfIndex ());
+  if (qdisc == 0)
+    {
+      return true;
+    }
+  std::string name = qdisc->GetInstanceTypeId ().GetName ();
+  NS_LOG_LOGIC ("Link " << link << " is managed by a " << name);
+  return m_packetLevelQueueDiscs.find (name) == m_packetLevelQueueDiscs.end ();
+}
+
+void
+PointToPointFluidManager::MonitorLink (Link link)
+{
+  NS_LOG_FUNCTION (this << link);
+
+  if (m_linkLoads.find (link) != m_linkLoads.end ())
+    {
+      return;
+    }
+  LinkLoad &linkLoad = m_linkLoads[link];
+  linkLoad.txBytes = 0;
+  linkLoad.load = 0;
+  link->TraceConnectWithoutContext ("PhyTxBegin",
+                                    MakeBoundCallback (&PointToPointFluidManager::PacketSent, &linkLoad));
+}
+
+void
+PointToPointFluidManager::PacketSent (LinkLoad *linkLoad, Ptr<const Packet> packet)
+{
+  linkLoad->txBytes += packet->GetSize ();
+}
+
+void
+PointToPointFluidManager::MeasureLoad (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  UpdateRemaining ();
+
+  double interval = (Simulator::Now () - m_lastMeasurement).GetSeconds ();
+  m_lastMeasurement = Simulator::Now ();
+  for (auto& link : m_linkLoads)
+    {
+      link.second.load = (interval > 0 ? 8.0 * link.second.txBytes / interval : 0);
+      link.second.txBytes = 0;
+      NS_LOG_LOGIC ("Packet-level load of link " << link.first << ": " << link.second.load << "bps");
+    }
+
+  Reallocate ();
+
+  if (!m_flows.empty ())
+    {
+      m_loadEvent = Simulator::Schedule (m_loadInterval, &PointToPointFluidManager::MeasureLoad, this);
+    }
+}
+
+void
+PointToPointFluidManager::ActivateFlow (uint32_t flowId)
+{
+  NS_LOG_FUNCTION (this << flowId);
+
+  auto it = m_flows.find (flowId);
+  NS_ASSERT (it != m_flows.end ());
+
+  UpdateRemaining ();
+  it->second.active = true;
+  Reallocate ();
+}
+
+void
+PointToPointFluidManager::UpdateRemaining (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  double elapsed = (Simulator::Now () - m_lastUpdate).GetSeconds ();
+  m_lastUpdate = Simulator::Now ();
+
+  for (auto& flow : m_flows)
+    {
+      if (flow.second.active)
+        {
+          flow.second.remaining = std::max (flow.second.remaining - flow.second.rate * elapsed, 0.0);
+        }
+    }
+}
+
+void
+PointToPointFluidManager::Reallocate (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  // Max-min fair allocation by progressive filling: the flows crossing the
+  // link offering the smallest fair share are assigned that share and then
+  // removed, along with the capacity they use, until all flows are assigned.
+  // The capacity of a link is what is left by the packet-level traffic
+  std::map<Link, double> capacity;
+  std::map<Link, uint32_t> nFlows;
+  std::set<uint32_t> unassigned;
+
+  for (auto& flow : m_flows)
+    {
+      if (!flow.second.active)
+        {
+          continue;
+        }
+      unassigned.insert (flow.first);
+      for (auto& link : flow.second.path)
+        {
+          if (capacity.find (link) == capacity.end ())
+            {
+              DataRateValue rate;
+              link->GetAttribute ("DataRate", rate);
+              capacity[link] = std::max (rate.Get ().GetBitRate () - m_linkLoads[link].load, 0.0);
+            }
+          nFlows[link]++;
+        }
+    }
+
+  while (!unassigned.empty ())
+    {
+      double share = std::numeric_limits<double>::max ();
+      for (auto& link : nFlows)
+        {
+          if (link.second > 0)
+            {
+              share = std::min (share, capacity[link.first] / link.second);
+            }
+        }
+
+      std::set<Link> bottlenecks;
+      for (auto& link : nFlows)
+        {
+          if (link.second > 0 && capacity[link.first] / link.second <= share * (1 + 1e-12))
+            {
+              bottlenecks.insert (link.first);
+            }
+        }
+
+      for (auto it = unassigned.begin (); it != unassigned.end (); )
+        {
+          Flow &flow = m_flows[*it];
+          bool bottlenecked = false;
+          for (auto& link : flow.path)
+            {
+              bottlenecked |= (bottlenecks.find (link) != bottlenecks.end ());
+            }
+          if (!bottlenecked)
+            {
+              it++;
+              continue;
+            }
+          flow.rate = share;
+          for (auto& link : flow.path)
+            {
+              capacity[link] = std::max (capacity[link] - share, 0.0);
+              nFlows[link]--;
+            }
+          it = unassigned.erase (it);
+        }
+    }
+
+  // Schedule the completion of the flow(s) that will finish first
+  double next = std::numeric_limits<double>::max ();
+  for (auto& flow : m_flows)
+    {
+      if (flow.second.active && flow.second.rate > 0)
+        {
+          next = std::min (next, flow.second.remaining / flow.second.rate);
+        }
+    }
+
+  m_completionEvent.Cancel ();
+  if (next < std::numeric_limits<double>::max ())
+    {
+      NS_LOG_LOGIC ("Next flow completes in " << next << "s");
+      m_completionEvent = Simulator::Schedule (Seconds (next), &PointToPointFluidManager::CompleteFlows, this);
+    }
+}
+
+void
+PointToPointFluidManager::CompleteFlows (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  UpdateRemaining ();
+
+  for (auto& flow : m_flows)
+    {
+      // bits that would be transferred in less than a nanosecond are
+      // rounding errors due to the resolution of the completion time
+      if (flow.second.active && flow.second.remaining <= flow.second.rate * 1e-9 + 1e-6)
+        {
+          NS_LOG_LOGIC ("Flow " << flow.first << " has been transferred");
+          flow.second.active = false;
+          flow.second.remaining = 0;
+          Simulator::Schedule (flow.second.delay, &PointToPointFluidManager::NotifyFlowCompleted,
+                               this, flow.first);
+        }
+    }
+
+  Reallocate ();
+}
+
+void
+PointToPointFluidManager::NotifyFlowCompleted (uint32_t flowId)
+{
+  NS_LOG_FUNCTION (this << flowId);
+
+  auto it = m_flows.find (flowId);
+  NS_ASSERT (it != m_flows.end ());
+
+  Time fct = Simulator::Now () - it->second.startTime;
+  m_flows.erase (it);
+  m_flowCompletedTrace (flowId, fct);
+}
+
+} // namespace ns3
@@ -0,0 +1,257 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef POINT_TO_POINT_FLUID_MANAGER_H
+#define POINT_TO_POINT_FLUID_MANAGER_H
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include "ns3/object.h"
+#include "ns3/ptr.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/callback.h"
+#include "ns3/traced-callback.h"
+
+namespace ns3 {
+
+class Node;
+class Packet;
+class PointToPointNetDevice;
+
+/**
+ * \ingroup point-to-point
+ * \brief Flow-level (fluid) model of bulk transfers over point-to-point links.
+ *
+ * Simulating long-lived bulk transfers packet by packet is expensive when
+ * only their flow completion times are of interest. This class models such
+ * transfers as fluid flows, i.e., as rates rather than packets. The rates of
+ * the active flows are the max-min fair allocation of the capacity (the
+ * DataRate of the transmitting PointToPointNetDevice) of the links they
+ * traverse, which is recomputed (by progressive filling) whenever a flow
+ * starts or completes. Hence, only a few events per flow are scheduled,
+ * regardless of the size of the flow.
+ *
+ * Fluid flows can share links with packet-level traffic. The bytes
+ * transmitted at the packet level on the links crossed by fluid flows are
+ * counted (through the PhyTxBegin trace source of the transmitting devices)
+ * and, at the end of every LoadInterval, the measured packet-level load is
+ * subtracted from the capacity of the links and the rates of the fluid flows
+ * are recomputed. Hence, fluid flows only get the capacity left by the
+ * packet-level traffic, as measured in the last interval. Conversely, fluid
+ * flows do not send packets and are therefore invisible to the packet-level
+ * traffic, which is not slowed down by them.
+ *
+ * The path of a flow is the shortest (in number of hops) path between the
+ * source and the destination node made of point-to-point links only. A flow
+ * is modeled at the packet level instead if no such path exists or if one
+ * of the links of the path is managed by a queue disc whose behavior cannot
+ * be captured by a fluid model, such as RED or CoDel (see
+ * AddPacketLevelQueueDisc). In such a case, the callback set through
+ * SetPacketLevelFlowCallback is invoked, so that the caller can set up a
+ * packet-level transfer (e.g., a BulkSendApplication).
+ *
+ * The completion time of a flow accounts for the connection establishment
+ * (StartupRtts round trip times), for the transmission of the payload at the
+ * allocated rate, scaled by the ratio between the segment size and the
+ * segment size plus the header size, and for the propagation delay of the
+ * path. Slow start and losses are not taken into account.
+ */
+class PointToPointFluidManager : public Object
+{
+public:
+  /**
+   * \brief Get the TypeId
+   *
+   * \return The TypeId for this class
+   */
+  static TypeId GetTypeId (void);
+
+  PointToPointFluidManager ();
+  virtual ~PointToPointFluidManager ();
+
+  /**
+   * Callback invoked when a flow has to be modeled at the packet level.
+   * Arguments are the flow ID, the source node, the destination node and
+   * the number of bytes to transfer.
+   */
+  typedef Callback<void, uint32_t, Ptr<Node>, Ptr<Node>, uint64_t> PacketLevelFlowCallback;
+
+  /**
+   * TracedCallback signature for flow completion events.
+   *
+   * \param [in] flowId The flow ID.
+   * \param [in] fct The flow completion time.
+   */
+  typedef void (* FlowCompletedTracedCallback) (uint32_t flowId, Time fct);
+
+  /**
+   * \brief Set the callback invoked when a flow cannot be modeled as a fluid flow
+   * \param cb the callback
+   */
+  void SetPacketLevelFlowCallback (PacketLevelFlowCallback cb);
+
+  /**
+   * \brief Links managed by a root queue disc of the given type are modeled
+   *        at the packet level
+   *
+   * RED, ARED, CoDel, FqCoDel, PIE and Cake queue discs are considered by default.
+   *
+   * \param typeName the name of the TypeId of the queue disc
+   */
+  void AddPacketLevelQueueDisc (std::string typeName);
+
+  /**
+   * \brief Start a bulk transfer
+   *
+   * The transfer is modeled as a fluid flow if a path made of point-to-point
+   * links that can be modeled as fluid links exists between the source and
+   * the destination node, otherwise the packet level flow callback is invoked.
+   *
+   * \param src the source node
+   * \param dst the destination node
+   * \param bytes the number of bytes to transfer
+   * \return the ID of the flow
+   */
+  uint32_t AddFlow (Ptr<Node> src, Ptr<Node> dst, uint64_t bytes);
+
+  /**
+   * \param flowId the ID of a flow
+   * \return true if the flow is a fluid flow that has not completed yet,
+   *         false if it is modeled at the packet level, if it has completed
+   *         or if no flow has such ID
+   */
+  bool IsFluidFlow (uint32_t flowId) const;
+
+  /**
+   * \return the number of fluid flows that are currently transferring data
+   */
+  uint32_t GetNActiveFlows (void) const;
+
+  /**
+   * \param flowId the ID of a fluid flow transferring data
+   * \return the rate (in bits per second, including headers) currently
+   *         allocated to the flow
+   */
+  double GetFlowRate (uint32_t flowId) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /// A directed link, identified by its transmitting device
+  typedef Ptr<PointToPointNetDevice> Link;
+
+  /// Packet-level load of a link crossed by fluid flows
+  struct LinkLoad
+  {
+    uint64_t txBytes;         //!< bytes sent at the packet level in the current interval
+    double load;              //!< packet-level load (bps) measured in the last interval
+  };
+
+  /// State of a fluid flow
+  struct Flow
+  {
+    std::vector<Link> path;   //!< links traversed by the flow
+    Time startTime;           //!< time the flow was added
+    Time delay;               //!< one-way propagation delay of the path
+    double remaining;         //!< bits (including headers) left to transfer
+    double rate;              //!< allocated rate in bps
+    bool active;              //!< true once the connection is established
+  };
+
+  /**
+   * \brief Find the path of a fluid flow
+   * \param src the source node
+   * \param dst the destination node
+   * \param path the links of the path (output)
+   * \return true if a path of point-to-point links that can be modeled as
+   *         fluid links has been found
+   */
+  bool FindPath (Ptr<Node> src, Ptr<Node> dst, std::vector<Link> &path) const;
+
+  /**
+   * \param link a link
+   * \return true if the link can be modeled as a fluid link
+   */
+  bool IsFluidLink (Link link) const;
+
+  /**
+   * \brief Start measuring the packet-level load of a link, if not done yet
+   * \param link the link
+   */
+  void MonitorLink (Link link);
+
+  /**
+   * \brief Count the bytes of a packet sent at the packet level
+   * \param linkLoad the load of the link the packet is sent on
+   * \param packet the packet
+   */
+  static void PacketSent (LinkLoad *linkLoad, Ptr<const Packet> packet);
+
+  /**
+   * \brief Update the packet-level load of the links and reallocate the rates
+   */
+  void MeasureLoad (void);
+
+  /**
+   * \brief Start transferring data on a flow whose connection is established
+   * \param flowId the ID of the flow
+   */
+  void ActivateFlow (uint32_t flowId);
+
+  /**
+   * \brief Remove the flows that have completed their transfer
+   */
+  void CompleteFlows (void);
+
+  /**
+   * \brief Notify the completion of a flow
+   * \param flowId the ID of the flow
+   */
+  void NotifyFlowCompleted (uint32_t flowId);
+
+  /**
+   * \brief Account for the bits transferred since the last update
+   */
+  void UpdateRemaining (void);
+
+  /**
+   * \brief Compute the max-min fair rates and schedule the next completion
+   */
+  void Reallocate (void);
+
+  std::map<uint32_t, Flow> m_flows;          //!< fluid flows (being set up, active or completing)
+  std::map<Link, LinkLoad> m_linkLoads;      //!< packet-level load of the links crossed by fluid flows
+  std::set<std::string> m_packetLevelQueueDiscs; //!< queue discs that force packet level links
+  PacketLevelFlowCallback m_packetLevelFlowCallback; //!< packet level flow callback
+  uint32_t m_nextFlowId;                     //!< ID of the next flow
+  Time m_lastUpdate;                         //!< time of the last update of the remaining bits
+  EventId m_completionEvent;                 //!< next completion event
+  Time m_loadInterval;                       //!< interval between packet-level load measurements
+  Time m_lastMeasurement;                    //!< time of the last packet-level load measurement
+  EventId m_loadEvent;                       //!< next packet-level load measurement
+  uint32_t m_segmentSize;                    //!< payload bytes per segment
+  uint32_t m_headerSize;                     //!< header bytes per segment
+  double m_startupRtts;                      //!< RTTs needed to establish a connection
+  TracedCallback<uint32_t, Time> m_flowCompletedTrace; //!< flow completion trace source
+};
+
+} // namespace ns3
+
+#endif /* POINT_TO_POINT_FLUID_MANAGER_H */
@@ -25,8 +25,11 @@
 #include "ns3/trace-source-accessor.h"
 #include "ns3/uinteger.h"
 #include "ns3/pointer.h"
+#include "ns3/queue-item.h"
+#include "ns3/segmentation-offload.h"
 #include "point-to-point-net-device.h"
 #include "point-to-point-channel.h"
+#include "point-to-point-tx-queue-tag.h"
 #include "ppp-header.h"
 
 namespace ns3 {
@@ -67,6 +70,19 @@ PointToPointNetDevice::GetTypeId (void)
                    TimeValue (Seconds (0.0)),
                    MakeTimeAccessor (&PointToPointNetDevice::m_tInterframeGap),
                    MakeTimeChecker ())
+    .AddAttribute ("MaxBatchSize",
+                   "The maximum number of packets the device accepts at once "
+                   "from the traffic control layer (1 disables batching)",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&PointToPointNetDevice::m_maxBatchSize),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("MaxTrainSize",
+                   "The maximum number of queued packets sent back-to-back as "
+                   "a train, with a single transmit complete event and a single "
+                   "receive event (1 disables trains)",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&PointToPointNetDevice::m_maxTrainSize),
+                   MakeUintegerChecker<uint32_t> (1))
 
     //
     // Transmit queueing discipline for the device which includes its own set
@@ -75,7 +91,8 @@ PointToPointNetDevice::GetTypeId (void)
     .AddAttribute ("TxQueue", 
                    "A queue to use as the transmit queue in the device.",
                    PointerValue (),
-                   MakePointerAccessor (&PointToPointNetDevice::m_queue),
+                   MakePointerAccessor (&PointToPointNetDevice::SetQueue,
+                                        &PointToPointNetDevice::GetQueue),
                    MakePointerChecker<Queue<Packet> > ())
 
     //
@@ -125,7 +142,9 @@ PointToPointNetDevice::GetTypeId (void)
                      "ns3::Packet::TracedCallback")
     .AddTraceSource ("PhyTxEnd", 
                      "Trace source indicating a packet has been "
-                     "completely transmitted over the channel",
+                     "completely transmitted over the channel (for the "
+                     "packets of a train, when the whole train has been "
+                     "transmitted, see PhyTxTrain for the exact times)",
                      MakeTraceSourceAccessor (&PointToPointNetDevice::m_phyTxEndTrace),
                      "ns3::Packet::TracedCallback")
     .AddTraceSource ("PhyTxDrop", 
@@ -143,7 +162,9 @@ PointToPointNetDevice::GetTypeId (void)
 #endif
     .AddTraceSource ("PhyRxEnd", 
                      "Trace source indicating a packet has been "
-                     "completely received by the device",
+                     "completely received by the device (for the packets "
+                     "of a train, when the last bit of the train arrives, "
+                     "see PhyRxTrain for the exact times)",
                      MakeTraceSourceAccessor (&PointToPointNetDevice::m_phyRxEndTrace),
                      "ns3::Packet::TracedCallback")
     .AddTraceSource ("PhyRxDrop", 
@@ -151,6 +172,18 @@ PointToPointNetDevice::GetTypeId (void)
                      "dropped by the device during reception",
                      MakeTraceSourceAccessor (&PointToPointNetDevice::m_phyRxDropTrace),
                      "ns3::Packet::TracedCallback")
+    .AddTraceSource ("PhyTxTrain",
+                     "Trace source indicating a packet of a train has been "
+                     "sent to the channel, with the exact times at which "
+                     "its first and last bits are transmitted",
+                     MakeTraceSourceAccessor (&PointToPointNetDevice::m_phyTxTrainTrace),
+                     "ns3::PointToPointNetDevice::TxTrainTracedCallback")
+    .AddTraceSource ("PhyRxTrain",
+                     "Trace source indicating a packet of a train has been "
+                     "received, with the exact time at which its last bit "
+                     "arrived",
+                     MakeTraceSourceAccessor (&PointToPointNetDevice::m_phyRxTrainTrace),
+                     "ns3::PointToPointNetDevice::RxTrainTracedCallback")
 
     //
     // Trace sources designed to simulate a packet sniffer facility (tcpdump).
@@ -176,7 +209,10 @@ PointToPointNetDevice::PointToPointNetDevice ()
   :
     m_txMachineState (READY),
     m_channel (0),
+    m_nextQueue (0),
     m_linkUp (false),
+    m_maxBatchSize (1),
+    m_maxTrainSize (1),
     m_currentPkt (0)
 {
   NS_LOG_FUNCTION (this);
@@ -214,7 +250,8 @@ PointToPointNetDevice::DoDispose ()
   m_channel = 0;
   m_receiveErrorModel = 0;
   m_currentPkt = 0;
-  m_queue = 0;
+  m_currentTrain.clear ();
+  m_queues.clear ();
   NetDevice::DoDispose ();
 }
 
@@ -244,6 +281,12 @@ PointToPointNetDevice::TransmitStart (Ptr<Packet> p)
   // schedule an event that will be executed when the transmission is complete.
   //
   NS_ASSERT_MSG (m_txMachineState == READY, "Must be READY to transmit");
+
+  if (m_maxTrainSize > 1 || SegmentationOffload::IsSuperSegment (p))
+    {
+      return TransmitTrainStart (p);
+    }
+
   m_txMachineState = BUSY;
   m_currentPkt = p;
   m_phyTxBeginTrace (m_currentPkt);
@@ -262,6 +305,89 @@ PointToPointNetDevice::TransmitStart (Ptr<Packet> p)
   return result;
 }
 
+bool
+PointToPointNetDevice::TransmitTrainStart (Ptr<Packet> p)
+{
+  NS_LOG_FUNCTION (this << p);
+
+  NS_ASSERT_MSG (m_txMachineState == READY, "Must be READY to transmit");
+  m_txMachineState = BUSY;
+  m_currentPkt = p;
+
+  //
+  // The train is made of the given packet and of the packets waiting in the
+  // device queue, which are all sent back-to-back. Their serialization times
+  // are computed now, so that a single event is needed to complete the
+  // transmission of the whole train. Super-segments are split into their
+  // segments, which count towards the size of the train.
+  //
+  AddToTrain (p);
+  while (m_currentTrain.size () < m_maxTrainSize)
+    {
+      Ptr<Packet> next = DequeueNext ();
+      if (next == 0)
+        {
+          break;
+        }
+      m_snifferTrace (next);
+      m_promiscSnifferTrace (next);
+      AddToTrain (next);
+    }
+
+  std::vector<Time> txStartTimes;
+  std::vector<Time> txEndTimes;
+  txStartTimes.reserve (m_currentTrain.size ());
+  txEndTimes.reserve (m_currentTrain.size ());
+  Time txStart = Seconds (0);
+  for (auto& packet : m_currentTrain)
+    {
+      Time txTime = m_bps.CalculateBytesTxTime (packet->GetSize ());
+      m_phyTxBeginTrace (packet);
+      m_phyTxTrainTrace (packet, Simulator::Now () + txStart, Simulator::Now () + txStart + txTime);
+      txStartTimes.push_back (txStart);
+      txEndTimes.push_back (txStart + txTime);
+      txStart += txTime + m_tInterframeGap;
+    }
+
+  NS_LOG_LOGIC ("Schedule TransmitCompleteEvent for a train of " << m_currentTrain.size ()
+                << " packets in " << txStart.GetSeconds () << "sec");
+  Simulator::Schedule (txStart, &PointToPointNetDevice::TransmitComplete, this);
+
+  bool result = m_channel->TransmitTrainStart (m_currentTrain, this, txStartTimes, txEndTimes);
+  if (result == false)
+    {
+      for (auto& packet : m_currentTrain)
+        {
+          m_phyTxDropTrace (packet);
+        }
+    }
+  return result;
+}
+
+void
+PointToPointNetDevice::AddToTrain (Ptr<Packet> p)
+{
+  NS_LOG_FUNCTION (this << p);
+
+  if (SegmentationOffload::IsSuperSegment (p))
+    {
+      Ptr<Packet> packet = p->Copy ();
+      uint16_t protocol = 0;
+      ProcessHeader (packet, protocol);
+      std::vector<Ptr<Packet> > segments;
+      if (SegmentationOffload::Segment (packet, protocol, segments))
+        {
+          for (auto& segment : segments)
+            {
+              AddHeader (segment, protocol);
+              m_currentTrain.push_back (segment);
+            }
+          return;
+        }
+    }
+  m_currentTrain.push_back (p);
+}
+
 void
 PointToPointNetDevice::TransmitComplete (void)
 {
@@ -278,10 +404,21 @@ PointToPointNetDevice::TransmitComplete (void)
 
   NS_ASSERT_MSG (m_currentPkt != 0, "PointToPointNetDevice::TransmitComplete(): m_currentPkt zero");
 
-  m_phyTxEndTrace (m_currentPkt);
+  if (m_currentTrain.empty ())
+    {
+      m_phyTxEndTrace (m_currentPkt);
+    }
+  else
+    {
+      for (auto& packet : m_currentTrain)
+        {
+          m_phyTxEndTrace (packet);
+        }
+      m_currentTrain.clear ();
+    }
   m_currentPkt = 0;
 
-  Ptr<Packet> p = m_queue->Dequeue ();
+  Ptr<Packet> p = DequeueNext ();
   if (p == 0)
     {
       NS_LOG_LOGIC ("No pending packets in device queue after tx complete");
@@ -318,7 +455,77 @@ void
 PointToPointNetDevice::SetQueue (Ptr<Queue<Packet> > q)
 {
   NS_LOG_FUNCTION (this << q);
-  m_queue = q;
+  if (m_queues.empty ())
+    {
+      m_queues.push_back (q);
+    }
+  else
+    {
+      m_queues[0] = q;
+    }
+}
+
+void
+PointToPointNetDevice::AddTxQueue (Ptr<Queue<Packet> > q)
+{
+  NS_LOG_FUNCTION (this << q);
+  m_queues.push_back (q);
+}
+
+std::size_t
+PointToPointNetDevice::GetNTxQueues (void) const
+{
+  return m_queues.size ();
+}
+
+Ptr<Queue<Packet> >
+PointToPointNetDevice::GetTxQueue (std::size_t i) const
+{
+  NS_ASSERT (i < m_queues.size ());
+  return m_queues[i];
+}
+
+std::size_t
+PointToPointNetDevice::SelectTxQueue (Ptr<QueueItem> item, std::size_t nTxQueues)
+{
+  NS_ASSERT (nTxQueues > 0 && nTxQueues <= 256);
+
+  Ptr<QueueDiscItem> qdItem = DynamicCast<QueueDiscItem> (item);
+  std::size_t txq = (qdItem ? qdItem->Hash () % nTxQueues : 0);
+
+  // record the selected queue, so that the device stores the packet in it
+  PointToPointTxQueueTag txqTag;
+  txqTag.SetTxQueue (static_cast<uint8_t> (txq));
+  item->GetPacket ()->ReplacePacketTag (txqTag);
+  return txq;
+}
+
+std::size_t
+PointToPointNetDevice::GetTxQueueIndex (Ptr<Packet> p) const
+{
+  PointToPointTxQueueTag txqTag;
+  if (p->RemovePacketTag (txqTag))
+    {
+      return txqTag.GetTxQueue () % m_queues.size ();
+    }
+  return 0;
+}
+
+Ptr<Packet>
+PointToPointNetDevice::DequeueNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  std::size_t n = m_queues.size ();
+  for (std::size_t i = 0; i < n; i++)
+    {
+      Ptr<Packet> p = m_queues[m_nextQueue]->Dequeue ();
+      m_nextQueue = (m_nextQueue + 1 == n ? 0 : m_nextQueue + 1);
+      if (p != 0)
+        {
+          return p;
+        }
+    }
+  return 0;
 }
 
 void
@@ -378,11 +585,24 @@ PointToPointNetDevice::Receive (Ptr<Packet> packet)
     }
 }
 
+void
+PointToPointNetDevice::ReceiveTrain (std::vector<Ptr<Packet> > packets, std::vector<Time> rxTimes)
+{
+  NS_LOG_FUNCTION (this << packets.size ());
+  NS_ASSERT (packets.size () == rxTimes.size ());
+
+  for (std::size_t i = 0; i < packets.size (); i++)
+    {
+      m_phyRxTrainTrace (packets[i], rxTimes[i]);
+      Receive (packets[i]);
+    }
+}
+
 Ptr<Queue<Packet> >
 PointToPointNetDevice::GetQueue (void) const
 { 
   NS_LOG_FUNCTION (this);
-  return m_queue;
+  return (m_queues.empty () ? 0 : m_queues[0]);
 }
 
 void
@@ -534,14 +754,14 @@ PointToPointNetDevice::Send (
   //
   // We should enqueue and dequeue the packet to hit the tracing hooks.
   //
-  if (m_queue->Enqueue (packet))
+  if (m_queues[GetTxQueueIndex (packet)]->Enqueue (packet))
     {
       //
       // If the channel is ready for transition we send the packet right now
       // 
       if (m_txMachineState == READY)
         {
-          packet = m_queue->Dequeue ();
+          packet = DequeueNext ();
           m_snifferTrace (packet);
           m_promiscSnifferTrace (packet);
           bool ret = TransmitStart (packet);
@@ -556,6 +776,63 @@ PointToPointNetDevice::Send (
   return false;
 }
 
+uint32_t
+PointToPointNetDevice::SendBatch (const std::vector<Ptr<QueueDiscItem> > &items)
+{
+  NS_LOG_FUNCTION (this << items.size ());
+
+  uint32_t nSent = 0;
+  for (auto& item : items)
+    {
+      Ptr<Packet> packet = item->GetPacket ();
+      NS_LOG_LOGIC ("UID is " << packet->GetUid ());
+
+      if (IsLinkUp () == false)
+        {
+          m_macTxDropTrace (packet);
+          continue;
+        }
+
+      AddHeader (packet, item->GetProtocol ());
+
+      m_macTxTrace (packet);
+
+      if (m_queues[GetTxQueueIndex (packet)]->Enqueue (packet))
+        {
+          nSent++;
+        }
+      else
+        {
+          m_macTxDropTrace (packet);
+        }
+    }
+
+  //
+  // Start the transmitter once for the whole batch. If it is busy, the
+  // enqueued packets are sent when the current transmission completes
+  //
+  Ptr<Packet> packet;
+  if (m_txMachineState == READY && (packet = DequeueNext ()) != 0)
+    {
+      m_snifferTrace (packet);
+      m_promiscSnifferTrace (packet);
+      TransmitStart (packet);
+    }
+  return nSent;
+}
+
+uint32_t
+PointToPointNetDevice::GetMaxBatchSize (void) const
+{
+  return m_maxBatchSize;
+}
+
+bool
+PointToPointNetDevice::SupportsSegmentationOffload (void) const
+{
+  return true;
+}
+
 bool
 PointToPointNetDevice::SendFrom (Ptr<Packet> packet, 
                                  const Address &source, 
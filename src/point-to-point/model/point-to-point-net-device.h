@@ -20,6 +20,7 @@
 #define POINT_TO_POINT_NET_DEVICE_H
 
 #include <cstring>
+#include <vector>
 #include "ns3/address.h"
 #include "ns3/node.h"
 #include "ns3/net-device.h"
@@ -36,6 +37,7 @@ namespace ns3 {
 template <typename Item> class Queue;
 class PointToPointChannel;
 class ErrorModel;
+class QueueItem;
 
 /**
  * \defgroup point-to-point Point-To-Point Network Device
@@ -114,7 +116,8 @@ public:
    * Attach a queue to the PointToPointNetDevice.
    *
    * The PointToPointNetDevice "owns" a queue that implements a queueing 
-   * method such as DropTailQueue or RedQueue
+   * method such as DropTailQueue or RedQueue. This queue is the first
+   * transmission queue of the device.
    *
    * \param queue Ptr to the new queue.
    */
@@ -123,10 +126,54 @@ public:
   /**
    * Get a copy of the attached Queue.
    *
-   * \returns Ptr to the queue.
+   * \returns Ptr to the queue (the first transmission queue of the device).
    */
   Ptr<Queue<Packet> > GetQueue (void) const;
 
+  /**
+   * Add a transmission queue to the PointToPointNetDevice.
+   *
+   * A device with multiple transmission queues stores each packet in the
+   * queue selected by SelectTxQueue and serves the non-empty queues in
+   * round robin, so that each queue can be stopped and woken independently
+   * of the others (see NetDeviceQueueInterface).
+   *
+   * \param queue Ptr to the new queue.
+   */
+  void AddTxQueue (Ptr<Queue<Packet> > queue);
+
+  /**
+   * Get the number of transmission queues.
+   *
+   * \returns the number of transmission queues.
+   */
+  std::size_t GetNTxQueues (void) const;
+
+  /**
+   * Get a transmission queue.
+   *
+   * \param i the index of the transmission queue.
+   * \returns Ptr to the i-th transmission queue.
+   */
+  Ptr<Queue<Packet> > GetTxQueue (std::size_t i) const;
+
+  /**
+   * Select the transmission queue of a packet.
+   *
+   * As Linux does by default, the transmission queue is selected by the
+   * hash of the flow of the packet. The index of the queue is recorded in
+   * a PointToPointTxQueueTag, which the device uses (and removes) to store
+   * the packet in such queue. The SocketPriorityTag of the packet is left
+   * untouched, so that the queue discs still classify the packet by its
+   * priority. PointToPointHelper sets this method as the select queue callback
+   * of the devices having multiple transmission queues.
+   *
+   * \param item the packet.
+   * \param nTxQueues the number of transmission queues (at most 256).
+   * \returns the index of the selected transmission queue.
+   */
+  static std::size_t SelectTxQueue (Ptr<QueueItem> item, std::size_t nTxQueues);
+
   /**
    * Attach a receive ErrorModel to the PointToPointNetDevice.
    *
@@ -149,6 +196,40 @@ public:
    */
   void Receive (Ptr<Packet> p);
 
+  /**
+   * Receive a train of packets from a connected PointToPointChannel.
+   *
+   * This method is used by the channel when the transmitting device sends
+   * trains of packets (see the MaxTrainSize attribute). It is called when
+   * the last bit of the last packet of the train has arrived at the device
+   * and it receives the packets in order, as Receive () does. The exact time
+   * at which each packet was received is reported by the PhyRxTrain trace
+   * source.
+   *
+   * \param packets the packets of the train
+   * \param rxTimes the times at which the last bit of each packet arrived
+   */
+  void ReceiveTrain (std::vector<Ptr<Packet> > packets, std::vector<Time> rxTimes);
+
+  /**
+   * TracedCallback signature for the transmission of a packet of a train.
+   *
+   * \param [in] packet The packet.
+   * \param [in] firstBitTime The time at which the first bit is transmitted.
+   * \param [in] lastBitTime The time at which the last bit is transmitted.
+   */
+  typedef void (* TxTrainTracedCallback)
+    (Ptr<const Packet> packet, Time firstBitTime, Time lastBitTime);
+
+  /**
+   * TracedCallback signature for the reception of a packet of a train.
+   *
+   * \param [in] packet The packet.
+   * \param [in] lastBitTime The time at which the last bit was received.
+   */
+  typedef void (* RxTrainTracedCallback)
+    (Ptr<const Packet> packet, Time lastBitTime);
+
   // The remaining methods are documented in ns3::NetDevice*
 
   virtual void SetIfIndex (const uint32_t index);
@@ -177,6 +258,9 @@ public:
 
   virtual bool Send (Ptr<Packet> packet, const Address &dest, uint16_t protocolNumber);
   virtual bool SendFrom (Ptr<Packet> packet, const Address& source, const Address& dest, uint16_t protocolNumber);
+  virtual uint32_t SendBatch (const std::vector<Ptr<QueueDiscItem> > &items);
+  virtual uint32_t GetMaxBatchSize (void) const;
+  virtual bool SupportsSegmentationOffload (void) const;
 
   virtual Ptr<Node> GetNode (void) const;
   virtual void SetNode (Ptr<Node> node);
@@ -250,6 +334,21 @@ private:
    */
   bool ProcessHeader (Ptr<Packet> p, uint16_t& param);
 
+  /**
+   * Get the transmission queue in which a packet is stored, and remove the
+   * PointToPointTxQueueTag of the packet.
+   * \param p the packet
+   * \return the index of the transmission queue recorded by SelectTxQueue
+   */
+  std::size_t GetTxQueueIndex (Ptr<Packet> p) const;
+
+  /**
+   * Dequeue a packet from the transmission queues, which are served in
+   * round robin.
+   * \return the dequeued packet, or 0 if all the queues are empty
+   */
+  Ptr<Packet> DequeueNext (void);
+
   /**
    * Start Sending a Packet Down the Wire.
    *
@@ -267,6 +366,32 @@ private:
    */
   bool TransmitStart (Ptr<Packet> p);
 
+  /**
+   * Start Sending a Train of Packets Down the Wire.
+   *
+   * Called by TransmitStart when the MaxTrainSize attribute is greater than
+   * one or the packet is a super-segment. The given packet and the packets
+   * found in the device queue (up to MaxTrainSize packets in total) are sent
+   * back-to-back: the serialization time of each packet is computed in
+   * advance, a single event is scheduled for the end of the transmission of
+   * the whole train and the channel is asked to deliver the train with a
+   * single event. Super-segments are split into their segments (see
+   * SegmentationOffload), hence a segmentation offload is modelled by a
+   * train of MTU-sized packets.
+   *
+   * \see PointToPointChannel::TransmitTrainStart ()
+   * \param p the first packet of the train
+   * \returns true if success, false on failure
+   */
+  bool TransmitTrainStart (Ptr<Packet> p);
+
+  /**
+   * Add a packet, or the segments of a super-segment, to the current train.
+   *
+   * \param p the packet, including the PPP header
+   */
+  void AddToTrain (Ptr<Packet> p);
+
   /**
    * Stop Sending a Packet Down the Wire and Begin the Interframe Gap.
    *
@@ -314,12 +439,14 @@ private:
   Ptr<PointToPointChannel> m_channel;
 
   /**
-   * The Queue which this PointToPointNetDevice uses as a packet source.
-   * Management of this Queue has been delegated to the PointToPointNetDevice
+   * The Queues which this PointToPointNetDevice uses as a packet source.
+   * Management of these Queues has been delegated to the PointToPointNetDevice
    * and it has the responsibility for deletion.
    * \see class DropTailQueue
    */
-  Ptr<Queue<Packet> > m_queue;
+  std::vector<Ptr<Queue<Packet> > > m_queues;
+
+  std::size_t m_nextQueue;  //!< Index of the next transmission queue to serve
 
   /**
    * Error model for receive packet events
@@ -369,7 +496,9 @@ private:
 
   /**
    * The trace source fired when a packet ends the transmission process on
-   * the medium.
+   * the medium. The packets of a train are all reported when the whole
+   * train has been transmitted; the exact time at which each of them ends
+   * is reported by m_phyTxTrainTrace.
    */
   TracedCallback<Ptr<const Packet> > m_phyTxEndTrace;
 
@@ -387,7 +516,9 @@ private:
 
   /**
    * The trace source fired when a packet ends the reception process from
-   * the medium.
+   * the medium. The packets of a train are all reported when the last bit
+   * of the train arrives; the exact time at which each of them is received
+   * is reported by m_phyRxTrainTrace.
    */
   TracedCallback<Ptr<const Packet> > m_phyRxEndTrace;
 
@@ -398,6 +529,18 @@ private:
    */
   TracedCallback<Ptr<const Packet> > m_phyRxDropTrace;
 
+  /**
+   * The trace source fired when a packet of a train is sent to the channel,
+   * with the exact times at which its first and last bits are transmitted.
+   */
+  TracedCallback<Ptr<const Packet>, Time, Time> m_phyTxTrainTrace;
+
+  /**
+   * The trace source fired when a packet of a train is received, with the
+   * exact time at which its last bit arrived.
+   */
+  TracedCallback<Ptr<const Packet>, Time> m_phyRxTrainTrace;
+
   /**
    * A trace source that emulates a non-promiscuous protocol sniffer connected 
    * to the device.  Unlike your average everyday sniffer, this trace source 
@@ -413,6 +556,11 @@ private:
    * just before the receive callback is executed.  In Linux, for example, 
    * this would correspond to the point at which the packet is dispatched to 
    * packet sniffers in \c netif_receive_skb.
+   *
+   * The packets of a train (see the MaxTrainSize attribute) are all traced
+   * when the train starts on the transmit side and when the last bit of the
+   * train arrives on the receive side. The exact times are reported by
+   * m_phyTxTrainTrace and m_phyRxTrainTrace.
    */
   TracedCallback<Ptr<const Packet> > m_snifferTrace;
 
@@ -431,6 +579,11 @@ private:
    * just before the receive callback is executed.  In Linux, for example, 
    * this would correspond to the point at which the packet is dispatched to 
    * packet sniffers in \c netif_receive_skb.
+   *
+   * The packets of a train (see the MaxTrainSize attribute) are all traced
+   * when the train starts on the transmit side and when the last bit of the
+   * train arrives on the receive side. The exact times are reported by
+   * m_phyTxTrainTrace and m_phyRxTrainTrace.
    */
   TracedCallback<Ptr<const Packet> > m_promiscSnifferTrace;
 
@@ -455,7 +608,12 @@ private:
    */
   uint32_t m_mtu;
 
+  uint32_t m_maxBatchSize;  //!< Maximum number of packets accepted by SendBatch
+
+  uint32_t m_maxTrainSize;  //!< Maximum number of packets sent back-to-back with a single event
+
   Ptr<Packet> m_currentPkt; //!< Current packet processed
+  std::vector<Ptr<Packet> > m_currentTrain; //!< Packets of the train being transmitted
 
   /**
    * \brief PPP to Ethernet protocol number mapping
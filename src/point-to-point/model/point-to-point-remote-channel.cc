@@ -77,4 +77,20 @@ PointToPointRemoteChannel::TransmitStart (
   return true;
 }
 
+bool
+PointToPointRemoteChannel::TransmitTrainStart (const std::vector<Ptr<Packet> > &packets,
+                                               Ptr<PointToPointNetDevice> src,
+                                               const std::vector<Time> &txStartTimes,
+                                               const std::vector<Time> &txEndTimes)
+{
+  NS_LOG_FUNCTION (this << packets.size () << src);
+  NS_ASSERT (packets.size () == txStartTimes.size () && packets.size () == txEndTimes.size ());
+
+  for (std::size_t i = 0; i < packets.size (); i++)
+    {
+      TransmitStart (packets[i], src, txEndTimes[i]);
+    }
+  return true;
+}
+
 } // namespace ns3
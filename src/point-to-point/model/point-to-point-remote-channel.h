@@ -68,6 +68,25 @@ public:
    */
   virtual bool TransmitStart (Ptr<const Packet> p, Ptr<PointToPointNetDevice> src,
                               Time txTime);
+
+  /**
+   * \brief Transmit a train of packets
+   *
+   * Packets are sent to the remote process one at a time, each with the
+   * exact time at which its last bit arrives.
+   *
+   * \param packets the packets to transmit
+   * \param src Source PointToPointNetDevice
+   * \param txStartTimes the time (relative to now) at which the transmission
+   *        of each packet starts
+   * \param txEndTimes the time (relative to now) at which the transmission
+   *        of each packet completes
+   * \returns true if successful (currently always true)
+   */
+  virtual bool TransmitTrainStart (const std::vector<Ptr<Packet> > &packets,
+                                   Ptr<PointToPointNetDevice> src,
+                                   const std::vector<Time> &txStartTimes,
+                                   const std::vector<Time> &txEndTimes);
 };
 
 } // namespace ns3
@@ -0,0 +1,81 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "point-to-point-tx-queue-tag.h"
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (PointToPointTxQueueTag);
+
+PointToPointTxQueueTag::PointToPointTxQueueTag ()
+  : m_txq (0)
+{
+}
+
+void
+PointToPointTxQueueTag::SetTxQueue (uint8_t txq)
+{
+  m_txq = txq;
+}
+
+uint8_t
+PointToPointTxQueueTag::GetTxQueue (void) const
+{
+  return m_txq;
+}
+
+TypeId
+PointToPointTxQueueTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::PointToPointTxQueueTag")
+    .SetParent<Tag> ()
+    .SetGroupName ("PointToPoint")
+    .AddConstructor<PointToPointTxQueueTag> ()
+  ;
+  return tid;
+}
+
+TypeId
+PointToPointTxQueueTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+PointToPointTxQueueTag::GetSerializedSize (void) const
+{
+  return 1;
+}
+
+void
+PointToPointTxQueueTag::Serialize (TagBuffer i) const
+{
+  i.WriteU8 (m_txq);
+}
+
+void
+PointToPointTxQueueTag::Deserialize (TagBuffer i)
+{
+  m_txq = i.ReadU8 ();
+}
+
+void
+PointToPointTxQueueTag::Print (std::ostream &os) const
+{
+  os << "TxQueue=" << (uint32_t) m_txq;
+}
+
+} // namespace ns3
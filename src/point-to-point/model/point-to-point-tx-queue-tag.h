@@ -0,0 +1,77 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef POINT_TO_POINT_TX_QUEUE_TAG_H
+#define POINT_TO_POINT_TX_QUEUE_TAG_H
+
+#include "ns3/tag.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup point-to-point
+ * \brief Packet tag carrying the transmission queue of a packet
+ *
+ * The tag is added by PointToPointNetDevice::SelectTxQueue and removed by
+ * the device when the packet is stored in the transmission queue. Unlike
+ * the SocketPriorityTag, which the queue discs use to classify the packet,
+ * it only records the index of the queue.
+ */
+class PointToPointTxQueueTag : public Tag
+{
+public:
+  PointToPointTxQueueTag ();
+
+  /**
+   * \brief Set the index of the transmission queue
+   * \param txq the index of the transmission queue
+   */
+  void SetTxQueue (uint8_t txq);
+
+  /**
+   * \brief Get the index of the transmission queue
+   * \return the index of the transmission queue
+   */
+  uint8_t GetTxQueue (void) const;
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  // inherited function, no need to doc.
+  virtual TypeId GetInstanceTypeId (void) const;
+
+  // inherited function, no need to doc.
+  virtual uint32_t GetSerializedSize (void) const;
+
+  // inherited function, no need to doc.
+  virtual void Serialize (TagBuffer i) const;
+
+  // inherited function, no need to doc.
+  virtual void Deserialize (TagBuffer i);
+
+  // inherited function, no need to doc.
+  virtual void Print (std::ostream &os) const;
+
+private:
+  uint8_t m_txq;  //!< the index of the transmission queue
+};
+
+} // namespace ns3
+
+#endif /* POINT_TO_POINT_TX_QUEUE_TAG_H */
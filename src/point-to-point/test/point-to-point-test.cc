@@ -23,7 +23,14 @@
 #include "ns3/simulator.h"
 #include "ns3/point-to-point-net-device.h"
 #include "ns3/point-to-point-channel.h"
+#include "ns3/point-to-point-fluid-manager.h"
+#include "ns3/point-to-point-tx-queue-tag.h"
 #include "ns3/net-device-queue-interface.h"
+#include "ns3/segmentation-offload.h"
+#include "ns3/queue-item.h"
+#include "ns3/socket.h"
+#include "ns3/data-rate.h"
+#include "ns3/uinteger.h"
 
 using namespace ns3;
 
@@ -94,6 +101,752 @@ PointToPointTest::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \brief Test class for the transmission of trains of packets
+ *
+ * It sends a burst of packets from one NetDevice to another, once with trains
+ * disabled and once with trains enabled, and checks that the exact reception
+ * times of the packets, and the transmission times and last bit times given
+ * by the channel trace, are the same, while fewer events are processed when
+ * trains are enabled.
+ */
+class PointToPointTrainTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   */
+  PointToPointTrainTest ();
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Send a burst of packets to the device specified
+   *
+   * \param device NetDevice to send to
+   * \param nPackets number of packets to send
+   */
+  void SendPackets (Ptr<PointToPointNetDevice> device, uint32_t nPackets);
+
+  /**
+   * \brief Record the reception time of a packet (trains disabled)
+   *
+   * \param p the received packet
+   */
+  void PhyRxEnd (Ptr<const Packet> p);
+
+  /**
+   * \brief Record the reception time of a packet of a train
+   *
+   * \param p the received packet
+   * \param rxTime the time at which the last bit of the packet arrived
+   */
+  void PhyRxTrain (Ptr<const Packet> p, Time rxTime);
+
+  /**
+   * \brief Record the transmission of a packet by the channel
+   *
+   * \param p the packet
+   * \param txDevice the transmitting device
+   * \param rxDevice the receiving device
+   * \param duration the transmission time of the packet
+   * \param lastBitTime the time (relative to now) at which the last bit arrives
+   */
+  void TxRx (Ptr<const Packet> p, Ptr<NetDevice> txDevice, Ptr<NetDevice> rxDevice,
+             Time duration, Time lastBitTime);
+
+  /**
+   * \brief Simulate the transmission of a burst of packets
+   *
+   * \param maxTrainSize the value of the MaxTrainSize attribute
+   * \return the number of events processed by the simulator
+   */
+  uint64_t RunScenario (uint32_t maxTrainSize);
+
+  std::vector<Time> m_rxTimes; //!< reception times of the packets
+  std::vector<Time> m_txDurations; //!< transmission times of the packets
+  std::vector<Time> m_lastBitTimes; //!< arrival times of the last bits of the packets
+};
+
+PointToPointTrainTest::PointToPointTrainTest ()
+  : TestCase ("PointToPoint trains of packets")
+{
+}
+
+void
+PointToPointTrainTest::SendPackets (Ptr<PointToPointNetDevice> device, uint32_t nPackets)
+{
+  for (uint32_t i = 0; i < nPackets; i++)
+    {
+      device->Send (Create<Packet> (1000), device->GetBroadcast (), 0x800);
+    }
+}
+
+void
+PointToPointTrainTest::PhyRxEnd (Ptr<const Packet> p)
+{
+  m_rxTimes.push_back (Simulator::Now ());
+}
+
+void
+PointToPointTrainTest::PhyRxTrain (Ptr<const Packet> p, Time rxTime)
+{
+  m_rxTimes.push_back (rxTime);
+}
+
+void
+PointToPointTrainTest::TxRx (Ptr<const Packet> p, Ptr<NetDevice> txDevice, Ptr<NetDevice> rxDevice,
+                             Time duration, Time lastBitTime)
+{
+  m_txDurations.push_back (duration);
+  m_lastBitTimes.push_back (Simulator::Now () + lastBitTime);
+}
+
+uint64_t
+PointToPointTrainTest::RunScenario (uint32_t maxTrainSize)
+{
+  Ptr<Node> a = CreateObject<Node> ();
+  Ptr<Node> b = CreateObject<Node> ();
+  Ptr<PointToPointNetDevice> devA = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointNetDevice> devB = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+
+  channel->SetAttribute ("Delay", TimeValue (MilliSeconds (1)));
+  devA->SetAttribute ("DataRate", DataRateValue (DataRate ("8Mbps")));
+  devA->SetAttribute ("InterframeGap", TimeValue (MicroSeconds (10)));
+  devA->SetAttribute ("MaxTrainSize", UintegerValue (maxTrainSize));
+
+  devA->Attach (channel);
+  devA->SetAddress (Mac48Address::Allocate ());
+  devA->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+  devB->Attach (channel);
+  devB->SetAddress (Mac48Address::Allocate ());
+  devB->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+
+  a->AddDevice (devA);
+  b->AddDevice (devB);
+
+  if (maxTrainSize > 1)
+    {
+      devB->TraceConnectWithoutContext ("PhyRxTrain",
+                                        MakeCallback (&PointToPointTrainTest::PhyRxTrain, this));
+    }
+  else
+    {
+      devB->TraceConnectWithoutContext ("PhyRxEnd",
+                                        MakeCallback (&PointToPointTrainTest::PhyRxEnd, this));
+    }
+
+  channel->TraceConnectWithoutContext ("TxRxPointToPoint",
+                                       MakeCallback (&PointToPointTrainTest::TxRx, this));
+
+  Simulator::Schedule (Seconds (1.0), &PointToPointTrainTest::SendPackets, this, devA, 10);
+
+  Simulator::Run ();
+  uint64_t nEvents = Simulator::GetEventCount ();
+  Simulator::Destroy ();
+  return nEvents;
+}
+
+void
+PointToPointTrainTest::DoRun (void)
+{
+  uint64_t nEvents = RunScenario (1);
+  std::vector<Time> rxTimes;
+  std::vector<Time> txDurations;
+  std::vector<Time> lastBitTimes;
+  rxTimes.swap (m_rxTimes);
+  txDurations.swap (m_txDurations);
+  lastBitTimes.swap (m_lastBitTimes);
+  NS_TEST_ASSERT_MSG_EQ (rxTimes.size (), 10, "Unexpected number of received packets");
+  NS_TEST_ASSERT_MSG_EQ (txDurations.size (), 10, "Unexpected number of transmitted packets");
+
+  // The first packet is sent alone, the following 9 packets are sent in two
+  // trains of 8 and 1 packets
+  uint64_t nEventsTrain = RunScenario (8);
+  NS_TEST_ASSERT_MSG_EQ (m_rxTimes.size (), 10, "Unexpected number of received packets");
+
+  NS_TEST_ASSERT_MSG_EQ (m_txDurations.size (), 10, "Unexpected number of transmitted packets");
+
+  for (uint32_t i = 0; i < rxTimes.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_rxTimes[i], rxTimes[i], "Unexpected reception time of packet " << i);
+      NS_TEST_EXPECT_MSG_EQ (m_txDurations[i], txDurations[i], "Unexpected transmission time of packet " << i);
+      NS_TEST_EXPECT_MSG_EQ (m_lastBitTimes[i], lastBitTimes[i], "Unexpected last bit time of packet " << i);
+    }
+  // per-packet transmission: 10 transmit complete and 10 receive events;
+  // trains: 3 transmit complete and 3 receive events
+  NS_TEST_EXPECT_MSG_EQ (nEvents - nEventsTrain, 14, "Unexpected number of events");
+}
+
+/**
+ * \brief Queue disc item with a given hash, used to test the selection of
+ * the transmission queue
+ */
+class PointToPointTestItem : public QueueDiscItem
+{
+public:
+  /**
+   * \brief Constructor
+   *
+   * \param p the packet
+   * \param hash the hash of the packet
+   */
+  PointToPointTestItem (Ptr<Packet> p, uint32_t hash)
+    : QueueDiscItem (p, Mac48Address (), 0),
+      m_hash (hash)
+  {
+  }
+  virtual void AddHeader (void)
+  {
+  }
+  virtual bool Mark (void)
+  {
+    return false;
+  }
+  virtual uint32_t Hash (uint32_t perturbation) const
+  {
+    return m_hash;
+  }
+
+private:
+  uint32_t m_hash; //!< the hash of the packet
+};
+
+/**
+ * \brief Test class for the devices with multiple transmission queues
+ *
+ * It checks that the transmission queue selected for a packet is recorded in
+ * the packet, that the packets are stored in the selected queues and that the
+ * queues are served in round robin.
+ */
+class PointToPointMultiQueueTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   */
+  PointToPointMultiQueueTest ();
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Record the uid of a received packet
+   *
+   * \param p the received packet
+   */
+  void PhyRxEnd (Ptr<const Packet> p);
+
+  std::vector<uint64_t> m_rxUids; //!< uids of the received packets
+};
+
+PointToPointMultiQueueTest::PointToPointMultiQueueTest ()
+  : TestCase ("PointToPoint multiple transmission queues")
+{
+}
+
+void
+PointToPointMultiQueueTest::PhyRxEnd (Ptr<const Packet> p)
+{
+  PointToPointTxQueueTag txqTag;
+  NS_TEST_EXPECT_MSG_EQ (p->PeekPacketTag (txqTag), false, "The transmission queue should not be sent on the link");
+  m_rxUids.push_back (p->GetUid ());
+}
+
+void
+PointToPointMultiQueueTest::DoRun (void)
+{
+  Ptr<Node> a = CreateObject<Node> ();
+  Ptr<Node> b = CreateObject<Node> ();
+  Ptr<PointToPointNetDevice> devA = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointNetDevice> devB = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+
+  devA->Attach (channel);
+  devA->SetAddress (Mac48Address::Allocate ());
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      devA->AddTxQueue (CreateObject<DropTailQueue<Packet> > ());
+    }
+  devB->Attach (channel);
+  devB->SetAddress (Mac48Address::Allocate ());
+  devB->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+
+  a->AddDevice (devA);
+  b->AddDevice (devB);
+
+  NS_TEST_ASSERT_MSG_EQ (devA->GetNTxQueues (), 4, "Unexpected number of transmission queues");
+  NS_TEST_EXPECT_MSG_EQ (devA->GetQueue (), devA->GetTxQueue (0), "The queue should be the first transmission queue");
+
+  devB->TraceConnectWithoutContext ("PhyRxEnd",
+                                    MakeCallback (&PointToPointMultiQueueTest::PhyRxEnd, this));
+
+  // the first packet is transmitted right away, the others are stored in
+  // the selected transmission queues (0, 0, 0, 1, 2, 3)
+  uint32_t hashes[] = {0, 4, 8, 12, 1, 6, 11};
+  std::vector<uint64_t> uids;
+  for (uint32_t i = 0; i < 7; i++)
+    {
+      Ptr<QueueDiscItem> item = Create<PointToPointTestItem> (Create<Packet> (1000), hashes[i]);
+      SocketPriorityTag priorityTag;
+      priorityTag.SetPriority (6);
+      item->GetPacket ()->AddPacketTag (priorityTag);
+      std::size_t txq = PointToPointNetDevice::SelectTxQueue (item, 4);
+      NS_TEST_EXPECT_MSG_EQ (txq, hashes[i] % 4, "Unexpected transmission queue");
+      PointToPointTxQueueTag txqTag;
+      NS_TEST_EXPECT_MSG_EQ (item->GetPacket ()->PeekPacketTag (txqTag), true,
+                             "The transmission queue should be recorded in the packet");
+      NS_TEST_EXPECT_MSG_EQ ((uint32_t) txqTag.GetTxQueue (), txq, "Unexpected recorded transmission queue");
+      NS_TEST_EXPECT_MSG_EQ (item->GetPacket ()->PeekPacketTag (priorityTag), true,
+                             "The priority of the packet should be kept");
+      NS_TEST_EXPECT_MSG_EQ ((uint32_t) priorityTag.GetPriority (), 6, "The priority of the packet should not change");
+      uids.push_back (item->GetPacket ()->GetUid ());
+      devA->Send (item->GetPacket (), devA->GetBroadcast (), 0x800);
+    }
+  NS_TEST_EXPECT_MSG_EQ (devA->GetTxQueue (0)->GetNPackets (), 3, "Unexpected number of packets in queue 0");
+  for (uint32_t i = 1; i < 4; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (devA->GetTxQueue (i)->GetNPackets (), 1, "Unexpected number of packets in queue " << i);
+    }
+
+  Simulator::Run ();
+
+  // after the first packet (from queue 0), the queues are served in round
+  // robin starting from queue 1
+  uint32_t order[] = {0, 4, 5, 6, 1, 2, 3};
+  NS_TEST_ASSERT_MSG_EQ (m_rxUids.size (), 7, "Unexpected number of received packets");
+  for (uint32_t i = 0; i < 7; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_rxUids[i], uids[order[i]], "Unexpected packet received at position " << i);
+    }
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \brief Split a packet into segments, regardless of its headers
+ *
+ * \param packet the packet to split
+ * \param segmentSize the size of the segments
+ * \param segments the vector to fill with the segments
+ * \return true
+ */
+static bool
+SplitPacket (Ptr<Packet> packet, uint16_t segmentSize, std::vector<Ptr<Packet> > &segments)
+{
+  for (uint32_t offset = 0; offset < packet->GetSize (); offset += segmentSize)
+    {
+      segments.push_back (packet->CreateFragment (offset, std::min<uint32_t> (segmentSize, packet->GetSize () - offset)));
+    }
+  return true;
+}
+
+/**
+ * \brief Test class for the segmentation offload
+ *
+ * It sends a super-segment from one NetDevice to another, and checks that
+ * its segments are received at the same times as if they were sent as
+ * separate packets, with a single transmission and a single reception event.
+ */
+class PointToPointSegmentationOffloadTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   */
+  PointToPointSegmentationOffloadTest ();
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Record the reception time of a packet sent on its own
+   *
+   * \param p the received packet
+   */
+  void PhyRxEnd (Ptr<const Packet> p);
+
+  /**
+   * \brief Record the reception time of a segment
+   *
+   * \param p the received packet
+   * \param rxTime the time at which the last bit of the packet arrived
+   */
+  void PhyRxTrain (Ptr<const Packet> p, Time rxTime);
+
+  /**
+   * \brief Record the size of a received packet
+   *
+   * \param device the receiving device
+   * \param p the received packet
+   * \param protocol the protocol number
+   * \param from the sender address
+   * \return true
+   */
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from);
+
+  /**
+   * \brief Simulate the transmission of 4500 bytes
+   *
+   * \param offload whether a super-segment is sent
+   * \return the number of events processed by the simulator
+   */
+  uint64_t RunScenario (bool offload);
+
+  std::vector<Time> m_rxTimes;     //!< reception times of the packets
+  std::vector<uint32_t> m_rxSizes; //!< sizes of the received packets
+};
+
+PointToPointSegmentationOffloadTest::PointToPointSegmentationOffloadTest ()
+  : TestCase ("PointToPoint segmentation offload")
+{
+}
+
+void
+PointToPointSegmentationOffloadTest::PhyRxEnd (Ptr<const Packet> p)
+{
+  m_rxTimes.push_back (Simulator::Now ());
+}
+
+void
+PointToPointSegmentationOffloadTest::PhyRxTrain (Ptr<const Packet> p, Time rxTime)
+{
+  m_rxTimes.push_back (rxTime);
+}
+
+bool
+PointToPointSegmentationOffloadTest::Receive (Ptr<NetDevice> device, Ptr<const Packet> p,
+                                              uint16_t protocol, const Address &from)
+{
+  m_rxSizes.push_back (p->GetSize ());
+  return true;
+}
+
+uint64_t
+PointToPointSegmentationOffloadTest::RunScenario (bool offload)
+{
+  Ptr<Node> a = CreateObject<Node> ();
+  Ptr<Node> b = CreateObject<Node> ();
+  Ptr<PointToPointNetDevice> devA = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointNetDevice> devB = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+
+  channel->SetAttribute ("Delay", TimeValue (MilliSeconds (1)));
+  devA->SetAttribute ("DataRate", DataRateValue (DataRate ("8Mbps")));
+  devA->SetAttribute ("InterframeGap", TimeValue (MicroSeconds (10)));
+
+  devA->Attach (channel);
+  devA->SetAddress (Mac48Address::Allocate ());
+  devA->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+  devB->Attach (channel);
+  devB->SetAddress (Mac48Address::Allocate ());
+  devB->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+
+  a->AddDevice (devA);
+  b->AddDevice (devB);
+  devB->SetReceiveCallback (MakeCallback (&PointToPointSegmentationOffloadTest::Receive, this));
+
+  if (offload)
+    {
+      devB->TraceConnectWithoutContext ("PhyRxTrain",
+                                        MakeCallback (&PointToPointSegmentationOffloadTest::PhyRxTrain, this));
+      Ptr<Packet> packet = Create<Packet> (4500);
+      packet->AddPacketTag (SegmentationOffloadTag (1000));
+      Simulator::Schedule (Seconds (1.0), &PointToPointNetDevice::Send, devA, packet,
+                           devA->GetBroadcast (), 0x86DD);
+    }
+  else
+    {
+      devB->TraceConnectWithoutContext ("PhyRxEnd",
+                                        MakeCallback (&PointToPointSegmentationOffloadTest::PhyRxEnd, this));
+      for (uint32_t size = 0; size < 4500; size += 1000)
+        {
+          Simulator::Schedule (Seconds (1.0), &PointToPointNetDevice::Send, devA,
+                               Create<Packet> (std::min<uint32_t> (1000, 4500 - size)),
+                               devA->GetBroadcast (), 0x86DD);
+        }
+    }
+
+  Simulator::Run ();
+  uint64_t nEvents = Simulator::GetEventCount ();
+  Simulator::Destroy ();
+  return nEvents;
+}
+
+void
+PointToPointSegmentationOffloadTest::DoRun (void)
+{
+  SegmentationOffload::Register (0x86DD, MakeCallback (&SplitPacket));
+
+  uint64_t nEvents = RunScenario (false);
+  std::vector<Time> rxTimes;
+  rxTimes.swap (m_rxTimes);
+  std::vector<uint32_t> rxSizes;
+  rxSizes.swap (m_rxSizes);
+  NS_TEST_ASSERT_MSG_EQ (rxTimes.size (), 5, "Unexpected number of received packets");
+
+  uint64_t nEventsOffload = RunScenario (true);
+  NS_TEST_ASSERT_MSG_EQ (m_rxTimes.size (), 5, "Unexpected number of received segments");
+  NS_TEST_ASSERT_MSG_EQ (m_rxSizes.size (), 5, "Unexpected number of received segments");
+  for (uint32_t i = 0; i < rxTimes.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_rxTimes[i], rxTimes[i], "Unexpected reception time of segment " << i);
+      NS_TEST_EXPECT_MSG_EQ (m_rxSizes[i], rxSizes[i], "Unexpected size of segment " << i);
+    }
+  // separate packets: 5 send, 5 transmit complete and 5 receive events;
+  // super-segment: 1 send, 1 transmit complete and 1 receive event
+  NS_TEST_EXPECT_MSG_EQ (nEvents - nEventsOffload, 12, "Unexpected number of events");
+}
+
+/**
+ * \brief Test class for the fluid model of bulk transfers
+ *
+ * Two flows share a link, one of them being limited by a slower link: the
+ * rates must be max-min fair and the flow completion times must account for
+ * the rate increase of the remaining flow when the other one completes.
+ */
+class PointToPointFluidTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   */
+  PointToPointFluidTest ();
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Record the completion time of a flow
+   *
+   * \param flowId the ID of the flow
+   * \param fct the flow completion time
+   */
+  void FlowCompleted (uint32_t flowId, Time fct);
+
+  /**
+   * \brief Check the rates allocated to the flows
+   *
+   * \param manager the fluid manager
+   */
+  void CheckRates (Ptr<PointToPointFluidManager> manager);
+
+  std::map<uint32_t, Time> m_fct; //!< flow completion times
+};
+
+PointToPointFluidTest::PointToPointFluidTest ()
+  : TestCase ("PointToPoint fluid flows")
+{
+}
+
+void
+PointToPointFluidTest::FlowCompleted (uint32_t flowId, Time fct)
+{
+  m_fct[flowId] = fct;
+}
+
+void
+PointToPointFluidTest::CheckRates (Ptr<PointToPointFluidManager> manager)
+{
+  NS_TEST_EXPECT_MSG_EQ (manager->GetNActiveFlows (), 2, "Two flows should be active");
+  NS_TEST_EXPECT_MSG_EQ_TOL (manager->GetFlowRate (1), 4e6, 1, "Unexpected rate of the first flow");
+  NS_TEST_EXPECT_MSG_EQ_TOL (manager->GetFlowRate (2), 1e6, 1, "Unexpected rate of the second flow");
+}
+
+void
+PointToPointFluidTest::DoRun (void)
+{
+  // n0 --10Mbps-- n1 --5Mbps-- n2
+  //               |
+  // n3 ---1Mbps---+
+  std::vector<Ptr<Node> > nodes;
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      nodes.push_back (CreateObject<Node> ());
+    }
+
+  auto link = [&nodes] (uint32_t a, uint32_t b, std::string rate)
+    {
+      Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+      channel->SetAttribute ("Delay", TimeValue (MilliSeconds (1)));
+      for (uint32_t n : {a, b})
+        {
+          Ptr<PointToPointNetDevice> dev = CreateObject<PointToPointNetDevice> ();
+          dev->SetAttribute ("DataRate", DataRateValue (DataRate (rate)));
+          dev->Attach (channel);
+          dev->SetAddress (Mac48Address::Allocate ());
+          dev->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+          nodes[n]->AddDevice (dev);
+        }
+    };
+  link (0, 1, "10Mbps");
+  link (1, 2, "5Mbps");
+  link (3, 1, "1Mbps");
+
+  Ptr<PointToPointFluidManager> manager = CreateObject<PointToPointFluidManager> ();
+  manager->SetAttribute ("HeaderSize", UintegerValue (0));
+  manager->TraceConnectWithoutContext ("FlowCompleted",
+                                       MakeCallback (&PointToPointFluidTest::FlowCompleted, this));
+
+  // 8 Mbit and 1 Mbit transfers
+  NS_TEST_EXPECT_MSG_EQ (manager->AddFlow (nodes[0], nodes[2], 1000000), 1, "Unexpected flow ID");
+  NS_TEST_EXPECT_MSG_EQ (manager->AddFlow (nodes[3], nodes[2], 125000), 2, "Unexpected flow ID");
+  NS_TEST_EXPECT_MSG_EQ (manager->IsFluidFlow (1), true, "The first flow should be a fluid flow");
+  NS_TEST_EXPECT_MSG_EQ (manager->IsFluidFlow (3), false, "No flow has been added with such ID");
+
+  // no path between n2 and a node not connected to any other node
+  Ptr<Node> isolated = CreateObject<Node> ();
+  NS_TEST_EXPECT_MSG_EQ (manager->IsFluidFlow (manager->AddFlow (nodes[2], isolated, 1000)), false,
+                         "The flow should be modeled at the packet level");
+
+  Simulator::Schedule (Seconds (0.5), &PointToPointFluidTest::CheckRates, this, manager);
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (manager->IsFluidFlow (1), false, "The first flow should have completed");
+  Simulator::Destroy ();
+
+  // Both flows start transferring data after 4ms (one RTT). The second flow
+  // gets 1Mbps and completes after 1s, the first flow gets 4Mbps for 1s and
+  // then 5Mbps for 0.8s. Completion is notified 2ms later (one-way delay).
+  NS_TEST_ASSERT_MSG_EQ (m_fct.size (), 2, "Both flows should have completed");
+  NS_TEST_EXPECT_MSG_EQ_TOL (m_fct[1].GetSeconds (), 1.806, 1e-6, "Unexpected completion time");
+  NS_TEST_EXPECT_MSG_EQ_TOL (m_fct[2].GetSeconds (), 1.006, 1e-6, "Unexpected completion time");
+}
+
+/**
+ * \brief Test class for fluid flows sharing a link with packet-level traffic
+ *
+ * A fluid flow shares a link with a constant bit rate packet-level flow: after
+ * the first load measurement, the fluid flow must only get the capacity left by
+ * the packet-level flow.
+ */
+class PointToPointFluidSharedLinkTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   */
+  PointToPointFluidSharedLinkTest ();
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Record the completion time of a flow
+   *
+   * \param flowId the ID of the flow
+   * \param fct the flow completion time
+   */
+  void FlowCompleted (uint32_t flowId, Time fct);
+
+  /**
+   * \brief Check the rate allocated to the fluid flow
+   *
+   * \param manager the fluid manager
+   * \param rate the expected rate
+   */
+  void CheckRate (Ptr<PointToPointFluidManager> manager, double rate);
+
+  /**
+   * \brief Send a packet at the packet level
+   *
+   * \param dev the transmitting device
+   */
+  void SendPacket (Ptr<PointToPointNetDevice> dev);
+
+  Time m_fct; //!< flow completion time
+};
+
+PointToPointFluidSharedLinkTest::PointToPointFluidSharedLinkTest ()
+  : TestCase ("PointToPoint fluid flow sharing a link with packet-level traffic")
+{
+}
+
+void
+PointToPointFluidSharedLinkTest::FlowCompleted (uint32_t flowId, Time fct)
+{
+  m_fct = fct;
+}
+
+void
+PointToPointFluidSharedLinkTest::CheckRate (Ptr<PointToPointFluidManager> manager, double rate)
+{
+  NS_TEST_EXPECT_MSG_EQ_TOL (manager->GetFlowRate (1), rate, 1, "Unexpected rate of the fluid flow");
+}
+
+void
+PointToPointFluidSharedLinkTest::SendPacket (Ptr<PointToPointNetDevice> dev)
+{
+  dev->Send (Create<Packet> (500), dev->GetBroadcast (), 0x800);
+}
+
+void
+PointToPointFluidSharedLinkTest::DoRun (void)
+{
+  // n0 --10Mbps-- n1
+  Ptr<Node> a = CreateObject<Node> ();
+  Ptr<Node> b = CreateObject<Node> ();
+  Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+  channel->SetAttribute ("Delay", TimeValue (MilliSeconds (1)));
+  Ptr<PointToPointNetDevice> devA = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointNetDevice> devB = CreateObject<PointToPointNetDevice> ();
+  for (auto& dev : {devA, devB})
+    {
+      dev->SetAttribute ("DataRate", DataRateValue (DataRate ("10Mbps")));
+      dev->Attach (channel);
+      dev->SetAddress (Mac48Address::Allocate ());
+      dev->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+    }
+  a->AddDevice (devA);
+  b->AddDevice (devB);
+
+  Ptr<PointToPointFluidManager> manager = CreateObject<PointToPointFluidManager> ();
+  manager->SetAttribute ("HeaderSize", UintegerValue (0));
+  manager->SetAttribute ("LoadInterval", TimeValue (MilliSeconds (100)));
+  manager->TraceConnectWithoutContext ("FlowCompleted",
+                                       MakeCallback (&PointToPointFluidSharedLinkTest::FlowCompleted, this));
+
+  // 8 Mbit transfer
+  manager->AddFlow (a, b, 1000000);
+
+  // a 502 byte packet (including the PPP header) every ms, i.e., 4.016Mbps
+  for (uint32_t i = 0; i < 2000; i++)
+    {
+      Simulator::Schedule (MicroSeconds (500 + 1000 * i),
+                           &PointToPointFluidSharedLinkTest::SendPacket, this, devA);
+    }
+
+  // no packet-level load has been measured in the first 100ms
+  Simulator::Schedule (MilliSeconds (50), &PointToPointFluidSharedLinkTest::CheckRate,
+                       this, manager, 10e6);
+  Simulator::Schedule (MilliSeconds (500), &PointToPointFluidSharedLinkTest::CheckRate,
+                       this, manager, 10e6 - 4.016e6);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  // The flow starts transferring data after 2ms (one RTT) at 10Mbps and gets
+  // the capacity left by the packet-level flow after 100ms. Completion is
+  // notified 1ms later (one-way delay).
+  double fct = 0.1 + (8e6 - 0.098 * 10e6) / (10e6 - 4.016e6) + 0.001;
+  NS_TEST_EXPECT_MSG_EQ_TOL (m_fct.GetSeconds (), fct, 1e-6, "Unexpected completion time");
+}
+
 /**
  * \brief TestSuite for PointToPoint module
  */
@@ -110,6 +863,11 @@ PointToPointTestSuite::PointToPointTestSuite ()
   : TestSuite ("devices-point-to-point", UNIT)
 {
   AddTestCase (new PointToPointTest, TestCase::QUICK);
+  AddTestCase (new PointToPointTrainTest, TestCase::QUICK);
+  AddTestCase (new PointToPointSegmentationOffloadTest, TestCase::QUICK);
+  AddTestCase (new PointToPointFluidTest, TestCase::QUICK);
+  AddTestCase (new PointToPointFluidSharedLinkTest, TestCase::QUICK);
+  AddTestCase (new PointToPointMultiQueueTest, TestCase::QUICK);
 }
 
 static PointToPointTestSuite g_pointToPointTestSuite; //!< The testsuite
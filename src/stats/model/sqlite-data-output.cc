@@ -19,6 +19,7 @@
  */
 
 #include <sstream>
+#include <fstream>
 
 #include <sqlite3.h>
 
@@ -185,6 +186,64 @@ SqliteDataOutput::Output (DataCollector &dc)
   // end SqliteDataOutput::Output
 }
 
+uint32_t
+SqliteDataOutput::Merge (const std::vector<std::string> &prefixes)
+{
+  NS_LOG_FUNCTION (this << prefixes.size ());
+
+  std::string dbFile = m_filePrefix + ".db";
+
+  if (sqlite3_open (dbFile.c_str (), &m_db)) {
+      NS_LOG_ERROR ("Could not open sqlite3 database \"" << dbFile << "\"");
+      NS_LOG_ERROR ("sqlite3 error \"" << sqlite3_errmsg (m_db) << "\"");
+      sqlite3_close (m_db);
+      return 0;
+    }
+
+  Exec ("create table if not exists Experiments (run, experiment, strategy, input, description text)");
+  Exec ("create table if not exists Metadata ( run text, key text, value)");
+  Exec ("create table if not exists Singletons ( run text, name text, variable text, value )");
+
+  uint32_t merged = 0;
+  for (std::vector<std::string>::const_iterator i = prefixes.begin ();
+       i != prefixes.end (); i++) {
+      std::string source = *i + ".db";
+      if (!std::ifstream (source.c_str ()).good ()) {
+          // attaching would create an empty database
+          NS_LOG_WARN ("No sqlite3 database \"" << source << "\" to merge");
+          continue;
+        }
+
+      sqlite3_stmt *stmt;
+      sqlite3_prepare_v2 (m_db, "attach database ? as source", -1, &stmt, NULL);
+      sqlite3_bind_text (stmt, 1, source.c_str (), source.length (), SQLITE_TRANSIENT);
+      int res = sqlite3_step (stmt);
+      sqlite3_finalize (stmt);
+      if (res != SQLITE_DONE) {
+          NS_LOG_ERROR ("Could not attach sqlite3 database \"" << source << "\"");
+          NS_LOG_ERROR ("sqlite3 error \"" << sqlite3_errmsg (m_db) << "\"");
+          continue;
+        }
+
+      Exec ("BEGIN");
+      if (Exec ("insert into Experiments select * from source.Experiments") == SQLITE_OK
+          && Exec ("insert into Metadata select * from source.Metadata") == SQLITE_OK
+          && Exec ("insert into Singletons select * from source.Singletons") == SQLITE_OK) {
+          Exec ("COMMIT");
+          merged++;
+        } else {
+          NS_LOG_ERROR ("Could not merge sqlite3 database \"" << source << "\"");
+          Exec ("ROLLBACK");
+        }
+      Exec ("detach database source");
+    }
+
+  sqlite3_close (m_db);
+  return merged;
+
+  // end SqliteDataOutput::Merge
+}
+
 SqliteDataOutput::SqliteOutputCallback::SqliteOutputCallback
   (Ptr<SqliteDataOutput> owner, std::string run) :
   m_owner (owner),
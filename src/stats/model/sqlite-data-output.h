@@ -21,6 +21,9 @@
 #ifndef SQLITE_DATA_OUTPUT_H
 #define SQLITE_DATA_OUTPUT_H
 
+#include <vector>
+#include <string>
+
 #include "ns3/nstime.h"
 
 #include "data-output-interface.h"
@@ -51,6 +54,21 @@ public:
   
   virtual void Output (DataCollector &dc);
 
+  /**
+   * \brief Append the data of other databases to this output's database
+   *
+   * The rows of the tables of the databases written by other
+   * SqliteDataOutput objects, such as those of the replications run by
+   * a ReplicationRunner, are inserted into the tables of this output's
+   * database.  The runs are told apart by the run label of their
+   * DataCollector.  The missing databases are skipped, as well as
+   * those whose rows cannot be inserted, which are left out entirely.
+   *
+   * \param prefixes The file prefixes of the other databases
+   * \returns The number of databases merged
+   */
+  uint32_t Merge (const std::vector<std::string> &prefixes);
+
 protected:
   virtual void DoDispose ();
 
@@ -0,0 +1,130 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <sstream>
+#include <sqlite3.h>
+
+#include "ns3/test.h"
+#include "ns3/data-collector.h"
+#include "ns3/basic-data-calculators.h"
+#include "ns3/sqlite-data-output.h"
+
+using namespace ns3;
+
+// ===========================================================================
+// Test case for merging the databases of several runs.
+// ===========================================================================
+
+class SqliteMergeTestCase : public TestCase
+{
+public:
+  SqliteMergeTestCase ();
+  virtual ~SqliteMergeTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Count the rows of a table
+   * \param db the database
+   * \param query the query selecting the count
+   * \return the count
+   */
+  static int Count (sqlite3 *db, std::string query);
+};
+
+SqliteMergeTestCase::SqliteMergeTestCase ()
+  : TestCase ("Merge the databases of several runs")
+{
+}
+
+SqliteMergeTestCase::~SqliteMergeTestCase ()
+{
+}
+
+int
+SqliteMergeTestCase::Count (sqlite3 *db, std::string query)
+{
+  sqlite3_stmt *stmt;
+  int count = -1;
+  if (sqlite3_prepare_v2 (db, query.c_str (), -1, &stmt, NULL) == SQLITE_OK
+      && sqlite3_step (stmt) == SQLITE_ROW)
+    {
+      count = sqlite3_column_int (stmt, 0);
+    }
+  sqlite3_finalize (stmt);
+  return count;
+}
+
+void
+SqliteMergeTestCase::DoRun (void)
+{
+  std::vector<std::string> prefixes;
+  for (uint32_t run = 1; run <= 3; run++)
+    {
+      std::ostringstream label;
+      label << "run" << run;
+      DataCollector collector;
+      collector.DescribeRun ("merge", "test", "none", label.str ());
+      Ptr<CounterCalculator<> > counter = CreateObject<CounterCalculator<> > ();
+      counter->SetKey ("counter");
+      counter->Update (run);
+      collector.AddDataCalculator (counter);
+
+      Ptr<SqliteDataOutput> output = CreateObject<SqliteDataOutput> ();
+      output->SetFilePrefix (CreateTempDirFilename (label.str ()));
+      output->Output (collector);
+      prefixes.push_back (output->GetFilePrefix ());
+    }
+  // the database of a failed run is missing
+  prefixes.push_back (CreateTempDirFilename ("run4"));
+  // the database of another run lacks the tables
+  sqlite3 *db;
+  std::string otherFile = CreateTempDirFilename ("run5") + ".db";
+  NS_TEST_ASSERT_MSG_EQ (sqlite3_open (otherFile.c_str (), &db), SQLITE_OK, "Could not open " << otherFile);
+  NS_TEST_ASSERT_MSG_EQ (sqlite3_exec (db, "create table Experiments (run)", NULL, NULL, NULL), SQLITE_OK,
+                         "Could not create a table in " << otherFile);
+  sqlite3_close (db);
+  prefixes.push_back (CreateTempDirFilename ("run5"));
+
+  Ptr<SqliteDataOutput> merged = CreateObject<SqliteDataOutput> ();
+  merged->SetFilePrefix (CreateTempDirFilename ("merged"));
+  NS_TEST_ASSERT_MSG_EQ (merged->Merge (prefixes), 3, "Unexpected number of databases merged");
+
+  std::string dbFile = merged->GetFilePrefix () + ".db";
+  NS_TEST_ASSERT_MSG_EQ (sqlite3_open (dbFile.c_str (), &db), SQLITE_OK, "Could not open " << dbFile);
+  NS_TEST_EXPECT_MSG_EQ (Count (db, "select count(*) from Experiments"), 3, "Unexpected number of runs");
+  NS_TEST_EXPECT_MSG_EQ (Count (db, "select count(*) from Singletons where run = 'run2'"), 1,
+                         "Unexpected number of values of run2");
+  NS_TEST_EXPECT_MSG_EQ (Count (db, "select sum(value) from Singletons where variable = 'counter'"), 6,
+                         "Unexpected sum of the counters of the runs");
+  sqlite3_close (db);
+}
+
+
+class SqliteDataOutputTestSuite : public TestSuite
+{
+public:
+  SqliteDataOutputTestSuite ();
+};
+
+SqliteDataOutputTestSuite::SqliteDataOutputTestSuite ()
+  : TestSuite ("sqlite-data-output", UNIT)
+{
+  AddTestCase (new SqliteMergeTestCase, TestCase::QUICK);
+}
+
+static SqliteDataOutputTestSuite sqliteDataOutputTestSuite;
@@ -36,6 +36,19 @@
 
 using namespace ns3;
 
+/**
+ * Get the number of packets in a flow queue of a FqCoDel queue disc
+ * \param queueDisc the queue disc
+ * \param i the rank of the flow queue, in the order of their first packet
+ * \return the number of packets in the flow queue
+ */
+static uint32_t
+GetFlowNPackets (Ptr<FqCoDelQueueDisc> queueDisc, uint32_t i)
+{
+  const FlowQueueTable &table = queueDisc->GetFlowQueueTable ();
+  return table.GetNPackets (table.GetUsedFlow (i));
+}
+
 /**
  * Simple test packet filter able to classify IPv4 packets
  *
@@ -120,12 +133,12 @@ FqCoDelQueueDiscNoSuitableFilter::DoRun (void)
   Address dest;
   item = Create<Ipv6QueueDiscItem> (p, dest, 0, ipv6Header);
   queueDisc->Enqueue (item);
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetNQueueDiscClasses (), 0, "no flow queue should have been created");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueTable ().GetNUsedFlows (), 0, "no flow queue should have been created");
 
   p = Create<Packet> (reinterpret_cast<const uint8_t*> ("hello, world"), 12);
   item = Create<Ipv6QueueDiscItem> (p, dest, 0, ipv6Header);
   queueDisc->Enqueue (item);
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetNQueueDiscClasses (), 0, "no flow queue should have been created");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueTable ().GetNUsedFlows (), 0, "no flow queue should have been created");
 
   Simulator::Destroy ();
 }
@@ -181,20 +194,20 @@ FqCoDelQueueDiscIPFlowsSeparationAndPacketLimit::DoRun (void)
   AddPacket (queueDisc, hdr);
   AddPacket (queueDisc, hdr);
   NS_TEST_ASSERT_MSG_EQ (queueDisc->QueueDisc::GetNPackets (), 3, "unexpected number of packets in the queue disc");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (0)->GetQueueDisc ()->GetNPackets (), 3, "unexpected number of packets in the flow queue");
+  NS_TEST_ASSERT_MSG_EQ (GetFlowNPackets (queueDisc, 0), 3, "unexpected number of packets in the flow queue");
 
   // Add two packets from the second flow
   hdr.SetDestination (Ipv4Address ("10.10.1.7"));
   // Add the first packet
   AddPacket (queueDisc, hdr);
   NS_TEST_ASSERT_MSG_EQ (queueDisc->QueueDisc::GetNPackets (), 4, "unexpected number of packets in the queue disc");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (0)->GetQueueDisc ()->GetNPackets (), 3, "unexpected number of packets in the flow queue");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (1)->GetQueueDisc ()->GetNPackets (), 1, "unexpected number of packets in the flow queue");
+  NS_TEST_ASSERT_MSG_EQ (GetFlowNPackets (queueDisc, 0), 3, "unexpected number of packets in the flow queue");
+  NS_TEST_ASSERT_MSG_EQ (GetFlowNPackets (queueDisc, 1), 1, "unexpected number of packets in the flow queue");
   // Add the second packet that causes two packets to be dropped from the fat flow (max backlog = 300, threshold = 150)
   AddPacket (queueDisc, hdr);
   NS_TEST_ASSERT_MSG_EQ (queueDisc->QueueDisc::GetNPackets (), 3, "unexpected number of packets in the queue disc");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (0)->GetQueueDisc ()->GetNPackets (), 1, "unexpected number of packets in the flow queue");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (1)->GetQueueDisc ()->GetNPackets (), 2, "unexpected number of packets in the flow queue");
+  NS_TEST_ASSERT_MSG_EQ (GetFlowNPackets (queueDisc, 0), 1, "unexpected number of packets in the flow queue");
+  NS_TEST_ASSERT_MSG_EQ (GetFlowNPackets (queueDisc, 1), 2, "unexpected number of packets in the flow queue");
 
   Simulator::Destroy ();
 }
@@ -248,82 +261,83 @@ FqCoDelQueueDiscDeficit::DoRun (void)
   // Add a packet from the first flow
   AddPacket (queueDisc, hdr);
   NS_TEST_ASSERT_MSG_EQ (queueDisc->QueueDisc::GetNPackets (), 1, "unexpected number of packets in the queue disc");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (0)->GetQueueDisc ()->GetNPackets (), 1, "unexpected number of packets in the first flow queue");
-  Ptr<FqCoDelFlow> flow1 = StaticCast<FqCoDelFlow> (queueDisc->GetQueueDiscClass (0));
-  NS_TEST_ASSERT_MSG_EQ (flow1->GetDeficit (), static_cast<int32_t> (queueDisc->GetQuantum ()), "the deficit of the first flow must equal the quantum");
-  NS_TEST_ASSERT_MSG_EQ (flow1->GetStatus (), FqCoDelFlow::NEW_FLOW, "the first flow must be in the list of new queues");
+  NS_TEST_ASSERT_MSG_EQ (GetFlowNPackets (queueDisc, 0), 1, "unexpected number of packets in the first flow queue");
+  const FlowQueueTable &table = queueDisc->GetFlowQueueTable ();
+  uint32_t flow1 = table.GetUsedFlow (0);
+  NS_TEST_ASSERT_MSG_EQ (table.GetDeficit (flow1), static_cast<int32_t> (queueDisc->GetQuantum ()), "the deficit of the first flow must equal the quantum");
+  NS_TEST_ASSERT_MSG_EQ (table.GetStatus (flow1), FlowQueueTable::NEW_FLOW, "the first flow must be in the list of new queues");
   // Dequeue a packet
   queueDisc->Dequeue ();
   NS_TEST_ASSERT_MSG_EQ (queueDisc->QueueDisc::GetNPackets (), 0, "unexpected number of packets in the queue disc");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (0)->GetQueueDisc ()->GetNPackets (), 0, "unexpected number of packets in the first flow queue");
+  NS_TEST_ASSERT_MSG_EQ (GetFlowNPackets (queueDisc, 0), 0, "unexpected number of packets in the first flow queue");
   // the deficit for the first flow becomes 90 - (100+20) = -30
-  NS_TEST_ASSERT_MSG_EQ (flow1->GetDeficit (), -30, "unexpected deficit for the first flow");
+  NS_TEST_ASSERT_MSG_EQ (table.GetDeficit (flow1), -30, "unexpected deficit for the first flow");
 
   // Add two packets from the first flow
   AddPacket (queueDisc, hdr);
   AddPacket (queueDisc, hdr);
   NS_TEST_ASSERT_MSG_EQ (queueDisc->QueueDisc::GetNPackets (), 2, "unexpected number of packets in the queue disc");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (0)->GetQueueDisc ()->GetNPackets (), 2, "unexpected number of packets in the first flow queue");
-  NS_TEST_ASSERT_MSG_EQ (flow1->GetStatus (), FqCoDelFlow::NEW_FLOW, "the first flow must still be in the list of new queues");
+  NS_TEST_ASSERT_MSG_EQ (GetFlowNPackets (queueDisc, 0), 2, "unexpected number of packets in the first flow queue");
+  NS_TEST_ASSERT_MSG_EQ (table.GetStatus (flow1), FlowQueueTable::NEW_FLOW, "the first flow must still be in the list of new queues");
 
   // Add two packets from the second flow
   hdr.SetDestination (Ipv4Address ("10.10.1.10"));
   AddPacket (queueDisc, hdr);
   AddPacket (queueDisc, hdr);
   NS_TEST_ASSERT_MSG_EQ (queueDisc->QueueDisc::GetNPackets (), 4, "unexpected number of packets in the queue disc");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (0)->GetQueueDisc ()->GetNPackets (), 2, "unexpected number of packets in the first flow queue");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (1)->GetQueueDisc ()->GetNPackets (), 2, "unexpected number of packets in the second flow queue");
-  Ptr<FqCoDelFlow> flow2 = StaticCast<FqCoDelFlow> (queueDisc->GetQueueDiscClass (1));
-  NS_TEST_ASSERT_MSG_EQ (flow2->GetDeficit (), static_cast<int32_t> (queueDisc->GetQuantum ()), "the deficit of the second flow must equal the quantum");
-  NS_TEST_ASSERT_MSG_EQ (flow2->GetStatus (), FqCoDelFlow::NEW_FLOW, "the second flow must be in the list of new queues");
+  NS_TEST_ASSERT_MSG_EQ (GetFlowNPackets (queueDisc, 0), 2, "unexpected number of packets in the first flow queue");
+  NS_TEST_ASSERT_MSG_EQ (GetFlowNPackets (queueDisc, 1), 2, "unexpected number of packets in the second flow queue");
+  uint32_t flow2 = table.GetUsedFlow (1);
+  NS_TEST_ASSERT_MSG_EQ (table.GetDeficit (flow2), static_cast<int32_t> (queueDisc->GetQuantum ()), "the deficit of the second flow must equal the quantum");
+  NS_TEST_ASSERT_MSG_EQ (table.GetStatus (flow2), FlowQueueTable::NEW_FLOW, "the second flow must be in the list of new queues");
 
   // Dequeue a packet (from the second flow, as the first flow has a negative deficit)
   queueDisc->Dequeue ();
   NS_TEST_ASSERT_MSG_EQ (queueDisc->QueueDisc::GetNPackets (), 3, "unexpected number of packets in the queue disc");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (0)->GetQueueDisc ()->GetNPackets (), 2, "unexpected number of packets in the first flow queue");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (1)->GetQueueDisc ()->GetNPackets (), 1, "unexpected number of packets in the second flow queue");
+  NS_TEST_ASSERT_MSG_EQ (GetFlowNPackets (queueDisc, 0), 2, "unexpected number of packets in the first flow queue");
+  NS_TEST_ASSERT_MSG_EQ (GetFlowNPackets (queueDisc, 1), 1, "unexpected number of packets in the second flow queue");
   // the first flow got a quantum of deficit (-30+90=60) and has been moved to the end of the list of old queues
-  NS_TEST_ASSERT_MSG_EQ (flow1->GetDeficit (), 60, "unexpected deficit for the first flow");
-  NS_TEST_ASSERT_MSG_EQ (flow1->GetStatus (), FqCoDelFlow::OLD_FLOW, "the first flow must be in the list of old queues");
+  NS_TEST_ASSERT_MSG_EQ (table.GetDeficit (flow1), 60, "unexpected deficit for the first flow");
+  NS_TEST_ASSERT_MSG_EQ (table.GetStatus (flow1), FlowQueueTable::OLD_FLOW, "the first flow must be in the list of old queues");
   // the second flow has a negative deficit (-30) and is still in the list of new queues
-  NS_TEST_ASSERT_MSG_EQ (flow2->GetDeficit (), -30, "unexpected deficit for the second flow");
-  NS_TEST_ASSERT_MSG_EQ (flow2->GetStatus (), FqCoDelFlow::NEW_FLOW, "the second flow must be in the list of new queues");
+  NS_TEST_ASSERT_MSG_EQ (table.GetDeficit (flow2), -30, "unexpected deficit for the second flow");
+  NS_TEST_ASSERT_MSG_EQ (table.GetStatus (flow2), FlowQueueTable::NEW_FLOW, "the second flow must be in the list of new queues");
 
   // Dequeue a packet (from the first flow, as the second flow has a negative deficit)
   queueDisc->Dequeue ();
   NS_TEST_ASSERT_MSG_EQ (queueDisc->QueueDisc::GetNPackets (), 2, "unexpected number of packets in the queue disc");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (0)->GetQueueDisc ()->GetNPackets (), 1, "unexpected number of packets in the first flow queue");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (1)->GetQueueDisc ()->GetNPackets (), 1, "unexpected number of packets in the second flow queue");
+  NS_TEST_ASSERT_MSG_EQ (GetFlowNPackets (queueDisc, 0), 1, "unexpected number of packets in the first flow queue");
+  NS_TEST_ASSERT_MSG_EQ (GetFlowNPackets (queueDisc, 1), 1, "unexpected number of packets in the second flow queue");
   // the first flow has a negative deficit (60-(100+20)= -60) and stays in the list of old queues
-  NS_TEST_ASSERT_MSG_EQ (flow1->GetDeficit (), -60, "unexpected deficit for the first flow");
-  NS_TEST_ASSERT_MSG_EQ (flow1->GetStatus (), FqCoDelFlow::OLD_FLOW, "the first flow must be in the list of old queues");
+  NS_TEST_ASSERT_MSG_EQ (table.GetDeficit (flow1), -60, "unexpected deficit for the first flow");
+  NS_TEST_ASSERT_MSG_EQ (table.GetStatus (flow1), FlowQueueTable::OLD_FLOW, "the first flow must be in the list of old queues");
   // the second flow got a quantum of deficit (-30+90=60) and has been moved to the end of the list of old queues
-  NS_TEST_ASSERT_MSG_EQ (flow2->GetDeficit (), 60, "unexpected deficit for the second flow");
-  NS_TEST_ASSERT_MSG_EQ (flow2->GetStatus (), FqCoDelFlow::OLD_FLOW, "the second flow must be in the list of new queues");
+  NS_TEST_ASSERT_MSG_EQ (table.GetDeficit (flow2), 60, "unexpected deficit for the second flow");
+  NS_TEST_ASSERT_MSG_EQ (table.GetStatus (flow2), FlowQueueTable::OLD_FLOW, "the second flow must be in the list of new queues");
 
   // Dequeue a packet (from the second flow, as the first flow has a negative deficit)
   queueDisc->Dequeue ();
   NS_TEST_ASSERT_MSG_EQ (queueDisc->QueueDisc::GetNPackets (), 1, "unexpected number of packets in the queue disc");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (0)->GetQueueDisc ()->GetNPackets (), 1, "unexpected number of packets in the first flow queue");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (1)->GetQueueDisc ()->GetNPackets (), 0, "unexpected number of packets in the second flow queue");
+  NS_TEST_ASSERT_MSG_EQ (GetFlowNPackets (queueDisc, 0), 1, "unexpected number of packets in the first flow queue");
+  NS_TEST_ASSERT_MSG_EQ (GetFlowNPackets (queueDisc, 1), 0, "unexpected number of packets in the second flow queue");
   // the first flow got a quantum of deficit (-60+90=30) and has been moved to the end of the list of old queues
-  NS_TEST_ASSERT_MSG_EQ (flow1->GetDeficit (), 30, "unexpected deficit for the first flow");
-  NS_TEST_ASSERT_MSG_EQ (flow1->GetStatus (), FqCoDelFlow::OLD_FLOW, "the first flow must be in the list of old queues");
+  NS_TEST_ASSERT_MSG_EQ (table.GetDeficit (flow1), 30, "unexpected deficit for the first flow");
+  NS_TEST_ASSERT_MSG_EQ (table.GetStatus (flow1), FlowQueueTable::OLD_FLOW, "the first flow must be in the list of old queues");
   // the second flow has a negative deficit (60-(100+20)= -60)
-  NS_TEST_ASSERT_MSG_EQ (flow2->GetDeficit (), -60, "unexpected deficit for the second flow");
-  NS_TEST_ASSERT_MSG_EQ (flow2->GetStatus (), FqCoDelFlow::OLD_FLOW, "the second flow must be in the list of new queues");
+  NS_TEST_ASSERT_MSG_EQ (table.GetDeficit (flow2), -60, "unexpected deficit for the second flow");
+  NS_TEST_ASSERT_MSG_EQ (table.GetStatus (flow2), FlowQueueTable::OLD_FLOW, "the second flow must be in the list of new queues");
 
   // Dequeue a packet (from the first flow, as the second flow has a negative deficit)
   queueDisc->Dequeue ();
   NS_TEST_ASSERT_MSG_EQ (queueDisc->QueueDisc::GetNPackets (), 0, "unexpected number of packets in the queue disc");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (0)->GetQueueDisc ()->GetNPackets (), 0, "unexpected number of packets in the first flow queue");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (1)->GetQueueDisc ()->GetNPackets (), 0, "unexpected number of packets in the second flow queue");
+  NS_TEST_ASSERT_MSG_EQ (GetFlowNPackets (queueDisc, 0), 0, "unexpected number of packets in the first flow queue");
+  NS_TEST_ASSERT_MSG_EQ (GetFlowNPackets (queueDisc, 1), 0, "unexpected number of packets in the second flow queue");
   // the first flow has a negative deficit (30-(100+20)= -90)
-  NS_TEST_ASSERT_MSG_EQ (flow1->GetDeficit (), -90, "unexpected deficit for the first flow");
-  NS_TEST_ASSERT_MSG_EQ (flow1->GetStatus (), FqCoDelFlow::OLD_FLOW, "the first flow must be in the list of old queues");
+  NS_TEST_ASSERT_MSG_EQ (table.GetDeficit (flow1), -90, "unexpected deficit for the first flow");
+  NS_TEST_ASSERT_MSG_EQ (table.GetStatus (flow1), FlowQueueTable::OLD_FLOW, "the first flow must be in the list of old queues");
   // the second flow got a quantum of deficit (-60+90=30) and has been moved to the end of the list of old queues
-  NS_TEST_ASSERT_MSG_EQ (flow2->GetDeficit (), 30, "unexpected deficit for the second flow");
-  NS_TEST_ASSERT_MSG_EQ (flow2->GetStatus (), FqCoDelFlow::OLD_FLOW, "the second flow must be in the list of new queues");
+  NS_TEST_ASSERT_MSG_EQ (table.GetDeficit (flow2), 30, "unexpected deficit for the second flow");
+  NS_TEST_ASSERT_MSG_EQ (table.GetStatus (flow2), FlowQueueTable::OLD_FLOW, "the second flow must be in the list of new queues");
 
   // Dequeue a packet
   queueDisc->Dequeue ();
@@ -333,10 +347,10 @@ FqCoDelQueueDiscDeficit::DoRun (void)
   // reconsidered, but it has a null deficit, hence it gets another quantum of deficit (0+90=90). Then, the first
   // flow is reconsidered again, now it has a positive deficit and hence it is selected. But, it is empty and
   // therefore is set to inactive, too.
-  NS_TEST_ASSERT_MSG_EQ (flow1->GetDeficit (), 90, "unexpected deficit for the first flow");
-  NS_TEST_ASSERT_MSG_EQ (flow1->GetStatus (), FqCoDelFlow::INACTIVE, "the first flow must be inactive");
-  NS_TEST_ASSERT_MSG_EQ (flow2->GetDeficit (), 30, "unexpected deficit for the second flow");
-  NS_TEST_ASSERT_MSG_EQ (flow2->GetStatus (), FqCoDelFlow::INACTIVE, "the second flow must be inactive");
+  NS_TEST_ASSERT_MSG_EQ (table.GetDeficit (flow1), 90, "unexpected deficit for the first flow");
+  NS_TEST_ASSERT_MSG_EQ (table.GetStatus (flow1), FlowQueueTable::INACTIVE, "the first flow must be inactive");
+  NS_TEST_ASSERT_MSG_EQ (table.GetDeficit (flow2), 30, "unexpected deficit for the second flow");
+  NS_TEST_ASSERT_MSG_EQ (table.GetStatus (flow2), FlowQueueTable::INACTIVE, "the second flow must be inactive");
 
   Simulator::Destroy ();
 }
@@ -397,32 +411,32 @@ FqCoDelQueueDiscTCPFlowsSeparation::DoRun (void)
   AddPacket (queueDisc, hdr, tcpHdr);
   AddPacket (queueDisc, hdr, tcpHdr);
   NS_TEST_ASSERT_MSG_EQ (queueDisc->QueueDisc::GetNPackets (), 3, "unexpected number of packets in the queue disc");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (0)->GetQueueDisc ()->GetNPackets (), 3, "unexpected number of packets in the first flow queue");
+  NS_TEST_ASSERT_MSG_EQ (GetFlowNPackets (queueDisc, 0), 3, "unexpected number of packets in the first flow queue");
 
   // Add a packet from the second flow
   tcpHdr.SetSourcePort (8);
   AddPacket (queueDisc, hdr, tcpHdr);
   NS_TEST_ASSERT_MSG_EQ (queueDisc->QueueDisc::GetNPackets (), 4, "unexpected number of packets in the queue disc");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (0)->GetQueueDisc ()->GetNPackets (), 3, "unexpected number of packets in the first flow queue");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (1)->GetQueueDisc ()->GetNPackets (), 1, "unexpected number of packets in the second flow queue");
+  NS_TEST_ASSERT_MSG_EQ (GetFlowNPackets (queueDisc, 0), 3, "unexpected number of packets in the first flow queue");
+  NS_TEST_ASSERT_MSG_EQ (GetFlowNPackets (queueDisc, 1), 1, "unexpected number of packets in the second flow queue");
 
   // Add a packet from the third flow
   tcpHdr.SetDestinationPort (28);
   AddPacket (queueDisc, hdr, tcpHdr);
   NS_TEST_ASSERT_MSG_EQ (queueDisc->QueueDisc::GetNPackets (), 5, "unexpected number of packets in the queue disc");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (0)->GetQueueDisc ()->GetNPackets (), 3, "unexpected number of packets in the first flow queue");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (1)->GetQueueDisc ()->GetNPackets (), 1, "unexpected number of packets in the second flow queue");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (2)->GetQueueDisc ()->GetNPackets (), 1, "unexpected number of packets in the third flow queue");
+  NS_TEST_ASSERT_MSG_EQ (GetFlowNPackets (queueDisc, 0), 3, "unexpected number of packets in the first flow queue");
+  NS_TEST_ASSERT_MSG_EQ (GetFlowNPackets (queueDisc, 1), 1, "unexpected number of packets in the second flow queue");
+  NS_TEST_ASSERT_MSG_EQ (GetFlowNPackets (queueDisc, 2), 1, "unexpected number of packets in the third flow queue");
 
   // Add two packets from the fourth flow
   tcpHdr.SetSourcePort (7);
   AddPacket (queueDisc, hdr, tcpHdr);
   AddPacket (queueDisc, hdr, tcpHdr);
   NS_TEST_ASSERT_MSG_EQ (queueDisc->QueueDisc::GetNPackets (), 7, "unexpected number of packets in the queue disc");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (0)->GetQueueDisc ()->GetNPackets (), 3, "unexpected number of packets in the first flow queue");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (1)->GetQueueDisc ()->GetNPackets (), 1, "unexpected number of packets in the second flow queue");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (2)->GetQueueDisc ()->GetNPackets (), 1, "unexpected number of packets in the third flow queue");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (3)->GetQueueDisc ()->GetNPackets (), 2, "unexpected number of packets in the third flow queue");
+  NS_TEST_ASSERT_MSG_EQ (GetFlowNPackets (queueDisc, 0), 3, "unexpected number of packets in the first flow queue");
+  NS_TEST_ASSERT_MSG_EQ (GetFlowNPackets (queueDisc, 1), 1, "unexpected number of packets in the second flow queue");
+  NS_TEST_ASSERT_MSG_EQ (GetFlowNPackets (queueDisc, 2), 1, "unexpected number of packets in the third flow queue");
+  NS_TEST_ASSERT_MSG_EQ (GetFlowNPackets (queueDisc, 3), 2, "unexpected number of packets in the third flow queue");
 
   Simulator::Destroy ();
 }
@@ -483,32 +497,32 @@ FqCoDelQueueDiscUDPFlowsSeparation::DoRun (void)
   AddPacket (queueDisc, hdr, udpHdr);
   AddPacket (queueDisc, hdr, udpHdr);
   NS_TEST_ASSERT_MSG_EQ (queueDisc->QueueDisc::GetNPackets (), 3, "unexpected number of packets in the queue disc");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (0)->GetQueueDisc ()->GetNPackets (), 3, "unexpected number of packets in the first flow queue");
+  NS_TEST_ASSERT_MSG_EQ (GetFlowNPackets (queueDisc, 0), 3, "unexpected number of packets in the first flow queue");
 
   // Add a packet from the second flow
   udpHdr.SetSourcePort (8);
   AddPacket (queueDisc, hdr, udpHdr);
   NS_TEST_ASSERT_MSG_EQ (queueDisc->QueueDisc::GetNPackets (), 4, "unexpected number of packets in the queue disc");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (0)->GetQueueDisc ()->GetNPackets (), 3, "unexpected number of packets in the first flow queue");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (1)->GetQueueDisc ()->GetNPackets (), 1, "unexpected number of packets in the second flow queue");
+  NS_TEST_ASSERT_MSG_EQ (GetFlowNPackets (queueDisc, 0), 3, "unexpected number of packets in the first flow queue");
+  NS_TEST_ASSERT_MSG_EQ (GetFlowNPackets (queueDisc, 1), 1, "unexpected number of packets in the second flow queue");
 
   // Add a packet from the third flow
   udpHdr.SetDestinationPort (28);
   AddPacket (queueDisc, hdr, udpHdr);
   NS_TEST_ASSERT_MSG_EQ (queueDisc->QueueDisc::GetNPackets (), 5, "unexpected number of packets in the queue disc");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (0)->GetQueueDisc ()->GetNPackets (), 3, "unexpected number of packets in the first flow queue");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (1)->GetQueueDisc ()->GetNPackets (), 1, "unexpected number of packets in the second flow queue");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (2)->GetQueueDisc ()->GetNPackets (), 1, "unexpected number of packets in the third flow queue");
+  NS_TEST_ASSERT_MSG_EQ (GetFlowNPackets (queueDisc, 0), 3, "unexpected number of packets in the first flow queue");
+  NS_TEST_ASSERT_MSG_EQ (GetFlowNPackets (queueDisc, 1), 1, "unexpected number of packets in the second flow queue");
+  NS_TEST_ASSERT_MSG_EQ (GetFlowNPackets (queueDisc, 2), 1, "unexpected number of packets in the third flow queue");
 
   // Add two packets from the fourth flow
   udpHdr.SetSourcePort (7);
   AddPacket (queueDisc, hdr, udpHdr);
   AddPacket (queueDisc, hdr, udpHdr);
   NS_TEST_ASSERT_MSG_EQ (queueDisc->QueueDisc::GetNPackets (), 7, "unexpected number of packets in the queue disc");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (0)->GetQueueDisc ()->GetNPackets (), 3, "unexpected number of packets in the first flow queue");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (1)->GetQueueDisc ()->GetNPackets (), 1, "unexpected number of packets in the second flow queue");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (2)->GetQueueDisc ()->GetNPackets (), 1, "unexpected number of packets in the third flow queue");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (3)->GetQueueDisc ()->GetNPackets (), 2, "unexpected number of packets in the third flow queue");
+  NS_TEST_ASSERT_MSG_EQ (GetFlowNPackets (queueDisc, 0), 3, "unexpected number of packets in the first flow queue");
+  NS_TEST_ASSERT_MSG_EQ (GetFlowNPackets (queueDisc, 1), 1, "unexpected number of packets in the second flow queue");
+  NS_TEST_ASSERT_MSG_EQ (GetFlowNPackets (queueDisc, 2), 1, "unexpected number of packets in the third flow queue");
+  NS_TEST_ASSERT_MSG_EQ (GetFlowNPackets (queueDisc, 3), 2, "unexpected number of packets in the third flow queue");
 
   Simulator::Destroy ();
 }
@@ -28,6 +28,15 @@
 #include "ns3/pointer.h"
 #include "ns3/object-factory.h"
 #include "ns3/socket.h"
+#include "ns3/node-container.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/traffic-control-helper.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/inet-socket-address.h"
+#include <set>
+#include <sstream>
 
 using namespace ns3;
 
@@ -326,6 +335,130 @@ PfifoFastQueueDiscNoPriority::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * This class tests that the pfifo_fast children of an mq queue disc installed
+ * on a multi-queue point-to-point device enqueue the packets in the band
+ * given by their priority, whatever transmission queue is selected for them
+ */
+class PfifoFastQueueDiscMqPrioritization : public TestCase
+{
+public:
+  PfifoFastQueueDiscMqPrioritization ();
+  virtual ~PfifoFastQueueDiscMqPrioritization ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Record a packet enqueued in a band of a child queue disc
+   * \param context the transmission queue and the band
+   * \param item the enqueued item
+   */
+  void Enqueue (std::string context, Ptr<const QueueDiscItem> item);
+  /**
+   * Send a packet through a socket
+   * \param socket the socket
+   * \param size the size of the packet
+   */
+  void SendPacket (Ptr<Socket> socket, uint32_t size);
+  /**
+   * Connect to the enqueue traces of the bands of the child queue discs,
+   * which are created when the queue discs are initialized
+   * \param mq the mq queue disc
+   */
+  void ConnectTraces (Ptr<QueueDisc> mq);
+
+  uint32_t m_enqueued;            //!< number of enqueued packets
+  std::set<uint32_t> m_txQueues;  //!< transmission queues of the enqueued packets
+};
+
+PfifoFastQueueDiscMqPrioritization::PfifoFastQueueDiscMqPrioritization ()
+  : TestCase ("Test priority-based prioritization under a multi-queue device"),
+    m_enqueued (0)
+{
+}
+
+PfifoFastQueueDiscMqPrioritization::~PfifoFastQueueDiscMqPrioritization ()
+{
+}
+
+void
+PfifoFastQueueDiscMqPrioritization::Enqueue (std::string context, Ptr<const QueueDiscItem> item)
+{
+  // the priority of the packet is given by the size of its payload
+  static const uint32_t prio2band[16] = {1, 2, 2, 2, 1, 2, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1};
+  std::istringstream iss (context);
+  uint32_t txq, band;
+  iss >> txq >> band;
+  uint32_t priority = item->GetPacket ()->GetSize () - 8 - 100;
+  NS_TEST_EXPECT_MSG_EQ (band, prio2band[priority], "A packet with priority " << priority
+                         << " sent on transmission queue " << txq << " is enqueued in the wrong band");
+  m_txQueues.insert (txq);
+  m_enqueued++;
+}
+
+void
+PfifoFastQueueDiscMqPrioritization::SendPacket (Ptr<Socket> socket, uint32_t size)
+{
+  socket->Send (Create<Packet> (size));
+}
+
+void
+PfifoFastQueueDiscMqPrioritization::ConnectTraces (Ptr<QueueDisc> mq)
+{
+  for (uint32_t txq = 0; txq < mq->GetNQueueDiscClasses (); txq++)
+    {
+      Ptr<QueueDisc> child = mq->GetQueueDiscClass (txq)->GetQueueDisc ();
+      for (uint32_t band = 0; band < child->GetNInternalQueues (); band++)
+        {
+          std::ostringstream oss;
+          oss << txq << " " << band;
+          child->GetInternalQueue (band)->TraceConnect ("Enqueue", oss.str (),
+                                                         MakeCallback (&PfifoFastQueueDiscMqPrioritization::Enqueue, this));
+        }
+    }
+}
+
+void
+PfifoFastQueueDiscMqPrioritization::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+  PointToPointHelper p2p;
+  p2p.SetNTxQueues (4);
+  NetDeviceContainer devices = p2p.Install (nodes);
+
+  InternetStackHelper stack;
+  stack.Install (nodes);
+
+  TrafficControlHelper tch;
+  uint16_t handle = tch.SetRootQueueDisc ("ns3::MqQueueDisc");
+  TrafficControlHelper::ClassIdList cls = tch.AddQueueDiscClasses (handle, 4, "ns3::QueueDiscClass");
+  tch.AddChildQueueDiscs (handle, cls, "ns3::PfifoFastQueueDisc");
+  QueueDiscContainer qdiscs = tch.Install (devices);
+
+  Ipv4AddressHelper address ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = address.Assign (devices);
+
+  Simulator::Schedule (Seconds (0.5), &PfifoFastQueueDiscMqPrioritization::ConnectTraces, this, qdiscs.Get (0));
+
+  // each flow is hashed to a transmission queue, regardless of its priority
+  uint8_t priorities[] = {0, 2, 6};
+  for (uint32_t i = 0; i < 24; i++)
+    {
+      Ptr<Socket> socket = Socket::CreateSocket (nodes.Get (0), UdpSocketFactory::GetTypeId ());
+      socket->Connect (InetSocketAddress (interfaces.GetAddress (1), 9));
+      socket->SetPriority (priorities[i % 3]);
+      Simulator::Schedule (Seconds (1), &PfifoFastQueueDiscMqPrioritization::SendPacket, this,
+                           socket, 100 + priorities[i % 3]);
+    }
+
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_enqueued, 24, "Unexpected number of enqueued packets");
+  NS_TEST_EXPECT_MSG_GT (m_txQueues.size (), 1, "The flows should be spread over several transmission queues");
+  Simulator::Destroy ();
+}
+
 class PfifoFastQueueDiscTestSuite : public TestSuite
 {
 public:
@@ -339,6 +472,7 @@ PfifoFastQueueDiscTestSuite::PfifoFastQueueDiscTestSuite ()
   AddTestCase (new PfifoFastQueueDiscDscpPrioritization, TestCase::QUICK);
   AddTestCase (new PfifoFastQueueDiscOverflow, TestCase::QUICK);
   AddTestCase (new PfifoFastQueueDiscNoPriority, TestCase::QUICK);
+  AddTestCase (new PfifoFastQueueDiscMqPrioritization, TestCase::QUICK);
 }
 
 static PfifoFastQueueDiscTestSuite pfifoFastQueueTestSuite;
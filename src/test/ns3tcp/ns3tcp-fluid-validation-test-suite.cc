@@ -0,0 +1,326 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/test.h"
+#include "ns3/config.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/point-to-point-fluid-manager.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-global-routing-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/packet-sink-helper.h"
+#include "ns3/packet-sink.h"
+#include "ns3/bulk-send-helper.h"
+#include "ns3/traffic-control-helper.h"
+#include "ns3/node-container.h"
+#include "ns3/simulator.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("Ns3TcpFluidValidationTest");
+
+// ===========================================================================
+// Validation of the fluid model of bulk transfers over point-to-point links
+// against packet-level TCP transfers
+// ===========================================================================
+//
+//   n0 ---+
+//         | 100Mbps, 1ms
+//         r ---------------- n2
+//         |  10Mbps, 5ms
+//   n1 ---+
+//
+// A 2MB transfer from n0 to n2 starts at time 0 and a 1MB transfer from n1
+// to n2 starts at time 0.5s. The flow completion times obtained with the
+// fluid model must be close to those obtained with packet-level TCP.
+//
+class Ns3TcpFluidValidationTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor
+   *
+   * \param queueDisc the root queue disc installed on the bottleneck link
+   */
+  Ns3TcpFluidValidationTestCase (std::string queueDisc);
+  virtual ~Ns3TcpFluidValidationTestCase () {}
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Create the topology, install the internet stack and the queue discs
+   */
+  void CreateTopology (void);
+
+  /**
+   * Run the transfers at the packet level and record their completion times
+   */
+  void RunPacketLevel (void);
+
+  /**
+   * Run the transfers with the fluid model and record their completion times
+   */
+  void RunFluid (void);
+
+  /**
+   * Start a packet-level transfer
+   *
+   * \param src the source node
+   * \param port the destination port
+   * \param bytes the number of bytes to transfer
+   * \param start the start time
+   */
+  void InstallBulkSend (Ptr<Node> src, uint16_t port, uint64_t bytes, Time start);
+
+  /**
+   * Record the completion of a packet-level transfer
+   *
+   * \param context the index of the transfer
+   * \param p the received packet
+   * \param from the sender address
+   */
+  void SinkRx (std::string context, Ptr<const Packet> p, const Address &from);
+
+  /**
+   * Record the completion of a fluid flow
+   *
+   * \param flowId the flow ID
+   * \param fct the flow completion time
+   */
+  void FluidFlowCompleted (uint32_t flowId, Time fct);
+
+  /**
+   * Start a packet-level transfer for a flow that cannot be modeled as a fluid flow
+   *
+   * \param flowId the flow ID
+   * \param src the source node
+   * \param dst the destination node
+   * \param bytes the number of bytes to transfer
+   */
+  void PacketLevelFlow (uint32_t flowId, Ptr<Node> src, Ptr<Node> dst, uint64_t bytes);
+
+  std::string m_queueDisc;            //!< root queue disc on the bottleneck link
+  NodeContainer m_senders;            //!< sender nodes
+  NodeContainer m_router;             //!< router node
+  NodeContainer m_receiver;           //!< receiver node
+  Ipv4Address m_receiverAddress;      //!< address of the receiver
+  std::vector<Ptr<PacketSink> > m_sinks; //!< sinks of the packet-level transfers
+  std::vector<uint64_t> m_sinkBytes;  //!< bytes of the packet-level transfers
+  std::vector<Time> m_sinkStart;      //!< start times of the packet-level transfers
+  std::vector<Time> m_packetFct;      //!< flow completion times (packet level)
+  std::vector<Time> m_fluidFct;       //!< flow completion times (fluid model)
+  uint32_t m_nPacketLevelFlows;       //!< flows the fluid manager handed to the packet level
+};
+
+static const uint64_t g_bytes[] = {2000000, 1000000};   //!< bytes transferred by each flow
+static const double g_start[] = {0.0, 0.5};             //!< start time of each flow (seconds)
+
+Ns3TcpFluidValidationTestCase::Ns3TcpFluidValidationTestCase (std::string queueDisc)
+  : TestCase ("Check the fluid model of bulk transfers against TCP (" + queueDisc + " on the bottleneck)"),
+    m_queueDisc (queueDisc),
+    m_nPacketLevelFlows (0)
+{
+}
+
+void
+Ns3TcpFluidValidationTestCase::CreateTopology (void)
+{
+  m_senders = NodeContainer ();
+  m_router = NodeContainer ();
+  m_receiver = NodeContainer ();
+  m_senders.Create (2);
+  m_router.Create (1);
+  m_receiver.Create (1);
+
+  PointToPointHelper access;
+  access.SetDeviceAttribute ("DataRate", StringValue ("100Mbps"));
+  access.SetChannelAttribute ("Delay", StringValue ("1ms"));
+  PointToPointHelper bottleneck;
+  bottleneck.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  bottleneck.SetChannelAttribute ("Delay", StringValue ("5ms"));
+  bottleneck.SetQueue ("ns3::DropTailQueue", "MaxSize", StringValue ("10p"));
+
+  NetDeviceContainer dev0 = access.Install (m_senders.Get (0), m_router.Get (0));
+  NetDeviceContainer dev1 = access.Install (m_senders.Get (1), m_router.Get (0));
+  NetDeviceContainer dev2 = bottleneck.Install (m_router.Get (0), m_receiver.Get (0));
+
+  InternetStackHelper stack;
+  stack.Install (m_senders);
+  stack.Install (m_router);
+  stack.Install (m_receiver);
+
+  TrafficControlHelper tch;
+  tch.SetRootQueueDisc (m_queueDisc, "MaxSize", StringValue ("50p"));
+  tch.Install (dev2.Get (0));
+
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.1.0", "255.255.255.0");
+  address.Assign (dev0);
+  address.SetBase ("10.1.2.0", "255.255.255.0");
+  address.Assign (dev1);
+  address.SetBase ("10.1.3.0", "255.255.255.0");
+  m_receiverAddress = address.Assign (dev2).GetAddress (1);
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+}
+
+void
+Ns3TcpFluidValidationTestCase::SinkRx (std::string context, Ptr<const Packet> p, const Address &from)
+{
+  uint32_t index = std::stoi (context);
+  if (m_sinks[index]->GetTotalRx () == m_sinkBytes[index])
+    {
+      m_packetFct[index] = Simulator::Now () - m_sinkStart[index];
+    }
+}
+
+void
+Ns3TcpFluidValidationTestCase::InstallBulkSend (Ptr<Node> src, uint16_t port, uint64_t bytes, Time start)
+{
+  uint32_t index = m_packetFct.size ();
+  m_packetFct.push_back (Seconds (0));
+
+  PacketSinkHelper sinkHelper ("ns3::TcpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), port));
+  Ptr<PacketSink> sink = DynamicCast<PacketSink> (sinkHelper.Install (m_receiver.Get (0)).Get (0));
+  sink->TraceConnect ("Rx", std::to_string (index),
+                      MakeCallback (&Ns3TcpFluidValidationTestCase::SinkRx, this));
+  m_sinks.push_back (sink);
+  m_sinkBytes.push_back (bytes);
+  m_sinkStart.push_back (start);
+
+  BulkSendHelper source ("ns3::TcpSocketFactory", InetSocketAddress (m_receiverAddress, port));
+  source.SetAttribute ("MaxBytes", UintegerValue (bytes));
+  ApplicationContainer apps = source.Install (src);
+  apps.Start (start);
+}
+
+void
+Ns3TcpFluidValidationTestCase::RunPacketLevel (void)
+{
+  CreateTopology ();
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      InstallBulkSend (m_senders.Get (i), 50000 + i, g_bytes[i], Seconds (g_start[i]));
+    }
+  Simulator::Stop (Seconds (20));
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+void
+Ns3TcpFluidValidationTestCase::FluidFlowCompleted (uint32_t flowId, Time fct)
+{
+  m_fluidFct[flowId - 1] = fct;
+}
+
+void
+Ns3TcpFluidValidationTestCase::PacketLevelFlow (uint32_t flowId, Ptr<Node> src, Ptr<Node> dst, uint64_t bytes)
+{
+  m_nPacketLevelFlows++;
+  InstallBulkSend (src, 50000 + flowId, bytes, Simulator::Now ());
+}
+
+void
+Ns3TcpFluidValidationTestCase::RunFluid (void)
+{
+  CreateTopology ();
+  m_fluidFct.assign (2, Seconds (0));
+
+  Ptr<PointToPointFluidManager> manager = CreateObject<PointToPointFluidManager> ();
+  manager->TraceConnectWithoutContext ("FlowCompleted",
+                                       MakeCallback (&Ns3TcpFluidValidationTestCase::FluidFlowCompleted, this));
+  manager->SetPacketLevelFlowCallback (MakeCallback (&Ns3TcpFluidValidationTestCase::PacketLevelFlow, this));
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      Simulator::Schedule (Seconds (g_start[i]), &PointToPointFluidManager::AddFlow, manager,
+                           m_senders.Get (i), m_receiver.Get (0), g_bytes[i]);
+    }
+  Simulator::Stop (Seconds (20));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  manager->Dispose ();
+}
+
+void
+Ns3TcpFluidValidationTestCase::DoRun (void)
+{
+  Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (1448));
+
+  RunPacketLevel ();
+  NS_TEST_ASSERT_MSG_EQ (m_packetFct.size (), 2, "Unexpected number of packet-level transfers");
+  std::vector<Time> packetFct;
+  packetFct.swap (m_packetFct);
+  m_sinks.clear ();
+  m_sinkBytes.clear ();
+  m_sinkStart.clear ();
+
+  RunFluid ();
+
+  if (m_queueDisc == "ns3::RedQueueDisc")
+    {
+      // links managed by RED are modeled at the packet level, hence both
+      // transfers must be completed by packet-level TCP
+      NS_TEST_EXPECT_MSG_EQ (m_nPacketLevelFlows, 2, "Both flows should be modeled at the packet level");
+      NS_TEST_ASSERT_MSG_EQ (m_packetFct.size (), 2, "Unexpected number of packet-level transfers");
+      for (uint32_t i = 0; i < 2; i++)
+        {
+          NS_TEST_EXPECT_MSG_GT (m_packetFct[i], Seconds (0), "The packet-level transfer did not complete");
+          NS_TEST_EXPECT_MSG_EQ (m_fluidFct[i], Seconds (0), "No fluid flow should have completed");
+        }
+      return;
+    }
+
+  NS_TEST_EXPECT_MSG_EQ (m_nPacketLevelFlows, 0, "Both flows should be modeled as fluid flows");
+
+  // TCP flows only share the bottleneck fairly on average, hence the FCT of
+  // each flow is only checked loosely, while the time needed to complete all
+  // the transfers, which depends on the bottleneck capacity, is checked tightly
+  double packetEnd = 0;
+  double fluidEnd = 0;
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      NS_LOG_INFO ("Flow " << i << ": packet level FCT " << packetFct[i].GetSeconds ()
+                   << "s, fluid FCT " << m_fluidFct[i].GetSeconds () << "s");
+      NS_TEST_EXPECT_MSG_GT (packetFct[i], Seconds (0), "The packet-level transfer did not complete");
+      NS_TEST_EXPECT_MSG_EQ_TOL (m_fluidFct[i].GetSeconds (), packetFct[i].GetSeconds (),
+                                 0.25 * packetFct[i].GetSeconds (),
+                                 "The fluid FCT differs from the packet-level FCT by more than 25%");
+      packetEnd = std::max (packetEnd, g_start[i] + packetFct[i].GetSeconds ());
+      fluidEnd = std::max (fluidEnd, g_start[i] + m_fluidFct[i].GetSeconds ());
+    }
+  NS_TEST_EXPECT_MSG_EQ_TOL (fluidEnd, packetEnd, 0.1 * packetEnd,
+                             "The transfers complete at times differing by more than 10%");
+}
+
+class Ns3TcpFluidValidationTestSuite : public TestSuite
+{
+public:
+  Ns3TcpFluidValidationTestSuite ();
+};
+
+Ns3TcpFluidValidationTestSuite::Ns3TcpFluidValidationTestSuite ()
+  : TestSuite ("ns3-tcp-fluid-validation", SYSTEM)
+{
+  AddTestCase (new Ns3TcpFluidValidationTestCase ("ns3::FifoQueueDisc"), TestCase::QUICK);
+  AddTestCase (new Ns3TcpFluidValidationTestCase ("ns3::RedQueueDisc"), TestCase::QUICK);
+}
+
+static Ns3TcpFluidValidationTestSuite ns3TcpFluidValidationTestSuite;
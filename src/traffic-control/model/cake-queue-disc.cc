@@ -0,0 +1,146 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "cake-queue-disc.h"
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("CakeQueueDisc");
+
+NS_OBJECT_ENSURE_REGISTERED (CakeQueueDisc);
+
+TypeId CakeQueueDisc::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CakeQueueDisc")
+    .SetParent<FqCoDelQueueDisc> ()
+    .SetGroupName ("TrafficControl")
+    .AddConstructor<CakeQueueDisc> ()
+    .AddAttribute ("Bandwidth",
+                   "The rate of the shaper (0 to disable the shaper)",
+                   DataRateValue (DataRate (0)),
+                   MakeDataRateAccessor (&CakeQueueDisc::m_bandwidth),
+                   MakeDataRateChecker ())
+    .AddAttribute ("SetWays",
+                   "The number of flow queues of a set of the set-associative hash (1 to disable)",
+                   UintegerValue (8),
+                   MakeUintegerAccessor (&CakeQueueDisc::m_ways),
+                   MakeUintegerChecker<uint32_t> (1))
+  ;
+  return tid;
+}
+
+CakeQueueDisc::CakeQueueDisc ()
+  : m_collisions (0),
+    m_timeNext (Seconds (0))
+{
+  NS_LOG_FUNCTION (this);
+}
+
+CakeQueueDisc::~CakeQueueDisc ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+CakeQueueDisc::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_watchdog.Cancel ();
+  m_tags.clear ();
+  FqCoDelQueueDisc::DoDispose ();
+}
+
+uint32_t
+CakeQueueDisc::GetNCollisions (void) const
+{
+  return m_collisions;
+}
+
+uint32_t
+CakeQueueDisc::SelectFlow (uint32_t hash)
+{
+  NS_LOG_FUNCTION (this << hash);
+  const FlowQueueTable &table = GetFlowQueueTable ();
+  uint32_t nFlows = table.GetNFlows ();
+  uint32_t reduced = hash % nFlows;
+  uint32_t outer = reduced - reduced % m_ways;
+  uint32_t ways = std::min (m_ways, nFlows - outer);
+  uint32_t inner = reduced - outer;
+
+  // look for the flow queue of this flow in the set
+  for (uint32_t i = 0, k = inner; i < ways; i++, k = (k + 1) % ways)
+    {
+      if (m_tags[outer + k] == hash)
+        {
+          return outer + k;
+        }
+    }
+  // look for a free flow queue in the set
+  for (uint32_t i = 0, k = inner; i < ways; i++, k = (k + 1) % ways)
+    {
+      if (table.GetStatus (outer + k) == FlowQueueTable::INACTIVE)
+        {
+          m_tags[outer + k] = hash;
+          return outer + k;
+        }
+    }
+  // with no free flow queue, share the original one
+  NS_LOG_DEBUG ("Hash collision in flow queue " << reduced);
+  m_collisions++;
+  m_tags[reduced] = hash;
+  return reduced;
+}
+
+Ptr<QueueDiscItem>
+CakeQueueDisc::DoDequeue (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  Time now = Simulator::Now ();
+  if (m_bandwidth.GetBitRate () > 0 && m_timeNext > now)
+    {
+      // restart the queue disc when the shaper allows, unless this has
+      // been done already
+      if (GetNPackets () > 0 && !m_watchdog.IsRunning ())
+        {
+          m_watchdog = Simulator::Schedule (m_timeNext - now, &QueueDisc::Run, this);
+          NS_LOG_LOGIC ("Waking Event Scheduled in " << m_timeNext - now);
+        }
+      return 0;
+    }
+
+  Ptr<QueueDiscItem> item = FqCoDelQueueDisc::DoDequeue ();
+
+  if (item && m_bandwidth.GetBitRate () > 0)
+    {
+      m_timeNext = std::max (m_timeNext, now) + m_bandwidth.CalculateBytesTxTime (item->GetSize ());
+    }
+  return item;
+}
+
+void
+CakeQueueDisc::InitializeParams (void)
+{
+  NS_LOG_FUNCTION (this);
+  FqCoDelQueueDisc::InitializeParams ();
+  m_tags.assign (GetFlowQueueTable ().GetNFlows (), 0);
+}
+
+} // namespace ns3
@@ -0,0 +1,86 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef CAKE_QUEUE_DISC_H
+#define CAKE_QUEUE_DISC_H
+
+#include "ns3/data-rate.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "fq-codel-queue-disc.h"
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief A Cake (Common Applications Kept Enhanced) packet queue disc
+ *
+ * A simplified model of the Linux cake queue disc, built on the flow queues
+ * of FqCoDelQueueDisc (DRR++ scheduling of new and old flows, CoDel AQM on
+ * each flow queue, dropping from the fattest flow on overflow), with the
+ * following additions:
+ *
+ * - set-associative hashing: a packet whose flow queue is used by another
+ *   flow is stored in another free flow queue of the same set of
+ *   ``SetWays`` queues, if any, which makes hash collisions unlikely;
+ * - a deficit-mode shaper: if the ``Bandwidth`` attribute is not null,
+ *   the packets are released at most at such rate, and a single event
+ *   restarts the queue disc when the next packet can be sent.
+ *
+ * The BLUE component of the COBALT AQM, the DiffServ tins and the host
+ * isolation of the Linux implementation are not modeled.
+ */
+class CakeQueueDisc : public FqCoDelQueueDisc
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  /**
+   * \brief CakeQueueDisc constructor
+   */
+  CakeQueueDisc ();
+
+  virtual ~CakeQueueDisc ();
+
+  /**
+   * \brief Get the number of packets stored in a flow queue used by another flow
+   * \return the number of hash collisions
+   */
+  uint32_t GetNCollisions (void) const;
+
+protected:
+  virtual void DoDispose (void);
+  virtual Ptr<QueueDiscItem> DoDequeue (void);
+  virtual void InitializeParams (void);
+  virtual uint32_t SelectFlow (uint32_t hash);
+
+private:
+  DataRate m_bandwidth;           //!< Rate of the shaper
+  uint32_t m_ways;                //!< Number of flow queues of a set
+  std::vector<uint32_t> m_tags;   //!< Hash of the flow of each flow queue
+  uint32_t m_collisions;          //!< Number of hash collisions
+  Time m_timeNext;                //!< Time at which the shaper releases the next packet
+  EventId m_watchdog;             //!< Event restarting the queue disc when the shaper allows
+};
+
+} // namespace ns3
+
+#endif /* CAKE_QUEUE_DISC_H */
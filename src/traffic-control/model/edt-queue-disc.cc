@@ -0,0 +1,230 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/drop-tail-queue.h"
+#include "ns3/departure-time-tag.h"
+#include "edt-queue-disc.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("EdtQueueDisc");
+
+NS_OBJECT_ENSURE_REGISTERED (EdtQueueDisc);
+
+TypeId EdtQueueDisc::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::EdtQueueDisc")
+    .SetParent<QueueDisc> ()
+    .SetGroupName ("TrafficControl")
+    .AddConstructor<EdtQueueDisc> ()
+    .AddAttribute ("MaxSize",
+                   "The max queue size",
+                   QueueSizeValue (QueueSize ("10000p")),
+                   MakeQueueSizeAccessor (&QueueDisc::SetMaxSize,
+                                          &QueueDisc::GetMaxSize),
+                   MakeQueueSizeChecker ())
+    .AddAttribute ("Flows",
+                   "The number of queues into which the incoming packets are classified",
+                   UintegerValue (1024),
+                   MakeUintegerAccessor (&EdtQueueDisc::m_flows),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("Perturbation",
+                   "The salt used as an additional input to the hash function used to classify packets",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&EdtQueueDisc::m_perturbation),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("Horizon",
+                   "The packets whose departure time is farther than this in the future are dropped",
+                   TimeValue (Seconds (10)),
+                   MakeTimeAccessor (&EdtQueueDisc::m_horizon),
+                   MakeTimeChecker ())
+  ;
+  return tid;
+}
+
+EdtQueueDisc::EdtQueueDisc ()
+  : QueueDisc (QueueDiscSizePolicy::MULTIPLE_QUEUES)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+EdtQueueDisc::~EdtQueueDisc ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+EdtQueueDisc::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_watchdog.Cancel ();
+  m_schedule.clear ();
+  QueueDisc::DoDispose ();
+}
+
+Time
+EdtQueueDisc::GetDepartureTime (Ptr<const QueueDiscItem> item, Time arrival) const
+{
+  DepartureTimeTag tag;
+  if (item->GetPacket ()->PeekPacketTag (tag))
+    {
+      return tag.GetDepartureTime ();
+    }
+  return arrival;
+}
+
+bool
+EdtQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
+{
+  NS_LOG_FUNCTION (this << item);
+
+  if (GetCurrentSize () + item > GetMaxSize ())
+    {
+      NS_LOG_LOGIC ("Queue full -- dropping pkt");
+      DropBeforeEnqueue (item, LIMIT_EXCEEDED_DROP);
+      return false;
+    }
+
+  Time departure = GetDepartureTime (item, Simulator::Now ());
+  if (departure > Simulator::Now () + m_horizon)
+    {
+      NS_LOG_LOGIC ("Departure time " << departure << " beyond the horizon -- dropping pkt");
+      DropBeforeEnqueue (item, HORIZON_DROP);
+      return false;
+    }
+
+  uint32_t h = 0;
+  if (GetNPacketFilters () == 0)
+    {
+      h = item->Hash (m_perturbation) % m_flows;
+    }
+  else
+    {
+      int32_t ret = Classify (item);
+
+      if (ret != PacketFilter::PF_NO_MATCH)
+        {
+          h = ret % m_flows;
+        }
+      else
+        {
+          NS_LOG_ERROR ("No filter has been able to classify this packet, drop it.");
+          DropBeforeEnqueue (item, UNCLASSIFIED_DROP);
+          return false;
+        }
+    }
+
+  uint32_t index;
+  std::map<uint32_t, uint32_t>::const_iterator it = m_flowsIndices.find (h);
+  if (it == m_flowsIndices.end ())
+    {
+      NS_LOG_DEBUG ("Creating a new flow queue with index " << h);
+      AddInternalQueue (CreateObjectWithAttributes<DropTailQueue<QueueDiscItem> >
+                          ("MaxSize", QueueSizeValue (GetMaxSize ())));
+      index = GetNInternalQueues () - 1;
+      m_flowsIndices[h] = index;
+    }
+  else
+    {
+      index = it->second;
+    }
+
+  Ptr<InternalQueue> queue = GetInternalQueue (index);
+  if (queue->IsEmpty ())
+    {
+      m_schedule.insert (std::make_pair (departure, index));
+    }
+
+  bool retval = queue->Enqueue (item);
+
+  // If Queue::Enqueue fails, QueueDisc::DropBeforeEnqueue is called by the
+  // internal queue because QueueDisc::AddInternalQueue sets the trace callback
+
+  NS_LOG_LOGIC ("Packet enqueued into flow " << h << " with departure time " << departure);
+
+  return retval;
+}
+
+Ptr<QueueDiscItem>
+EdtQueueDisc::DoDequeue (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_schedule.empty ())
+    {
+      NS_LOG_LOGIC ("Queue empty");
+      return 0;
+    }
+
+  Time now = Simulator::Now ();
+  Schedule::iterator first = m_schedule.begin ();
+  if (first->first > now)
+    {
+      // restart the queue disc at the earliest departure time, unless this
+      // has been done already
+      Time wakeup = first->first;
+      if (!m_watchdog.IsRunning () || Simulator::GetDelayLeft (m_watchdog) > wakeup - now)
+        {
+          m_watchdog.Cancel ();
+          m_watchdog = Simulator::Schedule (wakeup - now, &QueueDisc::Run, this);
+          NS_LOG_LOGIC ("Waking Event Scheduled in " << wakeup - now);
+        }
+      return 0;
+    }
+
+  uint32_t index = first->second;
+  m_schedule.erase (first);
+  Ptr<InternalQueue> queue = GetInternalQueue (index);
+  Ptr<QueueDiscItem> item = queue->Dequeue ();
+
+  Ptr<const QueueDiscItem> next = queue->Peek ();
+  if (next)
+    {
+      m_schedule.insert (std::make_pair (GetDepartureTime (next, next->GetTimeStamp ()), index));
+    }
+
+  return item;
+}
+
+bool
+EdtQueueDisc::CheckConfig (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (GetNQueueDiscClasses () > 0)
+    {
+      NS_LOG_ERROR ("EdtQueueDisc cannot have classes");
+      return false;
+    }
+
+  if (GetNInternalQueues () > 0)
+    {
+      NS_LOG_ERROR ("EdtQueueDisc cannot have internal queues");
+      return false;
+    }
+
+  return true;
+}
+
+void
+EdtQueueDisc::InitializeParams (void)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+} // namespace ns3
@@ -0,0 +1,98 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef EDT_QUEUE_DISC_H
+#define EDT_QUEUE_DISC_H
+
+#include "ns3/queue-disc.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include <map>
+#include <set>
+
+namespace ns3 {
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief Earliest Departure Time queue disc
+ *
+ * The packets are released no earlier than the departure time carried by
+ * their DepartureTimeTag (the packets without such a tag can leave at once),
+ * in the order of their departure times. This is the timing model of the
+ * Linux fq queue disc, which enforces the pacing of the TCP sockets setting
+ * the departure time of their segments (see the PacingMode attribute of
+ * TcpL4Protocol).
+ *
+ * The packets are classified into flow queues, as in FqCoDelQueueDisc.
+ * Since the departure times of the packets of a flow are not decreasing,
+ * each flow queue is a FIFO queue and the flow queues are sorted by the
+ * departure time of their head packet. When the earliest departure time is
+ * in the future, a single event is scheduled to restart the queue disc.
+ * Flows hashed to the same queue are served in the order of arrival of
+ * their packets.
+ */
+class EdtQueueDisc : public QueueDisc
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  /**
+   * \brief EdtQueueDisc constructor
+   */
+  EdtQueueDisc ();
+
+  virtual ~EdtQueueDisc ();
+
+  // Reasons for dropping packets
+  static constexpr const char* LIMIT_EXCEEDED_DROP = "Queue disc limit exceeded";  //!< Packet dropped due to queue disc limit exceeded
+  static constexpr const char* HORIZON_DROP = "Departure time beyond horizon";     //!< Packet dropped because its departure time is too far in the future
+  static constexpr const char* UNCLASSIFIED_DROP = "Unclassified drop";            //!< No packet filter able to classify packet
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  virtual bool DoEnqueue (Ptr<QueueDiscItem> item);
+  virtual Ptr<QueueDiscItem> DoDequeue (void);
+  virtual bool CheckConfig (void);
+  virtual void InitializeParams (void);
+
+  /**
+   * \brief Get the departure time of a packet
+   * \param item the packet
+   * \param arrival the time the packet entered the queue disc
+   * \return the departure time carried by the packet, or the arrival time
+   */
+  Time GetDepartureTime (Ptr<const QueueDiscItem> item, Time arrival) const;
+
+  /// Flow queues sorted by the departure time of their head packet
+  typedef std::set<std::pair<Time, uint32_t> > Schedule;
+
+  uint32_t m_flows;                            //!< Number of flow queues
+  uint32_t m_perturbation;                     //!< Hash perturbation value
+  Time m_horizon;                              //!< Maximum delay of the departure times
+  std::map<uint32_t, uint32_t> m_flowsIndices; //!< Map with the index of the internal queue of each flow
+  Schedule m_schedule;                         //!< Non-empty flow queues, by departure time of their head packet
+  EventId m_watchdog;                          //!< Event restarting the queue disc at the earliest departure time
+};
+
+} // namespace ns3
+
+#endif /* EDT_QUEUE_DISC_H */
@@ -0,0 +1,288 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "five-tuple-classifier.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("FiveTupleClassifier");
+
+FiveTupleRule::FiveTupleRule ()
+  : m_sourceLength (0),
+    m_destinationLength (0),
+    m_protocol (0),
+    m_matchProtocol (false),
+    m_dscp (0),
+    m_matchDscp (false)
+{
+  m_sourcePorts[0] = m_destinationPorts[0] = 0;
+  m_sourcePorts[1] = m_destinationPorts[1] = 0xffff;
+}
+
+void
+FiveTupleRule::SetSource (Ipv4Address address, Ipv4Mask mask)
+{
+  NS_ABORT_MSG_IF ((~mask.Get () & (~mask.Get () + 1)) != 0, "The mask must be made of contiguous ones");
+  m_source = Ipv6Address::MakeIpv4MappedAddress (address);
+  m_sourceLength = 96 + mask.GetPrefixLength ();
+}
+
+void
+FiveTupleRule::SetSource (Ipv6Address address, Ipv6Prefix prefix)
+{
+  m_source = address;
+  m_sourceLength = prefix.GetPrefixLength ();
+}
+
+void
+FiveTupleRule::SetDestination (Ipv4Address address, Ipv4Mask mask)
+{
+  NS_ABORT_MSG_IF ((~mask.Get () & (~mask.Get () + 1)) != 0, "The mask must be made of contiguous ones");
+  m_destination = Ipv6Address::MakeIpv4MappedAddress (address);
+  m_destinationLength = 96 + mask.GetPrefixLength ();
+}
+
+void
+FiveTupleRule::SetDestination (Ipv6Address address, Ipv6Prefix prefix)
+{
+  m_destination = address;
+  m_destinationLength = prefix.GetPrefixLength ();
+}
+
+void
+FiveTupleRule::SetSourcePortRange (uint16_t min, uint16_t max)
+{
+  NS_ABORT_MSG_IF (min > max, "Invalid range of ports");
+  m_sourcePorts[0] = min;
+  m_sourcePorts[1] = max;
+}
+
+void
+FiveTupleRule::SetDestinationPortRange (uint16_t min, uint16_t max)
+{
+  NS_ABORT_MSG_IF (min > max, "Invalid range of ports");
+  m_destinationPorts[0] = min;
+  m_destinationPorts[1] = max;
+}
+
+void
+FiveTupleRule::SetProtocol (uint8_t protocol)
+{
+  m_protocol = protocol;
+  m_matchProtocol = true;
+}
+
+void
+FiveTupleRule::SetDscp (uint8_t dscp)
+{
+  NS_ABORT_MSG_IF (dscp > 0x3f, "The DSCP is a 6-bit value");
+  m_dscp = dscp;
+  m_matchDscp = true;
+}
+
+/**
+ * \brief Get the words of an IPv6 address
+ * \param address the address
+ * \param words the words to fill
+ */
+static void
+AddressToWords (Ipv6Address address, uint64_t *words)
+{
+  uint8_t buf[16];
+  address.GetBytes (buf);
+  words[0] = words[1] = 0;
+  for (uint32_t i = 0; i < 8; i++)
+    {
+      words[0] = (words[0] << 8) | buf[i];
+      words[1] = (words[1] << 8) | buf[8 + i];
+    }
+}
+
+/**
+ * \brief Get the mask of a prefix of the given length
+ * \param length the length of the prefix, in bits
+ * \param width the width of the field, in bits (up to 64)
+ * \return the mask, right aligned
+ */
+static uint64_t
+PrefixMask (uint8_t length, uint8_t width)
+{
+  if (length == 0)
+    {
+      return 0;
+    }
+  uint64_t ones = (width == 64 ? ~static_cast<uint64_t> (0) : (static_cast<uint64_t> (1) << width) - 1);
+  return (ones << (width - length)) & ones;
+}
+
+const int32_t FiveTupleClassifier::NO_MATCH;
+
+FiveTupleClassifier::FiveTupleClassifier ()
+{
+}
+
+std::size_t
+FiveTupleClassifier::KeyHash::operator() (const Key &key) const
+{
+  uint64_t h = 0;
+  for (auto w : key)
+    {
+      h ^= w + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    }
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  return static_cast<std::size_t> (h);
+}
+
+FiveTupleClassifier::Key
+FiveTupleClassifier::MakeKey (Ipv6Address source, Ipv6Address destination, uint8_t protocol,
+                              uint16_t sourcePort, uint16_t destinationPort, uint8_t dscp)
+{
+  Key key;
+  AddressToWords (source, &key[0]);
+  AddressToWords (destination, &key[2]);
+  key[4] = (static_cast<uint64_t> (sourcePort) << 48) | (static_cast<uint64_t> (destinationPort) << 32)
+           | (static_cast<uint64_t> (protocol) << 24) | (static_cast<uint64_t> (dscp & 0x3f) << 16);
+  return key;
+}
+
+FiveTupleClassifier::Key
+FiveTupleClassifier::MakeKey (Ipv4Address source, Ipv4Address destination, uint8_t protocol,
+                              uint16_t sourcePort, uint16_t destinationPort, uint8_t dscp)
+{
+  return MakeKey (Ipv6Address::MakeIpv4MappedAddress (source), Ipv6Address::MakeIpv4MappedAddress (destination),
+                  protocol, sourcePort, destinationPort, dscp);
+}
+
+void
+FiveTupleClassifier::AddRule (const FiveTupleRule &rule, int32_t value)
+{
+  NS_LOG_FUNCTION (this << value);
+  NS_ABORT_MSG_IF (value < 0, "The value of a rule must be non-negative");
+
+  uint32_t index = m_values.size ();
+  m_values.push_back (value);
+
+  // the ports are not part of the mask, as they are matched by ranges
+  Key mask;
+  mask[0] = PrefixMask (std::min<uint8_t> (rule.m_sourceLength, 64), 64);
+  mask[1] = PrefixMask (rule.m_sourceLength > 64 ? rule.m_sourceLength - 64 : 0, 64);
+  mask[2] = PrefixMask (std::min<uint8_t> (rule.m_destinationLength, 64), 64);
+  mask[3] = PrefixMask (rule.m_destinationLength > 64 ? rule.m_destinationLength - 64 : 0, 64);
+  mask[4] = (rule.m_matchProtocol ? 0xffULL << 24 : 0) | (rule.m_matchDscp ? 0x3fULL << 16 : 0);
+
+  Key key = MakeKey (rule.m_source, rule.m_destination, rule.m_protocol, 0, 0, rule.m_dscp);
+  for (uint32_t i = 0; i < key.size (); i++)
+    {
+      key[i] &= mask[i];
+    }
+
+  Entry entry;
+  entry.rule = index;
+  entry.sourcePorts[0] = rule.m_sourcePorts[0];
+  entry.sourcePorts[1] = rule.m_sourcePorts[1];
+  entry.destinationPorts[0] = rule.m_destinationPorts[0];
+  entry.destinationPorts[1] = rule.m_destinationPorts[1];
+
+  for (auto& tuple : m_tuples)
+    {
+      if (tuple.mask == mask)
+        {
+          // the rules are added in order, hence the lists stay sorted
+          tuple.entries[key].push_back (entry);
+          return;
+        }
+    }
+
+  // the new tuple (whose first rule is the last one added) keeps the tuples
+  // sorted by their first rule
+  NS_LOG_DEBUG ("New tuple for rule " << index);
+  m_tuples.push_back (Tuple ());
+  m_tuples.back ().mask = mask;
+  m_tuples.back ().firstRule = index;
+  m_tuples.back ().entries[key].push_back (entry);
+}
+
+void
+FiveTupleClassifier::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_values.clear ();
+  m_tuples.clear ();
+}
+
+uint32_t
+FiveTupleClassifier::GetNRules (void) const
+{
+  return m_values.size ();
+}
+
+uint32_t
+FiveTupleClassifier::GetNTuples (void) const
+{
+  return m_tuples.size ();
+}
+
+int32_t
+FiveTupleClassifier::Classify (const Key &key) const
+{
+  uint32_t best = m_values.size ();
+  uint16_t sourcePort = key[4] >> 48;
+  uint16_t destinationPort = (key[4] >> 32) & 0xffff;
+  Key masked;
+
+  for (auto& tuple : m_tuples)
+    {
+      if (tuple.firstRule >= best)
+        {
+          // the following tuples only hold rules added after the one matched
+          break;
+        }
+      for (uint32_t i = 0; i < masked.size (); i++)
+        {
+          masked[i] = key[i] & tuple.mask[i];
+        }
+      auto it = tuple.entries.find (masked);
+      if (it == tuple.entries.end ())
+        {
+          continue;
+        }
+      for (auto& entry : it->second)
+        {
+          if (entry.rule >= best)
+            {
+              break;
+            }
+          if (sourcePort >= entry.sourcePorts[0] && sourcePort <= entry.sourcePorts[1]
+              && destinationPort >= entry.destinationPorts[0] && destinationPort <= entry.destinationPorts[1])
+            {
+              best = entry.rule;
+              break;
+            }
+        }
+    }
+
+  if (best == m_values.size ())
+    {
+      return NO_MATCH;
+    }
+  return m_values[best];
+}
+
+} // namespace ns3
@@ -0,0 +1,228 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef FIVE_TUPLE_CLASSIFIER_H
+#define FIVE_TUPLE_CLASSIFIER_H
+
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv6-address.h"
+#include <array>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief A classification rule matching the 5-tuple and the DSCP of packets
+ *
+ * A rule matches the packets whose source and destination addresses have the
+ * given prefixes, whose source and destination ports are in the given ranges
+ * and whose protocol and DSCP have the given values. A newly created rule
+ * matches any packet. IPv4 addresses are matched as IPv4-mapped IPv6
+ * addresses, hence a rule on IPv4 addresses never matches IPv6 packets.
+ */
+class FiveTupleRule
+{
+public:
+  FiveTupleRule ();
+
+  /**
+   * \brief Match the source address with an IPv4 prefix
+   * \param address the address
+   * \param mask the mask (made of contiguous ones)
+   */
+  void SetSource (Ipv4Address address, Ipv4Mask mask);
+  /**
+   * \brief Match the source address with an IPv6 prefix
+   * \param address the address
+   * \param prefix the prefix
+   */
+  void SetSource (Ipv6Address address, Ipv6Prefix prefix);
+  /**
+   * \brief Match the destination address with an IPv4 prefix
+   * \param address the address
+   * \param mask the mask (made of contiguous ones)
+   */
+  void SetDestination (Ipv4Address address, Ipv4Mask mask);
+  /**
+   * \brief Match the destination address with an IPv6 prefix
+   * \param address the address
+   * \param prefix the prefix
+   */
+  void SetDestination (Ipv6Address address, Ipv6Prefix prefix);
+  /**
+   * \brief Match the source port with a range of ports
+   * \param min the first port of the range
+   * \param max the last port of the range
+   */
+  void SetSourcePortRange (uint16_t min, uint16_t max);
+  /**
+   * \brief Match the destination port with a range of ports
+   * \param min the first port of the range
+   * \param max the last port of the range
+   */
+  void SetDestinationPortRange (uint16_t min, uint16_t max);
+  /**
+   * \brief Match the protocol (IPv4 protocol or IPv6 next header)
+   * \param protocol the protocol number
+   */
+  void SetProtocol (uint8_t protocol);
+  /**
+   * \brief Match the DSCP
+   * \param dscp the DSCP (6 bits)
+   */
+  void SetDscp (uint8_t dscp);
+
+private:
+  friend class FiveTupleClassifier;
+
+  Ipv6Address m_source;          //!< the source address
+  uint8_t m_sourceLength;        //!< the length of the source prefix
+  Ipv6Address m_destination;     //!< the destination address
+  uint8_t m_destinationLength;   //!< the length of the destination prefix
+  uint16_t m_sourcePorts[2];     //!< the range of source ports
+  uint16_t m_destinationPorts[2];//!< the range of destination ports
+  uint8_t m_protocol;            //!< the protocol
+  bool m_matchProtocol;          //!< whether the protocol is matched
+  uint8_t m_dscp;                //!< the DSCP
+  bool m_matchDscp;              //!< whether the DSCP is matched
+};
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief Classification engine matching packets against a list of 5-tuple rules
+ *
+ * Each rule (FiveTupleRule) is associated with a value, returned when a packet
+ * matches the rule. If a packet matches multiple rules, the value of the rule
+ * added first is returned.
+ *
+ * The rules are compiled, as they are added, into a tuple space: the rules
+ * are grouped by the combination of the lengths of their address prefixes and
+ * of the fields they match exactly (protocol and DSCP), i.e., by tuple. Each
+ * tuple stores its rules in a hash table indexed by the masked header fields,
+ * and the rules sharing the same masked fields (which only differ in their
+ * port ranges) in a list sorted by the order in which they were added. Hence,
+ * a packet is classified with one hash lookup per tuple, regardless of the
+ * number of rules, and the tuples are searched in the order of their first
+ * rule, so that the search stops as soon as no remaining tuple can hold a rule
+ * added before the one matched.
+ */
+class FiveTupleClassifier
+{
+public:
+  /// Value returned when no rule matches
+  static const int32_t NO_MATCH = -1;
+
+  /**
+   * \brief The header fields of a packet, as matched by the rules
+   *
+   * The source address (words 0-1), the destination address (words 2-3) and
+   * the ports, the protocol and the DSCP (word 4).
+   */
+  typedef std::array<uint64_t, 5> Key;
+
+  FiveTupleClassifier ();
+
+  /**
+   * \brief Build the key of a packet
+   * \param source the source address
+   * \param destination the destination address
+   * \param protocol the protocol
+   * \param sourcePort the source port
+   * \param destinationPort the destination port
+   * \param dscp the DSCP (6 bits)
+   * \return the key
+   */
+  static Key MakeKey (Ipv6Address source, Ipv6Address destination, uint8_t protocol,
+                      uint16_t sourcePort, uint16_t destinationPort, uint8_t dscp);
+  /**
+   * \brief Build the key of an IPv4 packet
+   * \param source the source address
+   * \param destination the destination address
+   * \param protocol the protocol
+   * \param sourcePort the source port
+   * \param destinationPort the destination port
+   * \param dscp the DSCP (6 bits)
+   * \return the key
+   */
+  static Key MakeKey (Ipv4Address source, Ipv4Address destination, uint8_t protocol,
+                      uint16_t sourcePort, uint16_t destinationPort, uint8_t dscp);
+
+  /**
+   * \brief Add a rule, with a lower precedence than the rules already added
+   * \param rule the rule
+   * \param value the value returned for the packets matching the rule (non-negative)
+   */
+  void AddRule (const FiveTupleRule &rule, int32_t value);
+  /**
+   * \brief Remove all the rules
+   */
+  void Clear (void);
+  /**
+   * \brief Get the number of rules
+   * \return the number of rules
+   */
+  uint32_t GetNRules (void) const;
+  /**
+   * \brief Get the number of tuples, i.e., of hash lookups to classify a packet
+   * \return the number of tuples
+   */
+  uint32_t GetNTuples (void) const;
+
+  /**
+   * \brief Classify a packet
+   * \param key the key of the packet
+   * \return the value of the first rule matching the packet, or NO_MATCH
+   */
+  int32_t Classify (const Key &key) const;
+
+private:
+  /// Hash function of the keys
+  struct KeyHash
+  {
+    /**
+     * \param key the key
+     * \return the hash of the key
+     */
+    std::size_t operator() (const Key &key) const;
+  };
+
+  /// A rule, as stored in a tuple
+  struct Entry
+  {
+    uint32_t rule;                  //!< the index of the rule
+    uint16_t sourcePorts[2];        //!< the range of source ports
+    uint16_t destinationPorts[2];   //!< the range of destination ports
+  };
+
+  /// A set of rules sharing the lengths of their prefixes and the exactly matched fields
+  struct Tuple
+  {
+    Key mask;           //!< the mask of the rules
+    uint32_t firstRule; //!< the first rule of the tuple
+    std::unordered_map<Key, std::vector<Entry>, KeyHash> entries; //!< the rules of each masked key, in order
+  };
+
+  std::vector<int32_t> m_values;   //!< the value of each rule
+  std::vector<Tuple> m_tuples;     //!< the tuples, sorted by their first rule
+};
+
+} // namespace ns3
+
+#endif /* FIVE_TUPLE_CLASSIFIER_H */
@@ -0,0 +1,254 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "flow-queue-table.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("FlowQueueTable");
+
+const uint32_t FlowQueueTable::NO_FLOW;
+
+FlowQueueTable::FlowList::FlowList ()
+  : head (NO_FLOW),
+    tail (NO_FLOW)
+{
+}
+
+FlowQueueTable::FlowQueueTable ()
+  : m_freeSlot (NO_FLOW)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+FlowQueueTable::SetNFlows (uint32_t nFlows)
+{
+  NS_LOG_FUNCTION (this << nFlows);
+  Clear ();
+  Flow flow;
+  flow.head = NO_FLOW;
+  flow.tail = NO_FLOW;
+  flow.nPackets = 0;
+  flow.nBytes = 0;
+  flow.deficit = 0;
+  flow.next = NO_FLOW;
+  flow.status = INACTIVE;
+  flow.used = false;
+  m_flows.assign (nFlows, flow);
+}
+
+uint32_t
+FlowQueueTable::GetNFlows (void) const
+{
+  return m_flows.size ();
+}
+
+void
+FlowQueueTable::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_flows.clear ();
+  m_slots.clear ();
+  m_freeSlot = NO_FLOW;
+  m_used.clear ();
+}
+
+uint32_t
+FlowQueueTable::GetNUsedFlows (void) const
+{
+  return m_used.size ();
+}
+
+uint32_t
+FlowQueueTable::GetUsedFlow (uint32_t i) const
+{
+  NS_ASSERT (i < m_used.size ());
+  return m_used[i];
+}
+
+bool
+FlowQueueTable::IsUsed (uint32_t flow) const
+{
+  NS_ASSERT (flow < m_flows.size ());
+  return m_flows[flow].used;
+}
+
+void
+FlowQueueTable::Enqueue (uint32_t flow, Ptr<QueueDiscItem> item)
+{
+  NS_LOG_FUNCTION (this << flow << item);
+  NS_ASSERT (flow < m_flows.size ());
+
+  uint32_t slot = m_freeSlot;
+  if (slot == NO_FLOW)
+    {
+      slot = m_slots.size ();
+      m_slots.push_back (Slot ());
+    }
+  else
+    {
+      m_freeSlot = m_slots[slot].next;
+    }
+  m_slots[slot].item = item;
+  m_slots[slot].next = NO_FLOW;
+
+  Flow &f = m_flows[flow];
+  if (f.tail == NO_FLOW)
+    {
+      f.head = slot;
+    }
+  else
+    {
+      m_slots[f.tail].next = slot;
+    }
+  f.tail = slot;
+  f.nPackets++;
+  f.nBytes += item->GetSize ();
+
+  if (!f.used)
+    {
+      f.used = true;
+      m_used.push_back (flow);
+    }
+}
+
+Ptr<QueueDiscItem>
+FlowQueueTable::Dequeue (uint32_t flow)
+{
+  NS_LOG_FUNCTION (this << flow);
+  NS_ASSERT (flow < m_flows.size ());
+
+  Flow &f = m_flows[flow];
+  if (f.head == NO_FLOW)
+    {
+      return 0;
+    }
+
+  uint32_t slot = f.head;
+  Ptr<QueueDiscItem> item = m_slots[slot].item;
+  m_slots[slot].item = 0;
+  f.head = m_slots[slot].next;
+  if (f.head == NO_FLOW)
+    {
+      f.tail = NO_FLOW;
+    }
+  f.nPackets--;
+  f.nBytes -= item->GetSize ();
+
+  m_slots[slot].next = m_freeSlot;
+  m_freeSlot = slot;
+  return item;
+}
+
+Ptr<const QueueDiscItem>
+FlowQueueTable::Peek (uint32_t flow) const
+{
+  NS_ASSERT (flow < m_flows.size ());
+  const Flow &f = m_flows[flow];
+  if (f.head == NO_FLOW)
+    {
+      return 0;
+    }
+  return m_slots[f.head].item;
+}
+
+uint32_t
+FlowQueueTable::GetNPackets (uint32_t flow) const
+{
+  NS_ASSERT (flow < m_flows.size ());
+  return m_flows[flow].nPackets;
+}
+
+uint32_t
+FlowQueueTable::GetNBytes (uint32_t flow) const
+{
+  NS_ASSERT (flow < m_flows.size ());
+  return m_flows[flow].nBytes;
+}
+
+int32_t
+FlowQueueTable::GetDeficit (uint32_t flow) const
+{
+  NS_ASSERT (flow < m_flows.size ());
+  return m_flows[flow].deficit;
+}
+
+void
+FlowQueueTable::SetDeficit (uint32_t flow, int32_t deficit)
+{
+  NS_LOG_FUNCTION (this << flow << deficit);
+  NS_ASSERT (flow < m_flows.size ());
+  m_flows[flow].deficit = deficit;
+}
+
+void
+FlowQueueTable::IncreaseDeficit (uint32_t flow, int32_t deficit)
+{
+  NS_LOG_FUNCTION (this << flow << deficit);
+  NS_ASSERT (flow < m_flows.size ());
+  m_flows[flow].deficit += deficit;
+}
+
+FlowQueueTable::FlowStatus
+FlowQueueTable::GetStatus (uint32_t flow) const
+{
+  NS_ASSERT (flow < m_flows.size ());
+  return static_cast<FlowStatus> (m_flows[flow].status);
+}
+
+void
+FlowQueueTable::SetStatus (uint32_t flow, FlowStatus status)
+{
+  NS_LOG_FUNCTION (this << flow << status);
+  NS_ASSERT (flow < m_flows.size ());
+  m_flows[flow].status = status;
+}
+
+void
+FlowQueueTable::PushBack (FlowList &list, uint32_t flow)
+{
+  NS_LOG_FUNCTION (this << flow);
+  NS_ASSERT (flow < m_flows.size ());
+  m_flows[flow].next = NO_FLOW;
+  if (list.tail == NO_FLOW)
+    {
+      list.head = flow;
+    }
+  else
+    {
+      m_flows[list.tail].next = flow;
+    }
+  list.tail = flow;
+}
+
+uint32_t
+FlowQueueTable::PopFront (FlowList &list)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (list.head != NO_FLOW);
+  uint32_t flow = list.head;
+  list.head = m_flows[flow].next;
+  if (list.head == NO_FLOW)
+    {
+      list.tail = NO_FLOW;
+    }
+  m_flows[flow].next = NO_FLOW;
+  return flow;
+}
+
+} // namespace ns3
@@ -0,0 +1,212 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef FLOW_QUEUE_TABLE_H
+#define FLOW_QUEUE_TABLE_H
+
+#include "ns3/ptr.h"
+#include "ns3/queue-item.h"
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief Flat table of the flow queues of a flow queueing queue disc
+ *
+ * Flow queueing queue discs (e.g., FqCoDelQueueDisc) classify the packets
+ * into a large number of flow queues, only a few of which are backlogged at
+ * any time. The table keeps the state of the flow queues in a single array,
+ * indexed by the flow number, and the packets of all the flow queues in a
+ * shared pool of slots, each flow queue being a FIFO list of slots. The
+ * round-robin lists of the schedulers (e.g., the lists of new and old flows)
+ * are linked through the array as well. Hence, no object is created per flow
+ * and no memory is allocated per packet once the pool has grown to the
+ * backlog of the queue disc.
+ */
+class FlowQueueTable
+{
+public:
+  /// Status of a flow queue
+  enum FlowStatus
+    {
+      INACTIVE,   //!< the flow queue is not in any list
+      NEW_FLOW,   //!< the flow queue is in the list of new flows
+      OLD_FLOW,   //!< the flow queue is in the list of old flows
+      THROTTLED   //!< the flow queue waits for the departure time of its head packet
+    };
+
+  /// Null index, terminating the lists of flows and of packet slots
+  static const uint32_t NO_FLOW = 0xffffffff;
+
+  /**
+   * \brief A list of flow queues linked through the table
+   */
+  struct FlowList
+  {
+    FlowList ();
+    uint32_t head;  //!< the first flow of the list
+    uint32_t tail;  //!< the last flow of the list
+  };
+
+  FlowQueueTable ();
+
+  /**
+   * \brief Set the number of flow queues, discarding their content
+   * \param nFlows the number of flow queues
+   */
+  void SetNFlows (uint32_t nFlows);
+  /**
+   * \brief Get the number of flow queues
+   * \return the number of flow queues
+   */
+  uint32_t GetNFlows (void) const;
+  /**
+   * \brief Discard the flow queues and their packets
+   */
+  void Clear (void);
+
+  /**
+   * \brief Get the number of flow queues that received at least a packet
+   * \return the number of flow queues used
+   */
+  uint32_t GetNUsedFlows (void) const;
+  /**
+   * \brief Get a flow queue that received at least a packet
+   * \param i the rank of the flow queue, in the order of their first packet
+   * \return the flow number
+   */
+  uint32_t GetUsedFlow (uint32_t i) const;
+  /**
+   * \brief Check whether a flow queue received at least a packet
+   * \param flow the flow number
+   * \return true if the flow queue received at least a packet
+   */
+  bool IsUsed (uint32_t flow) const;
+
+  /**
+   * \brief Add a packet at the tail of a flow queue
+   * \param flow the flow number
+   * \param item the packet
+   */
+  void Enqueue (uint32_t flow, Ptr<QueueDiscItem> item);
+  /**
+   * \brief Remove the packet at the head of a flow queue
+   * \param flow the flow number
+   * \return the packet, or 0 if the flow queue is empty
+   */
+  Ptr<QueueDiscItem> Dequeue (uint32_t flow);
+  /**
+   * \brief Get the packet at the head of a flow queue
+   * \param flow the flow number
+   * \return the packet, or 0 if the flow queue is empty
+   */
+  Ptr<const QueueDiscItem> Peek (uint32_t flow) const;
+  /**
+   * \brief Get the number of packets in a flow queue
+   * \param flow the flow number
+   * \return the number of packets
+   */
+  uint32_t GetNPackets (uint32_t flow) const;
+  /**
+   * \brief Get the number of bytes in a flow queue
+   * \param flow the flow number
+   * \return the number of bytes
+   */
+  uint32_t GetNBytes (uint32_t flow) const;
+
+  /**
+   * \brief Get the deficit of a flow queue
+   * \param flow the flow number
+   * \return the deficit
+   */
+  int32_t GetDeficit (uint32_t flow) const;
+  /**
+   * \brief Set the deficit of a flow queue
+   * \param flow the flow number
+   * \param deficit the deficit
+   */
+  void SetDeficit (uint32_t flow, int32_t deficit);
+  /**
+   * \brief Increase the deficit of a flow queue
+   * \param flow the flow number
+   * \param deficit the amount by which the deficit is to be increased
+   */
+  void IncreaseDeficit (uint32_t flow, int32_t deficit);
+  /**
+   * \brief Get the status of a flow queue
+   * \param flow the flow number
+   * \return the status
+   */
+  FlowStatus GetStatus (uint32_t flow) const;
+  /**
+   * \brief Set the status of a flow queue
+   * \param flow the flow number
+   * \param status the status
+   */
+  void SetStatus (uint32_t flow, FlowStatus status);
+
+  /**
+   * \brief Add a flow queue at the end of a list
+   *
+   * A flow queue can be in a single list at a time.
+   *
+   * \param list the list
+   * \param flow the flow number
+   */
+  void PushBack (FlowList &list, uint32_t flow);
+  /**
+   * \brief Remove the first flow queue of a list
+   * \param list the list, which must not be empty
+   * \return the flow number of the removed flow queue
+   */
+  uint32_t PopFront (FlowList &list);
+
+private:
+  /**
+   * \brief State of a flow queue
+   */
+  struct Flow
+  {
+    uint32_t head;      //!< the slot of the first packet
+    uint32_t tail;      //!< the slot of the last packet
+    uint32_t nPackets;  //!< the number of packets
+    uint32_t nBytes;    //!< the number of bytes
+    int32_t deficit;    //!< the deficit
+    uint32_t next;      //!< the next flow in the list holding this flow
+    uint8_t status;     //!< the FlowStatus
+    bool used;          //!< whether the flow queue received a packet
+  };
+
+  /**
+   * \brief Slot of the packet pool
+   */
+  struct Slot
+  {
+    Ptr<QueueDiscItem> item;  //!< the packet
+    uint32_t next;            //!< the next slot of the flow queue or of the free list
+  };
+
+  std::vector<Flow> m_flows;     //!< The flow queues
+  std::vector<Slot> m_slots;     //!< The pool of packet slots
+  uint32_t m_freeSlot;           //!< The first slot of the free list
+  std::vector<uint32_t> m_used;  //!< The flow queues used, in the order of their first packet
+};
+
+} // namespace ns3
+
+#endif /* FLOW_QUEUE_TABLE_H */
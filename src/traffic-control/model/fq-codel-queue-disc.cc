@@ -21,7 +21,8 @@
 
 #include "ns3/log.h"
 #include "ns3/string.h"
-#include "ns3/queue.h"
+#include "ns3/uinteger.h"
+#include "ns3/simulator.h"
 #include "fq-codel-queue-disc.h"
 #include "codel-queue-disc.h"
 #include "ns3/net-device-queue-interface.h"
@@ -30,66 +31,61 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("FqCoDelQueueDisc");
 
-NS_OBJECT_ENSURE_REGISTERED (FqCoDelFlow);
-
-TypeId FqCoDelFlow::GetTypeId (void)
+/**
+ * Performs a reciprocal divide, similar to the
+ * Linux kernel reciprocal_divide function
+ * \param A numerator
+ * \param R reciprocal of the denominator B
+ * \return the value of A/B
+ */
+static inline uint32_t ReciprocalDivide (uint32_t A, uint32_t R)
 {
-  static TypeId tid = TypeId ("ns3::FqCoDelFlow")
-    .SetParent<QueueDiscClass> ()
-    .SetGroupName ("TrafficControl")
-    .AddConstructor<FqCoDelFlow> ()
-  ;
-  return tid;
+  return (uint32_t)(((uint64_t)A * R) >> 32);
 }
 
-FqCoDelFlow::FqCoDelFlow ()
-  : m_deficit (0),
-    m_status (INACTIVE)
+/**
+ * Returns the given time translated in CoDel time representation
+ * \param t the time
+ * \return the time in CoDel time units
+ */
+static inline uint32_t Time2CoDel (Time t)
 {
-  NS_LOG_FUNCTION (this);
+  return static_cast<uint32_t>(t.GetNanoSeconds () >> CODEL_SHIFT);
 }
 
-FqCoDelFlow::~FqCoDelFlow ()
+/**
+ * Check if CoDel time a is successive to b
+ * \param a left operand
+ * \param b right operand
+ * \return true if a is greater than b
+ */
+static inline bool CoDelTimeAfter (uint32_t a, uint32_t b)
 {
-  NS_LOG_FUNCTION (this);
+  return ((int)(a) - (int)(b) > 0);
 }
 
-void
-FqCoDelFlow::SetDeficit (uint32_t deficit)
+/**
+ * Check if CoDel time a is successive or equal to b
+ * \param a left operand
+ * \param b right operand
+ * \return true if a is greater than or equal to b
+ */
+static inline bool CoDelTimeAfterEq (uint32_t a, uint32_t b)
 {
-  NS_LOG_FUNCTION (this << deficit);
-  m_deficit = deficit;
+  return ((int)(a) - (int)(b) >= 0);
 }
 
-int32_t
-FqCoDelFlow::GetDeficit (void) const
+/**
+ * Check if CoDel time a is preceding b
+ * \param a left operand
+ * \param b right operand
+ * \return true if a is less than b
+ */
+static inline bool CoDelTimeBefore (uint32_t a, uint32_t b)
 {
-  NS_LOG_FUNCTION (this);
-  return m_deficit;
-}
-
-void
-FqCoDelFlow::IncreaseDeficit (int32_t deficit)
-{
-  NS_LOG_FUNCTION (this << deficit);
-  m_deficit += deficit;
+  return ((int)(a) - (int)(b) < 0);
 }
 
-void
-FqCoDelFlow::SetStatus (FlowStatus status)
-{
-  NS_LOG_FUNCTION (this);
-  m_status = status;
-}
-
-FqCoDelFlow::FlowStatus
-FqCoDelFlow::GetStatus (void) const
-{
-  NS_LOG_FUNCTION (this);
-  return m_status;
-}
-
-
 NS_OBJECT_ENSURE_REGISTERED (FqCoDelQueueDisc);
 
 TypeId FqCoDelQueueDisc::GetTypeId (void)
@@ -108,6 +104,11 @@ TypeId FqCoDelQueueDisc::GetTypeId (void)
                    StringValue ("5ms"),
                    MakeStringAccessor (&FqCoDelQueueDisc::m_target),
                    MakeStringChecker ())
+    .AddAttribute ("MinBytes",
+                   "The CoDel algorithm minbytes parameter for each FQCoDel queue",
+                   UintegerValue (1500),
+                   MakeUintegerAccessor (&FqCoDelQueueDisc::m_minBytes),
+                   MakeUintegerChecker<uint32_t> ())
     .AddAttribute ("MaxSize",
                    "The maximum number of packets accepted by this queue disc",
                    QueueSizeValue (QueueSize ("10240p")),
@@ -118,7 +119,7 @@ TypeId FqCoDelQueueDisc::GetTypeId (void)
                    "The number of queues into which the incoming packets are classified",
                    UintegerValue (1024),
                    MakeUintegerAccessor (&FqCoDelQueueDisc::m_flows),
-                   MakeUintegerChecker<uint32_t> ())
+                   MakeUintegerChecker<uint32_t> (1))
     .AddAttribute ("DropBatchSize",
                    "The maximum number of packets dropped from the fat flow",
                    UintegerValue (64),
@@ -135,7 +136,9 @@ TypeId FqCoDelQueueDisc::GetTypeId (void)
 
 FqCoDelQueueDisc::FqCoDelQueueDisc ()
   : QueueDisc (QueueDiscSizePolicy::MULTIPLE_QUEUES, QueueSizeUnit::PACKETS),
-    m_quantum (0)
+    m_quantum (0),
+    m_codelInterval (0),
+    m_codelTarget (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -145,6 +148,17 @@ FqCoDelQueueDisc::~FqCoDelQueueDisc ()
   NS_LOG_FUNCTION (this);
 }
 
+void
+FqCoDelQueueDisc::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_table.Clear ();
+  m_codel.clear ();
+  m_newFlows = FlowQueueTable::FlowList ();
+  m_oldFlows = FlowQueueTable::FlowList ();
+  QueueDisc::DoDispose ();
+}
+
 void
 FqCoDelQueueDisc::SetQuantum (uint32_t quantum)
 {
@@ -158,6 +172,18 @@ FqCoDelQueueDisc::GetQuantum (void) const
   return m_quantum;
 }
 
+const FlowQueueTable &
+FqCoDelQueueDisc::GetFlowQueueTable (void) const
+{
+  return m_table;
+}
+
+uint32_t
+FqCoDelQueueDisc::SelectFlow (uint32_t hash)
+{
+  return hash % m_flows;
+}
+
 bool
 FqCoDelQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
 {
@@ -167,7 +193,7 @@ FqCoDelQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
 
   if (GetNPacketFilters () == 0)
     {
-      h = item->Hash (m_perturbation) % m_flows;
+      h = SelectFlow (item->Hash (m_perturbation));
     }
   else
     {
@@ -175,7 +201,7 @@ FqCoDelQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
 
       if (ret != PacketFilter::PF_NO_MATCH)
         {
-          h = ret % m_flows;
+          h = SelectFlow (ret);
         }
       else
         {
@@ -185,33 +211,17 @@ FqCoDelQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
         }
     }
 
-  Ptr<FqCoDelFlow> flow;
-  if (m_flowsIndices.find (h) == m_flowsIndices.end ())
-    {
-      NS_LOG_DEBUG ("Creating a new flow queue with index " << h);
-      flow = m_flowFactory.Create<FqCoDelFlow> ();
-      Ptr<QueueDisc> qd = m_queueDiscFactory.Create<QueueDisc> ();
-      qd->Initialize ();
-      flow->SetQueueDisc (qd);
-      AddQueueDiscClass (flow);
-
-      m_flowsIndices[h] = GetNQueueDiscClasses () - 1;
-    }
-  else
-    {
-      flow = StaticCast<FqCoDelFlow> (GetQueueDiscClass (m_flowsIndices[h]));
-    }
-
-  if (flow->GetStatus () == FqCoDelFlow::INACTIVE)
+  if (m_table.GetStatus (h) == FlowQueueTable::INACTIVE)
     {
-      flow->SetStatus (FqCoDelFlow::NEW_FLOW);
-      flow->SetDeficit (m_quantum);
-      m_newFlows.push_back (flow);
+      m_table.SetStatus (h, FlowQueueTable::NEW_FLOW);
+      m_table.SetDeficit (h, m_quantum);
+      m_table.PushBack (m_newFlows, h);
     }
 
-  flow->GetQueueDisc ()->Enqueue (item);
+  m_table.Enqueue (h, item);
+  PacketEnqueued (item);
 
-  NS_LOG_DEBUG ("Packet enqueued into flow " << h << "; flow index " << m_flowsIndices[h]);
+  NS_LOG_DEBUG ("Packet enqueued into flow " << h);
 
   if (GetCurrentSize () > GetMaxSize ())
     {
@@ -226,23 +236,23 @@ FqCoDelQueueDisc::DoDequeue (void)
 {
   NS_LOG_FUNCTION (this);
 
-  Ptr<FqCoDelFlow> flow;
+  uint32_t flow;
   Ptr<QueueDiscItem> item;
 
   do
     {
       bool found = false;
 
-      while (!found && !m_newFlows.empty ())
+      while (!found && m_newFlows.head != FlowQueueTable::NO_FLOW)
         {
-          flow = m_newFlows.front ();
+          flow = m_newFlows.head;
 
-          if (flow->GetDeficit () <= 0)
+          if (m_table.GetDeficit (flow) <= 0)
             {
-              flow->IncreaseDeficit (m_quantum);
-              flow->SetStatus (FqCoDelFlow::OLD_FLOW);
-              m_oldFlows.push_back (flow);
-              m_newFlows.pop_front ();
+              m_table.IncreaseDeficit (flow, m_quantum);
+              m_table.SetStatus (flow, FlowQueueTable::OLD_FLOW);
+              m_table.PopFront (m_newFlows);
+              m_table.PushBack (m_oldFlows, flow);
             }
           else
             {
@@ -251,15 +261,15 @@ FqCoDelQueueDisc::DoDequeue (void)
             }
         }
 
-      while (!found && !m_oldFlows.empty ())
+      while (!found && m_oldFlows.head != FlowQueueTable::NO_FLOW)
         {
-          flow = m_oldFlows.front ();
+          flow = m_oldFlows.head;
 
-          if (flow->GetDeficit () <= 0)
+          if (m_table.GetDeficit (flow) <= 0)
             {
-              flow->IncreaseDeficit (m_quantum);
-              m_oldFlows.push_back (flow);
-              m_oldFlows.pop_front ();
+              m_table.IncreaseDeficit (flow, m_quantum);
+              m_table.PopFront (m_oldFlows);
+              m_table.PushBack (m_oldFlows, flow);
             }
           else
             {
@@ -274,21 +284,21 @@ FqCoDelQueueDisc::DoDequeue (void)
           return 0;
         }
 
-      item = flow->GetQueueDisc ()->Dequeue ();
+      item = CoDelDequeue (flow);
 
       if (!item)
         {
           NS_LOG_DEBUG ("Could not get a packet from the selected flow queue");
-          if (!m_newFlows.empty ())
+          if (m_newFlows.head != FlowQueueTable::NO_FLOW)
             {
-              flow->SetStatus (FqCoDelFlow::OLD_FLOW);
-              m_oldFlows.push_back (flow);
-              m_newFlows.pop_front ();
+              m_table.SetStatus (flow, FlowQueueTable::OLD_FLOW);
+              m_table.PopFront (m_newFlows);
+              m_table.PushBack (m_oldFlows, flow);
             }
           else
             {
-              flow->SetStatus (FqCoDelFlow::INACTIVE);
-              m_oldFlows.pop_front ();
+              m_table.SetStatus (flow, FlowQueueTable::INACTIVE);
+              m_table.PopFront (m_oldFlows);
             }
         }
       else
@@ -297,8 +307,149 @@ FqCoDelQueueDisc::DoDequeue (void)
         }
     } while (item == 0);
 
-  flow->IncreaseDeficit (item->GetSize () * -1);
+  m_table.IncreaseDeficit (flow, item->GetSize () * -1);
+
+  return item;
+}
+
+bool
+FqCoDelQueueDisc::OkToDrop (uint32_t flow, Ptr<QueueDiscItem> item, uint32_t now)
+{
+  NS_LOG_FUNCTION (this << flow);
+  CoDelState &state = m_codel[flow];
+
+  if (!item)
+    {
+      state.firstAboveTime = 0;
+      return false;
+    }
+
+  uint32_t sojournTime = Time2CoDel (Simulator::Now () - item->GetTimeStamp ());
+
+  if (CoDelTimeBefore (sojournTime, m_codelTarget)
+      || m_table.GetNBytes (flow) < m_minBytes)
+    {
+      // went below so we'll stay below for at least interval
+      state.firstAboveTime = 0;
+      return false;
+    }
+  bool okToDrop = false;
+  if (state.firstAboveTime == 0)
+    {
+      // just went above from below. If we stay above for at least interval
+      // we'll say it's ok to drop
+      state.firstAboveTime = now + m_codelInterval;
+    }
+  else if (CoDelTimeAfter (now, state.firstAboveTime))
+    {
+      okToDrop = true;
+    }
+  return okToDrop;
+}
+
+void
+FqCoDelQueueDisc::NewtonStep (CoDelState &state) const
+{
+  uint32_t invsqrt = ((uint32_t) state.recInvSqrt) << REC_INV_SQRT_SHIFT;
+  uint32_t invsqrt2 = ((uint64_t) invsqrt * invsqrt) >> 32;
+  uint64_t val = (3ll << 32) - ((uint64_t) state.count * invsqrt2);
+
+  val >>= 2; /* avoid overflow */
+  val = (val * invsqrt) >> (32 - 2 + 1);
+  state.recInvSqrt = static_cast<uint16_t>(val >> REC_INV_SQRT_SHIFT);
+}
+
+uint32_t
+FqCoDelQueueDisc::ControlLaw (const CoDelState &state, uint32_t t) const
+{
+  return t + ReciprocalDivide (m_codelInterval, state.recInvSqrt << REC_INV_SQRT_SHIFT);
+}
+
+Ptr<QueueDiscItem>
+FqCoDelQueueDisc::CoDelDequeue (uint32_t flow)
+{
+  NS_LOG_FUNCTION (this << flow);
+  CoDelState &state = m_codel[flow];
 
+  Ptr<QueueDiscItem> item = m_table.Dequeue (flow);
+  if (!item)
+    {
+      // Leave dropping state when queue is empty
+      state.dropping = false;
+      return 0;
+    }
+  PacketDequeued (item);
+  uint32_t now = Time2CoDel (Simulator::Now ());
+
+  bool okToDrop = OkToDrop (flow, item, now);
+
+  if (state.dropping)
+    {
+      if (!okToDrop)
+        {
+          // sojourn time fell below target - leave dropping state
+          state.dropping = false;
+        }
+      else if (CoDelTimeAfterEq (now, state.dropNext))
+        {
+          while (state.dropping && CoDelTimeAfterEq (now, state.dropNext))
+            {
+              // It's time for the next drop. Drop the current packet and
+              // dequeue the next. The dequeue might take us out of dropping
+              // state. If not, schedule the next drop.
+              NS_LOG_LOGIC ("Sojourn time is still above target and it's time for next drop; dropping " << item);
+              DropAfterDequeue (item, TARGET_EXCEEDED_DROP);
+
+              ++state.count;
+              NewtonStep (state);
+              item = m_table.Dequeue (flow);
+              if (item)
+                {
+                  PacketDequeued (item);
+                }
+
+              if (!OkToDrop (flow, item, now))
+                {
+                  state.dropping = false;
+                }
+              else
+                {
+                  state.dropNext = ControlLaw (state, state.dropNext);
+                }
+            }
+        }
+    }
+  else if (okToDrop)
+    {
+      // Drop the first packet and enter dropping state unless the queue is empty
+      NS_LOG_LOGIC ("Sojourn time goes above target, dropping the first packet " << item << " and entering the dropping state");
+      DropAfterDequeue (item, TARGET_EXCEEDED_DROP);
+
+      item = m_table.Dequeue (flow);
+      if (item)
+        {
+          PacketDequeued (item);
+        }
+
+      OkToDrop (flow, item, now);
+      state.dropping = true;
+      // if min went above target close to when we last went below it
+      // assume that the drop rate that controlled the queue on the
+      // last cycle is a good starting point to control it now.
+      int delta = state.count - state.lastCount;
+      if (delta > 1 && CoDelTimeBefore (now - state.dropNext, 16 * m_codelInterval))
+        {
+          state.count = delta;
+          NewtonStep (state);
+        }
+      else
+        {
+          state.count = 1;
+          state.recInvSqrt = ~0U >> REC_INV_SQRT_SHIFT;
+        }
+      state.lastCount = state.count;
+      state.dropNext = ControlLaw (state, now);
+    }
   return item;
 }
 
@@ -347,12 +498,18 @@ FqCoDelQueueDisc::InitializeParams (void)
 {
   NS_LOG_FUNCTION (this);
 
-  m_flowFactory.SetTypeId ("ns3::FqCoDelFlow");
-
-  m_queueDiscFactory.SetTypeId ("ns3::CoDelQueueDisc");
-  m_queueDiscFactory.Set ("MaxSize", QueueSizeValue (GetMaxSize ()));
-  m_queueDiscFactory.Set ("Interval", StringValue (m_interval));
-  m_queueDiscFactory.Set ("Target", StringValue (m_target));
+  m_codelInterval = Time2CoDel (Time (m_interval));
+  m_codelTarget = Time2CoDel (Time (m_target));
+
+  m_table.SetNFlows (m_flows);
+  CoDelState state;
+  state.count = 0;
+  state.lastCount = 0;
+  state.firstAboveTime = 0;
+  state.dropNext = 0;
+  state.recInvSqrt = ~0U >> REC_INV_SQRT_SHIFT;
+  state.dropping = false;
+  m_codel.assign (m_flows, state);
 }
 
 uint32_t
@@ -361,28 +518,27 @@ FqCoDelQueueDisc::FqCoDelDrop (void)
   NS_LOG_FUNCTION (this);
 
   uint32_t maxBacklog = 0, index = 0;
-  Ptr<QueueDisc> qd;
 
   /* Queue is full! Find the fat flow and drop packet(s) from it */
-  for (uint32_t i = 0; i < GetNQueueDiscClasses (); i++)
+  for (uint32_t i = 0; i < m_table.GetNUsedFlows (); i++)
     {
-      qd = GetQueueDiscClass (i)->GetQueueDisc ();
-      uint32_t bytes = qd->GetNBytes ();
+      uint32_t flow = m_table.GetUsedFlow (i);
+      uint32_t bytes = m_table.GetNBytes (flow);
       if (bytes > maxBacklog)
         {
           maxBacklog = bytes;
-          index = i;
+          index = flow;
         }
     }
 
   /* Our goal is to drop half of this fat flow backlog */
   uint32_t len = 0, count = 0, threshold = maxBacklog >> 1;
-  qd = GetQueueDiscClass (index)->GetQueueDisc ();
   Ptr<QueueDiscItem> item;
 
   do
     {
-      item = qd->GetInternalQueue (0)->Dequeue ();
+      item = m_table.Dequeue (index);
+      PacketDequeued (item);
       DropAfterDequeue (item, OVERLIMIT_DROP);
       len += item->GetSize ();
     } while (++count < m_dropBatchSize && len < threshold);
@@ -23,79 +23,20 @@
 #define FQ_CODEL_QUEUE_DISC
 
 #include "ns3/queue-disc.h"
-#include "ns3/object-factory.h"
-#include <list>
-#include <map>
+#include "flow-queue-table.h"
+#include <vector>
 
 namespace ns3 {
 
-/**
- * \ingroup traffic-control
- *
- * \brief A flow queue used by the FqCoDel queue disc
- */
-
-class FqCoDelFlow : public QueueDiscClass {
-public:
-  /**
-   * \brief Get the type ID.
-   * \return the object TypeId
-   */
-  static TypeId GetTypeId (void);
-  /**
-   * \brief FqCoDelFlow constructor
-   */
-  FqCoDelFlow ();
-
-  virtual ~FqCoDelFlow ();
-
-  /**
-   * \enum FlowStatus
-   * \brief Used to determine the status of this flow queue
-   */
-  enum FlowStatus
-    {
-      INACTIVE,
-      NEW_FLOW,
-      OLD_FLOW
-    };
-
-  /**
-   * \brief Set the deficit for this flow
-   * \param deficit the deficit for this flow
-   */
-  void SetDeficit (uint32_t deficit);
-  /**
-   * \brief Get the deficit for this flow
-   * \return the deficit for this flow
-   */
-  int32_t GetDeficit (void) const;
-  /**
-   * \brief Increase the deficit for this flow
-   * \param deficit the amount by which the deficit is to be increased
-   */
-  void IncreaseDeficit (int32_t deficit);
-  /**
-   * \brief Set the status for this flow
-   * \param status the status for this flow
-   */
-  void SetStatus (FlowStatus status);
-  /**
-   * \brief Get the status of this flow
-   * \return the status of this flow
-   */
-  FlowStatus GetStatus (void) const;
-
-private:
-  int32_t m_deficit;    //!< the deficit for this flow
-  FlowStatus m_status;  //!< the status of this flow
-};
-
-
 /**
  * \ingroup traffic-control
  *
  * \brief A FqCoDel packet queue disc
+ *
+ * The flow queues and their CoDel state are kept in flat arrays indexed by
+ * the flow number (see FlowQueueTable), so that the number of flow queues
+ * can be raised to tens of thousands at the cost of a few tens of bytes
+ * per flow queue.
  */
 
 class FqCoDelQueueDisc : public QueueDisc {
@@ -126,36 +67,99 @@ public:
     */
    uint32_t GetQuantum (void) const;
 
+  /**
+   * \brief Get the table of the flow queues
+   *
+   * The flow queues used so far can be enumerated, in the order of their
+   * first packet, with FlowQueueTable::GetNUsedFlows and
+   * FlowQueueTable::GetUsedFlow.
+   *
+   * \return the table of the flow queues
+   */
+  const FlowQueueTable & GetFlowQueueTable (void) const;
+
   // Reasons for dropping packets
   static constexpr const char* UNCLASSIFIED_DROP = "Unclassified drop";  //!< No packet filter able to classify packet
   static constexpr const char* OVERLIMIT_DROP = "Overlimit drop";        //!< Overlimit dropped packets
+  static constexpr const char* TARGET_EXCEEDED_DROP = "Target exceeded drop";  //!< Sojourn time above target
 
-private:
-  virtual bool DoEnqueue (Ptr<QueueDiscItem> item);
+protected:
+  virtual void DoDispose (void);
   virtual Ptr<QueueDiscItem> DoDequeue (void);
   virtual bool CheckConfig (void);
   virtual void InitializeParams (void);
 
+  /**
+   * \brief Select the flow queue of a packet
+   * \param hash the hash of the packet, or the class returned by the packet filters
+   * \return the flow number
+   */
+  virtual uint32_t SelectFlow (uint32_t hash);
+
+private:
+  /**
+   * \brief CoDel state of a flow queue
+   */
+  struct CoDelState
+  {
+    uint32_t count;           //!< Number of packets dropped since entering drop state
+    uint32_t lastCount;       //!< Last number of packets dropped since entering drop state
+    uint32_t firstAboveTime;  //!< Time to declare sojourn time above target
+    uint32_t dropNext;        //!< Time to drop next packet
+    uint16_t recInvSqrt;      //!< Reciprocal inverse square root
+    bool dropping;            //!< True if in dropping state
+  };
+
+  virtual bool DoEnqueue (Ptr<QueueDiscItem> item);
+
   /**
    * \brief Drop a packet from the head of the queue with the largest current byte count
    * \return the index of the queue with the largest current byte count
    */
   uint32_t FqCoDelDrop (void);
 
+  /**
+   * \brief Dequeue a packet from a flow queue, as the CoDel algorithm does
+   * \param flow the flow number
+   * \return the packet, or 0 if the flow queue is or becomes empty
+   */
+  Ptr<QueueDiscItem> CoDelDequeue (uint32_t flow);
+  /**
+   * \brief Determine whether a packet of a flow queue is OK to be dropped
+   * \param flow the flow number
+   * \param item the packet
+   * \param now the current time in CoDel time units
+   * \return true if the sojourn time has been above target for at least interval
+   */
+  bool OkToDrop (uint32_t flow, Ptr<QueueDiscItem> item, uint32_t now);
+  /**
+   * \brief Update the reciprocal square root of the count of a flow queue
+   * \param state the CoDel state of the flow queue
+   */
+  void NewtonStep (CoDelState &state) const;
+  /**
+   * \brief Determine the time for next drop of a flow queue
+   * \param state the CoDel state of the flow queue
+   * \param t current next drop time
+   * \return the new next drop time
+   */
+  uint32_t ControlLaw (const CoDelState &state, uint32_t t) const;
+
   std::string m_interval;    //!< CoDel interval attribute
   std::string m_target;      //!< CoDel target attribute
+  uint32_t m_minBytes;       //!< CoDel minbytes attribute
   uint32_t m_quantum;        //!< Deficit assigned to flows at each round
   uint32_t m_flows;          //!< Number of flow queues
   uint32_t m_dropBatchSize;  //!< Max number of packets dropped from the fat flow
   uint32_t m_perturbation;   //!< hash perturbation value
 
-  std::list<Ptr<FqCoDelFlow> > m_newFlows;    //!< The list of new flows
-  std::list<Ptr<FqCoDelFlow> > m_oldFlows;    //!< The list of old flows
-
-  std::map<uint32_t, uint32_t> m_flowsIndices;    //!< Map with the index of class for each flow
+  uint32_t m_codelInterval;  //!< CoDel interval in CoDel time units
+  uint32_t m_codelTarget;    //!< CoDel target in CoDel time units
 
-  ObjectFactory m_flowFactory;         //!< Factory to create a new flow
-  ObjectFactory m_queueDiscFactory;    //!< Factory to create a new queue
+  FlowQueueTable m_table;                //!< The flow queues
+  std::vector<CoDelState> m_codel;       //!< The CoDel state of each flow queue
+  FlowQueueTable::FlowList m_newFlows;   //!< The list of new flows
+  FlowQueueTable::FlowList m_oldFlows;   //!< The list of old flows
 };
 
 } // namespace ns3
@@ -0,0 +1,337 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/departure-time-tag.h"
+#include "ns3/net-device-queue-interface.h"
+#include "fq-queue-disc.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("FqQueueDisc");
+
+NS_OBJECT_ENSURE_REGISTERED (FqQueueDisc);
+
+TypeId FqQueueDisc::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::FqQueueDisc")
+    .SetParent<QueueDisc> ()
+    .SetGroupName ("TrafficControl")
+    .AddConstructor<FqQueueDisc> ()
+    .AddAttribute ("MaxSize",
+                   "The max queue size",
+                   QueueSizeValue (QueueSize ("10000p")),
+                   MakeQueueSizeAccessor (&QueueDisc::SetMaxSize,
+                                          &QueueDisc::GetMaxSize),
+                   MakeQueueSizeChecker ())
+    .AddAttribute ("Flows",
+                   "The number of queues into which the incoming packets are classified",
+                   UintegerValue (1024),
+                   MakeUintegerAccessor (&FqQueueDisc::m_flows),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("FlowLimit",
+                   "The maximum number of packets in a flow queue",
+                   UintegerValue (100),
+                   MakeUintegerAccessor (&FqQueueDisc::m_flowLimit),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("Quantum",
+                   "The deficit assigned to the flows at each round (0 for twice the MTU of the device)",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&FqQueueDisc::m_quantum),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("InitialQuantum",
+                   "The deficit assigned to the flows at their first packet (0 for ten times the MTU of the device)",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&FqQueueDisc::m_initialQuantum),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("Perturbation",
+                   "The salt used as an additional input to the hash function used to classify packets",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&FqQueueDisc::m_perturbation),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("Horizon",
+                   "The packets whose departure time is farther than this in the future are dropped",
+                   TimeValue (Seconds (10)),
+                   MakeTimeAccessor (&FqQueueDisc::m_horizon),
+                   MakeTimeChecker ())
+  ;
+  return tid;
+}
+
+FqQueueDisc::FqQueueDisc ()
+  : QueueDisc (QueueDiscSizePolicy::MULTIPLE_QUEUES, QueueSizeUnit::PACKETS)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+FqQueueDisc::~FqQueueDisc ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+FqQueueDisc::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_watchdog.Cancel ();
+  m_table.Clear ();
+  m_newFlows = FlowQueueTable::FlowList ();
+  m_oldFlows = FlowQueueTable::FlowList ();
+  m_throttled = Throttled ();
+  QueueDisc::DoDispose ();
+}
+
+const FlowQueueTable &
+FqQueueDisc::GetFlowQueueTable (void) const
+{
+  return m_table;
+}
+
+uint32_t
+FqQueueDisc::GetNThrottledFlows (void) const
+{
+  return m_throttled.size ();
+}
+
+Time
+FqQueueDisc::GetDepartureTime (Ptr<const QueueDiscItem> item) const
+{
+  DepartureTimeTag tag;
+  if (item->GetPacket ()->PeekPacketTag (tag))
+    {
+      return tag.GetDepartureTime ();
+    }
+  return Time (0);
+}
+
+bool
+FqQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
+{
+  NS_LOG_FUNCTION (this << item);
+
+  if (GetCurrentSize () + item > GetMaxSize ())
+    {
+      NS_LOG_LOGIC ("Queue full -- dropping pkt");
+      DropBeforeEnqueue (item, LIMIT_EXCEEDED_DROP);
+      return false;
+    }
+
+  Time departure = GetDepartureTime (item);
+  if (departure > Simulator::Now () + m_horizon)
+    {
+      NS_LOG_LOGIC ("Departure time " << departure << " beyond the horizon -- dropping pkt");
+      DropBeforeEnqueue (item, HORIZON_DROP);
+      return false;
+    }
+
+  uint32_t h = 0;
+  if (GetNPacketFilters () == 0)
+    {
+      h = item->Hash (m_perturbation) % m_flows;
+    }
+  else
+    {
+      int32_t ret = Classify (item);
+
+      if (ret != PacketFilter::PF_NO_MATCH)
+        {
+          h = ret % m_flows;
+        }
+      else
+        {
+          NS_LOG_ERROR ("No filter has been able to classify this packet, drop it.");
+          DropBeforeEnqueue (item, UNCLASSIFIED_DROP);
+          return false;
+        }
+    }
+
+  if (m_table.GetNPackets (h) >= m_flowLimit)
+    {
+      NS_LOG_LOGIC ("Flow queue " << h << " full -- dropping pkt");
+      DropBeforeEnqueue (item, FLOW_LIMIT_DROP);
+      return false;
+    }
+
+  if (m_table.GetStatus (h) == FlowQueueTable::INACTIVE)
+    {
+      if (!m_table.IsUsed (h))
+        {
+          m_table.SetDeficit (h, m_initialQuantum);
+        }
+      else if (m_table.GetDeficit (h) < static_cast<int32_t> (m_quantum))
+        {
+          m_table.SetDeficit (h, m_quantum);
+        }
+      m_table.SetStatus (h, FlowQueueTable::NEW_FLOW);
+      m_table.PushBack (m_newFlows, h);
+    }
+
+  m_table.Enqueue (h, item);
+  PacketEnqueued (item);
+
+  NS_LOG_LOGIC ("Packet enqueued into flow " << h << " with departure time " << departure);
+
+  return true;
+}
+
+Ptr<QueueDiscItem>
+FqQueueDisc::DoDequeue (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  Time now = Simulator::Now ();
+
+  // the throttled flows whose head packet can leave join the old flows
+  while (!m_throttled.empty () && m_throttled.top ().first <= now)
+    {
+      uint32_t flow = m_throttled.top ().second;
+      m_throttled.pop ();
+      m_table.SetStatus (flow, FlowQueueTable::OLD_FLOW);
+      m_table.PushBack (m_oldFlows, flow);
+    }
+
+  while (true)
+    {
+      FlowQueueTable::FlowList *list = &m_newFlows;
+      if (list->head == FlowQueueTable::NO_FLOW)
+        {
+          list = &m_oldFlows;
+        }
+      if (list->head == FlowQueueTable::NO_FLOW)
+        {
+          if (!m_throttled.empty ())
+            {
+              // restart the queue disc at the earliest departure time, unless
+              // this has been done already
+              Time wakeup = m_throttled.top ().first;
+              if (!m_watchdog.IsRunning () || Simulator::GetDelayLeft (m_watchdog) > wakeup - now)
+                {
+                  m_watchdog.Cancel ();
+                  m_watchdog = Simulator::Schedule (wakeup - now, &QueueDisc::Run, this);
+                  NS_LOG_LOGIC ("Waking Event Scheduled in " << wakeup - now);
+                }
+            }
+          NS_LOG_LOGIC ("No flow found to dequeue a packet");
+          return 0;
+        }
+
+      uint32_t flow = list->head;
+
+      if (m_table.GetDeficit (flow) <= 0)
+        {
+          m_table.IncreaseDeficit (flow, m_quantum);
+          m_table.PopFront (*list);
+          m_table.SetStatus (flow, FlowQueueTable::OLD_FLOW);
+          m_table.PushBack (m_oldFlows, flow);
+          continue;
+        }
+
+      Ptr<const QueueDiscItem> head = m_table.Peek (flow);
+      if (head)
+        {
+          Time departure = GetDepartureTime (head);
+          if (departure > now)
+            {
+              NS_LOG_LOGIC ("Throttling flow " << flow << " until " << departure);
+              m_table.PopFront (*list);
+              m_table.SetStatus (flow, FlowQueueTable::THROTTLED);
+              m_throttled.push (std::make_pair (departure, flow));
+              continue;
+            }
+        }
+
+      Ptr<QueueDiscItem> item = m_table.Dequeue (flow);
+
+      if (!item)
+        {
+          m_table.PopFront (*list);
+          if (list == &m_newFlows && m_oldFlows.head != FlowQueueTable::NO_FLOW)
+            {
+              m_table.SetStatus (flow, FlowQueueTable::OLD_FLOW);
+              m_table.PushBack (m_oldFlows, flow);
+            }
+          else
+            {
+              m_table.SetStatus (flow, FlowQueueTable::INACTIVE);
+            }
+          continue;
+        }
+
+      PacketDequeued (item);
+      m_table.IncreaseDeficit (flow, item->GetSize () * -1);
+      NS_LOG_LOGIC ("Dequeued packet " << item->GetPacket () << " from flow " << flow);
+      return item;
+    }
+}
+
+bool
+FqQueueDisc::CheckConfig (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (GetNQueueDiscClasses () > 0)
+    {
+      NS_LOG_ERROR ("FqQueueDisc cannot have classes");
+      return false;
+    }
+
+  if (GetNInternalQueues () > 0)
+    {
+      NS_LOG_ERROR ("FqQueueDisc cannot have internal queues");
+      return false;
+    }
+
+  // we are at initialization time. If the user has not set the quantum
+  // values, set them from the MTU of the device (if any)
+  if (!m_quantum || !m_initialQuantum)
+    {
+      Ptr<NetDeviceQueueInterface> ndqi = GetNetDeviceQueueInterface ();
+      Ptr<NetDevice> dev;
+      // if the NetDeviceQueueInterface object is aggregated to a
+      // NetDevice, get the MTU of such NetDevice
+      if (ndqi && (dev = ndqi->GetObject<NetDevice> ()))
+        {
+          if (!m_quantum)
+            {
+              m_quantum = 2 * dev->GetMtu ();
+            }
+          if (!m_initialQuantum)
+            {
+              m_initialQuantum = 10 * dev->GetMtu ();
+            }
+          NS_LOG_DEBUG ("Setting the quantum values from the MTU of the device: "
+                        << m_quantum << " " << m_initialQuantum);
+        }
+
+      if (!m_quantum || !m_initialQuantum)
+        {
+          NS_LOG_ERROR ("The quantum parameters cannot be null");
+          return false;
+        }
+    }
+
+  return true;
+}
+
+void
+FqQueueDisc::InitializeParams (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_table.SetNFlows (m_flows);
+}
+
+} // namespace ns3
@@ -0,0 +1,118 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef FQ_QUEUE_DISC_H
+#define FQ_QUEUE_DISC_H
+
+#include "ns3/queue-disc.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "flow-queue-table.h"
+#include <queue>
+#include <vector>
+#include <functional>
+
+namespace ns3 {
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief Fair Queue packet queue disc
+ *
+ * A model of the Linux fq queue disc. The packets are classified into flow
+ * queues, which are served in Deficit Round Robin (DRR) with separate lists
+ * of new and old flows, as in FqCoDelQueueDisc. In addition, the packets are
+ * released no earlier than the departure time carried by their
+ * DepartureTimeTag (Earliest Departure Time pacing, see the PacingMode
+ * attribute of TcpL4Protocol): a flow queue whose head packet cannot leave
+ * yet is throttled, i.e., removed from the round robin until the departure
+ * time of the head packet, and a single event restarts the queue disc at the
+ * earliest departure time of the throttled flow queues.
+ *
+ * The flow queues are kept in a FlowQueueTable and the throttled flow
+ * queues in a binary heap, so that no object is created per flow queue.
+ */
+class FqQueueDisc : public QueueDisc
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  /**
+   * \brief FqQueueDisc constructor
+   */
+  FqQueueDisc ();
+
+  virtual ~FqQueueDisc ();
+
+  /**
+   * \brief Get the table of the flow queues
+   * \return the table of the flow queues
+   */
+  const FlowQueueTable & GetFlowQueueTable (void) const;
+
+  /**
+   * \brief Get the number of flow queues currently throttled
+   * \return the number of throttled flow queues
+   */
+  uint32_t GetNThrottledFlows (void) const;
+
+  // Reasons for dropping packets
+  static constexpr const char* LIMIT_EXCEEDED_DROP = "Queue disc limit exceeded";  //!< Packet dropped due to queue disc limit exceeded
+  static constexpr const char* FLOW_LIMIT_DROP = "Flow limit exceeded";            //!< Packet dropped due to flow queue limit exceeded
+  static constexpr const char* HORIZON_DROP = "Departure time beyond horizon";     //!< Packet dropped because its departure time is too far in the future
+  static constexpr const char* UNCLASSIFIED_DROP = "Unclassified drop";            //!< No packet filter able to classify packet
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  virtual bool DoEnqueue (Ptr<QueueDiscItem> item);
+  virtual Ptr<QueueDiscItem> DoDequeue (void);
+  virtual bool CheckConfig (void);
+  virtual void InitializeParams (void);
+
+  /**
+   * \brief Get the departure time of a packet
+   * \param item the packet
+   * \return the departure time carried by the packet, or zero
+   */
+  Time GetDepartureTime (Ptr<const QueueDiscItem> item) const;
+
+  /// Throttled flow queues, by departure time of their head packet
+  typedef std::priority_queue<std::pair<Time, uint32_t>,
+                              std::vector<std::pair<Time, uint32_t> >,
+                              std::greater<std::pair<Time, uint32_t> > > Throttled;
+
+  uint32_t m_flows;                     //!< Number of flow queues
+  uint32_t m_flowLimit;                 //!< Maximum number of packets in a flow queue
+  uint32_t m_quantum;                   //!< Deficit assigned to flows at each round
+  uint32_t m_initialQuantum;            //!< Deficit assigned to flows at their first packet
+  uint32_t m_perturbation;              //!< Hash perturbation value
+  Time m_horizon;                       //!< Maximum delay of the departure times
+
+  FlowQueueTable m_table;               //!< The flow queues
+  FlowQueueTable::FlowList m_newFlows;  //!< The list of new flows
+  FlowQueueTable::FlowList m_oldFlows;  //!< The list of old flows
+  Throttled m_throttled;                //!< The throttled flows
+  EventId m_watchdog;                   //!< Event restarting the queue disc at the earliest departure time
+};
+
+} // namespace ns3
+
+#endif /* FQ_QUEUE_DISC_H */
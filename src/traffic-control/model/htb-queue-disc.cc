@@ -0,0 +1,814 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/pointer.h"
+#include "ns3/uinteger.h"
+#include "ns3/simulator.h"
+#include "htb-queue-disc.h"
+#include <algorithm>
+#include <map>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("HtbQueueDisc");
+
+NS_OBJECT_ENSURE_REGISTERED (HtbClass);
+
+TypeId HtbClass::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::HtbClass")
+    .SetParent<QueueDiscClass> ()
+    .SetGroupName ("TrafficControl")
+    .AddConstructor<HtbClass> ()
+    .AddAttribute ("Parent",
+                   "The parent class, from which this class borrows (null for a root class)",
+                   PointerValue (),
+                   MakePointerAccessor (&HtbClass::m_parent),
+                   MakePointerChecker<HtbClass> ())
+    .AddAttribute ("Rate",
+                   "The rate guaranteed to this class",
+                   DataRateValue (DataRate ("1Mbps")),
+                   MakeDataRateAccessor (&HtbClass::m_rate),
+                   MakeDataRateChecker ())
+    .AddAttribute ("Ceil",
+                   "The maximum rate of this class, when borrowing from its parent."
+                   " If null, it is equal to the rate",
+                   DataRateValue (DataRate ("0bps")),
+                   MakeDataRateAccessor (&HtbClass::m_ceil),
+                   MakeDataRateChecker ())
+    .AddAttribute ("Burst",
+                   "The size in bytes of the bucket of the tokens generated at the rate."
+                   " If null, it is the number of bytes sent at the rate in 1ms plus 1600",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&HtbClass::m_burst),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("Cburst",
+                   "The size in bytes of the bucket of the tokens generated at the ceil rate."
+                   " If null, it is the number of bytes sent at the ceil rate in 1ms plus 1600",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&HtbClass::m_cburst),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("Priority",
+                   "The priority of this class when borrowing (0 is the highest)",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&HtbClass::m_priority),
+                   MakeUintegerChecker<uint8_t> (0, 7))
+    .AddAttribute ("Quantum",
+                   "The number of bytes served per round when borrowing. If null,"
+                   " it is the rate in bytes per second divided by the R2q attribute"
+                   " of the queue disc",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&HtbClass::m_quantum),
+                   MakeUintegerChecker<uint32_t> ())
+  ;
+  return tid;
+}
+
+HtbClass::HtbClass ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+HtbClass::~HtbClass ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+HtbClass::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_parent = 0;
+  QueueDiscClass::DoDispose ();
+}
+
+void
+HtbClass::SetParentClass (Ptr<HtbClass> parent)
+{
+  NS_LOG_FUNCTION (this << parent);
+  m_parent = parent;
+}
+
+Ptr<HtbClass>
+HtbClass::GetParentClass (void) const
+{
+  return m_parent;
+}
+
+DataRate
+HtbClass::GetRate (void) const
+{
+  return m_rate;
+}
+
+DataRate
+HtbClass::GetCeil (void) const
+{
+  return m_ceil;
+}
+
+uint32_t
+HtbClass::GetBurst (void) const
+{
+  return m_burst;
+}
+
+uint32_t
+HtbClass::GetCburst (void) const
+{
+  return m_cburst;
+}
+
+uint8_t
+HtbClass::GetPriority (void) const
+{
+  return m_priority;
+}
+
+uint32_t
+HtbClass::GetQuantum (void) const
+{
+  return m_quantum;
+}
+
+/// The maximum time a class can be in debt or wait for, in nanoseconds (60 seconds)
+static const int64_t HTB_MAX_BUFFER = 60000000000LL;
+
+NS_OBJECT_ENSURE_REGISTERED (HtbQueueDisc);
+
+TypeId HtbQueueDisc::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::HtbQueueDisc")
+    .SetParent<QueueDisc> ()
+    .SetGroupName ("TrafficControl")
+    .AddConstructor<HtbQueueDisc> ()
+    .AddAttribute ("DefaultClass",
+                   "The index of the class of the packets not classified by the packet"
+                   " filters. If not the index of a class, such packets are dropped",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&HtbQueueDisc::m_defaultClass),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("R2q",
+                   "The ratio between the rate (in bytes per second) and the default"
+                   " quantum of the classes",
+                   UintegerValue (10),
+                   MakeUintegerAccessor (&HtbQueueDisc::m_r2q),
+                   MakeUintegerChecker<uint32_t> (1))
+  ;
+  return tid;
+}
+
+HtbQueueDisc::HtbQueueDisc ()
+  : QueueDisc (QueueDiscSizePolicy::NO_LIMITS),
+    m_now (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+HtbQueueDisc::~HtbQueueDisc ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+HtbQueueDisc::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_watchdog.Cancel ();
+  m_htbClasses.clear ();
+  m_rows.clear ();
+  m_rowMask.clear ();
+  m_calendar.clear ();
+  QueueDisc::DoDispose ();
+}
+
+HtbQueueDisc::ClassMode
+HtbQueueDisc::GetClassMode (uint32_t index) const
+{
+  NS_ASSERT_MSG (index < GetNQueueDiscClasses (), "Invalid class index " << index);
+  return m_htbClasses[index].mode;
+}
+
+int64_t
+HtbQueueDisc::BytesTime (uint32_t bytes, double nsPerByte)
+{
+  return static_cast<int64_t> (bytes * nsPerByte);
+}
+
+bool
+HtbQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
+{
+  NS_LOG_FUNCTION (this << item);
+
+  uint32_t index;
+  int32_t ret = Classify (item);
+
+  if (ret >= 0 && static_cast<uint32_t> (ret) < GetNQueueDiscClasses ())
+    {
+      index = ret;
+    }
+  else if (m_defaultClass < GetNQueueDiscClasses ())
+    {
+      NS_LOG_DEBUG ("Packet not classified, enqueued in the default class");
+      index = m_defaultClass;
+    }
+  else
+    {
+      NS_LOG_DEBUG ("Packet not classified and no default class: dropped");
+      DropBeforeEnqueue (item, UNCLASSIFIED_DROP);
+      return false;
+    }
+
+  Class &cl = m_htbClasses[index];
+  bool retval = cl.qdisc->Enqueue (item);
+
+  // If Queue::Enqueue fails, QueueDisc::Drop is called by the child queue
+  // disc because QueueDisc::AddQueueDiscClass sets the drop callback
+
+  if (retval && !cl.prioActivity)
+    {
+      Activate (index);
+    }
+
+  NS_LOG_LOGIC ("Enqueued in class " << index << ", current queue size: " << GetNPackets () << " packets");
+  return retval;
+}
+
+Ptr<QueueDiscItem>
+HtbQueueDisc::DoDequeue (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  m_now = Simulator::Now ().GetNanoSeconds ();
+  int64_t nextEvent = ProcessCalendar ();
+
+  // serve the lowest level first, i.e., the classes sending at their rate
+  // before those borrowing, and the highest priority first within a level
+  for (uint8_t level = 0; level < m_rows.size (); level++)
+    {
+      uint8_t mask = m_rowMask[level];
+      while (mask)
+        {
+          uint8_t prio = 0;
+          while (!(mask & (1 << prio)))
+            {
+              prio++;
+            }
+          mask &= ~(1 << prio);
+
+          Ptr<QueueDiscItem> item = DequeueRow (prio, level);
+          if (item)
+            {
+              return item;
+            }
+        }
+    }
+
+  // wake up when the first class of the calendar can send again
+  if (nextEvent >= 0 && GetNPackets () > 0)
+    {
+      Time delay = NanoSeconds (nextEvent - m_now);
+      if (!m_watchdog.IsRunning () || Simulator::GetDelayLeft (m_watchdog) > delay)
+        {
+          m_watchdog.Cancel ();
+          m_watchdog = Simulator::Schedule (delay, &QueueDisc::Run, this);
+          NS_LOG_LOGIC ("Waking event scheduled in " << delay);
+        }
+    }
+  return 0;
+}
+
+HtbQueueDisc::ClassMode
+HtbQueueDisc::GetMode (const Class &cl, int64_t *diff) const
+{
+  int64_t toks = cl.ctokens + *diff;
+  if (toks < 0)
+    {
+      *diff = -toks;
+      return CANT_SEND;
+    }
+  toks = cl.tokens + *diff;
+  if (toks >= 0)
+    {
+      return CAN_SEND;
+    }
+  *diff = -toks;
+  return MAY_BORROW;
+}
+
+void
+HtbQueueDisc::ChangeMode (uint32_t index, int64_t *diff)
+{
+  Class &cl = m_htbClasses[index];
+  ClassMode mode = GetMode (cl, diff);
+
+  if (mode == cl.mode)
+    {
+      return;
+    }
+
+  if (cl.prioActivity)
+    {
+      // move the class between the rows and the feeds of its ancestors
+      if (cl.mode != CANT_SEND)
+        {
+          DeactivatePrios (index);
+        }
+      cl.mode = mode;
+      if (mode != CANT_SEND)
+        {
+          ActivatePrios (index);
+        }
+    }
+  else
+    {
+      cl.mode = mode;
+    }
+}
+
+void
+HtbQueueDisc::Activate (uint32_t index)
+{
+  Class &cl = m_htbClasses[index];
+  if (!cl.prioActivity)
+    {
+      cl.prioActivity = 1 << cl.priority;
+      ActivatePrios (index);
+    }
+}
+
+void
+HtbQueueDisc::Deactivate (uint32_t index)
+{
+  DeactivatePrios (index);
+  m_htbClasses[index].prioActivity = 0;
+}
+
+void
+HtbQueueDisc::ActivatePrios (uint32_t index)
+{
+  uint32_t c = index;
+  int32_t p = m_htbClasses[c].parent;
+  uint8_t mask = m_htbClasses[c].prioActivity;
+
+  // a class that needs to borrow is added to the feeds of its parent. The
+  // parent becomes active for the priorities of such feeds that were empty,
+  // and it is in turn added to the feeds of its own parent if it needs to
+  // borrow, and so on
+  while (m_htbClasses[c].mode == MAY_BORROW && p >= 0 && mask)
+    {
+      Class &parent = m_htbClasses[p];
+      for (uint8_t prio = 0; prio < NUM_PRIOS; prio++)
+        {
+          if (!(mask & (1 << prio)))
+            {
+              continue;
+            }
+          if (!parent.feeds[prio].ids.empty ())
+            {
+              // the parent is already active for this priority
+              mask &= ~(1 << prio);
+            }
+          parent.feeds[prio].ids.insert (c);
+        }
+      parent.prioActivity |= mask;
+      c = p;
+      p = parent.parent;
+    }
+
+  // the first class that can send at its rate is added to the rows
+  Class &cl = m_htbClasses[c];
+  if (cl.mode == CAN_SEND && mask)
+    {
+      for (uint8_t prio = 0; prio < NUM_PRIOS; prio++)
+        {
+          if (mask & (1 << prio))
+            {
+              m_rows[cl.level][prio].ids.insert (c);
+              m_rowMask[cl.level] |= (1 << prio);
+            }
+        }
+    }
+}
+
+void
+HtbQueueDisc::DeactivatePrios (uint32_t index)
+{
+  uint32_t c = index;
+  int32_t p = m_htbClasses[c].parent;
+  uint8_t mask = m_htbClasses[c].prioActivity;
+
+  while (m_htbClasses[c].mode == MAY_BORROW && p >= 0 && mask)
+    {
+      Class &parent = m_htbClasses[p];
+      uint8_t m = mask;
+      mask = 0;
+      for (uint8_t prio = 0; prio < NUM_PRIOS; prio++)
+        {
+          if (!(m & (1 << prio)))
+            {
+              continue;
+            }
+          parent.feeds[prio].ids.erase (c);
+          if (parent.feeds[prio].ids.empty ())
+            {
+              // the parent is no longer active for this priority
+              mask |= (1 << prio);
+            }
+        }
+      parent.prioActivity &= ~mask;
+      c = p;
+      p = parent.parent;
+    }
+
+  Class &cl = m_htbClasses[c];
+  if (cl.mode == CAN_SEND && mask)
+    {
+      for (uint8_t prio = 0; prio < NUM_PRIOS; prio++)
+        {
+          if (mask & (1 << prio))
+            {
+              m_rows[cl.level][prio].ids.erase (c);
+              if (m_rows[cl.level][prio].ids.empty ())
+                {
+                  m_rowMask[cl.level] &= ~(1 << prio);
+                }
+            }
+        }
+    }
+}
+
+void
+HtbQueueDisc::AddToCalendar (uint32_t index, int64_t delay)
+{
+  Class &cl = m_htbClasses[index];
+  NS_ASSERT (cl.waitKey < 0);
+  cl.waitKey = m_now + std::max<int64_t> (delay, 1);
+  m_calendar.insert (std::make_pair (cl.waitKey, index));
+}
+
+void
+HtbQueueDisc::RemoveFromCalendar (uint32_t index)
+{
+  Class &cl = m_htbClasses[index];
+  if (cl.waitKey >= 0)
+    {
+      m_calendar.erase (std::make_pair (cl.waitKey, index));
+      cl.waitKey = -1;
+    }
+}
+
+int64_t
+HtbQueueDisc::ProcessCalendar (void)
+{
+  while (!m_calendar.empty ())
+    {
+      auto it = m_calendar.begin ();
+      if (it->first > m_now)
+        {
+          return it->first;
+        }
+      uint32_t index = it->second;
+      m_calendar.erase (it);
+      Class &cl = m_htbClasses[index];
+      cl.waitKey = -1;
+
+      int64_t diff = std::min (m_now - cl.checkpoint, HTB_MAX_BUFFER);
+      ChangeMode (index, &diff);
+      if (cl.mode != CAN_SEND)
+        {
+          AddToCalendar (index, diff);
+        }
+    }
+  return -1;
+}
+
+int32_t
+HtbQueueDisc::LookupLeaf (Ring *row, uint8_t prio)
+{
+  // the rings visited from the row down to the leaf
+  Ring *stack[MAX_DEPTH + 1];
+  uint8_t sp = 0;
+  stack[0] = row;
+
+  for (uint32_t i = 0; i < 65535; i++)
+    {
+      Ring *ring = stack[sp];
+      if (ring->ids.empty ())
+        {
+          NS_LOG_WARN ("Empty ring while looking up a leaf");
+          return -1;
+        }
+      auto it = ring->ids.lower_bound (ring->next);
+      if (it == ring->ids.end ())
+        {
+          // all the classes of the ring have been served: rewind it and move
+          // the ring above to its next class
+          ring->next = 0;
+          if (sp > 0)
+            {
+              sp--;
+              auto up = stack[sp]->ids.lower_bound (stack[sp]->next);
+              if (up != stack[sp]->ids.end ())
+                {
+                  stack[sp]->next = *up + 1;
+                }
+            }
+          continue;
+        }
+      Class &cl = m_htbClasses[*it];
+      if (cl.level == 0)
+        {
+          return *it;
+        }
+      stack[++sp] = &cl.feeds[prio];
+    }
+  return -1;
+}
+
+void
+HtbQueueDisc::Advance (uint32_t index, uint8_t level, uint8_t prio)
+{
+  Ring &ring = (level ? m_htbClasses[m_htbClasses[index].parent].feeds[prio] : m_rows[0][prio]);
+  ring.next = index + 1;
+}
+
+Ptr<QueueDiscItem>
+HtbQueueDisc::DequeueRow (uint8_t prio, uint8_t level)
+{
+  Ring *row = &m_rows[level][prio];
+  int32_t start = LookupLeaf (row, prio);
+  int32_t index = start;
+  Ptr<QueueDiscItem> item;
+
+  while (true)
+    {
+      if (index < 0)
+        {
+          return 0;
+        }
+      Class &cl = m_htbClasses[index];
+      if (cl.qdisc->GetNPackets () == 0)
+        {
+          // the child queue disc dropped its packets: deactivate the class
+          Deactivate (index);
+          if (!(m_rowMask[level] & (1 << prio)))
+            {
+              return 0;
+            }
+          int32_t next = LookupLeaf (row, prio);
+          if (index == start)
+            {
+              start = next;
+            }
+          index = next;
+          continue;
+        }
+      item = cl.qdisc->Dequeue ();
+      if (item)
+        {
+          break;
+        }
+      // the child queue disc is not work conserving: try the next class
+      Advance (index, level, prio);
+      index = LookupLeaf (row, prio);
+      if (index == start)
+        {
+          return 0;
+        }
+    }
+
+  Class &cl = m_htbClasses[index];
+  uint32_t bytes = item->GetSize ();
+  cl.deficit[level] -= bytes;
+  if (cl.deficit[level] < 0)
+    {
+      cl.deficit[level] += cl.quantum;
+      Advance (index, level, prio);
+    }
+  if (cl.qdisc->GetNPackets () == 0)
+    {
+      Deactivate (index);
+    }
+  Charge (index, level, bytes);
+
+  NS_LOG_LOGIC ("Dequeued from class " << index << " at level " << +level << " and priority " << +prio);
+  return item;
+}
+
+void
+HtbQueueDisc::Charge (uint32_t index, uint8_t level, uint32_t bytes)
+{
+  for (int32_t c = index; c >= 0; c = m_htbClasses[c].parent)
+    {
+      Class &cl = m_htbClasses[c];
+      int64_t diff = std::min (m_now - cl.checkpoint, HTB_MAX_BUFFER);
+
+      // the classes below the one lending the tokens only borrow
+      if (cl.level >= level)
+        {
+          int64_t toks = std::min (cl.tokens + diff, cl.buffer) - BytesTime (bytes, cl.rateNsPerByte);
+          cl.tokens = std::max (toks, 1 - HTB_MAX_BUFFER);
+        }
+      else
+        {
+          cl.tokens += diff;
+        }
+      int64_t ctoks = std::min (cl.ctokens + diff, cl.cbuffer) - BytesTime (bytes, cl.ceilNsPerByte);
+      cl.ctokens = std::max (ctoks, 1 - HTB_MAX_BUFFER);
+      cl.checkpoint = m_now;
+
+      ClassMode oldMode = cl.mode;
+      diff = 0;
+      ChangeMode (c, &diff);
+      if (oldMode != cl.mode)
+        {
+          if (oldMode != CAN_SEND)
+            {
+              RemoveFromCalendar (c);
+            }
+          if (cl.mode != CAN_SEND)
+            {
+              AddToCalendar (c, diff);
+            }
+        }
+    }
+}
+
+bool
+HtbQueueDisc::CheckConfig (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (GetNInternalQueues () > 0)
+    {
+      NS_LOG_ERROR ("HtbQueueDisc cannot have internal queues");
+      return false;
+    }
+
+  if (GetNQueueDiscClasses () == 0)
+    {
+      NS_LOG_ERROR ("HtbQueueDisc needs at least one class");
+      return false;
+    }
+
+  // the leaves are the classes of the queue disc, followed by their ancestors
+  std::map<Ptr<HtbClass>, uint32_t> indices;
+  std::vector<Ptr<HtbClass> > classes;
+  for (uint32_t i = 0; i < GetNQueueDiscClasses (); i++)
+    {
+      Ptr<HtbClass> cl = DynamicCast<HtbClass> (GetQueueDiscClass (i));
+      if (!cl)
+        {
+          NS_LOG_ERROR ("The classes of HtbQueueDisc must be HtbClass objects");
+          return false;
+        }
+      indices[cl] = i;
+      classes.push_back (cl);
+    }
+
+  m_htbClasses.clear ();
+  m_htbClasses.resize (classes.size ());
+  for (uint32_t i = 0; i < GetNQueueDiscClasses (); i++)
+    {
+      uint32_t c = i;
+      uint8_t depth = 1;
+      for (Ptr<HtbClass> p = classes[i]->GetParentClass (); p; p = p->GetParentClass ())
+        {
+          auto it = indices.find (p);
+          if (it == indices.end ())
+            {
+              it = indices.insert (std::make_pair (p, classes.size ())).first;
+              classes.push_back (p);
+              m_htbClasses.push_back (Class ());
+              m_htbClasses.back ().parent = -1;
+              m_htbClasses.back ().level = 0;
+            }
+          else if (it->second < GetNQueueDiscClasses ())
+            {
+              NS_LOG_ERROR ("A class attached to a queue disc cannot be the parent of other classes");
+              return false;
+            }
+          if (++depth > MAX_DEPTH)
+            {
+              NS_LOG_ERROR ("The tree of classes of HtbQueueDisc cannot be deeper than " << +MAX_DEPTH);
+              return false;
+            }
+          m_htbClasses[c].parent = it->second;
+          // the level of an inner class is one more than the highest level of its children
+          m_htbClasses[it->second].level = std::max<uint8_t> (m_htbClasses[it->second].level,
+                                                              m_htbClasses[c].level + 1);
+          c = it->second;
+        }
+      if (c == i)
+        {
+          m_htbClasses[c].parent = -1;
+        }
+    }
+
+  for (uint32_t i = 0; i < classes.size (); i++)
+    {
+      Class &cl = m_htbClasses[i];
+      cl.config = classes[i];
+      cl.qdisc = classes[i]->GetQueueDisc ();
+      if (i < GetNQueueDiscClasses ())
+        {
+          cl.level = 0;
+        }
+      else if (cl.qdisc)
+        {
+          NS_LOG_ERROR ("An inner class of HtbQueueDisc cannot have a queue disc");
+          return false;
+        }
+      if (classes[i]->GetRate ().GetBitRate () == 0)
+        {
+          NS_LOG_ERROR ("The rate of the classes of HtbQueueDisc cannot be null");
+          return false;
+        }
+      if (classes[i]->GetCeil ().GetBitRate () != 0 && classes[i]->GetCeil () < classes[i]->GetRate ())
+        {
+          NS_LOG_ERROR ("The ceil rate of a class of HtbQueueDisc cannot be lower than its rate");
+          return false;
+        }
+    }
+
+  return true;
+}
+
+void
+HtbQueueDisc::InitializeParams (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  m_now = Simulator::Now ().GetNanoSeconds ();
+  uint8_t maxLevel = 0;
+
+  for (auto& cl : m_htbClasses)
+    {
+      maxLevel = std::max (maxLevel, cl.level);
+    }
+
+  for (auto& cl : m_htbClasses)
+    {
+      uint64_t rate = cl.config->GetRate ().GetBitRate ();
+      uint64_t ceil = (cl.config->GetCeil ().GetBitRate () ? cl.config->GetCeil ().GetBitRate () : rate);
+      cl.rateNsPerByte = 8e9 / rate;
+      cl.ceilNsPerByte = 8e9 / ceil;
+
+      // the default bursts are those set by tc, i.e., the bytes sent in a
+      // (1ms) tick plus an MTU
+      uint32_t burst = (cl.config->GetBurst () ? cl.config->GetBurst () : rate / 8000 + 1600);
+      uint32_t cburst = (cl.config->GetCburst () ? cl.config->GetCburst () : ceil / 8000 + 1600);
+      cl.buffer = BytesTime (burst, cl.rateNsPerByte);
+      cl.cbuffer = BytesTime (cburst, cl.ceilNsPerByte);
+
+      cl.quantum = cl.config->GetQuantum ();
+      if (cl.quantum == 0)
+        {
+          cl.quantum = rate / 8 / m_r2q;
+          if (cl.quantum < 1000)
+            {
+              NS_LOG_WARN ("The quantum of a class is small, consider decreasing R2q");
+              cl.quantum = 1000;
+            }
+          else if (cl.quantum > 200000)
+            {
+              NS_LOG_WARN ("The quantum of a class is big, consider increasing R2q");
+              cl.quantum = 200000;
+            }
+        }
+
+      cl.priority = cl.config->GetPriority ();
+      cl.prioActivity = 0;
+      cl.mode = CAN_SEND;
+      cl.tokens = cl.buffer;
+      cl.ctokens = cl.cbuffer;
+      cl.checkpoint = m_now;
+      cl.waitKey = -1;
+      cl.deficit.assign (maxLevel + 1, 0);
+      cl.feeds.clear ();
+      if (cl.level > 0)
+        {
+          cl.feeds.resize (NUM_PRIOS);
+        }
+    }
+
+  m_rows.assign (maxLevel + 1, std::array<Ring, NUM_PRIOS> ());
+  m_rowMask.assign (maxLevel + 1, 0);
+  m_calendar.clear ();
+}
+
+} // namespace ns3
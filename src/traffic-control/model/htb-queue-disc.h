@@ -0,0 +1,295 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef HTB_QUEUE_DISC_H
+#define HTB_QUEUE_DISC_H
+
+#include "ns3/queue-disc.h"
+#include "ns3/data-rate.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include <array>
+#include <set>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief A class of an HTB queue disc
+ *
+ * An HTB class is guaranteed its rate and can borrow from its parent class up
+ * to its ceil rate. The classes attached to a queue disc (the leaves) are the
+ * classes of the HTB queue disc, while the parent classes (the inner classes)
+ * are only referenced by their children, through the Parent attribute.
+ */
+class HtbClass : public QueueDiscClass {
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  HtbClass ();
+  virtual ~HtbClass ();
+
+  /**
+   * \brief Set the parent class
+   * \param parent the parent class (null for a root class)
+   */
+  void SetParentClass (Ptr<HtbClass> parent);
+  /**
+   * \brief Get the parent class
+   * \return the parent class (null for a root class)
+   */
+  Ptr<HtbClass> GetParentClass (void) const;
+  /**
+   * \brief Get the guaranteed rate
+   * \return the rate
+   */
+  DataRate GetRate (void) const;
+  /**
+   * \brief Get the maximum rate, i.e., the rate if the class borrows from its parent
+   * \return the ceil rate (null if equal to the rate)
+   */
+  DataRate GetCeil (void) const;
+  /**
+   * \brief Get the size of the bucket of the tokens generated at the rate
+   * \return the burst, in bytes (null for the default)
+   */
+  uint32_t GetBurst (void) const;
+  /**
+   * \brief Get the size of the bucket of the tokens generated at the ceil rate
+   * \return the cburst, in bytes (null for the default)
+   */
+  uint32_t GetCburst (void) const;
+  /**
+   * \brief Get the priority
+   * \return the priority (0 is the highest)
+   */
+  uint8_t GetPriority (void) const;
+  /**
+   * \brief Get the quantum
+   * \return the number of bytes served per round when borrowing (null for the default)
+   */
+  uint32_t GetQuantum (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  Ptr<HtbClass> m_parent;   //!< the parent class
+  DataRate m_rate;          //!< the guaranteed rate
+  DataRate m_ceil;          //!< the ceil rate
+  uint32_t m_burst;         //!< the burst
+  uint32_t m_cburst;        //!< the ceil burst
+  uint8_t m_priority;       //!< the priority
+  uint32_t m_quantum;       //!< the quantum
+};
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief A hierarchical token bucket queue disc
+ *
+ * This class is a model of the Linux htb queue disc. The classes form a tree
+ * whose leaves have a child queue disc; each class sends at up to its rate on
+ * its own, and at up to its ceil rate by borrowing the unused tokens of its
+ * ancestors. Packets are classified by the packet filters, whose return value
+ * is the index of a leaf class, or enqueued in the default class.
+ *
+ * As in Linux, the classes able to send are kept in rows (one per level of
+ * the tree and priority), and each inner class keeps its children that need
+ * to borrow in feeds (one per priority). Rows and feeds are sorted sets, served
+ * in a deficit round robin fashion, and the classes that cannot send are kept
+ * in a calendar sorted by the time their mode changes. Hence, the cost of
+ * enqueuing and dequeuing a packet grows with the logarithm of the number of
+ * classes, and a single event wakes the queue disc when the first class of
+ * the calendar can send again.
+ */
+class HtbQueueDisc : public QueueDisc {
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  HtbQueueDisc ();
+  virtual ~HtbQueueDisc ();
+
+  /// The mode of a class
+  enum ClassMode
+  {
+    CANT_SEND,      //!< the class cannot send, not even by borrowing
+    MAY_BORROW,     //!< the class exceeded its rate and may borrow
+    CAN_SEND        //!< the class can send at its rate
+  };
+
+  /**
+   * \brief Get the mode of a class, as of the last packet dequeued
+   * \param index the index of the leaf class
+   * \return the mode of the class
+   */
+  ClassMode GetClassMode (uint32_t index) const;
+
+  // Reasons for dropping packets
+  static constexpr const char* UNCLASSIFIED_DROP = "Unclassified drop";  //!< No packet filter able to classify packet and no default class
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  static const uint8_t NUM_PRIOS = 8;       //!< Number of priorities
+  static const uint8_t MAX_DEPTH = 8;       //!< Maximum depth of the tree of classes
+
+  /// A set of classes, served in round robin
+  struct Ring
+  {
+    std::set<uint32_t> ids;   //!< the classes
+    uint32_t next = 0;        //!< the class to serve is the first not lower than this one
+  };
+
+  /// The state of a class
+  struct Class
+  {
+    int32_t parent;                 //!< the parent class (-1 for a root class)
+    uint8_t level;                  //!< the level (0 for leaves)
+    uint8_t priority;               //!< the priority
+    uint8_t prioActivity;           //!< the priorities for which the class is active
+    ClassMode mode;                 //!< the mode
+    int32_t quantum;                //!< the quantum
+    double rateNsPerByte;           //!< the time to send a byte at the rate
+    double ceilNsPerByte;           //!< the time to send a byte at the ceil rate
+    int64_t buffer;                 //!< the burst, in nanoseconds at the rate
+    int64_t cbuffer;                //!< the ceil burst, in nanoseconds at the ceil rate
+    int64_t tokens;                 //!< the tokens, in nanoseconds
+    int64_t ctokens;                //!< the ceil tokens, in nanoseconds
+    int64_t checkpoint;             //!< the time the tokens were last updated
+    int64_t waitKey;                //!< the time the class is in the calendar for (-1 if not)
+    std::vector<int32_t> deficit;   //!< the deficit of a leaf, for each level it is served at
+    std::vector<Ring> feeds;        //!< the feeds of an inner class, for each priority
+    Ptr<HtbClass> config;           //!< the configuration of the class
+    Ptr<QueueDisc> qdisc;           //!< the queue disc of a leaf
+  };
+
+  virtual bool DoEnqueue (Ptr<QueueDiscItem> item);
+  virtual Ptr<QueueDiscItem> DoDequeue (void);
+  virtual bool CheckConfig (void);
+  virtual void InitializeParams (void);
+
+  /**
+   * \brief Compute the mode of a class
+   * \param cl the class
+   * \param diff the time elapsed since the last update of the tokens; set to
+   *             the time until the mode changes, if the class cannot send
+   * \return the mode
+   */
+  ClassMode GetMode (const Class &cl, int64_t *diff) const;
+  /**
+   * \brief Update the mode of a class and, if needed, its rows and feeds
+   * \param index the class
+   * \param diff as for GetMode
+   */
+  void ChangeMode (uint32_t index, int64_t *diff);
+  /**
+   * \brief Add a leaf with packets to the rows or feeds
+   * \param index the leaf
+   */
+  void Activate (uint32_t index);
+  /**
+   * \brief Remove an empty leaf from the rows or feeds
+   * \param index the leaf
+   */
+  void Deactivate (uint32_t index);
+  /**
+   * \brief Add a class to the feeds of its ancestors that need to borrow, or to the rows
+   * \param index the class
+   */
+  void ActivatePrios (uint32_t index);
+  /**
+   * \brief Remove a class from the feeds of its ancestors, or from the rows
+   * \param index the class
+   */
+  void DeactivatePrios (uint32_t index);
+  /**
+   * \brief Put a class in the calendar
+   * \param index the class
+   * \param delay the time until the mode of the class changes
+   */
+  void AddToCalendar (uint32_t index, int64_t delay);
+  /**
+   * \brief Remove a class from the calendar
+   * \param index the class
+   */
+  void RemoveFromCalendar (uint32_t index);
+  /**
+   * \brief Update the mode of the classes whose time in the calendar has come
+   * \return the time the next class in the calendar is due, or -1 if none
+   */
+  int64_t ProcessCalendar (void);
+  /**
+   * \brief Find the leaf to serve from a row, descending through the feeds
+   * \param row the row
+   * \param prio the priority
+   * \return the leaf, or -1 if none
+   */
+  int32_t LookupLeaf (Ring *row, uint8_t prio);
+  /**
+   * \brief Dequeue a packet from the leaves served by a row
+   * \param prio the priority
+   * \param level the level
+   * \return the packet, if any
+   */
+  Ptr<QueueDiscItem> DequeueRow (uint8_t prio, uint8_t level);
+  /**
+   * \brief Charge a packet to a leaf and to its ancestors
+   * \param index the leaf
+   * \param level the level at which the leaf was served
+   * \param bytes the size of the packet
+   */
+  void Charge (uint32_t index, uint8_t level, uint32_t bytes);
+  /**
+   * \brief Move the round robin of the ring holding a leaf past the leaf
+   * \param index the leaf
+   * \param level the level at which the leaf was served
+   * \param prio the priority
+   */
+  void Advance (uint32_t index, uint8_t level, uint8_t prio);
+  /**
+   * \brief Get the number of nanoseconds to send the given number of bytes
+   * \param bytes the number of bytes
+   * \param nsPerByte the number of nanoseconds per byte
+   * \return the number of nanoseconds
+   */
+  static int64_t BytesTime (uint32_t bytes, double nsPerByte);
+
+  uint32_t m_defaultClass;    //!< Index of the class of the unclassified packets
+  uint32_t m_r2q;             //!< Ratio between the rate and the default quantum of a class
+
+  std::vector<Class> m_htbClasses;                            //!< the leaves, then the inner classes
+  std::vector<std::array<Ring, NUM_PRIOS> > m_rows;           //!< the classes able to send, per level and priority
+  std::vector<uint8_t> m_rowMask;                             //!< the non-empty rows of each level
+  std::set<std::pair<int64_t, uint32_t> > m_calendar;         //!< the classes unable to send, by time their mode changes
+  int64_t m_now;                                              //!< the time of the current operation, in nanoseconds
+  EventId m_watchdog;                                         //!< the event waking the queue disc
+};
+
+} // namespace ns3
+
+#endif /* HTB_QUEUE_DISC_H */
@@ -73,14 +73,24 @@ PfifoFastQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
       return false;
     }
 
-  uint8_t priority = 0;
-  SocketPriorityTag priorityTag;
-  if (item->GetPacket ()->PeekPacketTag (priorityTag))
+  uint32_t band;
+  int32_t ret = Classify (item);
+
+  if (ret >= 0 && ret < 3)
     {
-      priority = priorityTag.GetPriority ();
+      NS_LOG_DEBUG ("Packet filters returned " << ret);
+      band = ret;
+    }
+  else
+    {
+      uint8_t priority = 0;
+      SocketPriorityTag priorityTag;
+      if (item->GetPacket ()->PeekPacketTag (priorityTag))
+        {
+          priority = priorityTag.GetPriority ();
+        }
+      band = prio2band[priority & 0x0f];
     }
-
-  uint32_t band = prio2band[priority & 0x0f];
 
   bool retval = GetInternalQueue (band)->Enqueue (item);
 
@@ -149,12 +159,6 @@ PfifoFastQueueDisc::CheckConfig (void)
       return false;
     }
 
-  if (GetNPacketFilters () != 0)
-    {
-      NS_LOG_ERROR ("PfifoFastQueueDisc needs no packet filter");
-      return false;
-    }
-
   if (GetNInternalQueues () == 0)
     {
       // create 3 DropTail queues with GetLimit() packets each
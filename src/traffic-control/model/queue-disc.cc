@@ -323,8 +323,11 @@ QueueDisc::QueueDisc (QueueDiscSizePolicy policy)
   :  m_nPackets (0),
      m_nBytes (0),
      m_maxSize (QueueSize ("1p")),         // to avoid that setting the mode at construction time is ignored
+     m_maxBatchSize (1),
      m_running (false),
      m_peeked (false),
+     m_independentChildren (false),
+     m_txQueueIndex (-1),
      m_sizePolicy (policy),
      m_prohibitChangeMode (false)
 {
@@ -383,6 +386,7 @@ QueueDisc::DoDispose (void)
   m_classes.clear ();
   m_devQueueIface = 0;
   m_send = nullptr;
+  m_sendBatch = nullptr;
   m_requeued = 0;
   m_internalQueueDbeFunctor = nullptr;
   m_internalQueueDadFunctor = nullptr;
@@ -415,6 +419,60 @@ QueueDisc::DoInitialize (void)
 const QueueDisc::Stats&
 QueueDisc::GetStats (void)
 {
+  if (m_independentChildren)
+    {
+      // the child queue discs do not notify this queue disc, hence the
+      // statistics are the sum of the statistics of the child queue discs
+      m_stats = Stats ();
+      for (auto& cl : m_classes)
+        {
+          const Stats& st = cl->GetQueueDisc ()->GetStats ();
+          m_stats.nTotalReceivedPackets += st.nTotalReceivedPackets;
+          m_stats.nTotalReceivedBytes += st.nTotalReceivedBytes;
+          m_stats.nTotalSentPackets += st.nTotalSentPackets;
+          m_stats.nTotalSentBytes += st.nTotalSentBytes;
+          m_stats.nTotalEnqueuedPackets += st.nTotalEnqueuedPackets;
+          m_stats.nTotalEnqueuedBytes += st.nTotalEnqueuedBytes;
+          m_stats.nTotalDequeuedPackets += st.nTotalDequeuedPackets;
+          m_stats.nTotalDequeuedBytes += st.nTotalDequeuedBytes;
+          m_stats.nTotalDroppedPackets += st.nTotalDroppedPackets;
+          m_stats.nTotalDroppedPacketsBeforeEnqueue += st.nTotalDroppedPacketsBeforeEnqueue;
+          m_stats.nTotalDroppedPacketsAfterDequeue += st.nTotalDroppedPacketsAfterDequeue;
+          m_stats.nTotalDroppedBytes += st.nTotalDroppedBytes;
+          m_stats.nTotalDroppedBytesBeforeEnqueue += st.nTotalDroppedBytesBeforeEnqueue;
+          m_stats.nTotalDroppedBytesAfterDequeue += st.nTotalDroppedBytesAfterDequeue;
+          m_stats.nTotalRequeuedPackets += st.nTotalRequeuedPackets;
+          m_stats.nTotalRequeuedBytes += st.nTotalRequeuedBytes;
+          m_stats.nTotalMarkedPackets += st.nTotalMarkedPackets;
+          m_stats.nTotalMarkedBytes += st.nTotalMarkedBytes;
+          for (auto& d : st.nDroppedPacketsBeforeEnqueue)
+            {
+              m_stats.nDroppedPacketsBeforeEnqueue[CHILD_QUEUE_DISC_DROP + d.first] += d.second;
+            }
+          for (auto& d : st.nDroppedBytesBeforeEnqueue)
+            {
+              m_stats.nDroppedBytesBeforeEnqueue[CHILD_QUEUE_DISC_DROP + d.first] += d.second;
+            }
+          for (auto& d : st.nDroppedPacketsAfterDequeue)
+            {
+              m_stats.nDroppedPacketsAfterDequeue[CHILD_QUEUE_DISC_DROP + d.first] += d.second;
+            }
+          for (auto& d : st.nDroppedBytesAfterDequeue)
+            {
+              m_stats.nDroppedBytesAfterDequeue[CHILD_QUEUE_DISC_DROP + d.first] += d.second;
+            }
+          for (auto& m : st.nMarkedPackets)
+            {
+              m_stats.nMarkedPackets[m.first] += m.second;
+            }
+          for (auto& m : st.nMarkedBytes)
+            {
+              m_stats.nMarkedBytes[m.first] += m.second;
+            }
+        }
+      return m_stats;
+    }
+
   NS_ASSERT (m_stats.nTotalDroppedPackets == m_stats.nTotalDroppedPacketsBeforeEnqueue
              + m_stats.nTotalDroppedPacketsAfterDequeue);
   NS_ASSERT (m_stats.nTotalDroppedBytes == m_stats.nTotalDroppedBytesBeforeEnqueue
@@ -435,6 +493,15 @@ uint32_t
 QueueDisc::GetNPackets () const
 {
   NS_LOG_FUNCTION (this);
+  if (m_independentChildren)
+    {
+      uint32_t nPackets = 0;
+      for (auto& cl : m_classes)
+        {
+          nPackets += cl->GetQueueDisc ()->GetNPackets ();
+        }
+      return nPackets;
+    }
   return m_nPackets;
 }
 
@@ -442,6 +509,15 @@ uint32_t
 QueueDisc::GetNBytes (void) const
 {
   NS_LOG_FUNCTION (this);
+  if (m_independentChildren)
+    {
+      uint32_t nBytes = 0;
+      for (auto& cl : m_classes)
+        {
+          nBytes += cl->GetQueueDisc ()->GetNBytes ();
+        }
+      return nBytes;
+    }
   return m_nBytes;
 }
 
@@ -521,11 +597,11 @@ QueueDisc::GetCurrentSize (void)
 
   if (GetMaxSize ().GetUnit () == QueueSizeUnit::PACKETS)
     {
-      return QueueSize (QueueSizeUnit::PACKETS, m_nPackets);
+      return QueueSize (QueueSizeUnit::PACKETS, GetNPackets ());
     }
   if (GetMaxSize ().GetUnit () == QueueSizeUnit::BYTES)
     {
-      return QueueSize (QueueSizeUnit::BYTES, m_nBytes);
+      return QueueSize (QueueSizeUnit::BYTES, GetNBytes ());
     }
   NS_ABORT_MSG ("Unknown queue size unit");
 }
@@ -558,6 +634,35 @@ QueueDisc::GetSendCallback (void) const
   return m_send;
 }
 
+void
+QueueDisc::SetSendBatchCallback (SendBatchCallback func)
+{
+  NS_LOG_FUNCTION (this);
+  m_sendBatch = func;
+}
+
+QueueDisc::SendBatchCallback
+QueueDisc::GetSendBatchCallback (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_sendBatch;
+}
+
+void
+QueueDisc::SetMaxBatchSize (uint32_t maxBatchSize)
+{
+  NS_LOG_FUNCTION (this << maxBatchSize);
+  NS_ABORT_MSG_IF (maxBatchSize == 0, "The maximum batch size must be at least one");
+  m_maxBatchSize = maxBatchSize;
+}
+
+uint32_t
+QueueDisc::GetMaxBatchSize (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_maxBatchSize;
+}
+
 void
 QueueDisc::SetQuota (const uint32_t quota)
 {
@@ -635,6 +740,20 @@ QueueDisc::AddQueueDiscClass (Ptr<QueueDiscClass> qdClass)
   NS_ABORT_MSG_IF (qdClass->GetQueueDisc ()->GetWakeMode () == WAKE_CHILD,
                    "A queue disc with WAKE_CHILD as wake mode can only be a root queue disc");
 
+  // the child queue discs of a queue disc with wake mode equal to WAKE_CHILD
+  // are run independently, on distinct device transmission queues, and do not
+  // notify the parent queue disc, whose counters and statistics are computed
+  // on demand. This avoids that the packets of all the transmission queues
+  // update the same counters
+  if (GetWakeMode () == WAKE_CHILD)
+    {
+      m_independentChildren = true;
+      // the i-th child queue disc only serves the i-th transmission queue
+      qdClass->GetQueueDisc ()->m_txQueueIndex = m_classes.size ();
+      m_classes.push_back (qdClass);
+      return;
+    }
+
   // set the parent callbacks on the child queue disc, so that it can notify
   // the parent queue disc of packets enqueued, dequeued or dropped
   qdClass->GetQueueDisc ()->TraceConnectWithoutContext ("Enqueue",
@@ -951,13 +1070,27 @@ QueueDisc::Run (void)
   if (RunBegin ())
     {
       uint32_t quota = m_quota;
-      while (Restart ())
+      if (m_maxBatchSize > 1)
+        {
+          while (RestartBatch (quota))
+            {
+              if (quota <= 0)
+                {
+                  /// \todo netif_schedule (q);
+                  break;
+                }
+            }
+        }
+      else
         {
-          quota -= 1;
-          if (quota <= 0)
+          while (Restart ())
             {
-              /// \todo netif_schedule (q);
-              break;
+              quota -= 1;
+              if (quota <= 0)
+                {
+                  /// \todo netif_schedule (q);
+                  break;
+                }
             }
         }
       RunEnd ();
@@ -998,6 +1131,50 @@ QueueDisc::Restart (void)
   return Transmit (item);
 }
 
+bool
+QueueDisc::RestartBatch (uint32_t &quota)
+{
+  NS_LOG_FUNCTION (this << quota);
+  Ptr<QueueDiscItem> item = DequeuePacket();
+  if (item == 0)
+    {
+      NS_LOG_LOGIC ("No packet to send");
+      return false;
+    }
+
+  std::vector<Ptr<QueueDiscItem> > batch (1, item);
+
+  // Bulk dequeue as many packets as the device queue can accept (this is
+  // what Linux does in try_bulk_dequeue_skb). If the device queue is stopped,
+  // the bulk limit is null and the packet is requeued by TransmitBatch.
+  uint32_t budget = std::min (quota, m_maxBatchSize);
+  if (m_devQueueIface)
+    {
+      budget = std::min (budget, m_devQueueIface->GetTxQueue (item->GetTxQueueIndex ())->GetBulkLimit ());
+    }
+
+  while (batch.size () < budget)
+    {
+      Ptr<QueueDiscItem> next = DequeuePacket ();
+      if (next == 0)
+        {
+          break;
+        }
+      if (next->GetTxQueueIndex () != item->GetTxQueueIndex ())
+        {
+          // a batch only includes packets destined to the same device queue.
+          // The packet is held back for the next batch, but it is not counted
+          // as requeued because the device did not refuse it
+          m_requeued = next;
+          break;
+        }
+      batch.push_back (next);
+    }
+
+  quota -= std::min<uint32_t> (quota, batch.size ());
+  return TransmitBatch (batch);
+}
+
 Ptr<QueueDiscItem>
 QueueDisc::DequeuePacket ()
 {
@@ -1029,11 +1206,13 @@ QueueDisc::DequeuePacket ()
     {
       // If the device is multi-queue (actually, Linux checks if the queue disc has
       // multiple queues), ask the queue disc to dequeue a packet (a multi-queue aware
-      // queue disc should try not to dequeue a packet destined to a stopped queue).
+      // queue disc should try not to dequeue a packet destined to a stopped queue),
+      // unless the queue disc only serves one of the queues (child of mq).
       // Otherwise, ask the queue disc to dequeue a packet only if the (unique) queue
       // is not stopped.
-      if (!m_devQueueIface ||
-          m_devQueueIface->GetNTxQueues ()>1 || !m_devQueueIface->GetTxQueue (0)->IsStopped ())
+      if (!m_devQueueIface
+          || (m_devQueueIface->GetNTxQueues ()>1 && m_txQueueIndex < 0)
+          || !m_devQueueIface->GetTxQueue (m_txQueueIndex < 0 ? 0 : m_txQueueIndex)->IsStopped ())
         {
           item = Dequeue ();
           // If the item is not null, add the header to the packet.
@@ -1110,4 +1289,49 @@ QueueDisc::Transmit (Ptr<QueueDiscItem> item)
   return true;
 }
 
+bool
+QueueDisc::TransmitBatch (const std::vector<Ptr<QueueDiscItem> > &batch)
+{
+  NS_LOG_FUNCTION (this << batch.size ());
+  NS_ASSERT (!batch.empty ());
+
+  std::size_t txq = batch.front ()->GetTxQueueIndex ();
+
+  // if the device queue is stopped, requeue the packet and return false.
+  // A batch is never dequeued when the device queue is stopped, hence it
+  // only includes one packet in such a case
+  if (m_devQueueIface && m_devQueueIface->GetTxQueue (txq)->IsStopped ())
+    {
+      NS_ASSERT (batch.size () == 1);
+      Requeue (batch.front ());
+      return false;
+    }
+
+  // a single queue device makes no use of the priority tag
+  // a device that does not install a device queue interface likely makes no use of it as well
+  if (!m_devQueueIface || m_devQueueIface->GetNTxQueues () == 1)
+    {
+      SocketPriorityTag priorityTag;
+      for (auto& item : batch)
+        {
+          item->GetPacket ()->RemovePacketTag (priorityTag);
+        }
+    }
+  NS_ASSERT_MSG (m_sendBatch, "Send batch callback not set");
+  m_sendBatch (batch);
+
+  // as in Transmit, the packets sent to the netdevice are never requeued
+
+  // if the queue disc is empty (and does not hold back a packet destined to
+  // another device queue) or the device queue is now stopped, return false so
+  // that the Run method does not attempt to dequeue other packets and exits
+  if ((GetNPackets () == 0 && m_requeued == 0) ||
+      (m_devQueueIface && m_devQueueIface->GetTxQueue (txq)->IsStopped ()))
+    {
+      return false;
+    }
+
+  return true;
+}
+
 } // namespace ns3
@@ -149,6 +149,12 @@ enum QueueDiscSizePolicy
  * is room for another packet in its transmission queue, but the transmission queue
  * is stopped. Waking a queue disc is equivalent to make it run.
  *
+ * If the netdevice accepts batches of packets (i.e., NetDevice::GetMaxBatchSize
+ * returns a value greater than one), a queue disc run dequeues bursts of packets,
+ * as long as there is room for them in the device transmission queue, and hands
+ * each burst to the netdevice with a single call to NetDevice::SendBatch (this is
+ * similar to the bulk dequeue and xmit_more mechanisms of Linux).
+ *
  * Every queue disc collects statistics about the total number of packets/bytes
  * received from the upper layers (in case of root queue disc) or from the parent
  * queue disc (in case of child queue disc), enqueued, dequeued, requeued, dropped,
@@ -168,6 +174,16 @@ enum QueueDiscSizePolicy
  * queue disc, the reason is "(Dropped by child queue disc) " followed by the
  * reason why the child queue disc dropped the packet.
  *
+ * The child queue discs of a queue disc whose wake mode is WAKE_CHILD (such as
+ * mq) are run independently of each other, each on its own device transmission
+ * queue. In such a case, the child queue discs do not notify the root queue disc
+ * of the packets they enqueue, dequeue or drop, so that the packets of distinct
+ * transmission queues never update a shared counter. Hence, the Enqueue, Dequeue,
+ * Drop, PacketsInQueue and BytesInQueue trace sources of the root queue disc are
+ * not fired, while the number of packets/bytes in the root queue disc and its
+ * statistics are computed when requested (by GetNPackets, GetNBytes and GetStats)
+ * by summing those of the child queue discs.
+ *
  * The QueueDisc base class provides the SojournTime trace source, which provides
  * the sojourn time of every packet dequeued from a queue disc, including packets
  * that are dropped or requeued after being dequeued. The sojourn time is taken
@@ -372,6 +388,44 @@ public:
    */
   SendCallback GetSendCallback (void) const;
 
+  /// Callback invoked to send a batch of packets to the receiving object when Run is called
+  typedef std::function<void (const std::vector<Ptr<QueueDiscItem> >&)> SendBatchCallback;
+
+  /**
+   * \param func the callback to send a batch of packets to the receiving object.
+   *
+   * Set the callback used by the TransmitBatch method (called eventually by
+   * the Run method if the maximum batch size is greater than one) to send a
+   * batch of packets to the receiving object.
+   */
+  void SetSendBatchCallback (SendBatchCallback func);
+
+  /**
+   * \return the callback to send a batch of packets to the receiving object.
+   *
+   * Get the callback used by the TransmitBatch method (called eventually by
+   * the Run method if the maximum batch size is greater than one) to send a
+   * batch of packets to the receiving object.
+   */
+  SendBatchCallback GetSendBatchCallback (void) const;
+
+  /**
+   * \brief Set the maximum number of packets sent to the receiving object at once
+   * \param maxBatchSize the maximum number of packets sent to the receiving object at once.
+   *
+   * If the maximum batch size is greater than one, the Run method dequeues
+   * bursts of packets (as long as there is room for them in the device
+   * transmission queue) and sends each burst by means of the send batch
+   * callback, which must be set.
+   */
+  void SetMaxBatchSize (uint32_t maxBatchSize);
+
+  /**
+   * \brief Get the maximum number of packets sent to the receiving object at once
+   * \return the maximum number of packets sent to the receiving object at once.
+   */
+  uint32_t GetMaxBatchSize (void) const;
+
   /**
    * \brief Set the maximum number of dequeue operations following a packet enqueue
    * \param quota the maximum number of dequeue operations following a packet enqueue.
@@ -560,6 +614,26 @@ protected:
    */
   bool Mark (Ptr<QueueDiscItem> item, const char* reason);
 
+  /**
+   *  \brief Perform the actions required when the queue disc is notified of
+   *         a packet enqueue
+   *  \param item item that was enqueued
+   *  This method is called by the internal queues and the child queue discs.
+   *  Subclasses storing packets by other means must call it to record that
+   *  a packet was enqueued
+   */
+  void PacketEnqueued (Ptr<const QueueDiscItem> item);
+
+  /**
+   *  \brief Perform the actions required when the queue disc is notified of
+   *         a packet dequeue
+   *  \param item item that was dequeued
+   *  This method is called by the internal queues and the child queue discs.
+   *  Subclasses storing packets by other means must call it to record that
+   *  a packet was dequeued (or removed to be dropped)
+   */
+  void PacketDequeued (Ptr<const QueueDiscItem> item);
+
 private:
   /**
    * \brief Copy constructor
@@ -644,6 +718,17 @@ private:
    */
   bool Restart (void);
 
+  /**
+   * Modelled after the Linux function qdisc_restart (net/sched/sch_generic.c)
+   * when bulk dequeue is enabled. Dequeue a batch of packets (by calling
+   * DequeuePacket), no larger than the maximum batch size, the given quota
+   * and the room left in the device transmission queue, and send it to the
+   * device (by calling TransmitBatch).
+   * \param quota the remaining quota, decreased by the number of dequeued packets
+   * \return true if a batch of packets is successfully sent to the device.
+   */
+  bool RestartBatch (uint32_t &quota);
+
   /**
    * Modelled after the Linux function dequeue_skb (net/sched/sch_generic.c)
    * \return the requeued packet, if any, or the packet dequeued by the queue disc, otherwise.
@@ -667,18 +752,14 @@ private:
   bool Transmit (Ptr<QueueDiscItem> item);
 
   /**
-   *  \brief Perform the actions required when the queue disc is notified of
-   *         a packet enqueue
-   *  \param item item that was enqueued
-   */
-  void PacketEnqueued (Ptr<const QueueDiscItem> item);
-
-  /**
-   *  \brief Perform the actions required when the queue disc is notified of
-   *         a packet dequeue
-   *  \param item item that was dequeued
+   * Modelled after the Linux function sch_direct_xmit (net/sched/sch_generic.c)
+   * when a list of packets is passed. Sends a batch of packets to the device
+   * if the device queue is not stopped, and requeues the (single) packet
+   * otherwise.
+   * \param batch the packets to transmit
+   * \return true if the device queue is not stopped and the queue disc is not empty
    */
-  void PacketDequeued (Ptr<const QueueDiscItem> item);
+  bool TransmitBatch (const std::vector<Ptr<QueueDiscItem> > &batch);
 
   static const uint32_t DEFAULT_QUOTA = 64; //!< Default quota (as in /proc/sys/net/core/dev_weight)
 
@@ -695,9 +776,13 @@ private:
   uint32_t m_quota;                 //!< Maximum number of packets dequeued in a qdisc run
   Ptr<NetDeviceQueueInterface> m_devQueueIface;   //!< NetDevice queue interface
   SendCallback m_send;              //!< Callback used to send a packet to the receiving object
+  SendBatchCallback m_sendBatch;    //!< Callback used to send a batch of packets to the receiving object
+  uint32_t m_maxBatchSize;          //!< Maximum number of packets sent to the receiving object at once
   bool m_running;                   //!< The queue disc is performing multiple dequeue operations
   Ptr<QueueDiscItem> m_requeued;    //!< The last packet that failed to be transmitted
   bool m_peeked;                    //!< A packet was dequeued because Peek was called
+  bool m_independentChildren;       //!< The child queue discs are run independently (WAKE_CHILD)
+  int32_t m_txQueueIndex;           //!< Device transmission queue this queue disc is bound to (-1 if none)
   std::string m_childQueueDiscDropMsg;  //!< Reason why a packet was dropped by a child queue disc
   QueueDiscSizePolicy m_sizePolicy;     //!< The queue disc size policy
   bool m_prohibitChangeMode;            //!< True if changing mode is prohibited
@@ -186,6 +186,9 @@ TrafficControlLayer::ScanDevices (void)
               q->SetNetDeviceQueueInterface (ndqi);
               q->SetSendCallback ([dev] (Ptr<QueueDiscItem> item)
                                   { dev->Send (item->GetPacket (), item->GetAddress (), item->GetProtocol ()); });
+              q->SetSendBatchCallback ([dev] (const std::vector<Ptr<QueueDiscItem> >& items)
+                                       { dev->SendBatch (items); });
+              q->SetMaxBatchSize (dev->GetMaxBatchSize ());
             }
         }
     }
@@ -250,6 +253,7 @@ TrafficControlLayer::DeleteRootQueueDiscOnDevice (Ptr<NetDevice> device)
     {
       q->SetNetDeviceQueueInterface (nullptr);
       q->SetSendCallback (nullptr);
+      q->SetSendBatchCallback (nullptr);
     }
   ndi->second.m_queueDiscsToWake.clear ();
 
@@ -0,0 +1,227 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/cake-queue-disc.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Cake Queue Disc Test Item
+ */
+class CakeQueueDiscTestItem : public QueueDiscItem {
+public:
+  /**
+   * Constructor
+   *
+   * \param p the packet
+   * \param flow the flow of the packet
+   */
+  CakeQueueDiscTestItem (Ptr<Packet> p, uint32_t flow);
+  virtual ~CakeQueueDiscTestItem ();
+  virtual void AddHeader (void);
+  virtual bool Mark (void);
+  virtual uint32_t Hash (uint32_t perturbation) const;
+
+private:
+  CakeQueueDiscTestItem ();
+  /**
+   * \brief Copy constructor
+   * Disable default implementation to avoid misuse
+   */
+  CakeQueueDiscTestItem (const CakeQueueDiscTestItem &);
+  /**
+   * \brief Assignment operator
+   * \return this object
+   * Disable default implementation to avoid misuse
+   */
+  CakeQueueDiscTestItem &operator = (const CakeQueueDiscTestItem &);
+  uint32_t m_flow; //!< Flow of the packet
+};
+
+CakeQueueDiscTestItem::CakeQueueDiscTestItem (Ptr<Packet> p, uint32_t flow)
+  : QueueDiscItem (p, Address (), 0),
+    m_flow (flow)
+{
+}
+
+CakeQueueDiscTestItem::~CakeQueueDiscTestItem ()
+{
+}
+
+void
+CakeQueueDiscTestItem::AddHeader (void)
+{
+}
+
+bool
+CakeQueueDiscTestItem::Mark (void)
+{
+  return false;
+}
+
+uint32_t
+CakeQueueDiscTestItem::Hash (uint32_t perturbation) const
+{
+  return m_flow;
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Cake Queue Disc Set-Associative Hash Test Case
+ *
+ * Flows hashed to the same flow queue are stored in distinct flow queues
+ * of the same set, until the set is full.
+ */
+class CakeQueueDiscSetAssociativeTestCase : public TestCase
+{
+public:
+  CakeQueueDiscSetAssociativeTestCase ();
+  virtual void DoRun (void);
+};
+
+CakeQueueDiscSetAssociativeTestCase::CakeQueueDiscSetAssociativeTestCase ()
+  : TestCase ("Check the set-associative hash of the Cake queue disc")
+{
+}
+
+void
+CakeQueueDiscSetAssociativeTestCase::DoRun (void)
+{
+  Ptr<CakeQueueDisc> queue = CreateObjectWithAttributes<CakeQueueDisc> ("Flows", UintegerValue (16),
+                                                                        "SetWays", UintegerValue (4));
+  queue->SetQuantum (1500);
+  queue->Initialize ();
+  const FlowQueueTable &table = queue->GetFlowQueueTable ();
+
+  // five flows hashed to the flow queue 5, in the set of flow queues 4 to 7
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      queue->Enqueue (Create<CakeQueueDiscTestItem> (Create<Packet> (100), 5 + 16 * i));
+    }
+  NS_TEST_EXPECT_MSG_EQ (table.GetNUsedFlows (), 4, "The flows should use the four flow queues of the set");
+  NS_TEST_EXPECT_MSG_EQ (table.GetUsedFlow (0), 5, "The first flow should use its flow queue");
+  NS_TEST_EXPECT_MSG_EQ (table.GetUsedFlow (1), 6, "The second flow should use the next flow queue");
+  NS_TEST_EXPECT_MSG_EQ (table.GetUsedFlow (2), 7, "The third flow should use the next flow queue");
+  NS_TEST_EXPECT_MSG_EQ (table.GetUsedFlow (3), 4, "The fourth flow should use the first flow queue of the set");
+  NS_TEST_EXPECT_MSG_EQ (table.GetNPackets (5), 2, "The fifth flow should share the flow queue of the first flow");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNCollisions (), 1, "There should be a single collision");
+
+  // the second flow finds its flow queue again
+  queue->Enqueue (Create<CakeQueueDiscTestItem> (Create<Packet> (100), 21));
+  NS_TEST_EXPECT_MSG_EQ (table.GetNPackets (6), 2, "The second flow should find its flow queue");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNCollisions (), 1, "There should be a single collision");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Cake Queue Disc Shaper Test Case
+ *
+ * A backlogged flow is released at the rate of the shaper. As the packets
+ * wait in the queue disc for longer than the CoDel target, CoDel drops some
+ * of them.
+ */
+class CakeQueueDiscShaperTestCase : public TestCase
+{
+public:
+  CakeQueueDiscShaperTestCase ();
+  virtual void DoRun (void);
+private:
+  /**
+   * Record a packet sent by the queue disc
+   * \param item the packet
+   */
+  void Send (Ptr<QueueDiscItem> item);
+
+  std::vector<Time> m_sent; //!< Send time of the sent packets
+};
+
+CakeQueueDiscShaperTestCase::CakeQueueDiscShaperTestCase ()
+  : TestCase ("Check the shaper and the CoDel drops of the Cake queue disc")
+{
+}
+
+void
+CakeQueueDiscShaperTestCase::Send (Ptr<QueueDiscItem> item)
+{
+  m_sent.push_back (Simulator::Now ());
+}
+
+void
+CakeQueueDiscShaperTestCase::DoRun (void)
+{
+  // 1000 bytes packets are sent every 8 ms
+  Ptr<CakeQueueDisc> queue = CreateObjectWithAttributes<CakeQueueDisc> ("Bandwidth", StringValue ("1Mbps"));
+  queue->SetQuantum (1500);
+  queue->SetSendCallback (MakeCallback (&CakeQueueDiscShaperTestCase::Send, this));
+  queue->Initialize ();
+
+  uint32_t nPackets = 100;
+  for (uint32_t i = 0; i < nPackets; i++)
+    {
+      queue->Enqueue (Create<CakeQueueDiscTestItem> (Create<Packet> (1000), 1));
+    }
+  Simulator::ScheduleNow (&QueueDisc::Run, queue);
+  Simulator::Run ();
+
+  uint32_t dropped = queue->GetStats ().GetNDroppedPackets (FqCoDelQueueDisc::TARGET_EXCEEDED_DROP);
+  NS_TEST_EXPECT_MSG_GT (dropped, 0, "CoDel should drop packets");
+  NS_TEST_EXPECT_MSG_EQ (m_sent.size () + dropped, nPackets, "The packets should be sent or dropped");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), 0, "The queue disc should be empty");
+  // until CoDel drops a packet (after the sojourn time has been above target
+  // for an interval), the packets are sent at the rate of the shaper
+  for (uint32_t i = 0; i < 13; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_sent[i], MilliSeconds (8 * i), "Packet sent at the wrong time");
+    }
+  for (uint32_t i = 1; i < m_sent.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_sent[i] - m_sent[i - 1], MilliSeconds (8), "Packets sent faster than the shaper");
+    }
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Cake Queue Disc Test Suite
+ */
+static class CakeQueueDiscTestSuite : public TestSuite
+{
+public:
+  CakeQueueDiscTestSuite ()
+    : TestSuite ("cake-queue-disc", UNIT)
+  {
+    AddTestCase (new CakeQueueDiscSetAssociativeTestCase (), TestCase::QUICK);
+    AddTestCase (new CakeQueueDiscShaperTestCase (), TestCase::QUICK);
+  }
+} g_cakeQueueDiscTestSuite; ///< the test suite
@@ -0,0 +1,198 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/edt-queue-disc.h"
+#include "ns3/departure-time-tag.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Edt Queue Disc Test Item
+ */
+class EdtQueueDiscTestItem : public QueueDiscItem {
+public:
+  /**
+   * Constructor
+   *
+   * \param p the packet
+   * \param flow the flow of the packet
+   */
+  EdtQueueDiscTestItem (Ptr<Packet> p, uint32_t flow);
+  virtual ~EdtQueueDiscTestItem ();
+  virtual void AddHeader (void);
+  virtual bool Mark (void);
+  virtual uint32_t Hash (uint32_t perturbation) const;
+
+private:
+  EdtQueueDiscTestItem ();
+  /**
+   * \brief Copy constructor
+   * Disable default implementation to avoid misuse
+   */
+  EdtQueueDiscTestItem (const EdtQueueDiscTestItem &);
+  /**
+   * \brief Assignment operator
+   * \return this object
+   * Disable default implementation to avoid misuse
+   */
+  EdtQueueDiscTestItem &operator = (const EdtQueueDiscTestItem &);
+  uint32_t m_flow; //!< Flow of the packet
+};
+
+EdtQueueDiscTestItem::EdtQueueDiscTestItem (Ptr<Packet> p, uint32_t flow)
+  : QueueDiscItem (p, Address (), 0),
+    m_flow (flow)
+{
+}
+
+EdtQueueDiscTestItem::~EdtQueueDiscTestItem ()
+{
+}
+
+void
+EdtQueueDiscTestItem::AddHeader (void)
+{
+}
+
+bool
+EdtQueueDiscTestItem::Mark (void)
+{
+  return false;
+}
+
+uint32_t
+EdtQueueDiscTestItem::Hash (uint32_t perturbation) const
+{
+  return m_flow;
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Edt Queue Disc Test Case
+ *
+ * Packets of two flows, whose departure times interleave, and an untagged
+ * packet are enqueued at the same time. The packets must be sent at their
+ * departure times, in the order of their departure times. Packets beyond
+ * the horizon or the queue disc limit are dropped.
+ */
+class EdtQueueDiscTestCase : public TestCase
+{
+public:
+  EdtQueueDiscTestCase ();
+  virtual void DoRun (void);
+private:
+  /**
+   * Enqueue a packet
+   * \param queue the queue disc
+   * \param flow the flow of the packet
+   * \param size the size of the packet
+   * \param departure the departure time of the packet, if positive
+   * \return true if the packet has been enqueued
+   */
+  bool Enqueue (Ptr<EdtQueueDisc> queue, uint32_t flow, uint32_t size, Time departure);
+  /**
+   * Record a packet sent by the queue disc
+   * \param item the packet
+   */
+  void Send (Ptr<QueueDiscItem> item);
+
+  std::vector<std::pair<Time, uint32_t> > m_sent; //!< Send time and size of the sent packets
+};
+
+EdtQueueDiscTestCase::EdtQueueDiscTestCase ()
+  : TestCase ("Sanity check on the EDT queue disc implementation")
+{
+}
+
+bool
+EdtQueueDiscTestCase::Enqueue (Ptr<EdtQueueDisc> queue, uint32_t flow, uint32_t size, Time departure)
+{
+  Ptr<Packet> p = Create<Packet> (size);
+  if (departure.IsStrictlyPositive ())
+    {
+      p->AddPacketTag (DepartureTimeTag (departure));
+    }
+  return queue->Enqueue (Create<EdtQueueDiscTestItem> (p, flow));
+}
+
+void
+EdtQueueDiscTestCase::Send (Ptr<QueueDiscItem> item)
+{
+  m_sent.push_back (std::make_pair (Simulator::Now (), item->GetSize ()));
+}
+
+void
+EdtQueueDiscTestCase::DoRun (void)
+{
+  Ptr<EdtQueueDisc> queue = CreateObjectWithAttributes<EdtQueueDisc> ("MaxSize", StringValue ("6p"),
+                                                                      "Horizon", StringValue ("1s"));
+  queue->SetSendCallback (MakeCallback (&EdtQueueDiscTestCase::Send, this));
+  queue->Initialize ();
+
+  // the packet size identifies the packet
+  NS_TEST_EXPECT_MSG_EQ (Enqueue (queue, 1, 103, MilliSeconds (3)), true, "The packet should be enqueued");
+  NS_TEST_EXPECT_MSG_EQ (Enqueue (queue, 1, 105, MilliSeconds (5)), true, "The packet should be enqueued");
+  NS_TEST_EXPECT_MSG_EQ (Enqueue (queue, 2, 101, MilliSeconds (1)), true, "The packet should be enqueued");
+  NS_TEST_EXPECT_MSG_EQ (Enqueue (queue, 2, 104, MilliSeconds (4)), true, "The packet should be enqueued");
+  NS_TEST_EXPECT_MSG_EQ (Enqueue (queue, 3, 100, Seconds (0)), true, "The untagged packet should be enqueued");
+  NS_TEST_EXPECT_MSG_EQ (Enqueue (queue, 3, 200, Seconds (2)), false, "The packet beyond the horizon should be dropped");
+  NS_TEST_EXPECT_MSG_EQ (Enqueue (queue, 3, 102, MilliSeconds (2)), true, "The packet should be enqueued");
+  NS_TEST_EXPECT_MSG_EQ (Enqueue (queue, 3, 300, MilliSeconds (2)), false, "The packet beyond the limit should be dropped");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), 6, "There should be 6 packets in the queue disc");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetStats ().GetNDroppedPackets (EdtQueueDisc::HORIZON_DROP), 1,
+                         "One packet should be dropped because of the horizon");
+
+  // flow 3 is served in FIFO order: its second packet can not leave before
+  // the first one, which leaves at once
+  Simulator::ScheduleNow (&QueueDisc::Run, queue);
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_sent.size (), 6, "All the packets should have been sent");
+  for (uint32_t i = 0; i < m_sent.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_sent[i].second, 100 + i, "Packet sent out of order");
+      NS_TEST_EXPECT_MSG_EQ (m_sent[i].first, MilliSeconds (i), "Packet sent at the wrong time");
+    }
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), 0, "The queue disc should be empty");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Edt Queue Disc Test Suite
+ */
+static class EdtQueueDiscTestSuite : public TestSuite
+{
+public:
+  EdtQueueDiscTestSuite ()
+    : TestSuite ("edt-queue-disc", UNIT)
+  {
+    AddTestCase (new EdtQueueDiscTestCase (), TestCase::QUICK);
+  }
+} g_edtQueueDiscTestSuite; ///< the test suite
@@ -0,0 +1,218 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/five-tuple-classifier.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/simulator.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Five Tuple Classifier Rules Test Case
+ *
+ * Check the matching of prefixes, port ranges, protocol and DSCP, and that the
+ * rule added first wins.
+ */
+class FiveTupleClassifierRulesTestCase : public TestCase
+{
+public:
+  FiveTupleClassifierRulesTestCase ();
+  virtual void DoRun (void);
+};
+
+FiveTupleClassifierRulesTestCase::FiveTupleClassifierRulesTestCase ()
+  : TestCase ("Check the rules of the five tuple classifier")
+{
+}
+
+void
+FiveTupleClassifierRulesTestCase::DoRun (void)
+{
+  FiveTupleClassifier classifier;
+  Ipv4Address a ("10.1.1.1");
+  Ipv4Address b ("10.2.1.1");
+
+  NS_TEST_EXPECT_MSG_EQ (classifier.Classify (FiveTupleClassifier::MakeKey (a, b, 17, 1000, 2000, 0)),
+                         FiveTupleClassifier::NO_MATCH, "No rule should match");
+
+  // rule 0: UDP packets to 10.2.0.0/16, destination ports 1000-2999
+  FiveTupleRule rule0;
+  rule0.SetDestination (Ipv4Address ("10.2.0.0"), Ipv4Mask ("255.255.0.0"));
+  rule0.SetProtocol (17);
+  rule0.SetDestinationPortRange (1000, 2999);
+  classifier.AddRule (rule0, 3);
+
+  // rule 1: packets from 10.1.1.0/24 with DSCP 46 (EF)
+  FiveTupleRule rule1;
+  rule1.SetSource (Ipv4Address ("10.1.1.0"), Ipv4Mask ("255.255.255.0"));
+  rule1.SetDscp (46);
+  classifier.AddRule (rule1, 5);
+
+  // rule 2: any IPv6 packet from 2001:db8::/32
+  FiveTupleRule rule2;
+  rule2.SetSource (Ipv6Address ("2001:db8::"), Ipv6Prefix (32));
+  classifier.AddRule (rule2, 7);
+
+  // rule 3: any packet
+  classifier.AddRule (FiveTupleRule (), 9);
+
+  NS_TEST_EXPECT_MSG_EQ (classifier.GetNRules (), 4, "Unexpected number of rules");
+
+  NS_TEST_EXPECT_MSG_EQ (classifier.Classify (FiveTupleClassifier::MakeKey (a, b, 17, 5, 1000, 46)), 3,
+                         "Rule 0 should win over rule 1");
+  NS_TEST_EXPECT_MSG_EQ (classifier.Classify (FiveTupleClassifier::MakeKey (a, b, 17, 5, 2999, 0)), 3,
+                         "The last port of the range should match");
+  NS_TEST_EXPECT_MSG_EQ (classifier.Classify (FiveTupleClassifier::MakeKey (a, b, 17, 5, 3000, 46)), 5,
+                         "A port out of the range should not match");
+  NS_TEST_EXPECT_MSG_EQ (classifier.Classify (FiveTupleClassifier::MakeKey (a, b, 6, 5, 1000, 46)), 5,
+                         "Another protocol should not match");
+  NS_TEST_EXPECT_MSG_EQ (classifier.Classify (FiveTupleClassifier::MakeKey (a, Ipv4Address ("10.3.1.1"), 17, 5, 1000, 0)), 9,
+                         "Another destination prefix should not match");
+  NS_TEST_EXPECT_MSG_EQ (classifier.Classify (FiveTupleClassifier::MakeKey (Ipv4Address ("10.1.2.1"), b, 6, 5, 1000, 46)), 9,
+                         "Another source prefix should not match");
+  NS_TEST_EXPECT_MSG_EQ (classifier.Classify (FiveTupleClassifier::MakeKey (Ipv6Address ("2001:db8:1::1"),
+                                                                            Ipv6Address ("2001:db9::1"), 17, 5, 1000, 0)), 7,
+                         "The IPv6 prefix should match");
+  NS_TEST_EXPECT_MSG_EQ (classifier.Classify (FiveTupleClassifier::MakeKey (Ipv6Address ("2001:db9::1"),
+                                                                            Ipv6Address ("2001:db8::1"), 17, 5, 1000, 0)), 9,
+                         "The IPv6 prefix should not match");
+
+  classifier.Clear ();
+  NS_TEST_EXPECT_MSG_EQ (classifier.Classify (FiveTupleClassifier::MakeKey (a, b, 17, 1000, 2000, 0)),
+                         FiveTupleClassifier::NO_MATCH, "No rule should match after clearing the rules");
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Five Tuple Classifier Many Rules Test Case
+ *
+ * Thousands of random rules are added, and the classification of random
+ * packets is compared to a linear search of the rules.
+ */
+class FiveTupleClassifierManyRulesTestCase : public TestCase
+{
+public:
+  FiveTupleClassifierManyRulesTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /// A rule, as checked by the linear search
+  struct Reference
+  {
+    uint32_t source;          //!< the source address
+    uint32_t sourceMask;      //!< the source mask
+    uint32_t destination;     //!< the destination address
+    uint32_t destinationMask; //!< the destination mask
+    uint16_t minPort;         //!< the first destination port
+    uint16_t maxPort;         //!< the last destination port
+    int16_t protocol;         //!< the protocol (-1 for any)
+  };
+};
+
+FiveTupleClassifierManyRulesTestCase::FiveTupleClassifierManyRulesTestCase ()
+  : TestCase ("Check the five tuple classifier against a linear search of 5000 rules")
+{
+}
+
+void
+FiveTupleClassifierManyRulesTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (1);
+
+  FiveTupleClassifier classifier;
+  std::vector<Reference> references;
+  const uint32_t prefixes[] = {8, 16, 24, 32};
+
+  for (uint32_t i = 0; i < 5000; i++)
+    {
+      Reference ref;
+      uint32_t srcLength = prefixes[rng->GetInteger (0, 3)];
+      uint32_t dstLength = prefixes[rng->GetInteger (0, 3)];
+      ref.sourceMask = 0xffffffff << (32 - srcLength);
+      ref.destinationMask = 0xffffffff << (32 - dstLength);
+      ref.source = (0x0a000000 | rng->GetInteger (0, 0xffff)) & ref.sourceMask;
+      ref.destination = (0x0b000000 | rng->GetInteger (0, 0xffff)) & ref.destinationMask;
+      ref.minPort = rng->GetInteger (0, 2000);
+      ref.maxPort = ref.minPort + rng->GetInteger (0, 200);
+      ref.protocol = (rng->GetInteger (0, 1) ? 6 : -1);
+      references.push_back (ref);
+
+      FiveTupleRule rule;
+      rule.SetSource (Ipv4Address (ref.source), Ipv4Mask (ref.sourceMask));
+      rule.SetDestination (Ipv4Address (ref.destination), Ipv4Mask (ref.destinationMask));
+      rule.SetDestinationPortRange (ref.minPort, ref.maxPort);
+      if (ref.protocol >= 0)
+        {
+          rule.SetProtocol (ref.protocol);
+        }
+      classifier.AddRule (rule, i);
+    }
+  NS_TEST_EXPECT_MSG_EQ (classifier.GetNTuples (), 32, "The rules should be grouped into few tuples");
+
+  uint32_t nMatched = 0;
+  for (uint32_t i = 0; i < 20000; i++)
+    {
+      // pick a packet matching the addresses of a random rule most of the time
+      const Reference &ref = references[rng->GetInteger (0, references.size () - 1)];
+      uint32_t src = ref.source | (rng->GetInteger (0, 0xffff) & ~ref.sourceMask);
+      uint32_t dst = ref.destination | (rng->GetInteger (0, 0xffff) & ~ref.destinationMask);
+      uint16_t port = rng->GetInteger (0, 2300);
+      uint8_t protocol = (rng->GetInteger (0, 1) ? 6 : 17);
+
+      int32_t expected = FiveTupleClassifier::NO_MATCH;
+      for (uint32_t r = 0; r < references.size (); r++)
+        {
+          const Reference &cand = references[r];
+          if ((src & cand.sourceMask) == cand.source && (dst & cand.destinationMask) == cand.destination
+              && port >= cand.minPort && port <= cand.maxPort
+              && (cand.protocol < 0 || cand.protocol == protocol))
+            {
+              expected = r;
+              break;
+            }
+        }
+      nMatched += (expected != FiveTupleClassifier::NO_MATCH ? 1 : 0);
+
+      int32_t value = classifier.Classify (FiveTupleClassifier::MakeKey (Ipv4Address (src), Ipv4Address (dst),
+                                                                         protocol, 1234, port, 0));
+      NS_TEST_ASSERT_MSG_EQ (value, expected, "Unexpected rule matched by packet " << i);
+    }
+  NS_TEST_EXPECT_MSG_GT (nMatched, 1000, "Too few packets matched a rule");
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Five Tuple Classifier Test Suite
+ */
+static class FiveTupleClassifierTestSuite : public TestSuite
+{
+public:
+  FiveTupleClassifierTestSuite ()
+    : TestSuite ("five-tuple-classifier", UNIT)
+  {
+    AddTestCase (new FiveTupleClassifierRulesTestCase (), TestCase::QUICK);
+    AddTestCase (new FiveTupleClassifierManyRulesTestCase (), TestCase::QUICK);
+  }
+} g_fiveTupleClassifierTestSuite; ///< the test suite
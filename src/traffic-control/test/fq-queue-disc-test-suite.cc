@@ -0,0 +1,308 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/fq-queue-disc.h"
+#include "ns3/departure-time-tag.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Fq Queue Disc Test Item
+ */
+class FqQueueDiscTestItem : public QueueDiscItem {
+public:
+  /**
+   * Constructor
+   *
+   * \param p the packet
+   * \param flow the flow of the packet
+   */
+  FqQueueDiscTestItem (Ptr<Packet> p, uint32_t flow);
+  virtual ~FqQueueDiscTestItem ();
+  virtual void AddHeader (void);
+  virtual bool Mark (void);
+  virtual uint32_t Hash (uint32_t perturbation) const;
+
+private:
+  FqQueueDiscTestItem ();
+  /**
+   * \brief Copy constructor
+   * Disable default implementation to avoid misuse
+   */
+  FqQueueDiscTestItem (const FqQueueDiscTestItem &);
+  /**
+   * \brief Assignment operator
+   * \return this object
+   * Disable default implementation to avoid misuse
+   */
+  FqQueueDiscTestItem &operator = (const FqQueueDiscTestItem &);
+  uint32_t m_flow; //!< Flow of the packet
+};
+
+FqQueueDiscTestItem::FqQueueDiscTestItem (Ptr<Packet> p, uint32_t flow)
+  : QueueDiscItem (p, Address (), 0),
+    m_flow (flow)
+{
+}
+
+FqQueueDiscTestItem::~FqQueueDiscTestItem ()
+{
+}
+
+void
+FqQueueDiscTestItem::AddHeader (void)
+{
+}
+
+bool
+FqQueueDiscTestItem::Mark (void)
+{
+  return false;
+}
+
+uint32_t
+FqQueueDiscTestItem::Hash (uint32_t perturbation) const
+{
+  return m_flow;
+}
+
+/**
+ * Enqueue a packet
+ * \param queue the queue disc
+ * \param flow the flow of the packet
+ * \param size the size of the packet
+ * \param departure the departure time of the packet, if positive
+ * \return true if the packet has been enqueued
+ */
+static bool
+FqQueueDiscTestEnqueue (Ptr<FqQueueDisc> queue, uint32_t flow, uint32_t size, Time departure)
+{
+  Ptr<Packet> p = Create<Packet> (size);
+  if (departure.IsStrictlyPositive ())
+    {
+      p->AddPacketTag (DepartureTimeTag (departure));
+    }
+  return queue->Enqueue (Create<FqQueueDiscTestItem> (p, flow));
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Fq Queue Disc Round Robin Test Case
+ *
+ * Two backlogged flows are served in Deficit Round Robin, the first flow
+ * being the first new flow. The packets beyond the limit of a flow queue
+ * are dropped.
+ */
+class FqQueueDiscRoundRobinTestCase : public TestCase
+{
+public:
+  FqQueueDiscRoundRobinTestCase ();
+  virtual void DoRun (void);
+};
+
+FqQueueDiscRoundRobinTestCase::FqQueueDiscRoundRobinTestCase ()
+  : TestCase ("Check the round robin of the Fq queue disc")
+{
+}
+
+void
+FqQueueDiscRoundRobinTestCase::DoRun (void)
+{
+  Ptr<FqQueueDisc> queue = CreateObjectWithAttributes<FqQueueDisc> ("FlowLimit", UintegerValue (6),
+                                                                    "Quantum", UintegerValue (200),
+                                                                    "InitialQuantum", UintegerValue (200));
+  queue->Initialize ();
+
+  for (uint32_t i = 0; i < 6; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (FqQueueDiscTestEnqueue (queue, 1, 100, Seconds (0)), true, "The packet should be enqueued");
+    }
+  NS_TEST_EXPECT_MSG_EQ (FqQueueDiscTestEnqueue (queue, 1, 100, Seconds (0)), false, "The packet beyond the flow limit should be dropped");
+  for (uint32_t i = 0; i < 6; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (FqQueueDiscTestEnqueue (queue, 2, 101, Seconds (0)), true, "The packet should be enqueued");
+    }
+  NS_TEST_EXPECT_MSG_EQ (queue->GetStats ().GetNDroppedPackets (FqQueueDisc::FLOW_LIMIT_DROP), 1,
+                         "One packet should be dropped because of the flow limit");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetFlowQueueTable ().GetNUsedFlows (), 2, "Two flow queues should be used");
+
+  // each flow sends two packets at each round
+  uint32_t expected[] = {100, 100, 101, 101, 100, 100, 101, 101, 100, 100, 101, 101};
+  for (uint32_t i = 0; i < 12; i++)
+    {
+      Ptr<QueueDiscItem> item = queue->Dequeue ();
+      NS_TEST_ASSERT_MSG_NE (item, 0, "A packet should be dequeued");
+      NS_TEST_EXPECT_MSG_EQ (item->GetSize (), expected[i], "Packet dequeued from the wrong flow");
+    }
+  NS_TEST_EXPECT_MSG_EQ (queue->Dequeue (), 0, "The queue disc should be empty");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Fq Queue Disc Pacing Test Case
+ *
+ * The packets of a paced flow are sent at their departure times, while the
+ * packets of an unpaced flow are sent at once. Packets beyond the horizon
+ * are dropped.
+ */
+class FqQueueDiscPacingTestCase : public TestCase
+{
+public:
+  FqQueueDiscPacingTestCase ();
+  virtual void DoRun (void);
+private:
+  /**
+   * Record a packet sent by the queue disc
+   * \param item the packet
+   */
+  void Send (Ptr<QueueDiscItem> item);
+
+  std::vector<std::pair<Time, uint32_t> > m_sent; //!< Send time and size of the sent packets
+};
+
+FqQueueDiscPacingTestCase::FqQueueDiscPacingTestCase ()
+  : TestCase ("Check the pacing of the Fq queue disc")
+{
+}
+
+void
+FqQueueDiscPacingTestCase::Send (Ptr<QueueDiscItem> item)
+{
+  m_sent.push_back (std::make_pair (Simulator::Now (), item->GetSize ()));
+}
+
+void
+FqQueueDiscPacingTestCase::DoRun (void)
+{
+  Ptr<FqQueueDisc> queue = CreateObjectWithAttributes<FqQueueDisc> ("Horizon", StringValue ("1s"),
+                                                                    "Quantum", UintegerValue (3000),
+                                                                    "InitialQuantum", UintegerValue (3000));
+  queue->SetSendCallback (MakeCallback (&FqQueueDiscPacingTestCase::Send, this));
+  queue->Initialize ();
+
+  // the packet size identifies the packet
+  NS_TEST_EXPECT_MSG_EQ (FqQueueDiscTestEnqueue (queue, 1, 103, MilliSeconds (1)), true, "The packet should be enqueued");
+  NS_TEST_EXPECT_MSG_EQ (FqQueueDiscTestEnqueue (queue, 1, 104, MilliSeconds (2)), true, "The packet should be enqueued");
+  NS_TEST_EXPECT_MSG_EQ (FqQueueDiscTestEnqueue (queue, 1, 105, MilliSeconds (3)), true, "The packet should be enqueued");
+  NS_TEST_EXPECT_MSG_EQ (FqQueueDiscTestEnqueue (queue, 1, 200, Seconds (2)), false, "The packet beyond the horizon should be dropped");
+  NS_TEST_EXPECT_MSG_EQ (FqQueueDiscTestEnqueue (queue, 2, 100, Seconds (0)), true, "The packet should be enqueued");
+  NS_TEST_EXPECT_MSG_EQ (FqQueueDiscTestEnqueue (queue, 2, 101, Seconds (0)), true, "The packet should be enqueued");
+  NS_TEST_EXPECT_MSG_EQ (FqQueueDiscTestEnqueue (queue, 2, 102, Seconds (0)), true, "The packet should be enqueued");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetStats ().GetNDroppedPackets (FqQueueDisc::HORIZON_DROP), 1,
+                         "One packet should be dropped because of the horizon");
+
+  // the first flow is throttled until its head packet can leave, while the
+  // second flow is served
+  Simulator::ScheduleNow (&QueueDisc::Run, queue);
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_sent.size (), 6, "All the packets should have been sent");
+  Time expected[] = {Seconds (0), Seconds (0), Seconds (0), MilliSeconds (1), MilliSeconds (2), MilliSeconds (3)};
+  for (uint32_t i = 0; i < m_sent.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_sent[i].second, 100 + i, "Packet sent out of order");
+      NS_TEST_EXPECT_MSG_EQ (m_sent[i].first, expected[i], "Packet sent at the wrong time");
+    }
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNThrottledFlows (), 0, "No flow should be throttled");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), 0, "The queue disc should be empty");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Fq Queue Disc Many Flows Test Case
+ *
+ * A packet of each of 10^5 flows is enqueued in as many flow queues. Each
+ * packet must be dequeued once, in the order of arrival, as all the flows
+ * are new flows.
+ */
+class FqQueueDiscManyFlowsTestCase : public TestCase
+{
+public:
+  FqQueueDiscManyFlowsTestCase ();
+  virtual void DoRun (void);
+};
+
+FqQueueDiscManyFlowsTestCase::FqQueueDiscManyFlowsTestCase ()
+  : TestCase ("Check the Fq queue disc with 10^5 flow queues")
+{
+}
+
+void
+FqQueueDiscManyFlowsTestCase::DoRun (void)
+{
+  uint32_t nFlows = 100000;
+  Ptr<FqQueueDisc> queue = CreateObjectWithAttributes<FqQueueDisc> ("MaxSize", StringValue ("100000p"),
+                                                                    "Flows", UintegerValue (nFlows),
+                                                                    "Quantum", UintegerValue (1500),
+                                                                    "InitialQuantum", UintegerValue (1500));
+  queue->Initialize ();
+
+  for (uint32_t i = 0; i < nFlows; i++)
+    {
+      FqQueueDiscTestEnqueue (queue, (i * 7919) % nFlows, 100, Seconds (0));
+    }
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), nFlows, "All the packets should be enqueued");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetFlowQueueTable ().GetNUsedFlows (), nFlows, "Each flow should have its flow queue");
+
+  const FlowQueueTable &table = queue->GetFlowQueueTable ();
+  uint32_t dequeued = 0;
+  while (queue->Dequeue ())
+    {
+      dequeued++;
+    }
+  NS_TEST_EXPECT_MSG_EQ (dequeued, nFlows, "All the packets should be dequeued");
+  NS_TEST_EXPECT_MSG_EQ (table.GetUsedFlow (1), 7919, "Flow queues used in the wrong order");
+  NS_TEST_EXPECT_MSG_EQ (table.GetStatus (7919), FlowQueueTable::INACTIVE, "The flow queue should be inactive");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Fq Queue Disc Test Suite
+ */
+static class FqQueueDiscTestSuite : public TestSuite
+{
+public:
+  FqQueueDiscTestSuite ()
+    : TestSuite ("fq-queue-disc", UNIT)
+  {
+    AddTestCase (new FqQueueDiscRoundRobinTestCase (), TestCase::QUICK);
+    AddTestCase (new FqQueueDiscPacingTestCase (), TestCase::QUICK);
+    AddTestCase (new FqQueueDiscManyFlowsTestCase (), TestCase::QUICK);
+  }
+} g_fqQueueDiscTestSuite; ///< the test suite
@@ -0,0 +1,501 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/htb-queue-disc.h"
+#include "ns3/fifo-queue-disc.h"
+#include "ns3/packet-filter.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/pointer.h"
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Htb Queue Disc Test Item
+ */
+class HtbQueueDiscTestItem : public QueueDiscItem {
+public:
+  /**
+   * Constructor
+   *
+   * \param p the packet
+   * \param leaf the leaf class of the packet
+   */
+  HtbQueueDiscTestItem (Ptr<Packet> p, int32_t leaf);
+  virtual ~HtbQueueDiscTestItem ();
+  virtual void AddHeader (void);
+  virtual bool Mark (void);
+  /**
+   * \return the leaf class of the packet
+   */
+  int32_t GetLeaf (void) const;
+
+private:
+  HtbQueueDiscTestItem ();
+  /**
+   * \brief Copy constructor
+   * Disable default implementation to avoid misuse
+   */
+  HtbQueueDiscTestItem (const HtbQueueDiscTestItem &);
+  /**
+   * \brief Assignment operator
+   * \return this object
+   * Disable default implementation to avoid misuse
+   */
+  HtbQueueDiscTestItem &operator = (const HtbQueueDiscTestItem &);
+  int32_t m_leaf; //!< Leaf class of the packet
+};
+
+HtbQueueDiscTestItem::HtbQueueDiscTestItem (Ptr<Packet> p, int32_t leaf)
+  : QueueDiscItem (p, Mac48Address (), 0),
+    m_leaf (leaf)
+{
+}
+
+HtbQueueDiscTestItem::~HtbQueueDiscTestItem ()
+{
+}
+
+void
+HtbQueueDiscTestItem::AddHeader (void)
+{
+}
+
+bool
+HtbQueueDiscTestItem::Mark (void)
+{
+  return false;
+}
+
+int32_t
+HtbQueueDiscTestItem::GetLeaf (void) const
+{
+  return m_leaf;
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Htb Queue Disc Test Packet Filter, returning the leaf class of the test items
+ */
+class HtbQueueDiscTestFilter : public PacketFilter
+{
+private:
+  virtual bool CheckProtocol (Ptr<QueueDiscItem> item) const;
+  virtual int32_t DoClassify (Ptr<QueueDiscItem> item) const;
+};
+
+bool
+HtbQueueDiscTestFilter::CheckProtocol (Ptr<QueueDiscItem> item) const
+{
+  return true;
+}
+
+int32_t
+HtbQueueDiscTestFilter::DoClassify (Ptr<QueueDiscItem> item) const
+{
+  return StaticCast<HtbQueueDiscTestItem> (item)->GetLeaf ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Htb Queue Disc Rates Test Case
+ *
+ * The leaf classes of an HTB queue disc are kept backlogged and the queue disc
+ * is dequeued at the rate of a 100Mbps link, which is faster than any class.
+ * The rates of the leaf classes are checked against those obtained with Linux
+ * HTB: each class gets its rate and the excess of its parent is shared among
+ * the children that can borrow in proportion to their quanta (i.e., to their
+ * rates), with the highest priority children served first, and up to their
+ * ceil rate.
+ */
+class HtbQueueDiscRatesTestCase : public TestCase
+{
+public:
+  HtbQueueDiscRatesTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Create a class
+   * \param parent the parent class
+   * \param rate the rate
+   * \param ceil the ceil rate
+   * \param prio the priority
+   * \return the class
+   */
+  Ptr<HtbClass> CreateClass (Ptr<HtbClass> parent, std::string rate, std::string ceil, uint8_t prio = 0);
+  /**
+   * Create a leaf class and add it to the queue disc
+   * \param qd the queue disc
+   * \param parent the parent class
+   * \param rate the rate
+   * \param ceil the ceil rate
+   * \param prio the priority
+   */
+  void AddLeaf (Ptr<HtbQueueDisc> qd, Ptr<HtbClass> parent, std::string rate, std::string ceil, uint8_t prio = 0);
+  /**
+   * Fill the given leaf classes and dequeue the queue disc for the given duration
+   * \param qd the queue disc
+   * \param backlogged the number of packets enqueued in each leaf class
+   * \param packetSize the size of the packets
+   * \param duration the duration
+   * \return the rate of each leaf class, in Mbps
+   */
+  std::vector<double> Run (Ptr<HtbQueueDisc> qd, std::vector<uint32_t> backlogged, uint32_t packetSize,
+                           Time duration);
+  /**
+   * Dequeue a packet and schedule the next dequeue at the link rate
+   * \param qd the queue disc
+   */
+  void Pump (Ptr<HtbQueueDisc> qd);
+  /**
+   * Count a packet sent
+   * \param item the packet
+   */
+  void Sent (Ptr<QueueDiscItem> item);
+
+  std::vector<uint64_t> m_bytes;   //!< Bytes sent by each leaf class
+  EventId m_pump;                  //!< The next dequeue
+};
+
+HtbQueueDiscRatesTestCase::HtbQueueDiscRatesTestCase ()
+  : TestCase ("Check the rates of the classes of an HTB queue disc")
+{
+}
+
+Ptr<HtbClass>
+HtbQueueDiscRatesTestCase::CreateClass (Ptr<HtbClass> parent, std::string rate, std::string ceil, uint8_t prio)
+{
+  return CreateObjectWithAttributes<HtbClass> ("Parent", PointerValue (parent),
+                                               "Rate", StringValue (rate),
+                                               "Ceil", StringValue (ceil),
+                                               "Priority", UintegerValue (prio));
+}
+
+void
+HtbQueueDiscRatesTestCase::AddLeaf (Ptr<HtbQueueDisc> qd, Ptr<HtbClass> parent, std::string rate, std::string ceil,
+                                    uint8_t prio)
+{
+  Ptr<HtbClass> c = CreateClass (parent, rate, ceil, prio);
+  c->SetQueueDisc (CreateObjectWithAttributes<FifoQueueDisc> ("MaxSize", StringValue ("100000p")));
+  qd->AddQueueDiscClass (c);
+}
+
+void
+HtbQueueDiscRatesTestCase::Sent (Ptr<QueueDiscItem> item)
+{
+  m_bytes[StaticCast<HtbQueueDiscTestItem> (item)->GetLeaf ()] += item->GetSize ();
+}
+
+void
+HtbQueueDiscRatesTestCase::Pump (Ptr<HtbQueueDisc> qd)
+{
+  Ptr<QueueDiscItem> item = qd->Dequeue ();
+  if (item)
+    {
+      Sent (item);
+      m_pump = Simulator::Schedule (DataRate ("100Mbps").CalculateBytesTxTime (item->GetSize ()),
+                                    &HtbQueueDiscRatesTestCase::Pump, this, qd);
+    }
+  else
+    {
+      m_pump = Simulator::Schedule (MicroSeconds (10), &HtbQueueDiscRatesTestCase::Pump, this, qd);
+    }
+}
+
+std::vector<double>
+HtbQueueDiscRatesTestCase::Run (Ptr<HtbQueueDisc> qd, std::vector<uint32_t> backlogged, uint32_t packetSize,
+                                Time duration)
+{
+  qd->AddPacketFilter (CreateObject<HtbQueueDiscTestFilter> ());
+  // the packets sent when the queue disc wakes itself up
+  qd->SetSendCallback (MakeCallback (&HtbQueueDiscRatesTestCase::Sent, this));
+  qd->Initialize ();
+
+  m_bytes.assign (backlogged.size (), 0);
+  for (uint32_t leaf = 0; leaf < backlogged.size (); leaf++)
+    {
+      for (uint32_t i = 0; i < backlogged[leaf]; i++)
+        {
+          qd->Enqueue (Create<HtbQueueDiscTestItem> (Create<Packet> (packetSize), leaf));
+        }
+    }
+
+  m_pump = Simulator::ScheduleNow (&HtbQueueDiscRatesTestCase::Pump, this, qd);
+  Simulator::Stop (duration);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  std::vector<double> rates;
+  for (auto bytes : m_bytes)
+    {
+      rates.push_back (bytes * 8 / duration.GetSeconds () / 1e6);
+    }
+  qd->Dispose ();
+  return rates;
+}
+
+void
+HtbQueueDiscRatesTestCase::DoRun (void)
+{
+  Ptr<HtbQueueDisc> qd;
+  Ptr<HtbClass> root;
+  std::vector<double> rates;
+  Time duration = Seconds (2);
+
+  // a single class sends at its rate
+  qd = CreateObject<HtbQueueDisc> ();
+  AddLeaf (qd, 0, "1Mbps", "1Mbps");
+  rates = Run (qd, {1000}, 1000, duration);
+  NS_TEST_EXPECT_MSG_EQ_TOL (rates[0], 1, 0.02, "A class should send at its rate");
+
+  // the excess is shared in proportion to the rates
+  qd = CreateObject<HtbQueueDisc> ();
+  root = CreateClass (0, "10Mbps", "10Mbps");
+  AddLeaf (qd, root, "2Mbps", "10Mbps");
+  AddLeaf (qd, root, "3Mbps", "10Mbps");
+  rates = Run (qd, {5000, 5000}, 1000, duration);
+  NS_TEST_EXPECT_MSG_EQ_TOL (rates[0], 4, 0.15, "The excess should be shared in proportion to the rates");
+  NS_TEST_EXPECT_MSG_EQ_TOL (rates[1], 6, 0.15, "The excess should be shared in proportion to the rates");
+  NS_TEST_EXPECT_MSG_EQ_TOL (rates[0] + rates[1], 10, 0.2, "The classes should get the rate of their parent");
+
+  // the highest priority class borrows the excess
+  qd = CreateObject<HtbQueueDisc> ();
+  root = CreateClass (0, "10Mbps", "10Mbps");
+  AddLeaf (qd, root, "2Mbps", "10Mbps", 1);
+  AddLeaf (qd, root, "3Mbps", "10Mbps", 0);
+  rates = Run (qd, {5000, 5000}, 1000, duration);
+  NS_TEST_EXPECT_MSG_EQ_TOL (rates[0], 2, 0.05, "The low priority class should only get its rate");
+  NS_TEST_EXPECT_MSG_EQ_TOL (rates[1], 8, 0.15, "The high priority class should get the excess");
+
+  // a class does not borrow beyond its ceil rate
+  qd = CreateObject<HtbQueueDisc> ();
+  root = CreateClass (0, "10Mbps", "10Mbps");
+  AddLeaf (qd, root, "2Mbps", "3Mbps");
+  AddLeaf (qd, root, "3Mbps", "10Mbps");
+  rates = Run (qd, {5000, 5000}, 1000, duration);
+  // the class may send less than its ceil rate, as its ceil tokens overflow
+  // while the other class is served a quantum
+  NS_TEST_EXPECT_MSG_EQ_TOL (rates[0], 3, 0.15, "A class should borrow up to its ceil rate");
+  NS_TEST_EXPECT_MSG_LT_OR_EQ (rates[0], 3.02, "A class should not exceed its ceil rate");
+  NS_TEST_EXPECT_MSG_EQ_TOL (rates[1], 7, 0.15, "The other class should get the rest");
+
+  // a class alone borrows up to its ceil rate, the other class being idle
+  qd = CreateObject<HtbQueueDisc> ();
+  root = CreateClass (0, "10Mbps", "10Mbps");
+  AddLeaf (qd, root, "2Mbps", "10Mbps");
+  AddLeaf (qd, root, "3Mbps", "10Mbps");
+  rates = Run (qd, {5000, 0}, 1000, duration);
+  NS_TEST_EXPECT_MSG_EQ_TOL (rates[0], 10, 0.2, "A class alone should borrow the rate of its parent");
+
+  // two levels of inner classes: the inner classes get their rates, which
+  // sum to the rate of the root class, and share them among their children
+  qd = CreateObject<HtbQueueDisc> ();
+  root = CreateClass (0, "10Mbps", "10Mbps");
+  Ptr<HtbClass> a = CreateClass (root, "6Mbps", "10Mbps");
+  Ptr<HtbClass> b = CreateClass (root, "4Mbps", "10Mbps");
+  AddLeaf (qd, a, "1Mbps", "10Mbps");
+  AddLeaf (qd, a, "1Mbps", "10Mbps");
+  AddLeaf (qd, b, "1Mbps", "10Mbps");
+  rates = Run (qd, {5000, 5000, 5000}, 1000, duration);
+  NS_TEST_EXPECT_MSG_EQ_TOL (rates[0], 3, 0.15, "The class should get half of the rate of its parent");
+  NS_TEST_EXPECT_MSG_EQ_TOL (rates[1], 3, 0.15, "The class should get half of the rate of its parent");
+  NS_TEST_EXPECT_MSG_EQ_TOL (rates[2], 4, 0.15, "The class should get the rate of its parent");
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Htb Queue Disc Many Classes Test Case
+ *
+ * A thousand leaf classes share the rate of their parent, which is the sum of
+ * their rates, and each of them gets its rate.
+ */
+class HtbQueueDiscManyClassesTestCase : public TestCase
+{
+public:
+  HtbQueueDiscManyClassesTestCase ();
+  virtual void DoRun (void);
+private:
+  /**
+   * Dequeue the packets available and schedule the next dequeue
+   * \param qd the queue disc
+   */
+  void Pump (Ptr<HtbQueueDisc> qd);
+  /**
+   * Count a packet sent
+   * \param item the packet
+   */
+  void Sent (Ptr<QueueDiscItem> item);
+
+  std::vector<uint32_t> m_packets;   //!< Packets sent by each leaf class
+};
+
+HtbQueueDiscManyClassesTestCase::HtbQueueDiscManyClassesTestCase ()
+  : TestCase ("Check that a thousand classes of an HTB queue disc get their rates")
+{
+}
+
+void
+HtbQueueDiscManyClassesTestCase::Sent (Ptr<QueueDiscItem> item)
+{
+  m_packets[StaticCast<HtbQueueDiscTestItem> (item)->GetLeaf ()]++;
+}
+
+void
+HtbQueueDiscManyClassesTestCase::Pump (Ptr<HtbQueueDisc> qd)
+{
+  Ptr<QueueDiscItem> item;
+  while ((item = qd->Dequeue ()))
+    {
+      Sent (item);
+    }
+  Simulator::Schedule (MicroSeconds (100), &HtbQueueDiscManyClassesTestCase::Pump, this, qd);
+}
+
+void
+HtbQueueDiscManyClassesTestCase::DoRun (void)
+{
+  const uint32_t nLeaves = 1000;
+  // each leaf sends 100 byte packets at 10kbps, i.e., 25 packets in 2 seconds
+  // plus a packet allowed by its initial burst
+  Ptr<HtbQueueDisc> qd = CreateObject<HtbQueueDisc> ();
+  Ptr<HtbClass> root = CreateObjectWithAttributes<HtbClass> ("Rate", StringValue ("10Mbps"));
+  for (uint32_t i = 0; i < nLeaves; i++)
+    {
+      Ptr<HtbClass> c = CreateObjectWithAttributes<HtbClass> ("Parent", PointerValue (root),
+                                                              "Rate", StringValue ("10kbps"),
+                                                              "Ceil", StringValue ("10Mbps"),
+                                                              "Burst", UintegerValue (100),
+                                                              "Cburst", UintegerValue (100));
+      c->SetQueueDisc (CreateObjectWithAttributes<FifoQueueDisc> ("MaxSize", StringValue ("1000p")));
+      qd->AddQueueDiscClass (c);
+    }
+  qd->AddPacketFilter (CreateObject<HtbQueueDiscTestFilter> ());
+  qd->SetSendCallback (MakeCallback (&HtbQueueDiscManyClassesTestCase::Sent, this));
+  qd->Initialize ();
+
+  m_packets.assign (nLeaves, 0);
+  for (uint32_t leaf = 0; leaf < nLeaves; leaf++)
+    {
+      for (uint32_t i = 0; i < 100; i++)
+        {
+          qd->Enqueue (Create<HtbQueueDiscTestItem> (Create<Packet> (100), leaf));
+        }
+    }
+
+  Simulator::ScheduleNow (&HtbQueueDiscManyClassesTestCase::Pump, this, qd);
+  Simulator::Stop (Seconds (2));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  uint32_t total = 0;
+  for (uint32_t leaf = 0; leaf < nLeaves; leaf++)
+    {
+      total += m_packets[leaf];
+      NS_TEST_EXPECT_MSG_EQ_TOL (m_packets[leaf], 26, 3, "Class " << leaf << " should get its rate");
+    }
+  NS_TEST_EXPECT_MSG_EQ_TOL (total, 26000, 500, "The classes should get the rate of their parent");
+  qd->Dispose ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Htb Queue Disc Classification Test Case
+ *
+ * The packets not classified by the filters are enqueued in the default class,
+ * or dropped if the default class does not exist.
+ */
+class HtbQueueDiscClassificationTestCase : public TestCase
+{
+public:
+  HtbQueueDiscClassificationTestCase ();
+  virtual void DoRun (void);
+};
+
+HtbQueueDiscClassificationTestCase::HtbQueueDiscClassificationTestCase ()
+  : TestCase ("Check the classification of packets by an HTB queue disc")
+{
+}
+
+void
+HtbQueueDiscClassificationTestCase::DoRun (void)
+{
+  Ptr<HtbQueueDisc> qd = CreateObjectWithAttributes<HtbQueueDisc> ("DefaultClass", UintegerValue (1));
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      Ptr<HtbClass> c = CreateObject<HtbClass> ();
+      c->SetQueueDisc (CreateObject<FifoQueueDisc> ());
+      qd->AddQueueDiscClass (c);
+    }
+  qd->AddPacketFilter (CreateObject<HtbQueueDiscTestFilter> ());
+  qd->Initialize ();
+
+  qd->Enqueue (Create<HtbQueueDiscTestItem> (Create<Packet> (100), 0));
+  qd->Enqueue (Create<HtbQueueDiscTestItem> (Create<Packet> (100), -1));
+  qd->Enqueue (Create<HtbQueueDiscTestItem> (Create<Packet> (100), 7));
+  NS_TEST_EXPECT_MSG_EQ (qd->GetQueueDiscClass (0)->GetQueueDisc ()->GetNPackets (), 1,
+                         "One packet should be enqueued in the first class");
+  NS_TEST_EXPECT_MSG_EQ (qd->GetQueueDiscClass (1)->GetQueueDisc ()->GetNPackets (), 2,
+                         "The unclassified packets should be enqueued in the default class");
+  qd->Dispose ();
+
+  qd = CreateObjectWithAttributes<HtbQueueDisc> ("DefaultClass", UintegerValue (5));
+  Ptr<HtbClass> c = CreateObject<HtbClass> ();
+  c->SetQueueDisc (CreateObject<FifoQueueDisc> ());
+  qd->AddQueueDiscClass (c);
+  qd->AddPacketFilter (CreateObject<HtbQueueDiscTestFilter> ());
+  qd->Initialize ();
+
+  qd->Enqueue (Create<HtbQueueDiscTestItem> (Create<Packet> (100), -1));
+  NS_TEST_EXPECT_MSG_EQ (qd->GetNPackets (), 0, "The unclassified packet should be dropped");
+  NS_TEST_EXPECT_MSG_EQ (qd->GetStats ().GetNDroppedPackets (HtbQueueDisc::UNCLASSIFIED_DROP), 1,
+                         "The unclassified packet should be dropped");
+  qd->Dispose ();
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Htb Queue Disc Test Suite
+ */
+static class HtbQueueDiscTestSuite : public TestSuite
+{
+public:
+  HtbQueueDiscTestSuite ()
+    : TestSuite ("htb-queue-disc", UNIT)
+  {
+    AddTestCase (new HtbQueueDiscRatesTestCase (), TestCase::QUICK);
+    AddTestCase (new HtbQueueDiscManyClassesTestCase (), TestCase::QUICK);
+    AddTestCase (new HtbQueueDiscClassificationTestCase (), TestCase::QUICK);
+  }
+} g_htbQueueDiscTestSuite; ///< the test suite
@@ -0,0 +1,228 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/mq-queue-disc.h"
+#include "ns3/fifo-queue-disc.h"
+#include "ns3/traffic-control-layer.h"
+#include "ns3/net-device-queue-interface.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simple-channel.h"
+#include "ns3/drop-tail-queue.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Mq Queue Disc Test Item
+ */
+class MqQueueDiscTestItem : public QueueDiscItem {
+public:
+  /**
+   * Constructor
+   *
+   * \param p the packet
+   * \param flow the flow of the packet
+   */
+  MqQueueDiscTestItem (Ptr<Packet> p, uint32_t flow);
+  virtual ~MqQueueDiscTestItem ();
+  virtual void AddHeader (void);
+  virtual bool Mark (void);
+  virtual uint32_t Hash (uint32_t perturbation) const;
+
+private:
+  MqQueueDiscTestItem ();
+  /**
+   * \brief Copy constructor
+   * Disable default implementation to avoid misuse
+   */
+  MqQueueDiscTestItem (const MqQueueDiscTestItem &);
+  /**
+   * \brief Assignment operator
+   * \return this object
+   * Disable default implementation to avoid misuse
+   */
+  MqQueueDiscTestItem &operator = (const MqQueueDiscTestItem &);
+  uint32_t m_flow; //!< Flow of the packet
+};
+
+MqQueueDiscTestItem::MqQueueDiscTestItem (Ptr<Packet> p, uint32_t flow)
+  : QueueDiscItem (p, Mac48Address (), 0),
+    m_flow (flow)
+{
+}
+
+MqQueueDiscTestItem::~MqQueueDiscTestItem ()
+{
+}
+
+void
+MqQueueDiscTestItem::AddHeader (void)
+{
+}
+
+bool
+MqQueueDiscTestItem::Mark (void)
+{
+  return false;
+}
+
+uint32_t
+MqQueueDiscTestItem::Hash (uint32_t perturbation) const
+{
+  return m_flow;
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Mq Queue Disc Test Case
+ *
+ * The packets sent through a device with four transmission queues are
+ * enqueued in the child queue disc of the transmission queue selected for
+ * them. The child queue discs do not notify the mq queue disc, whose number
+ * of packets and statistics are the sum of those of the child queue discs.
+ */
+class MqQueueDiscTestCase : public TestCase
+{
+public:
+  MqQueueDiscTestCase ();
+  virtual void DoRun (void);
+private:
+  /**
+   * Count the packets enqueued in the mq queue disc
+   * \param item the packet
+   */
+  void RootEnqueue (Ptr<const QueueDiscItem> item);
+
+  uint32_t m_rootEnqueued; //!< Number of packets reported by the Enqueue trace of the mq queue disc
+};
+
+MqQueueDiscTestCase::MqQueueDiscTestCase ()
+  : TestCase ("Check the per-queue dispatch and the statistics of the mq queue disc"),
+    m_rootEnqueued (0)
+{
+}
+
+void
+MqQueueDiscTestCase::RootEnqueue (Ptr<const QueueDiscItem> item)
+{
+  m_rootEnqueued++;
+}
+
+void
+MqQueueDiscTestCase::DoRun (void)
+{
+  const uint32_t nTxQueues = 4;
+
+  Ptr<Node> node = CreateObject<Node> ();
+  Ptr<TrafficControlLayer> tc = CreateObject<TrafficControlLayer> ();
+  node->AggregateObject (tc);
+
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  Ptr<SimpleNetDevice> dev = CreateObject<SimpleNetDevice> ();
+  dev->SetAddress (Mac48Address::Allocate ());
+  dev->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+  dev->SetChannel (channel);
+  node->AddDevice (dev);
+
+  // the transmission queue of a packet is its flow modulo the number of queues
+  Ptr<NetDeviceQueueInterface> ndqi = CreateObjectWithAttributes<NetDeviceQueueInterface> ("NTxQueues",
+                                                                                          UintegerValue (nTxQueues));
+  ndqi->SetSelectQueueCallback ([nTxQueues] (Ptr<QueueItem> item)
+                                { return DynamicCast<QueueDiscItem> (item)->Hash () % nTxQueues; });
+  dev->AggregateObject (ndqi);
+
+  // the child queue discs hold up to 3 packets
+  Ptr<MqQueueDisc> mq = CreateObject<MqQueueDisc> ();
+  for (uint32_t i = 0; i < nTxQueues; i++)
+    {
+      Ptr<QueueDiscClass> c = CreateObject<QueueDiscClass> ();
+      c->SetQueueDisc (CreateObjectWithAttributes<FifoQueueDisc> ("MaxSize", StringValue ("3p")));
+      mq->AddQueueDiscClass (c);
+    }
+  mq->TraceConnectWithoutContext ("Enqueue", MakeCallback (&MqQueueDiscTestCase::RootEnqueue, this));
+  tc->SetRootQueueDiscOnDevice (dev, mq);
+  node->Initialize ();
+
+  // stop the transmission queues, so that the packets are not dequeued
+  for (uint32_t i = 0; i < nTxQueues; i++)
+    {
+      ndqi->GetTxQueue (i)->Stop ();
+    }
+
+  // 2 packets of flow 1, 4 packets of flow 2 (one is dropped) and 1 packet of flow 7
+  uint32_t flows[] = {1, 1, 2, 2, 2, 2, 7};
+  for (uint32_t i = 0; i < 7; i++)
+    {
+      tc->Send (dev, Create<MqQueueDiscTestItem> (Create<Packet> (100), flows[i]));
+    }
+
+  uint32_t expected[] = {0, 2, 3, 1};
+  for (uint32_t i = 0; i < nTxQueues; i++)
+    {
+      Ptr<QueueDisc> child = mq->GetQueueDiscClass (i)->GetQueueDisc ();
+      NS_TEST_EXPECT_MSG_EQ (child->GetNPackets (), expected[i],
+                             "Unexpected number of packets in the child queue disc " << i);
+    }
+  NS_TEST_EXPECT_MSG_EQ (m_rootEnqueued, 0, "The child queue discs should not notify the mq queue disc");
+  NS_TEST_EXPECT_MSG_EQ (mq->GetNPackets (), 6, "The mq queue disc should hold the packets of its children");
+  NS_TEST_EXPECT_MSG_EQ (mq->GetNBytes (), 600, "The mq queue disc should hold the bytes of its children");
+
+  const QueueDisc::Stats& st = mq->GetStats ();
+  NS_TEST_EXPECT_MSG_EQ (st.nTotalReceivedPackets, 7, "Unexpected number of received packets");
+  NS_TEST_EXPECT_MSG_EQ (st.nTotalEnqueuedPackets, 6, "Unexpected number of enqueued packets");
+  NS_TEST_EXPECT_MSG_EQ (st.nTotalDroppedPackets, 1, "Unexpected number of dropped packets");
+  NS_TEST_EXPECT_MSG_EQ (st.GetNDroppedPackets (std::string (QueueDisc::CHILD_QUEUE_DISC_DROP)
+                                                + FifoQueueDisc::LIMIT_EXCEEDED_DROP), 1,
+                         "The packet should be dropped by a child queue disc");
+
+  // waking a transmission queue only runs its child queue disc
+  ndqi->GetTxQueue (1)->Wake ();
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (mq->GetQueueDiscClass (1)->GetQueueDisc ()->GetNPackets (), 0,
+                         "The child queue disc of the woken queue should be empty");
+  NS_TEST_EXPECT_MSG_EQ (mq->GetQueueDiscClass (2)->GetQueueDisc ()->GetNPackets (), 3,
+                         "The other child queue discs should not be run");
+  NS_TEST_EXPECT_MSG_EQ (mq->GetNPackets (), 4, "The mq queue disc should hold the packets of its children");
+  NS_TEST_EXPECT_MSG_EQ (mq->GetStats ().nTotalSentPackets, 2, "Unexpected number of sent packets");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Mq Queue Disc Test Suite
+ */
+static class MqQueueDiscTestSuite : public TestSuite
+{
+public:
+  MqQueueDiscTestSuite ()
+    : TestSuite ("mq-queue-disc", UNIT)
+  {
+    AddTestCase (new MqQueueDiscTestCase (), TestCase::QUICK);
+  }
+} g_mqQueueDiscTestSuite; ///< the test suite
@@ -34,6 +34,7 @@
 #include "ns3/net-device-queue-interface.h"
 #include "ns3/queue.h"
 #include "ns3/config.h"
+#include "ns3/fifo-queue-disc.h"
 
 using namespace ns3;
 
@@ -103,8 +104,9 @@ public:
    * Constructor
    *
    * \param tt the test type
+   * \param maxBatchSize the maximum number of packets sent to the device at once
    */
-  TcFlowControlTestCase (QueueSizeUnit tt);
+  TcFlowControlTestCase (QueueSizeUnit tt, uint32_t maxBatchSize);
   virtual ~TcFlowControlTestCase ();
 private:
   virtual void DoRun (void);
@@ -136,11 +138,14 @@ private:
    */
   void CheckPacketsInQueueDisc (Ptr<NetDevice> dev, uint16_t nPackets, const char* msg);
   QueueSizeUnit m_type;       //!< the test type
+  uint32_t m_maxBatchSize;    //!< the maximum number of packets sent to the device at once
 };
 
-TcFlowControlTestCase::TcFlowControlTestCase (QueueSizeUnit tt)
-  : TestCase ("Test the operation of the flow control mechanism"),
-    m_type (tt)
+TcFlowControlTestCase::TcFlowControlTestCase (QueueSizeUnit tt, uint32_t maxBatchSize)
+  : TestCase ("Test the operation of the flow control mechanism (max batch size "
+              + std::to_string (maxBatchSize) + ")"),
+    m_type (tt),
+    m_maxBatchSize (maxBatchSize)
 {
 }
 
@@ -198,6 +203,7 @@ TcFlowControlTestCase::DoRun (void)
   NetDeviceContainer rxDevC = simple.Install (n.Get (1));
 
   simple.SetDeviceAttribute ("DataRate", DataRateValue (DataRate ("1Mb/s")));
+  simple.SetDeviceAttribute ("MaxBatchSize", UintegerValue (m_maxBatchSize));
   simple.SetQueue ("ns3::DropTailQueue", "MaxSize",
                    StringValue (m_type == QueueSizeUnit::PACKETS ? "5p" : "5000B"));
 
@@ -212,7 +218,66 @@ TcFlowControlTestCase::DoRun (void)
   Simulator::Schedule (Time (Seconds (0)), &TcFlowControlTestCase::SendPackets,
                       this, n.Get (0), 10);
 
-  if (m_type == QueueSizeUnit::PACKETS)
+  if (m_maxBatchSize > 1)
+    {
+      /*
+       * When the device accepts batches of 4 packets, the device queue (in
+       * packet mode) is only woken up when there is room for 4 packets, and
+       * then the queue disc sends the 4 packets it holds in a single batch
+       */
+
+      // After 1ms, we have 5 packets in the device queue (stopped) and 4 in the queue disc
+      Simulator::Schedule (Time (MilliSeconds (1)), &TcFlowControlTestCase::CheckPacketsInDeviceQueue,
+                          this, txDev, 5, "There must be 5 packets in the device queue after 1ms");
+      Simulator::Schedule (Time (MilliSeconds (1)), &TcFlowControlTestCase::CheckDeviceQueueStopped,
+                          this, txDev, true, "The device queue must be stopped after 1ms");
+      Simulator::Schedule (Time (MilliSeconds (1)), &TcFlowControlTestCase::CheckPacketsInQueueDisc,
+                          this, txDev, 4, "There must be 4 packets in the queue disc after 1ms");
+
+      // After 9ms, we have 4 packets in the device queue (still stopped) and 4 in the queue disc
+      Simulator::Schedule (Time (MilliSeconds (9)), &TcFlowControlTestCase::CheckPacketsInDeviceQueue,
+                          this, txDev, 4, "There must be 4 packets in the device queue after 9ms");
+      Simulator::Schedule (Time (MilliSeconds (9)), &TcFlowControlTestCase::CheckDeviceQueueStopped,
+                          this, txDev, true, "The device queue must be stopped after 9ms");
+      Simulator::Schedule (Time (MilliSeconds (9)), &TcFlowControlTestCase::CheckPacketsInQueueDisc,
+                          this, txDev, 4, "There must be 4 packets in the queue disc after 9ms");
+
+      // After 25ms, we have 2 packets in the device queue (still stopped) and 4 in the queue disc
+      Simulator::Schedule (Time (MilliSeconds (25)), &TcFlowControlTestCase::CheckPacketsInDeviceQueue,
+                          this, txDev, 2, "There must be 2 packets in the device queue after 25ms");
+      Simulator::Schedule (Time (MilliSeconds (25)), &TcFlowControlTestCase::CheckDeviceQueueStopped,
+                          this, txDev, true, "The device queue must be stopped after 25ms");
+      Simulator::Schedule (Time (MilliSeconds (25)), &TcFlowControlTestCase::CheckPacketsInQueueDisc,
+                          this, txDev, 4, "There must be 4 packets in the queue disc after 25ms");
+
+      // At 32ms there is room for 4 packets, which are sent at once: after 33ms,
+      // we have 5 packets in the device queue (stopped) and the queue disc is empty
+      Simulator::Schedule (Time (MilliSeconds (33)), &TcFlowControlTestCase::CheckPacketsInDeviceQueue,
+                          this, txDev, 5, "There must be 5 packets in the device queue after 33ms");
+      Simulator::Schedule (Time (MilliSeconds (33)), &TcFlowControlTestCase::CheckDeviceQueueStopped,
+                          this, txDev, true, "The device queue must be stopped after 33ms");
+      Simulator::Schedule (Time (MilliSeconds (33)), &TcFlowControlTestCase::CheckPacketsInQueueDisc,
+                          this, txDev, 0, "The queue disc must be empty after 33ms");
+
+      // After 57ms, we have 2 packets in the device queue (still stopped)
+      Simulator::Schedule (Time (MilliSeconds (57)), &TcFlowControlTestCase::CheckPacketsInDeviceQueue,
+                          this, txDev, 2, "There must be 2 packets in the device queue after 57ms");
+      Simulator::Schedule (Time (MilliSeconds (57)), &TcFlowControlTestCase::CheckDeviceQueueStopped,
+                          this, txDev, true, "The device queue must be stopped after 57ms");
+
+      // After 65ms, we have 1 packet in the device queue (not stopped)
+      Simulator::Schedule (Time (MilliSeconds (65)), &TcFlowControlTestCase::CheckPacketsInDeviceQueue,
+                          this, txDev, 1, "There must be 1 packet in the device queue after 65ms");
+      Simulator::Schedule (Time (MilliSeconds (65)), &TcFlowControlTestCase::CheckDeviceQueueStopped,
+                          this, txDev, false, "The device queue must not be stopped after 65ms");
+
+      // After 81ms, all packets must have been transmitted
+      Simulator::Schedule (Time (MilliSeconds (81)), &TcFlowControlTestCase::CheckPacketsInDeviceQueue,
+                          this, txDev, 0, "The device queue must be empty after 81ms");
+      Simulator::Schedule (Time (MilliSeconds (81)), &TcFlowControlTestCase::CheckPacketsInQueueDisc,
+                          this, txDev, 0, "The queue disc must be empty after 81ms");
+    }
+  else if (m_type == QueueSizeUnit::PACKETS)
     {
       /*
        * When the device queue is in packet mode, all the packets enqueued in the
@@ -363,6 +428,90 @@ TcFlowControlTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Traffic Control Batch Test Case
+ *
+ * Checks that a batch only includes packets destined to the same device queue
+ * and that the packet destined to another device queue, which ends a batch, is
+ * sent in the next batch without being counted as requeued.
+ */
+class TcBatchTxQueueTestCase : public TestCase
+{
+public:
+  TcBatchTxQueueTestCase ();
+  virtual ~TcBatchTxQueueTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Record a batch sent to the device
+   * \param batch the batch of packets
+   */
+  void SendBatch (const std::vector<Ptr<QueueDiscItem> > &batch);
+  std::vector<std::vector<uint8_t> > m_batches;  //!< the tx queues of the packets of each batch
+};
+
+TcBatchTxQueueTestCase::TcBatchTxQueueTestCase ()
+  : TestCase ("Test batches of packets destined to different device queues")
+{
+}
+
+TcBatchTxQueueTestCase::~TcBatchTxQueueTestCase ()
+{
+}
+
+void
+TcBatchTxQueueTestCase::SendBatch (const std::vector<Ptr<QueueDiscItem> > &batch)
+{
+  std::vector<uint8_t> txqs;
+  for (auto& item : batch)
+    {
+      txqs.push_back (item->GetTxQueueIndex ());
+    }
+  m_batches.push_back (txqs);
+}
+
+void
+TcBatchTxQueueTestCase::DoRun (void)
+{
+  Ptr<QueueDisc> qdisc = CreateObject<FifoQueueDisc> ();
+  qdisc->SetSendBatchCallback ([this] (const std::vector<Ptr<QueueDiscItem> > &batch)
+                               { SendBatch (batch); });
+  qdisc->SetMaxBatchSize (4);
+  qdisc->Initialize ();
+
+  uint8_t txqs[] = {0, 0, 1, 1, 1, 0};
+  for (uint8_t txq : txqs)
+    {
+      Ptr<QueueDiscItem> item = Create<QueueDiscTestItem> (Create<Packet> (1000));
+      item->SetTxQueueIndex (txq);
+      qdisc->Enqueue (item);
+    }
+  qdisc->Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_batches.size (), 3, "Unexpected number of batches");
+  NS_TEST_EXPECT_MSG_EQ (m_batches[0].size (), 2, "Unexpected size of the first batch");
+  NS_TEST_EXPECT_MSG_EQ (m_batches[1].size (), 3, "Unexpected size of the second batch");
+  NS_TEST_EXPECT_MSG_EQ (m_batches[2].size (), 1, "Unexpected size of the third batch");
+  for (auto& batch : m_batches)
+    {
+      for (auto& txq : batch)
+        {
+          NS_TEST_EXPECT_MSG_EQ (txq, batch.front (), "A batch includes packets destined to different queues");
+        }
+    }
+
+  QueueDisc::Stats stats = qdisc->GetStats ();
+  NS_TEST_EXPECT_MSG_EQ (stats.nTotalRequeuedPackets, 0, "No packet should have been requeued");
+  NS_TEST_EXPECT_MSG_EQ (stats.nTotalSentPackets, 6, "All the packets should have been sent");
+  NS_TEST_EXPECT_MSG_EQ (qdisc->GetNPackets (), 0, "The queue disc should be empty");
+
+  qdisc->Dispose ();
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup traffic-control-test
  * \ingroup tests
@@ -375,7 +524,9 @@ public:
   TcFlowControlTestSuite ()
     : TestSuite ("tc-flow-control", UNIT)
   {
-    AddTestCase (new TcFlowControlTestCase (QueueSizeUnit::PACKETS), TestCase::QUICK);
-    AddTestCase (new TcFlowControlTestCase (QueueSizeUnit::BYTES), TestCase::QUICK);
+    AddTestCase (new TcFlowControlTestCase (QueueSizeUnit::PACKETS, 1), TestCase::QUICK);
+    AddTestCase (new TcFlowControlTestCase (QueueSizeUnit::BYTES, 1), TestCase::QUICK);
+    AddTestCase (new TcFlowControlTestCase (QueueSizeUnit::PACKETS, 4), TestCase::QUICK);
+    AddTestCase (new TcBatchTxQueueTestCase (), TestCase::QUICK);
   }
 } g_tcFlowControlTestSuite; ///< the test suite
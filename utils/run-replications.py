@@ -0,0 +1,220 @@
+#! /usr/bin/env python3
+## -*- Mode: python; py-indent-offset: 4; indent-tabs-mode: nil; coding: utf-8; -*-
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License version 2 as
+# published by the Free Software Foundation;
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+"""
+Run independent replications of an ns-3 program in parallel.
+
+Each configuration, i.e., each combination of the values of the sweeps, is
+run with the run numbers --first-run to --first-run + --replications - 1,
+passed to the program as --RngRun.  The swept values are passed as
+--name=value arguments, so any program argument, attribute default value or
+global value known to the CommandLine of the program can be swept.  In the
+arguments of the program, {run}, {config} and {label} are replaced by the
+run number, the configuration index and the label of the replication.
+Each replication runs in its own directory, <output-dir>/<label>, where its
+standard output and error are written to output.log, so that the programs
+writing to fixed file names can be replicated.
+
+The SQLite databases written by the replications (see SqliteDataOutput) can
+be merged into a single database, the runs being told apart by the run
+label of their DataCollector.
+
+The program is run directly, without waf, so it must have been built before.
+The programs which build their topology once and fork the replications
+themselves use the ns3::ReplicationRunner class instead.
+
+Example:
+
+  ./utils/run-replications.py --replications 10 --jobs 4 \\
+      --sweep distance=10,50 --merge-db data wifi-example-sim --format=db --run={label}
+"""
+
+from __future__ import print_function
+
+import argparse
+import itertools
+import os
+import sqlite3
+import subprocess
+import sys
+import threading
+
+try:
+    import queue
+except ImportError:
+    import Queue as queue
+
+
+def read_waf_config(top_dir):
+    """Return the configuration items of the waf build used to run the programs."""
+    out_dir = None
+    for line in open(os.path.join(top_dir, ".lock-waf_" + sys.platform + "_build"), "rt"):
+        if line.startswith("out_dir ="):
+            out_dir = eval(line.split('=', 1)[1].strip())
+    config = {"out_dir": out_dir}
+    for line in open(os.path.join(out_dir, "c4che", "_cache.py"), "rt"):
+        for item in ("APPNAME", "VERSION", "BUILD_PROFILE", "NS3_MODULE_PATH"):
+            if line.startswith(item + " ="):
+                config[item] = eval(line.split('=', 1)[1].strip())
+    return config
+
+
+def find_program(config, name):
+    """Return the path of the executable of a program, given its path or its name."""
+    if os.path.isfile(name) and os.access(name, os.X_OK):
+        return os.path.abspath(name)
+    suffix = "" if config["BUILD_PROFILE"] == "release" else "-" + config["BUILD_PROFILE"]
+    target = "%s%s-%s%s" % (config["APPNAME"], config["VERSION"], os.path.basename(name), suffix)
+    found = []
+    for root, dirs, files in os.walk(config["out_dir"]):
+        if target in files:
+            found.append(os.path.join(root, target))
+    if len(found) != 1:
+        sys.exit("%s program %s in %s; build it first or give its path" %
+                 ("Ambiguous" if found else "Could not find", name, config["out_dir"]))
+    return found[0]
+
+
+def make_replications(args):
+    """Return the replications, as (label, run, configuration, settings) tuples."""
+    sweeps = []
+    for sweep in args.sweep:
+        if "=" not in sweep:
+            sys.exit("Invalid sweep %s, expected name=value1,value2,..." % sweep)
+        name, values = sweep.split("=", 1)
+        sweeps.append([(name, value) for value in values.split(",")])
+
+    replications = []
+    # the values of the last sweep change first, as in ns3::ReplicationRunner
+    for configuration, settings in enumerate(itertools.product(*sweeps)):
+        for run in range(args.first_run, args.first_run + args.replications):
+            label = "run%d" % run
+            if sweeps:
+                label = "config%d-%s" % (configuration, label)
+            replications.append((label, run, configuration, list(settings)))
+    return replications
+
+
+def run_replications(args, program, replications):
+    """Run the replications, at most args.jobs at the same time; return the labels of the failed ones."""
+    pending = queue.Queue()
+    for replication in replications:
+        pending.put(replication)
+    failed = []
+    lock = threading.Lock()
+
+    def worker():
+        while True:
+            try:
+                label, run, configuration, settings = pending.get_nowait()
+            except queue.Empty:
+                return
+            substitutions = {"run": run, "config": configuration, "label": label}
+            command = [program]
+            command += [argument.format(**substitutions) for argument in args.arguments]
+            command += ["--RngRun=%d" % run]
+            command += ["--%s=%s" % setting for setting in settings]
+            directory = os.path.join(args.output_dir, label)
+            if not os.path.isdir(directory):
+                os.makedirs(directory)
+            with open(os.path.join(directory, "output.log"), "w") as log:
+                status = subprocess.call(command, stdout=log, stderr=subprocess.STDOUT, cwd=directory)
+            with lock:
+                if status != 0:
+                    failed.append(label)
+                print("%s: %s" % ("FAIL" if status != 0 else "DONE", " ".join(command)))
+                sys.stdout.flush()
+
+    threads = [threading.Thread(target=worker) for i in range(max(1, args.jobs))]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    return failed
+
+
+def merge_databases(target, sources):
+    """Append the rows of the tables of the source databases to the target database."""
+    db = sqlite3.connect(target + ".db")
+    merged = 0
+    for source in sources:
+        if not os.path.isfile(source + ".db"):
+            print("No database %s.db to merge" % source)
+            continue
+        db.execute("attach database ? as source", (source + ".db",))
+        tables = db.execute("select name, sql from source.sqlite_master where type = 'table'").fetchall()
+        existing = [row[0] for row in db.execute("select name from main.sqlite_master where type = 'table'")]
+        for name, sql in tables:
+            if name not in existing:
+                db.execute(sql)
+            db.execute('insert into main."%s" select * from source."%s"' % (name, name))
+        db.commit()
+        db.execute("detach database source")
+        merged += 1
+    db.close()
+    return merged
+
+
+def main(argv):
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0].strip(),
+                                     epilog=__doc__.split("\n\n", 1)[1],
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--replications", type=int, default=1,
+                        help="number of replications of each configuration")
+    parser.add_argument("--first-run", type=int, default=1,
+                        help="run number of the first replication of each configuration")
+    parser.add_argument("--jobs", type=int, default=os.sysconf("SC_NPROCESSORS_ONLN"),
+                        help="number of replications run at the same time")
+    parser.add_argument("--sweep", action="append", default=[],
+                        help="values of an argument in the configurations, as name=value1,value2,... "
+                        "(may be repeated)")
+    parser.add_argument("--output-dir", default="replications",
+                        help="directory of the directories of the replications")
+    parser.add_argument("--merge-db", metavar="PREFIX",
+                        help="merge the SQLite databases of the replications into PREFIX.db")
+    parser.add_argument("--db-prefix", metavar="PREFIX", default="data",
+                        help="prefix of the database of a replication, in its directory")
+    parser.add_argument("program", help="name or path of the program")
+    parser.add_argument("arguments", nargs=argparse.REMAINDER, help="arguments of the program")
+    args = parser.parse_args(argv)
+
+    top_dir = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    config = read_waf_config(top_dir)
+    program = find_program(config, args.program)
+    if sys.platform == "darwin":
+        variable = "DYLD_LIBRARY_PATH"
+    else:
+        variable = "LD_LIBRARY_PATH"
+    paths = [str(path) for path in config["NS3_MODULE_PATH"]]
+    if os.environ.get(variable):
+        paths.append(os.environ[variable])
+    os.environ[variable] = os.pathsep.join(paths)
+
+    replications = make_replications(args)
+    failed = run_replications(args, program, replications)
+
+    if args.merge_db:
+        sources = [os.path.join(args.output_dir, replication[0], args.db_prefix)
+                   for replication in replications]
+        merged = merge_databases(args.merge_db, sources)
+        print("Merged %d databases into %s.db" % (merged, args.merge_db))
+
+    print("%d of %d replications succeeded" % (len(replications) - len(failed), len(replications)))
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))